@@ -33,6 +33,8 @@
         'include/audio_util.h',
         'resampler/include/push_resampler.h',
         'resampler/include/resampler.h',
+        'resampler/polyphase_resampler.cc',
+        'resampler/polyphase_resampler.h',
         'resampler/push_resampler.cc',
         'resampler/push_sinc_resampler.cc',
         'resampler/push_sinc_resampler.h',
@@ -90,7 +92,7 @@
       ],
       'conditions': [
         ['target_arch=="ia32" or target_arch=="x64"', {
-          'dependencies': ['common_audio_sse2',],
+          'dependencies': ['common_audio_sse2', 'common_audio_avx2',],
         }],
         ['target_arch=="arm"', {
           'sources': [
@@ -131,13 +133,36 @@
           'target_name': 'common_audio_sse2',
           'type': 'static_library',
           'sources': [
+            'resampler/polyphase_resampler_sse.cc',
             'resampler/sinc_resampler_sse.cc',
+            'signal_processing/cross_correlation_sse2.c',
+            'signal_processing/downsample_fast_sse2.c',
+            'signal_processing/min_max_operations_sse2.c',
+            'signal_processing/vector_scaling_operations_sse2.c',
           ],
           'cflags': ['-msse2',],
           'xcode_settings': {
             'OTHER_CFLAGS': ['-msse2',],
           },
         },
+        {
+          'target_name': 'common_audio_avx2',
+          'type': 'static_library',
+          'sources': [
+            'resampler/polyphase_resampler_avx2.cc',
+            'resampler/sinc_resampler_avx2.cc',
+            'signal_processing/cross_correlation_avx2.c',
+            'signal_processing/downsample_fast_avx2.c',
+            'signal_processing/min_max_operations_avx2.c',
+            'signal_processing/vector_scaling_operations_avx2.c',
+          ],
+          # The resampler versions also use FMA, and are only selected when
+          # both are supported.
+          'cflags': ['-mavx2', '-mfma',],
+          'xcode_settings': {
+            'OTHER_CFLAGS': ['-mavx2', '-mfma',],
+          },
+        },
       ],  # targets
     }],
     ['target_arch=="arm" and armv7==1', {
@@ -147,6 +172,7 @@
           'type': 'static_library',
           'includes': ['../build/arm_neon.gypi',],
           'sources': [
+            'resampler/polyphase_resampler_neon.cc',
             'resampler/sinc_resampler_neon.cc',
             'signal_processing/cross_correlation_neon.S',
             'signal_processing/downsample_fast_neon.S',
@@ -170,6 +196,7 @@
           ],
           'sources': [
             'audio_util_unittest.cc',
+            'resampler/polyphase_resampler_unittest.cc',
             'resampler/resampler_unittest.cc',
             'resampler/push_resampler_unittest.cc',
             'resampler/push_sinc_resampler_unittest.cc',
@@ -189,6 +216,7 @@
           'sources': [
             'signal_processing/real_fft_unittest.cc',
             'signal_processing/signal_processing_unittest.cc',
+            'signal_processing/spl_init_unittest.cc',
           ],
         },
         {
@@ -16,12 +16,14 @@
 
 namespace webrtc {
 
+class PolyphaseResampler;
 class Resampler;
 class PushSincResampler;
 
 // Wraps the old resampler and new arbitrary rate conversion resampler. The
 // old resampler will be used whenever it supports the requested rates, and
-// otherwise the sinc resampler will be enabled.
+// otherwise the sinc resampler will be enabled. The sinc resampler uses a
+// precomputed polyphase filter bank when the ratio of the rates allows it.
 class PushResampler {
  public:
   PushResampler();
@@ -44,6 +46,7 @@ class PushResampler {
                    int dst_capacity);
 
   scoped_ptr<Resampler> resampler_;
+  scoped_ptr<PolyphaseResampler> polyphase_resampler_;
   scoped_ptr<PushSincResampler> sinc_resampler_;
   scoped_ptr<PushSincResampler> sinc_resampler_right_;
   int src_sample_rate_hz_;
@@ -0,0 +1,216 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// The source samples of a block are placed after kKernelSize samples of
+// history, and output sample n of the block is computed at source position
+// n * src_size / dst_size of it, exactly like SincResampler does it when fed
+// 10 ms blocks by PushSincResampler:
+//
+// |--------------------------------|------------------------------------|
+//            kKernelSize                        src_size
+//       history (initially zero)               current block
+//
+// With the ratio reduced to M / L, the position n * M / L is at input offset
+// (n * M) / L with a sub-sample shift of ((n * M) % L) / L, i.e. it takes one
+// of L phases. The windowed sinc kernel of each phase is computed once, and a
+// kernel centered on the position spans input offsets [offset, offset +
+// kKernelSize), which delays the output by kKernelSize / 2 source samples.
+
+// MSVC++ requires this to be set before any other includes to get M_PI.
+#define _USE_MATH_DEFINES
+
+#include "webrtc/common_audio/resampler/polyphase_resampler.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+namespace {
+
+int GreatestCommonDivisor(int a, int b) {
+  while (b != 0) {
+    const int remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+  return a;
+}
+
+// Channel buffers are padded to keep each of them 32-byte aligned.
+int ChannelStride(int src_size) {
+  return (PolyphaseResampler::kKernelSize + src_size + 7) & ~7;
+}
+
+}  // namespace
+
+bool PolyphaseResampler::IsSupported(int src_block_size, int dst_block_size) {
+  if (src_block_size <= 0 || dst_block_size <= 0) {
+    return false;
+  }
+  const int phases =
+      dst_block_size / GreatestCommonDivisor(src_block_size, dst_block_size);
+  return phases <= kMaxPhases;
+}
+
+PolyphaseResampler::PolyphaseResampler(int src_block_size,
+                                       int dst_block_size,
+                                       int num_channels)
+    : src_size_(src_block_size),
+      dst_size_(dst_block_size),
+      num_channels_(num_channels),
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+      convolve_proc_(WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3) ?
+                     Convolve_AVX2 : WebRtc_GetCPUInfo(kSSE2) ?
+                     Convolve_SSE : Convolve_C),
+#elif defined(WEBRTC_ARCH_ARM_V7) && !defined(WEBRTC_ARCH_ARM_NEON)
+      convolve_proc_(WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON ?
+                     Convolve_NEON : Convolve_C),
+#endif
+      kernel_storage_(NULL),
+      kernels_(new const float*[dst_block_size]),
+      input_offsets_(new int[dst_block_size]),
+      input_buffer_(static_cast<float*>(AlignedMalloc(
+          sizeof(float) * ChannelStride(src_block_size) * num_channels, 32))),
+      inputs_(new float*[num_channels]),
+      output_buffer_(new float[dst_block_size * num_channels]),
+      outputs_(new float*[num_channels]) {
+  assert(IsSupported(src_block_size, dst_block_size));
+  assert(num_channels > 0);
+
+  const int divisor = GreatestCommonDivisor(src_size_, dst_size_);
+  const int phases = dst_size_ / divisor;
+  const int step = src_size_ / divisor;
+  kernel_storage_.reset(static_cast<float*>(
+      AlignedMalloc(sizeof(float) * kKernelSize * phases, 32)));
+  InitializeKernels(phases, step);
+
+  const int stride = ChannelStride(src_size_);
+  memset(input_buffer_.get(), 0,
+         sizeof(*input_buffer_.get()) * stride * num_channels_);
+  for (int i = 0; i < num_channels_; ++i) {
+    inputs_[i] = input_buffer_.get() + i * stride;
+    outputs_[i] = output_buffer_.get() + i * dst_size_;
+  }
+}
+
+PolyphaseResampler::~PolyphaseResampler() {
+}
+
+void PolyphaseResampler::InitializeKernels(int phases, int step) {
+  // Blackman window parameters, as in SincResampler.
+  static const double kAlpha = 0.16;
+  static const double kA0 = 0.5 * (1.0 - kAlpha);
+  static const double kA1 = 0.5;
+  static const double kA2 = 0.5 * kAlpha;
+
+  // The normalized cutoff frequency of the low-pass filter, adjusted slightly
+  // downward as the window widens the transition band. See SincScaleFactor()
+  // in sinc_resampler.cc.
+  const double io_ratio = static_cast<double>(step) / phases;
+  const double sinc_scale_factor =
+      (io_ratio > 1.0 ? 1.0 / io_ratio : 1.0) * 0.9;
+
+  for (int phase = 0; phase < phases; ++phase) {
+    const double subsample_offset = static_cast<double>(phase) / phases;
+    float* kernel = kernel_storage_.get() + phase * kKernelSize;
+    for (int i = 0; i < kKernelSize; ++i) {
+      const double pre_sinc = M_PI * (i - kKernelSize / 2 - subsample_offset);
+      const double x = (i - subsample_offset) / kKernelSize;
+      const double window =
+          kA0 - kA1 * cos(2.0 * M_PI * x) + kA2 * cos(4.0 * M_PI * x);
+      if (pre_sinc == 0) {
+        kernel[i] = static_cast<float>(sinc_scale_factor * window);
+      } else {
+        kernel[i] = static_cast<float>(
+            window * sin(sinc_scale_factor * pre_sinc) / pre_sinc);
+      }
+    }
+  }
+
+  for (int i = 0; i < dst_size_; ++i) {
+    const int position = i * step;
+    input_offsets_[i] = position / phases;
+    kernels_[i] = kernel_storage_.get() + (position % phases) * kKernelSize;
+  }
+}
+
+// If we know the minimum architecture avoid function hopping for CPU detection.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#define CONVOLVE_FUNC convolve_proc_
+#elif defined(WEBRTC_ARCH_ARM_V7)
+#if defined(WEBRTC_ARCH_ARM_NEON)
+#define CONVOLVE_FUNC Convolve_NEON
+#else
+#define CONVOLVE_FUNC convolve_proc_
+#endif
+#else
+#define CONVOLVE_FUNC Convolve_C
+#endif
+
+int PolyphaseResampler::Resample(const int16_t* source,
+                                 int source_length,
+                                 int16_t* destination,
+                                 int destination_capacity) {
+  assert(source_length == src_size_ * num_channels_);
+  assert(destination_capacity >= dst_size_ * num_channels_);
+
+  for (int i = 0; i < num_channels_; ++i) {
+    float* input = inputs_[i] + kKernelSize;
+    for (int j = 0; j < src_size_; ++j) {
+      input[j] = static_cast<float>(source[j * num_channels_ + i]);
+    }
+  }
+
+  CONVOLVE_FUNC(inputs_.get(), num_channels_, input_offsets_.get(),
+                kernels_.get(), dst_size_, outputs_.get());
+
+  for (int i = 0; i < num_channels_; ++i) {
+    const float* output = outputs_[i];
+    for (int j = 0; j < dst_size_; ++j) {
+      float clipped = std::max(std::min(output[j], 32767.0f), -32768.0f);
+      destination[j * num_channels_ + i] =
+          static_cast<int16_t>(std::floor(clipped + 0.5));
+    }
+    // Keep the end of the block as history for the next one.
+    memmove(inputs_[i], inputs_[i] + src_size_,
+            sizeof(*inputs_[i]) * kKernelSize);
+  }
+
+  return dst_size_ * num_channels_;
+}
+
+#undef CONVOLVE_FUNC
+
+void PolyphaseResampler::Convolve_C(const float* const* inputs,
+                                    int num_channels,
+                                    const int* input_offsets,
+                                    const float* const* kernels,
+                                    int frames,
+                                    float* const* outputs) {
+  for (int i = 0; i < frames; ++i) {
+    const float* kernel = kernels[i];
+    for (int j = 0; j < num_channels; ++j) {
+      const float* input = inputs[j] + input_offsets[i];
+      float sum = 0;
+      for (int k = 0; k < kKernelSize; ++k) {
+        sum += input[k] * kernel[k];
+      }
+      outputs[j][i] = sum;
+    }
+  }
+}
+
+}  // namespace webrtc
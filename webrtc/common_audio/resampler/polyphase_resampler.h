@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_COMMON_AUDIO_RESAMPLER_POLYPHASE_RESAMPLER_H_
+#define WEBRTC_COMMON_AUDIO_RESAMPLER_POLYPHASE_RESAMPLER_H_
+
+#include "webrtc/common_audio/resampler/sinc_resampler.h"
+#include "webrtc/system_wrappers/interface/aligned_malloc.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/test/testsupport/gtest_prod_util.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// A push-based multi-channel resampler for a fixed rational ratio, as given by
+// the source and destination block sizes. It is a drop-in replacement for one
+// PushSincResampler per channel: the same windowed sinc kernel and the same
+// delay of kKernelSize / 2 source samples, but with one kernel per output
+// phase precomputed at construction rather than interpolated between two
+// kernels for every output sample. All channels are filtered together, one
+// output sample at a time, so that they share the kernel loads.
+class PolyphaseResampler {
+ public:
+  enum {
+    kKernelSize = SincResampler::kKernelSize,
+
+    // The largest number of phases in the filter bank, which bounds its size
+    // to kMaxPhases * kKernelSize floats. Allows any pair of 10 ms blocks with
+    // a destination rate of up to 48 kHz.
+    kMaxPhases = 480,
+  };
+
+  // Returns true if the ratio of the block sizes needs at most kMaxPhases
+  // phases.
+  static bool IsSupported(int src_block_size, int dst_block_size);
+
+  // Provide the size of the source and destination blocks in samples per
+  // channel. These must correspond to the same time duration (typically
+  // 10 ms) and IsSupported() must hold for them.
+  PolyphaseResampler(int src_block_size, int dst_block_size, int num_channels);
+  ~PolyphaseResampler();
+
+  // Perform the resampling of one block of interleaved audio. |source_length|
+  // must always equal |src_block_size| * |num_channels| and
+  // |destination_capacity| must be at least |dst_block_size| * |num_channels|.
+  // Returns the number of samples provided in |destination|.
+  int Resample(const int16_t* source, int source_length,
+               int16_t* destination, int destination_capacity);
+
+ private:
+  FRIEND_TEST_ALL_PREFIXES(PolyphaseResamplerTest, Convolve);
+  FRIEND_TEST_ALL_PREFIXES(PolyphaseResamplerTest, ConvolveBenchmark);
+
+  void InitializeKernels(int phases, int step);
+
+  // Computes |frames| output samples for each of |num_channels| channels.
+  // Output sample n of channel c is the dot product of the kKernelSize samples
+  // at |inputs|[c] + |input_offsets|[n] with |kernels|[n]. On x86, the
+  // underlying implementation is chosen at run time based on SSE, AVX2 and FMA
+  // support. On ARM, NEON support is chosen at compile time based on
+  // compilation flags.
+  static void Convolve_C(const float* const* inputs, int num_channels,
+                         const int* input_offsets,
+                         const float* const* kernels, int frames,
+                         float* const* outputs);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  static void Convolve_SSE(const float* const* inputs, int num_channels,
+                           const int* input_offsets,
+                           const float* const* kernels, int frames,
+                           float* const* outputs);
+  static void Convolve_AVX2(const float* const* inputs, int num_channels,
+                            const int* input_offsets,
+                            const float* const* kernels, int frames,
+                            float* const* outputs);
+#elif defined(WEBRTC_ARCH_ARM_V7)
+  static void Convolve_NEON(const float* const* inputs, int num_channels,
+                            const int* input_offsets,
+                            const float* const* kernels, int frames,
+                            float* const* outputs);
+#endif
+
+  const int src_size_;
+  const int dst_size_;
+  const int num_channels_;
+
+  // Stores the runtime selection of which Convolve function to use.
+#if defined(WEBRTC_ARCH_X86_FAMILY) ||  \
+    (defined(WEBRTC_ARCH_ARM_V7) && !defined(WEBRTC_ARCH_ARM_NEON))
+  typedef void (*ConvolveProc)(const float* const*, int, const int*,
+                               const float* const*, int, float* const*);
+  const ConvolveProc convolve_proc_;
+#endif
+
+  // The filter bank, with the kernel for phase p (a sub-sample shift of p
+  // divided by the number of phases) at offset p * kKernelSize.
+  scoped_ptr_malloc<float, AlignedFree> kernel_storage_;
+
+  // For each output sample of a block, the kernel and the offset of the first
+  // input sample it is applied to. These repeat identically for every block.
+  scoped_array<const float*> kernels_;
+  scoped_array<int> input_offsets_;
+
+  // For each channel, kKernelSize samples of history followed by the current
+  // block.
+  scoped_ptr_malloc<float, AlignedFree> input_buffer_;
+  scoped_array<float*> inputs_;
+  scoped_array<float> output_buffer_;
+  scoped_array<float*> outputs_;
+
+  DISALLOW_COPY_AND_ASSIGN(PolyphaseResampler);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_AUDIO_RESAMPLER_POLYPHASE_RESAMPLER_H_
@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/resampler/polyphase_resampler.h"
+
+#include <immintrin.h>
+
+namespace webrtc {
+
+// AVX2 version of Convolve_SSE(). Requires FMA as well.
+void PolyphaseResampler::Convolve_AVX2(const float* const* inputs,
+                                       int num_channels,
+                                       const int* input_offsets,
+                                       const float* const* kernels,
+                                       int frames,
+                                       float* const* outputs) {
+  for (int i = 0; i < frames; ++i) {
+    // The kernel stays in the cache for all channels.
+    const float* kernel = kernels[i];
+    for (int j = 0; j < num_channels; ++j) {
+      const float* input = inputs[j] + input_offsets[i];
+      __m256 m_sums1 = _mm256_setzero_ps();
+      __m256 m_sums2 = _mm256_setzero_ps();
+      for (int k = 0; k < kKernelSize; k += 16) {
+        m_sums1 = _mm256_fmadd_ps(_mm256_loadu_ps(input + k),
+                                  _mm256_load_ps(kernel + k), m_sums1);
+        m_sums2 = _mm256_fmadd_ps(_mm256_loadu_ps(input + k + 8),
+                                  _mm256_load_ps(kernel + k + 8), m_sums2);
+      }
+
+      // Sum components together.
+      m_sums1 = _mm256_add_ps(m_sums1, m_sums2);
+      __m128 m_sum = _mm_add_ps(_mm256_castps256_ps128(m_sums1),
+                                _mm256_extractf128_ps(m_sums1, 1));
+      m_sum = _mm_add_ps(_mm_movehl_ps(m_sum, m_sum), m_sum);
+      outputs[j][i] = _mm_cvtss_f32(
+          _mm_add_ss(m_sum, _mm_shuffle_ps(m_sum, m_sum, 1)));
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/resampler/polyphase_resampler.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+void PolyphaseResampler::Convolve_NEON(const float* const* inputs,
+                                       int num_channels,
+                                       const int* input_offsets,
+                                       const float* const* kernels,
+                                       int frames,
+                                       float* const* outputs) {
+  for (int i = 0; i < frames; ++i) {
+    // The kernel stays in the cache for all channels.
+    const float* kernel = kernels[i];
+    for (int j = 0; j < num_channels; ++j) {
+      const float* input = inputs[j] + input_offsets[i];
+      float32x4_t m_sums1 = vmovq_n_f32(0);
+      float32x4_t m_sums2 = vmovq_n_f32(0);
+      for (int k = 0; k < kKernelSize; k += 8) {
+        m_sums1 = vmlaq_f32(m_sums1, vld1q_f32(input + k),
+                            vld1q_f32(kernel + k));
+        m_sums2 = vmlaq_f32(m_sums2, vld1q_f32(input + k + 4),
+                            vld1q_f32(kernel + k + 4));
+      }
+
+      // Sum components together.
+      m_sums1 = vaddq_f32(m_sums1, m_sums2);
+      float32x2_t m_half = vadd_f32(vget_high_f32(m_sums1),
+                                    vget_low_f32(m_sums1));
+      outputs[j][i] = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/resampler/polyphase_resampler.h"
+
+#include <xmmintrin.h>
+
+namespace webrtc {
+
+void PolyphaseResampler::Convolve_SSE(const float* const* inputs,
+                                      int num_channels,
+                                      const int* input_offsets,
+                                      const float* const* kernels,
+                                      int frames,
+                                      float* const* outputs) {
+  for (int i = 0; i < frames; ++i) {
+    // The kernel stays in the cache for all channels.
+    const float* kernel = kernels[i];
+    for (int j = 0; j < num_channels; ++j) {
+      const float* input = inputs[j] + input_offsets[i];
+      __m128 m_sums1 = _mm_setzero_ps();
+      __m128 m_sums2 = _mm_setzero_ps();
+      for (int k = 0; k < kKernelSize; k += 8) {
+        m_sums1 = _mm_add_ps(m_sums1, _mm_mul_ps(
+            _mm_loadu_ps(input + k), _mm_load_ps(kernel + k)));
+        m_sums2 = _mm_add_ps(m_sums2, _mm_mul_ps(
+            _mm_loadu_ps(input + k + 4), _mm_load_ps(kernel + k + 4)));
+      }
+
+      // Sum components together.
+      m_sums1 = _mm_add_ps(m_sums1, m_sums2);
+      m_sums2 = _mm_add_ps(_mm_movehl_ps(m_sums1, m_sums1), m_sums1);
+      _mm_store_ss(&outputs[j][i], _mm_add_ss(m_sums2, _mm_shuffle_ps(
+          m_sums2, m_sums2, 1)));
+    }
+  }
+}
+
+}  // namespace webrtc
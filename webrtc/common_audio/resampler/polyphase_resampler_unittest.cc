@@ -0,0 +1,305 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/common_audio/resampler/polyphase_resampler.h"
+#include "webrtc/common_audio/resampler/push_sinc_resampler.h"
+#include "webrtc/common_audio/resampler/sinusoidal_linear_chirp_source.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+static const int kNumChannels = 2;
+
+// Fills the input history and block of each channel of |resampler| with
+// random samples, by resampling two blocks of them.
+static void FillInputs(PolyphaseResampler* resampler, int src_size,
+                       int dst_size) {
+  scoped_array<int16_t> source(new int16_t[src_size * kNumChannels]);
+  scoped_array<int16_t> destination(new int16_t[dst_size * kNumChannels]);
+  srand(17);
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < src_size * kNumChannels; ++j) {
+      source[j] = static_cast<int16_t>((rand() % 65536) - 32768);
+    }
+    resampler->Resample(source.get(), src_size * kNumChannels,
+                        destination.get(), dst_size * kNumChannels);
+  }
+}
+
+TEST(PolyphaseResamplerTest, IsSupported) {
+  EXPECT_TRUE(PolyphaseResampler::IsSupported(441, 480));
+  EXPECT_TRUE(PolyphaseResampler::IsSupported(80, 441));
+  EXPECT_TRUE(PolyphaseResampler::IsSupported(1920, 80));
+  EXPECT_TRUE(PolyphaseResampler::IsSupported(441, 960));
+  EXPECT_FALSE(PolyphaseResampler::IsSupported(480, 0));
+  EXPECT_FALSE(PolyphaseResampler::IsSupported(441, 1920));
+  EXPECT_FALSE(PolyphaseResampler::IsSupported(0, 480));
+}
+
+// Ensure the optimized Convolve() methods return the same values as
+// Convolve_C() for every output sample and channel of a block.
+TEST(PolyphaseResamplerTest, Convolve) {
+  const int kSrcSize = 441;
+  const int kDstSize = 480;
+  PolyphaseResampler resampler(kSrcSize, kDstSize, kNumChannels);
+  FillInputs(&resampler, kSrcSize, kDstSize);
+
+  float expected[kNumChannels][kDstSize];
+  float* expected_ptrs[kNumChannels] = {expected[0], expected[1]};
+  PolyphaseResampler::Convolve_C(resampler.inputs_.get(), kNumChannels,
+                                 resampler.input_offsets_.get(),
+                                 resampler.kernels_.get(), kDstSize,
+                                 expected_ptrs);
+
+  // The summation order differs, so compare relative to the magnitude of the
+  // samples.
+  static const double kEpsilon = 32768 * 0.000001;
+  float actual[kNumChannels][kDstSize];
+  float* actual_ptrs[kNumChannels] = {actual[0], actual[1]};
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  ASSERT_TRUE(WebRtc_GetCPUInfo(kSSE2));
+  PolyphaseResampler::Convolve_SSE(resampler.inputs_.get(), kNumChannels,
+                                   resampler.input_offsets_.get(),
+                                   resampler.kernels_.get(), kDstSize,
+                                   actual_ptrs);
+  for (int i = 0; i < kNumChannels; ++i) {
+    for (int j = 0; j < kDstSize; ++j) {
+      EXPECT_NEAR(expected[i][j], actual[i][j], kEpsilon);
+    }
+  }
+
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3)) {
+    PolyphaseResampler::Convolve_AVX2(resampler.inputs_.get(), kNumChannels,
+                                      resampler.input_offsets_.get(),
+                                      resampler.kernels_.get(), kDstSize,
+                                      actual_ptrs);
+    for (int i = 0; i < kNumChannels; ++i) {
+      for (int j = 0; j < kDstSize; ++j) {
+        EXPECT_NEAR(expected[i][j], actual[i][j], kEpsilon);
+      }
+    }
+  }
+#elif defined(WEBRTC_ARCH_ARM_V7)
+  ASSERT_TRUE(WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON);
+  PolyphaseResampler::Convolve_NEON(resampler.inputs_.get(), kNumChannels,
+                                    resampler.input_offsets_.get(),
+                                    resampler.kernels_.get(), kDstSize,
+                                    actual_ptrs);
+  for (int i = 0; i < kNumChannels; ++i) {
+    for (int j = 0; j < kDstSize; ++j) {
+      EXPECT_NEAR(expected[i][j], actual[i][j], kEpsilon);
+    }
+  }
+#endif
+}
+
+// Benchmark for the various Convolve() methods, resampling stereo 10 ms blocks
+// from 44.1 to 48 kHz.
+TEST(PolyphaseResamplerTest, DISABLED_ConvolveBenchmark) {
+  const int kSrcSize = 441;
+  const int kDstSize = 480;
+  const int kConvolveIterations = 10000;
+  PolyphaseResampler resampler(kSrcSize, kDstSize, kNumChannels);
+  FillInputs(&resampler, kSrcSize, kDstSize);
+
+  printf("Benchmarking %d iterations:\n", kConvolveIterations);
+
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kConvolveIterations; ++i) {
+    PolyphaseResampler::Convolve_C(resampler.inputs_.get(), kNumChannels,
+                                   resampler.input_offsets_.get(),
+                                   resampler.kernels_.get(), kDstSize,
+                                   resampler.outputs_.get());
+  }
+  double total_time_c_us = (TickTime::Now() - start).Microseconds();
+  printf("Convolve_C took %.2fms.\n", total_time_c_us / 1000);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  start = TickTime::Now();
+  for (int i = 0; i < kConvolveIterations; ++i) {
+    PolyphaseResampler::Convolve_SSE(resampler.inputs_.get(), kNumChannels,
+                                     resampler.input_offsets_.get(),
+                                     resampler.kernels_.get(), kDstSize,
+                                     resampler.outputs_.get());
+  }
+  double total_time_sse_us = (TickTime::Now() - start).Microseconds();
+  printf("Convolve_SSE took %.2fms; which is %.2fx faster than Convolve_C.\n",
+         total_time_sse_us / 1000, total_time_c_us / total_time_sse_us);
+
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3)) {
+    start = TickTime::Now();
+    for (int i = 0; i < kConvolveIterations; ++i) {
+      PolyphaseResampler::Convolve_AVX2(resampler.inputs_.get(), kNumChannels,
+                                        resampler.input_offsets_.get(),
+                                        resampler.kernels_.get(), kDstSize,
+                                        resampler.outputs_.get());
+    }
+    double total_time_avx2_us = (TickTime::Now() - start).Microseconds();
+    printf("Convolve_AVX2 took %.2fms; which is %.2fx faster than Convolve_C "
+           "and %.2fx faster than Convolve_SSE.\n", total_time_avx2_us / 1000,
+           total_time_c_us / total_time_avx2_us,
+           total_time_sse_us / total_time_avx2_us);
+  }
+#elif defined(WEBRTC_ARCH_ARM_V7)
+  start = TickTime::Now();
+  for (int i = 0; i < kConvolveIterations; ++i) {
+    PolyphaseResampler::Convolve_NEON(resampler.inputs_.get(), kNumChannels,
+                                      resampler.input_offsets_.get(),
+                                      resampler.kernels_.get(), kDstSize,
+                                      resampler.outputs_.get());
+  }
+  double total_time_neon_us = (TickTime::Now() - start).Microseconds();
+  printf("Convolve_NEON took %.2fms; which is %.2fx faster than Convolve_C.\n",
+         total_time_neon_us / 1000, total_time_c_us / total_time_neon_us);
+#endif
+}
+
+typedef std::tr1::tuple<int, int> PolyphaseResamplerTestData;
+class PolyphaseResamplerTest
+    : public testing::TestWithParam<PolyphaseResamplerTestData> {
+ public:
+  PolyphaseResamplerTest()
+      : input_rate_(std::tr1::get<0>(GetParam())),
+        output_rate_(std::tr1::get<1>(GetParam())) {
+  }
+
+  virtual ~PolyphaseResamplerTest() {}
+
+ protected:
+  int input_rate_;
+  int output_rate_;
+};
+
+// Returns the RMS error of |resampled| against the pure signal of |source|,
+// and in |low_freq_max_error| the maximum error below 0.7 times the Nyquist
+// frequency of |minimum_rate|. Both are in dBFS.
+static double ResamplingError(const int16_t* resampled, int samples,
+                              int minimum_rate,
+                              SinusoidalLinearChirpSource* source,
+                              double* low_freq_max_error) {
+  scoped_array<float> pure(new float[samples]);
+  source->Run(pure.get(), samples);
+
+  const double low_frequency_range = 0.7 * 0.5 * minimum_rate;
+  double sum_of_squares = 0;
+  *low_freq_max_error = 0;
+  for (int i = 0; i < samples; ++i) {
+    double error = fabs(resampled[i] / 32767.0 - pure[i]);
+    if (source->Frequency(i) < low_frequency_range) {
+      *low_freq_max_error = std::max(*low_freq_max_error, error);
+    }
+    sum_of_squares += error * error;
+  }
+  *low_freq_max_error = 20 * log10(*low_freq_max_error);
+  return 20 * log10(sqrt(sum_of_squares / samples));
+}
+
+// Resamples one second of a chirp in 10 ms blocks, in stereo with the same
+// signal in both channels, and compares the result to that of
+// PushSincResampler. The two only differ in how the kernel is computed for a
+// sub-sample position, so the errors against the pure signal must be the same
+// or lower.
+TEST_P(PolyphaseResamplerTest, Resample) {
+  const int kNumBlocks = 100;
+  const int input_block_size = input_rate_ / 100;
+  const int output_block_size = output_rate_ / 100;
+  const int output_samples = kNumBlocks * output_block_size;
+
+  SinusoidalLinearChirpSource source(input_rate_, input_rate_,
+                                     0.5 * input_rate_, 0);
+  scoped_array<float> source_float(new float[input_rate_]);
+  source.Run(source_float.get(), input_rate_);
+
+  PolyphaseResampler resampler(input_block_size, output_block_size,
+                               kNumChannels);
+  PushSincResampler sinc_resampler(input_block_size, output_block_size);
+  scoped_array<int16_t> source_mono(new int16_t[input_block_size]);
+  scoped_array<int16_t> source_stereo(
+      new int16_t[input_block_size * kNumChannels]);
+  scoped_array<int16_t> destination_stereo(
+      new int16_t[output_block_size * kNumChannels]);
+  scoped_array<int16_t> resampled(new int16_t[output_samples]);
+  scoped_array<int16_t> sinc_resampled(new int16_t[output_samples]);
+
+  for (int i = 0; i < kNumBlocks; ++i) {
+    for (int j = 0; j < input_block_size; ++j) {
+      source_mono[j] = static_cast<int16_t>(std::floor(
+          32767 * source_float[i * input_block_size + j] + 0.5));
+      source_stereo[j * kNumChannels] = source_mono[j];
+      source_stereo[j * kNumChannels + 1] = source_mono[j];
+    }
+    EXPECT_EQ(output_block_size * kNumChannels,
+              resampler.Resample(source_stereo.get(),
+                                 input_block_size * kNumChannels,
+                                 destination_stereo.get(),
+                                 output_block_size * kNumChannels));
+    EXPECT_EQ(output_block_size,
+              sinc_resampler.Resample(source_mono.get(), input_block_size,
+                                      &sinc_resampled[i * output_block_size],
+                                      output_block_size));
+    for (int j = 0; j < output_block_size; ++j) {
+      ASSERT_EQ(destination_stereo[j * kNumChannels],
+                destination_stereo[j * kNumChannels + 1]);
+      resampled[i * output_block_size + j] =
+          destination_stereo[j * kNumChannels];
+    }
+  }
+
+  // Both resamplers delay the signal by half the kernel size at the input
+  // sample rate; see PushSincResamplerTest.
+  const double output_delay_samples = static_cast<double>(output_rate_) /
+      input_rate_ * PolyphaseResampler::kKernelSize / 2;
+  const int minimum_rate = std::min(input_rate_, output_rate_);
+  SinusoidalLinearChirpSource pure_source(
+      output_rate_, output_samples, 0.5 * input_rate_, output_delay_samples);
+  double low_freq_max_error = 0;
+  double rms_error = ResamplingError(resampled.get(), output_samples,
+                                     minimum_rate, &pure_source,
+                                     &low_freq_max_error);
+  SinusoidalLinearChirpSource sinc_pure_source(
+      output_rate_, output_samples, 0.5 * input_rate_, output_delay_samples);
+  double sinc_low_freq_max_error = 0;
+  double sinc_rms_error = ResamplingError(sinc_resampled.get(), output_samples,
+                                          minimum_rate, &sinc_pure_source,
+                                          &sinc_low_freq_max_error);
+
+  // Allow for the quantization to 16 bits.
+  static const double kToleranceDb = 0.05;
+  EXPECT_LE(rms_error, sinc_rms_error + kToleranceDb);
+  EXPECT_LE(low_freq_max_error, sinc_low_freq_max_error + kToleranceDb);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    PolyphaseResamplerTest, PolyphaseResamplerTest, testing::Values(
+        std::tr1::make_tuple(8000, 16000),
+        std::tr1::make_tuple(8000, 44100),
+        std::tr1::make_tuple(8000, 48000),
+        std::tr1::make_tuple(16000, 8000),
+        std::tr1::make_tuple(16000, 44100),
+        std::tr1::make_tuple(32000, 44100),
+        std::tr1::make_tuple(44100, 8000),
+        std::tr1::make_tuple(44100, 16000),
+        std::tr1::make_tuple(44100, 32000),
+        std::tr1::make_tuple(44100, 48000),
+        std::tr1::make_tuple(48000, 8000),
+        std::tr1::make_tuple(48000, 32000),
+        std::tr1::make_tuple(48000, 44100),
+        std::tr1::make_tuple(96000, 44100)));
+
+}  // namespace webrtc
@@ -14,6 +14,7 @@
 
 #include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/resampler/include/resampler.h"
+#include "webrtc/common_audio/resampler/polyphase_resampler.h"
 #include "webrtc/common_audio/resampler/push_sinc_resampler.h"
 
 namespace webrtc {
@@ -21,6 +22,7 @@ namespace webrtc {
 PushResampler::PushResampler()
       // Requires valid values at construction, so give it something arbitrary.
     : resampler_(new Resampler(48000, 48000, kResamplerSynchronous)),
+      polyphase_resampler_(NULL),
       sinc_resampler_(NULL),
       sinc_resampler_right_(NULL),
       src_sample_rate_hz_(0),
@@ -67,6 +69,17 @@ int PushResampler::InitializeIfNeeded(int src_sample_rate_hz,
   use_sinc_resampler_ = true;
   const int src_size_10ms_mono = src_sample_rate_hz / 100;
   const int dst_size_10ms_mono = dst_sample_rate_hz / 100;
+  if (PolyphaseResampler::IsSupported(src_size_10ms_mono,
+                                      dst_size_10ms_mono)) {
+    // Resamples all channels at once; no need to deinterleave.
+    polyphase_resampler_.reset(new PolyphaseResampler(
+        src_size_10ms_mono, dst_size_10ms_mono, num_channels_));
+    sinc_resampler_.reset();
+    sinc_resampler_right_.reset();
+    return 0;
+  }
+
+  polyphase_resampler_.reset();
   sinc_resampler_.reset(new PushSincResampler(src_size_10ms_mono,
                                               dst_size_10ms_mono));
   if (num_channels_ == 2) {
@@ -109,6 +122,9 @@ int PushResampler::ResampleSinc(const int16_t* src, int src_length,
     memcpy(dst, src, src_length * sizeof(int16_t));
     return src_length;
   }
+  if (polyphase_resampler_.get()) {
+    return polyphase_resampler_->Resample(src, src_length, dst, dst_capacity);
+  }
   if (num_channels_ == 2) {
     const int src_length_mono = src_length / num_channels_;
     const int dst_capacity_mono = dst_capacity / num_channels_;
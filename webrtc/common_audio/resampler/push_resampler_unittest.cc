@@ -8,8 +8,18 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+// MSVC++ requires this to be set before any other includes to get M_PI.
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <cstdio>
+
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/resampler/include/push_resampler.h"
+#include "webrtc/common_audio/resampler/push_sinc_resampler.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 // Quality testing of PushResampler is handled through output_mixer_unittest.cc.
 
@@ -104,4 +114,84 @@ INSTANTIATE_TEST_CASE_P(
         std::tr1::make_tuple(96000, 192000, false),
         std::tr1::make_tuple(192000, 192000, false)));
 
+// Benchmark for resampling 10 ms blocks between the rates used in WebRTC,
+// comparing PushResampler to a PushSincResampler for each channel, which is
+// what PushResampler used whenever the old resampler does not support the
+// rates.
+TEST(PushResamplerTest, DISABLED_ResampleBenchmark) {
+  static const int kRates[] = {8000, 16000, 32000, 44100, 48000};
+  static const int kNumRates = sizeof(kRates) / sizeof(*kRates);
+  static const int kMaxChannels = 2;
+  const int kNumBlocks = 1000;
+
+  printf("Microseconds per 10 ms block, over %d blocks:\n", kNumBlocks);
+  printf("%6s -> %6s  channels  PushSincResampler  PushResampler\n",
+         "src Hz", "dst Hz");
+  for (int num_channels = 1; num_channels <= kMaxChannels; ++num_channels) {
+    for (int i = 0; i < kNumRates; ++i) {
+      for (int j = 0; j < kNumRates; ++j) {
+        if (i == j) {
+          continue;
+        }
+        const int src_size_mono = kRates[i] / 100;
+        const int dst_size_mono = kRates[j] / 100;
+        const int src_size = src_size_mono * num_channels;
+        const int dst_size = dst_size_mono * num_channels;
+
+        // A 1 kHz tone at about -10 dBFS.
+        scoped_array<int16_t> src(new int16_t[src_size]);
+        for (int k = 0; k < src_size_mono; ++k) {
+          for (int c = 0; c < num_channels; ++c) {
+            src[k * num_channels + c] = static_cast<int16_t>(
+                10000 * sin(2 * M_PI * 1000 * k / kRates[i]));
+          }
+        }
+        scoped_array<int16_t> dst(new int16_t[dst_size]);
+
+        // One PushSincResampler per channel, with the same deinterleaving
+        // as PushResampler.
+        scoped_ptr<PushSincResampler> sinc_resamplers[kMaxChannels];
+        scoped_array<int16_t> src_channels[kMaxChannels];
+        scoped_array<int16_t> dst_channels[kMaxChannels];
+        int16_t* src_ptrs[kMaxChannels];
+        const int16_t* dst_ptrs[kMaxChannels];
+        for (int c = 0; c < num_channels; ++c) {
+          sinc_resamplers[c].reset(
+              new PushSincResampler(src_size_mono, dst_size_mono));
+          src_channels[c].reset(new int16_t[src_size_mono]);
+          dst_channels[c].reset(new int16_t[dst_size_mono]);
+          src_ptrs[c] = src_channels[c].get();
+          dst_ptrs[c] = dst_channels[c].get();
+        }
+        TickTime start = TickTime::Now();
+        for (int k = 0; k < kNumBlocks; ++k) {
+          Deinterleave(src.get(), src_size_mono, num_channels, src_ptrs);
+          for (int c = 0; c < num_channels; ++c) {
+            sinc_resamplers[c]->Resample(src_channels[c].get(), src_size_mono,
+                                         dst_channels[c].get(),
+                                         dst_size_mono);
+          }
+          Interleave(dst_ptrs, dst_size_mono, num_channels, dst.get());
+        }
+        double sinc_us = (TickTime::Now() - start).Microseconds();
+
+        PushResampler resampler;
+        ASSERT_EQ(0, resampler.InitializeIfNeeded(kRates[i], kRates[j],
+                                                  num_channels));
+        start = TickTime::Now();
+        for (int k = 0; k < kNumBlocks; ++k) {
+          ASSERT_EQ(dst_size, resampler.Resample(src.get(), src_size,
+                                                 dst.get(), dst_size));
+        }
+        double push_us = (TickTime::Now() - start).Microseconds();
+
+        printf("%6d -> %6d  %8d  %17.2f  %13.2f (%s)\n", kRates[i],
+               kRates[j], num_channels, sinc_us / kNumBlocks,
+               push_us / kNumBlocks,
+               resampler.use_sinc_resampler() ? "sinc" : "old resampler");
+      }
+    }
+  }
+}
+
 }  // namespace webrtc
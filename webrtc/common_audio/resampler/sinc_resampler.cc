@@ -79,17 +79,19 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
       read_cb_(read_cb),
       block_size_(block_size),
       buffer_size_(block_size_ + kKernelSize),
-      // Create input buffers with a 16-byte alignment for SSE optimizations.
+      // Create input buffers with a 32-byte alignment for AVX optimizations.
       kernel_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_pre_sinc_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_window_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       input_buffer_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * buffer_size_, 16))),
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE__)
-      convolve_proc_(WebRtc_GetCPUInfo(kSSE2) ? Convolve_SSE : Convolve_C),
+          AlignedMalloc(sizeof(float) * buffer_size_, 32))),
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+      convolve_proc_(WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3) ?
+                     Convolve_AVX2 : WebRtc_GetCPUInfo(kSSE2) ?
+                     Convolve_SSE : Convolve_C),
 #elif defined(WEBRTC_ARCH_ARM_V7) && !defined(WEBRTC_ARCH_ARM_NEON)
       convolve_proc_(WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON ?
                      Convolve_NEON : Convolve_C),
@@ -113,17 +115,19 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
       read_cb_(read_cb),
       block_size_(kDefaultBlockSize),
       buffer_size_(kDefaultBufferSize),
-      // Create input buffers with a 16-byte alignment for SSE optimizations.
+      // Create input buffers with a 32-byte alignment for AVX optimizations.
       kernel_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_pre_sinc_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_window_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       input_buffer_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * buffer_size_, 16))),
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE__)
-      convolve_proc_(WebRtc_GetCPUInfo(kSSE2) ? Convolve_SSE : Convolve_C),
+          AlignedMalloc(sizeof(float) * buffer_size_, 32))),
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+      convolve_proc_(WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3) ?
+                     Convolve_AVX2 : WebRtc_GetCPUInfo(kSSE2) ?
+                     Convolve_SSE : Convolve_C),
 #elif defined(WEBRTC_ARCH_ARM_V7) && !defined(WEBRTC_ARCH_ARM_NEON)
       convolve_proc_(WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON ?
                      Convolve_NEON : Convolve_C),
@@ -142,9 +146,9 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
 SincResampler::~SincResampler() {}
 
 void SincResampler::Initialize() {
-  // Ensure kKernelSize is a multiple of 32 for easy SSE optimizations; causes
-  // r0_ and r5_ (used for input) to always be 16-byte aligned by virtue of
-  // input_buffer_ being 16-byte aligned.
+  // Ensure kKernelSize is a multiple of 32 for easy SIMD optimizations; causes
+  // r0_ and r5_ (used for input) to always be 32-byte aligned by virtue of
+  // input_buffer_ being 32-byte aligned.
   COMPILE_ASSERT(kKernelSize % 32 == 0);
   assert(block_size_ > kKernelSize);
   // Basic sanity checks to ensure buffer regions are laid out correctly:
@@ -236,13 +240,9 @@ void SincResampler::SetRatio(double io_sample_rate_ratio) {
 
 // If we know the minimum architecture avoid function hopping for CPU detection.
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-#if defined(__SSE__)
-#define CONVOLVE_FUNC Convolve_SSE
-#else
-// X86 CPU detection required.  |convolve_proc_| will be set upon construction.
-// TODO(dalecurtis): Once Chrome moves to a SSE baseline this can be removed.
+// X86 CPU detection required to pick between the SSE and AVX2 versions.
+// |convolve_proc_| will be set upon construction.
 #define CONVOLVE_FUNC convolve_proc_
-#endif
 #elif defined(WEBRTC_ARCH_ARM_V7)
 #if defined(WEBRTC_ARCH_ARM_NEON)
 #define CONVOLVE_FUNC Convolve_NEON
@@ -280,10 +280,10 @@ void SincResampler::Resample(float* destination, int frames) {
       float* k1 = kernel_storage_.get() + offset_idx * kKernelSize;
       float* k2 = k1 + kKernelSize;
 
-      // Ensure |k1|, |k2| are 16-byte aligned for SIMD usage.  Should always be
-      // true so long as kKernelSize is a multiple of 16.
-      assert((reinterpret_cast<uintptr_t>(k1) & 0x0F) == 0u);
-      assert((reinterpret_cast<uintptr_t>(k2) & 0x0F) == 0u);
+      // Ensure |k1|, |k2| are 32-byte aligned for SIMD usage.  Should always be
+      // true so long as kKernelSize is a multiple of 32.
+      assert((reinterpret_cast<uintptr_t>(k1) & 0x1F) == 0u);
+      assert((reinterpret_cast<uintptr_t>(k2) & 0x1F) == 0u);
 
       // Initialize input pointer based on quantized |virtual_source_idx_|.
       float* input_ptr = r1_ + source_idx;
@@ -101,14 +101,18 @@ class SincResampler {
 
   // Compute convolution of |k1| and |k2| over |input_ptr|, resultant sums are
   // linearly interpolated using |kernel_interpolation_factor|.  On x86, the
-  // underlying implementation is chosen at run time based on SSE support.  On
-  // ARM, NEON support is chosen at compile time based on compilation flags.
+  // underlying implementation is chosen at run time based on SSE, AVX2 and FMA
+  // support.  On ARM, NEON support is chosen at compile time based on
+  // compilation flags.
   static float Convolve_C(const float* input_ptr, const float* k1,
                           const float* k2, double kernel_interpolation_factor);
 #if defined(WEBRTC_ARCH_X86_FAMILY)
   static float Convolve_SSE(const float* input_ptr, const float* k1,
                             const float* k2,
                             double kernel_interpolation_factor);
+  static float Convolve_AVX2(const float* input_ptr, const float* k1,
+                             const float* k2,
+                             double kernel_interpolation_factor);
 #elif defined(WEBRTC_ARCH_ARM_V7)
   static float Convolve_NEON(const float* input_ptr, const float* k1,
                              const float* k2,
@@ -145,7 +149,7 @@ class SincResampler {
   scoped_ptr_malloc<float, AlignedFree> input_buffer_;
 
   // Stores the runtime selection of which Convolve function to use.
-#if (defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE__)) ||  \
+#if defined(WEBRTC_ARCH_X86_FAMILY) ||  \
     (defined(WEBRTC_ARCH_ARM_V7) && !defined(WEBRTC_ARCH_ARM_NEON))
   typedef float (*ConvolveProc)(const float*, const float*, const float*,
                                 double);
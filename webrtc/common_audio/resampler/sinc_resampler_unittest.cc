@@ -141,6 +141,15 @@ TEST(SincResamplerTest, Convolve) {
       resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
       resampler.kernel_storage_.get(), kKernelInterpolationFactor);
   EXPECT_NEAR(result2, result, kEpsilon);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3)) {
+    result2 = resampler.Convolve_AVX2(
+        resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+    EXPECT_NEAR(result2, result, kEpsilon);
+  }
+#endif
 }
 #endif
 
@@ -204,6 +213,23 @@ TEST(SincResamplerTest, ConvolveBenchmark) {
          total_time_c_us / total_time_optimized_aligned_us,
          total_time_optimized_unaligned_us / total_time_optimized_aligned_us);
 #endif
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3)) {
+    // Benchmark Convolve_AVX2(), which only requires aligned kernels.
+    start = TickTime::Now();
+    for (int j = 0; j < kConvolveIterations; ++j) {
+      resampler.Convolve_AVX2(
+          resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+          resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+    }
+    double total_time_avx2_us = (TickTime::Now() - start).Microseconds();
+    printf("Convolve_AVX2 took %.2fms; which is %.2fx faster than Convolve_C "
+           "and %.2fx faster than " STRINGIZE(CONVOLVE_FUNC) " (unaligned).\n",
+           total_time_avx2_us / 1000, total_time_c_us / total_time_avx2_us,
+           total_time_optimized_unaligned_us / total_time_avx2_us);
+  }
+#endif
 }
 
 #undef CONVOLVE_FUNC
@@ -328,7 +354,7 @@ INSTANTIATE_TEST_CASE_P(
         std::tr1::make_tuple(16000, 44100, kResamplingRMSError, -62.54),
         std::tr1::make_tuple(22050, 44100, kResamplingRMSError, -73.53),
         std::tr1::make_tuple(32000, 44100, kResamplingRMSError, -63.32),
-        std::tr1::make_tuple(44100, 44100, kResamplingRMSError, -73.53),
+        std::tr1::make_tuple(44100, 44100, kResamplingRMSError, -73.52),
         std::tr1::make_tuple(48000, 44100, -15.01, -64.04),
         std::tr1::make_tuple(96000, 44100, -18.49, -25.51),
         std::tr1::make_tuple(192000, 44100, -20.50, -13.31),
@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+/* AVX2 version of WebRtcSpl_CrossCorrelation(), bit-exact with the C version.
+ * See cross_correlation_sse2.c. */
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2) {
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  int i = 0, j = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    const int16_t* seq2_ptr = &seq2[step_seq2 * i];
+    __m256i sum = _mm256_setzero_si256();
+    __m128i sum128;
+    int32_t total = 0;
+
+    j = 0;
+    if (right_shifts == 0) {
+      for (; j <= dim_seq - 16; j += 16) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)&seq1[j]);
+        const __m256i b = _mm256_loadu_si256((const __m256i*)&seq2_ptr[j]);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+      }
+    } else {
+      for (; j <= dim_seq - 16; j += 16) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)&seq1[j]);
+        const __m256i b = _mm256_loadu_si256((const __m256i*)&seq2_ptr[j]);
+        const __m256i low = _mm256_mullo_epi16(a, b);
+        const __m256i high = _mm256_mulhi_epi16(a, b);
+        sum = _mm256_add_epi32(
+            sum, _mm256_sra_epi32(_mm256_unpacklo_epi16(low, high), shift));
+        sum = _mm256_add_epi32(
+            sum, _mm256_sra_epi32(_mm256_unpackhi_epi16(low, high), shift));
+      }
+    }
+    sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                           _mm256_extracti128_si256(sum, 1));
+    sum128 = _mm_add_epi32(sum128, _mm_srli_si128(sum128, 8));
+    sum128 = _mm_add_epi32(sum128, _mm_srli_si128(sum128, 4));
+    total = _mm_cvtsi128_si32(sum128);
+
+    for (; j < dim_seq; j++) {
+      total += (seq1[j] * seq2_ptr[j]) >> right_shifts;
+    }
+    *cross_correlation++ = total;
+  }
+}
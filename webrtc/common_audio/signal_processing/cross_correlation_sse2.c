@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+/* SSE2 version of WebRtcSpl_CrossCorrelation(), bit-exact with the C version.
+ * The C version shifts every product before accumulating it, so the products
+ * are only summed pairwise (pmaddwd) when there is no shift. */
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2) {
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  int i = 0, j = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    const int16_t* seq2_ptr = &seq2[step_seq2 * i];
+    __m128i sum = _mm_setzero_si128();
+    int32_t total = 0;
+
+    j = 0;
+    if (right_shifts == 0) {
+      for (; j <= dim_seq - 8; j += 8) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)&seq1[j]);
+        const __m128i b = _mm_loadu_si128((const __m128i*)&seq2_ptr[j]);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, b));
+      }
+    } else {
+      for (; j <= dim_seq - 8; j += 8) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)&seq1[j]);
+        const __m128i b = _mm_loadu_si128((const __m128i*)&seq2_ptr[j]);
+        const __m128i low = _mm_mullo_epi16(a, b);
+        const __m128i high = _mm_mulhi_epi16(a, b);
+        sum = _mm_add_epi32(sum, _mm_sra_epi32(_mm_unpacklo_epi16(low, high),
+                                               shift));
+        sum = _mm_add_epi32(sum, _mm_sra_epi32(_mm_unpackhi_epi16(low, high),
+                                               shift));
+      }
+    }
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+    total = _mm_cvtsi128_si32(sum);
+
+    for (; j < dim_seq; j++) {
+      total += (seq1[j] * seq2_ptr[j]) >> right_shifts;
+    }
+    *cross_correlation++ = total;
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+// Longest filter handled with SIMD; longer ones use the C version.
+#define MAX_COEFFICIENTS_LENGTH 64
+
+// Loads eight samples from |low| and from |high| into the two 128-bit lanes.
+static __m256i LoadLanes(const int16_t* low, const int16_t* high) {
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)low)),
+      _mm_loadu_si128((const __m128i*)high), 1);
+}
+
+// AVX2 version of WebRtcSpl_DownsampleFast(), bit-exact with the C version.
+// See downsample_fast_sse2.c. Eight outputs are computed at a time, with
+// output n in the low lane and output n + 4 in the high lane of a register.
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay) {
+  int16_t reversed[MAX_COEFFICIENTS_LENGTH];
+  const __m256i round = _mm256_set1_epi32(2048);  // 0.5 in Q12.
+  int padded_length = (coefficients_length + 7) & ~7;
+  int last_padded_pos = 0;
+  int i = 0;
+  int j = 0;
+  int32_t out_s32 = 0;
+  int endpos = delay + factor * (data_out_length - 1) + 1;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length <= 0 || coefficients_length <= 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+  if (padded_length > MAX_COEFFICIENTS_LENGTH) {
+    return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                     data_out_length, coefficients,
+                                     coefficients_length, factor, delay);
+  }
+
+  for (j = 0; j < coefficients_length; j++) {
+    reversed[j] = coefficients[coefficients_length - 1 - j];
+  }
+  for (; j < padded_length; j++) {
+    reversed[j] = 0;
+  }
+
+  // The last position whose padded dot product stays within |data_in|.
+  last_padded_pos = data_in_length - 1 - (padded_length - coefficients_length);
+  for (i = delay; i + 7 * factor < endpos &&
+       i + 7 * factor <= last_padded_pos; i += 8 * factor) {
+    const int16_t* in0 = &data_in[i - coefficients_length + 1];
+    const int16_t* in4 = in0 + 4 * factor;
+    __m256i sum0 = _mm256_setzero_si256();
+    __m256i sum1 = _mm256_setzero_si256();
+    __m256i sum2 = _mm256_setzero_si256();
+    __m256i sum3 = _mm256_setzero_si256();
+    __m256i sum01, sum23, out;
+
+    for (j = 0; j < padded_length; j += 8) {
+      const __m128i c128 = _mm_loadu_si128((const __m128i*)&reversed[j]);
+      const __m256i c = _mm256_inserti128_si256(
+          _mm256_castsi128_si256(c128), c128, 1);
+      sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(
+          c, LoadLanes(&in0[j], &in4[j])));
+      sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(
+          c, LoadLanes(&in0[j + factor], &in4[j + factor])));
+      sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(
+          c, LoadLanes(&in0[j + 2 * factor], &in4[j + 2 * factor])));
+      sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(
+          c, LoadLanes(&in0[j + 3 * factor], &in4[j + 3 * factor])));
+    }
+
+    // Transpose and add within each lane, leaving outputs 0 to 3 in the low
+    // lane and 4 to 7 in the high lane.
+    sum01 = _mm256_add_epi32(_mm256_unpacklo_epi32(sum0, sum1),
+                             _mm256_unpackhi_epi32(sum0, sum1));
+    sum23 = _mm256_add_epi32(_mm256_unpacklo_epi32(sum2, sum3),
+                             _mm256_unpackhi_epi32(sum2, sum3));
+    out = _mm256_add_epi32(_mm256_unpacklo_epi64(sum01, sum23),
+                           _mm256_unpackhi_epi64(sum01, sum23));
+    out = _mm256_srai_epi32(_mm256_add_epi32(out, round), 12);  // Q0.
+
+    // Saturate, gather the low 64 bits of both lanes and store the output.
+    out = _mm256_permute4x64_epi64(_mm256_packs_epi32(out, out), 0x08);
+    _mm_storeu_si128((__m128i*)data_out, _mm256_castsi256_si128(out));
+    data_out += 8;
+  }
+
+  for (; i < endpos; i += factor) {
+    out_s32 = 2048;  // Round value, 0.5 in Q12.
+
+    for (j = 0; j < coefficients_length; j++) {
+      out_s32 += coefficients[j] * data_in[i - j];  // Q12.
+    }
+
+    out_s32 >>= 12;  // Q0.
+
+    // Saturate and store the output.
+    *data_out++ = WebRtcSpl_SatW32ToW16(out_s32);
+  }
+
+  return 0;
+}
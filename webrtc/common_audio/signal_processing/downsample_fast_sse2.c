@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+// Longest filter handled with SIMD; longer ones use the C version.
+#define MAX_COEFFICIENTS_LENGTH 64
+
+// SSE2 version of WebRtcSpl_DownsampleFast(), bit-exact with the C version.
+//
+// The coefficients are reversed and zero padded to a multiple of eight, so
+// that every output is a dot product of contiguous vectors. Four outputs are
+// computed at a time. The padding makes the dot products read up to seven
+// samples past the last one used by the filter, so the last few outputs are
+// computed as in the C version.
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay) {
+  int16_t reversed[MAX_COEFFICIENTS_LENGTH];
+  const __m128i round = _mm_set1_epi32(2048);  // 0.5 in Q12.
+  int padded_length = (coefficients_length + 7) & ~7;
+  int last_padded_pos = 0;
+  int i = 0;
+  int j = 0;
+  int32_t out_s32 = 0;
+  int endpos = delay + factor * (data_out_length - 1) + 1;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length <= 0 || coefficients_length <= 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+  if (padded_length > MAX_COEFFICIENTS_LENGTH) {
+    return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                     data_out_length, coefficients,
+                                     coefficients_length, factor, delay);
+  }
+
+  for (j = 0; j < coefficients_length; j++) {
+    reversed[j] = coefficients[coefficients_length - 1 - j];
+  }
+  for (; j < padded_length; j++) {
+    reversed[j] = 0;
+  }
+
+  // The last position whose padded dot product stays within |data_in|.
+  last_padded_pos = data_in_length - 1 - (padded_length - coefficients_length);
+  for (i = delay; i + 3 * factor < endpos &&
+       i + 3 * factor <= last_padded_pos; i += 4 * factor) {
+    const int16_t* in0 = &data_in[i - coefficients_length + 1];
+    const int16_t* in1 = in0 + factor;
+    const int16_t* in2 = in1 + factor;
+    const int16_t* in3 = in2 + factor;
+    __m128i sum0 = _mm_setzero_si128();
+    __m128i sum1 = _mm_setzero_si128();
+    __m128i sum2 = _mm_setzero_si128();
+    __m128i sum3 = _mm_setzero_si128();
+    __m128i sum01, sum23, out;
+
+    for (j = 0; j < padded_length; j += 8) {
+      const __m128i c = _mm_loadu_si128((const __m128i*)&reversed[j]);
+      sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(
+          c, _mm_loadu_si128((const __m128i*)&in0[j])));
+      sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(
+          c, _mm_loadu_si128((const __m128i*)&in1[j])));
+      sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(
+          c, _mm_loadu_si128((const __m128i*)&in2[j])));
+      sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(
+          c, _mm_loadu_si128((const __m128i*)&in3[j])));
+    }
+
+    // Transpose and add, leaving the four sums in order.
+    sum01 = _mm_add_epi32(_mm_unpacklo_epi32(sum0, sum1),
+                          _mm_unpackhi_epi32(sum0, sum1));
+    sum23 = _mm_add_epi32(_mm_unpacklo_epi32(sum2, sum3),
+                          _mm_unpackhi_epi32(sum2, sum3));
+    out = _mm_add_epi32(_mm_unpacklo_epi64(sum01, sum23),
+                        _mm_unpackhi_epi64(sum01, sum23));
+    out = _mm_srai_epi32(_mm_add_epi32(out, round), 12);  // Q0.
+
+    // Saturate and store the output.
+    _mm_storel_epi64((__m128i*)data_out, _mm_packs_epi32(out, out));
+    data_out += 4;
+  }
+
+  for (; i < endpos; i += factor) {
+    out_s32 = 2048;  // Round value, 0.5 in Q12.
+
+    for (j = 0; j < coefficients_length; j++) {
+      out_s32 += coefficients[j] * data_in[i - j];  // Q12.
+    }
+
+    out_s32 >>= 12;  // Q0.
+
+    // Saturate and store the output.
+    *data_out++ = WebRtcSpl_SatW32ToW16(out_s32);
+  }
+
+  return 0;
+}
@@ -224,6 +224,10 @@ int16_t WebRtcSpl_MaxAbsValueW16Neon(const int16_t* vector, int length);
 #if defined(MIPS32_LE)
 int16_t WebRtcSpl_MaxAbsValueW16_mips(const int16_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MaxAbsValueW16SSE2(const int16_t* vector, int length);
+int16_t WebRtcSpl_MaxAbsValueW16AVX2(const int16_t* vector, int length);
+#endif
 
 // Returns the largest absolute value in a signed 32-bit vector.
 //
@@ -242,6 +246,10 @@ int32_t WebRtcSpl_MaxAbsValueW32Neon(const int32_t* vector, int length);
 #if defined(MIPS_DSP_R1_LE)
 int32_t WebRtcSpl_MaxAbsValueW32_mips(const int32_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MaxAbsValueW32SSE2(const int32_t* vector, int length);
+int32_t WebRtcSpl_MaxAbsValueW32AVX2(const int32_t* vector, int length);
+#endif
 
 // Returns the maximum value of a 16-bit vector.
 //
@@ -262,6 +270,10 @@ int16_t WebRtcSpl_MaxValueW16Neon(const int16_t* vector, int length);
 #if defined(MIPS32_LE)
 int16_t WebRtcSpl_MaxValueW16_mips(const int16_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MaxValueW16SSE2(const int16_t* vector, int length);
+int16_t WebRtcSpl_MaxValueW16AVX2(const int16_t* vector, int length);
+#endif
 
 // Returns the maximum value of a 32-bit vector.
 //
@@ -282,6 +294,10 @@ int32_t WebRtcSpl_MaxValueW32Neon(const int32_t* vector, int length);
 #if defined(MIPS32_LE)
 int32_t WebRtcSpl_MaxValueW32_mips(const int32_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MaxValueW32SSE2(const int32_t* vector, int length);
+int32_t WebRtcSpl_MaxValueW32AVX2(const int32_t* vector, int length);
+#endif
 
 // Returns the minimum value of a 16-bit vector.
 //
@@ -302,6 +318,10 @@ int16_t WebRtcSpl_MinValueW16Neon(const int16_t* vector, int length);
 #if defined(MIPS32_LE)
 int16_t WebRtcSpl_MinValueW16_mips(const int16_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MinValueW16SSE2(const int16_t* vector, int length);
+int16_t WebRtcSpl_MinValueW16AVX2(const int16_t* vector, int length);
+#endif
 
 // Returns the minimum value of a 32-bit vector.
 //
@@ -322,6 +342,10 @@ int32_t WebRtcSpl_MinValueW32Neon(const int32_t* vector, int length);
 #if defined(MIPS32_LE)
 int32_t WebRtcSpl_MinValueW32_mips(const int32_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MinValueW32SSE2(const int32_t* vector, int length);
+int32_t WebRtcSpl_MinValueW32AVX2(const int32_t* vector, int length);
+#endif
 
 // Returns the vector index to the largest absolute value of a 16-bit vector.
 //
@@ -456,6 +480,22 @@ int WebRtcSpl_ScaleAndAddVectorsWithRoundNeon(const int16_t* in_vector1,
                                               int16_t* out_vector,
                                               int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length);
+int WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length);
+#endif
 // End: Vector scaling operations.
 
 // iLBC specific functions. Implementations in ilbc_specific_functions.c.
@@ -627,6 +667,22 @@ void WebRtcSpl_CrossCorrelationNeon(int32_t* cross_correlation,
                                     int16_t right_shifts,
                                     int16_t step_seq2);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2);
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2);
+#endif
 
 // Creates (the first half of) a Hanning window. Size must be at least 1 and
 // at most 512.
@@ -771,6 +827,24 @@ int WebRtcSpl_DownsampleFastNeon(const int16_t* data_in,
                                  int factor,
                                  int delay);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay);
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay);
+#endif
 
 // End: Filter operations.
 
@@ -69,7 +69,8 @@ int32_t WebRtcSpl_MaxAbsValueW32C(const int32_t* vector, int length) {
   }
 
   for (i = 0; i < length; i++) {
-    absolute = abs((int)vector[i]);
+    // abs() of WEBRTC_SPL_WORD32_MIN is undefined; negate as unsigned.
+    absolute = vector[i] < 0 ? 0u - (uint32_t)vector[i] : (uint32_t)vector[i];
     if (absolute > maximum) {
       maximum = absolute;
     }
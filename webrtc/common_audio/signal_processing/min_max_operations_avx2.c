@@ -0,0 +1,207 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 versions of the functions in
+ * min_max_operations.c. They are bit-exact with the C versions.
+ */
+
+#include <immintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+static int16_t HorizontalMaxW16(__m256i v) {
+  __m128i m = _mm_max_epi16(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  m = _mm_max_epi16(m, _mm_srli_si128(m, 8));
+  m = _mm_max_epi16(m, _mm_srli_si128(m, 4));
+  m = _mm_max_epi16(m, _mm_srli_si128(m, 2));
+  return (int16_t)_mm_cvtsi128_si32(m);
+}
+
+static int16_t HorizontalMinW16(__m256i v) {
+  __m128i m = _mm_min_epi16(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  m = _mm_min_epi16(m, _mm_srli_si128(m, 8));
+  m = _mm_min_epi16(m, _mm_srli_si128(m, 4));
+  m = _mm_min_epi16(m, _mm_srli_si128(m, 2));
+  return (int16_t)_mm_cvtsi128_si32(m);
+}
+
+static int32_t HorizontalMaxW32(__m256i v) {
+  __m128i m = _mm_max_epi32(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  m = _mm_max_epi32(m, _mm_srli_si128(m, 8));
+  m = _mm_max_epi32(m, _mm_srli_si128(m, 4));
+  return _mm_cvtsi128_si32(m);
+}
+
+static int32_t HorizontalMinW32(__m256i v) {
+  __m128i m = _mm_min_epi32(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  m = _mm_min_epi32(m, _mm_srli_si128(m, 8));
+  m = _mm_min_epi32(m, _mm_srli_si128(m, 4));
+  return _mm_cvtsi128_si32(m);
+}
+
+// Maximum absolute value of word16 vector. AVX2 version.
+int16_t WebRtcSpl_MaxAbsValueW16AVX2(const int16_t* vector, int length) {
+  __m256i maximum_vector = _mm256_setzero_si256();
+  __m256i minimum_vector = _mm256_setzero_si256();
+  int maximum = 0, minimum = 0;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  // The largest absolute value is that of the maximum or the minimum, which
+  // avoids the overflow of abs(-32768) in 16 bits.
+  for (; i <= length - 16; i += 16) {
+    const __m256i v = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    maximum_vector = _mm256_max_epi16(maximum_vector, v);
+    minimum_vector = _mm256_min_epi16(minimum_vector, v);
+  }
+  maximum = HorizontalMaxW16(maximum_vector);
+  minimum = HorizontalMinW16(minimum_vector);
+  for (; i < length; i++) {
+    maximum = WEBRTC_SPL_MAX(maximum, vector[i]);
+    minimum = WEBRTC_SPL_MIN(minimum, vector[i]);
+  }
+
+  maximum = WEBRTC_SPL_MAX(maximum, -minimum);
+  // Guard the case for abs(-32768).
+  if (maximum > WEBRTC_SPL_WORD16_MAX) {
+    maximum = WEBRTC_SPL_WORD16_MAX;
+  }
+
+  return (int16_t)maximum;
+}
+
+// Maximum absolute value of word32 vector. AVX2 version.
+int32_t WebRtcSpl_MaxAbsValueW32AVX2(const int32_t* vector, int length) {
+  __m256i maximum_vector = _mm256_setzero_si256();
+  uint32_t absolute = 0, maximum = 0;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  for (; i <= length - 8; i += 8) {
+    __m256i absolute_vector = _mm256_abs_epi32(
+        _mm256_loadu_si256((const __m256i*)&vector[i]));
+    // abs(0x80000000) is 0x80000000; subtracting one for it saturates it to
+    // WEBRTC_SPL_WORD32_MAX, as the C version does at the end.
+    absolute_vector = _mm256_add_epi32(absolute_vector,
+                                       _mm256_srai_epi32(absolute_vector, 31));
+    maximum_vector = _mm256_max_epi32(maximum_vector, absolute_vector);
+  }
+  maximum = (uint32_t)HorizontalMaxW32(maximum_vector);
+  for (; i < length; i++) {
+    // abs() of WEBRTC_SPL_WORD32_MIN is undefined; negate as unsigned.
+    absolute = vector[i] < 0 ? 0u - (uint32_t)vector[i] : (uint32_t)vector[i];
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+
+  maximum = WEBRTC_SPL_MIN(maximum, WEBRTC_SPL_WORD32_MAX);
+
+  return (int32_t)maximum;
+}
+
+// Maximum value of word16 vector. AVX2 version.
+int16_t WebRtcSpl_MaxValueW16AVX2(const int16_t* vector, int length) {
+  __m256i maximum_vector = _mm256_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  int16_t maximum = WEBRTC_SPL_WORD16_MIN;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return maximum;
+  }
+
+  for (; i <= length - 16; i += 16) {
+    maximum_vector = _mm256_max_epi16(
+        maximum_vector, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  maximum = HorizontalMaxW16(maximum_vector);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+// Maximum value of word32 vector. AVX2 version.
+int32_t WebRtcSpl_MaxValueW32AVX2(const int32_t* vector, int length) {
+  __m256i maximum_vector = _mm256_set1_epi32(WEBRTC_SPL_WORD32_MIN);
+  int32_t maximum = WEBRTC_SPL_WORD32_MIN;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return maximum;
+  }
+
+  for (; i <= length - 8; i += 8) {
+    maximum_vector = _mm256_max_epi32(
+        maximum_vector, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  maximum = HorizontalMaxW32(maximum_vector);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+// Minimum value of word16 vector. AVX2 version.
+int16_t WebRtcSpl_MinValueW16AVX2(const int16_t* vector, int length) {
+  __m256i minimum_vector = _mm256_set1_epi16(WEBRTC_SPL_WORD16_MAX);
+  int16_t minimum = WEBRTC_SPL_WORD16_MAX;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return minimum;
+  }
+
+  for (; i <= length - 16; i += 16) {
+    minimum_vector = _mm256_min_epi16(
+        minimum_vector, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  minimum = HorizontalMinW16(minimum_vector);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
+
+// Minimum value of word32 vector. AVX2 version.
+int32_t WebRtcSpl_MinValueW32AVX2(const int32_t* vector, int length) {
+  __m256i minimum_vector = _mm256_set1_epi32(WEBRTC_SPL_WORD32_MAX);
+  int32_t minimum = WEBRTC_SPL_WORD32_MAX;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return minimum;
+  }
+
+  for (; i <= length - 8; i += 8) {
+    minimum_vector = _mm256_min_epi32(
+        minimum_vector, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  minimum = HorizontalMinW32(minimum_vector);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
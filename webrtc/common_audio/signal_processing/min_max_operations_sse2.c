@@ -0,0 +1,213 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the SSE2 versions of the functions in
+ * min_max_operations.c. They are bit-exact with the C versions.
+ */
+
+#include <emmintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+static int16_t HorizontalMaxW16(__m128i v) {
+  v = _mm_max_epi16(v, _mm_srli_si128(v, 8));
+  v = _mm_max_epi16(v, _mm_srli_si128(v, 4));
+  v = _mm_max_epi16(v, _mm_srli_si128(v, 2));
+  return (int16_t)_mm_cvtsi128_si32(v);
+}
+
+static int16_t HorizontalMinW16(__m128i v) {
+  v = _mm_min_epi16(v, _mm_srli_si128(v, 8));
+  v = _mm_min_epi16(v, _mm_srli_si128(v, 4));
+  v = _mm_min_epi16(v, _mm_srli_si128(v, 2));
+  return (int16_t)_mm_cvtsi128_si32(v);
+}
+
+// SSE2 has no 32-bit min and max instructions; select with a comparison.
+static __m128i MaxW32(__m128i a, __m128i b) {
+  const __m128i greater = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(greater, a),
+                      _mm_andnot_si128(greater, b));
+}
+
+static __m128i MinW32(__m128i a, __m128i b) {
+  const __m128i greater = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(greater, b),
+                      _mm_andnot_si128(greater, a));
+}
+
+static int32_t HorizontalMaxW32(__m128i v) {
+  v = MaxW32(v, _mm_srli_si128(v, 8));
+  v = MaxW32(v, _mm_srli_si128(v, 4));
+  return _mm_cvtsi128_si32(v);
+}
+
+static int32_t HorizontalMinW32(__m128i v) {
+  v = MinW32(v, _mm_srli_si128(v, 8));
+  v = MinW32(v, _mm_srli_si128(v, 4));
+  return _mm_cvtsi128_si32(v);
+}
+
+// Maximum absolute value of word16 vector. SSE2 version.
+int16_t WebRtcSpl_MaxAbsValueW16SSE2(const int16_t* vector, int length) {
+  __m128i maximum_vector = _mm_setzero_si128();
+  __m128i minimum_vector = _mm_setzero_si128();
+  int maximum = 0, minimum = 0;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  // The largest absolute value is that of the maximum or the minimum, which
+  // avoids the overflow of abs(-32768) in 16 bits.
+  for (; i <= length - 8; i += 8) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)&vector[i]);
+    maximum_vector = _mm_max_epi16(maximum_vector, v);
+    minimum_vector = _mm_min_epi16(minimum_vector, v);
+  }
+  maximum = HorizontalMaxW16(maximum_vector);
+  minimum = HorizontalMinW16(minimum_vector);
+  for (; i < length; i++) {
+    maximum = WEBRTC_SPL_MAX(maximum, vector[i]);
+    minimum = WEBRTC_SPL_MIN(minimum, vector[i]);
+  }
+
+  maximum = WEBRTC_SPL_MAX(maximum, -minimum);
+  // Guard the case for abs(-32768).
+  if (maximum > WEBRTC_SPL_WORD16_MAX) {
+    maximum = WEBRTC_SPL_WORD16_MAX;
+  }
+
+  return (int16_t)maximum;
+}
+
+// Maximum absolute value of word32 vector. SSE2 version.
+int32_t WebRtcSpl_MaxAbsValueW32SSE2(const int32_t* vector, int length) {
+  __m128i maximum_vector = _mm_setzero_si128();
+  uint32_t absolute = 0, maximum = 0;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  for (; i <= length - 4; i += 4) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)&vector[i]);
+    const __m128i sign = _mm_srai_epi32(v, 31);
+    __m128i absolute_vector = _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+    // abs(0x80000000) is 0x80000000; subtracting one for it saturates it to
+    // WEBRTC_SPL_WORD32_MAX, as the C version does at the end.
+    absolute_vector = _mm_add_epi32(absolute_vector,
+                                    _mm_srai_epi32(absolute_vector, 31));
+    maximum_vector = MaxW32(maximum_vector, absolute_vector);
+  }
+  maximum = (uint32_t)HorizontalMaxW32(maximum_vector);
+  for (; i < length; i++) {
+    // abs() of WEBRTC_SPL_WORD32_MIN is undefined; negate as unsigned.
+    absolute = vector[i] < 0 ? 0u - (uint32_t)vector[i] : (uint32_t)vector[i];
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+
+  maximum = WEBRTC_SPL_MIN(maximum, WEBRTC_SPL_WORD32_MAX);
+
+  return (int32_t)maximum;
+}
+
+// Maximum value of word16 vector. SSE2 version.
+int16_t WebRtcSpl_MaxValueW16SSE2(const int16_t* vector, int length) {
+  __m128i maximum_vector = _mm_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  int16_t maximum = WEBRTC_SPL_WORD16_MIN;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return maximum;
+  }
+
+  for (; i <= length - 8; i += 8) {
+    maximum_vector = _mm_max_epi16(
+        maximum_vector, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  maximum = HorizontalMaxW16(maximum_vector);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+// Maximum value of word32 vector. SSE2 version.
+int32_t WebRtcSpl_MaxValueW32SSE2(const int32_t* vector, int length) {
+  __m128i maximum_vector = _mm_set1_epi32(WEBRTC_SPL_WORD32_MIN);
+  int32_t maximum = WEBRTC_SPL_WORD32_MIN;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return maximum;
+  }
+
+  for (; i <= length - 4; i += 4) {
+    maximum_vector = MaxW32(
+        maximum_vector, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  maximum = HorizontalMaxW32(maximum_vector);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+// Minimum value of word16 vector. SSE2 version.
+int16_t WebRtcSpl_MinValueW16SSE2(const int16_t* vector, int length) {
+  __m128i minimum_vector = _mm_set1_epi16(WEBRTC_SPL_WORD16_MAX);
+  int16_t minimum = WEBRTC_SPL_WORD16_MAX;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return minimum;
+  }
+
+  for (; i <= length - 8; i += 8) {
+    minimum_vector = _mm_min_epi16(
+        minimum_vector, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  minimum = HorizontalMinW16(minimum_vector);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
+
+// Minimum value of word32 vector. SSE2 version.
+int32_t WebRtcSpl_MinValueW32SSE2(const int32_t* vector, int length) {
+  __m128i minimum_vector = _mm_set1_epi32(WEBRTC_SPL_WORD32_MAX);
+  int32_t minimum = WEBRTC_SPL_WORD32_MAX;
+  int i = 0;
+
+  if (vector == NULL || length <= 0) {
+    return minimum;
+  }
+
+  for (; i <= length - 4; i += 4) {
+    minimum_vector = MinW32(
+        minimum_vector, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  minimum = HorizontalMinW32(minimum_vector);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
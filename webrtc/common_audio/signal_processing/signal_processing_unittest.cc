@@ -532,9 +532,13 @@ TEST_F(SplTest, CrossCorrelationTest) {
   const int32_t kExpectedNeon[kCrossCorrelationDimension] =
       {-266947901, -15579553, -171281999};
   const int32_t* expected = kExpected;
-  if (WebRtcSpl_CrossCorrelation != WebRtcSpl_CrossCorrelationC) {
+#if defined(WEBRTC_DETECT_ARM_NEON) || defined(WEBRTC_ARCH_ARM_NEON)
+  if (WebRtcSpl_CrossCorrelation == WebRtcSpl_CrossCorrelationNeon) {
     expected = kExpectedNeon;
   }
+#else
+  (void)kExpectedNeon;
+#endif
   for (int i = 0; i < kCrossCorrelationDimension; ++i) {
     EXPECT_EQ(expected[i], vector32[i]);
   }
@@ -9,7 +9,7 @@
  */
 
 /* The global function contained in this file initializes SPL function
- * pointers, currently only for ARM platforms.
+ * pointers, currently for x86, ARM and MIPS platforms.
  *
  * Some code came from common/rtcd.c in the WebM project.
  */
@@ -50,6 +50,39 @@ static void InitPointersToC() {
 }
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+/* Initialize function pointers to the SSE2 version. The FFTs have no SSE2
+ * version and keep the generic C one. */
+static void InitPointersToSSE2() {
+  InitPointersToC();
+  WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16SSE2;
+  WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32SSE2;
+  WebRtcSpl_MaxValueW16 = WebRtcSpl_MaxValueW16SSE2;
+  WebRtcSpl_MaxValueW32 = WebRtcSpl_MaxValueW32SSE2;
+  WebRtcSpl_MinValueW16 = WebRtcSpl_MinValueW16SSE2;
+  WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32SSE2;
+  WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationSSE2;
+  WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastSSE2;
+  WebRtcSpl_ScaleAndAddVectorsWithRound =
+      WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2;
+}
+
+/* Initialize function pointers to the AVX2 version. */
+static void InitPointersToAVX2() {
+  InitPointersToC();
+  WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16AVX2;
+  WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32AVX2;
+  WebRtcSpl_MaxValueW16 = WebRtcSpl_MaxValueW16AVX2;
+  WebRtcSpl_MaxValueW32 = WebRtcSpl_MaxValueW32AVX2;
+  WebRtcSpl_MinValueW16 = WebRtcSpl_MinValueW16AVX2;
+  WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32AVX2;
+  WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationAVX2;
+  WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastAVX2;
+  WebRtcSpl_ScaleAndAddVectorsWithRound =
+      WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2;
+}
+#endif
+
 #if defined(WEBRTC_DETECT_ARM_NEON) || defined(WEBRTC_ARCH_ARM_NEON)
 /* Initialize function pointers to the Neon version. */
 static void InitPointersToNeon() {
@@ -101,6 +134,14 @@ static void InitFunctionPointers(void) {
   InitPointersToNeon();
 #elif defined(MIPS32_LE)
   InitPointersToMIPS();
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    InitPointersToAVX2();
+  } else if (WebRtc_GetCPUInfo(kSSE2)) {
+    InitPointersToSSE2();
+  } else {
+    InitPointersToC();
+  }
 #else
   InitPointersToC();
 #endif  /* WEBRTC_DETECT_ARM_NEON */
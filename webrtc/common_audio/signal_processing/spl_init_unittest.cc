@@ -0,0 +1,479 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Tests of the versions of the SPL functions that WebRtcSpl_Init() selects
+// from, and a benchmark of every function dispatched through a pointer.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "common_audio/signal_processing/include/real_fft.h"
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+#include "gtest/gtest.h"
+#include "system_wrappers/interface/cpu_features_wrapper.h"
+#include "system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+struct SplVersion {
+  const char* name;
+  MaxAbsValueW16 max_abs_value_w16;
+  MaxAbsValueW32 max_abs_value_w32;
+  MaxValueW16 max_value_w16;
+  MaxValueW32 max_value_w32;
+  MinValueW16 min_value_w16;
+  MinValueW32 min_value_w32;
+  CrossCorrelation cross_correlation;
+  DownsampleFast downsample_fast;
+  ScaleAndAddVectorsWithRound scale_and_add_vectors_with_round;
+};
+
+// Returns the versions that can run on this CPU, the C version first. All of
+// them are bit-exact with the C version.
+std::vector<SplVersion> SupportedVersions() {
+  std::vector<SplVersion> versions;
+  SplVersion c = { "C",
+                   WebRtcSpl_MaxAbsValueW16C,
+                   WebRtcSpl_MaxAbsValueW32C,
+                   WebRtcSpl_MaxValueW16C,
+                   WebRtcSpl_MaxValueW32C,
+                   WebRtcSpl_MinValueW16C,
+                   WebRtcSpl_MinValueW32C,
+                   WebRtcSpl_CrossCorrelationC,
+                   WebRtcSpl_DownsampleFastC,
+                   WebRtcSpl_ScaleAndAddVectorsWithRoundC };
+  versions.push_back(c);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    SplVersion sse2 = { "SSE2",
+                        WebRtcSpl_MaxAbsValueW16SSE2,
+                        WebRtcSpl_MaxAbsValueW32SSE2,
+                        WebRtcSpl_MaxValueW16SSE2,
+                        WebRtcSpl_MaxValueW32SSE2,
+                        WebRtcSpl_MinValueW16SSE2,
+                        WebRtcSpl_MinValueW32SSE2,
+                        WebRtcSpl_CrossCorrelationSSE2,
+                        WebRtcSpl_DownsampleFastSSE2,
+                        WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2 };
+    versions.push_back(sse2);
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    SplVersion avx2 = { "AVX2",
+                        WebRtcSpl_MaxAbsValueW16AVX2,
+                        WebRtcSpl_MaxAbsValueW32AVX2,
+                        WebRtcSpl_MaxValueW16AVX2,
+                        WebRtcSpl_MaxValueW32AVX2,
+                        WebRtcSpl_MinValueW16AVX2,
+                        WebRtcSpl_MinValueW32AVX2,
+                        WebRtcSpl_CrossCorrelationAVX2,
+                        WebRtcSpl_DownsampleFastAVX2,
+                        WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2 };
+    versions.push_back(avx2);
+  }
+#endif
+  return versions;
+}
+
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  uint32_t Next() {
+    state_ = state_ * 1664525 + 1013904223;
+    return state_;
+  }
+
+  // Returns a value in [-|limit|, |limit|], or one of the extremes of the
+  // 16-bit range every eighth time on average.
+  int16_t NextW16(int limit) {
+    const uint32_t r = Next();
+    switch (r >> 29) {
+      case 0: return WEBRTC_SPL_WORD16_MIN;
+      case 1: return WEBRTC_SPL_WORD16_MAX;
+      default: return static_cast<int16_t>(
+          static_cast<int>((r >> 8) % (2 * limit + 1)) - limit);
+    }
+  }
+
+  int32_t NextW32() {
+    const uint32_t r = Next();
+    switch (r & 7) {
+      case 0: return WEBRTC_SPL_WORD32_MIN;
+      case 1: return WEBRTC_SPL_WORD32_MAX;
+      default: return static_cast<int32_t>((r << 16) ^ Next());
+    }
+  }
+
+  void Fill(int16_t* data, int length) {
+    for (int i = 0; i < length; i++) {
+      data[i] = NextW16(WEBRTC_SPL_WORD16_MAX);
+    }
+  }
+
+  void Fill(int32_t* data, int length) {
+    for (int i = 0; i < length; i++) {
+      data[i] = NextW32();
+    }
+  }
+
+ private:
+  uint32_t state_;
+};
+
+class SplInitTest : public ::testing::Test {
+ protected:
+  SplInitTest() : versions_(SupportedVersions()) {
+    WebRtcSpl_Init();
+  }
+
+  const std::vector<SplVersion> versions_;
+};
+
+TEST_F(SplInitTest, MinMaxOperationsAreBitExact) {
+  const int kMaxLength = 100;
+  const int kMaxOffset = 8;
+  int16_t vector16[kMaxLength + kMaxOffset];
+  int32_t vector32[kMaxLength + kMaxOffset];
+  Random random(17);
+  const SplVersion& c = versions_[0];
+
+  for (size_t v = 1; v < versions_.size(); v++) {
+    const SplVersion& version = versions_[v];
+    EXPECT_EQ(-1, version.max_abs_value_w16(NULL, 16));
+    EXPECT_EQ(-1, version.max_abs_value_w32(vector32, 0));
+    EXPECT_EQ(WEBRTC_SPL_WORD16_MIN, version.max_value_w16(vector16, 0));
+    EXPECT_EQ(WEBRTC_SPL_WORD32_MIN, version.max_value_w32(NULL, 8));
+    EXPECT_EQ(WEBRTC_SPL_WORD16_MAX, version.min_value_w16(NULL, 16));
+    EXPECT_EQ(WEBRTC_SPL_WORD32_MAX, version.min_value_w32(vector32, -1));
+
+    for (int length = 1; length <= kMaxLength; length++) {
+      for (int offset = 0; offset < kMaxOffset; offset++) {
+        random.Fill(vector16, kMaxLength + kMaxOffset);
+        random.Fill(vector32, kMaxLength + kMaxOffset);
+        const int16_t* in16 = &vector16[offset];
+        const int32_t* in32 = &vector32[offset];
+        ASSERT_EQ(c.max_abs_value_w16(in16, length),
+                  version.max_abs_value_w16(in16, length))
+            << version.name << " length " << length;
+        ASSERT_EQ(c.max_abs_value_w32(in32, length),
+                  version.max_abs_value_w32(in32, length))
+            << version.name << " length " << length;
+        ASSERT_EQ(c.max_value_w16(in16, length),
+                  version.max_value_w16(in16, length))
+            << version.name << " length " << length;
+        ASSERT_EQ(c.max_value_w32(in32, length),
+                  version.max_value_w32(in32, length))
+            << version.name << " length " << length;
+        ASSERT_EQ(c.min_value_w16(in16, length),
+                  version.min_value_w16(in16, length))
+            << version.name << " length " << length;
+        ASSERT_EQ(c.min_value_w32(in32, length),
+                  version.min_value_w32(in32, length))
+            << version.name << " length " << length;
+      }
+    }
+
+    // The absolute value of the most negative number saturates.
+    for (int i = 0; i < kMaxLength; i++) {
+      vector16[i] = WEBRTC_SPL_WORD16_MIN;
+      vector32[i] = WEBRTC_SPL_WORD32_MIN;
+    }
+    EXPECT_EQ(WEBRTC_SPL_WORD16_MAX,
+              version.max_abs_value_w16(vector16, kMaxLength));
+    EXPECT_EQ(WEBRTC_SPL_WORD32_MAX,
+              version.max_abs_value_w32(vector32, kMaxLength));
+  }
+}
+
+TEST_F(SplInitTest, CrossCorrelationIsBitExact) {
+  const int kMaxDimSeq = 70;
+  const int kMaxDimCrossCorrelation = 5;
+  const int16_t kRightShifts[] = {0, 1, 6, 15, 20};
+  const int16_t kSteps[] = {-1, 1, 2};
+  // |seq2| slides backwards for negative steps.
+  const int kSeq2Offset = kMaxDimCrossCorrelation;
+  int16_t seq1[kMaxDimSeq];
+  int16_t seq2[kMaxDimSeq + 3 * kMaxDimCrossCorrelation];
+  int32_t expected[kMaxDimCrossCorrelation];
+  int32_t actual[kMaxDimCrossCorrelation];
+  Random random(4711);
+  const SplVersion& c = versions_[0];
+
+  for (size_t v = 1; v < versions_.size(); v++) {
+    const SplVersion& version = versions_[v];
+    for (int dim_seq = 1; dim_seq <= kMaxDimSeq; dim_seq++) {
+      for (int dim = 1; dim <= kMaxDimCrossCorrelation; dim++) {
+        for (size_t s = 0; s < sizeof(kRightShifts) / sizeof(kRightShifts[0]);
+             s++) {
+          for (size_t t = 0; t < sizeof(kSteps) / sizeof(kSteps[0]); t++) {
+            random.Fill(seq1, kMaxDimSeq);
+            random.Fill(seq2, sizeof(seq2) / sizeof(seq2[0]));
+            c.cross_correlation(expected, seq1, &seq2[kSeq2Offset], dim_seq,
+                                dim, kRightShifts[s], kSteps[t]);
+            version.cross_correlation(actual, seq1, &seq2[kSeq2Offset],
+                                      dim_seq, dim, kRightShifts[s],
+                                      kSteps[t]);
+            ASSERT_EQ(0, memcmp(expected, actual, sizeof(int32_t) * dim))
+                << version.name << " dim_seq " << dim_seq << " dim " << dim
+                << " right_shifts " << kRightShifts[s] << " step "
+                << kSteps[t];
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(SplInitTest, DownsampleFastIsBitExact) {
+  // Includes filters longer than handled by the SIMD versions.
+  const int kCoefficientsLengths[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 15, 16,
+                                      17, 24, 33, 64, 65, 70};
+  const int kMaxCoefficientsLength = 70;
+  const int kMaxFactor = 4;
+  const int kMaxDelay = 3;
+  const int kMaxOutLength = 40;
+  int16_t coefficients[kMaxCoefficientsLength];
+  int16_t short_data_in[10] = {0};
+  int16_t expected[kMaxOutLength];
+  int16_t actual[kMaxOutLength];
+  Random random(1234);
+  const SplVersion& c = versions_[0];
+
+  for (size_t v = 1; v < versions_.size(); v++) {
+    const SplVersion& version = versions_[v];
+    EXPECT_EQ(-1, version.downsample_fast(short_data_in, 10, actual, 0,
+                                          coefficients, 4, 1, 0));
+    EXPECT_EQ(-1, version.downsample_fast(short_data_in, 10, actual, 8,
+                                          coefficients, 4, 2, 0));
+
+    for (size_t n = 0;
+         n < sizeof(kCoefficientsLengths) / sizeof(kCoefficientsLengths[0]);
+         n++) {
+      const int coefficients_length = kCoefficientsLengths[n];
+      // Large enough coefficients to saturate the output, small enough to not
+      // overflow the accumulator.
+      const int limit = WEBRTC_SPL_MIN(
+          WEBRTC_SPL_WORD16_MAX,
+          WEBRTC_SPL_WORD32_MAX / (coefficients_length * 32768) - 1);
+      for (int factor = 1; factor <= kMaxFactor; factor++) {
+        for (int delay = 0; delay <= kMaxDelay; delay++) {
+          for (int out_length = 1; out_length <= kMaxOutLength; out_length++) {
+            // The input ends exactly at the last sample used, so that
+            // reading past it is caught by memory checkers.
+            const int in_length = delay + factor * (out_length - 1) + 1;
+            // The filter state precedes the input.
+            std::vector<int16_t> data_in(coefficients_length - 1 + in_length);
+            const int16_t* in = &data_in[coefficients_length - 1];
+            for (int i = 0; i < coefficients_length; i++) {
+              coefficients[i] = static_cast<int16_t>(
+                  static_cast<int>(random.Next() % (2 * limit + 1)) - limit);
+            }
+            random.Fill(&data_in[0], static_cast<int>(data_in.size()));
+            memset(expected, 0, sizeof(expected));
+            memset(actual, 0, sizeof(actual));
+            ASSERT_EQ(0, c.downsample_fast(in, in_length, expected,
+                                           out_length, coefficients,
+                                           coefficients_length, factor,
+                                           delay));
+            ASSERT_EQ(0, version.downsample_fast(in, in_length, actual,
+                                                 out_length, coefficients,
+                                                 coefficients_length, factor,
+                                                 delay));
+            ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected)))
+                << version.name << " coefficients_length "
+                << coefficients_length << " factor " << factor << " delay "
+                << delay << " out_length " << out_length;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(SplInitTest, ScaleAndAddVectorsWithRoundIsBitExact) {
+  const int kMaxLength = 70;
+  const int kMaxOffset = 8;
+  int16_t in1[kMaxLength + kMaxOffset];
+  int16_t in2[kMaxLength + kMaxOffset];
+  int16_t expected[kMaxLength + 1];
+  int16_t actual[kMaxLength + 1];
+  Random random(42);
+  const SplVersion& c = versions_[0];
+
+  for (size_t v = 1; v < versions_.size(); v++) {
+    const SplVersion& version = versions_[v];
+    EXPECT_EQ(-1, version.scale_and_add_vectors_with_round(
+        in1, 1, NULL, 1, 0, actual, kMaxLength));
+    EXPECT_EQ(-1, version.scale_and_add_vectors_with_round(
+        in1, 1, in2, 1, -1, actual, kMaxLength));
+    EXPECT_EQ(-1, version.scale_and_add_vectors_with_round(
+        in1, 1, in2, 1, 0, actual, 0));
+
+    for (int length = 1; length <= kMaxLength; length++) {
+      for (int right_shifts = 0; right_shifts <= 20; right_shifts++) {
+        const int offset = random.Next() % kMaxOffset;
+        const int16_t scale1 = random.NextW16(WEBRTC_SPL_WORD16_MAX);
+        const int16_t scale2 = random.NextW16(WEBRTC_SPL_WORD16_MAX);
+        random.Fill(in1, kMaxLength + kMaxOffset);
+        random.Fill(in2, kMaxLength + kMaxOffset);
+        memset(expected, 0, sizeof(expected));
+        memset(actual, 0, sizeof(actual));
+        ASSERT_EQ(0, c.scale_and_add_vectors_with_round(
+            &in1[offset], scale1, &in2[kMaxOffset - 1 - offset], scale2,
+            right_shifts, expected, length));
+        ASSERT_EQ(0, version.scale_and_add_vectors_with_round(
+            &in1[offset], scale1, &in2[kMaxOffset - 1 - offset], scale2,
+            right_shifts, actual, length));
+        ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected)))
+            << version.name << " length " << length << " right_shifts "
+            << right_shifts;
+      }
+    }
+  }
+}
+
+TEST_F(SplInitTest, InitSelectsBestVersion) {
+  const SplVersion& best = versions_.back();
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  EXPECT_EQ(best.max_abs_value_w16, WebRtcSpl_MaxAbsValueW16);
+  EXPECT_EQ(best.max_abs_value_w32, WebRtcSpl_MaxAbsValueW32);
+  EXPECT_EQ(best.max_value_w16, WebRtcSpl_MaxValueW16);
+  EXPECT_EQ(best.max_value_w32, WebRtcSpl_MaxValueW32);
+  EXPECT_EQ(best.min_value_w16, WebRtcSpl_MinValueW16);
+  EXPECT_EQ(best.min_value_w32, WebRtcSpl_MinValueW32);
+  EXPECT_EQ(best.cross_correlation, WebRtcSpl_CrossCorrelation);
+  EXPECT_EQ(best.downsample_fast, WebRtcSpl_DownsampleFast);
+  EXPECT_EQ(best.scale_and_add_vectors_with_round,
+            WebRtcSpl_ScaleAndAddVectorsWithRound);
+#else
+  // Other platforms have versions not tested here.
+  (void)best;
+#endif
+}
+
+// Benchmark for every function dispatched by WebRtcSpl_Init(), with sizes
+// typical of the codecs and AECM. Prints the time per call of each version
+// and its speedup over the C version.
+TEST_F(SplInitTest, DISABLED_Benchmark) {
+  const int kIterations = 100000;
+  const int kLength = 240;  // 30 ms at 8 kHz, or 15 ms at 16 kHz.
+  const int kDimSeq = 60;
+  const int kDimCrossCorrelation = 50;
+  const int kCoefficientsLength = 7;
+  const int kFactor = 4;
+  const int kOutLength = (kLength - (kCoefficientsLength - 1)) / kFactor;
+  const int16_t kCoefficients[kCoefficientsLength] = {
+    -104, 292, 1316, 1812, 1316, 292, -104
+  };
+  int16_t in16[kLength];
+  int16_t in16_2[kLength];
+  int16_t out16[kLength];
+  int32_t in32[kLength];
+  int32_t out32[kDimCrossCorrelation];
+  Random random(7);
+  random.Fill(in16, kLength);
+  random.Fill(in16_2, kLength);
+  random.Fill(in32, kLength);
+  // Keep the filter input in the range of speech.
+  for (int i = 0; i < kLength; i++) {
+    in16_2[i] /= 4;
+  }
+  // Prevents the calls from being optimized away.
+  volatile int sink = 0;
+
+  const char* kFunctions[] = {
+    "MaxAbsValueW16", "MaxAbsValueW32", "MaxValueW16", "MaxValueW32",
+    "MinValueW16", "MinValueW32", "CrossCorrelation", "DownsampleFast",
+    "ScaleAndAddVectorsWithRound"
+  };
+  const int kNumFunctions = sizeof(kFunctions) / sizeof(kFunctions[0]);
+  std::vector<double> c_us(kNumFunctions, 0.0);
+  for (size_t v = 0; v < versions_.size(); v++) {
+    const SplVersion& version = versions_[v];
+    for (int f = 0; f < kNumFunctions; f++) {
+      TickTime start = TickTime::Now();
+      for (int i = 0; i < kIterations; i++) {
+        switch (f) {
+          case 0:
+            sink = version.max_abs_value_w16(in16, kLength);
+            break;
+          case 1:
+            sink = version.max_abs_value_w32(in32, kLength);
+            break;
+          case 2:
+            sink = version.max_value_w16(in16, kLength);
+            break;
+          case 3:
+            sink = version.max_value_w32(in32, kLength);
+            break;
+          case 4:
+            sink = version.min_value_w16(in16, kLength);
+            break;
+          case 5:
+            sink = version.min_value_w32(in32, kLength);
+            break;
+          case 6:
+            version.cross_correlation(out32, in16, in16_2, kDimSeq,
+                                      kDimCrossCorrelation, 6, 1);
+            sink = out32[0];
+            break;
+          case 7:
+            sink = version.downsample_fast(
+                &in16_2[kCoefficientsLength - 1],
+                kLength - (kCoefficientsLength - 1), out16, kOutLength,
+                kCoefficients, kCoefficientsLength, kFactor, 0);
+            break;
+          case 8:
+            sink = version.scale_and_add_vectors_with_round(
+                in16, 11000, in16_2, 5000, 14, out16, kLength);
+            break;
+        }
+      }
+      const double us = static_cast<double>(
+          (TickTime::Now() - start).Microseconds()) / kIterations;
+      if (v == 0) {
+        c_us[f] = us;
+      }
+      printf("%s %s: %.3f us per call (%.1fx)\n", kFunctions[f], version.name,
+             us, us > 0 ? c_us[f] / us : 0.0);
+    }
+  }
+
+  // The FFTs have a C version only on x86.
+  const int kOrder = 7;
+  const int kFftLength = 2 << kOrder;
+  int16_t fft_in[kFftLength];
+  int16_t fft_out[kFftLength];
+  random.Fill(fft_in, kFftLength);
+  RealFFT* fft = WebRtcSpl_CreateRealFFT(kOrder);
+  ASSERT_TRUE(fft != NULL);
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kIterations; i++) {
+    sink = WebRtcSpl_RealForwardFFT(fft, fft_in, fft_out);
+  }
+  printf("RealForwardFFT order %d: %.3f us per call\n", kOrder,
+         static_cast<double>((TickTime::Now() - start).Microseconds()) /
+             kIterations);
+  start = TickTime::Now();
+  for (int i = 0; i < kIterations; i++) {
+    sink = WebRtcSpl_RealInverseFFT(fft, fft_in, fft_out);
+  }
+  printf("RealInverseFFT order %d: %.3f us per call\n", kOrder,
+         static_cast<double>((TickTime::Now() - start).Microseconds()) /
+             kIterations);
+  WebRtcSpl_FreeRealFFT(fft);
+  (void)sink;
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+// AVX2 version of WebRtcSpl_ScaleAndAddVectorsWithRound(), bit-exact with the
+// C version. See vector_scaling_operations_sse2.c.
+int WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length) {
+  __m256i scales;
+  __m256i round;
+  __m128i shift;
+  int i = 0;
+  int round_value = (1 << right_shifts) >> 1;
+
+  if (in_vector1 == NULL || in_vector2 == NULL || out_vector == NULL ||
+      length <= 0 || right_shifts < 0) {
+    return -1;
+  }
+
+  scales = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)in_vector2_scale
+      << 16) | (uint16_t)in_vector1_scale));
+  round = _mm256_set1_epi32(round_value);
+  shift = _mm_cvtsi32_si128(right_shifts);
+  // The unpacks and the pack work within 128-bit lanes, so the output order
+  // is the input order.
+  for (; i <= length - 16; i += 16) {
+    const __m256i a = _mm256_loadu_si256((const __m256i*)&in_vector1[i]);
+    const __m256i b = _mm256_loadu_si256((const __m256i*)&in_vector2[i]);
+    __m256i low = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), scales);
+    __m256i high = _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), scales);
+    low = _mm256_sra_epi32(_mm256_add_epi32(low, round), shift);
+    high = _mm256_sra_epi32(_mm256_add_epi32(high, round), shift);
+    low = _mm256_srai_epi32(_mm256_slli_epi32(low, 16), 16);
+    high = _mm256_srai_epi32(_mm256_slli_epi32(high, 16), 16);
+    _mm256_storeu_si256((__m256i*)&out_vector[i],
+                        _mm256_packs_epi32(low, high));
+  }
+
+  for (; i < length; i++) {
+    out_vector[i] = (int16_t)((
+        WEBRTC_SPL_MUL_16_16(in_vector1[i], in_vector1_scale)
+        + WEBRTC_SPL_MUL_16_16(in_vector2[i], in_vector2_scale)
+        + round_value) >> right_shifts);
+  }
+
+  return 0;
+}
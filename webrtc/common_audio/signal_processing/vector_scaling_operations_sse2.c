@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+// SSE2 version of WebRtcSpl_ScaleAndAddVectorsWithRound(), bit-exact with the
+// C version.
+int WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length) {
+  __m128i scales;
+  __m128i round;
+  __m128i shift;
+  int i = 0;
+  int round_value = (1 << right_shifts) >> 1;
+
+  if (in_vector1 == NULL || in_vector2 == NULL || out_vector == NULL ||
+      length <= 0 || right_shifts < 0) {
+    return -1;
+  }
+
+  // Interleaving the two vectors lets pmaddwd compute both products and
+  // their sum.
+  scales = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)in_vector2_scale
+      << 16) | (uint16_t)in_vector1_scale));
+  round = _mm_set1_epi32(round_value);
+  shift = _mm_cvtsi32_si128(right_shifts);
+  for (; i <= length - 8; i += 8) {
+    const __m128i a = _mm_loadu_si128((const __m128i*)&in_vector1[i]);
+    const __m128i b = _mm_loadu_si128((const __m128i*)&in_vector2[i]);
+    __m128i low = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), scales);
+    __m128i high = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), scales);
+    low = _mm_sra_epi32(_mm_add_epi32(low, round), shift);
+    high = _mm_sra_epi32(_mm_add_epi32(high, round), shift);
+    // The C version truncates to 16 bits rather than saturating. Sign extend
+    // the low halves so that the saturating pack leaves them unchanged.
+    low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+    high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+    _mm_storeu_si128((__m128i*)&out_vector[i], _mm_packs_epi32(low, high));
+  }
+
+  for (; i < length; i++) {
+    out_vector[i] = (int16_t)((
+        WEBRTC_SPL_MUL_16_16(in_vector1[i], in_vector1_scale)
+        + WEBRTC_SPL_MUL_16_16(in_vector2[i], in_vector2_scale)
+        + round_value) >> right_shifts);
+  }
+
+  return 0;
+}
@@ -196,6 +196,53 @@ public:
         int bytes_in,
         int* bytes_out) = 0;
 
+    // Returns the number of bytes the in-place methods below may add to a
+    // packet, e.g. for an authentication tag, or -1 if they aren't
+    // implemented. The engines only use them if this is non-negative.
+    virtual int in_place_tail_room() { return -1; }
+
+    // In-place variants of encrypt() and encrypt_rtcp(). The engines use
+    // these for outgoing packets in buffers they own, instead of copying the
+    // packets into a separate output buffer. Incoming packets belong to the
+    // external transport and are always decrypted with a copy.
+    //
+    // Args:
+    //   channel: The channel to encrypt data for.
+    //   data: The packet, bytes_in bytes long. The result is written to the
+    //       same buffer, which has room for at least
+    //       bytes_in + in_place_tail_room() bytes.
+    //   bytes_in: The number of bytes in the packet.
+    //   bytes_out: The number of bytes in the result, <= 0 on failure.
+    virtual void encrypt_in_place(
+        int channel,
+        unsigned char* data,
+        int bytes_in,
+        int* bytes_out) { *bytes_out = -1; }
+
+    virtual void encrypt_rtcp_in_place(
+        int channel,
+        unsigned char* data,
+        int bytes_in,
+        int* bytes_out) { *bytes_out = -1; }
+
+    // Encrypts |num_packets| RTP packets in place in one call, e.g. to
+    // interleave them in a vectorized cipher. data[i], bytes_in[i] and
+    // bytes_out[i] follow the contract of encrypt_in_place(). The engines use
+    // this for packets sent together, e.g. the packets of a video frame. The
+    // default implementation calls encrypt_in_place() for each packet.
+    virtual void encrypt_in_place_batch(
+        int channel,
+        unsigned char* const* data,
+        const int* bytes_in,
+        int* bytes_out,
+        int num_packets)
+    {
+        for (int i = 0; i < num_packets; ++i)
+        {
+            encrypt_in_place(channel, data[i], bytes_in[i], &bytes_out[i]);
+        }
+    }
+
 protected:
     virtual ~Encryption() {}
     Encryption() {}
@@ -208,6 +255,37 @@ public:
     virtual int SendPacket(int channel, const void *data, int len) = 0;
     virtual int SendRTCPPacket(int channel, const void *data, int len) = 0;
 
+    // Variants of the above for packets in buffers of |capacity| bytes which
+    // the sender doesn't use after the call, so that they can be modified in
+    // place, e.g. encrypted. The default implementations call the methods
+    // above.
+    virtual int SendWritablePacket(int channel, void *data, int len,
+                                   int capacity)
+    {
+        return SendPacket(channel, data, len);
+    }
+    virtual int SendWritableRTCPPacket(int channel, void *data, int len,
+                                       int capacity)
+    {
+        return SendRTCPPacket(channel, data, len);
+    }
+
+    // Sends |num_packets| RTP packets in one call, so that they can be
+    // encrypted together. data[i] and len[i] follow the contract of
+    // SendWritablePacket(), and bytes_sent[i] is set to what it would have
+    // returned. The default implementation calls SendWritablePacket() for
+    // each packet.
+    virtual void SendWritablePackets(int channel, unsigned char* const* data,
+                                     const int* len, int capacity,
+                                     int* bytes_sent, int num_packets)
+    {
+        for (int i = 0; i < num_packets; ++i)
+        {
+            bytes_sent[i] = SendWritablePacket(channel, data[i], len[i],
+                                               capacity);
+        }
+    }
+
 protected:
     virtual ~Transport() {}
     Transport() {}
@@ -321,6 +399,28 @@ typedef struct        // All levels are reported in dB
     StatVal a_nlp;
 } EchoStatistics;
 
+// Time spent in the stages of the VoiceEngine capture callback, in
+// microseconds per 10 ms block.
+struct CaptureTimingStatistics
+{
+    // number of blocks measured
+    int blocks;
+    // resampling and near-end processing of the captured audio
+    StatVal prepare;
+    // copying the processed audio to the sending channels
+    StatVal demux;
+    // encoding and packetization in the sending channels
+    StatVal encode;
+    // blocks in which channels were skipped because the encoder threads
+    // didn't get to them within the deadline
+    int deadlineMisses;
+    // total number of channels skipped
+    int skippedEncodes;
+    // total number of channels which sent the encoding of another channel,
+    // see VoEBase::SetEncoderSharing()
+    int sharedEncodes;
+};
+
 enum NsModes    // type of Noise Suppression
 {
     kNsUnchanged = 0,   // previously set mode
@@ -53,6 +53,8 @@
         }],
       ],
       'sources': [
+        'frame_buffer_pool.cc',
+        'frame_buffer_pool.h',
         'interface/i420_video_frame.h',
         'i420_video_frame.cc',
         'jpeg/include/jpeg.h',
@@ -83,6 +85,7 @@
              '<(webrtc_root)/test/test.gyp:test_support_main',
           ],
           'sources': [
+            'frame_buffer_pool_unittest.cc',
             'i420_video_frame_unittest.cc',
             'jpeg/jpeg_unittest.cc',
             'libyuv/libyuv_unittest.cc',
@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/frame_buffer_pool.h"
+
+#include <assert.h>
+
+#include "system_wrappers/interface/aligned_malloc.h"
+#include "system_wrappers/interface/critical_section_wrapper.h"
+
+namespace webrtc {
+
+namespace {
+
+FrameBufferPool* pool_instance = NULL;
+
+// Size at which the pending bytes of a ByteCounter are moved to its total,
+// leaving room for the bytes added meanwhile by other threads.
+const int32_t kMaxPendingBytes = 1 << 30;
+
+}  // namespace
+
+FrameBufferPool::Buffer::Buffer(FrameBufferPool* pool, int size)
+    : pool_(pool),
+      data_(AlignedMalloc<uint8_t>(size, kBufferAlignment)),
+      size_(size),
+      ref_count_(0) {}
+
+FrameBufferPool::Buffer::~Buffer() {
+  AlignedFree(data_);
+}
+
+int32_t FrameBufferPool::Buffer::Release() {
+  int32_t ref_count = --ref_count_;
+  if (ref_count == 0)
+    pool_->Recycle(this);
+  return ref_count;
+}
+
+FrameBufferPool* FrameBufferPool::GetInstance() {
+  if (pool_instance == NULL) {
+    // Allocated once and never freed, like the lock of GetStaticInstance().
+    static CriticalSectionWrapper* crit_sect(
+        CriticalSectionWrapper::CreateCriticalSection());
+    CriticalSectionScoped lock(crit_sect);
+    if (pool_instance == NULL) {
+      pool_instance = new FrameBufferPool();
+    }
+  }
+  return pool_instance;
+}
+
+FrameBufferPool::FrameBufferPool()
+    : crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      outstanding_buffers_(0) {}
+
+FrameBufferPool::~FrameBufferPool() {
+  assert(outstanding_buffers_ == 0);
+  Clear();
+}
+
+int FrameBufferPool::SizeClass(int size) {
+  if (size <= kMinBufferSize)
+    return kMinBufferSize;
+  // Round up to a multiple of a quarter of the largest power of two below
+  // |size|, which wastes at most 25% of the buffer.
+  int power = kMinBufferSize;
+  while (power <= (size - 1) / 2)
+    power *= 2;
+  const int step = power / 4;
+  const int64_t rounded =
+      (static_cast<int64_t>(size) + step - 1) / step * step;
+  return rounded > 0x7fffffff ? size : static_cast<int>(rounded);
+}
+
+scoped_refptr<FrameBufferPool::Buffer> FrameBufferPool::Allocate(int size) {
+  if (size <= 0)
+    return NULL;
+  const int size_class = SizeClass(size);
+  {
+    CriticalSectionScoped lock(crit_sect_.get());
+    ++outstanding_buffers_;
+    FreeLists::iterator it = free_lists_.find(size_class);
+    if (it != free_lists_.end() && !it->second.empty()) {
+      Buffer* buffer = it->second.back();
+      it->second.pop_back();
+      ++statistics_.buffers_reused;
+      return buffer;
+    }
+    ++statistics_.buffers_allocated;
+  }
+  Buffer* buffer = new Buffer(this, size_class);
+  if (buffer->data() == NULL) {
+    delete buffer;
+    CriticalSectionScoped lock(crit_sect_.get());
+    --outstanding_buffers_;
+    return NULL;
+  }
+  return buffer;
+}
+
+void FrameBufferPool::Recycle(Buffer* buffer) {
+  {
+    CriticalSectionScoped lock(crit_sect_.get());
+    assert(outstanding_buffers_ > 0);
+    --outstanding_buffers_;
+    std::vector<Buffer*>& free_list = free_lists_[buffer->size()];
+    if (free_list.size() < static_cast<size_t>(kMaxFreeBuffersPerSize)) {
+      free_list.push_back(buffer);
+      return;
+    }
+  }
+  delete buffer;
+}
+
+void FrameBufferPool::Clear() {
+  FreeLists free_lists;
+  {
+    CriticalSectionScoped lock(crit_sect_.get());
+    free_lists.swap(free_lists_);
+  }
+  for (FreeLists::iterator it = free_lists.begin(); it != free_lists.end();
+       ++it) {
+    for (size_t i = 0; i < it->second.size(); ++i)
+      delete it->second[i];
+  }
+}
+
+void FrameBufferPool::ByteCounter::Add(int bytes,
+                                       CriticalSectionWrapper* crit_sect) {
+  if ((pending_ += bytes) < kMaxPendingBytes)
+    return;
+  CriticalSectionScoped lock(crit_sect);
+  // Another thread may have moved the bytes already.
+  if (pending_.Value() >= kMaxPendingBytes)
+    total_ += TakePending();
+}
+
+void FrameBufferPool::ByteCounter::Reset() {
+  TakePending();
+  total_ = 0;
+}
+
+int32_t FrameBufferPool::ByteCounter::TakePending() {
+  int32_t pending = pending_.Value();
+  while (!pending_.CompareExchange(0, pending))
+    pending = pending_.Value();
+  return pending;
+}
+
+void FrameBufferPool::OnBytesCopied(int bytes) {
+  bytes_copied_.Add(bytes, crit_sect_.get());
+}
+
+void FrameBufferPool::OnBytesShared(int bytes) {
+  bytes_shared_.Add(bytes, crit_sect_.get());
+}
+
+void FrameBufferPool::OnBytesCopiedOnWrite(int bytes) {
+  bytes_copied_on_write_.Add(bytes, crit_sect_.get());
+}
+
+FrameBufferPool::Statistics FrameBufferPool::GetStatistics() const {
+  CriticalSectionScoped lock(crit_sect_.get());
+  Statistics statistics = statistics_;
+  statistics.bytes_copied = bytes_copied_.Value();
+  statistics.bytes_shared = bytes_shared_.Value();
+  statistics.bytes_copied_on_write = bytes_copied_on_write_.Value();
+  return statistics;
+}
+
+void FrameBufferPool::ResetStatistics() {
+  CriticalSectionScoped lock(crit_sect_.get());
+  statistics_ = Statistics();
+  bytes_copied_.Reset();
+  bytes_shared_.Reset();
+  bytes_copied_on_write_.Reset();
+}
+
+}  // namespace webrtc
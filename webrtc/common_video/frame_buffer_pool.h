@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_FRAME_BUFFER_POOL_H
+#define COMMON_VIDEO_FRAME_BUFFER_POOL_H
+
+#include <map>
+#include <vector>
+
+#include "system_wrappers/interface/atomic32.h"
+#include "system_wrappers/interface/constructor_magic.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/scoped_refptr.h"
+#include "typedefs.h"  //NOLINT
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+
+// Pool of reference counted, aligned buffers for video frame planes. Buffers
+// are handed out in size classes, four per power of two, so that a buffer
+// released by one frame can be reused by the next frame of a similar size.
+// When the last reference to a buffer is released it goes back to the free
+// list of its size class, unless that list is full.
+//
+// The pool also counts the plane bytes that were copied and the bytes that
+// were shared by reference instead, see Statistics.
+class FrameBufferPool {
+ public:
+  class Buffer {
+   public:
+    uint8_t* data() { return data_; }
+    const uint8_t* data() const { return data_; }
+    // The usable size, which is the size class the buffer was taken from.
+    int size() const { return size_; }
+
+    int32_t AddRef() { return ++ref_count_; }
+    // Returns the buffer to its pool when the last reference is released.
+    int32_t Release();
+
+    // True if the caller holds the only reference and may therefore write to
+    // the buffer without affecting anybody else.
+    bool HasOneRef() const { return ref_count_.Value() == 1; }
+
+   private:
+    friend class FrameBufferPool;
+
+    Buffer(FrameBufferPool* pool, int size);
+    ~Buffer();
+
+    FrameBufferPool* const pool_;
+    uint8_t* const data_;
+    const int size_;
+    Atomic32 ref_count_;
+
+    DISALLOW_COPY_AND_ASSIGN(Buffer);
+  };
+
+  struct Statistics {
+    Statistics()
+        : bytes_copied(0),
+          bytes_shared(0),
+          bytes_copied_on_write(0),
+          buffers_allocated(0),
+          buffers_reused(0) {}
+
+    // Plane bytes copied in from outside of the pool.
+    int64_t bytes_copied;
+    // Plane bytes handed from one plane to another by reference. Without
+    // sharing, these would have been copied instead.
+    int64_t bytes_shared;
+    // Plane bytes copied because a shared plane was written to. The bytes
+    // copied per frame are thus bytes_copied + bytes_shared without sharing,
+    // and bytes_copied + bytes_copied_on_write with it.
+    int64_t bytes_copied_on_write;
+    // Buffers taken from the heap and from the free lists, respectively.
+    int64_t buffers_allocated;
+    int64_t buffers_reused;
+  };
+
+  enum {
+    // Buffers are aligned to 64 bytes for SIMD access.
+    kBufferAlignment = 64,
+    // The smallest size class.
+    kMinBufferSize = 4096,
+    // The number of free buffers kept per size class.
+    kMaxFreeBuffersPerSize = 8,
+  };
+
+  // The process-wide pool used by Plane. It is created on first use and never
+  // destroyed.
+  static FrameBufferPool* GetInstance();
+
+  FrameBufferPool();
+  // All buffers must have been released when the pool is destroyed.
+  ~FrameBufferPool();
+
+  // Returns a buffer of at least |size| bytes, or NULL if |size| is not
+  // positive or the allocation fails. The contents are undefined.
+  scoped_refptr<Buffer> Allocate(int size);
+
+  // Frees all buffers on the free lists.
+  void Clear();
+
+  // Called by the users of the buffers to account for plane data copied or
+  // shared. These don't take the lock of the pool.
+  void OnBytesCopied(int bytes);
+  void OnBytesShared(int bytes);
+  void OnBytesCopiedOnWrite(int bytes);
+
+  Statistics GetStatistics() const;
+  void ResetStatistics();
+
+  // Returns the size class |size| bytes are allocated from.
+  static int SizeClass(int size);
+
+ private:
+  typedef std::map<int, std::vector<Buffer*> > FreeLists;
+
+  // 64-bit byte count updated without the lock. Bytes are added to an
+  // Atomic32, which is moved to the 64-bit total under the lock of the pool
+  // when it gets large.
+  class ByteCounter {
+   public:
+    ByteCounter() : pending_(0), total_(0) {}
+
+    void Add(int bytes, CriticalSectionWrapper* crit_sect);
+    // Must be called with the lock of the pool held.
+    int64_t Value() const { return total_ + pending_.Value(); }
+    void Reset();
+
+   private:
+    // Moves |pending_| to |total_|. Must be called with the lock held.
+    int32_t TakePending();
+
+    Atomic32 pending_;
+    int64_t total_;
+
+    DISALLOW_COPY_AND_ASSIGN(ByteCounter);
+  };
+
+  void Recycle(Buffer* buffer);
+
+  scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  FreeLists free_lists_;
+  int outstanding_buffers_;
+  // Holds the buffer counts. The byte counts are kept in the counters below.
+  Statistics statistics_;
+  ByteCounter bytes_copied_;
+  ByteCounter bytes_shared_;
+  ByteCounter bytes_copied_on_write_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameBufferPool);
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_FRAME_BUFFER_POOL_H
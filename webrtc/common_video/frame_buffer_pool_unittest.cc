@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/frame_buffer_pool.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace webrtc {
+
+TEST(TestFrameBufferPool, SizeClass) {
+  EXPECT_EQ(FrameBufferPool::kMinBufferSize, FrameBufferPool::SizeClass(1));
+  EXPECT_EQ(FrameBufferPool::kMinBufferSize,
+            FrameBufferPool::SizeClass(FrameBufferPool::kMinBufferSize));
+  EXPECT_EQ(5120, FrameBufferPool::SizeClass(4097));
+  EXPECT_EQ(8192, FrameBufferPool::SizeClass(8192));
+  EXPECT_EQ(10240, FrameBufferPool::SizeClass(8193));
+  // 720p planes.
+  EXPECT_EQ(1048576, FrameBufferPool::SizeClass(1280 * 720));
+  EXPECT_EQ(262144, FrameBufferPool::SizeClass(640 * 360));
+  // 1080p luma.
+  EXPECT_EQ(2097152, FrameBufferPool::SizeClass(1920 * 1080));
+  // At most 25% is wasted.
+  for (int size = 1; size < (1 << 24); size = size * 5 / 4 + 1) {
+    const int size_class = FrameBufferPool::SizeClass(size);
+    EXPECT_GE(size_class, size);
+    if (size > FrameBufferPool::kMinBufferSize) {
+      EXPECT_LE(static_cast<int64_t>(size_class) * 4,
+                static_cast<int64_t>(size) * 5);
+    }
+  }
+}
+
+TEST(TestFrameBufferPool, AllocateAndReuse) {
+  FrameBufferPool pool;
+  EXPECT_TRUE(pool.Allocate(0).get() == NULL);
+  EXPECT_TRUE(pool.Allocate(-1).get() == NULL);
+
+  scoped_refptr<FrameBufferPool::Buffer> buffer = pool.Allocate(10000);
+  ASSERT_TRUE(buffer.get() != NULL);
+  EXPECT_EQ(FrameBufferPool::SizeClass(10000), buffer->size());
+  EXPECT_TRUE(buffer->HasOneRef());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(buffer->data()) %
+               FrameBufferPool::kBufferAlignment);
+  const uint8_t* data = buffer->data();
+
+  scoped_refptr<FrameBufferPool::Buffer> reference = buffer;
+  EXPECT_FALSE(buffer->HasOneRef());
+  reference = NULL;
+  EXPECT_TRUE(buffer->HasOneRef());
+
+  // A released buffer is reused for any size of the same size class.
+  buffer = NULL;
+  buffer = pool.Allocate(FrameBufferPool::SizeClass(10000) - 1);
+  EXPECT_EQ(data, buffer->data());
+  FrameBufferPool::Statistics stats = pool.GetStatistics();
+  EXPECT_EQ(1, stats.buffers_allocated);
+  EXPECT_EQ(1, stats.buffers_reused);
+
+  // But not for another size class.
+  scoped_refptr<FrameBufferPool::Buffer> other = pool.Allocate(100000);
+  EXPECT_NE(data, other->data());
+  EXPECT_EQ(2, pool.GetStatistics().buffers_allocated);
+}
+
+TEST(TestFrameBufferPool, LimitsFreeBuffers) {
+  FrameBufferPool pool;
+  const int kNumBuffers = FrameBufferPool::kMaxFreeBuffersPerSize + 4;
+  std::vector<scoped_refptr<FrameBufferPool::Buffer> > buffers;
+  for (int i = 0; i < kNumBuffers; ++i)
+    buffers.push_back(pool.Allocate(1000));
+  buffers.clear();
+  for (int i = 0; i < kNumBuffers; ++i)
+    buffers.push_back(pool.Allocate(1000));
+  FrameBufferPool::Statistics stats = pool.GetStatistics();
+  EXPECT_EQ(kNumBuffers + 4, stats.buffers_allocated);
+  EXPECT_EQ(FrameBufferPool::kMaxFreeBuffersPerSize, stats.buffers_reused);
+  buffers.clear();
+
+  pool.Clear();
+  pool.Allocate(1000);
+  EXPECT_EQ(kNumBuffers + 5, pool.GetStatistics().buffers_allocated);
+}
+
+TEST(TestFrameBufferPool, Statistics) {
+  FrameBufferPool pool;
+  pool.OnBytesCopied(100);
+  pool.OnBytesCopied(50);
+  pool.OnBytesShared(1000);
+  pool.OnBytesCopiedOnWrite(10);
+  FrameBufferPool::Statistics stats = pool.GetStatistics();
+  EXPECT_EQ(150, stats.bytes_copied);
+  EXPECT_EQ(1000, stats.bytes_shared);
+  EXPECT_EQ(10, stats.bytes_copied_on_write);
+  pool.ResetStatistics();
+  stats = pool.GetStatistics();
+  EXPECT_EQ(0, stats.bytes_copied);
+  EXPECT_EQ(0, stats.bytes_shared);
+  EXPECT_EQ(0, stats.bytes_copied_on_write);
+}
+
+TEST(TestFrameBufferPool, StatisticsBeyond32Bits) {
+  FrameBufferPool pool;
+  const int kBytes = 300000000;
+  for (int i = 0; i < 20; ++i)
+    pool.OnBytesShared(kBytes);
+  EXPECT_EQ(20 * static_cast<int64_t>(kBytes),
+            pool.GetStatistics().bytes_shared);
+  pool.ResetStatistics();
+  pool.OnBytesShared(1);
+  EXPECT_EQ(1, pool.GetStatistics().bytes_shared);
+}
+
+}  // namespace webrtc
@@ -59,17 +59,20 @@ int I420VideoFrame::CreateFrame(int size_y, const uint8_t* buffer_y,
 }
 
 int I420VideoFrame::CopyFrame(const I420VideoFrame& videoFrame) {
-  int ret = CreateFrame(videoFrame.allocated_size(kYPlane),
-                        videoFrame.buffer(kYPlane),
-                        videoFrame.allocated_size(kUPlane),
-                        videoFrame.buffer(kUPlane),
-                        videoFrame.allocated_size(kVPlane),
-                        videoFrame.buffer(kVPlane),
-                        videoFrame.width_, videoFrame.height_,
-                        videoFrame.stride(kYPlane), videoFrame.stride(kUPlane),
-                        videoFrame.stride(kVPlane));
-  if (ret < 0)
-    return ret;
+  if (videoFrame.allocated_size(kYPlane) < 1 ||
+      videoFrame.allocated_size(kUPlane) < 1 ||
+      videoFrame.allocated_size(kVPlane) < 1)
+    return -1;
+  if (CheckDimensions(videoFrame.width_, videoFrame.height_,
+                      videoFrame.stride(kYPlane), videoFrame.stride(kUPlane),
+                      videoFrame.stride(kVPlane)) < 0)
+    return -1;
+  // The planes share the buffers of |videoFrame| until either is written to.
+  y_plane_.Copy(videoFrame.y_plane_);
+  u_plane_.Copy(videoFrame.u_plane_);
+  v_plane_.Copy(videoFrame.v_plane_);
+  width_ = videoFrame.width_;
+  height_ = videoFrame.height_;
   timestamp_ = videoFrame.timestamp_;
   render_time_ms_ = videoFrame.render_time_ms_;
   return 0;
@@ -9,9 +9,13 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
+#include "webrtc/common_video/frame_buffer_pool.h"
 #include "webrtc/common_video/interface/i420_video_frame.h"
 #include "webrtc/system_wrappers/interface/ref_count.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
@@ -213,6 +217,85 @@ TEST(TestI420VideoFrame, FrameSwap) {
   EXPECT_TRUE(EqualFrames(frame2_copy, frame1));
 }
 
+TEST(TestI420VideoFrame, CopyFrameSharesBuffers) {
+  I420VideoFrame frame1, frame2;
+  const int kWidth = 64;
+  const int kHeight = 48;
+  EXPECT_EQ(0, frame1.CreateEmptyFrame(kWidth, kHeight, kWidth, kWidth / 2,
+                                       kWidth / 2));
+  memset(frame1.buffer(kYPlane), 16, frame1.allocated_size(kYPlane));
+  memset(frame1.buffer(kUPlane), 128, frame1.allocated_size(kUPlane));
+  memset(frame1.buffer(kVPlane), 128, frame1.allocated_size(kVPlane));
+  EXPECT_EQ(0, frame2.CopyFrame(frame1));
+  const I420VideoFrame& const_frame1 = frame1;
+  const I420VideoFrame& const_frame2 = frame2;
+  EXPECT_EQ(const_frame1.buffer(kYPlane), const_frame2.buffer(kYPlane));
+  EXPECT_EQ(const_frame1.buffer(kUPlane), const_frame2.buffer(kUPlane));
+  EXPECT_EQ(const_frame1.buffer(kVPlane), const_frame2.buffer(kVPlane));
+
+  // Writing to one plane of the copy only copies that plane.
+  frame2.buffer(kYPlane)[0] = 235;
+  EXPECT_NE(const_frame1.buffer(kYPlane), const_frame2.buffer(kYPlane));
+  EXPECT_EQ(const_frame1.buffer(kUPlane), const_frame2.buffer(kUPlane));
+  EXPECT_EQ(16, const_frame1.buffer(kYPlane)[0]);
+  EXPECT_EQ(235, const_frame2.buffer(kYPlane)[0]);
+  EXPECT_EQ(0, memcmp(const_frame1.buffer(kYPlane) + 1,
+                      const_frame2.buffer(kYPlane) + 1,
+                      frame1.allocated_size(kYPlane) - 1));
+
+  // Refilling the original leaves the copy intact.
+  EXPECT_EQ(0, frame1.CreateEmptyFrame(kWidth, kHeight, kWidth, kWidth / 2,
+                                       kWidth / 2));
+  memset(frame1.buffer(kUPlane), 0, frame1.allocated_size(kUPlane));
+  EXPECT_EQ(128, const_frame2.buffer(kUPlane)[0]);
+}
+
+// Delivers 720p frames from one capturer to two encoders, which only read the
+// frame, and a local preview that mirrors it in place, the way
+// ViEFrameProviderBase hands a copy of the frame to each callback. Prints the
+// plane bytes copied per frame with and without sharing of the buffers.
+TEST(TestI420VideoFrame, CopiedBytesPerFrame) {
+  const int kWidth = 1280;
+  const int kHeight = 720;
+  const int kNumFrames = 100;
+  const int kNumCallbacks = 3;
+  FrameBufferPool* pool = FrameBufferPool::GetInstance();
+  pool->ResetStatistics();
+
+  I420VideoFrame capture_frame, extra_frame;
+  uint32_t checksum = 0;
+  for (int i = 0; i < kNumFrames; ++i) {
+    capture_frame.CreateEmptyFrame(kWidth, kHeight, kWidth, kWidth / 2,
+                                   kWidth / 2);
+    memset(capture_frame.buffer(kYPlane), i,
+           capture_frame.allocated_size(kYPlane));
+    for (int j = 0; j < kNumCallbacks; ++j) {
+      extra_frame.CopyFrame(capture_frame);
+      if (j == kNumCallbacks - 1) {
+        uint8_t* y = extra_frame.buffer(kYPlane);
+        std::swap(y[0], y[kWidth - 1]);
+      }
+      const I420VideoFrame& const_frame = extra_frame;
+      checksum += const_frame.buffer(kYPlane)[kWidth * kHeight / 2];
+    }
+  }
+  EXPECT_EQ(static_cast<uint32_t>(kNumCallbacks * kNumFrames *
+                                  (kNumFrames - 1) / 2), checksum);
+
+  const FrameBufferPool::Statistics stats = pool->GetStatistics();
+  const int64_t copied_before =
+      (stats.bytes_copied + stats.bytes_shared) / kNumFrames;
+  const int64_t copied_after =
+      (stats.bytes_copied + stats.bytes_copied_on_write) / kNumFrames;
+  printf("Bytes copied per frame for %d callbacks: %lld without sharing, "
+         "%lld with sharing\n", kNumCallbacks,
+         static_cast<long long>(copied_before),
+         static_cast<long long>(copied_after));
+  // Only the Y plane of the mirrored preview frame is copied.
+  EXPECT_EQ(kWidth * kHeight, copied_after);
+  EXPECT_EQ(kNumCallbacks * kWidth * kHeight * 3 / 2, copied_before);
+}
+
 TEST(TestI420VideoFrame, RefCountedInstantiation) {
   // Refcounted instantiation - ref_count should correspond to the number of
   // instances.
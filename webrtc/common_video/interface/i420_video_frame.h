@@ -61,15 +61,17 @@ class I420VideoFrame {
                   int width, int height,
                   int stride_y, int stride_u, int stride_v);
 
-  // Copy frame: If required size is bigger than allocated one, new buffers of
-  // adequate size will be allocated.
+  // Copy frame: The plane buffers of |videoFrame| are shared rather than
+  // copied, and are copied on the first write access to either frame through
+  // the non-const buffer(). Allocated sizes become those of |videoFrame|.
   // Return value: 0 on success ,-1 on error.
   int CopyFrame(const I420VideoFrame& videoFrame);
 
   // Swap Frame.
   void SwapFrame(I420VideoFrame* videoFrame);
 
-  // Get pointer to buffer per plane.
+  // Get pointer to buffer per plane. If the buffer is shared with a copy of
+  // the frame, it is copied first.
   uint8_t* buffer(PlaneType type);
   // Overloading with const.
   const uint8_t* buffer(PlaneType type) const;
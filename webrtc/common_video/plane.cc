@@ -10,14 +10,13 @@
 
 #include "common_video/plane.h"
 
+#include <stdlib.h>  // abort
+
 #include <algorithm>  // swap
 #include <cstring>  // memcpy
 
 namespace webrtc {
 
-// Aligning pointer to 64 bytes for improved performance, e.g. use SIMD.
-static const int kBufferAlignment =  64;
-
 Plane::Plane()
     : buffer_(NULL),
       allocated_size_(0),
@@ -39,32 +38,40 @@ int Plane::CreateEmptyPlane(int allocated_size, int stride, int plane_size) {
 int Plane::MaybeResize(int new_size) {
   if (new_size <= 0)
     return -1;
-  if (new_size <= allocated_size_)
+  const bool writable = buffer_.get() && buffer_->HasOneRef();
+  if (writable && new_size <= allocated_size_)
+    return 0;
+  // Grow within the size class of the buffer if it is not shared.
+  if (writable && new_size <= buffer_->size()) {
+    allocated_size_ = new_size;
     return 0;
-  Allocator<uint8_t>::scoped_ptr_aligned new_buffer(
-    AlignedMalloc<uint8_t>(new_size, kBufferAlignment));
-  if (buffer_.get()) {
-    memcpy(new_buffer.get(), buffer_.get(), plane_size_);
   }
-  buffer_.reset(new_buffer.release());
-  allocated_size_ = new_size;
+  const int size = std::max(new_size, allocated_size_);
+  scoped_refptr<FrameBufferPool::Buffer> new_buffer(
+      FrameBufferPool::GetInstance()->Allocate(size));
+  if (!new_buffer.get())
+    return -1;
+  buffer_ = new_buffer;
+  allocated_size_ = size;
   return 0;
 }
 
 int Plane::Copy(const Plane& plane) {
-  if (MaybeResize(plane.allocated_size_) < 0)
+  if (plane.allocated_size_ < 1)
     return -1;
-  if (plane.buffer_.get())
-    memcpy(buffer_.get(), plane.buffer_.get(), plane.plane_size_);
+  buffer_ = plane.buffer_;
+  allocated_size_ = plane.allocated_size_;
   stride_ = plane.stride_;
   plane_size_ = plane.plane_size_;
+  FrameBufferPool::GetInstance()->OnBytesShared(allocated_size_);
   return 0;
 }
 
 int Plane::Copy(int size, int stride, const uint8_t* buffer) {
   if (MaybeResize(size) < 0)
     return -1;
-  memcpy(buffer_.get(), buffer, size);
+  memcpy(buffer_->data(), buffer, size);
+  FrameBufferPool::GetInstance()->OnBytesCopied(size);
   plane_size_ = size;
   stride_ = stride;
   return 0;
@@ -77,4 +84,24 @@ void Plane::Swap(Plane& plane) {
   buffer_.swap(plane.buffer_);
 }
 
+uint8_t* Plane::buffer() {
+  if (!buffer_.get())
+    return NULL;
+  if (!buffer_->HasOneRef()) {
+    // Copy on write.
+    FrameBufferPool* pool = FrameBufferPool::GetInstance();
+    scoped_refptr<FrameBufferPool::Buffer> new_buffer(
+        pool->Allocate(allocated_size_));
+    // Out of memory. A plane that was readable can't become NULL here, its
+    // users don't expect that, and writing to the shared buffer instead
+    // would change the other copies.
+    if (!new_buffer.get())
+      abort();
+    memcpy(new_buffer->data(), buffer_->data(), allocated_size_);
+    pool->OnBytesCopiedOnWrite(allocated_size_);
+    buffer_ = new_buffer;
+  }
+  return buffer_->data();
+}
+
 }  // namespace webrtc
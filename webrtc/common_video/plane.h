@@ -11,24 +11,32 @@
 #ifndef COMMON_VIDEO_PLANE_H
 #define COMMON_VIDEO_PLANE_H
 
-#include "system_wrappers/interface/aligned_malloc.h"
+#include "common_video/frame_buffer_pool.h"
+#include "system_wrappers/interface/scoped_refptr.h"
 #include "typedefs.h"  //NOLINT
 
 namespace webrtc {
 
 // Helper class for I420VideoFrame: Store plane data and perform basic plane
 // operations.
+//
+// The plane data is held in a reference counted buffer from
+// FrameBufferPool, which copying a plane shares rather than duplicates. A
+// shared buffer is copied on the first write access, i.e. the first call to
+// the non-const buffer(), so planes behave as if they had been copied.
 class Plane {
  public:
   Plane();
   ~Plane();
   // CreateEmptyPlane - set allocated size, actual plane size and stride:
-  // If current size is smaller than current size, then a buffer of sufficient
-  // size will be allocated.
+  // If current size is smaller than current size, or the buffer is shared
+  // with another plane, then a buffer of sufficient size will be allocated.
+  // The contents of a newly allocated buffer are undefined.
   // Return value: 0 on success ,-1 on error.
   int CreateEmptyPlane(int allocated_size, int stride, int plane_size);
 
-  // Copy the entire plane data.
+  // Copy the entire plane data. The buffer of |plane| is shared, not copied,
+  // and the allocated size becomes that of |plane|.
   // Return value: 0 on success ,-1 on error.
   int Copy(const Plane& plane);
 
@@ -52,18 +60,24 @@ class Plane {
   // Get stride value.
   int stride() const {return stride_;}
 
+  // Return true if the buffer is shared with another plane.
+  bool IsShared() const {return buffer_.get() && !buffer_->HasOneRef();}
+
   // Return data pointer.
-  const uint8_t* buffer() const {return buffer_.get();}
-  // Overloading with non-const.
-  uint8_t* buffer() {return buffer_.get();}
+  const uint8_t* buffer() const {return buffer_.get() ? buffer_->data() : NULL;}
+  // Overloading with non-const. Copies the buffer first if it is shared, so
+  // the returned pointer must not be written through once the plane has been
+  // copied again. Returns NULL only if the plane has no buffer; running out
+  // of memory for the copy is fatal.
+  uint8_t* buffer();
 
  private:
-  // Resize when needed: If current allocated size is less than new_size, buffer
-  // will be updated. Old data will be copied to new buffer.
+  // Resize when needed: If current allocated size is less than new_size, or
+  // the buffer is shared, buffer will be updated. Old data is not kept.
   // Return value: 0 on success ,-1 on error.
   int MaybeResize(int new_size);
 
-  Allocator<uint8_t>::scoped_ptr_aligned buffer_;
+  scoped_refptr<FrameBufferPool::Buffer> buffer_;
   int allocated_size_;
   int plane_size_;
   int stride_;
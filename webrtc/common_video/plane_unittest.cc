@@ -62,8 +62,8 @@ TEST(TestPlane, PlaneCopy) {
   int stride1 = plane1.stride();
   int stride2 = plane2.stride();
   plane1.Copy(plane2);
-  // Smaller size - keep buffer size as is.
-  EXPECT_EQ(size1, plane1.allocated_size());
+  // Smaller size - the buffer of plane2 is shared.
+  EXPECT_EQ(plane2.allocated_size(), plane1.allocated_size());
   EXPECT_EQ(stride2, plane1.stride());
   plane2.Copy(plane1);
   // Verify increment of allocated size.
@@ -78,6 +78,34 @@ TEST(TestPlane, PlaneCopy) {
   EXPECT_EQ(0, memcmp(buffer1, plane2.buffer(), size1));
 }
 
+TEST(TestPlane, CopyOnWrite) {
+  Plane plane1, plane2;
+  uint8_t buffer[100];
+  memset(buffer, 1, sizeof(buffer));
+  EXPECT_EQ(0, plane1.Copy(sizeof(buffer), 10, buffer));
+  EXPECT_FALSE(plane1.IsShared());
+  EXPECT_EQ(0, plane2.Copy(plane1));
+  EXPECT_TRUE(plane1.IsShared());
+  EXPECT_TRUE(plane2.IsShared());
+  const Plane& const_plane1 = plane1;
+  const Plane& const_plane2 = plane2;
+  EXPECT_EQ(const_plane1.buffer(), const_plane2.buffer());
+
+  // Writing to a shared plane copies it first.
+  memset(plane2.buffer(), 2, sizeof(buffer));
+  EXPECT_FALSE(plane1.IsShared());
+  EXPECT_FALSE(plane2.IsShared());
+  EXPECT_EQ(0, memcmp(buffer, const_plane1.buffer(), sizeof(buffer)));
+  EXPECT_EQ(2, const_plane2.buffer()[0]);
+  EXPECT_EQ(2, const_plane2.buffer()[sizeof(buffer) - 1]);
+
+  // An empty plane created over a shared buffer gets a buffer of its own.
+  EXPECT_EQ(0, plane2.Copy(plane1));
+  EXPECT_EQ(0, plane2.CreateEmptyPlane(50, 10, 50));
+  EXPECT_FALSE(plane1.IsShared());
+  EXPECT_EQ(0, memcmp(buffer, const_plane1.buffer(), sizeof(buffer)));
+}
+
 TEST(TestPlane, PlaneSwap) {
   Plane plane1, plane2;
   int size1, size2, stride1, stride2;
@@ -16,6 +16,7 @@
 #include "module_common_types.h"
 
 namespace webrtc {
+class AudioMixerMixMinusReceiver;
 class AudioMixerOutputReceiver;
 class AudioMixerStatusReceiver;
 class MixerParticipant;
@@ -24,6 +25,8 @@ class Trace;
 class AudioConferenceMixer : public Module
 {
 public:
+    // Default number of participants mixed, see
+    // SetMaximumMixedParticipants().
     enum {kMaximumAmountOfMixedParticipants = 3};
     enum Frequency
     {
@@ -49,6 +52,16 @@ public:
         AudioMixerOutputReceiver& receiver) = 0;
     virtual int32_t UnRegisterMixedStreamCallback() = 0;
 
+    // Register/unregister a callback class for receiving one mix per
+    // participant that leaves out the participant's own audio (mix-minus).
+    // The full mix is computed once and each contributing participant's audio
+    // is subtracted from it, so the cost grows linearly with the number of
+    // participants. Participants that did not contribute to the mix receive
+    // the same audio as the mixed stream callback.
+    virtual int32_t RegisterMixMinusCallback(
+        AudioMixerMixMinusReceiver& receiver) = 0;
+    virtual int32_t UnRegisterMixMinusCallback() = 0;
+
     // Register/unregister a callback class for receiving status information.
     virtual int32_t RegisterMixerStatusCallback(
         AudioMixerStatusReceiver& mixerStatusCallback,
@@ -77,6 +90,13 @@ public:
     // downsampling of audio contributing to the mixed audio.
     virtual int32_t SetMinimumMixingFrequency(Frequency freq) = 0;
 
+    // Set the number of (non-anonymous) participants that are mixed. If more
+    // participants are mixable, the ones with the highest energy are chosen.
+    // Anonymous participants are always mixed and do not count toward this
+    // number. Defaults to kMaximumAmountOfMixedParticipants.
+    virtual int32_t SetMaximumMixedParticipants(uint32_t maxParticipants) = 0;
+    virtual uint32_t MaximumMixedParticipants() const = 0;
+
 protected:
     AudioConferenceMixer() {}
 };
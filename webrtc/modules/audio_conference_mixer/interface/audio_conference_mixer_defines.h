@@ -88,6 +88,21 @@ protected:
     virtual ~AudioMixerOutputReceiver() {}
 };
 
+class AudioMixerMixMinusReceiver
+{
+public:
+    // This callback function provides the audio for one participant for this
+    // mix iteration: the mix of everyone except the participant itself. It is
+    // called once per mix iteration for every mixable and anonymous
+    // participant.
+    virtual void NewMixMinusAudio(const int32_t id,
+                                  const MixerParticipant& participant,
+                                  const AudioFrame& audioFrame) = 0;
+protected:
+    AudioMixerMixMinusReceiver() {}
+    virtual ~AudioMixerMixMinusReceiver() {}
+};
+
 class AudioRelayReceiver
 {
 public:
@@ -8,50 +8,47 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
 #include "audio_conference_mixer_defines.h"
 #include "audio_conference_mixer_impl.h"
 #include "audio_frame_manipulator.h"
 #include "audio_processing.h"
 #include "critical_section_wrapper.h"
-#include "map_wrapper.h"
 #include "modules/utility/interface/audio_frame_operations.h"
 #include "trace.h"
 
 namespace webrtc {
 namespace {
 
-// Mix |frame| into |mixed_frame|, with saturation protection and upmixing.
-// These effects are applied to |frame| itself prior to mixing. Assumes that
-// |mixed_frame| always has at least as many channels as |frame|. Supports
-// stereo at most.
-//
-// TODO(andrew): consider not modifying |frame| here.
-void MixFrames(AudioFrame* mixed_frame, AudioFrame* frame) {
-  assert(mixed_frame->num_channels_ >= frame->num_channels_);
-  // Divide by two to avoid saturation in the mixing.
-  *frame >>= 1;
-  if (mixed_frame->num_channels_ > frame->num_channels_) {
-    // We only support mono-to-stereo.
-    assert(mixed_frame->num_channels_ == 2 &&
-           frame->num_channels_ == 1);
-    AudioFrameOperations::MonoToStereo(frame);
-  }
-
-  *mixed_frame += *frame;
-}
-
 // Return the max number of channels from a |list| composed of AudioFrames.
-int MaxNumChannels(const ListWrapper& list) {
-  ListItem* item = list.First();
+int MaxNumChannels(const AudioFrameList& list) {
   int max_num_channels = 1;
-  while (item) {
-    AudioFrame* frame = static_cast<AudioFrame*>(item->GetItem());
-    max_num_channels = std::max(max_num_channels, frame->num_channels_);
-    item = list.Next(item);
+  for (AudioFrameList::const_iterator it = list.begin(); it != list.end();
+       ++it) {
+    max_num_channels = std::max(max_num_channels,
+                                it->audioFrame->num_channels_);
   }
   return max_num_channels;
 }
 
+ParticipantFramePair MakeParticipantFramePair(MixerParticipant* participant,
+                                              AudioFrame* audioFrame)
+{
+    ParticipantFramePair pair;
+    pair.participant = participant;
+    pair.audioFrame = audioFrame;
+    return pair;
+}
+
+bool ParticipantLess(const ParticipantFramePair& lhs,
+                     const ParticipantFramePair& rhs)
+{
+    return std::less<MixerParticipant*>()(lhs.participant, rhs.participant);
+}
+
 void SetParticipantStatistics(ParticipantStatistics* stats,
                               const AudioFrame& frame)
 {
@@ -122,14 +119,16 @@ AudioConferenceMixer* AudioConferenceMixer::Create(int id)
 
 AudioConferenceMixerImpl::AudioConferenceMixerImpl(int id)
     : _scratchParticipantsToMixAmount(0),
-      _scratchMixedParticipants(),
+      _scratchMixedParticipants(kMaximumAmountOfMixedParticipants),
       _scratchVadPositiveParticipantsAmount(0),
-      _scratchVadPositiveParticipants(),
+      _scratchVadPositiveParticipants(kMaximumAmountOfMixedParticipants),
+      _mixingFunctions(GetMixingFunctions()),
       _crit(NULL),
       _cbCrit(NULL),
       _id(id),
       _minimumMixingFreq(kLowestPossible),
       _mixReceiver(NULL),
+      _mixMinusReceiver(NULL),
       _mixerStatusCallback(NULL),
       _amountOf10MsBetweenCallbacks(1),
       _amountOf10MsUntilNextCallback(0),
@@ -139,6 +138,7 @@ AudioConferenceMixerImpl::AudioConferenceMixerImpl(int id)
       _audioFramePool(NULL),
       _participantList(),
       _additionalParticipantList(),
+      _maxMixedParticipants(kMaximumAmountOfMixedParticipants),
       _numMixedParticipants(0),
       _timeStamp(0),
       _timeScheduler(kProcessPeriodicityInMs),
@@ -226,8 +226,7 @@ int32_t AudioConferenceMixerImpl::TimeUntilNextProcess()
 
 int32_t AudioConferenceMixerImpl::Process()
 {
-    uint32_t remainingParticipantsAllowedToMix =
-        kMaximumAmountOfMixedParticipants;
+    uint32_t remainingParticipantsAllowedToMix = 0;
     {
         CriticalSectionScoped cs(_crit.get());
         assert(_processCalls == 0);
@@ -237,13 +236,20 @@ int32_t AudioConferenceMixerImpl::Process()
         _timeScheduler.UpdateScheduler();
     }
 
-    ListWrapper mixList;
-    ListWrapper rampOutList;
-    ListWrapper additionalFramesList;
-    MapWrapper mixedParticipantsMap;
+    AudioFrameList mixList;
+    AudioFrameList rampOutList;
+    AudioFrameList additionalFramesList;
     {
         CriticalSectionScoped cs(_cbCrit.get());
 
+        remainingParticipantsAllowedToMix = _maxMixedParticipants;
+        if(_scratchMixedParticipants.size() < _maxMixedParticipants)
+        {
+            _scratchMixedParticipants.resize(_maxMixedParticipants);
+            _scratchVadPositiveParticipants.resize(_maxMixedParticipants);
+        }
+        mixList.reserve(_maxMixedParticipants);
+
         int32_t lowFreq = GetLowestMixingFrequency();
         // SILK can run in 12 kHz and 24 kHz. These frequencies are not
         // supported so use the closest higher frequency to not lose any
@@ -297,19 +303,13 @@ int32_t AudioConferenceMixerImpl::Process()
             }
         }
 
-        UpdateToMix(mixList, rampOutList, mixedParticipantsMap,
-                    remainingParticipantsAllowedToMix);
+        UpdateToMix(mixList, rampOutList, remainingParticipantsAllowedToMix);
 
         GetAdditionalAudio(additionalFramesList);
-        UpdateMixedStatus(mixedParticipantsMap);
-        _scratchParticipantsToMixAmount = mixedParticipantsMap.Size();
+        UpdateMixedStatus(mixList);
+        _scratchParticipantsToMixAmount = static_cast<uint32_t>(mixList.size());
     }
 
-    // Clear mixedParticipantsMap to avoid memory leak warning.
-    // Please note that the mixedParticipantsMap doesn't own any dynamically
-    // allocated memory.
-    while(mixedParticipantsMap.Erase(mixedParticipantsMap.First()) == 0) {}
-
     // Get an AudioFrame for mixing from the memory pool.
     AudioFrame* mixedAudio = NULL;
     if(_audioFramePool->PopMemory(mixedAudio) == -1)
@@ -346,6 +346,10 @@ int32_t AudioConferenceMixerImpl::Process()
         MixFromList(*mixedAudio, mixList);
         MixAnonomouslyFromList(*mixedAudio, additionalFramesList);
         MixAnonomouslyFromList(*mixedAudio, rampOutList);
+        if(_numMixedParticipants != 1)
+        {
+            SaturateMixedAudio(*mixedAudio);
+        }
 
         if(mixedAudio->samples_per_channel_ == 0)
         {
@@ -387,17 +391,23 @@ int32_t AudioConferenceMixerImpl::Process()
                 0);
         }
 
+        if(_mixMinusReceiver != NULL)
+        {
+            SendMixMinusAudio(*mixedAudio, mixList, additionalFramesList,
+                              rampOutList);
+        }
+
         if((_mixerStatusCallback != NULL) &&
             timeForMixerCallback)
         {
             _mixerStatusCallback->MixedParticipants(
                 _id,
-                _scratchMixedParticipants,
+                &_scratchMixedParticipants[0],
                 _scratchParticipantsToMixAmount);
 
             _mixerStatusCallback->VADPositiveParticipants(
                 _id,
-                _scratchVadPositiveParticipants,
+                &_scratchVadPositiveParticipants[0],
                 _scratchVadPositiveParticipantsAmount);
             _mixerStatusCallback->MixedAudioLevel(_id,audioLevel);
         }
@@ -438,6 +448,29 @@ int32_t AudioConferenceMixerImpl::UnRegisterMixedStreamCallback()
     return 0;
 }
 
+int32_t AudioConferenceMixerImpl::RegisterMixMinusCallback(
+    AudioMixerMixMinusReceiver& receiver)
+{
+    CriticalSectionScoped cs(_cbCrit.get());
+    if(_mixMinusReceiver != NULL)
+    {
+        return -1;
+    }
+    _mixMinusReceiver = &receiver;
+    return 0;
+}
+
+int32_t AudioConferenceMixerImpl::UnRegisterMixMinusCallback()
+{
+    CriticalSectionScoped cs(_cbCrit.get());
+    if(_mixMinusReceiver == NULL)
+    {
+        return -1;
+    }
+    _mixMinusReceiver = NULL;
+    return 0;
+}
+
 int32_t AudioConferenceMixerImpl::SetOutputFrequency(
     const Frequency frequency)
 {
@@ -573,13 +606,7 @@ int32_t AudioConferenceMixerImpl::SetMixabilityStatus(
             return -1;
         }
 
-        int numMixedNonAnonymous = _participantList.GetSize();
-        if (numMixedNonAnonymous > kMaximumAmountOfMixedParticipants)
-        {
-            numMixedNonAnonymous = kMaximumAmountOfMixedParticipants;
-        }
-        numMixedParticipants = numMixedNonAnonymous +
-                               _additionalParticipantList.GetSize();
+        numMixedParticipants = NumMixedParticipants();
     }
     // A MixerParticipant was added or removed. Make sure the scratch
     // buffer is updated if necessary.
@@ -647,6 +674,33 @@ int32_t AudioConferenceMixerImpl::AnonymousMixabilityStatus(
     return 0;
 }
 
+int32_t AudioConferenceMixerImpl::SetMaximumMixedParticipants(
+    uint32_t maxParticipants)
+{
+    if(maxParticipants == 0)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceAudioMixerServer, _id,
+                     "SetMaximumMixedParticipants must mix at least one "
+                     "participant");
+        return -1;
+    }
+    uint32_t numMixedParticipants;
+    {
+        CriticalSectionScoped cs(_cbCrit.get());
+        _maxMixedParticipants = maxParticipants;
+        numMixedParticipants = NumMixedParticipants();
+    }
+    CriticalSectionScoped cs(_crit.get());
+    _numMixedParticipants = numMixedParticipants;
+    return 0;
+}
+
+uint32_t AudioConferenceMixerImpl::MaximumMixedParticipants() const
+{
+    CriticalSectionScoped cs(_cbCrit.get());
+    return _maxMixedParticipants;
+}
+
 int32_t AudioConferenceMixerImpl::SetMinimumMixingFrequency(
     Frequency freq)
 {
@@ -697,56 +751,47 @@ int32_t AudioConferenceMixerImpl::GetLowestMixingFrequency()
 }
 
 int32_t AudioConferenceMixerImpl::GetLowestMixingFrequencyFromList(
-    ListWrapper& mixList)
+    const MixerParticipantList& mixList)
 {
     int32_t highestFreq = 8000;
-    ListItem* item = mixList.First();
-    while(item)
+    for(MixerParticipantList::const_iterator it = mixList.begin();
+        it != mixList.end();
+        ++it)
     {
-        MixerParticipant* participant =
-            static_cast<MixerParticipant*>(item->GetItem());
-        const int32_t neededFrequency = participant->NeededFrequency(_id);
+        const int32_t neededFrequency = (*it)->NeededFrequency(_id);
         if(neededFrequency > highestFreq)
         {
             highestFreq = neededFrequency;
         }
-        item = mixList.Next(item);
     }
     return highestFreq;
 }
 
 void AudioConferenceMixerImpl::UpdateToMix(
-    ListWrapper& mixList,
-    ListWrapper& rampOutList,
-    MapWrapper& mixParticipantList,
+    AudioFrameList& mixList,
+    AudioFrameList& rampOutList,
     uint32_t& maxAudioFrameCounter)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
-                 "UpdateToMix(mixList,rampOutList,mixParticipantList,%d)",
+                 "UpdateToMix(mixList,rampOutList,%d)",
                  maxAudioFrameCounter);
-    const uint32_t mixListStartSize = mixList.GetSize();
-    ListWrapper activeList; // Elements are AudioFrames
-    // Struct needed by the passive lists to keep track of which AudioFrame
-    // belongs to which MixerParticipant.
-    struct ParticipantFramePair
-    {
-        MixerParticipant* participant;
-        AudioFrame* audioFrame;
-    };
-    ListWrapper passiveWasNotMixedList; // Elements are MixerParticipant
-    ListWrapper passiveWasMixedList;    // Elements are MixerParticipant
-    ListItem* item = _participantList.First();
-    while(item)
+    const uint32_t mixListStartSize = static_cast<uint32_t>(mixList.size());
+    AudioFrameList activeList;
+    AudioFrameList passiveWasNotMixedList;
+    AudioFrameList passiveWasMixedList;
+    activeList.reserve(maxAudioFrameCounter);
+    for(MixerParticipantList::const_iterator it = _participantList.begin();
+        it != _participantList.end();
+        ++it)
     {
         // Stop keeping track of passive participants if there are already
         // enough participants available (they wont be mixed anyway).
         bool mustAddToPassiveList = (maxAudioFrameCounter >
-                                    (activeList.GetSize() +
-                                     passiveWasMixedList.GetSize() +
-                                     passiveWasNotMixedList.GetSize()));
+                                    (activeList.size() +
+                                     passiveWasMixedList.size() +
+                                     passiveWasNotMixedList.size()));
 
-        MixerParticipant* participant = static_cast<MixerParticipant*>(
-            item->GetItem());
+        MixerParticipant* participant = *it;
         bool wasMixed = false;
         participant->_mixHistory->WasMixed(wasMixed);
         AudioFrame* audioFrame = NULL;
@@ -764,7 +809,6 @@ void AudioConferenceMixerImpl::UpdateToMix(
             WEBRTC_TRACE(kTraceWarning, kTraceAudioMixerServer, _id,
                          "failed to GetAudioFrame() from participant");
             _audioFramePool->PushMemory(audioFrame);
-            item = _participantList.Next(item);
             continue;
         }
         // TODO(henrike): this assert triggers in some test cases where SRTP is
@@ -784,175 +828,119 @@ void AudioConferenceMixerImpl::UpdateToMix(
                 RampIn(*audioFrame);
             }
 
-            if(activeList.GetSize() >= maxAudioFrameCounter)
+            if(activeList.size() >= maxAudioFrameCounter)
             {
                 // There are already more active participants than should be
                 // mixed. Only keep the ones with the highest energy.
-                ListItem* replaceItem = NULL;
+                AudioFrameList::iterator replaceItem =
+                    activeList.end();
                 CalculateEnergy(*audioFrame);
                 uint32_t lowestEnergy = audioFrame->energy_;
 
-                ListItem* activeItem = activeList.First();
-                while(activeItem)
+                for(AudioFrameList::iterator activeItem =
+                        activeList.begin();
+                    activeItem != activeList.end();
+                    ++activeItem)
                 {
-                    AudioFrame* replaceFrame = static_cast<AudioFrame*>(
-                        activeItem->GetItem());
-                    CalculateEnergy(*replaceFrame);
-                    if(replaceFrame->energy_ < lowestEnergy)
+                    CalculateEnergy(*activeItem->audioFrame);
+                    if(activeItem->audioFrame->energy_ < lowestEnergy)
                     {
                         replaceItem = activeItem;
-                        lowestEnergy = replaceFrame->energy_;
+                        lowestEnergy = activeItem->audioFrame->energy_;
                     }
-                    activeItem = activeList.Next(activeItem);
                 }
-                if(replaceItem != NULL)
+                if(replaceItem != activeList.end())
                 {
-                    AudioFrame* replaceFrame = static_cast<AudioFrame*>(
-                        replaceItem->GetItem());
+                    MixerParticipant* replaceParticipant =
+                        replaceItem->participant;
+                    AudioFrame* replaceFrame = replaceItem->audioFrame;
 
                     bool replaceWasMixed = false;
-                    MapItem* replaceParticipant = mixParticipantList.Find(
-                        replaceFrame->id_);
-                    // When a frame is pushed to |activeList| it is also pushed
-                    // to mixParticipantList with the frame's id. This means
-                    // that the Find call above should never fail.
-                    if(replaceParticipant == NULL)
+                    replaceParticipant->_mixHistory->WasMixed(
+                        replaceWasMixed);
+                    *replaceItem = MakeParticipantFramePair(participant,
+                                                            audioFrame);
+
+                    if(replaceWasMixed)
                     {
-                        assert(false);
+                        RampOut(*replaceFrame);
+                        rampOutList.push_back(MakeParticipantFramePair(
+                            replaceParticipant, replaceFrame));
                     } else {
-                        static_cast<MixerParticipant*>(
-                            replaceParticipant->GetItem())->_mixHistory->
-                            WasMixed(replaceWasMixed);
-
-                        mixParticipantList.Erase(replaceFrame->id_);
-                        activeList.Erase(replaceItem);
-
-                        activeList.PushFront(static_cast<void*>(audioFrame));
-                        mixParticipantList.Insert(
-                            audioFrame->id_,
-                            static_cast<void*>(participant));
-                        assert(mixParticipantList.Size() <=
-                               kMaximumAmountOfMixedParticipants);
-
-                        if(replaceWasMixed)
-                        {
-                            RampOut(*replaceFrame);
-                            rampOutList.PushBack(
-                                static_cast<void*>(replaceFrame));
-                            assert(rampOutList.GetSize() <=
-                                   kMaximumAmountOfMixedParticipants);
-                        } else {
-                            _audioFramePool->PushMemory(replaceFrame);
-                        }
+                        _audioFramePool->PushMemory(replaceFrame);
                     }
                 } else {
                     if(wasMixed)
                     {
                         RampOut(*audioFrame);
-                        rampOutList.PushBack(static_cast<void*>(audioFrame));
-                        assert(rampOutList.GetSize() <=
-                               kMaximumAmountOfMixedParticipants);
+                        rampOutList.push_back(MakeParticipantFramePair(
+                            participant, audioFrame));
                     } else {
                         _audioFramePool->PushMemory(audioFrame);
                     }
                 }
             } else {
-                activeList.PushFront(static_cast<void*>(audioFrame));
-                mixParticipantList.Insert(audioFrame->id_,
-                                          static_cast<void*>(participant));
-                assert(mixParticipantList.Size() <=
-                       kMaximumAmountOfMixedParticipants);
+                activeList.push_back(MakeParticipantFramePair(participant,
+                                                              audioFrame));
             }
         } else {
             if(wasMixed)
             {
-                ParticipantFramePair* pair = new ParticipantFramePair;
-                pair->audioFrame  = audioFrame;
-                pair->participant = participant;
-                passiveWasMixedList.PushBack(static_cast<void*>(pair));
+                passiveWasMixedList.push_back(
+                    MakeParticipantFramePair(participant, audioFrame));
             } else if(mustAddToPassiveList) {
                 RampIn(*audioFrame);
-                ParticipantFramePair* pair = new ParticipantFramePair;
-                pair->audioFrame  = audioFrame;
-                pair->participant = participant;
-                passiveWasNotMixedList.PushBack(static_cast<void*>(pair));
+                passiveWasNotMixedList.push_back(
+                    MakeParticipantFramePair(participant, audioFrame));
             } else {
                 _audioFramePool->PushMemory(audioFrame);
             }
         }
-        item = _participantList.Next(item);
     }
-    assert(activeList.GetSize() <= maxAudioFrameCounter);
+    assert(activeList.size() <= maxAudioFrameCounter);
     // At this point it is known which participants should be mixed. Transfer
     // this information to this functions output parameters.
-    while(!activeList.Empty())
-    {
-        ListItem* mixItem = activeList.First();
-        mixList.PushBack(mixItem->GetItem());
-        activeList.Erase(mixItem);
-    }
+    mixList.insert(mixList.end(), activeList.begin(), activeList.end());
     // Always mix a constant number of AudioFrames. If there aren't enough
     // active participants mix passive ones. Starting with those that was mixed
-    // last iteration.
-    while(!passiveWasMixedList.Empty())
-    {
-        ListItem* mixItem = passiveWasMixedList.First();
-        ParticipantFramePair* pair = static_cast<ParticipantFramePair*>(
-            mixItem->GetItem());
-        if(mixList.GetSize() <  maxAudioFrameCounter + mixListStartSize)
-        {
-            mixList.PushBack(pair->audioFrame);
-            mixParticipantList.Insert(pair->audioFrame->id_,
-                                      static_cast<void*>(pair->participant));
-            assert(mixParticipantList.Size() <=
-                   kMaximumAmountOfMixedParticipants);
-        }
-        else
-        {
-            _audioFramePool->PushMemory(pair->audioFrame);
-        }
-        delete pair;
-        passiveWasMixedList.Erase(mixItem);
-    }
-    // And finally the ones that have not been mixed for a while.
-    while(!passiveWasNotMixedList.Empty())
+    // last iteration, and finally the ones that have not been mixed for a
+    // while.
+    passiveWasMixedList.insert(passiveWasMixedList.end(),
+                               passiveWasNotMixedList.begin(),
+                               passiveWasNotMixedList.end());
+    for(AudioFrameList::iterator it = passiveWasMixedList.begin();
+        it != passiveWasMixedList.end();
+        ++it)
     {
-        ListItem* mixItem = passiveWasNotMixedList.First();
-        ParticipantFramePair* pair = static_cast<ParticipantFramePair*>(
-            mixItem->GetItem());
-        if(mixList.GetSize() <  maxAudioFrameCounter + mixListStartSize)
+        if(mixList.size() < maxAudioFrameCounter + mixListStartSize)
         {
-            mixList.PushBack(pair->audioFrame);
-            mixParticipantList.Insert(pair->audioFrame->id_,
-                                      static_cast<void*>(pair->participant));
-            assert(mixParticipantList.Size() <=
-                   kMaximumAmountOfMixedParticipants);
+            mixList.push_back(*it);
         }
         else
         {
-            _audioFramePool->PushMemory(pair->audioFrame);
+            _audioFramePool->PushMemory(it->audioFrame);
         }
-        delete pair;
-        passiveWasNotMixedList.Erase(mixItem);
     }
-    assert(maxAudioFrameCounter + mixListStartSize >= mixList.GetSize());
-    maxAudioFrameCounter += mixListStartSize - mixList.GetSize();
+    assert(maxAudioFrameCounter + mixListStartSize >= mixList.size());
+    maxAudioFrameCounter += mixListStartSize -
+        static_cast<uint32_t>(mixList.size());
 }
 
 void AudioConferenceMixerImpl::GetAdditionalAudio(
-    ListWrapper& additionalFramesList)
+    AudioFrameList& additionalFramesList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "GetAdditionalAudio(additionalFramesList)");
-    ListItem* item = _additionalParticipantList.First();
-    while(item)
+    // The GetAudioFrame() callback may remove the current participant from
+    // _additionalParticipantList. Iterate over a copy just in case that
+    // happens.
+    const MixerParticipantList additionalParticipants(
+        _additionalParticipantList);
+    for(MixerParticipantList::const_iterator it =
+            additionalParticipants.begin();
+        it != additionalParticipants.end();
+        ++it)
     {
-        // The GetAudioFrame() callback may remove the current item. Store the
-        // next item just in case that happens.
-        ListItem* nextItem = _additionalParticipantList.Next(item);
-
-        MixerParticipant* participant = static_cast<MixerParticipant*>(
-            item->GetItem());
         AudioFrame* audioFrame = NULL;
         if(_audioFramePool->PopMemory(audioFrame) == -1)
         {
@@ -962,81 +950,72 @@ void AudioConferenceMixerImpl::GetAdditionalAudio(
             return;
         }
         audioFrame->sample_rate_hz_ = _outputFrequency;
-        if(participant->GetAudioFrame(_id, *audioFrame) != 0)
+        if((*it)->GetAudioFrame(_id, *audioFrame) != 0)
         {
             WEBRTC_TRACE(kTraceWarning, kTraceAudioMixerServer, _id,
                          "failed to GetAudioFrame() from participant");
             _audioFramePool->PushMemory(audioFrame);
-            item = nextItem;
             continue;
         }
         if(audioFrame->samples_per_channel_ == 0)
         {
             // Empty frame. Don't use it.
             _audioFramePool->PushMemory(audioFrame);
-            item = nextItem;
             continue;
         }
-        additionalFramesList.PushBack(static_cast<void*>(audioFrame));
-        item = nextItem;
+        additionalFramesList.push_back(MakeParticipantFramePair(*it,
+                                                                audioFrame));
     }
 }
 
 void AudioConferenceMixerImpl::UpdateMixedStatus(
-    MapWrapper& mixedParticipantsMap)
+    const AudioFrameList& mixList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
-                 "UpdateMixedStatus(mixedParticipantsMap)");
-    assert(mixedParticipantsMap.Size() <= kMaximumAmountOfMixedParticipants);
-
-    // Loop through all participants. If they are in the mix map they
-    // were mixed.
-    ListItem* participantItem = _participantList.First();
-    while(participantItem != NULL)
+                 "UpdateMixedStatus(mixList)");
+    assert(mixList.size() <= _maxMixedParticipants);
+
+    // Clear the status of all participants and then mark the ones that were
+    // mixed.
+    for(MixerParticipantList::const_iterator it = _participantList.begin();
+        it != _participantList.end();
+        ++it)
     {
-        bool isMixed = false;
-        MixerParticipant* participant =
-            static_cast<MixerParticipant*>(participantItem->GetItem());
-
-        MapItem* mixedItem = mixedParticipantsMap.First();
-        while(mixedItem)
-        {
-            if(participant == mixedItem->GetItem())
-            {
-                isMixed = true;
-                break;
-            }
-            mixedItem = mixedParticipantsMap.Next(mixedItem);
-        }
-        participant->_mixHistory->SetIsMixed(isMixed);
-        participantItem = _participantList.Next(participantItem);
+        (*it)->_mixHistory->SetIsMixed(false);
+    }
+    for(AudioFrameList::const_iterator it = mixList.begin();
+        it != mixList.end();
+        ++it)
+    {
+        it->participant->_mixHistory->SetIsMixed(true);
     }
 }
 
-void AudioConferenceMixerImpl::ClearAudioFrameList(ListWrapper& audioFrameList)
+void AudioConferenceMixerImpl::ClearAudioFrameList(
+    AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "ClearAudioFrameList(audioFrameList)");
-    ListItem* item = audioFrameList.First();
-    while(item)
+    for(AudioFrameList::iterator it = audioFrameList.begin();
+        it != audioFrameList.end();
+        ++it)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        _audioFramePool->PushMemory(audioFrame);
-        audioFrameList.Erase(item);
-        item = audioFrameList.First();
+        _audioFramePool->PushMemory(it->audioFrame);
     }
+    audioFrameList.clear();
 }
 
 void AudioConferenceMixerImpl::UpdateVADPositiveParticipants(
-    ListWrapper& mixList)
+    const AudioFrameList& mixList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "UpdateVADPositiveParticipants(mixList)");
 
-    ListItem* item = mixList.First();
-    while(item != NULL)
+    for(AudioFrameList::const_iterator it = mixList.begin();
+        it != mixList.end();
+        ++it)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
+        AudioFrame* audioFrame = it->audioFrame;
         CalculateEnergy(*audioFrame);
         if(audioFrame->vad_activity_ == AudioFrame::kVadActive)
         {
@@ -1048,40 +1027,26 @@ void AudioConferenceMixerImpl::UpdateVADPositiveParticipants(
                 _scratchVadPositiveParticipantsAmount].level = 0;
             _scratchVadPositiveParticipantsAmount++;
         }
-        item = mixList.Next(item);
     }
 }
 
 bool AudioConferenceMixerImpl::IsParticipantInList(
-    MixerParticipant& participant,
-    ListWrapper& participantList)
+    const MixerParticipant& participant,
+    const MixerParticipantList& participantList) const
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "IsParticipantInList(participant,participantList)");
-    ListItem* item = participantList.First();
-    while(item != NULL)
-    {
-        MixerParticipant* rhsParticipant =
-            static_cast<MixerParticipant*>(item->GetItem());
-        if(&participant == rhsParticipant)
-        {
-            return true;
-        }
-        item = participantList.Next(item);
-    }
-    return false;
+    return std::find(participantList.begin(), participantList.end(),
+                     &participant) != participantList.end();
 }
 
 bool AudioConferenceMixerImpl::AddParticipantToList(
     MixerParticipant& participant,
-    ListWrapper& participantList)
+    MixerParticipantList& participantList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "AddParticipantToList(participant, participantList)");
-    if(participantList.PushBack(static_cast<void*>(&participant)) == -1)
-    {
-        return false;
-    }
+    participantList.push_back(&participant);
     // Make sure that the mixed status is correct for new MixerParticipant.
     participant._mixHistory->ResetMixedStatus();
     return true;
@@ -1089,34 +1054,38 @@ bool AudioConferenceMixerImpl::AddParticipantToList(
 
 bool AudioConferenceMixerImpl::RemoveParticipantFromList(
     MixerParticipant& participant,
-    ListWrapper& participantList)
+    MixerParticipantList& participantList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "RemoveParticipantFromList(participant, participantList)");
-    ListItem* item = participantList.First();
-    while(item)
+    MixerParticipantList::iterator it = std::find(participantList.begin(),
+                                                  participantList.end(),
+                                                  &participant);
+    if(it == participantList.end())
     {
-        if(item->GetItem() == &participant)
-        {
-            participantList.Erase(item);
-            // Participant is no longer mixed, reset to default.
-            participant._mixHistory->ResetMixedStatus();
-            return true;
-        }
-        item = participantList.Next(item);
+        return false;
     }
-    return false;
+    participantList.erase(it);
+    // Participant is no longer mixed, reset to default.
+    participant._mixHistory->ResetMixedStatus();
+    return true;
+}
+
+uint32_t AudioConferenceMixerImpl::NumMixedParticipants() const
+{
+    const uint32_t numMixedNonAnonymous = std::min(
+        static_cast<uint32_t>(_participantList.size()), _maxMixedParticipants);
+    return numMixedNonAnonymous +
+        static_cast<uint32_t>(_additionalParticipantList.size());
 }
 
 int32_t AudioConferenceMixerImpl::MixFromList(
     AudioFrame& mixedAudio,
-    const ListWrapper& audioFrameList)
+    const AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "MixFromList(mixedAudio, audioFrameList)");
-    uint32_t position = 0;
-    ListItem* item = audioFrameList.First();
-    if(item == NULL)
+    if(audioFrameList.empty())
     {
         return 0;
     }
@@ -1124,35 +1093,36 @@ int32_t AudioConferenceMixerImpl::MixFromList(
     if(_numMixedParticipants == 1)
     {
         // No mixing required here; skip the saturation protection.
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
+        AudioFrame* audioFrame = audioFrameList.front().audioFrame;
         mixedAudio.CopyFrom(*audioFrame);
-        SetParticipantStatistics(&_scratchMixedParticipants[position],
+        SetParticipantStatistics(&_scratchMixedParticipants[0],
                                  *audioFrame);
         return 0;
     }
 
-    while(item != NULL)
+    uint32_t position = 0;
+    for(AudioFrameList::const_iterator it = audioFrameList.begin();
+        it != audioFrameList.end();
+        ++it)
     {
-        if(position >= kMaximumAmountOfMixedParticipants)
+        if(position >= _scratchMixedParticipants.size())
         {
             WEBRTC_TRACE(
                 kTraceMemory,
                 kTraceAudioMixerServer,
                 _id,
                 "Trying to mix more than max amount of mixed participants:%d!",
-                kMaximumAmountOfMixedParticipants);
+                static_cast<int>(_scratchMixedParticipants.size()));
             // Assert and avoid crash
             assert(false);
             position = 0;
         }
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        MixFrames(&mixedAudio, audioFrame);
+        AccumulateFrame(mixedAudio, *it->audioFrame);
 
         SetParticipantStatistics(&_scratchMixedParticipants[position],
-                                 *audioFrame);
+                                 *it->audioFrame);
 
         position++;
-        item = audioFrameList.Next(item);
     }
 
     return 0;
@@ -1161,31 +1131,184 @@ int32_t AudioConferenceMixerImpl::MixFromList(
 // TODO(andrew): consolidate this function with MixFromList.
 int32_t AudioConferenceMixerImpl::MixAnonomouslyFromList(
     AudioFrame& mixedAudio,
-    const ListWrapper& audioFrameList)
+    const AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "MixAnonomouslyFromList(mixedAudio, audioFrameList)");
-    ListItem* item = audioFrameList.First();
-    if(item == NULL)
+    if(audioFrameList.empty())
         return 0;
 
     if(_numMixedParticipants == 1)
     {
         // No mixing required here; skip the saturation protection.
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        mixedAudio.CopyFrom(*audioFrame);
+        mixedAudio.CopyFrom(*audioFrameList.front().audioFrame);
         return 0;
     }
 
-    while(item != NULL)
+    for(AudioFrameList::const_iterator it = audioFrameList.begin();
+        it != audioFrameList.end();
+        ++it)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        MixFrames(&mixedAudio, audioFrame);
-        item = audioFrameList.Next(item);
+        AccumulateFrame(mixedAudio, *it->audioFrame);
     }
     return 0;
 }
 
+void AudioConferenceMixerImpl::AccumulateFrame(AudioFrame& mixedAudio,
+                                               const AudioFrame& audioFrame)
+{
+    // Same frame properties as AudioFrame::operator+=().
+    assert(mixedAudio.num_channels_ >= audioFrame.num_channels_);
+    if(mixedAudio.samples_per_channel_ == 0)
+    {
+        // First frame of this mix iteration.
+        mixedAudio.samples_per_channel_ = audioFrame.samples_per_channel_;
+        memset(_mixBuffer, 0, sizeof(_mixBuffer[0]) *
+               mixedAudio.samples_per_channel_ * mixedAudio.num_channels_);
+    }
+    else if(mixedAudio.samples_per_channel_ !=
+            audioFrame.samples_per_channel_)
+    {
+        return;
+    }
+    if((mixedAudio.vad_activity_ == AudioFrame::kVadActive) ||
+        audioFrame.vad_activity_ == AudioFrame::kVadActive)
+    {
+        mixedAudio.vad_activity_ = AudioFrame::kVadActive;
+    }
+    else if((mixedAudio.vad_activity_ == AudioFrame::kVadUnknown) ||
+        audioFrame.vad_activity_ == AudioFrame::kVadUnknown)
+    {
+        mixedAudio.vad_activity_ = AudioFrame::kVadUnknown;
+    }
+    if(mixedAudio.speech_type_ != audioFrame.speech_type_)
+    {
+        mixedAudio.speech_type_ = AudioFrame::kUndefined;
+    }
+
+    if(mixedAudio.num_channels_ > audioFrame.num_channels_)
+    {
+        // We only support mono-to-stereo.
+        assert(mixedAudio.num_channels_ == 2 &&
+               audioFrame.num_channels_ == 1);
+        _mixingFunctions.accumulate_mono_to_stereo(
+            audioFrame.data_, _mixBuffer, audioFrame.samples_per_channel_);
+    }
+    else
+    {
+        _mixingFunctions.accumulate(
+            audioFrame.data_, _mixBuffer,
+            audioFrame.samples_per_channel_ * audioFrame.num_channels_);
+    }
+}
+
+void AudioConferenceMixerImpl::SaturateMixedAudio(AudioFrame& mixedAudio)
+{
+    // Divide by two to avoid saturation in the limiter, which restores the
+    // level afterwards.
+    _mixingFunctions.saturate(
+        _mixBuffer, 1, mixedAudio.data_,
+        mixedAudio.samples_per_channel_ * mixedAudio.num_channels_);
+    mixedAudio.energy_ = 0xffffffff;
+}
+
+void AudioConferenceMixerImpl::SendMixMinusAudio(
+    const AudioFrame& mixedAudio,
+    const AudioFrameList& mixList,
+    const AudioFrameList& additionalFramesList,
+    const AudioFrameList& rampOutList)
+{
+    // Collect the frames that are part of _mixBuffer, sorted by participant
+    // for lookup. AccumulateFrame() skips frames of the wrong length.
+    const AudioFrameList* frameLists[] = { &mixList,
+                                           &additionalFramesList,
+                                           &rampOutList };
+    AudioFrameList contributors;
+    contributors.reserve(mixList.size() + additionalFramesList.size() +
+                         rampOutList.size());
+    int numActive = 0;
+    for(size_t i = 0; i < sizeof(frameLists) / sizeof(frameLists[0]); ++i)
+    {
+        for(AudioFrameList::const_iterator it = frameLists[i]->begin();
+            it != frameLists[i]->end();
+            ++it)
+        {
+            if(it->audioFrame->samples_per_channel_ !=
+               mixedAudio.samples_per_channel_)
+            {
+                continue;
+            }
+            contributors.push_back(*it);
+            if(it->audioFrame->vad_activity_ == AudioFrame::kVadActive)
+            {
+                numActive++;
+            }
+        }
+    }
+    std::sort(contributors.begin(), contributors.end(), ParticipantLess);
+
+    // Only the participants still registered are called back, so a
+    // participant removed while mixing is never touched.
+    const MixerParticipantList* participantLists[] = {
+        &_participantList, &_additionalParticipantList };
+    const int length = mixedAudio.samples_per_channel_ *
+        mixedAudio.num_channels_;
+    for(size_t i = 0;
+        i < sizeof(participantLists) / sizeof(participantLists[0]);
+        ++i)
+    {
+        for(MixerParticipantList::const_iterator it =
+                participantLists[i]->begin();
+            it != participantLists[i]->end();
+            ++it)
+        {
+            AudioFrameList::const_iterator contribution = std::lower_bound(
+                contributors.begin(), contributors.end(),
+                MakeParticipantFramePair(*it, NULL), ParticipantLess);
+            if(contribution == contributors.end() ||
+               contribution->participant != *it)
+            {
+                _mixMinusReceiver->NewMixMinusAudio(_id, **it, mixedAudio);
+                continue;
+            }
+
+            const AudioFrame& ownFrame = *contribution->audioFrame;
+            const bool ownActive =
+                ownFrame.vad_activity_ == AudioFrame::kVadActive;
+            _mixMinusFrame.id_ = mixedAudio.id_;
+            _mixMinusFrame.timestamp_ = mixedAudio.timestamp_;
+            _mixMinusFrame.samples_per_channel_ =
+                mixedAudio.samples_per_channel_;
+            _mixMinusFrame.sample_rate_hz_ = mixedAudio.sample_rate_hz_;
+            _mixMinusFrame.num_channels_ = mixedAudio.num_channels_;
+            _mixMinusFrame.speech_type_ = mixedAudio.speech_type_;
+            _mixMinusFrame.vad_activity_ =
+                (numActive > (ownActive ? 1 : 0)) ?
+                    AudioFrame::kVadActive : AudioFrame::kVadPassive;
+            _mixMinusFrame.energy_ = 0xffffffff;
+            if(_numMixedParticipants == 1)
+            {
+                // mixedAudio is a copy of this participant's frame.
+                _mixMinusFrame.Mute();
+            }
+            else if(ownFrame.num_channels_ < mixedAudio.num_channels_)
+            {
+                AudioFrameOperations::MonoToStereo(
+                    ownFrame.data_, ownFrame.samples_per_channel_,
+                    _upmixBuffer);
+                _mixingFunctions.subtract_and_saturate(
+                    _mixBuffer, _upmixBuffer, _mixMinusFrame.data_, length);
+            }
+            else
+            {
+                _mixingFunctions.subtract_and_saturate(
+                    _mixBuffer, ownFrame.data_, _mixMinusFrame.data_, length);
+            }
+            _mixMinusReceiver->NewMixMinusAudio(_id, **it, _mixMinusFrame);
+        }
+    }
+}
+
 bool AudioConferenceMixerImpl::LimitMixedAudio(AudioFrame& mixedAudio)
 {
     if(_numMixedParticipants == 1)
@@ -11,10 +11,12 @@
 #ifndef WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_CONFERENCE_MIXER_IMPL_H_
 #define WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_CONFERENCE_MIXER_IMPL_H_
 
+#include <vector>
+
 #include "audio_conference_mixer.h"
+#include "audio_mixing_kernels.h"
 #include "engine_configurations.h"
 #include "level_indicator.h"
-#include "list_wrapper.h"
 #include "memory_pool.h"
 #include "module_common_types.h"
 #include "scoped_ptr.h"
@@ -24,6 +26,15 @@ namespace webrtc {
 class AudioProcessing;
 class CriticalSectionWrapper;
 
+// An AudioFrame and the MixerParticipant it was fetched from.
+struct ParticipantFramePair
+{
+    MixerParticipant* participant;
+    AudioFrame* audioFrame;
+};
+typedef std::vector<ParticipantFramePair> AudioFrameList;
+typedef std::vector<MixerParticipant*> MixerParticipantList;
+
 // Cheshire cat implementation of MixerParticipant's non virtual functions.
 class MixHistory
 {
@@ -67,6 +78,9 @@ public:
     virtual int32_t RegisterMixedStreamCallback(
         AudioMixerOutputReceiver& mixReceiver);
     virtual int32_t UnRegisterMixedStreamCallback();
+    virtual int32_t RegisterMixMinusCallback(
+        AudioMixerMixMinusReceiver& receiver);
+    virtual int32_t UnRegisterMixMinusCallback();
     virtual int32_t RegisterMixerStatusCallback(
         AudioMixerStatusReceiver& mixerStatusCallback,
         const uint32_t amountOf10MsBetweenCallbacks);
@@ -80,6 +94,8 @@ public:
         MixerParticipant& participant, const bool mixable);
     virtual int32_t AnonymousMixabilityStatus(
         MixerParticipant& participant, bool& mixable);
+    virtual int32_t SetMaximumMixedParticipants(uint32_t maxParticipants);
+    virtual uint32_t MaximumMixedParticipants() const;
 private:
     enum{DEFAULT_AUDIO_FRAME_POOLSIZE = 50};
 
@@ -92,73 +108,96 @@ private:
     bool SetNumLimiterChannels(int numChannels);
 
     // Fills mixList with the AudioFrames pointers that should be used when
-    // mixing. Fills mixParticipantList with ParticipantStatistics for the
-    // participants who's AudioFrames are inside mixList.
+    // mixing, together with the MixerParticipants they belong to.
     // maxAudioFrameCounter both input and output specifies how many more
     // AudioFrames that are allowed to be mixed.
     // rampOutList contain AudioFrames corresponding to an audio stream that
     // used to be mixed but shouldn't be mixed any longer. These AudioFrames
     // should be ramped out over this AudioFrame to avoid audio discontinuities.
-    void UpdateToMix(ListWrapper& mixList, ListWrapper& rampOutList,
-                     MapWrapper& mixParticipantList,
+    void UpdateToMix(AudioFrameList& mixList, AudioFrameList& rampOutList,
                      uint32_t& maxAudioFrameCounter);
 
     // Return the lowest mixing frequency that can be used without having to
     // downsample any audio.
     int32_t GetLowestMixingFrequency();
-    int32_t GetLowestMixingFrequencyFromList(ListWrapper& mixList);
+    int32_t GetLowestMixingFrequencyFromList(
+        const MixerParticipantList& mixList);
 
     // Return the AudioFrames that should be mixed anonymously.
-    void GetAdditionalAudio(ListWrapper& additionalFramesList);
+    void GetAdditionalAudio(AudioFrameList& additionalFramesList);
 
-    // Update the MixHistory of all MixerParticipants. mixedParticipantsList
-    // should contain a map of MixerParticipants that have been mixed.
-    void UpdateMixedStatus(MapWrapper& mixedParticipantsList);
+    // Update the MixHistory of all MixerParticipants. mixList should contain
+    // the AudioFrames of the MixerParticipants that have been mixed.
+    void UpdateMixedStatus(const AudioFrameList& mixList);
 
     // Clears audioFrameList and reclaims all memory associated with it.
-    void ClearAudioFrameList(ListWrapper& audioFrameList);
+    void ClearAudioFrameList(AudioFrameList& audioFrameList);
 
-    // Update the list of MixerParticipants who have a positive VAD. mixList
-    // should be a list of AudioFrames
-    void UpdateVADPositiveParticipants(
-        ListWrapper& mixList);
+    // Update the list of MixerParticipants who have a positive VAD.
+    void UpdateVADPositiveParticipants(const AudioFrameList& mixList);
 
     // This function returns true if it finds the MixerParticipant in the
     // specified list of MixerParticipants.
     bool IsParticipantInList(
-        MixerParticipant& participant,
-        ListWrapper& participantList);
+        const MixerParticipant& participant,
+        const MixerParticipantList& participantList) const;
 
     // Add/remove the MixerParticipant to the specified
     // MixerParticipant list.
     bool AddParticipantToList(
         MixerParticipant& participant,
-        ListWrapper& participantList);
+        MixerParticipantList& participantList);
     bool RemoveParticipantFromList(
         MixerParticipant& removeParticipant,
-        ListWrapper& participantList);
+        MixerParticipantList& participantList);
+
+    // Returns the number of participants that will be mixed given the
+    // current participant lists. _cbCrit must be held.
+    uint32_t NumMixedParticipants() const;
 
     // Mix the AudioFrames stored in audioFrameList into mixedAudio.
     int32_t MixFromList(
         AudioFrame& mixedAudio,
-        const ListWrapper& audioFrameList);
+        const AudioFrameList& audioFrameList);
     // Mix the AudioFrames stored in audioFrameList into mixedAudio. No
     // record will be kept of this mix (e.g. the corresponding MixerParticipants
     // will not be marked as IsMixed()
     int32_t MixAnonomouslyFromList(AudioFrame& mixedAudio,
-                                   const ListWrapper& audioFrameList);
+                                   const AudioFrameList& audioFrameList);
+
+    // Adds audioFrame to the 32-bit mix in _mixBuffer and updates the
+    // properties of mixedAudio accordingly. Mono frames are upmixed if
+    // mixedAudio is stereo.
+    void AccumulateFrame(AudioFrame& mixedAudio,
+                         const AudioFrame& audioFrame);
+    // Converts _mixBuffer to 16-bit samples in mixedAudio. The mix is halved
+    // to leave headroom for the limiter.
+    void SaturateMixedAudio(AudioFrame& mixedAudio);
 
     bool LimitMixedAudio(AudioFrame& mixedAudio);
 
+    // Delivers one AudioFrame per participant to _mixMinusReceiver. The
+    // participants whose audio is in the mix get _mixBuffer minus their own
+    // frame, saturated but not limited. All other participants get
+    // mixedAudio.
+    void SendMixMinusAudio(const AudioFrame& mixedAudio,
+                           const AudioFrameList& mixList,
+                           const AudioFrameList& additionalFramesList,
+                           const AudioFrameList& rampOutList);
+
     // Scratch memory
     // Note that the scratch memory may only be touched in the scope of
     // Process().
     uint32_t         _scratchParticipantsToMixAmount;
-    ParticipantStatistics  _scratchMixedParticipants[
-        kMaximumAmountOfMixedParticipants];
+    std::vector<ParticipantStatistics> _scratchMixedParticipants;
     uint32_t         _scratchVadPositiveParticipantsAmount;
-    ParticipantStatistics  _scratchVadPositiveParticipants[
-        kMaximumAmountOfMixedParticipants];
+    std::vector<ParticipantStatistics> _scratchVadPositiveParticipants;
+    // 32-bit mix of all AudioFrames, saturated once when mixing is done.
+    int32_t _mixBuffer[AudioFrame::kMaxDataSizeSamples];
+    MixingFunctions _mixingFunctions;
+    // Output of SendMixMinusAudio(), reused for every participant.
+    AudioFrame _mixMinusFrame;
+    int16_t _upmixBuffer[AudioFrame::kMaxDataSizeSamples];
 
     scoped_ptr<CriticalSectionWrapper> _crit;
     scoped_ptr<CriticalSectionWrapper> _cbCrit;
@@ -169,6 +208,7 @@ private:
 
     // Mix result callback
     AudioMixerOutputReceiver* _mixReceiver;
+    AudioMixerMixMinusReceiver* _mixMinusReceiver;
 
     AudioMixerStatusReceiver* _mixerStatusCallback;
     uint32_t            _amountOf10MsBetweenCallbacks;
@@ -183,9 +223,12 @@ private:
     MemoryPool<AudioFrame>* _audioFramePool;
 
     // List of all participants. Note all lists are disjunct
-    ListWrapper _participantList;              // May be mixed.
-    ListWrapper _additionalParticipantList;    // Always mixed, anonomously.
+    MixerParticipantList _participantList;            // May be mixed.
+    MixerParticipantList _additionalParticipantList;  // Always mixed,
+                                                      // anonomously.
 
+    // Maximum number of participants in _participantList that are mixed.
+    uint32_t _maxMixedParticipants;
     uint32_t _numMixedParticipants;
 
     uint32_t _timeStamp;
@@ -0,0 +1,538 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modules/audio_conference_mixer/interface/audio_conference_mixer.h"
+#include "modules/audio_conference_mixer/interface/audio_conference_mixer_defines.h"
+#include "modules/audio_conference_mixer/source/audio_mixing_kernels.h"
+#include "system_wrappers/interface/cpu_features_wrapper.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+const int kMaxLength = AudioFrame::kMaxDataSizeSamples / 2;
+
+struct MixingKernels {
+  const char* name;
+  MixingFunctions functions;
+};
+
+// Returns the kernels that can run on this CPU, the C version first.
+std::vector<MixingKernels> SupportedKernels() {
+  std::vector<MixingKernels> kernels;
+  MixingKernels c = { "C", { Accumulate_C, AccumulateMonoToStereo_C,
+                             Saturate_C, SubtractAndSaturate_C } };
+  kernels.push_back(c);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    MixingKernels sse2 = { "SSE2", { Accumulate_SSE2,
+                                     AccumulateMonoToStereo_SSE2,
+                                     Saturate_SSE2,
+                                     SubtractAndSaturate_SSE2 } };
+    kernels.push_back(sse2);
+  }
+#elif defined(WEBRTC_ARCH_ARM_V7)
+  if (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) {
+    MixingKernels neon = { "NEON", { Accumulate_NEON,
+                                     AccumulateMonoToStereo_NEON,
+                                     Saturate_NEON,
+                                     SubtractAndSaturate_NEON } };
+    kernels.push_back(neon);
+  }
+#endif
+  return kernels;
+}
+
+void FillRandom(int16_t* data, int length) {
+  for (int i = 0; i < length; ++i) {
+    data[i] = static_cast<int16_t>(rand());
+  }
+}
+
+class FakeParticipant : public MixerParticipant {
+ public:
+  FakeParticipant(int id, int num_channels, int16_t amplitude)
+      : id_(id),
+        num_channels_(num_channels),
+        amplitude_(amplitude),
+        sample_rate_hz_(16000) {}
+
+  virtual int32_t GetAudioFrame(const int32_t id, AudioFrame& audio_frame) {
+    const int samples_per_channel = sample_rate_hz_ / 100;
+    audio_frame.UpdateFrame(id_, 0, NULL, samples_per_channel,
+                            sample_rate_hz_, AudioFrame::kNormalSpeech,
+                            AudioFrame::kVadActive, num_channels_);
+    for (int i = 0; i < samples_per_channel * num_channels_; ++i) {
+      // A square wave, so the energy follows the amplitude.
+      audio_frame.data_[i] = ((i / num_channels_) & 1) ? amplitude_ :
+          -amplitude_;
+    }
+    return 0;
+  }
+
+  virtual int32_t NeededFrequency(const int32_t id) {
+    return sample_rate_hz_;
+  }
+
+  void set_sample_rate_hz(int sample_rate_hz) {
+    sample_rate_hz_ = sample_rate_hz;
+  }
+
+  int id() const { return id_; }
+  int16_t amplitude() const { return amplitude_; }
+
+  bool IsMixed() const {
+    bool mixed = false;
+    MixerParticipant::IsMixed(mixed);
+    return mixed;
+  }
+
+ private:
+  int id_;
+  int num_channels_;
+  int16_t amplitude_;
+  int sample_rate_hz_;
+};
+
+class MixedAudioReceiver : public AudioMixerOutputReceiver {
+ public:
+  MixedAudioReceiver() : num_calls_(0) {}
+
+  virtual void NewMixedAudio(const int32_t id,
+                             const AudioFrame& general_audio_frame,
+                             const AudioFrame** unique_audio_frames,
+                             const uint32_t size) {
+    mixed_frame_.CopyFrom(general_audio_frame);
+    ++num_calls_;
+  }
+
+  AudioFrame mixed_frame_;
+  int num_calls_;
+};
+
+// Keeps the last mix-minus frame of each FakeParticipant, indexed by id.
+class MixMinusReceiver : public AudioMixerMixMinusReceiver {
+ public:
+  explicit MixMinusReceiver(int num_participants)
+      : frames_(num_participants),
+        num_calls_(0) {
+    for (int i = 0; i < num_participants; ++i) {
+      frames_[i] = new AudioFrame;
+    }
+  }
+
+  virtual ~MixMinusReceiver() {
+    for (size_t i = 0; i < frames_.size(); ++i) {
+      delete frames_[i];
+    }
+  }
+
+  virtual void NewMixMinusAudio(const int32_t id,
+                                const MixerParticipant& participant,
+                                const AudioFrame& audio_frame) {
+    const int index = static_cast<const FakeParticipant&>(participant).id();
+    if (index < static_cast<int>(frames_.size())) {
+      frames_[index]->CopyFrom(audio_frame);
+    }
+    ++num_calls_;
+  }
+
+  std::vector<AudioFrame*> frames_;
+  int num_calls_;
+};
+
+class AudioConferenceMixerTest : public ::testing::Test {
+ protected:
+  AudioConferenceMixerTest() : mixer_(AudioConferenceMixer::Create(0)) {}
+
+  virtual void SetUp() {
+    ASSERT_TRUE(mixer_.get() != NULL);
+    ASSERT_EQ(0, mixer_->RegisterMixedStreamCallback(receiver_));
+  }
+
+  virtual void TearDown() {
+    for (size_t i = 0; i < participants_.size(); ++i) {
+      EXPECT_EQ(0, mixer_->SetMixabilityStatus(*participants_[i], false));
+      delete participants_[i];
+    }
+    EXPECT_EQ(0, mixer_->UnRegisterMixedStreamCallback());
+  }
+
+  FakeParticipant* AddParticipant(int num_channels, int16_t amplitude) {
+    FakeParticipant* participant = new FakeParticipant(
+        static_cast<int>(participants_.size()), num_channels, amplitude);
+    participants_.push_back(participant);
+    EXPECT_EQ(0, mixer_->SetMixabilityStatus(*participant, true));
+    return participant;
+  }
+
+  scoped_ptr<AudioConferenceMixer> mixer_;
+  MixedAudioReceiver receiver_;
+  std::vector<FakeParticipant*> participants_;
+};
+
+TEST(AudioMixingKernelsTest, AccumulateMatchesReference) {
+  std::vector<MixingKernels> kernels = SupportedKernels();
+  int16_t src[kMaxLength + 1];
+  int32_t initial[2 * kMaxLength + 2];
+  int32_t result[2 * kMaxLength + 2];
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    SCOPED_TRACE(kernels[k].name);
+    for (int length = 0; length <= 67; ++length) {
+      // Misalign the buffers by one sample.
+      FillRandom(src, length + 1);
+      for (int i = 0; i < 2 * length + 2; ++i) {
+        initial[i] = rand() - RAND_MAX / 2;
+      }
+      memcpy(result, initial, sizeof(result));
+      kernels[k].functions.accumulate(src + 1, result + 1, length);
+      for (int i = 0; i < length; ++i) {
+        ASSERT_EQ(initial[i + 1] + src[i + 1], result[i + 1]);
+      }
+      ASSERT_EQ(initial[0], result[0]);
+      ASSERT_EQ(initial[length + 1], result[length + 1]);
+
+      memcpy(result, initial, sizeof(result));
+      kernels[k].functions.accumulate_mono_to_stereo(src + 1, result + 1,
+                                                     length);
+      for (int i = 0; i < length; ++i) {
+        ASSERT_EQ(initial[2 * i + 1] + src[i + 1], result[2 * i + 1]);
+        ASSERT_EQ(initial[2 * i + 2] + src[i + 1], result[2 * i + 2]);
+      }
+      ASSERT_EQ(initial[0], result[0]);
+      ASSERT_EQ(initial[2 * length + 1], result[2 * length + 1]);
+    }
+  }
+}
+
+TEST(AudioMixingKernelsTest, SaturateMatchesReference) {
+  std::vector<MixingKernels> kernels = SupportedKernels();
+  int32_t src[kMaxLength];
+  int16_t result[kMaxLength + 1];
+  // Sums of up to 32 frames, including the extremes.
+  for (int i = 0; i < kMaxLength; ++i) {
+    src[i] = (rand() % (32 * 65536)) - 32 * 32768;
+  }
+  src[0] = 32 * -32768;
+  src[1] = 32 * 32767;
+  src[2] = 65535;
+  src[3] = -65536;
+  src[4] = -65537;
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    SCOPED_TRACE(kernels[k].name);
+    for (int shift = 0; shift <= 2; ++shift) {
+      for (int length = 0; length <= 67; ++length) {
+        result[length] = 12345;
+        kernels[k].functions.saturate(src, shift, result, length);
+        for (int i = 0; i < length; ++i) {
+          int32_t expected = src[i] >> shift;
+          expected = expected > 32767 ? 32767 : expected;
+          expected = expected < -32768 ? -32768 : expected;
+          ASSERT_EQ(expected, result[i]) << "shift " << shift;
+        }
+        ASSERT_EQ(12345, result[length]);
+      }
+    }
+  }
+}
+
+TEST_F(AudioConferenceMixerTest, MaximumMixedParticipants) {
+  EXPECT_EQ(static_cast<uint32_t>(
+                AudioConferenceMixer::kMaximumAmountOfMixedParticipants),
+            mixer_->MaximumMixedParticipants());
+  EXPECT_EQ(-1, mixer_->SetMaximumMixedParticipants(0));
+  EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(32));
+  EXPECT_EQ(32u, mixer_->MaximumMixedParticipants());
+}
+
+TEST(AudioMixingKernelsTest, SubtractAndSaturateMatchesReference) {
+  std::vector<MixingKernels> kernels = SupportedKernels();
+  int32_t src[kMaxLength];
+  int16_t subtrahend[kMaxLength];
+  int16_t result[kMaxLength + 1];
+  for (int i = 0; i < kMaxLength; ++i) {
+    src[i] = (rand() % (4 * 65536)) - 4 * 32768;
+  }
+  FillRandom(subtrahend, kMaxLength);
+  src[0] = 32767;
+  subtrahend[0] = -32768;
+  src[1] = -32768;
+  subtrahend[1] = 32767;
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    SCOPED_TRACE(kernels[k].name);
+    for (int length = 0; length <= 67; ++length) {
+      result[length] = 12345;
+      kernels[k].functions.subtract_and_saturate(src, subtrahend, result,
+                                                 length);
+      for (int i = 0; i < length; ++i) {
+        int32_t expected = src[i] - subtrahend[i];
+        expected = expected > 32767 ? 32767 : expected;
+        expected = expected < -32768 ? -32768 : expected;
+        ASSERT_EQ(expected, result[i]);
+      }
+      ASSERT_EQ(12345, result[length]);
+    }
+  }
+}
+
+TEST_F(AudioConferenceMixerTest, MixesLoudestParticipants) {
+  const int16_t kAmplitudes[] = { 100, 400, 200, 500, 300 };
+  for (size_t i = 0; i < sizeof(kAmplitudes) / sizeof(kAmplitudes[0]); ++i) {
+    AddParticipant(1, kAmplitudes[i]);
+  }
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_FALSE(participants_[0]->IsMixed());
+  EXPECT_TRUE(participants_[1]->IsMixed());
+  EXPECT_FALSE(participants_[2]->IsMixed());
+  EXPECT_TRUE(participants_[3]->IsMixed());
+  EXPECT_TRUE(participants_[4]->IsMixed());
+
+  EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(4));
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_FALSE(participants_[0]->IsMixed());
+  EXPECT_TRUE(participants_[2]->IsMixed());
+
+  EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(1));
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_FALSE(participants_[1]->IsMixed());
+  EXPECT_TRUE(participants_[3]->IsMixed());
+  EXPECT_FALSE(participants_[4]->IsMixed());
+  EXPECT_EQ(3, receiver_.num_calls_);
+}
+
+TEST_F(AudioConferenceMixerTest, MixesManyParticipants) {
+  const int kNumParticipants = 32;
+  EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(kNumParticipants));
+  for (int i = 0; i < kNumParticipants; ++i) {
+    // Mix mono and stereo participants.
+    AddParticipant(1 + (i & 1), 1000);
+  }
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(0, mixer_->Process());
+  for (int i = 0; i < kNumParticipants; ++i) {
+    EXPECT_TRUE(participants_[i]->IsMixed());
+  }
+  const AudioFrame& mixed = receiver_.mixed_frame_;
+  EXPECT_EQ(2, mixed.num_channels_);
+  EXPECT_EQ(160, mixed.samples_per_channel_);
+  EXPECT_EQ(AudioFrame::kVadActive, mixed.vad_activity_);
+  // The participants add up to well above full scale, which the limiter
+  // brings back down without changing the sign of the samples.
+  for (int i = 0; i < 2 * mixed.samples_per_channel_; ++i) {
+    if ((i / 2) & 1) {
+      EXPECT_GT(mixed.data_[i], 0);
+    } else {
+      EXPECT_LT(mixed.data_[i], 0);
+    }
+  }
+}
+
+TEST_F(AudioConferenceMixerTest, SingleParticipantIsNotModified) {
+  AddParticipant(1, 1000);
+  // The first frame of a newly mixed participant is ramped in.
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(0, mixer_->Process());
+  const AudioFrame& mixed = receiver_.mixed_frame_;
+  ASSERT_EQ(160, mixed.samples_per_channel_);
+  for (int i = 0; i < mixed.samples_per_channel_; ++i) {
+    EXPECT_EQ((i & 1) ? 1000 : -1000, mixed.data_[i]);
+  }
+}
+
+TEST_F(AudioConferenceMixerTest, MixMinusLeavesOutOwnAudio) {
+  // Three mixed participants, one of them in stereo, one anonymous
+  // participant and one participant too quiet to be mixed.
+  AddParticipant(1, 100);
+  AddParticipant(1, 200);
+  AddParticipant(2, 300);
+  FakeParticipant* anonymous = AddParticipant(1, 400);
+  EXPECT_EQ(0, mixer_->SetAnonymousMixabilityStatus(*anonymous, true));
+  AddParticipant(1, 50);
+  const int kSum = 100 + 200 + 300 + 400;
+
+  MixMinusReceiver mix_minus(static_cast<int>(participants_.size()));
+  EXPECT_EQ(-1, mixer_->UnRegisterMixMinusCallback());
+  EXPECT_EQ(0, mixer_->RegisterMixMinusCallback(mix_minus));
+  EXPECT_EQ(-1, mixer_->RegisterMixMinusCallback(mix_minus));
+  // The first frame of a newly mixed participant is ramped in.
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(2 * 5, mix_minus.num_calls_);
+
+  for (int p = 0; p < 4; ++p) {
+    SCOPED_TRACE(p);
+    const AudioFrame& frame = *mix_minus.frames_[p];
+    ASSERT_EQ(2, frame.num_channels_);
+    ASSERT_EQ(160, frame.samples_per_channel_);
+    EXPECT_EQ(AudioFrame::kVadActive, frame.vad_activity_);
+    const int expected = kSum - participants_[p]->amplitude();
+    for (int i = 0; i < 2 * frame.samples_per_channel_; ++i) {
+      ASSERT_EQ(((i / 2) & 1) ? expected : -expected, frame.data_[i]);
+    }
+  }
+  // The participant that was not mixed hears the regular mix.
+  const AudioFrame& mixed = receiver_.mixed_frame_;
+  const AudioFrame& not_mixed = *mix_minus.frames_[4];
+  ASSERT_EQ(mixed.samples_per_channel_, not_mixed.samples_per_channel_);
+  ASSERT_EQ(mixed.num_channels_, not_mixed.num_channels_);
+  EXPECT_EQ(0, memcmp(mixed.data_, not_mixed.data_,
+                      sizeof(mixed.data_[0]) * mixed.samples_per_channel_ *
+                      mixed.num_channels_));
+  EXPECT_EQ(0, mixer_->UnRegisterMixMinusCallback());
+}
+
+TEST_F(AudioConferenceMixerTest, MixMinusOfSingleParticipantIsSilent) {
+  AddParticipant(1, 1000);
+  MixMinusReceiver mix_minus(1);
+  EXPECT_EQ(0, mixer_->RegisterMixMinusCallback(mix_minus));
+  EXPECT_EQ(0, mixer_->Process());
+  const AudioFrame& frame = *mix_minus.frames_[0];
+  ASSERT_EQ(160, frame.samples_per_channel_);
+  EXPECT_EQ(AudioFrame::kVadPassive, frame.vad_activity_);
+  for (int i = 0; i < frame.samples_per_channel_; ++i) {
+    ASSERT_EQ(0, frame.data_[i]);
+  }
+  EXPECT_EQ(0, mixer_->UnRegisterMixMinusCallback());
+}
+
+// Compares the cost per participant of producing a mix-minus frame for every
+// participant, all of them speaking, with summing the other participants
+// separately for each of them. The former grows linearly with the number of
+// participants, the latter quadratically.
+TEST_F(AudioConferenceMixerTest, DISABLED_MixMinusBenchmark) {
+  const int kNumParticipants[] = { 4, 8, 16, 32, 64 };
+  const int kIterations = 200;
+  const int kLength = 160;
+  const MixingFunctions functions = GetMixingFunctions();
+  MixMinusReceiver mix_minus(0);
+  EXPECT_EQ(0, mixer_->RegisterMixMinusCallback(mix_minus));
+  std::vector<AudioFrame*> frames;
+  for (size_t n = 0; n < sizeof(kNumParticipants) / sizeof(int); ++n) {
+    const int num_participants = kNumParticipants[n];
+    while (static_cast<int>(participants_.size()) < num_participants) {
+      FakeParticipant* participant = AddParticipant(
+          1, static_cast<int16_t>(100 + 10 * participants_.size()));
+      frames.push_back(new AudioFrame);
+      participant->GetAudioFrame(0, *frames.back());
+    }
+    EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(num_participants));
+
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      EXPECT_EQ(0, mixer_->Process());
+    }
+    const int64_t mix_minus_us = (TickTime::Now() - start).Microseconds();
+
+    int32_t accumulator[kLength];
+    int16_t output[kLength];
+    start = TickTime::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      for (int p = 0; p < num_participants; ++p) {
+        memset(accumulator, 0, sizeof(accumulator));
+        for (int q = 0; q < num_participants; ++q) {
+          if (q != p) {
+            functions.accumulate(frames[q]->data_, accumulator, kLength);
+          }
+        }
+        functions.saturate(accumulator, 0, output, kLength);
+      }
+    }
+    const int64_t separate_us = (TickTime::Now() - start).Microseconds();
+
+    printf("%2d participants: Process() with mix-minus %.2f us/participant, "
+           "separate mixes %.2f us/participant\n", num_participants,
+           static_cast<double>(mix_minus_us) / kIterations / num_participants,
+           static_cast<double>(separate_us) / kIterations / num_participants);
+  }
+  EXPECT_EQ(kIterations * (4 + 8 + 16 + 32 + 64), mix_minus.num_calls_);
+  for (size_t i = 0; i < frames.size(); ++i) {
+    delete frames[i];
+  }
+  EXPECT_EQ(0, mixer_->UnRegisterMixMinusCallback());
+}
+
+// Mixes 3, 8 and 32 participants at 16, 32 and 48 kHz. Compares summing the
+// frames pairwise with 16-bit saturation (as AudioFrame::operator+=() does)
+// to accumulating them in 32 bits, and times a full Process() call. The
+// limiter does not run at 48 kHz, so Process() is only timed up to 32 kHz.
+TEST_F(AudioConferenceMixerTest, DISABLED_MixingBenchmark) {
+  const int kSampleRates[] = { 16000, 32000, 48000 };
+  const int kNumParticipants[] = { 3, 8, 32 };
+  const int kIterations = 1000;
+  const MixingFunctions functions = GetMixingFunctions();
+  for (size_t p = 0; p < sizeof(kNumParticipants) / sizeof(int); ++p) {
+    const int num_participants = kNumParticipants[p];
+    while (static_cast<int>(participants_.size()) < num_participants) {
+      AddParticipant(1, static_cast<int16_t>(100 * participants_.size()));
+    }
+    EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(num_participants));
+    for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(int); ++r) {
+      const int sample_rate_hz = kSampleRates[r];
+      std::vector<AudioFrame*> frames(num_participants);
+      for (int i = 0; i < num_participants; ++i) {
+        participants_[i]->set_sample_rate_hz(sample_rate_hz);
+        frames[i] = new AudioFrame;
+        participants_[i]->GetAudioFrame(0, *frames[i]);
+      }
+      const int length = sample_rate_hz / 100;
+      AudioFrame mixed;
+      int32_t accumulator[AudioFrame::kMaxDataSizeSamples];
+
+      TickTime start = TickTime::Now();
+      for (int n = 0; n < kIterations; ++n) {
+        mixed.samples_per_channel_ = 0;
+        for (int i = 0; i < num_participants; ++i) {
+          *frames[i] >>= 1;
+          mixed += *frames[i];
+        }
+      }
+      const int64_t pairwise_us = (TickTime::Now() - start).Microseconds();
+
+      start = TickTime::Now();
+      for (int n = 0; n < kIterations; ++n) {
+        memset(accumulator, 0, sizeof(accumulator[0]) * length);
+        for (int i = 0; i < num_participants; ++i) {
+          functions.accumulate(frames[i]->data_, accumulator, length);
+        }
+        functions.saturate(accumulator, 1, mixed.data_, length);
+      }
+      const int64_t accumulate_us = (TickTime::Now() - start).Microseconds();
+
+      int64_t process_us = 0;
+      if (sample_rate_hz <= 32000) {
+        start = TickTime::Now();
+        for (int n = 0; n < kIterations; ++n) {
+          EXPECT_EQ(0, mixer_->Process());
+        }
+        process_us = (TickTime::Now() - start).Microseconds();
+      }
+
+      printf("%2d participants, %d Hz: pairwise %.2f us, accumulated %.2f us, "
+             "Process() %.2f us\n", num_participants, sample_rate_hz,
+             static_cast<double>(pairwise_us) / kIterations,
+             static_cast<double>(accumulate_us) / kIterations,
+             static_cast<double>(process_us) / kIterations);
+      for (int i = 0; i < num_participants; ++i) {
+        delete frames[i];
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
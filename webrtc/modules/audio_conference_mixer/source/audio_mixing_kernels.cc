@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_conference_mixer/source/audio_mixing_kernels.h"
+
+#include "system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+void Accumulate_C(const int16_t* src, int32_t* dst, int length) {
+  for (int i = 0; i < length; ++i) {
+    dst[i] += src[i];
+  }
+}
+
+void AccumulateMonoToStereo_C(const int16_t* src, int32_t* dst, int length) {
+  for (int i = 0; i < length; ++i) {
+    dst[2 * i] += src[i];
+    dst[2 * i + 1] += src[i];
+  }
+}
+
+namespace {
+
+inline int16_t SaturateToInt16(int32_t value) {
+  if (value > 32767) {
+    return 32767;
+  }
+  if (value < -32768) {
+    return -32768;
+  }
+  return static_cast<int16_t>(value);
+}
+
+}  // namespace
+
+void Saturate_C(const int32_t* src, int shift, int16_t* dst, int length) {
+  for (int i = 0; i < length; ++i) {
+    dst[i] = SaturateToInt16(src[i] >> shift);
+  }
+}
+
+void SubtractAndSaturate_C(const int32_t* src, const int16_t* subtrahend,
+                           int16_t* dst, int length) {
+  for (int i = 0; i < length; ++i) {
+    dst[i] = SaturateToInt16(src[i] - subtrahend[i]);
+  }
+}
+
+MixingFunctions GetMixingFunctions() {
+  MixingFunctions c = { Accumulate_C, AccumulateMonoToStereo_C, Saturate_C,
+                        SubtractAndSaturate_C };
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  MixingFunctions sse2 = { Accumulate_SSE2, AccumulateMonoToStereo_SSE2,
+                           Saturate_SSE2, SubtractAndSaturate_SSE2 };
+  return WebRtc_GetCPUInfo(kSSE2) ? sse2 : c;
+#elif defined(WEBRTC_ARCH_ARM_V7)
+  MixingFunctions neon = { Accumulate_NEON, AccumulateMonoToStereo_NEON,
+                           Saturate_NEON, SubtractAndSaturate_NEON };
+#if defined(WEBRTC_ARCH_ARM_NEON)
+  return neon;
+#else
+  // NEON CPU detection required.
+  return (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) ? neon : c;
+#endif
+#else
+  return c;
+#endif
+}
+
+}  // namespace webrtc
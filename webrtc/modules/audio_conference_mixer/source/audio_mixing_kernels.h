@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_MIXING_KERNELS_H_
+#define WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_MIXING_KERNELS_H_
+
+#include "typedefs.h"
+
+namespace webrtc {
+
+// The mixer sums all participants into 32-bit accumulators and saturates
+// once, when the mix is converted back to 16 bits. An int32_t accumulator
+// can hold the sum of 65536 full-scale frames without overflowing.
+
+// Adds the |length| samples of |src| to the accumulators in |dst|.
+typedef void (*AccumulateFunction)(const int16_t* src, int32_t* dst,
+                                   int length);
+
+// Writes |src[i] >> shift|, saturated to 16 bits, to |dst|, for |length|
+// values.
+typedef void (*SaturateFunction)(const int32_t* src, int shift, int16_t* dst,
+                                 int length);
+
+// Writes |src[i] - subtrahend[i]|, saturated to 16 bits, to |dst|, for
+// |length| values.
+typedef void (*SubtractAndSaturateFunction)(const int32_t* src,
+                                            const int16_t* subtrahend,
+                                            int16_t* dst, int length);
+
+struct MixingFunctions {
+  // Mixes a frame into accumulators with the same channel layout.
+  AccumulateFunction accumulate;
+  // Mixes |length| mono samples into both channels of 2 * |length|
+  // interleaved stereo accumulators.
+  AccumulateFunction accumulate_mono_to_stereo;
+  SaturateFunction saturate;
+  // Removes one frame from a mix with the same channel layout.
+  SubtractAndSaturateFunction subtract_and_saturate;
+};
+
+// Portable versions.
+void Accumulate_C(const int16_t* src, int32_t* dst, int length);
+void AccumulateMonoToStereo_C(const int16_t* src, int32_t* dst, int length);
+void Saturate_C(const int32_t* src, int shift, int16_t* dst, int length);
+void SubtractAndSaturate_C(const int32_t* src, const int16_t* subtrahend,
+                           int16_t* dst, int length);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void Accumulate_SSE2(const int16_t* src, int32_t* dst, int length);
+void AccumulateMonoToStereo_SSE2(const int16_t* src, int32_t* dst,
+                                 int length);
+void Saturate_SSE2(const int32_t* src, int shift, int16_t* dst, int length);
+void SubtractAndSaturate_SSE2(const int32_t* src, const int16_t* subtrahend,
+                              int16_t* dst, int length);
+#elif defined(WEBRTC_ARCH_ARM_V7)
+void Accumulate_NEON(const int16_t* src, int32_t* dst, int length);
+void AccumulateMonoToStereo_NEON(const int16_t* src, int32_t* dst,
+                                 int length);
+void Saturate_NEON(const int32_t* src, int shift, int16_t* dst, int length);
+void SubtractAndSaturate_NEON(const int32_t* src, const int16_t* subtrahend,
+                              int16_t* dst, int length);
+#endif
+
+// Returns the fastest implementations supported by the CPU.
+MixingFunctions GetMixingFunctions();
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_MIXING_KERNELS_H_
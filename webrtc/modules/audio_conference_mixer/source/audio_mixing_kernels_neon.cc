@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_conference_mixer/source/audio_mixing_kernels.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+void Accumulate_NEON(const int16_t* src, int32_t* dst, int length) {
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const int16x8_t x = vld1q_s16(src + i);
+    vst1q_s32(dst + i, vaddw_s16(vld1q_s32(dst + i), vget_low_s16(x)));
+    vst1q_s32(dst + i + 4,
+              vaddw_s16(vld1q_s32(dst + i + 4), vget_high_s16(x)));
+  }
+  Accumulate_C(src + i, dst + i, length - i);
+}
+
+void AccumulateMonoToStereo_NEON(const int16_t* src, int32_t* dst,
+                                 int length) {
+  int i = 0;
+  for (; i + 4 <= length; i += 4) {
+    const int32x4_t x = vmovl_s16(vld1_s16(src + i));
+    const int32x4x2_t stereo = vzipq_s32(x, x);
+    int32_t* p = dst + 2 * i;
+    vst1q_s32(p, vaddq_s32(vld1q_s32(p), stereo.val[0]));
+    vst1q_s32(p + 4, vaddq_s32(vld1q_s32(p + 4), stereo.val[1]));
+  }
+  AccumulateMonoToStereo_C(src + i, dst + 2 * i, length - i);
+}
+
+void Saturate_NEON(const int32_t* src, int shift, int16_t* dst, int length) {
+  // A negative count makes vshlq an arithmetic right shift.
+  const int32x4_t count = vdupq_n_s32(-shift);
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const int32x4_t low = vshlq_s32(vld1q_s32(src + i), count);
+    const int32x4_t high = vshlq_s32(vld1q_s32(src + i + 4), count);
+    vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+  }
+  Saturate_C(src + i, shift, dst + i, length - i);
+}
+
+void SubtractAndSaturate_NEON(const int32_t* src, const int16_t* subtrahend,
+                              int16_t* dst, int length) {
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const int16x8_t x = vld1q_s16(subtrahend + i);
+    const int32x4_t low = vsubw_s16(vld1q_s32(src + i), vget_low_s16(x));
+    const int32x4_t high =
+        vsubw_s16(vld1q_s32(src + i + 4), vget_high_s16(x));
+    vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+  }
+  SubtractAndSaturate_C(src + i, subtrahend + i, dst + i, length - i);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_conference_mixer/source/audio_mixing_kernels.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+namespace {
+
+// Sign-extends the low and high halves of |x| to 32 bits.
+inline __m128i ExtendLow(__m128i x) {
+  return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+inline __m128i ExtendHigh(__m128i x) {
+  return _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
+
+inline void AddTo(int32_t* dst, __m128i x) {
+  __m128i* p = reinterpret_cast<__m128i*>(dst);
+  _mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), x));
+}
+
+}  // namespace
+
+void Accumulate_SSE2(const int16_t* src, int32_t* dst, int length) {
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    AddTo(dst + i, ExtendLow(x));
+    AddTo(dst + i + 4, ExtendHigh(x));
+  }
+  Accumulate_C(src + i, dst + i, length - i);
+}
+
+void AccumulateMonoToStereo_SSE2(const int16_t* src, int32_t* dst,
+                                 int length) {
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i low = ExtendLow(x);
+    const __m128i high = ExtendHigh(x);
+    AddTo(dst + 2 * i, _mm_unpacklo_epi32(low, low));
+    AddTo(dst + 2 * i + 4, _mm_unpackhi_epi32(low, low));
+    AddTo(dst + 2 * i + 8, _mm_unpacklo_epi32(high, high));
+    AddTo(dst + 2 * i + 12, _mm_unpackhi_epi32(high, high));
+  }
+  AccumulateMonoToStereo_C(src + i, dst + 2 * i, length - i);
+}
+
+void Saturate_SSE2(const int32_t* src, int shift, int16_t* dst, int length) {
+  const __m128i count = _mm_cvtsi32_si128(shift);
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i low = _mm_sra_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), count);
+    const __m128i high = _mm_sra_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), count);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packs_epi32(low, high));
+  }
+  Saturate_C(src + i, shift, dst + i, length - i);
+}
+
+void SubtractAndSaturate_SSE2(const int32_t* src, const int16_t* subtrahend,
+                              int16_t* dst, int length) {
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(subtrahend + i));
+    const __m128i low = _mm_sub_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)),
+        ExtendLow(x));
+    const __m128i high = _mm_sub_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)),
+        ExtendHigh(x));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packs_epi32(low, high));
+  }
+  SubtractAndSaturate_C(src + i, subtrahend + i, dst + i, length - i);
+}
+
+}  // namespace webrtc
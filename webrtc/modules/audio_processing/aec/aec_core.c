@@ -118,7 +118,7 @@ extern int webrtc_aec_instance_count;
 // "Private" function prototypes.
 static void ProcessBlock(AecCore* aec);
 
-static void NonLinearProcessing(AecCore* aec, short *output, short *outputH);
+static void NonLinearProcessing(AecCore* aec, float* output, float* outputH);
 
 static void GetHighbandGain(const float *lambda, float *nlpGainHband);
 
@@ -165,7 +165,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->nearFrBuf = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                         sizeof(int16_t));
+                                         sizeof(float));
     if (!aec->nearFrBuf) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -173,7 +173,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->outFrBuf = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                        sizeof(int16_t));
+                                        sizeof(float));
     if (!aec->outFrBuf) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -181,7 +181,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->nearFrBufH = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                          sizeof(int16_t));
+                                          sizeof(float));
     if (!aec->nearFrBufH) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -189,7 +189,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->outFrBufH = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                         sizeof(int16_t));
+                                         sizeof(float));
     if (!aec->outFrBufH) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -598,11 +598,11 @@ int WebRtcAec_MoveFarReadPtr(AecCore* aec, int elements) {
 }
 
 void WebRtcAec_ProcessFrame(AecCore* aec,
-                            const short* nearend,
-                            const short* nearendH,
+                            const float* nearend,
+                            const float* nearendH,
                             int knownDelay,
-                            int16_t* out,
-                            int16_t* outH) {
+                            float* out,
+                            float* outH) {
     int out_elements = 0;
 
     // For each frame the process is as follows:
@@ -803,10 +803,10 @@ static void ProcessBlock(AecCore* aec) {
     const float ramp = 1.0002f;
     const float gInitNoise[2] = {0.999f, 0.001f};
 
-    int16_t nearend[PART_LEN];
-    int16_t* nearend_ptr = NULL;
-    int16_t output[PART_LEN];
-    int16_t outputH[PART_LEN];
+    float nearend[PART_LEN];
+    float* nearend_ptr = NULL;
+    float output[PART_LEN];
+    float outputH[PART_LEN];
 
     float* xf_ptr = NULL;
 
@@ -817,27 +817,28 @@ static void ProcessBlock(AecCore* aec) {
                         (void**) &nearend_ptr,
                         nearend,
                         PART_LEN);
-      for (i = 0; i < PART_LEN; i++) {
-          dH[i] = (float) (nearend_ptr[i]);
-      }
+      memcpy(dH, nearend_ptr, sizeof(float) * PART_LEN);
       memcpy(aec->dBufH + PART_LEN, dH, sizeof(float) * PART_LEN);
     }
     WebRtc_ReadBuffer(aec->nearFrBuf, (void**) &nearend_ptr, nearend, PART_LEN);
 
     // ---------- Ooura fft ----------
     // Concatenate old and new nearend blocks.
-    for (i = 0; i < PART_LEN; i++) {
-        d[i] = (float) (nearend_ptr[i]);
-    }
+    memcpy(d, nearend_ptr, sizeof(float) * PART_LEN);
     memcpy(aec->dBuf + PART_LEN, d, sizeof(float) * PART_LEN);
 
 #ifdef WEBRTC_AEC_DEBUG_DUMP
     {
         int16_t farend[PART_LEN];
         int16_t* farend_ptr = NULL;
+        int16_t nearInt16[PART_LEN];
         WebRtc_ReadBuffer(aec->far_time_buf, (void**) &farend_ptr, farend, 1);
+        for (i = 0; i < PART_LEN; i++) {
+            nearInt16[i] = (int16_t)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, d[i],
+                WEBRTC_SPL_WORD16_MIN);
+        }
         (void)fwrite(farend_ptr, sizeof(int16_t), PART_LEN, aec->farFile);
-        (void)fwrite(nearend_ptr, sizeof(int16_t), PART_LEN, aec->nearFile);
+        (void)fwrite(nearInt16, sizeof(int16_t), PART_LEN, aec->nearFile);
     }
 #endif
 
@@ -990,18 +991,20 @@ static void ProcessBlock(AecCore* aec) {
 #ifdef WEBRTC_AEC_DEBUG_DUMP
     {
         int16_t eInt16[PART_LEN];
+        int16_t outputInt16[PART_LEN];
         for (i = 0; i < PART_LEN; i++) {
             eInt16[i] = (int16_t)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, e[i],
                 WEBRTC_SPL_WORD16_MIN);
+            outputInt16[i] = (int16_t)output[i];
         }
 
         (void)fwrite(eInt16, sizeof(int16_t), PART_LEN, aec->outLinearFile);
-        (void)fwrite(output, sizeof(int16_t), PART_LEN, aec->outFile);
+        (void)fwrite(outputInt16, sizeof(int16_t), PART_LEN, aec->outFile);
     }
 #endif
 }
 
-static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
+static void NonLinearProcessing(AecCore* aec, float* output, float* outputH)
 {
     float efw[2][PART_LEN1], dfw[2][PART_LEN1], xfw[2][PART_LEN1];
     complex_t comfortNoiseHband[PART_LEN1];
@@ -1287,7 +1290,7 @@ static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
         fft[i] = fft[i]*sqrtHanning[i] + aec->outBuf[i];
 
         // Saturation protection
-        output[i] = (short)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, fft[i],
+        output[i] = WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, fft[i],
             WEBRTC_SPL_WORD16_MIN);
 
         fft[PART_LEN + i] *= scale; // fft scaling
@@ -1326,7 +1329,7 @@ static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
             }
 
             // Saturation protection
-            outputH[i] = (short)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, dtmp,
+            outputH[i] = WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, dtmp,
                 WEBRTC_SPL_WORD16_MIN);
          }
     }
@@ -304,20 +304,10 @@ int32_t WebRtcAec_BufferFarend(void *aecInst, const int16_t *farend,
     return retVal;
 }
 
-int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
-                          const int16_t *nearendH, int16_t *out, int16_t *outH,
-                          int16_t nrOfSamples, int16_t msInSndCardBuf,
-                          int32_t skew)
-{
-    aecpc_t *aecpc = aecInst;
-    int32_t retVal = 0;
-    short i;
-    short nBlocks10ms;
-    short nFrames;
-    // Limit resampling to doubling/halving of signal
-    const float minSkewEst = -0.5f;
-    const float maxSkewEst = 1.0f;
-
+// Checks the arguments of WebRtcAec_Process() and WebRtcAec_ProcessFloat().
+static int CheckProcessArguments(aecpc_t* aecpc, const void* nearend,
+                                 const void* nearendH, const void* out,
+                                 int16_t nrOfSamples) {
     if (aecpc == NULL) {
         return -1;
     }
@@ -348,6 +338,70 @@ int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
        aecpc->lastError = AEC_NULL_POINTER_ERROR;
        return -1;
     }
+    return 0;
+}
+
+int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
+                          const int16_t *nearendH, int16_t *out, int16_t *outH,
+                          int16_t nrOfSamples, int16_t msInSndCardBuf,
+                          int32_t skew)
+{
+    aecpc_t *aecpc = aecInst;
+    float nearendFloat[160];
+    float nearendHFloat[160];
+    float outFloat[160];
+    float outHFloat[160];
+    int32_t retVal = 0;
+    short i;
+
+    if (CheckProcessArguments(aecpc, nearend, nearendH, out,
+                              nrOfSamples) != 0) {
+        return -1;
+    }
+
+    for (i = 0; i < nrOfSamples; i++) {
+        nearendFloat[i] = nearend[i];
+    }
+    if (aecpc->sampFreq == 32000) {
+        for (i = 0; i < nrOfSamples; i++) {
+            nearendHFloat[i] = nearendH[i];
+        }
+    }
+
+    retVal = WebRtcAec_ProcessFloat(aecInst, nearendFloat, nearendHFloat,
+                                    outFloat, outHFloat, nrOfSamples,
+                                    msInSndCardBuf, skew);
+
+    // The output is already limited to the range of int16_t.
+    for (i = 0; i < nrOfSamples; i++) {
+        out[i] = (int16_t)outFloat[i];
+    }
+    if (aecpc->sampFreq == 32000 && outH != NULL) {
+        for (i = 0; i < nrOfSamples; i++) {
+            outH[i] = (int16_t)outHFloat[i];
+        }
+    }
+    return retVal;
+}
+
+int32_t WebRtcAec_ProcessFloat(void* aecInst, const float* nearend,
+                               const float* nearendH, float* out, float* outH,
+                               int16_t nrOfSamples, int16_t msInSndCardBuf,
+                               int32_t skew)
+{
+    aecpc_t *aecpc = aecInst;
+    int32_t retVal = 0;
+    short i;
+    short nBlocks10ms;
+    short nFrames;
+    // Limit resampling to doubling/halving of signal
+    const float minSkewEst = -0.5f;
+    const float maxSkewEst = 1.0f;
+
+    if (CheckProcessArguments(aecpc, nearend, nearendH, out,
+                              nrOfSamples) != 0) {
+        return -1;
+    }
 
     if (msInSndCardBuf < 0) {
         msInSndCardBuf = 0;
@@ -402,7 +456,10 @@ int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
     if (aecpc->ECstartup) {
         if (nearend != out) {
             // Only needed if they don't already point to the same place.
-            memcpy(out, nearend, sizeof(short) * nrOfSamples);
+            memcpy(out, nearend, sizeof(float) * nrOfSamples);
+        }
+        if (aecpc->sampFreq == 32000 && outH != NULL && nearendH != outH) {
+            memcpy(outH, nearendH, sizeof(float) * nrOfSamples);
         }
 
         // The AEC is in the start up mode
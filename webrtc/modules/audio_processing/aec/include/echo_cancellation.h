@@ -162,6 +162,20 @@ int32_t WebRtcAec_Process(void *aecInst,
                           int16_t msInSndCardBuf,
                           int32_t skew);
 
+/*
+ * Same as WebRtcAec_Process(), for float samples in the range of int16_t. The
+ * output is limited to that range, but not rounded. The output may point to
+ * the input.
+ */
+int32_t WebRtcAec_ProcessFloat(void* aecInst,
+                               const float* nearend,
+                               const float* nearendH,
+                               float* out,
+                               float* outH,
+                               int16_t nrOfSamples,
+                               int16_t msInSndCardBuf,
+                               int32_t skew);
+
 /*
  * This function enables the user to set certain parameters on-the-fly.
  *
@@ -31,6 +31,32 @@ void StereoToMono(const int16_t* left, const int16_t* right,
     out[i] = WebRtcSpl_SatW32ToW16(data32);
   }
 }
+
+void StereoToMono(const float* left, const float* right, float* out,
+                  int samples_per_channel) {
+  for (int i = 0; i < samples_per_channel; i++) {
+    out[i] = (left[i] + right[i]) * 0.5f;
+  }
+}
+
+void FloatToInt16(const float* src, int length, int16_t* dest) {
+  for (int i = 0; i < length; i++) {
+    const float value = src[i];
+    if (value >= 32767.f) {
+      dest[i] = 32767;
+    } else if (value <= -32768.f) {
+      dest[i] = -32768;
+    } else {
+      dest[i] = static_cast<int16_t>(value + (value > 0 ? 0.5f : -0.5f));
+    }
+  }
+}
+
+void Int16ToFloat(const int16_t* src, int length, float* dest) {
+  for (int i = 0; i < length; i++) {
+    dest[i] = src[i];
+  }
+}
 }  // namespace
 
 struct AudioChannel {
@@ -73,22 +99,43 @@ AudioBuffer::AudioBuffer(int max_num_channels,
     reference_copied_(false),
     activity_(AudioFrame::kVadUnknown),
     is_muted_(false),
+    is_float_(false),
     data_(NULL),
     channels_(NULL),
     split_channels_(NULL),
     mixed_channels_(NULL),
     mixed_low_pass_channels_(NULL),
-    low_pass_reference_channels_(NULL) {
+    low_pass_reference_channels_(NULL),
+    float_channels_(NULL),
+    float_low_pass_channels_(NULL),
+    float_high_pass_channels_(NULL) {
+  // Mono channels are also needed for samples converted from float.
+  channels_.reset(new AudioChannel[max_num_channels_]);
   if (max_num_channels_ > 1) {
-    channels_.reset(new AudioChannel[max_num_channels_]);
     mixed_channels_.reset(new AudioChannel[max_num_channels_]);
     mixed_low_pass_channels_.reset(new AudioChannel[max_num_channels_]);
   }
   low_pass_reference_channels_.reset(new AudioChannel[max_num_channels_]);
 
+  int float_samples = kSamplesPer32kHzChannel * max_num_channels_;
   if (samples_per_channel_ == kSamplesPer32kHzChannel) {
     split_channels_.reset(new SplitAudioChannel[max_num_channels_]);
     samples_per_split_channel_ = kSamplesPer16kHzChannel;
+    float_samples += 2 * kSamplesPer16kHzChannel * max_num_channels_;
+  }
+  float_data_.reset(AlignedMalloc<float>(sizeof(float) * float_samples, 16));
+  memset(float_data_.get(), 0, sizeof(float) * float_samples);
+  float_channels_ = float_data_.get();
+  if (split_channels_.get() != NULL) {
+    float_low_pass_channels_ =
+        float_channels_ + kSamplesPer32kHzChannel * max_num_channels_;
+    float_high_pass_channels_ =
+        float_low_pass_channels_ + kSamplesPer16kHzChannel * max_num_channels_;
+  }
+
+  for (int i = 0; i < kNumBands; i++) {
+    int16_current_[i] = true;
+    float_current_[i] = false;
   }
 }
 
@@ -96,6 +143,7 @@ AudioBuffer::~AudioBuffer() {}
 
 int16_t* AudioBuffer::data(int channel) const {
   assert(channel >= 0 && channel < num_channels_);
+  UpdateInt16(kFullBand);
   if (data_ != NULL) {
     return data_;
   }
@@ -109,6 +157,7 @@ int16_t* AudioBuffer::low_pass_split_data(int channel) const {
     return data(channel);
   }
 
+  UpdateInt16(kSplitBands);
   return split_channels_[channel].low_pass_data;
 }
 
@@ -118,9 +167,36 @@ int16_t* AudioBuffer::high_pass_split_data(int channel) const {
     return NULL;
   }
 
+  UpdateInt16(kSplitBands);
   return split_channels_[channel].high_pass_data;
 }
 
+float* AudioBuffer::data_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  UpdateFloat(kFullBand);
+  return float_channels_ + channel * kSamplesPer32kHzChannel;
+}
+
+float* AudioBuffer::low_pass_split_data_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return data_f(channel);
+  }
+
+  UpdateFloat(kSplitBands);
+  return float_low_pass_channels_ + channel * kSamplesPer16kHzChannel;
+}
+
+float* AudioBuffer::high_pass_split_data_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return NULL;
+  }
+
+  UpdateFloat(kSplitBands);
+  return float_high_pass_channels_ + channel * kSamplesPer16kHzChannel;
+}
+
 int16_t* AudioBuffer::mixed_data(int channel) const {
   assert(channel >= 0 && channel < num_mixed_channels_);
 
@@ -174,6 +250,10 @@ bool AudioBuffer::is_muted() const {
   return is_muted_;
 }
 
+bool AudioBuffer::is_float() const {
+  return is_float_;
+}
+
 int AudioBuffer::num_channels() const {
   return num_channels_;
 }
@@ -201,6 +281,11 @@ void AudioBuffer::DeinterleaveFrom(AudioFrame* frame) {
   if (frame->energy_ == 0) {
     is_muted_ = true;
   }
+  is_float_ = false;
+  for (int i = 0; i < kNumBands; i++) {
+    int16_current_[i] = true;
+    float_current_[i] = false;
+  }
 
   if (num_channels_ == 1) {
     // We can get away with a pointer assignment in this case.
@@ -208,6 +293,7 @@ void AudioBuffer::DeinterleaveFrom(AudioFrame* frame) {
     return;
   }
 
+  data_ = NULL;
   int16_t* interleaved = frame->data_;
   for (int i = 0; i < num_channels_; i++) {
     int16_t* deinterleaved = channels_[i].data;
@@ -219,6 +305,80 @@ void AudioBuffer::DeinterleaveFrom(AudioFrame* frame) {
   }
 }
 
+void AudioBuffer::CopyFrom(const float* const* data, int num_channels) {
+  assert(num_channels <= max_num_channels_);
+
+  num_channels_ = num_channels;
+  data_was_mixed_ = false;
+  num_mixed_channels_ = 0;
+  num_mixed_low_pass_channels_ = 0;
+  reference_copied_ = false;
+  activity_ = AudioFrame::kVadUnknown;
+  is_muted_ = false;
+  is_float_ = true;
+  data_ = NULL;
+  int16_current_[kFullBand] = false;
+  float_current_[kFullBand] = true;
+  // The split bands are written by the splitting filter, in int16.
+  int16_current_[kSplitBands] = true;
+  float_current_[kSplitBands] = false;
+
+  for (int i = 0; i < num_channels_; i++) {
+    memcpy(float_channels_ + i * kSamplesPer32kHzChannel, data[i],
+           sizeof(float) * samples_per_channel_);
+  }
+}
+
+void AudioBuffer::CopyTo(float* const* data) const {
+  for (int i = 0; i < num_channels_; i++) {
+    memcpy(data[i], data_f(i), sizeof(float) * samples_per_channel_);
+  }
+}
+
+void AudioBuffer::UpdateInt16(Band band) const {
+  if (!int16_current_[band]) {
+    assert(float_current_[band]);
+    for (int i = 0; i < num_channels_; i++) {
+      if (band == kFullBand) {
+        FloatToInt16(float_channels_ + i * kSamplesPer32kHzChannel,
+                     samples_per_channel_,
+                     data_ != NULL ? data_ : channels_[i].data);
+      } else {
+        FloatToInt16(float_low_pass_channels_ + i * kSamplesPer16kHzChannel,
+                     samples_per_split_channel_,
+                     split_channels_[i].low_pass_data);
+        FloatToInt16(float_high_pass_channels_ + i * kSamplesPer16kHzChannel,
+                     samples_per_split_channel_,
+                     split_channels_[i].high_pass_data);
+      }
+    }
+    int16_current_[band] = true;
+  }
+  float_current_[band] = false;
+}
+
+void AudioBuffer::UpdateFloat(Band band) const {
+  if (!float_current_[band]) {
+    assert(int16_current_[band]);
+    for (int i = 0; i < num_channels_; i++) {
+      if (band == kFullBand) {
+        Int16ToFloat(data_ != NULL ? data_ : channels_[i].data,
+                     samples_per_channel_,
+                     float_channels_ + i * kSamplesPer32kHzChannel);
+      } else {
+        Int16ToFloat(split_channels_[i].low_pass_data,
+                     samples_per_split_channel_,
+                     float_low_pass_channels_ + i * kSamplesPer16kHzChannel);
+        Int16ToFloat(split_channels_[i].high_pass_data,
+                     samples_per_split_channel_,
+                     float_high_pass_channels_ + i * kSamplesPer16kHzChannel);
+      }
+    }
+    float_current_[band] = true;
+  }
+  int16_current_[band] = false;
+}
+
 void AudioBuffer::InterleaveTo(AudioFrame* frame, bool data_changed) const {
   assert(frame->num_channels_ == num_channels_);
   assert(frame->samples_per_channel_ == samples_per_channel_);
@@ -227,6 +387,7 @@ void AudioBuffer::InterleaveTo(AudioFrame* frame, bool data_changed) const {
   if (!data_changed) {
     return;
   }
+  UpdateInt16(kFullBand);
 
   if (num_channels_ == 1) {
     if (data_was_mixed_) {
@@ -260,10 +421,17 @@ void AudioBuffer::Mix(int num_mixed_channels) {
   assert(num_channels_ == 2);
   assert(num_mixed_channels == 1);
 
-  StereoToMono(channels_[0].data,
-               channels_[1].data,
-               channels_[0].data,
-               samples_per_channel_);
+  if (float_current_[kFullBand]) {
+    StereoToMono(float_channels_,
+                 float_channels_ + kSamplesPer32kHzChannel,
+                 float_channels_,
+                 samples_per_channel_);
+  } else {
+    StereoToMono(channels_[0].data,
+                 channels_[1].data,
+                 channels_[0].data,
+                 samples_per_channel_);
+  }
 
   num_channels_ = num_mixed_channels;
   data_was_mixed_ = true;
@@ -274,8 +442,8 @@ void AudioBuffer::CopyAndMix(int num_mixed_channels) {
   assert(num_channels_ == 2);
   assert(num_mixed_channels == 1);
 
-  StereoToMono(channels_[0].data,
-               channels_[1].data,
+  StereoToMono(data(0),
+               data(1),
                mixed_channels_[0].data,
                samples_per_channel_);
 
@@ -11,6 +11,7 @@
 #ifndef WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_AUDIO_BUFFER_H_
 #define WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_AUDIO_BUFFER_H_
 
+#include "aligned_malloc.h"
 #include "module_common_types.h"
 #include "scoped_ptr.h"
 #include "typedefs.h"
@@ -29,9 +30,18 @@ class AudioBuffer {
   int samples_per_channel() const;
   int samples_per_split_channel() const;
 
+  // The samples of the full band and of the split bands are held either as
+  // int16 or as float, in the range of int16, depending on which
+  // representation was written last. Accessing the other representation
+  // converts the samples, and since the caller may write through the returned
+  // pointer, makes the converted representation the only current one.
   int16_t* data(int channel) const;
   int16_t* low_pass_split_data(int channel) const;
   int16_t* high_pass_split_data(int channel) const;
+  // The float channels are 16-byte aligned.
+  float* data_f(int channel) const;
+  float* low_pass_split_data_f(int channel) const;
+  float* high_pass_split_data_f(int channel) const;
   int16_t* mixed_data(int channel) const;
   int16_t* mixed_low_pass_data(int channel) const;
   int16_t* low_pass_reference(int channel) const;
@@ -46,7 +56,17 @@ class AudioBuffer {
 
   bool is_muted() const;
 
+  // True if the current frame was delivered as float. Components with a float
+  // implementation should then use the float data, so the samples aren't
+  // rounded to int16 between float components.
+  bool is_float() const;
+
   void DeinterleaveFrom(AudioFrame* audioFrame);
+  // Copies the deinterleaved float channels |data|. Unlike an AudioFrame, the
+  // data doesn't tell whether it is muted or voice.
+  void CopyFrom(const float* const* data, int num_channels);
+  // Copies the current channels to |data|.
+  void CopyTo(float* const* data) const;
   void InterleaveTo(AudioFrame* audioFrame) const;
   // If |data_changed| is false, only the non-audio data members will be copied
   // to |frame|.
@@ -57,6 +77,17 @@ class AudioBuffer {
   void CopyLowPassToReference();
 
  private:
+  enum Band {
+    kFullBand,
+    kSplitBands,
+    kNumBands
+  };
+
+  // Makes the int16 or the float samples of |band| current, converting them
+  // if needed, and marks the other representation as out of date.
+  void UpdateInt16(Band band) const;
+  void UpdateFloat(Band band) const;
+
   const int max_num_channels_;
   int num_channels_;
   int num_mixed_channels_;
@@ -68,6 +99,9 @@ class AudioBuffer {
   bool reference_copied_;
   AudioFrame::VADActivity activity_;
   bool is_muted_;
+  bool is_float_;
+  mutable bool int16_current_[kNumBands];
+  mutable bool float_current_[kNumBands];
 
   int16_t* data_;
   scoped_array<AudioChannel> channels_;
@@ -76,6 +110,12 @@ class AudioBuffer {
   // TODO(andrew): improve this, we don't need the full 32 kHz space here.
   scoped_array<AudioChannel> mixed_low_pass_channels_;
   scoped_array<AudioChannel> low_pass_reference_channels_;
+  // One block for the full band channels, followed by the low and high band
+  // channels when splitting.
+  Allocator<float>::scoped_ptr_aligned float_data_;
+  float* float_channels_;
+  float* float_low_pass_channels_;
+  float* float_high_pass_channels_;
 };
 }  // namespace webrtc
 
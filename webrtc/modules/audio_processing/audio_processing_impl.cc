@@ -12,6 +12,8 @@
 
 #include <assert.h>
 
+#include <string>
+
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 #include "webrtc/modules/audio_processing/echo_cancellation_impl.h"
 #include "webrtc/modules/audio_processing/echo_control_mobile_impl.h"
@@ -37,6 +39,29 @@
 #endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
 
 namespace webrtc {
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+namespace {
+// Float frames are recorded as int16, like the frames of the AudioFrame
+// interface, so debug recordings can be replayed with either interface.
+std::string InterleaveToInt16(const float* const* data,
+                              int samples_per_channel,
+                              int num_channels) {
+  std::string interleaved(
+      sizeof(int16_t) * samples_per_channel * num_channels, '\0');
+  int16_t* dest = reinterpret_cast<int16_t*>(&interleaved[0]);
+  for (int i = 0; i < samples_per_channel; i++) {
+    for (int j = 0; j < num_channels; j++) {
+      const float value = data[j][i];
+      dest[i * num_channels + j] = value >= 32767.f ? 32767 :
+          value <= -32768.f ? -32768 :
+          static_cast<int16_t>(value + (value > 0 ? 0.5f : -0.5f));
+    }
+  }
+  return interleaved;
+}
+}  // namespace
+#endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
+
 AudioProcessing* AudioProcessing::Create(int id) {
   AudioProcessingImpl* apm = new AudioProcessingImpl(id);
   if (apm->Initialize() != kNoError) {
@@ -306,6 +331,106 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
   }
 
   bool data_processed = is_data_processed();
+  err = ProcessCaptureAudioLocked(data_processed);
+  if (err != kNoError) {
+    return err;
+  }
+
+  capture_audio_->InterleaveTo(frame, interleave_needed(data_processed));
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  if (debug_file_->Open()) {
+    audioproc::Stream* msg = event_msg_->mutable_stream();
+    const size_t data_size = sizeof(int16_t) *
+                             frame->samples_per_channel_ *
+                             frame->num_channels_;
+    msg->set_output_data(frame->data_, data_size);
+    err = WriteMessageToDebugFile();
+    if (err != kNoError) {
+      return err;
+    }
+  }
+#endif
+
+  was_stream_delay_set_ = false;
+  return kNoError;
+}
+
+int AudioProcessingImpl::ProcessStream(float* const* data,
+                                       int samples_per_channel,
+                                       int sample_rate_hz,
+                                       int num_channels) {
+  CriticalSectionScoped crit_scoped(crit_);
+  int err = kNoError;
+
+  if (data == NULL) {
+    return kNullPointerError;
+  }
+
+  if (sample_rate_hz != sample_rate_hz_) {
+    return kBadSampleRateError;
+  }
+
+  if (num_channels != num_input_channels_) {
+    return kBadNumberChannelsError;
+  }
+
+  if (samples_per_channel != samples_per_channel_) {
+    return kBadDataLengthError;
+  }
+
+  for (int i = 0; i < num_channels; i++) {
+    if (data[i] == NULL) {
+      return kNullPointerError;
+    }
+  }
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  if (debug_file_->Open()) {
+    event_msg_->set_type(audioproc::Event::STREAM);
+    audioproc::Stream* msg = event_msg_->mutable_stream();
+    msg->set_input_data(
+        InterleaveToInt16(data, samples_per_channel, num_channels));
+    msg->set_delay(stream_delay_ms_);
+    msg->set_drift(echo_cancellation_->stream_drift_samples());
+    msg->set_level(gain_control_->stream_analog_level());
+  }
+#endif
+
+  capture_audio_->CopyFrom(data, num_channels);
+
+  if (num_output_channels_ < num_input_channels_) {
+    capture_audio_->Mix(num_output_channels_);
+  }
+
+  bool data_processed = is_data_processed();
+  err = ProcessCaptureAudioLocked(data_processed);
+  if (err != kNoError) {
+    return err;
+  }
+
+  if (interleave_needed(data_processed)) {
+    capture_audio_->CopyTo(data);
+  }
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  if (debug_file_->Open()) {
+    audioproc::Stream* msg = event_msg_->mutable_stream();
+    msg->set_output_data(
+        InterleaveToInt16(data, samples_per_channel, num_output_channels_));
+    err = WriteMessageToDebugFile();
+    if (err != kNoError) {
+      return err;
+    }
+  }
+#endif
+
+  was_stream_delay_set_ = false;
+  return kNoError;
+}
+
+int AudioProcessingImpl::ProcessCaptureAudioLocked(bool data_processed) {
+  int err = kNoError;
   if (analysis_needed(data_processed)) {
     for (int i = 0; i < num_output_channels_; i++) {
       // Split into a low and high band.
@@ -369,29 +494,7 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
   }
 
   // The level estimator operates on the recombined data.
-  err = level_estimator_->ProcessStream(capture_audio_);
-  if (err != kNoError) {
-    return err;
-  }
-
-  capture_audio_->InterleaveTo(frame, interleave_needed(data_processed));
-
-#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    audioproc::Stream* msg = event_msg_->mutable_stream();
-    const size_t data_size = sizeof(int16_t) *
-                             frame->samples_per_channel_ *
-                             frame->num_channels_;
-    msg->set_output_data(frame->data_, data_size);
-    err = WriteMessageToDebugFile();
-    if (err != kNoError) {
-      return err;
-    }
-  }
-#endif
-
-  was_stream_delay_set_ = false;
-  return kNoError;
+  return level_estimator_->ProcessStream(capture_audio_);
 }
 
 int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
@@ -66,6 +66,10 @@ class AudioProcessingImpl : public AudioProcessing {
   virtual int set_num_reverse_channels(int channels);
   virtual int num_reverse_channels() const;
   virtual int ProcessStream(AudioFrame* frame);
+  virtual int ProcessStream(float* const* data,
+                            int samples_per_channel,
+                            int sample_rate_hz,
+                            int num_channels);
   virtual int AnalyzeReverseStream(AudioFrame* frame);
   virtual int set_stream_delay_ms(int delay);
   virtual int stream_delay_ms() const;
@@ -85,6 +89,8 @@ class AudioProcessingImpl : public AudioProcessing {
   virtual int32_t ChangeUniqueId(const int32_t id);
 
  private:
+  // Runs the components on |capture_audio_|, which holds the input frame.
+  int ProcessCaptureAudioLocked(bool data_processed);
   bool is_data_processed() const;
   bool interleave_needed(bool is_data_processed) const;
   bool synthesis_needed(bool is_data_processed) const;
@@ -0,0 +1,256 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/audio_processing_pool_impl.h"
+
+#include <assert.h>
+
+#include "webrtc/modules/audio_processing/include/audio_processing.h"
+#include "webrtc/system_wrappers/interface/condition_variable_wrapper.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+AudioProcessingPool* AudioProcessingPool::Create(int num_threads) {
+  AudioProcessingPoolImpl* pool = new AudioProcessingPoolImpl();
+  if (pool->Start(num_threads) != 0) {
+    delete pool;
+    pool = NULL;
+  }
+
+  return pool;
+}
+
+AudioProcessingPoolImpl::AudioProcessingPoolImpl()
+    : num_streams_(0),
+      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      work_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      done_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      stopped_(false),
+      ids_(NULL),
+      frames_(NULL),
+      num_frames_(0),
+      generation_(0),
+      pending_(0),
+      slice_time_us_(1, 0),
+      total_tick_us_(0),
+      total_processing_us_(0) {}
+
+AudioProcessingPoolImpl::~AudioProcessingPoolImpl() {
+  Stop();
+  for (size_t i = 0; i < streams_.size(); i++) {
+    delete streams_[i];
+  }
+}
+
+int AudioProcessingPoolImpl::Start(int num_threads) {
+  assert(workers_.empty());
+  if (num_threads < 0) {
+    return -1;
+  }
+  // The threads refer to their Worker, which therefore must not move.
+  workers_.reserve(num_threads);
+  slice_time_us_.assign(num_threads + 1, 0);
+  for (int i = 0; i < num_threads; i++) {
+    Worker worker;
+    worker.pool = this;
+    worker.thread = NULL;
+    worker.slice = i + 1;
+    worker.generation = generation_;
+    workers_.push_back(worker);
+    // Each batch has to be processed within the 10 ms tick.
+    Worker* added = &workers_.back();
+    added->thread = ThreadWrapper::CreateThread(
+        Run, added, kHighPriority, "AudioProcessingPoolThread");
+    unsigned int thread_id = 0;
+    if (added->thread == NULL || !added->thread->Start(thread_id)) {
+      Stop();
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void AudioProcessingPoolImpl::Stop() {
+  {
+    CriticalSectionScoped cs(crit_.get());
+    stopped_ = true;
+    work_cond_->WakeAll();
+  }
+  for (size_t i = 0; i < workers_.size(); i++) {
+    if (workers_[i].thread != NULL) {
+      workers_[i].thread->Stop();
+      delete workers_[i].thread;
+    }
+  }
+  workers_.clear();
+  stopped_ = false;
+}
+
+int AudioProcessingPoolImpl::AddStream() {
+  size_t id = 0;
+  while (id < streams_.size() && streams_[id] != NULL) {
+    id++;
+  }
+  AudioProcessing* apm = AudioProcessing::Create(static_cast<int>(id));
+  if (apm == NULL) {
+    return -1;
+  }
+  if (id == streams_.size()) {
+    streams_.push_back(apm);
+  } else {
+    streams_[id] = apm;
+  }
+  num_streams_++;
+  return static_cast<int>(id);
+}
+
+int AudioProcessingPoolImpl::RemoveStream(int id) {
+  if (stream(id) == NULL) {
+    return AudioProcessing::kBadParameterError;
+  }
+  delete streams_[id];
+  streams_[id] = NULL;
+  num_streams_--;
+  return AudioProcessing::kNoError;
+}
+
+AudioProcessing* AudioProcessingPoolImpl::stream(int id) const {
+  if (id < 0 || id >= static_cast<int>(streams_.size())) {
+    return NULL;
+  }
+  return streams_[id];
+}
+
+int AudioProcessingPoolImpl::num_streams() const {
+  return num_streams_;
+}
+
+int AudioProcessingPoolImpl::ProcessStreams(const int* ids,
+                                            AudioFrame* const* frames,
+                                            int* errors,
+                                            int num_frames) {
+  if (num_frames < 0) {
+    return AudioProcessing::kBadParameterError;
+  }
+  if (num_frames > 0 && (ids == NULL || frames == NULL)) {
+    return AudioProcessing::kNullPointerError;
+  }
+
+  const int64_t start_us = TickTime::MicrosecondTimestamp();
+  errors_.resize(num_frames);
+  {
+    CriticalSectionScoped cs(crit_.get());
+    ids_ = ids;
+    frames_ = frames;
+    num_frames_ = num_frames;
+    generation_++;
+    pending_ = static_cast<int>(workers_.size());
+    work_cond_->WakeAll();
+  }
+
+  // Take part in the processing, and wait for the workers.
+  slice_time_us_[0] = ProcessSlice(0);
+  {
+    CriticalSectionScoped cs(crit_.get());
+    while (pending_ > 0) {
+      done_cond_->SleepCS(*crit_);
+    }
+    ids_ = NULL;
+    frames_ = NULL;
+  }
+
+  const int64_t tick_us = TickTime::MicrosecondTimestamp() - start_us;
+  stats_.ticks++;
+  stats_.frames += num_frames;
+  if (tick_us > stats_.max_tick_us) {
+    stats_.max_tick_us = static_cast<int>(tick_us);
+  }
+  total_tick_us_ += tick_us;
+  for (size_t i = 0; i < slice_time_us_.size(); i++) {
+    total_processing_us_ += slice_time_us_[i];
+  }
+
+  int err = AudioProcessing::kNoError;
+  for (int i = 0; i < num_frames; i++) {
+    if (errors != NULL) {
+      errors[i] = errors_[i];
+    }
+    if (err == AudioProcessing::kNoError) {
+      err = errors_[i];
+    }
+  }
+  return err;
+}
+
+void AudioProcessingPoolImpl::GetStatistics(Statistics* stats) {
+  *stats = stats_;
+  if (stats_.ticks > 0) {
+    stats->average_tick_us = static_cast<int>(total_tick_us_ / stats_.ticks);
+  }
+  if (total_processing_us_ > 0) {
+    // Each stream needs a frame processed every 10 ms.
+    stats->streams_per_core = static_cast<float>(
+        stats_.frames * 10000.0 / total_processing_us_);
+  }
+  stats_ = Statistics();
+  total_tick_us_ = 0;
+  total_processing_us_ = 0;
+}
+
+bool AudioProcessingPoolImpl::Run(void* obj) {
+  Worker* worker = static_cast<Worker*>(obj);
+  return worker->pool->Process(worker);
+}
+
+bool AudioProcessingPoolImpl::Process(Worker* worker) {
+  {
+    CriticalSectionScoped cs(crit_.get());
+    while (!stopped_ && worker->generation == generation_) {
+      work_cond_->SleepCS(*crit_);
+    }
+    if (stopped_) {
+      return false;
+    }
+    worker->generation = generation_;
+  }
+
+  slice_time_us_[worker->slice] = ProcessSlice(worker->slice);
+
+  CriticalSectionScoped cs(crit_.get());
+  pending_--;
+  if (pending_ == 0) {
+    done_cond_->WakeAll();
+  }
+  return true;
+}
+
+int64_t AudioProcessingPoolImpl::ProcessSlice(int slice) {
+  const int64_t start_us = TickTime::MicrosecondTimestamp();
+  const int num_slices = static_cast<int>(slice_time_us_.size());
+  // Contiguous ranges of about the same size.
+  const int begin = slice * num_frames_ / num_slices;
+  const int end = (slice + 1) * num_frames_ / num_slices;
+  for (int i = begin; i < end; i++) {
+    AudioProcessing* apm = stream(ids_[i]);
+    if (apm == NULL) {
+      errors_[i] = AudioProcessing::kBadParameterError;
+    } else if (frames_[i] == NULL) {
+      errors_[i] = AudioProcessing::kNullPointerError;
+    } else {
+      errors_[i] = apm->ProcessStream(frames_[i]);
+    }
+  }
+  return TickTime::MicrosecondTimestamp() - start_us;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_AUDIO_PROCESSING_POOL_IMPL_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_AUDIO_PROCESSING_POOL_IMPL_H_
+
+#include <vector>
+
+#include "webrtc/modules/audio_processing/include/audio_processing_pool.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+
+class ConditionVariableWrapper;
+class CriticalSectionWrapper;
+class ThreadWrapper;
+
+class AudioProcessingPoolImpl : public AudioProcessingPool {
+ public:
+  AudioProcessingPoolImpl();
+  virtual ~AudioProcessingPoolImpl();
+
+  // Starts |num_threads| worker threads. Returns -1 if a thread can't be
+  // started, in which case no threads are left running.
+  int Start(int num_threads);
+
+  // AudioProcessingPool methods.
+  virtual int AddStream();
+  virtual int RemoveStream(int id);
+  virtual AudioProcessing* stream(int id) const;
+  virtual int num_streams() const;
+  virtual int ProcessStreams(const int* ids,
+                             AudioFrame* const* frames,
+                             int* errors,
+                             int num_frames);
+  virtual void GetStatistics(Statistics* stats);
+
+ private:
+  struct Worker {
+    AudioProcessingPoolImpl* pool;
+    ThreadWrapper* thread;
+    // Index of the slice processed by this worker; the calling thread
+    // processes slice 0.
+    int slice;
+    // The last batch processed.
+    int generation;
+  };
+
+  static bool Run(void* obj);
+  bool Process(Worker* worker);
+  void Stop();
+
+  // Processes the frames of slice |slice| of the current batch and returns
+  // the time it took.
+  int64_t ProcessSlice(int slice);
+
+  // The streams, indexed by id. Removed streams are NULL.
+  std::vector<AudioProcessing*> streams_;
+  int num_streams_;
+
+  std::vector<Worker> workers_;
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  // Signaled when a batch is ready, and on Stop().
+  scoped_ptr<ConditionVariableWrapper> work_cond_;
+  // Signaled when the last worker is done with a batch.
+  scoped_ptr<ConditionVariableWrapper> done_cond_;
+  bool stopped_;
+
+  // The current batch. |generation_| is incremented for every batch, and
+  // |pending_| counts the workers not done with it.
+  const int* ids_;
+  AudioFrame* const* frames_;
+  int num_frames_;
+  std::vector<int> errors_;
+  int generation_;
+  int pending_;
+  // Time spent processing by each slice, written by the thread processing it.
+  std::vector<int64_t> slice_time_us_;
+
+  Statistics stats_;
+  int64_t total_tick_us_;
+  int64_t total_processing_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(AudioProcessingPoolImpl);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_AUDIO_PROCESSING_POOL_IMPL_H_
@@ -0,0 +1,203 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "webrtc/modules/audio_processing/include/audio_processing.h"
+#include "webrtc/modules/audio_processing/include/audio_processing_pool.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+namespace {
+
+const int kSampleRateHz = 16000;
+const int kSamplesPerChannel = kSampleRateHz / 100;
+const double kPi = 3.14159265358979323846;
+
+// Enables noise suppression and gain control, as a server would for incoming
+// streams.
+void Configure(AudioProcessing* apm) {
+  ASSERT_EQ(AudioProcessing::kNoError, apm->set_sample_rate_hz(kSampleRateHz));
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->noise_suppression()->Enable(true));
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->gain_control()->set_mode(GainControl::kAdaptiveDigital));
+  ASSERT_EQ(AudioProcessing::kNoError, apm->gain_control()->Enable(true));
+}
+
+// Fills |frame| with a tone and noise, different for every |stream| and
+// |frame_index|.
+void GenerateFrame(int stream, int frame_index, AudioFrame* frame) {
+  frame->sample_rate_hz_ = kSampleRateHz;
+  frame->samples_per_channel_ = kSamplesPerChannel;
+  frame->num_channels_ = 1;
+  uint32_t seed = 1 + stream * 7919 + frame_index * 104729;
+  for (int i = 0; i < kSamplesPerChannel; i++) {
+    seed = seed * 1664525 + 1013904223;
+    const int noise = static_cast<int>(seed >> 22) - 512;
+    const double t = (frame_index * kSamplesPerChannel + i) /
+        static_cast<double>(kSampleRateHz);
+    const double tone = 3000 * sin(2 * kPi * (200 + 10 * stream) * t);
+    frame->data_[i] = static_cast<int16_t>(tone + noise);
+  }
+}
+
+class AudioProcessingPoolTest : public ::testing::Test {
+ protected:
+  // Adds |num_streams| streams to |pool_|, configured by Configure().
+  void AddStreams(int num_streams) {
+    for (int i = 0; i < num_streams; i++) {
+      const int id = pool_->AddStream();
+      ASSERT_GE(id, 0);
+      Configure(pool_->stream(id));
+      ids_.push_back(id);
+    }
+    // AudioFrame can't be copied, so it can't be held by a vector.
+    frames_.reset(new AudioFrame[ids_.size()]);
+    frame_pointers_.resize(ids_.size());
+    errors_.resize(ids_.size());
+    for (size_t i = 0; i < ids_.size(); i++) {
+      frame_pointers_[i] = &frames_[i];
+    }
+  }
+
+  // Generates frame |frame_index| of every stream, and processes them.
+  int ProcessStreams(int frame_index) {
+    for (size_t i = 0; i < ids_.size(); i++) {
+      GenerateFrame(ids_[i], frame_index, &frames_[i]);
+    }
+    return pool_->ProcessStreams(&ids_[0], &frame_pointers_[0], &errors_[0],
+                                 static_cast<int>(ids_.size()));
+  }
+
+  scoped_ptr<AudioProcessingPool> pool_;
+  std::vector<int> ids_;
+  scoped_array<AudioFrame> frames_;
+  std::vector<AudioFrame*> frame_pointers_;
+  std::vector<int> errors_;
+};
+
+TEST_F(AudioProcessingPoolTest, AddsAndRemovesStreams) {
+  pool_.reset(AudioProcessingPool::Create(0));
+  ASSERT_TRUE(pool_.get() != NULL);
+  EXPECT_EQ(0, pool_->num_streams());
+  EXPECT_TRUE(pool_->stream(0) == NULL);
+  EXPECT_TRUE(pool_->stream(-1) == NULL);
+
+  EXPECT_EQ(0, pool_->AddStream());
+  EXPECT_EQ(1, pool_->AddStream());
+  EXPECT_EQ(2, pool_->AddStream());
+  EXPECT_EQ(3, pool_->num_streams());
+  EXPECT_EQ(AudioProcessing::kNoError, pool_->RemoveStream(1));
+  EXPECT_TRUE(pool_->stream(1) == NULL);
+  EXPECT_EQ(AudioProcessing::kBadParameterError, pool_->RemoveStream(1));
+  EXPECT_EQ(2, pool_->num_streams());
+  // The id of the removed stream is reused.
+  EXPECT_EQ(1, pool_->AddStream());
+  EXPECT_TRUE(pool_->stream(1) != NULL);
+  EXPECT_EQ(3, pool_->AddStream());
+}
+
+TEST_F(AudioProcessingPoolTest, ProcessesLikeSeparateInstances) {
+  const int kNumStreams = 21;
+  const int kNumFrames = 50;
+  pool_.reset(AudioProcessingPool::Create(3));
+  ASSERT_TRUE(pool_.get() != NULL);
+  AddStreams(kNumStreams);
+
+  std::vector<AudioProcessing*> references;
+  for (int i = 0; i < kNumStreams; i++) {
+    references.push_back(AudioProcessing::Create(i));
+    Configure(references.back());
+  }
+
+  AudioFrame reference_frame;
+  for (int j = 0; j < kNumFrames; j++) {
+    ASSERT_EQ(AudioProcessing::kNoError, ProcessStreams(j));
+    for (int i = 0; i < kNumStreams; i++) {
+      EXPECT_EQ(AudioProcessing::kNoError, errors_[i]);
+      GenerateFrame(ids_[i], j, &reference_frame);
+      ASSERT_EQ(AudioProcessing::kNoError,
+                references[i]->ProcessStream(&reference_frame));
+      EXPECT_EQ(0, memcmp(reference_frame.data_, frames_[i].data_,
+                          sizeof(int16_t) * kSamplesPerChannel));
+    }
+  }
+
+  for (int i = 0; i < kNumStreams; i++) {
+    delete references[i];
+  }
+
+  AudioProcessingPool::Statistics stats;
+  pool_->GetStatistics(&stats);
+  EXPECT_EQ(kNumFrames, stats.ticks);
+  EXPECT_EQ(kNumFrames * kNumStreams, stats.frames);
+  EXPECT_GT(stats.streams_per_core, 0);
+  EXPECT_LE(stats.average_tick_us, stats.max_tick_us);
+  pool_->GetStatistics(&stats);
+  EXPECT_EQ(0, stats.ticks);
+}
+
+TEST_F(AudioProcessingPoolTest, ReportsErrorsPerFrame) {
+  pool_.reset(AudioProcessingPool::Create(2));
+  ASSERT_TRUE(pool_.get() != NULL);
+  AddStreams(4);
+
+  EXPECT_EQ(AudioProcessing::kNullPointerError,
+            pool_->ProcessStreams(NULL, &frame_pointers_[0], NULL, 4));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            pool_->ProcessStreams(NULL, NULL, NULL, 0));
+
+  ids_[1] = 17;
+  for (size_t i = 0; i < ids_.size(); i++) {
+    GenerateFrame(0, 0, &frames_[i]);
+  }
+  frames_[2].sample_rate_hz_ = 32000;
+  frame_pointers_[3] = NULL;
+  EXPECT_EQ(AudioProcessing::kBadParameterError,
+            pool_->ProcessStreams(&ids_[0], &frame_pointers_[0], &errors_[0],
+                                  4));
+  EXPECT_EQ(AudioProcessing::kNoError, errors_[0]);
+  EXPECT_EQ(AudioProcessing::kBadParameterError, errors_[1]);
+  EXPECT_EQ(AudioProcessing::kBadSampleRateError, errors_[2]);
+  EXPECT_EQ(AudioProcessing::kNullPointerError, errors_[3]);
+}
+
+// Measures the time per tick of processing many streams, and the number of
+// streams a core can process in real time.
+TEST_F(AudioProcessingPoolTest, DISABLED_ProcessStreamsBenchmark) {
+  const int kNumStreams = 200;
+  const int kNumFrames = 100;
+  const int kNumThreads[] = {0, 1, 3};
+  for (size_t i = 0; i < sizeof(kNumThreads) / sizeof(kNumThreads[0]); i++) {
+    pool_.reset(AudioProcessingPool::Create(kNumThreads[i]));
+    ASSERT_TRUE(pool_.get() != NULL);
+    ids_.clear();
+    AddStreams(kNumStreams);
+    for (int j = 0; j < kNumFrames; j++) {
+      ASSERT_EQ(AudioProcessing::kNoError, ProcessStreams(j));
+    }
+    AudioProcessingPool::Statistics stats;
+    pool_->GetStatistics(&stats);
+    printf("%d streams with NS and AGC, %d worker threads: %d us per tick "
+           "(max %d us), %.0f streams per core\n", kNumStreams,
+           kNumThreads[i], stats.average_tick_us, stats.max_tick_us,
+           stats.streams_per_core);
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -123,15 +123,27 @@ int EchoCancellationImpl::ProcessCaptureAudio(AudioBuffer* audio) {
   for (int i = 0; i < audio->num_channels(); i++) {
     for (int j = 0; j < apm_->num_reverse_channels(); j++) {
       Handle* my_handle = handle(handle_index);
-      err = WebRtcAec_Process(
-          my_handle,
-          audio->low_pass_split_data(i),
-          audio->high_pass_split_data(i),
-          audio->low_pass_split_data(i),
-          audio->high_pass_split_data(i),
-          static_cast<int16_t>(audio->samples_per_split_channel()),
-          apm_->stream_delay_ms(),
-          stream_drift_samples_);
+      if (audio->is_float()) {
+        err = WebRtcAec_ProcessFloat(
+            my_handle,
+            audio->low_pass_split_data_f(i),
+            audio->high_pass_split_data_f(i),
+            audio->low_pass_split_data_f(i),
+            audio->high_pass_split_data_f(i),
+            static_cast<int16_t>(audio->samples_per_split_channel()),
+            apm_->stream_delay_ms(),
+            stream_drift_samples_);
+      } else {
+        err = WebRtcAec_Process(
+            my_handle,
+            audio->low_pass_split_data(i),
+            audio->high_pass_split_data(i),
+            audio->low_pass_split_data(i),
+            audio->high_pass_split_data(i),
+            static_cast<int16_t>(audio->samples_per_split_channel()),
+            apm_->stream_delay_ms(),
+            stream_drift_samples_);
+      }
 
       if (err != apm_->kNoError) {
         err = GetHandleError(my_handle);
@@ -58,8 +58,10 @@ class VoiceDetection;
 //   2. Parameter getters are never called concurrently with the corresponding
 //      setter.
 //
-// APM accepts only 16-bit linear PCM audio data in frames of 10 ms. Multiple
-// channels should be interleaved.
+// APM accepts 16-bit linear PCM audio data in frames of 10 ms. Multiple
+// channels should be interleaved. Capture audio may alternatively be passed as
+// deinterleaved float channels, which saves conversions between the float
+// components.
 //
 // Usage example, omitting error checking:
 // AudioProcessing* apm = AudioProcessing::Create(0);
@@ -161,6 +163,20 @@ class AudioProcessing : public Module {
   // to APM.
   virtual int ProcessStream(AudioFrame* frame) = 0;
 
+  // Processes a 10 ms frame of float audio in place, as ProcessStream() above.
+  // |data| holds |num_channels| pointers to |samples_per_channel| samples
+  // each, in the range of int16. |sample_rate_hz| and |num_channels| must
+  // correspond to the settings supplied to APM. If fewer output than input
+  // channels are configured, only the first output channels are written.
+  //
+  // The float components (echo cancellation and, in float builds, noise
+  // suppression) then process the samples without rounding them to int16.
+  // Channels aligned to 16 bytes are copied the fastest.
+  virtual int ProcessStream(float* const* data,
+                            int samples_per_channel,
+                            int sample_rate_hz,
+                            int num_channels) = 0;
+
   // Analyzes a 10 ms |frame| of the reverse direction audio stream. The frame
   // will not be modified. On the client-side, this is the far-end (or to be
   // rendered) audio.
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_INCLUDE_AUDIO_PROCESSING_POOL_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_INCLUDE_AUDIO_PROCESSING_POOL_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class AudioFrame;
+class AudioProcessing;
+
+// Processes the capture streams of many AudioProcessing instances, one 10 ms
+// frame per stream and tick, on a pool of threads. This is intended for
+// servers applying e.g. noise suppression and gain control to every incoming
+// stream.
+//
+// Each thread is given a contiguous range of the streams of a batch. As long
+// as the streams are passed in the same order every tick, a stream is
+// processed by the same thread, so its state stays in the cache of one core.
+//
+// Usage example, omitting error checking:
+// AudioProcessingPool* pool = AudioProcessingPool::Create(3);
+// int id = pool->AddStream();
+// pool->stream(id)->set_sample_rate_hz(16000);
+// pool->stream(id)->noise_suppression()->Enable(true);
+// ...
+// // Every 10 ms:
+// pool->ProcessStreams(ids, frames, errors, num_streams);
+//
+// All methods must be called from the same thread.
+class AudioProcessingPool {
+ public:
+  struct Statistics {
+    Statistics()
+        : ticks(0),
+          frames(0),
+          average_tick_us(0),
+          max_tick_us(0),
+          streams_per_core(0.0f) {}
+
+    // Number of ProcessStreams() calls and frames processed by them.
+    int ticks;
+    int frames;
+    // Wall clock time of a ProcessStreams() call.
+    int average_tick_us;
+    int max_tick_us;
+    // Number of real-time streams one core can process, i.e. 10 ms divided by
+    // the processing time per frame, summed over all threads.
+    float streams_per_core;
+  };
+
+  // Creates a pool processing on |num_threads| worker threads in addition to
+  // the thread calling ProcessStreams(). Returns NULL if a thread can't be
+  // started.
+  static AudioProcessingPool* Create(int num_threads);
+  virtual ~AudioProcessingPool() {}
+
+  // Creates an AudioProcessing instance for a new stream, owned by the pool,
+  // and returns its id, or -1 on error. Ids of removed streams are reused.
+  virtual int AddStream() = 0;
+  virtual int RemoveStream(int id) = 0;
+
+  // Returns the instance of stream |id|, to be configured as any
+  // AudioProcessing instance, or NULL if there's no such stream. It must not
+  // be used during ProcessStreams().
+  virtual AudioProcessing* stream(int id) const = 0;
+  virtual int num_streams() const = 0;
+
+  // Processes |frames[i]| through stream |ids[i]| for |num_frames| frames in
+  // parallel, as AudioProcessing::ProcessStream() would. The stream
+  // parameters, such as the delay, must be set on the streams beforehand.
+  // |errors[i]|, if |errors| isn't NULL, receives the result of the i'th
+  // frame.
+  //
+  // Returns AudioProcessing::kNoError if all frames were processed without
+  // error, and otherwise the first error.
+  virtual int ProcessStreams(const int* ids,
+                             AudioFrame* const* frames,
+                             int* errors,
+                             int num_frames) = 0;
+
+  // Returns the statistics since the previous call, and resets them.
+  virtual void GetStatistics(Statistics* stats) = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_INCLUDE_AUDIO_PROCESSING_POOL_H_
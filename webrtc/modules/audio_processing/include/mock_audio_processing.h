@@ -197,6 +197,9 @@ class MockAudioProcessing : public AudioProcessing {
       int());
   MOCK_METHOD1(ProcessStream,
       int(AudioFrame* frame));
+  MOCK_METHOD4(ProcessStream,
+      int(float* const* data, int samples_per_channel, int sample_rate_hz,
+          int num_channels));
   MOCK_METHOD1(AnalyzeReverseStream,
       int(AudioFrame* frame));
   MOCK_METHOD1(set_stream_delay_ms,
@@ -104,6 +104,17 @@ int WebRtcNs_Process(NsHandle* NS_inst,
                      short* outframe,
                      short* outframe_H);
 
+/*
+ * Same as WebRtcNs_Process(), for float samples in the range of short. The
+ * output is limited to that range, but not rounded. The output may point to
+ * the input.
+ */
+int WebRtcNs_ProcessFloat(NsHandle* NS_inst,
+                          const float* spframe,
+                          const float* spframe_H,
+                          float* outframe,
+                          float* outframe_H);
+
 /* Returns the internally used prior speech probability of the current frame.
  * There is a frequency bin based one as well, with which this should not be
  * confused.
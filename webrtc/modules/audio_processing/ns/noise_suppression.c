@@ -45,6 +45,43 @@ int WebRtcNs_set_policy(NsHandle* NS_inst, int mode) {
 
 int WebRtcNs_Process(NsHandle* NS_inst, short* spframe, short* spframe_H,
                      short* outframe, short* outframe_H) {
+  NSinst_t* self = (NSinst_t*) NS_inst;
+  float in[BLOCKL_MAX];
+  float in_H[BLOCKL_MAX];
+  float out[BLOCKL_MAX];
+  float out_H[BLOCKL_MAX];
+  int i;
+
+  if (self->initFlag != 1) {
+    return -1;
+  }
+  for (i = 0; i < self->blockLen10ms; i++) {
+    in[i] = spframe[i];
+  }
+  if (spframe_H != NULL) {
+    for (i = 0; i < self->blockLen10ms; i++) {
+      in_H[i] = spframe_H[i];
+    }
+  }
+  if (WebRtcNs_ProcessCore(self, in, spframe_H != NULL ? in_H : NULL,
+                           out, out_H) != 0) {
+    return -1;
+  }
+  // The output is already limited to the range of short.
+  for (i = 0; i < self->blockLen10ms; i++) {
+    outframe[i] = (short) out[i];
+  }
+  if (self->fs == 32000) {
+    for (i = 0; i < self->blockLen10ms; i++) {
+      outframe_H[i] = (short) out_H[i];
+    }
+  }
+  return 0;
+}
+
+int WebRtcNs_ProcessFloat(NsHandle* NS_inst, const float* spframe,
+                          const float* spframe_H, float* outframe,
+                          float* outframe_H) {
   return WebRtcNs_ProcessCore(
       (NSinst_t*) NS_inst, spframe, spframe_H, outframe, outframe_H);
 }
@@ -715,10 +715,10 @@ void WebRtcNs_SpeechNoiseProb(NSinst_t* inst, float* probSpeechFinal, float* snr
 }
 
 int WebRtcNs_ProcessCore(NSinst_t* inst,
-                         short* speechFrame,
-                         short* speechFrameHB,
-                         short* outFrame,
-                         short* outFrameHB) {
+                         const float* speechFrame,
+                         const float* speechFrameHB,
+                         float* outFrame,
+                         float* outFrameHB) {
   // main routine for noise reduction
 
   int     flagHB = 0;
@@ -732,7 +732,7 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
   float   tmpFloat1, tmpFloat2, tmpFloat3, probSpeech, probNonSpeech;
   float   gammaNoiseTmp, gammaNoiseOld;
   float   noiseUpdateTmp, fTmp, dTmp;
-  float   fin[BLOCKL_MAX], fout[BLOCKL_MAX];
+  float   fout[BLOCKL_MAX];
   float   winData[ANAL_BLOCKL_MAX];
   float   magn[HALF_ANAL_BLOCKL], noise[HALF_ANAL_BLOCKL];
   float   theFilter[HALF_ANAL_BLOCKL], theFilterTmp[HALF_ANAL_BLOCKL];
@@ -776,25 +776,17 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
   //
 
   //for LB do all processing
-  // convert to float
-  for (i = 0; i < inst->blockLen10ms; i++) {
-    fin[i] = (float)speechFrame[i];
-  }
   // update analysis buffer for L band
   memcpy(inst->dataBuf, inst->dataBuf + inst->blockLen10ms,
          sizeof(float) * (inst->anaLen - inst->blockLen10ms));
-  memcpy(inst->dataBuf + inst->anaLen - inst->blockLen10ms, fin,
+  memcpy(inst->dataBuf + inst->anaLen - inst->blockLen10ms, speechFrame,
          sizeof(float) * inst->blockLen10ms);
 
   if (flagHB == 1) {
-    // convert to float
-    for (i = 0; i < inst->blockLen10ms; i++) {
-      fin[i] = (float)speechFrameHB[i];
-    }
     // update analysis buffer for H band
     memcpy(inst->dataBufHB, inst->dataBufHB + inst->blockLen10ms,
            sizeof(float) * (inst->anaLen - inst->blockLen10ms));
-    memcpy(inst->dataBufHB + inst->anaLen - inst->blockLen10ms, fin,
+    memcpy(inst->dataBufHB + inst->anaLen - inst->blockLen10ms, speechFrameHB,
            sizeof(float) * inst->blockLen10ms);
   }
 
@@ -833,7 +825,7 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
           inst->outBuf[i] = fout[i + inst->blockLen10ms];
         }
       }
-      // convert to short
+      // limit to the range of short
       for (i = 0; i < inst->blockLen10ms; i++) {
         dTmp = fout[i];
         if (dTmp < WEBRTC_SPL_WORD16_MIN) {
@@ -841,7 +833,7 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
         } else if (dTmp > WEBRTC_SPL_WORD16_MAX) {
           dTmp = WEBRTC_SPL_WORD16_MAX;
         }
-        outFrame[i] = (short)dTmp;
+        outFrame[i] = dTmp;
       }
 
       // for time-domain gain of HB
@@ -853,7 +845,7 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
           } else if (dTmp > WEBRTC_SPL_WORD16_MAX) {
             dTmp = WEBRTC_SPL_WORD16_MAX;
           }
-          outFrameHB[i] = (short)dTmp;
+          outFrameHB[i] = dTmp;
         }
       } // end of H band gain computation
       //
@@ -1239,7 +1231,7 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
     inst->outLen -= inst->blockLen10ms;
   }
 
-  // convert to short
+  // limit to the range of short
   for (i = 0; i < inst->blockLen10ms; i++) {
     dTmp = fout[i];
     if (dTmp < WEBRTC_SPL_WORD16_MIN) {
@@ -1247,7 +1239,7 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
     } else if (dTmp > WEBRTC_SPL_WORD16_MAX) {
       dTmp = WEBRTC_SPL_WORD16_MAX;
     }
-    outFrame[i] = (short)dTmp;
+    outFrame[i] = dTmp;
   }
 
   // for time-domain gain of HB
@@ -1295,7 +1287,7 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
       } else if (dTmp > WEBRTC_SPL_WORD16_MAX) {
         dTmp = WEBRTC_SPL_WORD16_MAX;
       }
-      outFrameHB[i] = (short)dTmp;
+      outFrameHB[i] = dTmp;
     }
   } // end of H band gain computation
   //
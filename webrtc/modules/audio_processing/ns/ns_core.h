@@ -158,8 +158,10 @@ int WebRtcNs_set_policy_core(NSinst_t* inst, int mode);
  *
  * Output:
  *      - inst          : Updated instance
- *      - outFrameLow   : Output speech frame for lower band
- *      - outFrameHigh  : Output speech frame for higher band
+ *      - outFrameLow   : Output speech frame for lower band, limited to the
+ *                        range of short
+ *      - outFrameHigh  : Output speech frame for higher band, limited to the
+ *                        range of short
  *
  * Return value         :  0 - OK
  *                        -1 - Error
@@ -167,10 +169,10 @@ int WebRtcNs_set_policy_core(NSinst_t* inst, int mode);
 
 
 int WebRtcNs_ProcessCore(NSinst_t* inst,
-                         short* inFrameLow,
-                         short* inFrameHigh,
-                         short* outFrameLow,
-                         short* outFrameHigh);
+                         const float* inFrameLow,
+                         const float* inFrameHigh,
+                         float* outFrameLow,
+                         float* outFrameHigh);
 
 
 #ifdef __cplusplus
@@ -134,6 +134,8 @@ void usage() {
   printf("  --noasm            Disable SSE optimization.\n");
   printf("  --delay DELAY      Add DELAY ms to input value.\n");
   printf("  --perf             Measure performance.\n");
+  printf("  --float            Process capture frames through the float"
+         " interface.\n");
   printf("  --quiet            Suppress text output.\n");
   printf("  --no_progress      Suppress progress.\n");
   printf("  --debug_file FILE  Dump a debug recording.\n");
@@ -155,6 +157,64 @@ static void SimulateMic(int mic_level, AudioFrame* frame) {
   }
 }
 
+const int kMaxChannels = 2;
+const int kMaxSamplesPerChannel = 320;
+
+// A deinterleaved float copy of an AudioFrame, for the float interface of
+// ProcessStream().
+class FloatFrame {
+ public:
+  FloatFrame() {
+    for (int i = 0; i < kMaxChannels; i++) {
+      channels_[i] = data_[i];
+    }
+  }
+
+  void CopyFrom(const AudioFrame& frame) {
+    ASSERT_LE(frame.num_channels_, kMaxChannels);
+    ASSERT_LE(frame.samples_per_channel_, kMaxSamplesPerChannel);
+    for (int i = 0; i < frame.num_channels_; i++) {
+      for (int j = 0; j < frame.samples_per_channel_; j++) {
+        data_[i][j] = frame.data_[j * frame.num_channels_ + i];
+      }
+    }
+  }
+
+  // Rounds the first |num_channels| channels back into |frame|.
+  void CopyTo(int num_channels, AudioFrame* frame) const {
+    frame->num_channels_ = num_channels;
+    for (int i = 0; i < num_channels; i++) {
+      for (int j = 0; j < frame->samples_per_channel_; j++) {
+        float v = floor(data_[i][j] + 0.5f);
+        v = std::max(std::min(32767.0f, v), -32768.0f);
+        frame->data_[j * num_channels + i] = static_cast<int16_t>(v);
+      }
+    }
+  }
+
+  float* const* channels() { return channels_; }
+
+ private:
+  float data_[kMaxChannels][kMaxSamplesPerChannel];
+  float* channels_[kMaxChannels];
+};
+
+// Processes |near_frame|, through the float interface if |float_frame| isn't
+// NULL, in which case |float_frame| must hold a copy of |near_frame|.
+int ProcessStream(AudioProcessing* apm,
+                  AudioFrame* near_frame,
+                  FloatFrame* float_frame) {
+  if (float_frame == NULL) {
+    return apm->ProcessStream(near_frame);
+  }
+  int err = apm->ProcessStream(float_frame->channels(),
+                               near_frame->samples_per_channel_,
+                               near_frame->sample_rate_hz_,
+                               near_frame->num_channels_);
+  near_frame->num_channels_ = apm->num_output_channels();
+  return err;
+}
+
 // void function for gtest.
 void void_main(int argc, char* argv[]) {
   if (argc > 1 && strcmp(argv[1], "--help") == 0) {
@@ -190,6 +250,7 @@ void void_main(int argc, char* argv[]) {
 
   bool simulating = false;
   bool perf_testing = false;
+  bool float_interface = false;
   bool verbose = true;
   bool progress = true;
   int extra_delay_ms = 0;
@@ -436,6 +497,9 @@ void void_main(int argc, char* argv[]) {
     } else if (strcmp(argv[i], "--perf") == 0) {
       perf_testing = true;
 
+    } else if (strcmp(argv[i], "--float") == 0) {
+      float_interface = true;
+
     } else if (strcmp(argv[i], "--quiet") == 0) {
       verbose = false;
       progress = false;
@@ -592,6 +656,8 @@ void void_main(int argc, char* argv[]) {
 
   AudioFrame far_frame;
   AudioFrame near_frame;
+  FloatFrame float_frame;
+  FloatFrame* float_near_frame = float_interface ? &float_frame : NULL;
 
   int delay_ms = 0;
   int drift_samples = 0;
@@ -708,6 +774,10 @@ void void_main(int argc, char* argv[]) {
           fflush(stdout);
         }
 
+        if (float_near_frame != NULL) {
+          float_near_frame->CopyFrom(near_frame);
+        }
+
         if (perf_testing) {
           t0 = TickTime::Now();
         }
@@ -718,7 +788,7 @@ void void_main(int argc, char* argv[]) {
                   apm->set_stream_delay_ms(msg.delay() + extra_delay_ms));
         apm->echo_cancellation()->set_stream_drift_samples(msg.drift());
 
-        int err = apm->ProcessStream(&near_frame);
+        int err = ProcessStream(apm, &near_frame, float_near_frame);
         if (err == apm->kBadStreamParameterWarning) {
           printf("Bad parameter warning. %s\n", trace_stream.str().c_str());
         }
@@ -755,6 +825,10 @@ void void_main(int argc, char* argv[]) {
           }
         }
 
+        if (float_near_frame != NULL) {
+          float_near_frame->CopyTo(near_frame.num_channels_, &near_frame);
+        }
+
         size_t size = samples_per_channel * near_frame.num_channels_;
         ASSERT_EQ(size, fwrite(near_frame.data_,
                                sizeof(int16_t),
@@ -910,6 +984,10 @@ void void_main(int argc, char* argv[]) {
           SimulateMic(capture_level, &near_frame);
         }
 
+        if (float_near_frame != NULL) {
+          float_near_frame->CopyFrom(near_frame);
+        }
+
         if (perf_testing) {
           t0 = TickTime::Now();
         }
@@ -921,7 +999,7 @@ void void_main(int argc, char* argv[]) {
                   apm->set_stream_delay_ms(delay_ms + extra_delay_ms));
         apm->echo_cancellation()->set_stream_drift_samples(drift_samples);
 
-        int err = apm->ProcessStream(&near_frame);
+        int err = ProcessStream(apm, &near_frame, float_near_frame);
         if (err == apm->kBadStreamParameterWarning) {
           printf("Bad parameter warning. %s\n", trace_stream.str().c_str());
         }
@@ -964,6 +1042,10 @@ void void_main(int argc, char* argv[]) {
           }
         }
 
+        if (float_near_frame != NULL) {
+          float_near_frame->CopyTo(near_frame.num_channels_, &near_frame);
+        }
+
         size = samples_per_channel * near_frame.num_channels_;
         ASSERT_EQ(size, fwrite(near_frame.data_,
                                sizeof(int16_t),
@@ -21,6 +21,7 @@
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
 #include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/test/testsupport/fileutils.h"
 #ifdef WEBRTC_ANDROID_PLATFORM_BUILD
@@ -41,6 +42,7 @@ using webrtc::NoiseSuppression;
 using webrtc::EchoCancellation;
 using webrtc::EventWrapper;
 using webrtc::scoped_array;
+using webrtc::TickTime;
 using webrtc::Trace;
 using webrtc::LevelEstimator;
 using webrtc::EchoCancellation;
@@ -141,6 +143,45 @@ bool FrameDataAreEqual(const AudioFrame& frame1, const AudioFrame& frame2) {
   return true;
 }
 
+const int kMaxChannels = 2;
+const int kMaxSamplesPerChannel = 320;
+
+// Deinterleaved float channels for the float interface of ProcessStream().
+class FloatFrame {
+ public:
+  FloatFrame() {
+    for (int i = 0; i < kMaxChannels; i++) {
+      channels_[i] = data_[i];
+    }
+  }
+
+  void CopyFrom(const AudioFrame& frame) {
+    ASSERT_LE(frame.num_channels_, kMaxChannels);
+    for (int i = 0; i < frame.num_channels_; i++) {
+      for (int j = 0; j < frame.samples_per_channel_; j++) {
+        data_[i][j] = frame.data_[j * frame.num_channels_ + i];
+      }
+    }
+  }
+
+  // Rounds the first |frame->num_channels_| channels into |frame|.
+  void CopyTo(AudioFrame* frame) const {
+    for (int i = 0; i < frame->num_channels_; i++) {
+      for (int j = 0; j < frame->samples_per_channel_; j++) {
+        frame->data_[j * frame->num_channels_ + i] = static_cast<int16_t>(
+            std::max(std::min(data_[i][j], 32767.0f), -32768.0f) +
+            (data_[i][j] > 0 ? 0.5f : -0.5f));
+      }
+    }
+  }
+
+  float* const* channels() { return channels_; }
+
+ private:
+  float data_[kMaxChannels][kMaxSamplesPerChannel];
+  float* channels_[kMaxChannels];
+};
+
 void TestStats(const AudioProcessing::Statistic& test,
                const webrtc::audioproc::Test::Statistic& reference) {
   EXPECT_EQ(reference.instant(), test.instant);
@@ -232,6 +273,9 @@ class ApmTest : public ::testing::Test {
   void EnableAllComponents();
   bool ReadFrame(FILE* file, AudioFrame* frame);
   void ProcessWithDefaultStreamParameters(AudioFrame* frame);
+  // Processes |frame| through the float interface, and rounds the output back
+  // into |frame|.
+  void ProcessFloatWithDefaultStreamParameters(AudioFrame* frame);
   template <typename F>
   void ChangeTriggersInit(F f, AudioProcessing* ap, int initial_value,
                           int changed_value);
@@ -450,6 +494,22 @@ void ApmTest::ProcessWithDefaultStreamParameters(AudioFrame* frame) {
   EXPECT_EQ(apm_->kNoError, apm_->ProcessStream(frame));
 }
 
+void ApmTest::ProcessFloatWithDefaultStreamParameters(AudioFrame* frame) {
+  FloatFrame float_frame;
+  float_frame.CopyFrom(*frame);
+  EXPECT_EQ(apm_->kNoError, apm_->set_stream_delay_ms(0));
+  apm_->echo_cancellation()->set_stream_drift_samples(0);
+  EXPECT_EQ(apm_->kNoError,
+      apm_->gain_control()->set_stream_analog_level(127));
+  EXPECT_EQ(apm_->kNoError,
+            apm_->ProcessStream(float_frame.channels(),
+                                frame->samples_per_channel_,
+                                frame->sample_rate_hz_,
+                                frame->num_channels_));
+  frame->num_channels_ = apm_->num_output_channels();
+  float_frame.CopyTo(frame);
+}
+
 template <typename F>
 void ApmTest::ChangeTriggersInit(F f, AudioProcessing* ap, int initial_value,
                                  int changed_value) {
@@ -1363,6 +1423,194 @@ TEST_F(ApmTest, SplittingFilter) {
   EXPECT_FALSE(FrameDataAreEqual(*frame_, frame_copy));
 }
 
+TEST_F(ApmTest, FloatStreamParameters) {
+  FloatFrame float_frame;
+  float_frame.CopyFrom(*frame_);
+  EXPECT_EQ(apm_->kNullPointerError,
+            apm_->ProcessStream(NULL, 320, 32000, 2));
+  float* null_channels[] = {NULL, NULL};
+  EXPECT_EQ(apm_->kNullPointerError,
+            apm_->ProcessStream(null_channels, 320, 32000, 2));
+  EXPECT_EQ(apm_->kBadSampleRateError,
+            apm_->ProcessStream(float_frame.channels(), 160, 16000, 2));
+  EXPECT_EQ(apm_->kBadNumberChannelsError,
+            apm_->ProcessStream(float_frame.channels(), 320, 32000, 1));
+  EXPECT_EQ(apm_->kBadDataLengthError,
+            apm_->ProcessStream(float_frame.channels(), 160, 32000, 2));
+  EXPECT_EQ(apm_->kNoError,
+            apm_->ProcessStream(float_frame.channels(), 320, 32000, 2));
+}
+
+TEST_F(ApmTest, FloatNoProcessingAndDownMixing) {
+  for (size_t i = 0; i < kSampleRatesSize; i++) {
+    Init(kSampleRates[i], 2, 2, 2, false);
+    SetFrameTo(frame_, 1000, 2000);
+    AudioFrame frame_copy;
+    frame_copy.CopyFrom(*frame_);
+    ProcessFloatWithDefaultStreamParameters(frame_);
+    EXPECT_TRUE(FrameDataAreEqual(*frame_, frame_copy));
+
+    Init(kSampleRates[i], 2, 2, 1, false);
+    AudioFrame mono_frame;
+    mono_frame.samples_per_channel_ = frame_->samples_per_channel_;
+    mono_frame.num_channels_ = 1;
+    SetFrameTo(&mono_frame, 1500);
+    ProcessFloatWithDefaultStreamParameters(frame_);
+    EXPECT_TRUE(FrameDataAreEqual(*frame_, mono_frame));
+  }
+}
+
+// The float interface only differs from the int16 interface in skipping the
+// rounding between the float components. Without those, the output has to be
+// identical, and otherwise close.
+TEST_F(ApmTest, FloatInterfaceMatchesInt16Interface) {
+  for (int float_components = 0; float_components < 2; float_components++) {
+    for (size_t i = 0; i < kProcessSampleRatesSize; i++) {
+      AudioProcessing::Destroy(apm_);
+      apm_ = AudioProcessing::Create(0);
+      ASSERT_TRUE(apm_ != NULL);
+      Init(kProcessSampleRates[i], 1, 1, 1, false);
+      webrtc::scoped_ptr<AudioProcessing> int16_apm(
+          AudioProcessing::Create(1));
+      ASSERT_TRUE(int16_apm.get() != NULL);
+      ASSERT_EQ(apm_->kNoError,
+                int16_apm->set_sample_rate_hz(kProcessSampleRates[i]));
+      AudioProcessing* apms[] = {apm_, int16_apm.get()};
+      for (int j = 0; j < 2; j++) {
+        EXPECT_EQ(apm_->kNoError, apms[j]->high_pass_filter()->Enable(true));
+        if (float_components) {
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+          EXPECT_EQ(apm_->kNoError,
+                    apms[j]->echo_cancellation()->Enable(true));
+#endif
+          EXPECT_EQ(apm_->kNoError,
+                    apms[j]->noise_suppression()->Enable(true));
+        } else {
+          EXPECT_EQ(apm_->kNoError, apms[j]->gain_control()->set_mode(
+              GainControl::kAdaptiveDigital));
+          EXPECT_EQ(apm_->kNoError, apms[j]->gain_control()->Enable(true));
+        }
+      }
+
+      AudioFrame int16_frame;
+      double signal_energy = 0;
+      double error_energy = 0;
+      int16_t max_error = 0;
+      while (ReadFrame(far_file_, revframe_) && ReadFrame(near_file_, frame_)) {
+        EXPECT_EQ(apm_->kNoError, apm_->AnalyzeReverseStream(revframe_));
+        EXPECT_EQ(apm_->kNoError, int16_apm->AnalyzeReverseStream(revframe_));
+
+        int16_frame.CopyFrom(*frame_);
+        EXPECT_EQ(apm_->kNoError, int16_apm->set_stream_delay_ms(0));
+        EXPECT_EQ(apm_->kNoError,
+            int16_apm->gain_control()->set_stream_analog_level(127));
+        EXPECT_EQ(apm_->kNoError, int16_apm->ProcessStream(&int16_frame));
+        ProcessFloatWithDefaultStreamParameters(frame_);
+
+        for (int k = 0; k < frame_->samples_per_channel_; k++) {
+          const int16_t error = AbsValue<int16_t>(
+              frame_->data_[k] - int16_frame.data_[k]);
+          max_error = std::max(max_error, error);
+          signal_energy += int16_frame.data_[k] * int16_frame.data_[k];
+          error_energy += error * error;
+        }
+      }
+      rewind(far_file_);
+      rewind(near_file_);
+
+      if (float_components) {
+        // At least 30 dB between the output and the difference.
+        EXPECT_LT(error_energy * 1000, signal_energy);
+      } else {
+        EXPECT_EQ(0, max_error);
+      }
+    }
+  }
+}
+
+// Measures the processing time per frame of common configurations, through
+// the int16 and the float interface.
+TEST_F(ApmTest, DISABLED_ProcessStreamBenchmark) {
+  enum Configuration {
+    kNs,
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+    kAecNs,
+#endif
+    kAllComponents,
+    kNumConfigurations
+  };
+  const char* kConfigurationNames[] = {
+    "NS",
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+    "AEC + NS",
+#endif
+    "all components"
+  };
+  const int kBenchmarkSampleRates[] = {16000, 32000};
+  const size_t kBenchmarkSampleRatesSize =
+      sizeof(kBenchmarkSampleRates) / sizeof(*kBenchmarkSampleRates);
+  const int kNumFrames = 500;
+
+  for (int config = 0; config < kNumConfigurations; config++) {
+    for (size_t i = 0; i < kBenchmarkSampleRatesSize; i++) {
+      int64_t elapsed_us[2] = {0, 0};
+      for (int use_float = 0; use_float < 2; use_float++) {
+        // Start from a new instance with all components disabled.
+        AudioProcessing::Destroy(apm_);
+        apm_ = AudioProcessing::Create(0);
+        ASSERT_TRUE(apm_ != NULL);
+        if (config == kAllComponents) {
+          EnableAllComponents();
+        } else {
+          EXPECT_EQ(apm_->kNoError,
+                    apm_->noise_suppression()->Enable(true));
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+          if (config == kAecNs) {
+            EXPECT_EQ(apm_->kNoError,
+                      apm_->echo_cancellation()->Enable(true));
+          }
+#endif
+        }
+        Init(kBenchmarkSampleRates[i], 1, 1, 1, false);
+
+        FloatFrame float_frame;
+        int frames = 0;
+        while (frames < kNumFrames) {
+          if (!ReadFrame(far_file_, revframe_) ||
+              !ReadFrame(near_file_, frame_)) {
+            rewind(far_file_);
+            rewind(near_file_);
+            continue;
+          }
+          EXPECT_EQ(apm_->kNoError, apm_->AnalyzeReverseStream(revframe_));
+          float_frame.CopyFrom(*frame_);
+
+          EXPECT_EQ(apm_->kNoError, apm_->set_stream_delay_ms(0));
+          apm_->echo_cancellation()->set_stream_drift_samples(0);
+          EXPECT_EQ(apm_->kNoError,
+              apm_->gain_control()->set_stream_analog_level(127));
+          const int64_t start_us = TickTime::MicrosecondTimestamp();
+          if (use_float) {
+            EXPECT_EQ(apm_->kNoError,
+                      apm_->ProcessStream(float_frame.channels(),
+                                          frame_->samples_per_channel_,
+                                          frame_->sample_rate_hz_,
+                                          frame_->num_channels_));
+          } else {
+            EXPECT_EQ(apm_->kNoError, apm_->ProcessStream(frame_));
+          }
+          elapsed_us[use_float] += TickTime::MicrosecondTimestamp() - start_us;
+          frames++;
+        }
+      }
+      printf("%s, %d Hz: %.1f us per 10 ms frame (int16), %.1f us (float)\n",
+             kConfigurationNames[config], kBenchmarkSampleRates[i],
+             static_cast<double>(elapsed_us[0]) / kNumFrames,
+             static_cast<double>(elapsed_us[1]) / kNumFrames);
+    }
+  }
+}
+
 // TODO(andrew): expand test to verify output.
 TEST_F(ApmTest, DebugDump) {
   const std::string filename = webrtc::test::OutputPath() + "debug.aec";
@@ -14,6 +14,7 @@
 #include <utility>
 
 #include "modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "system_wrappers/interface/rtc_event_log.h"
 
 namespace webrtc {
 
@@ -169,6 +170,7 @@ void BitrateControllerImpl::OnReceivedRtcpReceiverReport(
 void BitrateControllerImpl::OnNetworkChanged(const uint32_t bitrate,
                                              const uint8_t fraction_loss,
                                              const uint32_t rtt) {
+  RtcEventLog::LogBitrateControllerUpdate(bitrate, fraction_loss, rtt);
   // Sanity check.
   uint32_t number_of_observers = bitrate_observers_.size();
   if (number_of_observers == 0) {
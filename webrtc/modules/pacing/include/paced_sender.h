@@ -11,8 +11,9 @@
 #ifndef WEBRTC_MODULES_PACED_SENDER_H_
 #define WEBRTC_MODULES_PACED_SENDER_H_
 
+#include <deque>
 #include <list>
-#include <set>
+#include <vector>
 
 #include "webrtc/modules/interface/module.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
@@ -32,6 +33,13 @@ class PacedSender : public Module {
   // Low priority packets are mixed with the normal priority packets
   // while we are paused.
 
+  // A queued packet which is due to be sent.
+  struct QueuedPacket {
+    uint32_t ssrc;
+    uint16_t sequence_number;
+    int64_t capture_time_ms;
+  };
+
   class Callback {
    public:
     // Note: packets sent as a result of a callback should not pass by this
@@ -39,6 +47,11 @@ class PacedSender : public Module {
     // Called when it's time to send a queued packet.
     virtual void TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
                                   int64_t capture_time_ms) = 0;
+    // Called when it's time to send a number of queued packets, which should
+    // be sent in order. The default implementation calls TimeToSendPacket()
+    // for each packet.
+    virtual void TimeToSendPackets(const QueuedPacket* packets,
+                                   int num_packets);
     // Called when it's a good time to send a padding data.
     virtual void TimeToSendPadding(int bytes) = 0;
    protected:
@@ -94,19 +107,64 @@ class PacedSender : public Module {
     int bytes_;
   };
 
-  // STL list style class which prevents duplicates in the list.
+  // Queues the packets of each SSRC separately. Packets of a stream are sent
+  // in the order they were queued, while the streams take turns in deficit
+  // round robin order, which shares the send rate evenly in bytes between
+  // the streams with queued packets. A large frame on one stream therefore
+  // doesn't hold back the packets of other streams. Queuing and dequeuing
+  // take constant time regardless of the number of queued packets.
   class PacketList {
    public:
-    PacketList() {};
+    PacketList();
+    ~PacketList();
 
     bool empty() const;
-    Packet front() const;
-    void pop_front();
+    int size() const;
+    // Returns the packet to send next. Must not be called when empty.
+    const Packet& front() const;
+    // Removes the packet returned by front(). Returns true if no more packets
+    // with the same capture time are queued for its stream.
+    bool pop_front();
+    // Queues |packet| unless a packet with the same SSRC and sequence number
+    // is already queued.
     void push_back(const Packet& packet);
+    // Returns the capture time of the oldest queued packet.
+    int64_t OldestCaptureTimeMs() const;
 
    private:
-    std::list<Packet> packet_list_;
-    std::set<uint16_t> sequence_number_set_;
+    struct Stream {
+      Stream();
+      uint32_t ssrc;
+      std::deque<Packet> packets;
+      // One bit per sequence number, set for the queued packets.
+      std::vector<uint32_t> queued_sequence_numbers;
+      // The number of bytes the stream may send before its turn is over.
+      int deficit_bytes;
+    };
+
+    // Returns the stream of |ssrc|, creating it if it has no queued packets.
+    Stream* GetStream(uint32_t ssrc);
+    // Removes |stream|, which has no more queued packets.
+    void RemoveStream(Stream* stream);
+    int HomeSlot(uint32_t ssrc) const;
+    // Doubles the size of |stream_index_|.
+    void GrowStreamIndex();
+    // Gives the turn to the next stream until the stream at the front of
+    // |active_streams_| can send its next packet.
+    void SelectStream();
+
+    // A stream only exists while it has queued packets. The streams are
+    // indexed by SSRC in an open addressing hash table with linear probing,
+    // which is kept at most half full.
+    std::vector<Stream*> stream_index_;
+    int stream_index_bits_;
+    int num_streams_;
+    // Removed streams kept for reuse. All their sequence number bits are
+    // cleared.
+    std::vector<Stream*> free_streams_;
+    // Streams with queued packets. The front stream has the turn.
+    std::list<Stream*> active_streams_;
+    int size_;
   };
 
   // Checks if next packet in line can be transmitted. Returns true on success.
@@ -125,6 +183,12 @@ class PacedSender : public Module {
   // Updates the buffers with the number of bytes that we sent.
   void UpdateState(int num_bytes);
 
+  // Returns the time the oldest queued packet has been queued.
+  int QueueInMsInternal() const;
+
+  // Logs the queue to the RTC event log, unless it stays empty.
+  void LogQueueState();
+
   Callback* callback_;
   const float pace_multiplier_;
   bool enable_;
@@ -137,6 +201,7 @@ class PacedSender : public Module {
   TickTime time_last_send_;
   int64_t capture_time_ms_last_queued_;
   int64_t capture_time_ms_last_sent_;
+  int queued_packets_last_logged_;
 
   PacketList high_priority_packets_;
   PacketList normal_priority_packets_;
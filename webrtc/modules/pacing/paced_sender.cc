@@ -12,8 +12,11 @@
 
 #include <assert.h>
 
+#include <algorithm>
+
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
 #include "webrtc/system_wrappers/interface/trace_event.h"
 
 namespace {
@@ -28,31 +31,213 @@ const int kMaxIntervalTimeMs = 30;
 // packets are sent, regardless of buffer state. In practice only in effect at
 // low bitrates (less than 320 kbits/s).
 const int kMaxQueueTimeWithoutSendingMs = 30;
+
+// Number of bytes a stream may send per turn while other streams of the same
+// priority have queued packets.
+const int kStreamQuantumBytes = 1500;
+
+// Max number of packets handed to the callback in one call.
+const int kMaxPacketsPerBatch = 32;
+
+// Initial size of the SSRC index of a packet list, as a power of two.
+const int kInitialStreamIndexBits = 4;
+
+// Number of streams without queued packets a packet list keeps for reuse,
+// rather than freeing them and allocating them again once the SSRC queues
+// more packets.
+const size_t kMaxFreeStreams = 2;
 }  // namespace
 
 namespace webrtc {
 
+void PacedSender::Callback::TimeToSendPackets(const QueuedPacket* packets,
+                                              int num_packets) {
+  for (int i = 0; i < num_packets; ++i) {
+    TimeToSendPacket(packets[i].ssrc, packets[i].sequence_number,
+                     packets[i].capture_time_ms);
+  }
+}
+
+PacedSender::PacketList::Stream::Stream()
+    : ssrc(0),
+      packets(),
+      queued_sequence_numbers((1 << 16) / 32),
+      deficit_bytes(0) {
+}
+
+PacedSender::PacketList::PacketList()
+    : stream_index_(1 << kInitialStreamIndexBits, NULL),
+      stream_index_bits_(kInitialStreamIndexBits),
+      num_streams_(0),
+      free_streams_(),
+      active_streams_(),
+      size_(0) {
+}
+
+PacedSender::PacketList::~PacketList() {
+  for (std::list<Stream*>::iterator it = active_streams_.begin();
+       it != active_streams_.end(); ++it) {
+    delete *it;
+  }
+  for (size_t i = 0; i < free_streams_.size(); ++i) {
+    delete free_streams_[i];
+  }
+}
+
 bool PacedSender::PacketList::empty() const {
-  return packet_list_.empty();
+  return active_streams_.empty();
+}
+
+int PacedSender::PacketList::size() const {
+  return size_;
 }
 
-PacedSender::Packet PacedSender::PacketList::front() const {
-  return packet_list_.front();
+const PacedSender::Packet& PacedSender::PacketList::front() const {
+  return active_streams_.front()->packets.front();
 }
 
-void PacedSender::PacketList::pop_front() {
-  PacedSender::Packet& packet = packet_list_.front();
-  uint16_t sequence_number = packet.sequence_number_;
-  packet_list_.pop_front();
-  sequence_number_set_.erase(sequence_number);
+bool PacedSender::PacketList::pop_front() {
+  Stream* stream = active_streams_.front();
+  const Packet& packet = stream->packets.front();
+  const int64_t capture_time_ms = packet.capture_time_ms_;
+  stream->queued_sequence_numbers[packet.sequence_number_ >> 5] &=
+      ~(1u << (packet.sequence_number_ & 31));
+  stream->deficit_bytes -= packet.bytes_;
+  stream->packets.pop_front();
+  --size_;
+  if (stream->packets.empty()) {
+    // A stream can't save up bytes while it has nothing to send.
+    stream->deficit_bytes = 0;
+    active_streams_.pop_front();
+    RemoveStream(stream);
+    if (!active_streams_.empty()) {
+      active_streams_.front()->deficit_bytes += kStreamQuantumBytes;
+      SelectStream();
+    }
+    return true;
+  }
+  const bool last_packet =
+      stream->packets.front().capture_time_ms_ > capture_time_ms;
+  SelectStream();
+  return last_packet;
 }
 
 void PacedSender::PacketList::push_back(const PacedSender::Packet& packet) {
-  if (sequence_number_set_.find(packet.sequence_number_) ==
-      sequence_number_set_.end()) {
+  Stream* stream = GetStream(packet.ssrc_);
+  uint32_t& queued = stream->queued_sequence_numbers[
+      packet.sequence_number_ >> 5];
+  const uint32_t mask = 1u << (packet.sequence_number_ & 31);
+  if (queued & mask) {
     // Don't insert duplicates.
-    packet_list_.push_back(packet);
-    sequence_number_set_.insert(packet.sequence_number_);
+    return;
+  }
+  queued |= mask;
+  stream->packets.push_back(packet);
+  ++size_;
+  if (stream->packets.size() == 1) {
+    active_streams_.push_back(stream);
+    if (active_streams_.front() == stream) {
+      // The only stream with queued packets gets the turn right away.
+      stream->deficit_bytes = kStreamQuantumBytes;
+      SelectStream();
+    }
+  }
+}
+
+int64_t PacedSender::PacketList::OldestCaptureTimeMs() const {
+  int64_t oldest_capture_time_ms = active_streams_.front()->packets.front()
+      .capture_time_ms_;
+  for (std::list<Stream*>::const_iterator it = active_streams_.begin();
+       it != active_streams_.end(); ++it) {
+    oldest_capture_time_ms = std::min(oldest_capture_time_ms,
+                                      (*it)->packets.front().capture_time_ms_);
+  }
+  return oldest_capture_time_ms;
+}
+
+PacedSender::PacketList::Stream* PacedSender::PacketList::GetStream(
+    uint32_t ssrc) {
+  const int mask = (1 << stream_index_bits_) - 1;
+  int slot = HomeSlot(ssrc);
+  for (; stream_index_[slot] != NULL; slot = (slot + 1) & mask) {
+    if (stream_index_[slot]->ssrc == ssrc) {
+      return stream_index_[slot];
+    }
+  }
+  if (2 * (num_streams_ + 1) > (1 << stream_index_bits_)) {
+    GrowStreamIndex();
+    return GetStream(ssrc);
+  }
+  Stream* stream = NULL;
+  if (free_streams_.empty()) {
+    stream = new Stream();
+  } else {
+    stream = free_streams_.back();
+    free_streams_.pop_back();
+  }
+  stream->ssrc = ssrc;
+  stream_index_[slot] = stream;
+  ++num_streams_;
+  return stream;
+}
+
+void PacedSender::PacketList::RemoveStream(Stream* stream) {
+  const int mask = (1 << stream_index_bits_) - 1;
+  int hole = HomeSlot(stream->ssrc);
+  while (stream_index_[hole] != stream) {
+    hole = (hole + 1) & mask;
+  }
+  // Move later entries of the same probe sequence back, which keeps the
+  // table free of tombstones.
+  for (int i = (hole + 1) & mask; stream_index_[i] != NULL;
+       i = (i + 1) & mask) {
+    const int home = HomeSlot(stream_index_[i]->ssrc);
+    // The entry can fill the hole if the hole lies between its home slot and
+    // the slot it is stored in.
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      stream_index_[hole] = stream_index_[i];
+      hole = i;
+    }
+  }
+  stream_index_[hole] = NULL;
+  --num_streams_;
+  if (free_streams_.size() < kMaxFreeStreams) {
+    free_streams_.push_back(stream);
+  } else {
+    delete stream;
+  }
+}
+
+int PacedSender::PacketList::HomeSlot(uint32_t ssrc) const {
+  // Fibonacci hashing, SSRCs are random but may be assigned consecutively in
+  // tests.
+  return static_cast<int>((ssrc * 2654435761u) >> (32 - stream_index_bits_));
+}
+
+void PacedSender::PacketList::GrowStreamIndex() {
+  std::vector<Stream*> old_index(2 << stream_index_bits_, NULL);
+  old_index.swap(stream_index_);
+  ++stream_index_bits_;
+  const int mask = (1 << stream_index_bits_) - 1;
+  for (size_t i = 0; i < old_index.size(); ++i) {
+    if (old_index[i] == NULL) {
+      continue;
+    }
+    int slot = HomeSlot(old_index[i]->ssrc);
+    while (stream_index_[slot] != NULL) {
+      slot = (slot + 1) & mask;
+    }
+    stream_index_[slot] = old_index[i];
+  }
+}
+
+void PacedSender::PacketList::SelectStream() {
+  while (active_streams_.front()->deficit_bytes <
+         active_streams_.front()->packets.front().bytes_) {
+    // Move the stream to the back and give the turn to the next stream.
+    active_streams_.splice(active_streams_.end(), active_streams_,
+                           active_streams_.begin());
+    active_streams_.front()->deficit_bytes += kStreamQuantumBytes;
   }
 }
 
@@ -68,7 +253,8 @@ PacedSender::PacedSender(Callback* callback, int target_bitrate_kbps,
       padding_bytes_remaining_interval_(0),
       time_last_update_(TickTime::Now()),
       capture_time_ms_last_queued_(0),
-      capture_time_ms_last_sent_(0) {
+      capture_time_ms_last_sent_(0),
+      queued_packets_last_logged_(0) {
   UpdateBytesPerInterval(kMinPacketLimitMs);
 }
 
@@ -171,22 +357,27 @@ bool PacedSender::SendPacket(Priority priority, uint32_t ssrc,
 
 int PacedSender::QueueInMs() const {
   CriticalSectionScoped cs(critsect_.get());
+  return QueueInMsInternal();
+}
+
+// MUST have critsect_ when calling.
+int PacedSender::QueueInMsInternal() const {
   int64_t now_ms = TickTime::MillisecondTimestamp();
   int64_t oldest_packet_capture_time = now_ms;
   if (!high_priority_packets_.empty()) {
     oldest_packet_capture_time = std::min(
         oldest_packet_capture_time,
-        high_priority_packets_.front().capture_time_ms_);
+        high_priority_packets_.OldestCaptureTimeMs());
   }
   if (!normal_priority_packets_.empty()) {
     oldest_packet_capture_time = std::min(
         oldest_packet_capture_time,
-        normal_priority_packets_.front().capture_time_ms_);
+        normal_priority_packets_.OldestCaptureTimeMs());
   }
   if (!low_priority_packets_.empty()) {
     oldest_packet_capture_time = std::min(
         oldest_packet_capture_time,
-        low_priority_packets_.front().capture_time_ms_);
+        low_priority_packets_.OldestCaptureTimeMs());
   }
   return now_ms - oldest_packet_capture_time;
 }
@@ -217,6 +408,10 @@ int32_t PacedSender::Process() {
     int64_t capture_time_ms;
     Priority priority;
     bool last_packet;
+    // Hand the packets to the callback in batches, to not have to leave and
+    // enter the critical section for every packet.
+    QueuedPacket packets[kMaxPacketsPerBatch];
+    int num_packets = 0;
     while (GetNextPacket(&ssrc, &sequence_number, &capture_time_ms,
                          &priority, &last_packet)) {
       if (priority == kNormalPriority) {
@@ -227,8 +422,19 @@ int32_t PacedSender::Process() {
           TRACE_EVENT_ASYNC_END0("webrtc_rtp", "PacedSend", capture_time_ms);
         }
       }
+      packets[num_packets].ssrc = ssrc;
+      packets[num_packets].sequence_number = sequence_number;
+      packets[num_packets].capture_time_ms = capture_time_ms;
+      if (++num_packets == kMaxPacketsPerBatch) {
+        critsect_->Leave();
+        callback_->TimeToSendPackets(packets, num_packets);
+        critsect_->Enter();
+        num_packets = 0;
+      }
+    }
+    if (num_packets > 0) {
       critsect_->Leave();
-      callback_->TimeToSendPacket(ssrc, sequence_number, capture_time_ms);
+      callback_->TimeToSendPackets(packets, num_packets);
       critsect_->Enter();
     }
     if (high_priority_packets_.empty() &&
@@ -242,9 +448,21 @@ int32_t PacedSender::Process() {
       bytes_remaining_interval_ -= padding_bytes_remaining_interval_;
     }
   }
+  LogQueueState();
   return 0;
 }
 
+// MUST have critsect_ when calling.
+void PacedSender::LogQueueState() {
+  const int queued_packets = high_priority_packets_.size() +
+      normal_priority_packets_.size() + low_priority_packets_.size();
+  if (queued_packets == 0 && queued_packets_last_logged_ == 0) {
+    return;
+  }
+  RtcEventLog::LogPacerState(queued_packets, QueueInMsInternal());
+  queued_packets_last_logged_ = queued_packets;
+}
+
 // MUST have critsect_ when calling.
 void PacedSender::UpdateBytesPerInterval(uint32_t delta_time_ms) {
   uint32_t bytes_per_interval = target_bitrate_kbytes_per_s_ * delta_time_ms;
@@ -313,14 +531,12 @@ bool PacedSender::GetNextPacket(uint32_t* ssrc, uint16_t* sequence_number,
 void PacedSender::GetNextPacketFromList(PacketList* list,
     uint32_t* ssrc, uint16_t* sequence_number, int64_t* capture_time_ms,
     bool* last_packet) {
-  Packet packet = list->front();
+  const Packet& packet = list->front();
   UpdateState(packet.bytes_);
   *sequence_number = packet.sequence_number_;
   *ssrc = packet.ssrc_;
   *capture_time_ms = packet.capture_time_ms_;
-  list->pop_front();
-  *last_packet = list->empty() ||
-      list->front().capture_time_ms_ > *capture_time_ms;
+  *last_packet = list->pop_front();
 }
 
 // MUST have critsect_ when calling.
@@ -8,6 +8,12 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -292,5 +298,217 @@ TEST_F(PacedSenderTest, Pause) {
   EXPECT_EQ(0, send_bucket_->QueueInMs());
 }
 
+TEST_F(PacedSenderTest, SameSequenceNumberOnDifferentSsrcs) {
+  uint32_t ssrc = 12345;
+  uint32_t other_ssrc = 12346;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+
+  send_bucket_->Pause();
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+      sequence_number, capture_time_ms, 250));
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority,
+      other_ssrc, sequence_number, capture_time_ms, 250));
+  // Only the duplicate on the same SSRC is dropped.
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority,
+      other_ssrc, sequence_number, capture_time_ms, 250));
+  send_bucket_->Resume();
+
+  EXPECT_CALL(callback_, TimeToSendPadding(_)).Times(testing::AnyNumber());
+  EXPECT_CALL(callback_,
+      TimeToSendPacket(ssrc, sequence_number, capture_time_ms)).Times(1);
+  EXPECT_CALL(callback_,
+      TimeToSendPacket(other_ssrc, sequence_number, capture_time_ms)).Times(1);
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket_->Process());
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket_->Process());
+}
+
+TEST_F(PacedSenderTest, RoundRobinBetweenSsrcs) {
+  uint32_t ssrc = 12345;
+  uint32_t other_ssrc = 12346;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+  const int kPacketsPerSsrc = 5;
+
+  // Queue a burst on one SSRC followed by a burst on another.
+  send_bucket_->Pause();
+  for (int i = 0; i < kPacketsPerSsrc; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number + i, capture_time_ms, 1500));
+  }
+  for (int i = 0; i < kPacketsPerSsrc; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority,
+        other_ssrc, sequence_number + i, capture_time_ms, 1500));
+  }
+  send_bucket_->Resume();
+
+  // Expect the two SSRCs to take turns.
+  EXPECT_CALL(callback_, TimeToSendPadding(_)).Times(0);
+  {
+    testing::InSequence sequence;
+    for (int i = 0; i < kPacketsPerSsrc; ++i) {
+      EXPECT_CALL(callback_,
+          TimeToSendPacket(ssrc, sequence_number + i, capture_time_ms));
+      EXPECT_CALL(callback_,
+          TimeToSendPacket(other_ssrc, sequence_number + i, capture_time_ms));
+    }
+  }
+  while (send_bucket_->QueueInMs() > 0) {
+    TickTime::AdvanceFakeClock(5);
+    EXPECT_EQ(0, send_bucket_->Process());
+  }
+}
+
+TEST_F(PacedSenderTest, ManySsrcsQueueAgainAfterDraining) {
+  uint32_t first_ssrc = 12345;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+  // Enough SSRCs to grow the index of queued streams a few times.
+  const int kNumSsrcs = 100;
+
+  EXPECT_CALL(callback_, TimeToSendPadding(_)).Times(testing::AnyNumber());
+  for (int round = 0; round < 2; ++round) {
+    send_bucket_->Pause();
+    for (int i = 0; i < kNumSsrcs; ++i) {
+      EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority,
+          first_ssrc + i, sequence_number, capture_time_ms, 10));
+    }
+    send_bucket_->Resume();
+
+    // The drained streams are removed, the same sequence numbers are not
+    // duplicates when they are queued again.
+    for (int i = 0; i < kNumSsrcs; ++i) {
+      EXPECT_CALL(callback_, TimeToSendPacket(first_ssrc + i, sequence_number,
+                                              capture_time_ms)).Times(1);
+    }
+    while (send_bucket_->QueueInMs() > 0) {
+      TickTime::AdvanceFakeClock(5);
+      EXPECT_EQ(0, send_bucket_->Process());
+    }
+    testing::Mock::VerifyAndClearExpectations(&callback_);
+    EXPECT_CALL(callback_, TimeToSendPadding(_)).Times(testing::AnyNumber());
+  }
+}
+
+class MockPacedSenderBatchCallback : public MockPacedSenderCallback {
+ public:
+  MOCK_METHOD2(TimeToSendPackets,
+      void(const PacedSender::QueuedPacket* packets, int num_packets));
+};
+
+TEST(PacedSenderBatchTest, SendsQueuedPacketsInBatches) {
+  TickTime::UseFakeClock(123456);
+  MockPacedSenderBatchCallback callback;
+  PacedSender send_bucket(&callback, 100000, kPaceMultiplier);
+  send_bucket.SetStatus(true);
+  uint32_t ssrc = 12345;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+
+  send_bucket.Pause();
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_FALSE(send_bucket.SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number + i, capture_time_ms, 250));
+  }
+  send_bucket.Resume();
+
+  EXPECT_CALL(callback, TimeToSendPacket(_, _, _)).Times(0);
+  EXPECT_CALL(callback, TimeToSendPadding(_)).Times(testing::AnyNumber());
+  EXPECT_CALL(callback, TimeToSendPackets(_, 32)).Times(1);
+  EXPECT_CALL(callback, TimeToSendPackets(_, 8)).Times(1);
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket.Process());
+  EXPECT_EQ(0, send_bucket.QueueInMs());
+}
+
+class PacedSenderBenchmarkCallback : public PacedSender::Callback {
+ public:
+  PacedSenderBenchmarkCallback(uint32_t first_ssrc, int num_streams)
+      : first_ssrc_(first_ssrc),
+        queue_time_ms_(num_streams, std::vector<int64_t>(1 << 16)),
+        delays_ms_(num_streams) {
+  }
+
+  virtual void TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                                int64_t capture_time_ms) {
+    Sent(ssrc - first_ssrc_, sequence_number);
+  }
+  virtual void TimeToSendPadding(int bytes) {}
+
+  void Queued(int stream, uint16_t sequence_number) {
+    queue_time_ms_[stream][sequence_number] = TickTime::MillisecondTimestamp();
+  }
+  void Sent(int stream, uint16_t sequence_number) {
+    delays_ms_[stream].push_back(TickTime::MillisecondTimestamp() -
+                                 queue_time_ms_[stream][sequence_number]);
+  }
+  std::vector<int>* delays_ms(int stream) { return &delays_ms_[stream]; }
+
+ private:
+  const uint32_t first_ssrc_;
+  std::vector<std::vector<int64_t> > queue_time_ms_;
+  std::vector<std::vector<int> > delays_ms_;
+};
+
+static int Percentile(const std::vector<int>& sorted, int percent) {
+  return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+// Sends three simulcast streams of 30 frames per second, with a total of 10000
+// packets per second, through the pacer and reports the time the packets of
+// each stream spend queued. The largest layer is packetized first.
+TEST(PacedSenderBenchmark, DISABLED_QueueingDelay) {
+  const uint32_t kFirstSsrc = 1000;
+  const int kNumStreams = 3;
+  const int kPacketsPerFrame[kNumStreams] = { 256, 64, 16 };
+  const int kPacketSize = 1200;
+  const int kDurationMs = 5000;
+  // 10080 packets per second of 1200 bytes.
+  const int kBitrateKbps = 30 * 336 * kPacketSize * 8 / 1000;
+  TickTime::UseFakeClock(123456);
+  PacedSenderBenchmarkCallback callback(kFirstSsrc, kNumStreams);
+  PacedSender send_bucket(&callback, kBitrateKbps, kPaceMultiplier);
+  send_bucket.SetStatus(true);
+  uint16_t sequence_numbers[kNumStreams] = { 0 };
+  int num_packets = 0;
+  const clock_t start = clock();
+  for (int time_ms = 0; time_ms < kDurationMs; ++time_ms) {
+    if (time_ms * 30 / 1000 != (time_ms + 1) * 30 / 1000) {
+      // Time for a new frame.
+      const int64_t capture_time_ms = TickTime::MillisecondTimestamp();
+      for (int stream = 0; stream < kNumStreams; ++stream) {
+        for (int i = 0; i < kPacketsPerFrame[stream]; ++i) {
+          const uint16_t sequence_number = sequence_numbers[stream]++;
+          callback.Queued(stream, sequence_number);
+          if (send_bucket.SendPacket(PacedSender::kNormalPriority,
+                                     kFirstSsrc + stream, sequence_number,
+                                     capture_time_ms, kPacketSize)) {
+            callback.Sent(stream, sequence_number);
+          }
+          ++num_packets;
+        }
+      }
+    }
+    if (send_bucket.TimeUntilNextProcess() == 0)
+      send_bucket.Process();
+    TickTime::AdvanceFakeClock(1);
+  }
+  const double elapsed_ns =
+      1e9 * static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+  printf("%d packets/s, %.0f ns/packet\n", num_packets * 1000 / kDurationMs,
+         elapsed_ns / num_packets);
+  for (int stream = 0; stream < kNumStreams; ++stream) {
+    std::vector<int>* delays = callback.delays_ms(stream);
+    ASSERT_FALSE(delays->empty());
+    std::sort(delays->begin(), delays->end());
+    printf("Stream with %3d packets/frame: queueing delay p50 %2d ms, "
+           "p90 %2d ms, p99 %2d ms, max %2d ms\n", kPacketsPerFrame[stream],
+           Percentile(*delays, 50), Percentile(*delays, 90),
+           Percentile(*delays, 99), delays->back());
+  }
+}
+
 }  // namespace test
 }  // namespace webrtc
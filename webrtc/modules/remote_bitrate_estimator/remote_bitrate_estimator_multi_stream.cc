@@ -13,6 +13,7 @@
 #include "webrtc/modules/remote_bitrate_estimator/include/rtp_to_ntp.h"
 #include "webrtc/modules/remote_bitrate_estimator/remote_bitrate_estimator_single_stream.h"
 #include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
@@ -152,12 +153,15 @@ void RemoteBitrateEstimatorMultiStream::UpdateEstimate(int64_t time_now) {
     remote_rate_.Reset();
     return;
   }
+  const uint32_t incoming_bitrate = incoming_bitrate_.BitRate(time_now);
   const RateControlInput input(overuse_detector_.State(),
-                               incoming_bitrate_.BitRate(time_now),
+                               incoming_bitrate,
                                overuse_detector_.NoiseVar());
   const RateControlRegion region = remote_rate_.Update(&input, time_now);
   unsigned int target_bitrate = remote_rate_.UpdateBandwidthEstimate(time_now);
   if (remote_rate_.ValidEstimate()) {
+    RtcEventLog::LogRemoteBitrateEstimate(target_bitrate, incoming_bitrate,
+                                          overuse_detector_.State());
     std::vector<unsigned int> ssrcs;
     GetSsrcs(&ssrcs);
     if (!ssrcs.empty()) {
@@ -11,6 +11,7 @@
 #include "webrtc/modules/remote_bitrate_estimator/remote_bitrate_estimator_single_stream.h"
 
 #include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
 
 namespace webrtc {
 
@@ -107,12 +108,15 @@ void RemoteBitrateEstimatorSingleStream::UpdateEstimate(int64_t time_now) {
   }
   double mean_noise_var = sum_noise_var /
       static_cast<double>(overuse_detectors_.size());
+  const uint32_t incoming_bitrate = incoming_bitrate_.BitRate(time_now);
   const RateControlInput input(bw_state,
-                               incoming_bitrate_.BitRate(time_now),
+                               incoming_bitrate,
                                mean_noise_var);
   const RateControlRegion region = remote_rate_.Update(&input, time_now);
   unsigned int target_bitrate = remote_rate_.UpdateBandwidthEstimate(time_now);
   if (remote_rate_.ValidEstimate()) {
+    RtcEventLog::LogRemoteBitrateEstimate(target_bitrate, incoming_bitrate,
+                                          bw_state);
     std::vector<unsigned int> ssrcs;
     GetSsrcs(&ssrcs);
     observer_->OnReceiveBitrateChanged(&ssrcs, target_bitrate);
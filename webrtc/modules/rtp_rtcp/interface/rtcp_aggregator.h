@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// RtcpAggregator merges the RTCP packets of the RTP/RTCP modules sharing one
+// transport into as few packets as possible. It is registered as the
+// transport of those modules, or set on video channels with
+// ViENetwork::SetRtcpAggregator(), wraps the real transport and is processed
+// by a ProcessThread. RTP packets are passed straight through.
+//
+// Receiver reports, SDES and REMB are held for up to kMaxHoldTimeMs. The
+// report blocks of all held receiver reports are sent in receiver reports of
+// the SSRC of the first of them, with the delay since last SR adjusted for the
+// time held, the SDES chunks in SDES packets of up to 31 chunks, and REMBs
+// with the same bitrate are merged into one. Any other RTCP,
+// e.g. sender reports, NACK or PLI, is sent right away together with
+// everything held, in packets of at most |max_packet_size| bytes which start
+// with a sender or receiver report. Only receiver reports are split between
+// packets, compound packets holding any other RTCP packet larger than
+// |max_packet_size| are sent as they are.
+//
+// Packets reaching the aggregator must be plain RTCP, i.e. RTCP encryption
+// has to be done by the wrapped transport.
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_INTERFACE_RTCP_AGGREGATOR_H_
+#define WEBRTC_MODULES_RTP_RTCP_INTERFACE_RTCP_AGGREGATOR_H_
+
+#include <vector>
+
+#include "webrtc/common_types.h"
+#include "webrtc/modules/interface/module.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class Clock;
+class CriticalSectionWrapper;
+
+class RtcpAggregator : public Transport, public Module {
+ public:
+  enum {
+    kMaxHoldTimeMs = 100,
+    // Ethernet MTU minus IPv4 and UDP headers.
+    kDefaultMaxPacketSize = 1472,
+    kMaxPacketSize = 1500
+  };
+
+  RtcpAggregator(Transport* transport, Clock* clock,
+                 int max_packet_size = kDefaultMaxPacketSize);
+  virtual ~RtcpAggregator();
+
+  // Sends everything held now.
+  void Flush();
+
+  // Number of RTCP packets and bytes passed to the transport.
+  void Statistics(uint32_t* packets_sent, uint32_t* bytes_sent) const;
+
+  // Implements Transport. An aggregated packet is sent on the |channel| of
+  // the first packet in it.
+  virtual int SendPacket(int channel, const void* data, int len);
+  virtual int SendRTCPPacket(int channel, const void* data, int len);
+  virtual int SendWritablePacket(int channel, void* data, int len,
+                                 int capacity);
+  virtual void SendWritablePackets(int channel, unsigned char* const* data,
+                                   const int* len, int capacity,
+                                   int* bytes_sent, int num_packets);
+
+  // Implements Module.
+  virtual int32_t TimeUntilNextProcess();
+  virtual int32_t Process();
+
+ private:
+  // A report block of a held receiver report.
+  struct HeldReportBlock {
+    uint32_t sender_ssrc;
+    int64_t time_ms;
+    uint8_t data[24];
+  };
+
+  // A chunk of a held SDES packet, as serialized.
+  struct HeldSdesChunk {
+    uint32_t ssrc;
+    std::vector<uint8_t> data;
+  };
+
+  struct HeldRemb {
+    uint32_t sender_ssrc;
+    // Exponent and mantissa, as serialized.
+    uint8_t bitrate[3];
+    std::vector<uint32_t> ssrcs;
+  };
+
+  // Adds the RTCP packets in |packet| to the held ones. Returns false if
+  // |packet| isn't a valid RTCP packet, or shouldn't be aggregated. Sets
+  // |urgent| if the packet needs to be sent right away.
+  bool Add(const uint8_t* packet, int length, bool* urgent);
+  // Holds the chunks of the SDES packet |packet|. Returns false, holding
+  // nothing, if it isn't a valid SDES packet.
+  bool AddSdes(const uint8_t* packet, int length);
+  void AddRemb(const uint8_t* packet, int length);
+  // Serializes and sends everything held. Called with |crit_sect_| held.
+  void FlushLocked();
+  // Sends the packet being built and starts a new one.
+  void SendBuffer();
+  // Makes room for |length| bytes in the packet being built, starting a new
+  // packet if needed. Unless |report| is set, that packet is led by an empty
+  // receiver report if there were reports.
+  void Reserve(int length, bool report);
+
+  Transport* transport_;
+  Clock* clock_;
+  const int max_packet_size_;
+  scoped_ptr<CriticalSectionWrapper> crit_sect_;
+
+  int channel_;
+  bool has_channel_;
+  // Time the oldest held packet was added, -1 if there is none.
+  int64_t hold_start_ms_;
+  // SSRC of the first report held, for leading packets which would
+  // otherwise start with feedback. Only valid if |has_report_|.
+  uint32_t report_ssrc_;
+  bool has_report_;
+
+  std::vector<uint8_t> sender_reports_;
+  std::vector<HeldReportBlock> report_blocks_;
+  std::vector<HeldSdesChunk> sdes_chunks_;
+  std::vector<HeldRemb> rembs_;
+  std::vector<uint8_t> feedback_;
+
+  // The packet being built by FlushLocked(). A single RTCP packet from a
+  // module may need an empty receiver report in front of it.
+  uint8_t buffer_[kMaxPacketSize + 8];
+  int buffer_length_;
+  bool buffer_has_report_;
+
+  uint32_t packets_sent_;
+  uint32_t bytes_sent_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_INTERFACE_RTCP_AGGREGATOR_H_
@@ -68,7 +68,8 @@ bool ForwardErrorCorrection::SortablePacket::LessThan(
 ForwardErrorCorrection::ForwardErrorCorrection(int32_t id)
     : _id(id),
       _generatedFecPackets(kMaxMediaPackets),
-      _fecPacketReceived(false) {
+      _fecPacketReceived(false),
+      xor_bytes_(internal::GetXorBytesFunction()) {
 }
 
 ForwardErrorCorrection::~ForwardErrorCorrection() {
@@ -226,73 +227,71 @@ void ForwardErrorCorrection::GenerateFecBitStrings(
       kUlpHeaderSizeLBitSet : kUlpHeaderSizeLBitClear;
   const uint16_t fecRtpOffset = kFecHeaderSize + ulpHeaderSize - kRtpHeaderSize;
 
-  for (int i = 0; i < numFecPackets; i++) {
-    PacketList::const_iterator mediaListIt = mediaPacketList.begin();
-    uint32_t pktMaskIdx = i * numMaskBytes;
-    uint32_t mediaPktIdx = 0;
-    uint16_t fecPacketLength = 0;
-    uint16_t prevSeqNum = ParseSequenceNumber((*mediaListIt)->data);
-    while (mediaListIt != mediaPacketList.end()) {
-      // Each FEC packet has a multiple byte mask.
-      if (packetMask[pktMaskIdx] & (1 << (7 - mediaPktIdx))) {
-        Packet* mediaPacket = *mediaListIt;
-
-        // Assign network-ordered media payload length.
-        ModuleRTPUtility::AssignUWord16ToBuffer(
-            mediaPayloadLength,
-            mediaPacket->length - kRtpHeaderSize);
-
-        fecPacketLength = mediaPacket->length + fecRtpOffset;
-        // On the first protected packet, we don't need to XOR.
-        if (_generatedFecPackets[i].length == 0) {
-          // Copy the first 2 bytes of the RTP header.
-          memcpy(_generatedFecPackets[i].data, mediaPacket->data, 2);
-          // Copy the 5th to 8th bytes of the RTP header.
-          memcpy(&_generatedFecPackets[i].data[4], &mediaPacket->data[4], 4);
-          // Copy network-ordered payload size.
-          memcpy(&_generatedFecPackets[i].data[8], mediaPayloadLength, 2);
-
-          // Copy RTP payload, leaving room for the ULP header.
-          memcpy(&_generatedFecPackets[i].data[kFecHeaderSize + ulpHeaderSize],
-                 &mediaPacket->data[kRtpHeaderSize],
-                 mediaPacket->length - kRtpHeaderSize);
-        } else {
-          // XOR with the first 2 bytes of the RTP header.
-          _generatedFecPackets[i].data[0] ^= mediaPacket->data[0];
-          _generatedFecPackets[i].data[1] ^= mediaPacket->data[1];
-
-          // XOR with the 5th to 8th bytes of the RTP header.
-          for (uint32_t j = 4; j < 8; j++) {
-            _generatedFecPackets[i].data[j] ^= mediaPacket->data[j];
-          }
-
-          // XOR with the network-ordered payload size.
-          _generatedFecPackets[i].data[8] ^= mediaPayloadLength[0];
-          _generatedFecPackets[i].data[9] ^= mediaPayloadLength[1];
-
-          // XOR with RTP payload, leaving room for the ULP header.
-          for (int32_t j = kFecHeaderSize + ulpHeaderSize;
-              j < fecPacketLength; j++) {
-            _generatedFecPackets[i].data[j] ^=
-                mediaPacket->data[j - fecRtpOffset];
-          }
-        }
-        if (fecPacketLength > _generatedFecPackets[i].length) {
-          _generatedFecPackets[i].length = fecPacketLength;
-        }
+  PacketList::const_iterator mediaListIt = mediaPacketList.begin();
+  uint32_t mediaPktIdx = 0;
+  uint16_t prevSeqNum = ParseSequenceNumber((*mediaListIt)->data);
+  while (mediaListIt != mediaPacketList.end()) {
+    Packet* mediaPacket = *mediaListIt;
+    // Each FEC packet has a multiple byte mask; this media packet is covered
+    // by the FEC packets that have bit |mediaPktIdx| set.
+    const uint32_t maskByteIdx = mediaPktIdx >> 3;
+    const uint8_t maskBit = 1 << (7 - (mediaPktIdx & 7));
+
+    // Assign network-ordered media payload length.
+    ModuleRTPUtility::AssignUWord16ToBuffer(
+        mediaPayloadLength,
+        mediaPacket->length - kRtpHeaderSize);
+    const uint16_t fecPacketLength = mediaPacket->length + fecRtpOffset;
+
+    for (int i = 0; i < numFecPackets; i++) {
+      if (!(packetMask[i * numMaskBytes + maskByteIdx] & maskBit)) {
+        continue;
       }
-      mediaListIt++;
-      if (mediaListIt != mediaPacketList.end()) {
-        uint16_t seqNum = ParseSequenceNumber((*mediaListIt)->data);
-        mediaPktIdx += static_cast<uint16_t>(seqNum - prevSeqNum);
-        prevSeqNum = seqNum;
+      Packet* fecPacket = &_generatedFecPackets[i];
+      // On the first protected packet, we don't need to XOR.
+      if (fecPacket->length == 0) {
+        // Copy the first 2 bytes of the RTP header.
+        memcpy(fecPacket->data, mediaPacket->data, 2);
+        // Copy the 5th to 8th bytes of the RTP header.
+        memcpy(&fecPacket->data[4], &mediaPacket->data[4], 4);
+        // Copy network-ordered payload size.
+        memcpy(&fecPacket->data[8], mediaPayloadLength, 2);
+
+        // Copy RTP payload, leaving room for the ULP header.
+        memcpy(&fecPacket->data[kFecHeaderSize + ulpHeaderSize],
+               &mediaPacket->data[kRtpHeaderSize],
+               mediaPacket->length - kRtpHeaderSize);
+      } else {
+        // XOR with the first 2 bytes of the RTP header.
+        fecPacket->data[0] ^= mediaPacket->data[0];
+        fecPacket->data[1] ^= mediaPacket->data[1];
+
+        // XOR with the 5th to 8th bytes of the RTP header.
+        for (uint32_t j = 4; j < 8; j++) {
+          fecPacket->data[j] ^= mediaPacket->data[j];
+        }
+
+        // XOR with the network-ordered payload size.
+        fecPacket->data[8] ^= mediaPayloadLength[0];
+        fecPacket->data[9] ^= mediaPayloadLength[1];
+
+        // XOR with RTP payload, leaving room for the ULP header.
+        xor_bytes_(&mediaPacket->data[kRtpHeaderSize],
+                   &fecPacket->data[kFecHeaderSize + ulpHeaderSize],
+                   mediaPacket->length - kRtpHeaderSize);
       }
-      if (mediaPktIdx == 8) {
-        // Switch to the next mask byte.
-        mediaPktIdx = 0;
-        pktMaskIdx++;
+      if (fecPacketLength > fecPacket->length) {
+        fecPacket->length = fecPacketLength;
       }
     }
+    mediaListIt++;
+    if (mediaListIt != mediaPacketList.end()) {
+      uint16_t seqNum = ParseSequenceNumber((*mediaListIt)->data);
+      mediaPktIdx += static_cast<uint16_t>(seqNum - prevSeqNum);
+      prevSeqNum = seqNum;
+    }
+  }
+  for (int i = 0; i < numFecPackets; i++) {
     assert(_generatedFecPackets[i].length);
     //Note: This shouldn't happen: means packet mask is wrong or poorly designed
   }
@@ -699,9 +698,9 @@ void ForwardErrorCorrection::XorPackets(const Packet* src_packet,
 
   // XOR with RTP payload.
   // TODO(marpan/ajm): Are we doing more XORs than required here?
-  for (int32_t i = kRtpHeaderSize; i < src_packet->length; i++) {
-    dst_packet->pkt->data[i] ^= src_packet->data[i];
-  }
+  xor_bytes_(&src_packet->data[kRtpHeaderSize],
+             &dst_packet->pkt->data[kRtpHeaderSize],
+             src_packet->length - kRtpHeaderSize);
 }
 
 void ForwardErrorCorrection::RecoverPacket(
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
 #include "system_wrappers/interface/ref_count.h"
 #include "system_wrappers/interface/scoped_refptr.h"
 #include "typedefs.h"
@@ -267,6 +268,9 @@ class ForwardErrorCorrection {
                          int new_bit_index,
                          int old_bit_index);
 
+  // Generates the FEC payloads from the media packets. The media packets are
+  // traversed in the outer loop so that each one is read once for all the FEC
+  // packets whose mask covers it.
   void GenerateFecBitStrings(const PacketList& mediaPacketList,
                              uint8_t* packetMask,
                              int numFecPackets,
@@ -310,8 +314,7 @@ class ForwardErrorCorrection {
 
   // Performs XOR between |src_packet| and |dst_packet| and stores the result
   // in |dst_packet|.
-  static void XorPackets(const Packet* src_packet,
-                         RecoveredPacket* dst_packet);
+  void XorPackets(const Packet* src_packet, RecoveredPacket* dst_packet);
 
   // Finish up the recovery of a packet.
   static  void FinishRecovery(RecoveredPacket* recovered);
@@ -334,6 +337,8 @@ class ForwardErrorCorrection {
   std::vector<Packet> _generatedFecPackets;
   FecPacketList _fecPacketList;
   bool _fecPacketReceived;
+  // XOR kernel selected for the CPU at construction.
+  internal::XorBytesFunction xor_bytes_;
 };
 } // namespace webrtc
 #endif // WEBRTC_MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_H_
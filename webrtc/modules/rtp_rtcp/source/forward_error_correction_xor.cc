@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+#include <cstring>
+
+#include "system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+namespace internal {
+
+void XorBytes_C(const uint8_t* src, uint8_t* dst, int length) {
+  int i = 0;
+  // memcpy() compiles to plain word loads and stores, and keeps unaligned
+  // access legal on all architectures.
+  for (; i + static_cast<int>(sizeof(uint64_t)) <= length;
+       i += sizeof(uint64_t)) {
+    uint64_t s;
+    uint64_t d;
+    memcpy(&s, src + i, sizeof(s));
+    memcpy(&d, dst + i, sizeof(d));
+    d ^= s;
+    memcpy(dst + i, &d, sizeof(d));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+XorBytesFunction GetXorBytesFunction() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    return XorBytes_AVX2;
+  }
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    return XorBytes_SSE2;
+  }
+  return XorBytes_C;
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+  return XorBytes_NEON;
+#elif defined(WEBRTC_ARCH_ARM_V7)
+  // NEON CPU detection required.
+  return (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) ?
+      XorBytes_NEON : XorBytes_C;
+#else
+  return XorBytes_C;
+#endif
+}
+
+}  // namespace internal
+}  // namespace webrtc
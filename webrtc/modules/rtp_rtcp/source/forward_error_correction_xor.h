@@ -0,0 +1,39 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_XOR_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_XOR_H_
+
+#include "typedefs.h"
+
+namespace webrtc {
+namespace internal {
+
+// XORs |length| bytes of |src| into |dst|. The buffers may have any
+// alignment but must not overlap.
+typedef void (*XorBytesFunction)(const uint8_t* src, uint8_t* dst, int length);
+
+// Portable version working on machine words.
+void XorBytes_C(const uint8_t* src, uint8_t* dst, int length);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void XorBytes_SSE2(const uint8_t* src, uint8_t* dst, int length);
+void XorBytes_AVX2(const uint8_t* src, uint8_t* dst, int length);
+#elif defined(WEBRTC_ARCH_ARM_V7)
+void XorBytes_NEON(const uint8_t* src, uint8_t* dst, int length);
+#endif
+
+// Returns the fastest implementation supported by the CPU.
+XorBytesFunction GetXorBytesFunction();
+
+}  // namespace internal
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_XOR_H_
@@ -0,0 +1,32 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+#include <immintrin.h>
+
+namespace webrtc {
+namespace internal {
+
+void XorBytes_AVX2(const uint8_t* src, uint8_t* dst, int length) {
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i*>(dst + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_xor_si256(d, s));
+  }
+  // Avoid the AVX-SSE transition penalty in the SSE2 code that follows.
+  _mm256_zeroupper();
+  XorBytes_SSE2(src + i, dst + i, length - i);
+}
+
+}  // namespace internal
+}  // namespace webrtc
@@ -0,0 +1,29 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+namespace internal {
+
+void XorBytes_NEON(const uint8_t* src, uint8_t* dst, int length) {
+  int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    uint8x16_t s = vld1q_u8(src + i);
+    uint8x16_t d = vld1q_u8(dst + i);
+    vst1q_u8(dst + i, veorq_u8(d, s));
+  }
+  XorBytes_C(src + i, dst + i, length - i);
+}
+
+}  // namespace internal
+}  // namespace webrtc
@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+namespace internal {
+
+void XorBytes_SSE2(const uint8_t* src, uint8_t* dst, int length) {
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i s1 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    __m128i d0 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+    __m128i d1 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i + 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_xor_si128(d0, s0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16),
+                     _mm_xor_si128(d1, s1));
+  }
+  for (; i + 16 <= length; i += 16) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, s));
+  }
+  XorBytes_C(src + i, dst + i, length - i);
+}
+
+}  // namespace internal
+}  // namespace webrtc
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/forward_error_correction_xor.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "modules/rtp_rtcp/source/rtp_utility.h"
+#include "system_wrappers/interface/cpu_features_wrapper.h"
+#include "system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace internal {
+namespace {
+
+const int kMaxLength = IP_PACKET_SIZE;
+
+struct XorKernel {
+  const char* name;
+  XorBytesFunction function;
+};
+
+// Returns the kernels that can run on this CPU, the C version first.
+std::vector<XorKernel> SupportedKernels() {
+  std::vector<XorKernel> kernels;
+  XorKernel c = { "XorBytes_C", XorBytes_C };
+  kernels.push_back(c);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    XorKernel sse2 = { "XorBytes_SSE2", XorBytes_SSE2 };
+    kernels.push_back(sse2);
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    XorKernel avx2 = { "XorBytes_AVX2", XorBytes_AVX2 };
+    kernels.push_back(avx2);
+  }
+#elif defined(WEBRTC_ARCH_ARM_V7)
+  if (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) {
+    XorKernel neon = { "XorBytes_NEON", XorBytes_NEON };
+    kernels.push_back(neon);
+  }
+#endif
+  return kernels;
+}
+
+void FillRandom(uint8_t* data, int length) {
+  for (int i = 0; i < length; ++i) {
+    data[i] = static_cast<uint8_t>(rand());
+  }
+}
+
+}  // namespace
+
+// Verifies every kernel against a byte-wise XOR for all lengths up to an MTU
+// and for misaligned source and destination buffers.
+TEST(ForwardErrorCorrectionXorTest, KernelsMatchByteWiseXor) {
+  uint8_t src[kMaxLength + 32];
+  uint8_t dst[kMaxLength + 32];
+  uint8_t expected[kMaxLength + 32];
+  const std::vector<XorKernel> kernels = SupportedKernels();
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    for (int offset = 0; offset < 4; ++offset) {
+      for (int length = 0; length <= kMaxLength; ++length) {
+        FillRandom(src, sizeof(src));
+        FillRandom(dst, sizeof(dst));
+        memcpy(expected, dst, sizeof(dst));
+        for (int i = 0; i < length; ++i) {
+          expected[i + 2 * offset] ^= src[i + offset];
+        }
+        kernels[k].function(&src[offset], &dst[2 * offset], length);
+        ASSERT_EQ(0, memcmp(expected, dst, sizeof(dst)))
+            << kernels[k].name << " length " << length << " offset " << offset;
+      }
+    }
+  }
+}
+
+// Benchmark for the XOR kernels on MTU sized payloads.
+TEST(ForwardErrorCorrectionXorTest, DISABLED_KernelBenchmark) {
+  const int kIterations = 200000;
+  const int kLength = 1200;
+  uint8_t src[kLength];
+  uint8_t dst[kLength];
+  FillRandom(src, kLength);
+  FillRandom(dst, kLength);
+
+  const std::vector<XorKernel> kernels = SupportedKernels();
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      kernels[k].function(src, dst, kLength);
+    }
+    double elapsed_us = (TickTime::Now() - start).Microseconds();
+    printf("%s: %.0f MB/s\n", kernels[k].name,
+           static_cast<double>(kIterations) * kLength / elapsed_us);
+  }
+}
+
+// Benchmark for ForwardErrorCorrection::GenerateFEC() with the random and
+// bursty mask tables, reporting media bytes protected per second.
+TEST(ForwardErrorCorrectionXorTest, DISABLED_GenerateFecBenchmark) {
+  const int kIterations = 2000;
+  const int kPacketLength = 1200;
+  const int kNumMediaPackets[] = { 4, 12, 24, 48 };
+  const uint8_t kProtectionFactors[] = { 26, 128, 255 };
+  const FecMaskType kMaskTypes[] = { kFecMaskRandom, kFecMaskBursty };
+  const char* kMaskTypeNames[] = { "random", "bursty" };
+
+  ForwardErrorCorrection fec(0);
+  for (size_t m = 0; m < sizeof(kMaskTypes) / sizeof(kMaskTypes[0]); ++m) {
+    for (size_t n = 0;
+         n < sizeof(kNumMediaPackets) / sizeof(kNumMediaPackets[0]); ++n) {
+      ForwardErrorCorrection::PacketList media_packets;
+      for (int i = 0; i < kNumMediaPackets[n]; ++i) {
+        ForwardErrorCorrection::Packet* packet =
+            new ForwardErrorCorrection::Packet;
+        packet->length = kPacketLength;
+        FillRandom(packet->data, kPacketLength);
+        packet->data[0] = 0x80;  // Version 2.
+        ModuleRTPUtility::AssignUWord16ToBuffer(&packet->data[2], i);
+        media_packets.push_back(packet);
+      }
+      for (size_t p = 0;
+           p < sizeof(kProtectionFactors) / sizeof(kProtectionFactors[0]);
+           ++p) {
+        TickTime start = TickTime::Now();
+        for (int i = 0; i < kIterations; ++i) {
+          ForwardErrorCorrection::PacketList fec_packets;
+          ASSERT_EQ(0, fec.GenerateFEC(media_packets, kProtectionFactors[p],
+                                       0, false, kMaskTypes[m],
+                                       &fec_packets));
+        }
+        double elapsed_us = (TickTime::Now() - start).Microseconds();
+        printf("GenerateFEC %s mask, %d media packets, protection %d: "
+               "%.0f MB/s\n", kMaskTypeNames[m], kNumMediaPackets[n],
+               kProtectionFactors[p],
+               static_cast<double>(kIterations) * kNumMediaPackets[n] *
+                   kPacketLength / elapsed_us);
+      }
+      while (!media_packets.empty()) {
+        delete media_packets.front();
+        media_packets.pop_front();
+      }
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace webrtc
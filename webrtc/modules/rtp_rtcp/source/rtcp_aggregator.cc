@@ -0,0 +1,467 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/interface/rtcp_aggregator.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+
+namespace webrtc {
+
+namespace {
+
+const uint8_t kSenderReportType = 200;
+const uint8_t kReceiverReportType = 201;
+const uint8_t kSdesType = 202;
+const uint8_t kByeType = 203;
+const uint8_t kPsfbType = 206;
+const uint8_t kIjType = 195;
+const uint8_t kRembFmt = 15;
+const int kReportBlockLength = 24;
+const int kMaxReportBlocks = 31;
+const int kMaxSdesChunks = 31;
+const int kRembHeaderLength = 20;
+const int kMaxRembSsrcs = 255;
+
+// Length of the RTCP packet starting at |packet|, as given by its header.
+int RtcpPacketLength(const uint8_t* packet) {
+  return 4 * (ModuleRTPUtility::BufferToUWord16(packet + 2) + 1);
+}
+
+// Length of the SDES chunk starting at |chunk|, including the null item
+// ending it and the padding to a 32-bit boundary, or -1 if the chunk doesn't
+// fit in |max_length| bytes.
+int SdesChunkLength(const uint8_t* chunk, int max_length) {
+  int pos = 4;
+  while (pos < max_length && chunk[pos] != 0) {
+    if (max_length - pos < 2) {
+      return -1;
+    }
+    pos += 2 + chunk[pos + 1];
+  }
+  if (pos >= max_length) {
+    return -1;
+  }
+  pos = (pos + 4) & ~3;
+  return pos <= max_length ? pos : -1;
+}
+
+}  // namespace
+
+RtcpAggregator::RtcpAggregator(Transport* transport, Clock* clock,
+                               int max_packet_size)
+    : transport_(transport),
+      clock_(clock),
+      max_packet_size_(std::min(static_cast<int>(kMaxPacketSize),
+                                max_packet_size)),
+      crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      channel_(0),
+      has_channel_(false),
+      hold_start_ms_(-1),
+      report_ssrc_(0),
+      has_report_(false),
+      buffer_length_(0),
+      buffer_has_report_(false),
+      packets_sent_(0),
+      bytes_sent_(0) {
+}
+
+RtcpAggregator::~RtcpAggregator() {
+}
+
+void RtcpAggregator::Flush() {
+  CriticalSectionScoped cs(crit_sect_.get());
+  FlushLocked();
+}
+
+void RtcpAggregator::Statistics(uint32_t* packets_sent,
+                                uint32_t* bytes_sent) const {
+  CriticalSectionScoped cs(crit_sect_.get());
+  *packets_sent = packets_sent_;
+  *bytes_sent = bytes_sent_;
+}
+
+int RtcpAggregator::SendPacket(int channel, const void* data, int len) {
+  return transport_->SendPacket(channel, data, len);
+}
+
+int RtcpAggregator::SendWritablePacket(int channel, void* data, int len,
+                                       int capacity) {
+  return transport_->SendWritablePacket(channel, data, len, capacity);
+}
+
+void RtcpAggregator::SendWritablePackets(int channel,
+                                         unsigned char* const* data,
+                                         const int* len, int capacity,
+                                         int* bytes_sent, int num_packets) {
+  transport_->SendWritablePackets(channel, data, len, capacity, bytes_sent,
+                                  num_packets);
+}
+
+int RtcpAggregator::SendRTCPPacket(int channel, const void* data, int len) {
+  CriticalSectionScoped cs(crit_sect_.get());
+  bool urgent = false;
+  if (!Add(static_cast<const uint8_t*>(data), len, &urgent)) {
+    // Keep the order of the packets.
+    FlushLocked();
+    const int sent = transport_->SendRTCPPacket(channel, data, len);
+    if (sent > 0) {
+      ++packets_sent_;
+      bytes_sent_ += len;
+    }
+    return sent;
+  }
+  if (!has_channel_) {
+    channel_ = channel;
+    has_channel_ = true;
+  }
+  if (urgent) {
+    FlushLocked();
+  }
+  return len;
+}
+
+int32_t RtcpAggregator::TimeUntilNextProcess() {
+  CriticalSectionScoped cs(crit_sect_.get());
+  if (hold_start_ms_ < 0) {
+    return kMaxHoldTimeMs;
+  }
+  return static_cast<int32_t>(std::max<int64_t>(
+      hold_start_ms_ + kMaxHoldTimeMs - clock_->TimeInMilliseconds(), 0));
+}
+
+int32_t RtcpAggregator::Process() {
+  CriticalSectionScoped cs(crit_sect_.get());
+  if (hold_start_ms_ >= 0 &&
+      clock_->TimeInMilliseconds() >= hold_start_ms_ + kMaxHoldTimeMs) {
+    FlushLocked();
+  }
+  return 0;
+}
+
+bool RtcpAggregator::Add(const uint8_t* packet, int length, bool* urgent) {
+  // Validate the whole packet before holding any of it.
+  if (length < 4) {
+    return false;
+  }
+  for (int pos = 0; pos < length; pos += RtcpPacketLength(&packet[pos])) {
+    if (length - pos < 4 || (packet[pos] >> 6) != 2 ||
+        RtcpPacketLength(&packet[pos]) > length - pos) {
+      return false;
+    }
+    // An IJ report must follow the receiver report it belongs to and BYE
+    // ends the stream, so leave those packets as they are.
+    if (packet[pos + 1] == kIjType || packet[pos + 1] == kByeType) {
+      return false;
+    }
+    // Only receiver reports are split between packets, anything else has to
+    // fit in one.
+    const int rtcp_length = RtcpPacketLength(&packet[pos]);
+    if (rtcp_length > max_packet_size_ &&
+        (packet[pos + 1] != kReceiverReportType ||
+         rtcp_length != 8 + (packet[pos] & 0x1f) * kReportBlockLength)) {
+      return false;
+    }
+  }
+
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  for (int pos = 0; pos < length; pos += RtcpPacketLength(&packet[pos])) {
+    const uint8_t* rtcp = &packet[pos];
+    const int rtcp_length = RtcpPacketLength(rtcp);
+    const uint8_t packet_type = rtcp[1];
+    const int count = rtcp[0] & 0x1f;
+    if ((packet_type == kSenderReportType ||
+         packet_type == kReceiverReportType) && rtcp_length >= 8) {
+      const uint32_t sender_ssrc =
+          ModuleRTPUtility::BufferToUWord32(&rtcp[4]);
+      if (!has_report_) {
+        report_ssrc_ = sender_ssrc;
+        has_report_ = true;
+      }
+      if (packet_type == kReceiverReportType &&
+          rtcp_length == 8 + count * kReportBlockLength) {
+        for (int i = 0; i < count; ++i) {
+          HeldReportBlock block;
+          block.sender_ssrc = sender_ssrc;
+          block.time_ms = now_ms;
+          memcpy(block.data, &rtcp[8 + i * kReportBlockLength],
+                 kReportBlockLength);
+          report_blocks_.push_back(block);
+        }
+      } else {
+        // Sender reports, and receiver reports with profile extensions, are
+        // time critical and sent as they are.
+        sender_reports_.insert(sender_reports_.end(), rtcp,
+                               rtcp + rtcp_length);
+        *urgent = true;
+      }
+    } else if (packet_type == kPsfbType && count == kRembFmt &&
+               rtcp_length >= kRembHeaderLength &&
+               memcmp(&rtcp[12], "REMB", 4) == 0 &&
+               rtcp_length >= kRembHeaderLength + 4 * rtcp[16]) {
+      AddRemb(rtcp, rtcp_length);
+    } else if (packet_type != kSdesType || !AddSdes(rtcp, rtcp_length)) {
+      feedback_.insert(feedback_.end(), rtcp, rtcp + rtcp_length);
+      *urgent = true;
+    }
+  }
+  if (hold_start_ms_ < 0) {
+    hold_start_ms_ = now_ms;
+  }
+
+  // Send as soon as there is a full packet.
+  int held_length = static_cast<int>(sender_reports_.size() +
+                                     feedback_.size()) +
+      static_cast<int>(report_blocks_.size()) * kReportBlockLength;
+  for (size_t i = 0; i < sdes_chunks_.size(); ++i) {
+    held_length += static_cast<int>(sdes_chunks_[i].data.size());
+  }
+  for (size_t i = 0; i < rembs_.size(); ++i) {
+    held_length += kRembHeaderLength +
+        4 * static_cast<int>(rembs_[i].ssrcs.size());
+  }
+  if (held_length >= max_packet_size_) {
+    *urgent = true;
+  }
+  return true;
+}
+
+bool RtcpAggregator::AddSdes(const uint8_t* packet, int length) {
+  const int count = packet[0] & 0x1f;
+  std::vector<HeldSdesChunk> chunks(count);
+  int pos = 4;
+  for (int i = 0; i < count; ++i) {
+    const int chunk_length = SdesChunkLength(&packet[pos], length - pos);
+    if (chunk_length < 0) {
+      return false;
+    }
+    chunks[i].ssrc = ModuleRTPUtility::BufferToUWord32(&packet[pos]);
+    chunks[i].data.assign(&packet[pos], &packet[pos + chunk_length]);
+    pos += chunk_length;
+  }
+
+  // A new chunk replaces any held one for the same SSRC.
+  for (int i = 0; i < count; ++i) {
+    std::vector<HeldSdesChunk>::iterator it = sdes_chunks_.begin();
+    while (it != sdes_chunks_.end() && it->ssrc != chunks[i].ssrc) {
+      ++it;
+    }
+    if (it != sdes_chunks_.end()) {
+      it->data.swap(chunks[i].data);
+    } else {
+      sdes_chunks_.push_back(chunks[i]);
+    }
+  }
+  return true;
+}
+
+void RtcpAggregator::AddRemb(const uint8_t* packet, int length) {
+  HeldRemb remb;
+  remb.sender_ssrc = ModuleRTPUtility::BufferToUWord32(&packet[4]);
+  memcpy(remb.bitrate, &packet[17], sizeof(remb.bitrate));
+  const int num_ssrcs = packet[16];
+  for (int i = 0; i < num_ssrcs; ++i) {
+    remb.ssrcs.push_back(ModuleRTPUtility::BufferToUWord32(
+        &packet[kRembHeaderLength + 4 * i]));
+  }
+
+  // The new estimate replaces any held one for the same SSRCs.
+  std::vector<HeldRemb>::iterator it = rembs_.begin();
+  while (it != rembs_.end()) {
+    std::vector<uint32_t>::iterator ssrc = it->ssrcs.begin();
+    while (ssrc != it->ssrcs.end()) {
+      if (std::find(remb.ssrcs.begin(), remb.ssrcs.end(), *ssrc) !=
+          remb.ssrcs.end()) {
+        ssrc = it->ssrcs.erase(ssrc);
+      } else {
+        ++ssrc;
+      }
+    }
+    if (it->ssrcs.empty()) {
+      it = rembs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (it = rembs_.begin(); it != rembs_.end(); ++it) {
+    if (memcmp(it->bitrate, remb.bitrate, sizeof(remb.bitrate)) == 0 &&
+        it->ssrcs.size() + remb.ssrcs.size() <=
+            static_cast<size_t>(kMaxRembSsrcs)) {
+      it->ssrcs.insert(it->ssrcs.end(), remb.ssrcs.begin(), remb.ssrcs.end());
+      return;
+    }
+  }
+  rembs_.push_back(remb);
+}
+
+void RtcpAggregator::FlushLocked() {
+  if (hold_start_ms_ < 0) {
+    return;
+  }
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  const uint32_t packets_sent = packets_sent_;
+  buffer_length_ = 0;
+  buffer_has_report_ = false;
+
+  for (size_t pos = 0; pos < sender_reports_.size();) {
+    const int length = RtcpPacketLength(&sender_reports_[pos]);
+    Reserve(length, true);
+    memcpy(&buffer_[buffer_length_], &sender_reports_[pos], length);
+    buffer_length_ += length;
+    buffer_has_report_ = true;
+    pos += length;
+  }
+
+  // The report blocks are copied as serialized, only the delay since last SR
+  // is updated.
+  int report_start = -1;
+  for (size_t i = 0; i < report_blocks_.size(); ++i) {
+    const HeldReportBlock& block = report_blocks_[i];
+    if (report_start >= 0 &&
+        ((buffer_[report_start] & 0x1f) == kMaxReportBlocks ||
+         buffer_length_ + kReportBlockLength > max_packet_size_)) {
+      report_start = -1;
+    }
+    if (report_start < 0) {
+      Reserve(8 + kReportBlockLength, true);
+      report_start = buffer_length_;
+      buffer_[buffer_length_++] = 0x80;
+      buffer_[buffer_length_++] = kReceiverReportType;
+      buffer_length_ += 2;
+      ModuleRTPUtility::AssignUWord32ToBuffer(&buffer_[buffer_length_],
+                                              block.sender_ssrc);
+      buffer_length_ += 4;
+      buffer_has_report_ = true;
+    }
+    uint8_t* data = &buffer_[buffer_length_];
+    memcpy(data, block.data, kReportBlockLength);
+    if (ModuleRTPUtility::BufferToUWord32(&data[16]) != 0) {
+      // In units of 1/65536 seconds.
+      const uint32_t held = static_cast<uint32_t>(
+          ((now_ms - block.time_ms) << 16) / 1000);
+      ModuleRTPUtility::AssignUWord32ToBuffer(
+          &data[20], ModuleRTPUtility::BufferToUWord32(&data[20]) + held);
+    }
+    buffer_length_ += kReportBlockLength;
+    ++buffer_[report_start];
+    ModuleRTPUtility::AssignUWord16ToBuffer(
+        &buffer_[report_start + 2],
+        static_cast<uint16_t>((buffer_length_ - report_start) / 4 - 1));
+  }
+
+  int sdes_start = -1;
+  for (size_t i = 0; i < sdes_chunks_.size(); ++i) {
+    const std::vector<uint8_t>& chunk = sdes_chunks_[i].data;
+    const int length = static_cast<int>(chunk.size());
+    if (sdes_start >= 0 &&
+        ((buffer_[sdes_start] & 0x1f) == kMaxSdesChunks ||
+         buffer_length_ + length > max_packet_size_)) {
+      sdes_start = -1;
+    }
+    if (sdes_start < 0) {
+      Reserve(4 + length, false);
+      sdes_start = buffer_length_;
+      buffer_[buffer_length_++] = 0x80;
+      buffer_[buffer_length_++] = kSdesType;
+      buffer_length_ += 2;
+    }
+    memcpy(&buffer_[buffer_length_], &chunk[0], length);
+    buffer_length_ += length;
+    ++buffer_[sdes_start];
+    ModuleRTPUtility::AssignUWord16ToBuffer(
+        &buffer_[sdes_start + 2],
+        static_cast<uint16_t>((buffer_length_ - sdes_start) / 4 - 1));
+  }
+
+  for (size_t i = 0; i < rembs_.size(); ++i) {
+    const HeldRemb& remb = rembs_[i];
+    const int num_ssrcs = static_cast<int>(remb.ssrcs.size());
+    const int length = kRembHeaderLength + 4 * num_ssrcs;
+    Reserve(length, false);
+    uint8_t* data = &buffer_[buffer_length_];
+    data[0] = 0x80 + kRembFmt;
+    data[1] = kPsfbType;
+    ModuleRTPUtility::AssignUWord16ToBuffer(
+        &data[2], static_cast<uint16_t>(length / 4 - 1));
+    ModuleRTPUtility::AssignUWord32ToBuffer(&data[4], remb.sender_ssrc);
+    ModuleRTPUtility::AssignUWord32ToBuffer(&data[8], 0);
+    memcpy(&data[12], "REMB", 4);
+    data[16] = static_cast<uint8_t>(num_ssrcs);
+    memcpy(&data[17], remb.bitrate, sizeof(remb.bitrate));
+    for (int j = 0; j < num_ssrcs; ++j) {
+      ModuleRTPUtility::AssignUWord32ToBuffer(
+          &data[kRembHeaderLength + 4 * j], remb.ssrcs[j]);
+    }
+    buffer_length_ += length;
+  }
+
+  for (size_t pos = 0; pos < feedback_.size();) {
+    const int length = RtcpPacketLength(&feedback_[pos]);
+    Reserve(length, false);
+    memcpy(&buffer_[buffer_length_], &feedback_[pos], length);
+    buffer_length_ += length;
+    pos += length;
+  }
+
+  if (buffer_length_ == 0 && packets_sent == packets_sent_ && has_report_) {
+    // Only receiver reports without report blocks were held.
+    Reserve(0, false);
+  }
+  SendBuffer();
+
+  sender_reports_.clear();
+  report_blocks_.clear();
+  sdes_chunks_.clear();
+  rembs_.clear();
+  feedback_.clear();
+  hold_start_ms_ = -1;
+  has_report_ = false;
+  has_channel_ = false;
+}
+
+void RtcpAggregator::Reserve(int length, bool report) {
+  const bool lead = !report && has_report_;
+  if (buffer_length_ > 0 &&
+      buffer_length_ + length + (lead && !buffer_has_report_ ? 8 : 0) >
+          max_packet_size_) {
+    SendBuffer();
+  }
+  if (lead && !buffer_has_report_) {
+    // Start the packet with an empty receiver report, to keep it a valid
+    // compound packet.
+    buffer_[buffer_length_++] = 0x80;
+    buffer_[buffer_length_++] = kReceiverReportType;
+    ModuleRTPUtility::AssignUWord16ToBuffer(&buffer_[buffer_length_], 1);
+    buffer_length_ += 2;
+    ModuleRTPUtility::AssignUWord32ToBuffer(&buffer_[buffer_length_],
+                                            report_ssrc_);
+    buffer_length_ += 4;
+    buffer_has_report_ = true;
+  }
+}
+
+void RtcpAggregator::SendBuffer() {
+  if (buffer_length_ == 0) {
+    return;
+  }
+  if (transport_->SendRTCPPacket(channel_, buffer_, buffer_length_) > 0) {
+    ++packets_sent_;
+    bytes_sent_ += buffer_length_;
+  }
+  buffer_length_ = 0;
+  buffer_has_report_ = false;
+}
+
+}  // namespace webrtc
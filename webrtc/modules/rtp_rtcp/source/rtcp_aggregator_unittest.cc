@@ -0,0 +1,575 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "webrtc/common_types.h"
+#include "webrtc/modules/rtp_rtcp/interface/rtcp_aggregator.h"
+#include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp.h"
+#include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+typedef std::vector<uint8_t> Packet;
+
+class FakeTransport : public Transport {
+ public:
+  FakeTransport() : rtp_packets_(0), rtcp_bytes_(0) {}
+
+  virtual int SendPacket(int channel, const void* data, int len) {
+    ++rtp_packets_;
+    return len;
+  }
+  virtual int SendRTCPPacket(int channel, const void* data, int len) {
+    const uint8_t* packet = static_cast<const uint8_t*>(data);
+    rtcp_packets_.push_back(Packet(packet, packet + len));
+    channels_.push_back(channel);
+    rtcp_bytes_ += len;
+    return len;
+  }
+
+  int rtp_packets_;
+  int rtcp_bytes_;
+  std::vector<Packet> rtcp_packets_;
+  std::vector<int> channels_;
+};
+
+void AppendWord(uint32_t value, Packet* packet) {
+  packet->push_back(static_cast<uint8_t>(value >> 24));
+  packet->push_back(static_cast<uint8_t>(value >> 16));
+  packet->push_back(static_cast<uint8_t>(value >> 8));
+  packet->push_back(static_cast<uint8_t>(value));
+}
+
+void AppendHeader(uint8_t count, uint8_t packet_type, int words,
+                  Packet* packet) {
+  packet->push_back(0x80 | count);
+  packet->push_back(packet_type);
+  packet->push_back(static_cast<uint8_t>((words - 1) >> 8));
+  packet->push_back(static_cast<uint8_t>(words - 1));
+}
+
+// Appends a receiver report from |sender_ssrc| with one report block for
+// each of |media_ssrcs|.
+void AppendRr(uint32_t sender_ssrc, const std::vector<uint32_t>& media_ssrcs,
+              uint32_t last_sr, uint32_t delay_since_last_sr, Packet* packet) {
+  const int num_blocks = static_cast<int>(media_ssrcs.size());
+  AppendHeader(static_cast<uint8_t>(num_blocks), 201, 2 + 6 * num_blocks,
+               packet);
+  AppendWord(sender_ssrc, packet);
+  for (int i = 0; i < num_blocks; ++i) {
+    AppendWord(media_ssrcs[i], packet);
+    AppendWord(0x05000001, packet);  // Fraction lost and cumulative lost.
+    AppendWord(1000, packet);  // Extended highest sequence number.
+    AppendWord(20, packet);  // Jitter.
+    AppendWord(last_sr, packet);
+    AppendWord(delay_since_last_sr, packet);
+  }
+}
+
+Packet Rr(uint32_t sender_ssrc, uint32_t media_ssrc) {
+  Packet packet;
+  AppendRr(sender_ssrc, std::vector<uint32_t>(1, media_ssrc), 0, 0, &packet);
+  return packet;
+}
+
+// Appends an SDES packet with a CNAME chunk for |ssrc|, as RTCPSender does.
+void AppendSdes(uint32_t ssrc, const char* cname, Packet* packet) {
+  const int cname_length = static_cast<int>(strlen(cname));
+  // SSRC, CNAME item and at least one null octet, padded to 32 bits.
+  const int chunk_words = (4 + 2 + cname_length + 4) / 4;
+  AppendHeader(1, 202, 1 + chunk_words, packet);
+  AppendWord(ssrc, packet);
+  packet->push_back(1);
+  packet->push_back(static_cast<uint8_t>(cname_length));
+  packet->insert(packet->end(), cname, cname + cname_length);
+  packet->resize(packet->size() + 4 * chunk_words - 6 - cname_length, 0);
+}
+
+void AppendRemb(uint32_t sender_ssrc, const std::vector<uint32_t>& ssrcs,
+                uint32_t bitrate, Packet* packet) {
+  const int num_ssrcs = static_cast<int>(ssrcs.size());
+  AppendHeader(15, 206, 5 + num_ssrcs, packet);
+  AppendWord(sender_ssrc, packet);
+  AppendWord(0, packet);
+  AppendWord('R' << 24 | 'E' << 16 | 'M' << 8 | 'B', packet);
+  uint8_t exponent = 0;
+  while ((bitrate >> exponent) > 0x3ffff) {
+    ++exponent;
+  }
+  AppendWord(static_cast<uint32_t>(num_ssrcs) << 24 |
+                 static_cast<uint32_t>(exponent) << 18 | (bitrate >> exponent),
+             packet);
+  for (int i = 0; i < num_ssrcs; ++i) {
+    AppendWord(ssrcs[i], packet);
+  }
+}
+
+void AppendNack(uint32_t sender_ssrc, uint32_t media_ssrc,
+                uint16_t sequence_number, Packet* packet) {
+  AppendHeader(1, 205, 4, packet);
+  AppendWord(sender_ssrc, packet);
+  AppendWord(media_ssrc, packet);
+  AppendWord(static_cast<uint32_t>(sequence_number) << 16, packet);
+}
+
+// What a parsed RTCP packet contains.
+struct ParsedRtcp {
+  ParsedRtcp() : num_rr(0), num_sdes(0), num_nack(0), num_remb(0) {}
+
+  int num_rr;
+  std::vector<uint32_t> rr_sender_ssrcs;
+  std::vector<RTCPUtility::RTCPPacketReportBlockItem> report_blocks;
+  int num_sdes;
+  std::vector<RTCPUtility::RTCPPacketSDESCName> cnames;
+  int num_nack;
+  int num_remb;
+  std::vector<uint32_t> remb_bitrates;
+  std::vector<std::vector<uint32_t> > remb_ssrcs;
+};
+
+// Parses |packet| as a compound RTCP packet.
+bool Parse(const Packet& packet, ParsedRtcp* parsed) {
+  RTCPUtility::RTCPParserV2 parser(&packet[0], packet.size(), false);
+  if (!parser.IsValid()) {
+    return false;
+  }
+  for (RTCPUtility::RTCPPacketTypes type = parser.Begin();
+       type != RTCPUtility::kRtcpNotValidCode; type = parser.Iterate()) {
+    const RTCPUtility::RTCPPacket& rtcp = parser.Packet();
+    switch (type) {
+      case RTCPUtility::kRtcpRrCode:
+        ++parsed->num_rr;
+        parsed->rr_sender_ssrcs.push_back(rtcp.RR.SenderSSRC);
+        break;
+      case RTCPUtility::kRtcpReportBlockItemCode:
+        parsed->report_blocks.push_back(rtcp.ReportBlockItem);
+        break;
+      case RTCPUtility::kRtcpSdesCode:
+        ++parsed->num_sdes;
+        break;
+      case RTCPUtility::kRtcpSdesChunkCode:
+        parsed->cnames.push_back(rtcp.CName);
+        break;
+      case RTCPUtility::kRtcpRtpfbNackCode:
+        ++parsed->num_nack;
+        break;
+      case RTCPUtility::kRtcpPsfbRembItemCode:
+        ++parsed->num_remb;
+        parsed->remb_bitrates.push_back(rtcp.REMBItem.BitRate);
+        parsed->remb_ssrcs.push_back(std::vector<uint32_t>(
+            rtcp.REMBItem.SSRCs,
+            rtcp.REMBItem.SSRCs + rtcp.REMBItem.NumberOfSSRCs));
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+class RtcpAggregatorTest : public ::testing::Test {
+ protected:
+  RtcpAggregatorTest()
+      : clock_(1234567),
+        aggregator_(&transport_, &clock_) {
+  }
+
+  void Send(int channel, const Packet& packet) {
+    EXPECT_EQ(static_cast<int>(packet.size()),
+              aggregator_.SendRTCPPacket(channel, &packet[0],
+                                         static_cast<int>(packet.size())));
+  }
+
+  void AdvanceTimeAndProcess(int64_t time_ms) {
+    clock_.AdvanceTimeMilliseconds(time_ms);
+    if (aggregator_.TimeUntilNextProcess() <= 0) {
+      aggregator_.Process();
+    }
+  }
+
+  SimulatedClock clock_;
+  FakeTransport transport_;
+  RtcpAggregator aggregator_;
+};
+
+TEST_F(RtcpAggregatorTest, PassesRtpThrough) {
+  const uint8_t packet[12] = { 0x80, 96 };
+  EXPECT_EQ(12, aggregator_.SendPacket(0, packet, sizeof(packet)));
+  EXPECT_EQ(1, transport_.rtp_packets_);
+  EXPECT_TRUE(transport_.rtcp_packets_.empty());
+}
+
+TEST_F(RtcpAggregatorTest, MergesReceiverReports) {
+  Send(1, Rr(11, 101));
+  Send(2, Rr(12, 102));
+  AdvanceTimeAndProcess(RtcpAggregator::kMaxHoldTimeMs / 2);
+  Send(3, Rr(13, 103));
+  EXPECT_TRUE(transport_.rtcp_packets_.empty());
+  EXPECT_EQ(RtcpAggregator::kMaxHoldTimeMs / 2,
+            aggregator_.TimeUntilNextProcess());
+
+  AdvanceTimeAndProcess(RtcpAggregator::kMaxHoldTimeMs / 2);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  EXPECT_EQ(1, transport_.channels_[0]);
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  EXPECT_EQ(1, parsed.num_rr);
+  EXPECT_EQ(11u, parsed.rr_sender_ssrcs[0]);
+  ASSERT_EQ(3u, parsed.report_blocks.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(101u + i, parsed.report_blocks[i].SSRC);
+    EXPECT_EQ(1000u, parsed.report_blocks[i].ExtendedHighestSequenceNumber);
+    EXPECT_EQ(20u, parsed.report_blocks[i].Jitter);
+  }
+  // 8 bytes of header and 24 bytes per block.
+  EXPECT_EQ(8u + 3 * 24, transport_.rtcp_packets_[0].size());
+
+  uint32_t packets_sent = 0;
+  uint32_t bytes_sent = 0;
+  aggregator_.Statistics(&packets_sent, &bytes_sent);
+  EXPECT_EQ(1u, packets_sent);
+  EXPECT_EQ(8u + 3 * 24, bytes_sent);
+  EXPECT_EQ(RtcpAggregator::kMaxHoldTimeMs,
+            aggregator_.TimeUntilNextProcess());
+}
+
+TEST_F(RtcpAggregatorTest, AdjustsDelaySinceLastSrForTimeHeld) {
+  Packet packet;
+  AppendRr(11, std::vector<uint32_t>(1, 101), 0x12345678, 65536, &packet);
+  Send(0, packet);
+  AdvanceTimeAndProcess(RtcpAggregator::kMaxHoldTimeMs);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  ASSERT_EQ(1u, parsed.report_blocks.size());
+  EXPECT_EQ(0x12345678u, parsed.report_blocks[0].LastSR);
+  EXPECT_EQ(65536u + (RtcpAggregator::kMaxHoldTimeMs << 16) / 1000,
+            parsed.report_blocks[0].DelayLastSR);
+}
+
+TEST_F(RtcpAggregatorTest, SendsFeedbackRightAway) {
+  Send(1, Rr(11, 101));
+  Packet packet = Rr(12, 102);
+  AppendNack(12, 102, 4711, &packet);
+  Send(2, packet);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  EXPECT_EQ(1, parsed.num_rr);
+  EXPECT_EQ(2u, parsed.report_blocks.size());
+  EXPECT_EQ(1, parsed.num_nack);
+}
+
+TEST_F(RtcpAggregatorTest, LeadsFeedbackWithReceiverReport) {
+  // Only an empty receiver report, e.g. from a module which hasn't received
+  // anything, and a NACK from a module in reduced-size mode.
+  Packet empty_rr;
+  AppendRr(11, std::vector<uint32_t>(), 0, 0, &empty_rr);
+  Send(1, empty_rr);
+  Packet nack;
+  AppendNack(12, 102, 4711, &nack);
+  Send(2, nack);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  EXPECT_EQ(1, parsed.num_rr);
+  EXPECT_EQ(11u, parsed.rr_sender_ssrcs[0]);
+  EXPECT_EQ(1, parsed.num_nack);
+
+  // Nothing but empty receiver reports.
+  Send(1, empty_rr);
+  Send(1, empty_rr);
+  aggregator_.Flush();
+  ASSERT_EQ(2u, transport_.rtcp_packets_.size());
+  EXPECT_TRUE(transport_.rtcp_packets_[1] == empty_rr);
+}
+
+TEST_F(RtcpAggregatorTest, MergesRemb) {
+  Packet packet = Rr(11, 101);
+  AppendRemb(11, std::vector<uint32_t>(1, 101), 500000, &packet);
+  Send(0, packet);
+  packet = Rr(12, 102);
+  AppendRemb(12, std::vector<uint32_t>(1, 102), 500000, &packet);
+  Send(0, packet);
+  packet = Rr(13, 103);
+  AppendRemb(13, std::vector<uint32_t>(1, 103), 300000, &packet);
+  Send(0, packet);
+  // A new estimate for 101 replaces the held one.
+  packet = Rr(14, 104);
+  AppendRemb(14, std::vector<uint32_t>(1, 101), 300000, &packet);
+  Send(0, packet);
+  aggregator_.Flush();
+
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  EXPECT_EQ(4u, parsed.report_blocks.size());
+  ASSERT_EQ(2, parsed.num_remb);
+  EXPECT_EQ(500000u, parsed.remb_bitrates[0]);
+  EXPECT_EQ(std::vector<uint32_t>(1, 102), parsed.remb_ssrcs[0]);
+  EXPECT_EQ(300000u, parsed.remb_bitrates[1]);
+  ASSERT_EQ(2u, parsed.remb_ssrcs[1].size());
+  EXPECT_EQ(103u, parsed.remb_ssrcs[1][0]);
+  EXPECT_EQ(101u, parsed.remb_ssrcs[1][1]);
+}
+
+TEST_F(RtcpAggregatorTest, MergesSdes) {
+  const char* kCnames[] = { "cname", "a-longer-cname@example.org", "cname" };
+  for (int i = 0; i < 3; ++i) {
+    Packet packet = Rr(11 + i, 101 + i);
+    AppendSdes(11 + i, kCnames[i], &packet);
+    Send(i, packet);
+  }
+  // A new CNAME replaces the held one.
+  Packet packet = Rr(11, 104);
+  AppendSdes(11, "new", &packet);
+  Send(3, packet);
+  EXPECT_TRUE(transport_.rtcp_packets_.empty());
+
+  AdvanceTimeAndProcess(RtcpAggregator::kMaxHoldTimeMs);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  EXPECT_EQ(1, parsed.num_rr);
+  EXPECT_EQ(4u, parsed.report_blocks.size());
+  EXPECT_EQ(1, parsed.num_sdes);
+  ASSERT_EQ(3u, parsed.cnames.size());
+  EXPECT_EQ(11u, parsed.cnames[0].SenderSSRC);
+  EXPECT_STREQ("new", parsed.cnames[0].CName);
+  EXPECT_EQ(12u, parsed.cnames[1].SenderSSRC);
+  EXPECT_STREQ("a-longer-cname@example.org", parsed.cnames[1].CName);
+  EXPECT_EQ(13u, parsed.cnames[2].SenderSSRC);
+  EXPECT_STREQ("cname", parsed.cnames[2].CName);
+}
+
+TEST_F(RtcpAggregatorTest, LimitsChunksPerSdes) {
+  for (int i = 0; i < 40; ++i) {
+    Packet packet = Rr(1000 + i, 2000 + i);
+    AppendSdes(1000 + i, "cname", &packet);
+    Send(0, packet);
+  }
+  aggregator_.Flush();
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  EXPECT_EQ(40u, parsed.report_blocks.size());
+  EXPECT_EQ(2, parsed.num_sdes);
+  EXPECT_EQ(40u, parsed.cnames.size());
+}
+
+TEST_F(RtcpAggregatorTest, SplitsIntoPacketsOfMaxSize) {
+  const int kMaxPacketSize = 200;
+  RtcpAggregator aggregator(&transport_, &clock_, kMaxPacketSize);
+  const int kNumBlocks = 20;
+  std::vector<uint32_t> media_ssrcs;
+  for (int i = 0; i < kNumBlocks; ++i) {
+    media_ssrcs.push_back(2000 + i);
+  }
+  Packet packet;
+  AppendRr(1000, media_ssrcs, 0, 0, &packet);
+  AppendNack(1000, 2000, 1, &packet);
+  aggregator.SendRTCPPacket(0, &packet[0], static_cast<int>(packet.size()));
+
+  ASSERT_EQ(3u, transport_.rtcp_packets_.size());
+  int num_blocks = 0;
+  int num_nacks = 0;
+  for (size_t i = 0; i < transport_.rtcp_packets_.size(); ++i) {
+    EXPECT_LE(transport_.rtcp_packets_[i].size(),
+              static_cast<size_t>(kMaxPacketSize));
+    // Every packet starts with a receiver report.
+    ParsedRtcp parsed;
+    ASSERT_TRUE(Parse(transport_.rtcp_packets_[i], &parsed));
+    EXPECT_EQ(1, parsed.num_rr);
+    num_blocks += static_cast<int>(parsed.report_blocks.size());
+    num_nacks += parsed.num_nack;
+  }
+  EXPECT_EQ(kNumBlocks, num_blocks);
+  EXPECT_EQ(1, num_nacks);
+}
+
+TEST_F(RtcpAggregatorTest, PassesPacketsLargerThanMaxSizeThrough) {
+  const int kMaxPacketSize = 200;
+  RtcpAggregator aggregator(&transport_, &clock_, kMaxPacketSize);
+  Packet packet = Rr(1000, 2000);
+  AppendSdes(1000, std::string(kMaxPacketSize, 'a').c_str(), &packet);
+  aggregator.SendRTCPPacket(0, &packet[0], static_cast<int>(packet.size()));
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  EXPECT_TRUE(transport_.rtcp_packets_[0] == packet);
+}
+
+TEST_F(RtcpAggregatorTest, LimitsReportBlocksPerReceiverReport) {
+  for (int i = 0; i < 40; ++i) {
+    Send(0, Rr(1000 + i, 2000 + i));
+  }
+  aggregator_.Flush();
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  ParsedRtcp parsed;
+  ASSERT_TRUE(Parse(transport_.rtcp_packets_[0], &parsed));
+  EXPECT_EQ(2, parsed.num_rr);
+  EXPECT_EQ(1000u, parsed.rr_sender_ssrcs[0]);
+  EXPECT_EQ(1031u, parsed.rr_sender_ssrcs[1]);
+  EXPECT_EQ(40u, parsed.report_blocks.size());
+}
+
+TEST_F(RtcpAggregatorTest, PassesOtherPacketsThroughInOrder) {
+  Send(1, Rr(11, 101));
+  // Not RTCP.
+  const uint8_t garbage[8] = { 0x40, 201, 0, 1 };
+  EXPECT_EQ(8, aggregator_.SendRTCPPacket(2, garbage, sizeof(garbage)));
+  ASSERT_EQ(2u, transport_.rtcp_packets_.size());
+  EXPECT_TRUE(transport_.rtcp_packets_[0] == Rr(11, 101));
+  EXPECT_EQ(1, transport_.channels_[0]);
+  EXPECT_TRUE(transport_.rtcp_packets_[1] ==
+              Packet(garbage, garbage + sizeof(garbage)));
+  EXPECT_EQ(2, transport_.channels_[1]);
+}
+
+// Receive-only video streams multiplexed on one transport, with and without
+// aggregation of their RTCP.
+class RtcpAggregatorBenchmark {
+ public:
+  RtcpAggregatorBenchmark(int num_streams, bool aggregate, bool cname)
+      : clock_(1234567),
+        aggregator_(&transport_, &clock_),
+        aggregate_(aggregate),
+        sequence_number_(0),
+        process_time_us_(0) {
+    for (int i = 0; i < num_streams; ++i) {
+      RtpRtcp::Configuration configuration;
+      configuration.id = i;
+      configuration.clock = &clock_;
+      configuration.outgoing_transport =
+          aggregate ? static_cast<Transport*>(&aggregator_) : &transport_;
+      RtpRtcp* module = RtpRtcp::CreateRtpRtcp(configuration);
+      module->SetRTCPStatus(kRtcpCompound);
+      module->SetSSRC(1000 + i);
+      if (cname) {
+        char name[RTCP_CNAME_SIZE];
+        sprintf(name, "stream%d@example.org", i);
+        module->SetCNAME(name);
+      }
+      VideoCodec codec;
+      memset(&codec, 0, sizeof(codec));
+      codec.plType = 100;
+      strncpy(codec.plName, "VP8", 3);
+      module->RegisterReceivePayload(codec);
+      if (i == 0) {
+        // One module sends the estimate for all streams.
+        module->SetREMBStatus(true);
+        std::vector<uint32_t> ssrcs;
+        for (int j = 0; j < num_streams; ++j) {
+          ssrcs.push_back(2000 + j);
+        }
+        module->SetREMBData(1000000, static_cast<uint8_t>(ssrcs.size()),
+                            &ssrcs[0]);
+      }
+      modules_.push_back(module);
+    }
+  }
+
+  ~RtcpAggregatorBenchmark() {
+    for (size_t i = 0; i < modules_.size(); ++i) {
+      delete modules_[i];
+    }
+  }
+
+  void Run(int duration_ms) {
+    const int kProcessIntervalMs = 5;
+    const int kFrameIntervalMs = 30;
+    for (int time_ms = 0; time_ms < duration_ms;
+         time_ms += kProcessIntervalMs) {
+      if (time_ms % kFrameIntervalMs == 0) {
+        for (size_t i = 0; i < modules_.size(); ++i) {
+          ReceivePacket(i);
+        }
+        ++sequence_number_;
+      }
+      const int64_t start_us = TickTime::MicrosecondTimestamp();
+      for (size_t i = 0; i < modules_.size(); ++i) {
+        if (modules_[i]->TimeUntilNextProcess() <= 0) {
+          modules_[i]->Process();
+        }
+      }
+      if (aggregate_ && aggregator_.TimeUntilNextProcess() <= 0) {
+        aggregator_.Process();
+      }
+      process_time_us_ += TickTime::MicrosecondTimestamp() - start_us;
+      clock_.AdvanceTimeMilliseconds(kProcessIntervalMs);
+    }
+  }
+
+  int num_rtcp_packets() const {
+    return static_cast<int>(transport_.rtcp_packets_.size());
+  }
+  int rtcp_bytes() const { return transport_.rtcp_bytes_; }
+  int64_t process_time_us() const { return process_time_us_; }
+
+ private:
+  void ReceivePacket(size_t stream) {
+    uint8_t packet[12 + 100];
+    memset(packet, 0, sizeof(packet));
+    packet[0] = 0x80;
+    packet[1] = 100;
+    ModuleRTPUtility::AssignUWord16ToBuffer(&packet[2], sequence_number_);
+    ModuleRTPUtility::AssignUWord32ToBuffer(&packet[4],
+                                            sequence_number_ * 3000);
+    ModuleRTPUtility::AssignUWord32ToBuffer(&packet[8],
+                                            2000 + static_cast<int>(stream));
+    modules_[stream]->IncomingPacket(packet, sizeof(packet));
+  }
+
+  SimulatedClock clock_;
+  FakeTransport transport_;
+  RtcpAggregator aggregator_;
+  const bool aggregate_;
+  std::vector<RtpRtcp*> modules_;
+  uint16_t sequence_number_;
+  int64_t process_time_us_;
+};
+
+TEST(RtcpAggregatorBenchmarkTest, DISABLED_BytesAndCpuPerStream) {
+  const int kNumStreams = 200;
+  const int kDurationMs = 20000;
+  const int kIpUdpOverhead = 28;
+  for (int test = 0; test < 4; ++test) {
+    const bool aggregate = (test & 1) != 0;
+    const bool cname = (test & 2) != 0;
+    RtcpAggregatorBenchmark benchmark(kNumStreams, aggregate, cname);
+    benchmark.Run(kDurationMs);
+    const double seconds = kDurationMs / 1000.0;
+    const double packets_per_second = benchmark.num_rtcp_packets() / seconds;
+    const double bytes_per_stream_second =
+        (benchmark.rtcp_bytes() +
+         kIpUdpOverhead * benchmark.num_rtcp_packets()) /
+        (kNumStreams * seconds);
+    printf("%s, %s: %.1f RTCP packets/s, %.1f bytes/s per stream including "
+           "IP/UDP, %.2f us/s per stream processing\n",
+           aggregate ? "Aggregated" : "Per module",
+           cname ? "CNAME" : "no CNAME",
+           packets_per_second, bytes_per_stream_second,
+           benchmark.process_time_us() / (kNumStreams * seconds));
+    EXPECT_GT(benchmark.num_rtcp_packets(), 0);
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
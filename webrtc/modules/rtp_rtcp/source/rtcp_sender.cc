@@ -18,6 +18,7 @@
 #include "common_types.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_impl.h"
 #include "system_wrappers/interface/critical_section_wrapper.h"
+#include "system_wrappers/interface/rtc_event_log.h"
 #include "system_wrappers/interface/trace.h"
 #include "system_wrappers/interface/trace_event.h"
 
@@ -1939,17 +1940,20 @@ RTCPSender::SendRTCP(const uint32_t packetTypeFlags,
     {
         return -1;
     }
-    return SendToNetwork(rtcpbuffer, (uint16_t)pos);
+    return SendToNetwork(rtcpbuffer, (uint16_t)pos, sizeof(rtcpbuffer));
 }
 
 int32_t
-RTCPSender::SendToNetwork(const uint8_t* dataBuffer,
-                          const uint16_t length)
+RTCPSender::SendToNetwork(uint8_t* dataBuffer,
+                          const uint16_t length,
+                          const uint16_t capacity)
 {
+    RtcEventLog::LogRtcpPacket(_id, false, dataBuffer, length);
     CriticalSectionScoped lock(_criticalSectionTransport);
     if(_cbTransport)
     {
-        if(_cbTransport->SendRTCPPacket(_id, dataBuffer, length) > 0)
+        if(_cbTransport->SendWritableRTCPPacket(_id, dataBuffer, length,
+                                                capacity) > 0)
         {
             return 0;
         }
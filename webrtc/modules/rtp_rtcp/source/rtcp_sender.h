@@ -146,7 +146,10 @@ public:
     void SetTargetBitrate(unsigned int target_bitrate);
 
 private:
-    int32_t SendToNetwork(const uint8_t* dataBuffer, const uint16_t length);
+    // |dataBuffer| has room for |capacity| bytes and isn't used after the
+    // call, so the transport may modify it in place.
+    int32_t SendToNetwork(uint8_t* dataBuffer, const uint16_t length,
+                          const uint16_t capacity);
 
     void UpdatePacketRate();
 
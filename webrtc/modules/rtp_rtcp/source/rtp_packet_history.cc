@@ -11,7 +11,7 @@
 #include "rtp_packet_history.h"
 
 #include <assert.h>
-#include <cstring>   // memset
+#include <cstring>   // memcpy
 
 #include "critical_section_wrapper.h"
 #include "rtp_utility.h"
@@ -19,12 +19,27 @@
 
 namespace webrtc {
 
+RTPPacketHistory::StoredPacket::StoredPacket(uint32_t capacity)
+    : data_(new uint8_t[capacity]),
+      capacity_(capacity),
+      length_(0),
+      ref_count_(0) {
+}
+
+RTPPacketHistory::StoredPacket::~StoredPacket() {
+  delete [] data_;
+}
+
 RTPPacketHistory::RTPPacketHistory(Clock* clock)
   : clock_(clock),
     critsect_(CriticalSectionWrapper::CreateCriticalSection()),
     store_(false),
-    prev_index_(0),
-    max_packet_length_(0) {
+    max_packet_length_(0),
+    number_to_store_(0),
+    newest_seq_num_(0),
+    has_stored_(false),
+    slot_mask_(0),
+    num_free_packets_(0) {
 }
 
 RTPPacketHistory::~RTPPacketHistory() {
@@ -32,7 +47,7 @@ RTPPacketHistory::~RTPPacketHistory() {
   delete critsect_;
 }
 
-void RTPPacketHistory::SetStorePacketsStatus(bool enable, 
+void RTPPacketHistory::SetStorePacketsStatus(bool enable,
                                              uint16_t number_to_store) {
   if (enable) {
     Allocate(number_to_store);
@@ -50,13 +65,14 @@ void RTPPacketHistory::Allocate(uint16_t number_to_store) {
     return;
   }
 
+  uint32_t number_of_slots = 1;
+  while (number_of_slots < number_to_store) {
+    number_of_slots <<= 1;
+  }
   store_ = true;
-  stored_packets_.resize(number_to_store);
-  stored_seq_nums_.resize(number_to_store);
-  stored_lengths_.resize(number_to_store);
-  stored_times_.resize(number_to_store);
-  stored_resend_times_.resize(number_to_store);
-  stored_types_.resize(number_to_store);
+  number_to_store_ = number_to_store;
+  slots_.resize(number_of_slots);
+  slot_mask_ = number_of_slots - 1;
 }
 
 void RTPPacketHistory::Free() {
@@ -65,21 +81,17 @@ void RTPPacketHistory::Free() {
     return;
   }
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {   
-    it->clear();
-  }
-
-  stored_packets_.clear();
-  stored_seq_nums_.clear();
-  stored_lengths_.clear();
-  stored_times_.clear();
-  stored_resend_times_.clear();
-  stored_types_.clear();
+  // Packets still referenced by a caller are released by their last owner.
+  slots_.clear();
+  free_packets_.clear();
+  num_free_packets_ = 0;
+  slot_mask_ = 0;
 
   store_ = false;
-  prev_index_ = 0;
   max_packet_length_ = 0;
+  number_to_store_ = 0;
+  newest_seq_num_ = 0;
+  has_stored_ = false;
 }
 
 bool RTPPacketHistory::StorePackets() const {
@@ -88,21 +100,36 @@ bool RTPPacketHistory::StorePackets() const {
 }
 
 // private, lock should already be taken
-void RTPPacketHistory::VerifyAndAllocatePacketLength(uint16_t packet_length) {
+scoped_refptr<RTPPacketHistory::StoredPacket>
+RTPPacketHistory::AllocatePacket(uint16_t packet_length) {
   assert(packet_length > 0);
-  if (!store_) {
-    return;
+  const uint32_t size_class = (packet_length + kSlabSize - 1) / kSlabSize;
+  if (size_class < free_packets_.size() &&
+      !free_packets_[size_class].empty()) {
+    scoped_refptr<StoredPacket> packet = free_packets_[size_class].back();
+    free_packets_[size_class].pop_back();
+    --num_free_packets_;
+    return packet;
   }
+  return new StoredPacket(size_class * kSlabSize);
+}
 
-  if (packet_length <= max_packet_length_) {
+// private, lock should already be taken
+void RTPPacketHistory::RecyclePacket(scoped_refptr<StoredPacket>* packet) {
+  if (packet->get() == NULL) {
     return;
   }
-
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {
-    it->resize(packet_length);
+  // Only recycle buffers that no caller is holding on to, and never keep more
+  // spare buffers around than the history can hold packets.
+  if ((*packet)->HasOneRef() && num_free_packets_ < number_to_store_) {
+    const uint32_t size_class = (*packet)->capacity_ / kSlabSize;
+    if (size_class >= free_packets_.size()) {
+      free_packets_.resize(size_class + 1);
+    }
+    free_packets_[size_class].push_back(*packet);
+    ++num_free_packets_;
   }
-  max_packet_length_ = packet_length;
+  *packet = NULL;
 }
 
 int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
@@ -122,7 +149,9 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
   assert(packet);
   assert(packet_length > 3);
 
-  VerifyAndAllocatePacketLength(max_packet_length);
+  if (max_packet_length > max_packet_length_) {
+    max_packet_length_ = max_packet_length;
+  }
 
   if (packet_length > max_packet_length_) {
     WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, -1,
@@ -132,21 +161,25 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
 
   const uint16_t seq_num = (packet[2] << 8) + packet[3];
 
-  // Store packet
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + prev_index_;
-  std::copy(packet, packet + packet_length, it->begin());
-
-  stored_seq_nums_[prev_index_] = seq_num;
-  stored_lengths_[prev_index_] = packet_length;
-  stored_times_[prev_index_] =
+  // Store packet in the slot owned by its sequence number, evicting whatever
+  // packet was there.
+  Slot& slot = slots_[seq_num & slot_mask_];
+  RecyclePacket(&slot.packet);
+  scoped_refptr<StoredPacket> stored_packet = AllocatePacket(packet_length);
+  memcpy(stored_packet->data_, packet, packet_length);
+  stored_packet->length_ = packet_length;
+
+  slot.packet = stored_packet;
+  slot.seq_num = seq_num;
+  slot.stored_time_ms =
       (capture_time_ms > 0) ? capture_time_ms : clock_->TimeInMilliseconds();
-  stored_resend_times_[prev_index_] = 0;  // packet not resent
-  stored_types_[prev_index_] = type;
+  slot.resend_time_ms = 0;  // packet not resent
+  slot.type = type;
 
-  ++prev_index_;
-  if (prev_index_ >= stored_seq_nums_.size()) {
-    prev_index_ = 0;
+  if (!has_stored_ ||
+      IsNewerSequenceNumber(seq_num, newest_seq_num_)) {
+    newest_seq_num_ = seq_num;
+    has_stored_ = true;
   }
   return 0;
 }
@@ -168,26 +201,31 @@ int32_t RTPPacketHistory::ReplaceRTPHeader(const uint8_t* packet,
     return -1;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  Slot* slot = FindSlot(sequence_number);
+  if (slot == NULL) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u", sequence_number);
     return -1;
   }
 
-  uint16_t length = stored_lengths_.at(index);
-  if (length == 0 || length > max_packet_length_) {
+  const uint16_t length = slot->packet->length_;
+  if (rtp_header_length > length) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u, len %d", sequence_number, length);
     return -1;
   }
-  assert(stored_seq_nums_[index] == sequence_number);
+
+  // Stored packets are immutable once handed out; copy the packet if anyone
+  // but the history is holding a reference to it.
+  if (!slot->packet->HasOneRef()) {
+    scoped_refptr<StoredPacket> copy = AllocatePacket(length);
+    memcpy(copy->data_, slot->packet->data_, length);
+    copy->length_ = length;
+    slot->packet = copy;
+  }
 
   // Update RTP header.
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + index;
-  std::copy(packet, packet + rtp_header_length, it->begin());
+  memcpy(slot->packet->data_, packet, rtp_header_length);
   return 0;
 }
 
@@ -196,19 +234,7 @@ bool RTPPacketHistory::HasRTPPacket(uint16_t sequence_number) const {
   if (!store_) {
     return false;
   }
-
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
-    return false;
-  }
- 
-  uint16_t length = stored_lengths_.at(index);
-  if (length == 0 || length > max_packet_length_) {
-    // Invalid length.
-    return false;
-  }
-  return true;
+  return FindSlot(sequence_number) != NULL;
 }
 
 bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
@@ -222,44 +248,68 @@ bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
     return false;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  const Slot* slot = FindSlot(sequence_number);
+  if (slot == NULL) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u", sequence_number);
     return false;
   }
 
-  uint16_t length = stored_lengths_.at(index);
-  if (length == 0 || length > max_packet_length_) {
+  const uint16_t length = slot->packet->length_;
+  if (length > *packet_length) {
+    WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1,
+        "Input buffer too short for packet %u", sequence_number);
+    return false;
+  }
+
+  // Verify elapsed time since last retrieve.
+  int64_t now = clock_->TimeInMilliseconds();
+  if (min_elapsed_time_ms > 0 &&
+      ((now - slot->resend_time_ms) < min_elapsed_time_ms)) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
-        "No match for getting seqNum %u, len %d", sequence_number, length);
+        "Skip getting packet %u, packet recently resent.", sequence_number);
+    *packet_length = 0;
+    return true;
+  }
+
+  // Get packet.
+  memcpy(packet, slot->packet->data_, length);
+  *packet_length = length;
+  *stored_time_ms = slot->stored_time_ms;
+  *type = slot->type;
+  return true;
+}
+
+bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
+                                    uint32_t min_elapsed_time_ms,
+                                    scoped_refptr<StoredPacket>* packet,
+                                    int64_t* stored_time_ms,
+                                    StorageType* type) const {
+  CriticalSectionScoped cs(critsect_);
+  if (!store_) {
     return false;
   }
 
- if (length > *packet_length) {
-    WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1, 
-        "Input buffer too short for packet %u", sequence_number);
+  const Slot* slot = FindSlot(sequence_number);
+  if (slot == NULL) {
+    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
+        "No match for getting seqNum %u", sequence_number);
     return false;
- }
+  }
 
-  // Verify elapsed time since last retrieve. 
+  // Verify elapsed time since last retrieve.
   int64_t now = clock_->TimeInMilliseconds();
   if (min_elapsed_time_ms > 0 &&
-      ((now - stored_resend_times_.at(index)) < min_elapsed_time_ms)) {
-    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1, 
+      ((now - slot->resend_time_ms) < min_elapsed_time_ms)) {
+    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "Skip getting packet %u, packet recently resent.", sequence_number);
-    *packet_length = 0;
+    *packet = NULL;
     return true;
   }
 
-  // Get packet.
-  std::vector<std::vector<uint8_t> >::const_iterator it_found_packet =
-      stored_packets_.begin() + index;
-  std::copy(it_found_packet->begin(), it_found_packet->begin() + length, packet);
-  *packet_length = stored_lengths_.at(index);
-  *stored_time_ms = stored_times_.at(index);
-  *type = stored_types_.at(index);
+  *packet = slot->packet;
+  *stored_time_ms = slot->stored_time_ms;
+  *type = slot->type;
   return true;
 }
 
@@ -269,48 +319,37 @@ void RTPPacketHistory::UpdateResendTime(uint16_t sequence_number) {
     return;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  Slot* slot = FindSlot(sequence_number);
+  if (slot == NULL) {
     WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1,
         "Failed to update resend time, seq num: %u.", sequence_number);
     return;
   }
-  stored_resend_times_[index] = clock_->TimeInMilliseconds();
+  slot->resend_time_ms = clock_->TimeInMilliseconds();
 }
 
 // private, lock should already be taken
-bool RTPPacketHistory::FindSeqNum(uint16_t sequence_number,
-                                  int32_t* index) const {
-  uint16_t temp_sequence_number = 0;
-  if (prev_index_ > 0) {
-    *index = prev_index_ - 1;
-    temp_sequence_number = stored_seq_nums_[*index];
-  } else {
-    *index = stored_seq_nums_.size() - 1;
-    temp_sequence_number = stored_seq_nums_[*index];  // wrap
+const RTPPacketHistory::Slot* RTPPacketHistory::FindSlot(
+    uint16_t sequence_number) const {
+  if (!has_stored_) {
+    return NULL;
   }
-
-  int32_t idx = (prev_index_ - 1) - (temp_sequence_number - sequence_number);
-  if (idx >= 0 && idx < static_cast<int>(stored_seq_nums_.size())) {
-    *index = idx;
-    temp_sequence_number = stored_seq_nums_[*index];
+  // Only the |number_to_store_| most recent sequence numbers are kept, even
+  // if the ring is larger.
+  const uint16_t age = newest_seq_num_ - sequence_number;
+  if (age >= number_to_store_) {
+    return NULL;
   }
-
-  if (temp_sequence_number != sequence_number) {
-    // We did not found a match, search all.
-    for (uint16_t m = 0; m < stored_seq_nums_.size(); m++) {
-      if (stored_seq_nums_[m] == sequence_number) {
-        *index = m;
-        temp_sequence_number = stored_seq_nums_[*index];
-        break;
-      }
-    }
-  }
-  if (temp_sequence_number == sequence_number) {
-    // We found a match.
-    return true;
+  const Slot& slot = slots_[sequence_number & slot_mask_];
+  if (slot.packet.get() == NULL || slot.seq_num != sequence_number) {
+    return NULL;
   }
-  return false;
+  return &slot;
+}
+
+// private, lock should already be taken
+RTPPacketHistory::Slot* RTPPacketHistory::FindSlot(uint16_t sequence_number) {
+  return const_cast<Slot*>(
+      static_cast<const RTPPacketHistory*>(this)->FindSlot(sequence_number));
 }
 }  // namespace webrtc
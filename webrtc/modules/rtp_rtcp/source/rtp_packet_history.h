@@ -17,6 +17,8 @@
 
 #include "module_common_types.h"
 #include "rtp_rtcp_defines.h"
+#include "system_wrappers/interface/atomic32.h"
+#include "system_wrappers/interface/scoped_refptr.h"
 #include "typedefs.h"
 
 namespace webrtc {
@@ -26,6 +28,37 @@ class CriticalSectionWrapper;
 
 class RTPPacketHistory {
  public:
+  // Reference counted, immutable storage for a single RTP packet. A packet
+  // handed out by GetRTPPacket() stays valid for as long as the caller holds
+  // a reference, even if the history overwrites or replaces the slot in the
+  // meantime.
+  class StoredPacket {
+   public:
+    const uint8_t* data() const { return data_; }
+    uint16_t length() const { return length_; }
+
+    int32_t AddRef() { return ++ref_count_; }
+    int32_t Release() {
+      int32_t ref_count = --ref_count_;
+      if (ref_count == 0)
+        delete this;
+      return ref_count;
+    }
+
+   private:
+    friend class RTPPacketHistory;
+
+    explicit StoredPacket(uint32_t capacity);
+    ~StoredPacket();
+
+    bool HasOneRef() const { return ref_count_.Value() == 1; }
+
+    uint8_t* data_;
+    uint32_t capacity_;
+    uint16_t length_;
+    Atomic32 ref_count_;
+  };
+
   RTPPacketHistory(Clock* clock);
   ~RTPPacketHistory();
 
@@ -66,29 +99,59 @@ class RTPPacketHistory {
                     int64_t* stored_time_ms,
                     StorageType* type) const;
 
+  // Same as above, but returns a reference to the stored packet instead of
+  // copying it. If the packet is found but the minimum time has not elapsed,
+  // true is returned and |packet| is set to NULL.
+  bool GetRTPPacket(uint16_t sequence_number,
+                    uint32_t min_elapsed_time_ms,
+                    scoped_refptr<StoredPacket>* packet,
+                    int64_t* stored_time_ms,
+                    StorageType* type) const;
+
   bool HasRTPPacket(uint16_t sequence_number) const;
 
   void UpdateResendTime(uint16_t sequence_number);
 
  private:
+  struct Slot {
+    Slot() : seq_num(0), stored_time_ms(0), resend_time_ms(0),
+             type(kDontStore) {}
+
+    scoped_refptr<StoredPacket> packet;
+    uint16_t seq_num;
+    int64_t stored_time_ms;
+    int64_t resend_time_ms;
+    StorageType type;
+  };
+
+  // Buffers are handed out in size classes of |kSlabSize| bytes, and buffers
+  // no longer referenced outside the history are recycled rather than freed.
+  enum { kSlabSize = 128 };
+
   void Allocate(uint16_t number_to_store);
   void Free();
-  void VerifyAndAllocatePacketLength(uint16_t packet_length);
-  bool FindSeqNum(uint16_t sequence_number, int32_t* index) const;
+  scoped_refptr<StoredPacket> AllocatePacket(uint16_t packet_length);
+  void RecyclePacket(scoped_refptr<StoredPacket>* packet);
+  const Slot* FindSlot(uint16_t sequence_number) const;
+  Slot* FindSlot(uint16_t sequence_number);
 
  private:
   Clock* clock_;
   CriticalSectionWrapper* critsect_;
   bool store_;
-  uint32_t prev_index_;
   uint16_t max_packet_length_;
-
-  std::vector<std::vector<uint8_t> > stored_packets_;
-  std::vector<uint16_t> stored_seq_nums_;
-  std::vector<uint16_t> stored_lengths_;
-  std::vector<int64_t> stored_times_;
-  std::vector<int64_t> stored_resend_times_;
-  std::vector<StorageType> stored_types_;
+  uint16_t number_to_store_;
+  // Newest sequence number stored, valid if |has_stored_| is true.
+  uint16_t newest_seq_num_;
+  bool has_stored_;
+
+  // Ring of packets indexed directly by |sequence_number & slot_mask_|. The
+  // ring size is |number_to_store_| rounded up to a power of two so that the
+  // mapping is continuous across sequence number wrap-around.
+  std::vector<Slot> slots_;
+  uint32_t slot_mask_;
+  std::vector<std::vector<scoped_refptr<StoredPacket> > > free_packets_;
+  uint32_t num_free_packets_;
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_RTP_PACKET_HISTORY_H_
@@ -12,9 +12,15 @@
 
 #include <gtest/gtest.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
 #include "clock.h"
 #include "rtp_packet_history.h"
 #include "rtp_rtcp_defines.h"
+#include "system_wrappers/interface/tick_util.h"
 #include "typedefs.h"
 
 namespace webrtc {
@@ -260,4 +266,141 @@ TEST_F(RtpPacketHistoryTest, MinResendTime) {
   EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 101, packet_, &len, &time, &type));
   EXPECT_EQ(0, len);
 }
+
+TEST_F(RtpPacketHistoryTest, GetStoredPacket) {
+  hist_->SetStorePacketsStatus(true, 10);
+  uint16_t len = 0;
+  int64_t capture_time_ms = 1;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                   capture_time_ms, kAllowRetransmission));
+
+  scoped_refptr<RTPPacketHistory::StoredPacket> stored;
+  int64_t time;
+  StorageType type;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &stored, &time, &type));
+  ASSERT_TRUE(stored.get() != NULL);
+  EXPECT_EQ(len, stored->length());
+  EXPECT_EQ(0, memcmp(packet_, stored->data(), len));
+  EXPECT_EQ(capture_time_ms, time);
+  EXPECT_EQ(kAllowRetransmission, type);
+
+  // Recently resent packets are found, but not returned.
+  hist_->UpdateResendTime(kSeqNum);
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 100, &stored, &time, &type));
+  EXPECT_TRUE(stored.get() == NULL);
+  EXPECT_FALSE(hist_->GetRTPPacket(kSeqNum + 1, 0, &stored, &time, &type));
+}
+
+TEST_F(RtpPacketHistoryTest, StoredPacketIsNotModifiedByHistory) {
+  hist_->SetStorePacketsStatus(true, 10);
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+  scoped_refptr<RTPPacketHistory::StoredPacket> stored;
+  int64_t time;
+  StorageType type;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &stored, &time, &type));
+
+  // Replacing the header must not change the packet we are holding on to.
+  uint16_t len_modified = 0;
+  uint8_t packet_modified[kMaxPacketLength];
+  CreateRtpPacket(kSeqNum, kSsrc + 1, kPayload, kTimestamp, packet_modified,
+                  &len_modified);
+  EXPECT_EQ(0, hist_->ReplaceRTPHeader(packet_modified, kSeqNum,
+                                       len_modified));
+  EXPECT_EQ(0, memcmp(packet_, stored->data(), len));
+
+  scoped_refptr<RTPPacketHistory::StoredPacket> replaced;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &replaced, &time, &type));
+  EXPECT_EQ(0, memcmp(packet_modified, replaced->data(), len_modified));
+
+  // Overwriting the slot must not release the packet we are holding on to.
+  for (uint16_t i = 1; i <= 16; ++i) {
+    len_modified = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_modified,
+                    &len_modified);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_modified, len_modified,
+                                     kMaxPacketLength, 1,
+                                     kAllowRetransmission));
+  }
+  EXPECT_FALSE(hist_->HasRTPPacket(kSeqNum));
+  EXPECT_EQ(0, memcmp(packet_, stored->data(), len));
+}
+
+TEST_F(RtpPacketHistoryTest, KeepsLastNumberToStorePackets) {
+  const uint16_t kNumberToStore = 10;
+  hist_->SetStorePacketsStatus(true, kNumberToStore);
+  // Start just before the sequence number wraps.
+  const uint16_t kStartSeqNum = 0xFFFF - 3;
+  for (uint16_t i = 0; i < 2 * kNumberToStore; ++i) {
+    uint16_t len = 0;
+    CreateRtpPacket(kStartSeqNum + i, kSsrc, kPayload, kTimestamp, packet_,
+                    &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                     kAllowRetransmission));
+  }
+  for (uint16_t i = 0; i < 2 * kNumberToStore; ++i) {
+    EXPECT_EQ(i >= kNumberToStore,
+              hist_->HasRTPPacket(kStartSeqNum + i)) << i;
+  }
+}
+
+// Stores a stream of video sized packets and resends 10% of them, once by
+// copying the packets out of the history and once by referencing them.
+TEST_F(RtpPacketHistoryTest, DISABLED_ResendBenchmark) {
+  const uint16_t kNumberToStore = 600;
+  const int kNumRounds = 500;
+  const int kLossPercent = 10;
+  hist_->SetStorePacketsStatus(true, kNumberToStore);
+  srand(0);
+  for (int i = 0; i < kMaxPacketLength; ++i) {
+    packet_[i] = rand();
+  }
+  std::vector<uint16_t> lost;
+  uint16_t seq_num = 0;
+  int64_t put_us = 0;
+  int64_t copy_us = 0;
+  int64_t ref_us = 0;
+  uint32_t checksum = 0;
+  int64_t time;
+  StorageType type;
+  for (int round = 0; round < kNumRounds; ++round) {
+    lost.clear();
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kNumberToStore; ++i, ++seq_num) {
+      uint16_t len = 0;
+      CreateRtpPacket(seq_num, kSsrc, kPayload, kTimestamp, packet_, &len);
+      len = 200 + (seq_num * 7919) % 1000;
+      hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                          kAllowRetransmission);
+      if (rand() % 100 < kLossPercent)
+        lost.push_back(seq_num);
+    }
+    put_us += (TickTime::Now() - start).Microseconds();
+
+    start = TickTime::Now();
+    for (size_t i = 0; i < lost.size(); ++i) {
+      uint16_t len_out = kMaxPacketLength;
+      hist_->GetRTPPacket(lost[i], 0, packet_out_, &len_out, &time, &type);
+      checksum += packet_out_[len_out - 1];
+    }
+    copy_us += (TickTime::Now() - start).Microseconds();
+
+    start = TickTime::Now();
+    for (size_t i = 0; i < lost.size(); ++i) {
+      scoped_refptr<RTPPacketHistory::StoredPacket> stored;
+      hist_->GetRTPPacket(lost[i], 0, &stored, &time, &type);
+      checksum -= stored->data()[stored->length() - 1];
+    }
+    ref_us += (TickTime::Now() - start).Microseconds();
+  }
+  EXPECT_EQ(0u, checksum);
+  printf("Store %d packets: %.3f ms\n", kNumRounds * kNumberToStore,
+         put_us / 1000.0);
+  printf("Resend %d%% by copy: %.3f ms\n", kLossPercent, copy_us / 1000.0);
+  printf("Resend %d%% by reference: %.3f ms\n", kLossPercent,
+         ref_us / 1000.0);
+}
 }  // namespace webrtc
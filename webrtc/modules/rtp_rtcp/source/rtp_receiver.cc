@@ -55,6 +55,7 @@ RTPReceiver::RTPReceiver(const int32_t id,
       packet_timeout_ms_(0),
 
       rtp_header_extension_map_(),
+      rtp_header_extension_types_(),
       ssrc_(0),
       num_csrcs_(0),
       current_remote_csrc_(),
@@ -255,18 +256,25 @@ int32_t RTPReceiver::RegisterRtpHeaderExtension(
     const RTPExtensionType type,
     const uint8_t id) {
   CriticalSectionScoped cs(critical_section_rtp_receiver_);
-  return rtp_header_extension_map_.Register(type, id);
+  int32_t ret_val = rtp_header_extension_map_.Register(type, id);
+  rtp_header_extension_types_ =
+      ModuleRTPUtility::RTPExtensionTypes(rtp_header_extension_map_);
+  return ret_val;
 }
 
 int32_t RTPReceiver::DeregisterRtpHeaderExtension(
     const RTPExtensionType type) {
   CriticalSectionScoped cs(critical_section_rtp_receiver_);
-  return rtp_header_extension_map_.Deregister(type);
+  int32_t ret_val = rtp_header_extension_map_.Deregister(type);
+  rtp_header_extension_types_ =
+      ModuleRTPUtility::RTPExtensionTypes(rtp_header_extension_map_);
+  return ret_val;
 }
 
-void RTPReceiver::GetHeaderExtensionMapCopy(RtpHeaderExtensionMap* map) const {
+void RTPReceiver::GetHeaderExtensionTypes(
+    ModuleRTPUtility::RTPExtensionTypes* types) const {
   CriticalSectionScoped cs(critical_section_rtp_receiver_);
-  rtp_header_extension_map_.GetCopy(map);
+  *types = rtp_header_extension_types_;
 }
 
 NACKMethod RTPReceiver::NACK() const {
@@ -138,7 +138,9 @@ class RTPReceiver : public Bitrate {
 
   int32_t DeregisterRtpHeaderExtension(const RTPExtensionType type);
 
-  void GetHeaderExtensionMapCopy(RtpHeaderExtensionMap* map) const;
+  // Copies the registered header extensions, for parsing incoming headers.
+  void GetHeaderExtensionTypes(
+      ModuleRTPUtility::RTPExtensionTypes* types) const;
 
   // RTX.
   void SetRTXStatus(bool enable, uint32_t ssrc);
@@ -189,6 +191,8 @@ class RTPReceiver : public Bitrate {
   uint32_t          packet_timeout_ms_;
 
   RtpHeaderExtensionMap   rtp_header_extension_map_;
+  // |rtp_header_extension_map_| indexed by id.
+  ModuleRTPUtility::RTPExtensionTypes rtp_header_extension_types_;
 
   // SSRCs.
   uint32_t            ssrc_;
@@ -47,6 +47,9 @@ enum { DTMF_OUTBAND_MAX         = 20};
 enum { RTP_MAX_BURST_SLEEP_TIME = 500 };
 enum { RTP_AUDIO_LEVEL_UNIQUE_ID = 0xbede };
 enum { RTP_MAX_PACKETS_PER_FRAME= 512 }; // must be multiple of 32
+// Most packets passed to the transport in one call, e.g. to be encrypted
+// together.
+enum { kRtpMaxPacketBatch = 16 };
 } // namespace webrtc
 
 
@@ -17,6 +17,7 @@
 #include "webrtc/modules/rtp_rtcp/source/rtp_receiver_audio.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_receiver_video.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 
 #ifdef MATLAB
@@ -609,6 +610,8 @@ int32_t ModuleRtpRtcpImpl::IncomingPacket(
                    "IncomingPacket invalid RTCP packet");
       return -1;
     }
+    RtcEventLog::LogRtcpPacket(id_, true, incoming_packet,
+                               incoming_packet_length);
     RTCPHelp::RTCPPacketInformation rtcp_packet_information;
     int32_t ret_val = rtcp_receiver_.IncomingRTCPPacket(
         rtcp_packet_information, &rtcp_parser);
@@ -621,10 +624,10 @@ int32_t ModuleRtpRtcpImpl::IncomingPacket(
     WebRtcRTPHeader rtp_header;
     memset(&rtp_header, 0, sizeof(rtp_header));
 
-    RtpHeaderExtensionMap map;
-    rtp_receiver_->GetHeaderExtensionMapCopy(&map);
+    ModuleRTPUtility::RTPExtensionTypes extension_types;
+    rtp_receiver_->GetHeaderExtensionTypes(&extension_types);
 
-    const bool valid_rtpheader = rtp_parser.Parse(rtp_header, &map);
+    const bool valid_rtpheader = rtp_parser.Parse(rtp_header, extension_types);
     if (!valid_rtpheader) {
       WEBRTC_TRACE(kTraceDebug,
                    kTraceRtpRtcp,
@@ -632,6 +635,8 @@ int32_t ModuleRtpRtcpImpl::IncomingPacket(
                    "IncomingPacket invalid RTP header");
       return -1;
     }
+    RtcEventLog::LogRtpHeader(id_, true, incoming_packet,
+                              incoming_packet_length);
     return rtp_receiver_->IncomingRTPPacket(&rtp_header,
                                             incoming_packet,
                                             incoming_packet_length);
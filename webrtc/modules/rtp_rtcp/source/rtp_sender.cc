@@ -17,6 +17,7 @@
 #include "webrtc/modules/rtp_rtcp/source/rtp_sender_audio.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_sender_video.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/system_wrappers/interface/trace_event.h"
 
@@ -402,7 +403,12 @@ int32_t RTPSender::SendPadData(
   }
   // Max in the RFC 3550 is 255 bytes, we limit it to be modulus 32 for SRTP.
   int max_length = 224;
-  uint8_t data_buffer[IP_PACKET_SIZE];
+  // The packets are sent in batches of up to kRtpMaxPacketBatch.
+  uint8_t data_buffers[kRtpMaxPacketBatch][IP_PACKET_SIZE];
+  uint8_t* packets[kRtpMaxPacketBatch];
+  int padding_lengths[kRtpMaxPacketBatch];
+  int num_packets = 0;
+  int header_length = 0;
 
   for (; bytes > 0; bytes -= max_length) {
     int padding_bytes_in_packet = max_length;
@@ -413,8 +419,9 @@ int32_t RTPSender::SendPadData(
       // Sanity don't send empty packets.
       break;
     }
+    uint8_t* data_buffer = data_buffers[num_packets];
     // Correct seq num, timestamp and payload type.
-    int header_length = BuildRTPheader(
+    header_length = BuildRTPheader(
                             data_buffer, payload_type, false,  // No markerbit.
                             capture_timestamp, true,  // Timestamp provided.
                             true);  // Increment sequence number.
@@ -429,15 +436,24 @@ int32_t RTPSender::SendPadData(
     // Set number of padding bytes in the last byte of the packet.
     data_buffer[header_length + padding_bytes_in_packet - 1] =
         padding_bytes_in_packet;
-    // Send the packet.
-    if (0 > SendToNetwork(data_buffer, padding_bytes_in_packet, header_length,
-                          capture_time_ms, kDontRetransmit)) {
-      // Error sending the packet.
-      break;
+    packets[num_packets] = data_buffer;
+    padding_lengths[num_packets] = padding_bytes_in_packet;
+    ++num_packets;
+    if (num_packets == kRtpMaxPacketBatch) {
+      // Send the packets.
+      if (0 > SendPacketsToNetwork(packets, padding_lengths, header_length,
+                                   capture_time_ms, kDontRetransmit,
+                                   IP_PACKET_SIZE, num_packets)) {
+        // Error sending the packets, we did not manage to send all bytes.
+        return -1;
+      }
+      num_packets = 0;
     }
   }
-  if (bytes > 31) {  // 31 due to our modulus 32.
-    // We did not manage to send all bytes.
+  if (num_packets > 0 &&
+      0 > SendPacketsToNetwork(packets, padding_lengths, header_length,
+                               capture_time_ms, kDontRetransmit,
+                               IP_PACKET_SIZE, num_packets)) {
     return -1;
   }
   return 0;
@@ -453,29 +469,32 @@ bool RTPSender::StorePackets() const {
 }
 
 int32_t RTPSender::ReSendPacket(uint16_t packet_id, uint32_t min_resend_time) {
-  uint16_t length = IP_PACKET_SIZE;
-  uint8_t data_buffer[IP_PACKET_SIZE];
-  uint8_t *buffer_to_send_ptr = data_buffer;
+  scoped_refptr<RTPPacketHistory::StoredPacket> stored_packet;
   int64_t capture_time_ms;
   StorageType type;
-  if (!packet_history_->GetRTPPacket(packet_id, min_resend_time, data_buffer,
-                                     &length, &capture_time_ms, &type)) {
+  if (!packet_history_->GetRTPPacket(packet_id, min_resend_time,
+                                     &stored_packet, &capture_time_ms,
+                                     &type)) {
     // Packet not found.
     return 0;
   }
-  if (length == 0 || type == kDontRetransmit) {
-    // No bytes copied (packet recently resent, skip resending) or
-    // packet should not be retransmitted.
+  if (stored_packet.get() == NULL || type == kDontRetransmit) {
+    // Packet recently resent (skip resending) or packet should not be
+    // retransmitted.
     return 0;
   }
+  // The stored packet is sent as is unless it has to be wrapped in RTX.
+  const uint8_t* buffer_to_send_ptr = stored_packet->data();
+  uint16_t length = stored_packet->length();
 
   uint8_t data_buffer_rtx[IP_PACKET_SIZE];
   if (rtx_ != kRtxOff) {
-    BuildRtxPacket(data_buffer, &length, data_buffer_rtx);
+    BuildRtxPacket(stored_packet->data(), &length, data_buffer_rtx);
     buffer_to_send_ptr = data_buffer_rtx;
   }
 
-  ModuleRTPUtility::RTPHeaderParser rtp_parser(data_buffer, length);
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(stored_packet->data(),
+                                               stored_packet->length());
   WebRtcRTPHeader rtp_header;
   rtp_parser.Parse(rtp_header);
 
@@ -507,17 +526,57 @@ int32_t RTPSender::ReSendPacket(uint16_t packet_id, uint32_t min_resend_time) {
     }
   }
 
-  if (SendPacketToNetwork(buffer_to_send_ptr, length)) {
+  // The RTX packet is ours to modify, the stored packet is shared with the
+  // packet history.
+  const bool sent = rtx_ != kRtxOff ?
+      SendWritablePacketToNetwork(data_buffer_rtx, length,
+                                  sizeof(data_buffer_rtx)) :
+      SendPacketToNetwork(buffer_to_send_ptr, length);
+  if (sent) {
     return 0;
   }
   return -1;
 }
 
 bool RTPSender::SendPacketToNetwork(const uint8_t *packet, uint32_t size) {
+  RtcEventLog::LogRtpHeader(id_, false, packet, size);
   int bytes_sent = -1;
   if (transport_) {
     bytes_sent = transport_->SendPacket(id_, packet, size);
   }
+  return CheckPacketSent(size, bytes_sent);
+}
+
+bool RTPSender::SendWritablePacketToNetwork(uint8_t *packet, uint32_t size,
+                                            int capacity) {
+  RtcEventLog::LogRtpHeader(id_, false, packet, size);
+  int bytes_sent = -1;
+  if (transport_) {
+    bytes_sent = transport_->SendWritablePacket(id_, packet, size, capacity);
+  }
+  return CheckPacketSent(size, bytes_sent);
+}
+
+bool RTPSender::SendWritablePacketsToNetwork(uint8_t* const* packets,
+                                             const int* sizes, int capacity,
+                                             int num_packets) {
+  int bytes_sent[kRtpMaxPacketBatch];
+  for (int i = 0; i < num_packets; ++i) {
+    RtcEventLog::LogRtpHeader(id_, false, packets[i], sizes[i]);
+    bytes_sent[i] = -1;
+  }
+  if (transport_) {
+    transport_->SendWritablePackets(id_, packets, sizes, capacity, bytes_sent,
+                                    num_packets);
+  }
+  bool sent = true;
+  for (int i = 0; i < num_packets; ++i) {
+    sent &= CheckPacketSent(sizes[i], bytes_sent[i]);
+  }
+  return sent;
+}
+
+bool RTPSender::CheckPacketSent(uint32_t size, int bytes_sent) {
   TRACE_EVENT_INSTANT2("webrtc_rtp", "RTPSender::SendPacketToNetwork",
                        "size", size, "sent", bytes_sent);
   // TODO(pwesin): Add a separate bitrate for sent bitrate after pacer.
@@ -649,40 +708,104 @@ void RTPSender::UpdateNACKBitRate(const uint32_t bytes,
 void RTPSender::TimeToSendPacket(uint16_t sequence_number,
                                  int64_t capture_time_ms) {
   StorageType type;
-  uint16_t length = IP_PACKET_SIZE;
-  uint8_t data_buffer[IP_PACKET_SIZE];
+  scoped_refptr<RTPPacketHistory::StoredPacket> stored_packet;
   int64_t stored_time_ms;
 
   if (packet_history_ == NULL) {
     return;
   }
-  if (!packet_history_->GetRTPPacket(sequence_number, 0, data_buffer, &length,
+  if (!packet_history_->GetRTPPacket(sequence_number, 0, &stored_packet,
                                      &stored_time_ms, &type)) {
     return;
   }
-  assert(length > 0);
+  assert(stored_packet.get() != NULL);
 
-  ModuleRTPUtility::RTPHeaderParser rtp_parser(data_buffer, length);
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(stored_packet->data(),
+                                               stored_packet->length());
   WebRtcRTPHeader rtp_header;
   rtp_parser.Parse(rtp_header);
   TRACE_EVENT_INSTANT2("webrtc_rtp", "RTPSender::TimeToSendPacket",
                        "timestamp", rtp_header.header.timestamp,
                        "seqnum", sequence_number);
 
+  // Only the RTP header is rewritten; the payload is sent straight from the
+  // packet history.
+  const uint16_t header_length = rtp_header.header.headerLength;
+  uint8_t header_buffer[IP_PACKET_SIZE];
+  memcpy(header_buffer, stored_packet->data(), header_length);
   int64_t diff_ms = clock_->TimeInMilliseconds() - capture_time_ms;
-  if (UpdateTransmissionTimeOffset(data_buffer, length, rtp_header, diff_ms)) {
+  if (UpdateTransmissionTimeOffset(header_buffer, header_length, rtp_header,
+                                   diff_ms)) {
     // Update stored packet in case of receiving a re-transmission request.
-    packet_history_->ReplaceRTPHeader(data_buffer,
+    // Drop our reference first so that the history can update the header in
+    // place rather than copying the packet.
+    stored_packet = NULL;
+    packet_history_->ReplaceRTPHeader(header_buffer,
                                       rtp_header.header.sequenceNumber,
-                                      rtp_header.header.headerLength);
+                                      header_length);
+    if (!packet_history_->GetRTPPacket(sequence_number, 0, &stored_packet,
+                                       &stored_time_ms, &type)) {
+      return;
+    }
   }
-  SendPacketToNetwork(data_buffer, length);
+  SendPacketToNetwork(stored_packet->data(), stored_packet->length());
 }
 
-// TODO(pwestin): send in the RTPHeaderParser to avoid parsing it again.
 int32_t RTPSender::SendToNetwork(
     uint8_t *buffer, int payload_length, int rtp_header_length,
-    int64_t capture_time_ms, StorageType storage) {
+    int64_t capture_time_ms, StorageType storage, int capacity) {
+  bool send_now = false;
+  if (!PrepareToSend(buffer, payload_length, rtp_header_length,
+                     capture_time_ms, storage, &send_now)) {
+    return -1;
+  }
+  if (!send_now) {
+    // We can't send the packet right now.
+    // We will be called when it is time.
+    return 0;
+  }
+  const uint32_t length = payload_length + rtp_header_length;
+  const bool sent = capacity > 0 ?
+      SendWritablePacketToNetwork(buffer, length, capacity) :
+      SendPacketToNetwork(buffer, length);
+  if (sent) {
+    return 0;
+  }
+  return -1;
+}
+
+int32_t RTPSender::SendPacketsToNetwork(
+    uint8_t* const* data_buffers, const int* payload_lengths,
+    int rtp_header_length, int64_t capture_time_ms, StorageType storage,
+    int capacity, int num_packets) {
+  assert(capacity > 0);
+  assert(num_packets <= kRtpMaxPacketBatch);
+  int32_t ret = 0;
+  uint8_t* packets[kRtpMaxPacketBatch];
+  int sizes[kRtpMaxPacketBatch];
+  int num_send_now = 0;
+  for (int i = 0; i < num_packets; ++i) {
+    bool send_now = false;
+    if (!PrepareToSend(data_buffers[i], payload_lengths[i], rtp_header_length,
+                       capture_time_ms, storage, &send_now)) {
+      ret = -1;
+    } else if (send_now) {
+      packets[num_send_now] = data_buffers[i];
+      sizes[num_send_now] = payload_lengths[i] + rtp_header_length;
+      ++num_send_now;
+    }
+  }
+  if (num_send_now > 0 &&
+      !SendWritablePacketsToNetwork(packets, sizes, capacity, num_send_now)) {
+    ret = -1;
+  }
+  return ret;
+}
+
+// TODO(pwestin): send in the RTPHeaderParser to avoid parsing it again.
+bool RTPSender::PrepareToSend(
+    uint8_t *buffer, int payload_length, int rtp_header_length,
+    int64_t capture_time_ms, StorageType storage, bool *send_now) {
   ModuleRTPUtility::RTPHeaderParser rtp_parser(
       buffer, payload_length + rtp_header_length);
   WebRtcRTPHeader rtp_header;
@@ -700,7 +823,7 @@ int32_t RTPSender::SendToNetwork(
   if (packet_history_->PutRTPPacket(buffer, rtp_header_length + payload_length,
                                     max_payload_length_, capture_time_ms,
                                     storage) != 0) {
-    return -1;
+    return false;
   }
 
   // Create and send RTX Packet.
@@ -710,7 +833,10 @@ int32_t RTPSender::SendToNetwork(
     uint16_t length_rtx = payload_length + rtp_header_length;
     uint8_t data_buffer_rtx[IP_PACKET_SIZE];
     BuildRtxPacket(buffer, &length_rtx, data_buffer_rtx);
-    if (!SendPacketToNetwork(data_buffer_rtx, length_rtx)) return -1;
+    if (!SendWritablePacketToNetwork(data_buffer_rtx, length_rtx,
+                                     sizeof(data_buffer_rtx))) {
+      return false;
+    }
     rtx_sent = true;
   }
   {
@@ -726,20 +852,12 @@ int32_t RTPSender::SendToNetwork(
     }
   }
 
-  if (paced_sender_ && storage != kDontStore) {
-    if (!paced_sender_->SendPacket(
-        PacedSender::kNormalPriority, rtp_header.header.ssrc,
-        rtp_header.header.sequenceNumber, capture_time_ms,
-        payload_length + rtp_header_length)) {
-      // We can't send the packet right now.
-      // We will be called when it is time.
-      return 0;
-    }
-  }
-  if (SendPacketToNetwork(buffer, payload_length + rtp_header_length)) {
-    return 0;
-  }
-  return -1;
+  *send_now = !paced_sender_ || storage == kDontStore ||
+      paced_sender_->SendPacket(
+          PacedSender::kNormalPriority, rtp_header.header.ssrc,
+          rtp_header.header.sequenceNumber, capture_time_ms,
+          payload_length + rtp_header_length);
+  return true;
 }
 
 void RTPSender::ProcessBitrate() {
@@ -1219,13 +1337,12 @@ int32_t RTPSender::SetFecParameters(
   return video_->SetFecParameters(delta_params, key_params);
 }
 
-void RTPSender::BuildRtxPacket(uint8_t* buffer, uint16_t* length,
+void RTPSender::BuildRtxPacket(const uint8_t* buffer, uint16_t* length,
                                uint8_t* buffer_rtx) {
   CriticalSectionScoped cs(send_critsect_);
   uint8_t* data_buffer_rtx = buffer_rtx;
   // Add RTX header.
-  ModuleRTPUtility::RTPHeaderParser rtp_parser(
-      reinterpret_cast<const uint8_t *>(buffer), *length);
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(buffer, *length);
 
   WebRtcRTPHeader rtp_header;
   rtp_parser.Parse(rtp_header);
@@ -55,9 +55,21 @@ class RTPSenderInterface {
   virtual uint16_t PacketOverHead() const = 0;
   virtual uint16_t ActualSendBitrateKbit() const = 0;
 
+  // Sends the packet in |data_buffer|. If |capacity| is non-zero,
+  // |data_buffer| has room for |capacity| bytes and isn't used by the caller
+  // after the call, so that the transport may modify the packet in place.
   virtual int32_t SendToNetwork(
       uint8_t *data_buffer, int payload_length, int rtp_header_length,
-      int64_t capture_time_ms, StorageType storage) = 0;
+      int64_t capture_time_ms, StorageType storage, int capacity) = 0;
+
+  // Sends the |num_packets| packets in |data_buffers|, at most
+  // kRtpMaxPacketBatch, like SendToNetwork() with a non-zero |capacity|. The
+  // packets which aren't paced are passed to the transport in one call.
+  // Returns -1 if any of the packets couldn't be sent.
+  virtual int32_t SendPacketsToNetwork(
+      uint8_t* const* data_buffers, const int* payload_lengths,
+      int rtp_header_length, int64_t capture_time_ms, StorageType storage,
+      int capacity, int num_packets) = 0;
 };
 
 class RTPSender : public Bitrate, public RTPSenderInterface {
@@ -196,7 +208,12 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
 
   virtual int32_t SendToNetwork(
       uint8_t *data_buffer, int payload_length, int rtp_header_length,
-      int64_t capture_time_ms, StorageType storage);
+      int64_t capture_time_ms, StorageType storage, int capacity);
+
+  virtual int32_t SendPacketsToNetwork(
+      uint8_t* const* data_buffers, const int* payload_lengths,
+      int rtp_header_length, int64_t capture_time_ms, StorageType storage,
+      int capacity, int num_packets);
 
   // Audio.
 
@@ -258,10 +275,25 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
                                         uint32_t capture_timestamp,
                                         int64_t capture_time_ms);
 
-  void BuildRtxPacket(uint8_t* buffer, uint16_t* length,
+  void BuildRtxPacket(const uint8_t* buffer, uint16_t* length,
                       uint8_t* buffer_rtx);
 
   bool SendPacketToNetwork(const uint8_t *packet, uint32_t size);
+  // Sends |packet| from a buffer of |capacity| bytes which isn't used after
+  // the call, allowing the transport to modify it in place.
+  bool SendWritablePacketToNetwork(uint8_t *packet, uint32_t size,
+                                   int capacity);
+  // Sends |num_packets| packets like SendWritablePacketToNetwork(), in one
+  // call to the transport.
+  bool SendWritablePacketsToNetwork(uint8_t* const* packets, const int* sizes,
+                                    int capacity, int num_packets);
+  // Stores the packet in |buffer| in the packet history, sends it on RTX and
+  // updates the send statistics. Sets |send_now| unless the packet was queued
+  // in the pacer, which will ask for it when it's time to send it.
+  bool PrepareToSend(uint8_t *buffer, int payload_length,
+                     int rtp_header_length, int64_t capture_time_ms,
+                     StorageType storage, bool *send_now);
+  bool CheckPacketSent(uint32_t size, int bytes_sent);
 
   int32_t id_;
   const bool audio_configured_;
@@ -41,6 +41,7 @@ class LoopbackTransportTest : public webrtc::Transport {
  public:
   LoopbackTransportTest()
     : packets_sent_(0),
+      batches_sent_(0),
       last_sent_packet_len_(0) {
   }
   virtual int SendPacket(int channel, const void *data, int len) {
@@ -52,7 +53,15 @@ class LoopbackTransportTest : public webrtc::Transport {
   virtual int SendRTCPPacket(int channel, const void *data, int len) {
     return -1;
   }
+  virtual void SendWritablePackets(int channel, unsigned char* const* data,
+                                   const int* len, int capacity,
+                                   int* bytes_sent, int num_packets) {
+    batches_sent_++;
+    Transport::SendWritablePackets(channel, data, len, capacity, bytes_sent,
+                                   num_packets);
+  }
   int packets_sent_;
+  int batches_sent_;
   int last_sent_packet_len_;
   uint8_t last_sent_packet_[kMaxPacketLength];
 };
@@ -200,7 +209,8 @@ TEST_F(RtpSenderTest, TrafficSmoothingWithTimeOffset) {
                                           0,
                                           rtp_length,
                                           capture_time_ms,
-                                          kAllowRetransmission));
+                                          kAllowRetransmission,
+                                          0));
 
   EXPECT_EQ(0, transport_.packets_sent_);
 
@@ -245,7 +255,8 @@ TEST_F(RtpSenderTest, TrafficSmoothingRetransmits) {
                                           0,
                                           rtp_length,
                                           capture_time_ms,
-                                          kAllowRetransmission));
+                                          kAllowRetransmission,
+                                          0));
 
   EXPECT_EQ(0, transport_.packets_sent_);
 
@@ -335,5 +346,33 @@ TEST_F(RtpSenderTest, SendGenericVideo) {
   EXPECT_EQ(0, memcmp(payload, payload_data, sizeof(payload)));
 }
 
+TEST_F(RtpSenderTest, SendsPacketsOfFrameInBatches) {
+  char payload_name[RTP_PAYLOAD_NAME_SIZE] = "GENERIC";
+  const uint8_t payload_type = 127;
+  ASSERT_EQ(0, rtp_sender_->RegisterPayload(payload_name, payload_type, 90000,
+                                            0, 1500));
+  // 1000 bytes of payload per packet, after the RTP and generic headers.
+  ASSERT_EQ(0, rtp_sender_->SetMaxPayloadLength(1000 + 12 + 1, 28));
+  const int kNumPackets = kRtpMaxPacketBatch + 5;
+  const int kPayloadSize = kNumPackets * 1000;
+  uint8_t payload[kPayloadSize];
+  memset(payload, 47, sizeof(payload));
+
+  ASSERT_EQ(0, rtp_sender_->SendOutgoingData(kVideoFrameKey, payload_type, 1234,
+                                             4321, payload, sizeof(payload),
+                                             NULL));
+  EXPECT_EQ(kNumPackets, transport_.packets_sent_);
+  EXPECT_EQ(2, transport_.batches_sent_);
+
+  // The last packet of the frame has the marker bit set.
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(transport_.last_sent_packet_,
+      transport_.last_sent_packet_len_);
+  webrtc::WebRtcRTPHeader rtp_header;
+  ASSERT_TRUE(rtp_parser.Parse(rtp_header));
+  EXPECT_TRUE(rtp_header.header.markerBit);
+  EXPECT_EQ(static_cast<uint16_t>(kSeqNum + kNumPackets - 1),
+            rtp_header.header.sequenceNumber);
+}
+
 }  // namespace webrtc
 
@@ -115,7 +115,8 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
                                 const uint32_t capture_timestamp,
                                 int64_t capture_time_ms,
                                 StorageType storage,
-                                bool protect) {
+                                bool protect,
+                                int capacity) {
   if(_fecEnabled) {
     int ret = 0;
     int fec_overhead_sent = 0;
@@ -134,7 +135,8 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
         red_packet->length() - rtp_header_length,
         rtp_header_length,
         capture_time_ms,
-        storage);
+        storage,
+        0);
 
     ret |= packet_success;
 
@@ -171,7 +173,8 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
           red_packet->length() - rtp_header_length,
           rtp_header_length,
           capture_time_ms,
-          storage);
+          storage,
+          0);
 
       ret |= packet_success;
 
@@ -192,13 +195,36 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
                                      payload_length,
                                      rtp_header_length,
                                      capture_time_ms,
-                                     storage);
+                                     storage,
+                                     capacity);
   if (ret == 0) {
     _videoBitrate.Update(payload_length + rtp_header_length);
   }
   return ret;
 }
 
+int32_t RTPSenderVideo::SendVideoPackets(uint8_t* const* data_buffers,
+                                         const int* payload_lengths,
+                                         const uint16_t rtp_header_length,
+                                         const uint32_t capture_timestamp,
+                                         int64_t capture_time_ms,
+                                         StorageType storage,
+                                         int num_packets) {
+  TRACE_EVENT_INSTANT2("webrtc_rtp", "Video::PacketBatch",
+                       "timestamp", capture_timestamp,
+                       "packets", num_packets);
+  int ret = _rtpSender.SendPacketsToNetwork(data_buffers, payload_lengths,
+                                            rtp_header_length,
+                                            capture_time_ms, storage,
+                                            IP_PACKET_SIZE, num_packets);
+  if (ret == 0) {
+    for (int i = 0; i < num_packets; ++i) {
+      _videoBitrate.Update(payload_lengths[i] + rtp_header_length);
+    }
+  }
+  return ret;
+}
+
 int32_t
 RTPSenderVideo::SendRTPIntraRequest()
 {
@@ -217,7 +243,8 @@ RTPSenderVideo::SendRTPIntraRequest()
     TRACE_EVENT_INSTANT1("webrtc_rtp",
                          "Video::IntraRequest",
                          "seqnum", _rtpSender.SequenceNumber());
-    return _rtpSender.SendToNetwork(data, 0, length, -1, kDontStore);
+    return _rtpSender.SendToNetwork(data, 0, length, -1, kDontStore,
+                                    sizeof(data));
 }
 
 int32_t
@@ -344,7 +371,12 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
   assert(payload_length <= max_length);
 
   // Fragment packet into packets of max MaxPayloadLength bytes payload.
-  uint8_t buffer[IP_PACKET_SIZE];
+  // Without FEC, they are sent in batches of up to kRtpMaxPacketBatch.
+  uint8_t buffers[kRtpMaxPacketBatch][IP_PACKET_SIZE];
+  uint8_t* batch[kRtpMaxPacketBatch];
+  int payload_lengths[kRtpMaxPacketBatch];
+  int num_batched = 0;
+  const bool fec_enabled = _fecEnabled;
 
   uint8_t generic_header = RtpFormatVideoGeneric::kFirstPacketBit;
   if (frame_type == kVideoFrameKey) {
@@ -356,6 +388,7 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
       payload_length = size;
     }
     size -= payload_length;
+    uint8_t* buffer = buffers[num_batched];
 
     // MarkerBit is 1 on final packet (bytes_to_send == 0)
     if (_rtpSender.BuildRTPheader(buffer, payload_type, size == 0,
@@ -374,10 +407,24 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
     memcpy(out_ptr, payload, payload_length);
     payload += payload_length;
 
-    if (SendVideoPacket(buffer, payload_length + 1, rtp_header_length,
-                        capture_timestamp, capture_time_ms,
-                        kAllowRetransmission, true)) {
-      return -1;
+    if (fec_enabled) {
+      if (SendVideoPacket(buffer, payload_length + 1, rtp_header_length,
+                          capture_timestamp, capture_time_ms,
+                          kAllowRetransmission, true, IP_PACKET_SIZE)) {
+        return -1;
+      }
+      continue;
+    }
+    batch[num_batched] = buffer;
+    payload_lengths[num_batched] = payload_length + 1;
+    ++num_batched;
+    if (size == 0 || num_batched == kRtpMaxPacketBatch) {
+      if (SendVideoPackets(batch, payload_lengths, rtp_header_length,
+                           capture_timestamp, capture_time_ms,
+                           kAllowRetransmission, num_batched)) {
+        return -1;
+      }
+      num_batched = 0;
     }
   }
   return 0;
@@ -439,10 +486,18 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
     // |rtpTypeHdr->VP8.temporalIdx| is zero for base layers, or -1 if the field
     // isn't used. We currently only protect base layers.
     bool protect = (rtpTypeHdr->VP8.temporalIdx < 1);
+    // Without FEC, the packets are sent in batches of up to
+    // kRtpMaxPacketBatch.
+    uint8_t dataBuffers[kRtpMaxPacketBatch][IP_PACKET_SIZE];
+    uint8_t* batch[kRtpMaxPacketBatch];
+    int payloadLengths[kRtpMaxPacketBatch];
+    int numBatched = 0;
+    const bool fecEnabled = _fecEnabled;
     while (!last)
     {
         // Write VP8 Payload Descriptor and VP8 payload.
-        uint8_t dataBuffer[IP_PACKET_SIZE] = {0};
+        uint8_t* dataBuffer = dataBuffers[numBatched];
+        memset(dataBuffer, 0, IP_PACKET_SIZE);
         int payloadBytesInPacket = 0;
         int packetStartPartition =
             packetizer.NextPacket(&dataBuffer[rtpHeaderLength],
@@ -457,6 +512,13 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
         // else
         if (packetStartPartition < 0)
         {
+            if (numBatched > 0)
+            {
+                // Send the packets already built.
+                SendVideoPackets(batch, payloadLengths, rtpHeaderLength,
+                                 captureTimeStamp, capture_time_ms, storage,
+                                 numBatched);
+            }
             return -1;
         }
 
@@ -464,13 +526,33 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
         // Set marker bit true if this is the last packet in frame.
         _rtpSender.BuildRTPheader(dataBuffer, payloadType, last,
             captureTimeStamp);
-        if (-1 == SendVideoPacket(dataBuffer, payloadBytesInPacket,
-                                  rtpHeaderLength, captureTimeStamp,
-                                  capture_time_ms, storage, protect))
+        if (fecEnabled)
+        {
+            if (-1 == SendVideoPacket(dataBuffer, payloadBytesInPacket,
+                                      rtpHeaderLength, captureTimeStamp,
+                                      capture_time_ms, storage, protect,
+                                      IP_PACKET_SIZE))
+            {
+              WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, _id,
+                           "RTPSenderVideo::SendVP8 failed to send packet "
+                           "number %d", _rtpSender.SequenceNumber());
+            }
+            continue;
+        }
+        batch[numBatched] = dataBuffer;
+        payloadLengths[numBatched] = payloadBytesInPacket;
+        ++numBatched;
+        if (last || numBatched == kRtpMaxPacketBatch)
         {
-          WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, _id,
-                       "RTPSenderVideo::SendVP8 failed to send packet number"
-                       " %d", _rtpSender.SequenceNumber());
+            if (-1 == SendVideoPackets(batch, payloadLengths,
+                                       rtpHeaderLength, captureTimeStamp,
+                                       capture_time_ms, storage, numBatched))
+            {
+              WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, _id,
+                           "RTPSenderVideo::SendVP8 failed to send packets "
+                           "up to number %d", _rtpSender.SequenceNumber());
+            }
+            numBatched = 0;
         }
     }
     return 0;
@@ -95,9 +95,21 @@ protected:
                                     const uint32_t capture_timestamp,
                                     int64_t capture_time_ms,
                                     StorageType storage,
-                                    bool protect);
+                                    bool protect,
+                                    int capacity);
 
 private:
+    // Sends the |numPackets| packets of a frame in |dataBuffers|, buffers of
+    // IP_PACKET_SIZE bytes, to the network in one batch. Only for packets
+    // which aren't sent with RED, i.e. when FEC is disabled.
+    int32_t SendVideoPackets(uint8_t* const* dataBuffers,
+                             const int* payloadLengths,
+                             const uint16_t rtpHeaderLength,
+                             const uint32_t capture_timestamp,
+                             int64_t capture_time_ms,
+                             StorageType storage,
+                             int numPackets);
+
     int32_t SendGeneric(const FrameType frame_type,
                         const int8_t payload_type,
                         const uint32_t capture_timestamp,
@@ -204,6 +204,44 @@ void RTPPayload::SetType(RtpVideoCodecTypes videoType) {
   }
 }
 
+RTPExtensionTypes::RTPExtensionTypes() {
+  for (int id = 0; id <= kRtpMaxExtensionId; ++id) {
+    type[id] = kRtpExtensionNone;
+  }
+}
+
+RTPExtensionTypes::RTPExtensionTypes(const RtpHeaderExtensionMap& map) {
+  for (int id = 0; id <= kRtpMaxExtensionId; ++id) {
+    type[id] = kRtpExtensionNone;
+  }
+  for (RTPExtensionType extension = map.First();
+       extension != kRtpExtensionNone;
+       extension = map.Next(extension)) {
+    uint8_t id = 0;
+    if (map.GetId(extension, &id) == 0 && id <= kRtpMaxExtensionId) {
+      type[id] = extension;
+    }
+  }
+}
+
+int ParseRTPHeaders(const uint8_t* const* packets,
+                    const uint16_t* lengths,
+                    int numPackets,
+                    const RTPExtensionTypes& extensionTypes,
+                    WebRtcRTPHeader* headers,
+                    bool* valid) {
+  int numValid = 0;
+  for (int i = 0; i < numPackets; ++i) {
+    memset(&headers[i], 0, sizeof(headers[i]));
+    RTPHeaderParser parser(packets[i], lengths[i]);
+    valid[i] = parser.Parse(headers[i], extensionTypes);
+    if (valid[i]) {
+      ++numValid;
+    }
+  }
+  return numValid;
+}
+
 RTPHeaderParser::RTPHeaderParser(const uint8_t* rtpData,
                                  const uint32_t rtpDataLength)
   : _ptrRTPDataBegin(rtpData),
@@ -290,6 +328,14 @@ bool RTPHeaderParser::RTCP() const {
 
 bool RTPHeaderParser::Parse(WebRtcRTPHeader& parsedPacket,
                             RtpHeaderExtensionMap* ptrExtensionMap) const {
+  if (!ptrExtensionMap) {
+    return Parse(parsedPacket, RTPExtensionTypes());
+  }
+  return Parse(parsedPacket, RTPExtensionTypes(*ptrExtensionMap));
+}
+
+bool RTPHeaderParser::Parse(WebRtcRTPHeader& parsedPacket,
+                            const RTPExtensionTypes& extensionTypes) const {
   const ptrdiff_t length = _ptrRTPDataEnd - _ptrRTPDataBegin;
 
   if (length < 12) {
@@ -385,7 +431,7 @@ bool RTPHeaderParser::Parse(WebRtcRTPHeader& parsedPacket,
     if (definedByProfile == kRtpOneByteHeaderExtensionId) {
       const uint8_t* ptrRTPDataExtensionEnd = ptr + XLen;
       ParseOneByteExtensionHeader(parsedPacket,
-                                  ptrExtensionMap,
+                                  extensionTypes,
                                   ptrRTPDataExtensionEnd,
                                   ptr);
     }
@@ -396,13 +442,9 @@ bool RTPHeaderParser::Parse(WebRtcRTPHeader& parsedPacket,
 
 void RTPHeaderParser::ParseOneByteExtensionHeader(
     WebRtcRTPHeader& parsedPacket,
-    const RtpHeaderExtensionMap* ptrExtensionMap,
+    const RTPExtensionTypes& extensionTypes,
     const uint8_t* ptrRTPDataExtensionEnd,
     const uint8_t* ptr) const {
-  if (!ptrExtensionMap) {
-    return;
-  }
-
   while (ptrRTPDataExtensionEnd - ptr > 0) {
     //  0
     //  0 1 2 3 4 5 6 7
@@ -420,14 +462,13 @@ void RTPHeaderParser::ParseOneByteExtensionHeader(
       return;
     }
 
-    RTPExtensionType type;
-    if (ptrExtensionMap->GetType(id, &type) != 0) {
-      WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
-                   "Failed to find extension id: %d", id);
+    if (ptrRTPDataExtensionEnd - ptr < len + 1) {
+      WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1,
+                   "Extension id: %d exceeds the extension header.", id);
       return;
     }
 
-    switch (type) {
+    switch (extensionTypes.type[id]) {
       case kRtpExtensionTransmissionTimeOffset: {
         if (len != 2) {
           WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1,
@@ -464,12 +505,15 @@ void RTPHeaderParser::ParseOneByteExtensionHeader(
         // const uint8_t level = (*ptr & 0x7f);
         // DEBUG_PRINT("RTP_AUDIO_LEVEL_UNIQUE_ID: ID=%u, len=%u, V=%u,
         // level=%u", ID, len, V, level);
+        ptr += len + 1;
         break;
       }
       default: {
+        // Unknown, or not implemented. Skip it and parse the rest, RFC 5285.
         WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
-                     "Extension type not implemented.");
-        return;
+                     "Skipping extension id: %d", id);
+        ptr += len + 1;
+        break;
       }
     }
     uint8_t num_bytes = ParsePaddingBytes(ptrRTPDataExtensionEnd, ptr);
@@ -116,6 +116,20 @@ namespace ModuleRTPUtility
      */
     uint32_t BufferToUWord32(const uint8_t* dataBuffer);
 
+    // Highest id of a one-byte RTP header extension, RFC 5285.
+    enum { kRtpMaxExtensionId = 14 };
+
+    // The registered one-byte header extensions indexed by id,
+    // kRtpExtensionNone for unused ids. Cheap to copy, and lets a header be
+    // parsed without any RtpHeaderExtensionMap lookups.
+    struct RTPExtensionTypes
+    {
+        RTPExtensionTypes();
+        explicit RTPExtensionTypes(const RtpHeaderExtensionMap& map);
+
+        RTPExtensionType type[kRtpMaxExtensionId + 1];
+    };
+
     class RTPHeaderParser
     {
     public:
@@ -126,11 +140,13 @@ namespace ModuleRTPUtility
         bool RTCP() const;
         bool Parse(WebRtcRTPHeader& parsedPacket,
                    RtpHeaderExtensionMap* ptrExtensionMap = NULL) const;
+        bool Parse(WebRtcRTPHeader& parsedPacket,
+                   const RTPExtensionTypes& extensionTypes) const;
 
     private:
         void ParseOneByteExtensionHeader(
             WebRtcRTPHeader& parsedPacket,
-            const RtpHeaderExtensionMap* ptrExtensionMap,
+            const RTPExtensionTypes& extensionTypes,
             const uint8_t* ptrRTPDataExtensionEnd,
             const uint8_t* ptr) const;
 
@@ -142,6 +158,16 @@ namespace ModuleRTPUtility
         const uint8_t* const _ptrRTPDataEnd;
     };
 
+    // Parses the headers of |numPackets| RTP packets into |headers|.
+    // |valid[i]| is set to whether |packets[i]| has a valid RTP header.
+    // Returns the number of valid headers.
+    int ParseRTPHeaders(const uint8_t* const* packets,
+                        const uint16_t* lengths,
+                        int numPackets,
+                        const RTPExtensionTypes& extensionTypes,
+                        WebRtcRTPHeader* headers,
+                        bool* valid);
+
     enum FrameTypes
     {
         kIFrame,    // key frame
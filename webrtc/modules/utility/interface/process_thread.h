@@ -19,7 +19,32 @@ class Module;
 class ProcessThread
 {
 public:
+    // Timing statistics for one registered module.
+    struct ModuleStats
+    {
+        ModuleStats()
+            : processCalls(0),
+              totalLateMs(0),
+              maxLateMs(0),
+              totalProcessTimeUs(0),
+              maxProcessTimeUs(0) {}
+
+        // Number of Process() calls made on the module.
+        uint32_t processCalls;
+        // How much later than requested by TimeUntilNextProcess() the
+        // Process() calls were made.
+        int64_t totalLateMs;
+        int64_t maxLateMs;
+        // Time spent inside Process().
+        int64_t totalProcessTimeUs;
+        int64_t maxProcessTimeUs;
+    };
+
     static ProcessThread* CreateProcessThread();
+    // Creates a process thread backed by |numThreads| threads. Registered
+    // modules are spread over the threads, and each module is always
+    // processed by the same thread.
+    static ProcessThread* CreateProcessThread(int numThreads);
     static void DestroyProcessThread(ProcessThread* module);
 
     virtual int32_t Start() = 0;
@@ -27,6 +52,22 @@ public:
 
     virtual int32_t RegisterModule(const Module* module) = 0;
     virtual int32_t DeRegisterModule(const Module* module) = 0;
+
+    // Makes the process thread call TimeUntilNextProcess() on |module| again.
+    // A module's TimeUntilNextProcess() is otherwise only polled after its
+    // Process() call, so this must be used when a module gets work that
+    // should be processed sooner than it previously reported. Doesn't block
+    // on ongoing Process() calls, so it may be called from any thread, also
+    // with locks held that the module itself takes in Process().
+    virtual int32_t WakeUp(const Module* /*module*/) { return -1; }
+
+    // Returns the timing statistics collected for |module| in |stats|.
+    virtual int32_t GetModuleStats(const Module* /*module*/,
+                                   ModuleStats* /*stats*/) const
+    {
+        return -1;
+    }
+
 protected:
     virtual ~ProcessThread();
 };
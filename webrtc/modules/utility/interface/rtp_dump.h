@@ -42,9 +42,27 @@ public:
     // Writes the RTP/RTCP packet in packet with length packetLength in bytes.
     // Note: packet should contain the RTP/RTCP part of the packet. I.e. the
     // first bytes of packet should be the RTP/RTCP header.
+    // The packet is copied and written to the file by a background thread,
+    // -1 is returned if it had to be dropped since the thread has fallen too
+    // far behind.
     virtual int32_t DumpPacket(const uint8_t* packet,
                                uint16_t packetLength) = 0;
 
+    // Records only the header of the RTP packets, including CSRCs and header
+    // extensions, leaving out the payload. RTCP packets are always recorded
+    // in full. Disabled by default.
+    virtual int32_t SetHeaderOnly(bool enable) = 0;
+
+    // Bounds the disk space used by the dump to maxFiles files of at most
+    // maxFileBytes bytes. When the file passed to Start() is full, it is
+    // renamed to <file>.1, an existing <file>.1 to <file>.2 and so on, the
+    // oldest file is deleted and recording continues in a new <file>. A
+    // maxFileBytes of 0, the default, disables the limit.
+    virtual int32_t SetMaxFileSize(uint32_t maxFileBytes, int maxFiles) = 0;
+
+    // Number of packets dropped by DumpPacket() since Start().
+    virtual uint32_t DroppedPackets() const = 0;
+
 protected:
     virtual ~RtpDump();
 };
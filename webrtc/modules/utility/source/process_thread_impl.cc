@@ -9,17 +9,35 @@
  */
 
 #include "process_thread_impl.h"
+
+#include <algorithm>
+
 #include "module.h"
+#include "tick_util.h"
 #include "trace.h"
 
 namespace webrtc {
+
+// Upper bound on how long a module is left alone without its
+// TimeUntilNextProcess() being polled.
+static const int64_t kMaxWaitTimeMs = 100;
+
 ProcessThread::~ProcessThread()
 {
 }
 
 ProcessThread* ProcessThread::CreateProcessThread()
 {
-    return new ProcessThreadImpl();
+    return new ProcessThreadImpl(1);
+}
+
+ProcessThread* ProcessThread::CreateProcessThread(int numThreads)
+{
+    if(numThreads < 1)
+    {
+        return NULL;
+    }
+    return new ProcessThreadImpl(numThreads);
 }
 
 void ProcessThread::DestroyProcessThread(ProcessThread* module)
@@ -27,24 +45,169 @@ void ProcessThread::DestroyProcessThread(ProcessThread* module)
     delete module;
 }
 
-ProcessThreadImpl::ProcessThreadImpl()
-    : _timeEvent(*EventWrapper::Create()),
-      _critSectModules(CriticalSectionWrapper::CreateCriticalSection()),
-      _thread(NULL)
+ProcessThreadImpl::ProcessThreadImpl(int numThreads)
+    : _critSectModules(CriticalSectionWrapper::CreateCriticalSection()),
+      _workers(numThreads),
+      _workerLoad(numThreads, 0)
 {
+    for(int i = 0; i < numThreads; i++)
+    {
+        _workers[i] = new Worker();
+    }
     WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s created", __FUNCTION__);
 }
 
 ProcessThreadImpl::~ProcessThreadImpl()
 {
+    for(size_t i = 0; i < _workers.size(); i++)
+    {
+        delete _workers[i];
+    }
     delete _critSectModules;
-    delete &_timeEvent;
     WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s deleted", __FUNCTION__);
 }
 
 int32_t ProcessThreadImpl::Start()
+{
+    for(size_t i = 0; i < _workers.size(); i++)
+    {
+        if(_workers[i]->Start() != 0)
+        {
+            // Leave the process thread in the stopped state.
+            for(size_t j = 0; j < i; j++)
+            {
+                _workers[j]->Stop();
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int32_t ProcessThreadImpl::Stop()
+{
+    // |_critSectModules| is not held here since the worker threads may need
+    // it from within Module::Process() while they are being joined.
+    int32_t retVal = 0;
+    for(size_t i = 0; i < _workers.size(); i++)
+    {
+        if(!_workers[i]->Stop())
+        {
+            retVal = -1;
+        }
+    }
+    return retVal;
+}
+
+// The workers are called without |_critSectModules| held. A module may call
+// into the process thread from its Process() method, which runs with the
+// worker lock held, and taking the locks in the opposite order here could
+// then deadlock.
+int32_t ProcessThreadImpl::RegisterModule(const Module* module)
+{
+    Worker* worker = NULL;
+    {
+        CriticalSectionScoped lock(_critSectModules);
+
+        // Only allow module to be registered once.
+        if(_moduleWorker.find(module) != _moduleWorker.end())
+        {
+            return -1;
+        }
+
+        // Assign the module to the thread with the fewest modules.
+        const int index = static_cast<int>(
+            std::min_element(_workerLoad.begin(), _workerLoad.end()) -
+            _workerLoad.begin());
+        _moduleWorker[module] = index;
+        _workerLoad[index]++;
+        worker = _workers[index];
+
+        WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
+                     "number of registered modules has increased to %d",
+                     static_cast<int>(_moduleWorker.size()));
+    }
+    worker->AddModule(const_cast<Module*>(module));
+    return 0;
+}
+
+int32_t ProcessThreadImpl::DeRegisterModule(const Module* module)
+{
+    Worker* worker = NULL;
+    {
+        CriticalSectionScoped lock(_critSectModules);
+
+        std::map<const Module*, int>::iterator it = _moduleWorker.find(module);
+        if(it == _moduleWorker.end())
+        {
+            return -1;
+        }
+        worker = _workers[it->second];
+        _workerLoad[it->second]--;
+        _moduleWorker.erase(it);
+
+        WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
+                     "number of registered modules has decreased to %d",
+                     static_cast<int>(_moduleWorker.size()));
+    }
+    // Blocks until an ongoing Process() call on the module has returned.
+    worker->RemoveModule(const_cast<Module*>(module));
+    return 0;
+}
+
+int32_t ProcessThreadImpl::WakeUp(const Module* module)
+{
+    Worker* worker = WorkerForModule(module);
+    if(!worker)
+    {
+        return -1;
+    }
+    worker->WakeUp(const_cast<Module*>(module));
+    return 0;
+}
+
+int32_t ProcessThreadImpl::GetModuleStats(const Module* module,
+                                          ModuleStats* stats) const
+{
+    Worker* worker = WorkerForModule(module);
+    if(!worker || !stats)
+    {
+        return -1;
+    }
+    return worker->GetModuleStats(const_cast<Module*>(module), stats) ? 0 : -1;
+}
+
+ProcessThreadImpl::Worker* ProcessThreadImpl::WorkerForModule(
+    const Module* module) const
 {
     CriticalSectionScoped lock(_critSectModules);
+    std::map<const Module*, int>::const_iterator it =
+        _moduleWorker.find(module);
+    if(it == _moduleWorker.end())
+    {
+        return NULL;
+    }
+    return _workers[it->second];
+}
+
+ProcessThreadImpl::Worker::Worker()
+    : _timeEvent(*EventWrapper::Create()),
+      _critSect(CriticalSectionWrapper::CreateCriticalSection()),
+      _thread(NULL),
+      _critSectWakeUp(CriticalSectionWrapper::CreateCriticalSection())
+{
+}
+
+ProcessThreadImpl::Worker::~Worker()
+{
+    delete _critSectWakeUp;
+    delete _critSect;
+    delete &_timeEvent;
+}
+
+int32_t ProcessThreadImpl::Worker::Start()
+{
+    CriticalSectionScoped lock(_critSect);
     if(_thread)
     {
         return -1;
@@ -62,127 +225,193 @@ int32_t ProcessThreadImpl::Start()
     return -1;
 }
 
-int32_t ProcessThreadImpl::Stop()
+bool ProcessThreadImpl::Worker::Stop()
 {
-    _critSectModules->Enter();
-    if(_thread)
+    _critSect->Enter();
+    if(!_thread)
     {
-        _thread->SetNotAlive();
+        _critSect->Leave();
+        return true;
+    }
+    _thread->SetNotAlive();
 
-        ThreadWrapper* thread = _thread;
-        _thread = NULL;
+    ThreadWrapper* thread = _thread;
+    _thread = NULL;
 
-        _timeEvent.Set();
-        _critSectModules->Leave();
+    _timeEvent.Set();
+    _critSect->Leave();
 
-        if(thread->Stop())
-        {
-            delete thread;
-        } else {
-            return -1;
-        }
-    } else {
-        _critSectModules->Leave();
+    if(!thread->Stop())
+    {
+        return false;
     }
-    return 0;
+    delete thread;
+    return true;
 }
 
-int32_t ProcessThreadImpl::RegisterModule(const Module* module)
+// The module is scheduled by the worker thread, as if woken up. Polling its
+// TimeUntilNextProcess() here would call into the module on the registering
+// thread with |_critSect| held, while the caller may hold locks of its own.
+void ProcessThreadImpl::Worker::AddModule(Module* module)
 {
-    CriticalSectionScoped lock(_critSectModules);
+    CriticalSectionScoped lock(_critSect);
+    _modules[module].nextProcessTime = 0;
+    CriticalSectionScoped lockWakeUp(_critSectWakeUp);
+    if(_wokenModules.insert(module).second && _wokenModules.size() == 1)
+    {
+        _timeEvent.Set();
+    }
+}
 
-    // Only allow module to be registered once.
-    ListItem* item = _modules.First();
-    for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+void ProcessThreadImpl::Worker::RemoveModule(Module* module)
+{
+    CriticalSectionScoped lock(_critSect);
+    ModuleMap::iterator it = _modules.find(module);
+    if(it == _modules.end())
     {
-        if(module == item->GetItem())
-        {
-            return -1;
-        }
-        item = _modules.Next(item);
+        return;
     }
+    _queue.erase(std::make_pair(it->second.nextProcessTime, module));
+    _modules.erase(it);
+    CriticalSectionScoped lockWakeUp(_critSectWakeUp);
+    _wokenModules.erase(module);
+}
 
-    _modules.PushFront(module);
-    WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
-                 "number of registered modules has increased to %d",
-                 _modules.GetSize());
-    // Wake the thread calling ProcessThreadImpl::Process() to update the
-    // waiting time. The waiting time for the just registered module may be
-    // shorter than all other registered modules.
-    _timeEvent.Set();
-    return 0;
+// The module is rescheduled by the worker thread, so this may be called from
+// any thread, also while holding locks the module takes in Process().
+void ProcessThreadImpl::Worker::WakeUp(Module* module)
+{
+    CriticalSectionScoped lock(_critSectWakeUp);
+    if(_wokenModules.insert(module).second && _wokenModules.size() == 1)
+    {
+        _timeEvent.Set();
+    }
 }
 
-int32_t ProcessThreadImpl::DeRegisterModule(const Module* module)
+bool ProcessThreadImpl::Worker::GetModuleStats(Module* module,
+                                               ModuleStats* stats) const
 {
-    CriticalSectionScoped lock(_critSectModules);
+    CriticalSectionScoped lock(_critSect);
+    ModuleMap::const_iterator it = _modules.find(module);
+    if(it == _modules.end())
+    {
+        return false;
+    }
+    *stats = it->second.stats;
+    return true;
+}
 
-    ListItem* item = _modules.First();
-    for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+void ProcessThreadImpl::Worker::Schedule(Module* module, ModuleEntry* entry)
+{
+    _queue.erase(std::make_pair(entry->nextProcessTime, module));
+    int64_t timeToNext = module->TimeUntilNextProcess();
+    timeToNext = std::max<int64_t>(0, std::min(timeToNext, kMaxWaitTimeMs));
+    entry->nextProcessTime = TickTime::MillisecondTimestamp() + timeToNext;
+    std::pair<ProcessQueue::iterator, bool> inserted =
+        _queue.insert(std::make_pair(entry->nextProcessTime, module));
+    if(inserted.first == _queue.begin())
+    {
+        // Wake the thread to update the waiting time. The waiting time for
+        // this module may be shorter than for all other modules.
+        _timeEvent.Set();
+    }
+}
+
+void ProcessThreadImpl::Worker::ScheduleWokenModules()
+{
     {
-        if(module == item->GetItem())
+        CriticalSectionScoped lock(_critSectWakeUp);
+        _wokenScratch.assign(_wokenModules.begin(), _wokenModules.end());
+        _wokenModules.clear();
+    }
+    for(size_t i = 0; i < _wokenScratch.size(); i++)
+    {
+        ModuleMap::iterator it = _modules.find(_wokenScratch[i]);
+        if(it != _modules.end())
         {
-            int res = _modules.Erase(item);
-            WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
-                         "number of registered modules has decreased to %d",
-                         _modules.GetSize());
-            return res;
+            Schedule(it->first, &it->second);
         }
-        item = _modules.Next(item);
     }
-    return -1;
 }
 
-bool ProcessThreadImpl::Run(void* obj)
+bool ProcessThreadImpl::Worker::Run(void* obj)
 {
-    return static_cast<ProcessThreadImpl*>(obj)->Process();
+    return static_cast<Worker*>(obj)->Process();
 }
 
-bool ProcessThreadImpl::Process()
+bool ProcessThreadImpl::Worker::Process()
 {
     // Wait for the module that should be called next, but don't block thread
-    // longer than 100 ms.
-    int32_t minTimeToNext = 100;
+    // longer than kMaxWaitTimeMs.
+    int64_t timeToNext = kMaxWaitTimeMs;
+    int64_t now = TickTime::MillisecondTimestamp();
     {
-        CriticalSectionScoped lock(_critSectModules);
-        ListItem* item = _modules.First();
-        for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+        CriticalSectionScoped lock(_critSect);
+        ScheduleWokenModules();
+        if(!_queue.empty())
         {
-            int32_t timeToNext =
-                static_cast<Module*>(item->GetItem())->TimeUntilNextProcess();
-            if(minTimeToNext > timeToNext)
-            {
-                minTimeToNext = timeToNext;
-            }
-            item = _modules.Next(item);
+            timeToNext = _queue.begin()->first - now;
         }
     }
 
-    if(minTimeToNext > 0)
+    if(timeToNext > 0)
     {
-        if(kEventError == _timeEvent.Wait(minTimeToNext))
+        if(kEventError == _timeEvent.Wait(static_cast<unsigned long>(
+                              timeToNext)))
         {
             return true;
         }
-        CriticalSectionScoped lock(_critSectModules);
+        CriticalSectionScoped lock(_critSect);
         if(!_thread)
         {
             return false;
         }
+        now = TickTime::MillisecondTimestamp();
     }
+
+    // The lock is held while modules are processed so that RemoveModule()
+    // doesn't return while the module is being used.
+    CriticalSectionScoped lock(_critSect);
+    ScheduleWokenModules();
+    _dueModules.clear();
+    for(ProcessQueue::iterator it = _queue.begin();
+        it != _queue.end() && it->first <= now; ++it)
     {
-        CriticalSectionScoped lock(_critSectModules);
-        ListItem* item = _modules.First();
-        for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+        _dueModules.push_back(it->second);
+    }
+    for(size_t i = 0; i < _dueModules.size(); i++)
+    {
+        Module* module = _dueModules[i];
+        // An earlier module may have deregistered this one from its
+        // Process() call.
+        ModuleMap::iterator it = _modules.find(module);
+        if(it == _modules.end())
         {
-            int32_t timeToNext =
-                static_cast<Module*>(item->GetItem())->TimeUntilNextProcess();
-            if(timeToNext < 1)
-            {
-                static_cast<Module*>(item->GetItem())->Process();
-            }
-            item = _modules.Next(item);
+            continue;
         }
+        const int64_t lateMs = now - it->second.nextProcessTime;
+
+        const int64_t startUs = TickTime::MicrosecondTimestamp();
+        module->Process();
+        const int64_t processTimeUs =
+            TickTime::MicrosecondTimestamp() - startUs;
+
+        // The module may have deregistered itself, which invalidates |it|.
+        it = _modules.find(module);
+        if(it == _modules.end())
+        {
+            continue;
+        }
+        ModuleEntry& entry = it->second;
+        ModuleStats& stats = entry.stats;
+        stats.processCalls++;
+        stats.totalLateMs += lateMs;
+        stats.maxLateMs = std::max(stats.maxLateMs, lateMs);
+        stats.totalProcessTimeUs += processTimeUs;
+        stats.maxProcessTimeUs = std::max(stats.maxProcessTimeUs,
+                                          processTimeUs);
+
+        Schedule(module, &entry);
     }
     return true;
 }
@@ -11,9 +11,13 @@
 #ifndef WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 #define WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "critical_section_wrapper.h"
 #include "event_wrapper.h"
-#include "list_wrapper.h"
 #include "process_thread.h"
 #include "thread_wrapper.h"
 #include "typedefs.h"
@@ -22,7 +26,7 @@ namespace webrtc {
 class ProcessThreadImpl : public ProcessThread
 {
 public:
-    ProcessThreadImpl();
+    explicit ProcessThreadImpl(int numThreads);
     virtual ~ProcessThreadImpl();
 
     virtual int32_t Start();
@@ -31,16 +35,73 @@ public:
     virtual int32_t RegisterModule(const Module* module);
     virtual int32_t DeRegisterModule(const Module* module);
 
-protected:
-    static bool Run(void* obj);
-
-    bool Process();
+    virtual int32_t WakeUp(const Module* module);
+    virtual int32_t GetModuleStats(const Module* module,
+                                   ModuleStats* stats) const;
 
 private:
-    EventWrapper&           _timeEvent;
+    // Runs the modules of one shard on its own thread. The modules are kept
+    // in a queue ordered by the time they next want to be processed, so a
+    // wakeup only touches the modules that are due.
+    class Worker
+    {
+    public:
+        Worker();
+        ~Worker();
+
+        int32_t Start();
+        // Returns false if the thread could not be stopped.
+        bool Stop();
+
+        void AddModule(Module* module);
+        void RemoveModule(Module* module);
+        void WakeUp(Module* module);
+        bool GetModuleStats(Module* module, ModuleStats* stats) const;
+
+    private:
+        struct ModuleEntry
+        {
+            int64_t nextProcessTime;
+            ModuleStats stats;
+        };
+        typedef std::map<Module*, ModuleEntry> ModuleMap;
+        typedef std::set<std::pair<int64_t, Module*> > ProcessQueue;
+
+        static bool Run(void* obj);
+        bool Process();
+
+        // Polls |module| for its next process time and (re)inserts it in the
+        // queue. Wakes the thread if it becomes the first module in the
+        // queue. Must be called on the worker thread with |_critSect| held.
+        void Schedule(Module* module, ModuleEntry* entry);
+
+        // Reschedules the modules woken up since the last call. Must be
+        // called with |_critSect| held.
+        void ScheduleWokenModules();
+
+        EventWrapper&           _timeEvent;
+        CriticalSectionWrapper* _critSect;
+        ThreadWrapper*          _thread;
+        ModuleMap               _modules;
+        ProcessQueue            _queue;
+        // Scratch list of the modules due in the current Process() call.
+        std::vector<Module*>    _dueModules;
+        // Modules woken up by WakeUp(). They are kept under a lock of their
+        // own, which is never held while calling out of the worker, so that
+        // WakeUp() doesn't block while modules are being processed.
+        CriticalSectionWrapper* _critSectWakeUp;
+        std::set<Module*>       _wokenModules;
+        std::vector<Module*>    _wokenScratch;
+    };
+
+    Worker* WorkerForModule(const Module* module) const;
+
     CriticalSectionWrapper* _critSectModules;
-    ListWrapper             _modules;
-    ThreadWrapper*          _thread;
+    std::vector<Worker*>    _workers;
+    // The worker index each registered module is assigned to.
+    std::map<const Module*, int> _moduleWorker;
+    // Number of modules assigned to each worker.
+    std::vector<int>        _workerLoad;
 };
 } // namespace webrtc
 
@@ -0,0 +1,311 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "atomic32.h"
+#include "event_wrapper.h"
+#include "module.h"
+#include "process_thread.h"
+#include "scoped_ptr.h"
+#include "sleep.h"
+#include "thread_wrapper.h"
+#include "tick_util.h"
+
+namespace webrtc {
+namespace {
+
+// Module that asks to be processed every |interval_ms| and signals |event|
+// once it has been processed |signal_after| times.
+class FakeModule : public Module {
+ public:
+  FakeModule(int interval_ms, int signal_after, EventWrapper* event)
+      : interval_ms_(interval_ms),
+        signal_after_(signal_after),
+        event_(event),
+        last_process_time_(TickTime::MillisecondTimestamp()) {
+  }
+
+  virtual int32_t TimeUntilNextProcess() {
+    return static_cast<int32_t>(interval_ms_.Value() -
+        (TickTime::MillisecondTimestamp() - last_process_time_));
+  }
+
+  virtual int32_t Process() {
+    last_process_time_ = TickTime::MillisecondTimestamp();
+    if (++process_calls_ == signal_after_ && event_) {
+      event_->Set();
+    }
+    return 0;
+  }
+
+  void set_interval_ms(int interval_ms) {
+    interval_ms_ += interval_ms - interval_ms_.Value();
+  }
+  int process_calls() const { return process_calls_.Value(); }
+
+ private:
+  Atomic32 interval_ms_;
+  const int signal_after_;
+  EventWrapper* event_;
+  int64_t last_process_time_;
+  Atomic32 process_calls_;
+};
+
+// Module whose first Process() call signals |entered| and then blocks until
+// |release| is set.
+class BlockingModule : public Module {
+ public:
+  BlockingModule(EventWrapper* entered, EventWrapper* release)
+      : entered_(entered), release_(release), blocked_(false) {}
+
+  virtual int32_t TimeUntilNextProcess() { return blocked_ ? 1000 : 0; }
+  virtual int32_t Process() {
+    if (!blocked_) {
+      blocked_ = true;
+      entered_->Set();
+      release_->Wait(1000);
+    }
+    return 0;
+  }
+
+ private:
+  EventWrapper* entered_;
+  EventWrapper* release_;
+  bool blocked_;
+};
+
+// Module that deregisters |target| from |thread| in its first Process() call.
+class DeregisteringModule : public Module {
+ public:
+  DeregisteringModule(ProcessThread* thread, FakeModule* target)
+      : thread_(thread), target_(target), target_calls_(-1) {}
+
+  virtual int32_t TimeUntilNextProcess() { return 0; }
+  virtual int32_t Process() {
+    if (target_calls_ < 0) {
+      target_calls_ = target_ ? target_->process_calls() : 0;
+      thread_->DeRegisterModule(target_ ? static_cast<Module*>(target_) :
+                                          this);
+    }
+    return 0;
+  }
+
+  // Number of Process() calls of the target when it was deregistered.
+  int target_calls() const { return target_calls_; }
+
+ private:
+  ProcessThread* thread_;
+  FakeModule* target_;
+  int target_calls_;
+};
+
+// Module that records the thread its TimeUntilNextProcess() is called on.
+class ThreadCheckingModule : public Module {
+ public:
+  explicit ThreadCheckingModule(EventWrapper* event)
+      : event_(event), thread_id_(0) {}
+
+  virtual int32_t TimeUntilNextProcess() {
+    thread_id_ = ThreadWrapper::GetThreadId();
+    event_->Set();
+    return 1000;
+  }
+  virtual int32_t Process() { return 0; }
+
+  uint32_t thread_id() const { return thread_id_; }
+
+ private:
+  EventWrapper* event_;
+  uint32_t thread_id_;
+};
+
+}  // namespace
+
+TEST(ProcessThreadTest, RegisterModuleOnlyOnce) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  FakeModule module(1000, 1, NULL);
+  EXPECT_EQ(0, thread->RegisterModule(&module));
+  EXPECT_EQ(-1, thread->RegisterModule(&module));
+  EXPECT_EQ(0, thread->DeRegisterModule(&module));
+  EXPECT_EQ(-1, thread->DeRegisterModule(&module));
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ProcessThreadTest, CreateWithoutThreadsFails) {
+  EXPECT_TRUE(ProcessThread::CreateProcessThread(0) == NULL);
+}
+
+TEST(ProcessThreadTest, ProcessesModulesOnAllThreads) {
+  const int kNumThreads = 4;
+  const int kNumModules = 16;
+  ProcessThread* thread = ProcessThread::CreateProcessThread(kNumThreads);
+  scoped_ptr<EventWrapper> events[kNumModules];
+  std::vector<FakeModule*> modules;
+  for (int i = 0; i < kNumModules; ++i) {
+    events[i].reset(EventWrapper::Create());
+    modules.push_back(new FakeModule(5, 3, events[i].get()));
+    EXPECT_EQ(0, thread->RegisterModule(modules[i]));
+  }
+  EXPECT_EQ(0, thread->Start());
+  for (int i = 0; i < kNumModules; ++i) {
+    EXPECT_EQ(kEventSignaled, events[i]->Wait(1000));
+  }
+  EXPECT_EQ(0, thread->Stop());
+  for (int i = 0; i < kNumModules; ++i) {
+    ProcessThread::ModuleStats stats;
+    EXPECT_EQ(0, thread->GetModuleStats(modules[i], &stats));
+    EXPECT_EQ(static_cast<uint32_t>(modules[i]->process_calls()),
+              stats.processCalls);
+    EXPECT_GE(stats.maxLateMs, 0);
+    EXPECT_EQ(0, thread->DeRegisterModule(modules[i]));
+    delete modules[i];
+  }
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ProcessThreadTest, WakeUpReschedulesModule) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  scoped_ptr<EventWrapper> event(EventWrapper::Create());
+  // The module first asks to be processed in 100 ms, the maximum wait time.
+  FakeModule module(100, 1, event.get());
+  EXPECT_EQ(0, thread->RegisterModule(&module));
+  EXPECT_EQ(0, thread->Start());
+  module.set_interval_ms(10);
+  EXPECT_EQ(0, thread->WakeUp(&module));
+  EXPECT_EQ(kEventSignaled, event->Wait(50));
+  EXPECT_EQ(0, thread->Stop());
+  EXPECT_EQ(0, thread->DeRegisterModule(&module));
+  FakeModule unregistered(100, 1, NULL);
+  EXPECT_EQ(-1, thread->WakeUp(&unregistered));
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ProcessThreadTest, WakeUpDoesNotWaitForProcess) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  scoped_ptr<EventWrapper> entered(EventWrapper::Create());
+  scoped_ptr<EventWrapper> release(EventWrapper::Create());
+  scoped_ptr<EventWrapper> event(EventWrapper::Create());
+  BlockingModule blocking(entered.get(), release.get());
+  FakeModule module(100, 1, event.get());
+  EXPECT_EQ(0, thread->RegisterModule(&blocking));
+  EXPECT_EQ(0, thread->RegisterModule(&module));
+  EXPECT_EQ(0, thread->Start());
+  ASSERT_EQ(kEventSignaled, entered->Wait(1000));
+
+  // The single process thread is busy in the blocking module.
+  module.set_interval_ms(10);
+  const int64_t start_ms = TickTime::MillisecondTimestamp();
+  EXPECT_EQ(0, thread->WakeUp(&module));
+  EXPECT_LT(TickTime::MillisecondTimestamp() - start_ms, 100);
+
+  // The woken module is processed once the thread is available.
+  release->Set();
+  EXPECT_EQ(kEventSignaled, event->Wait(500));
+  EXPECT_EQ(0, thread->Stop());
+  EXPECT_EQ(0, thread->DeRegisterModule(&blocking));
+  EXPECT_EQ(0, thread->DeRegisterModule(&module));
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ProcessThreadTest, ModuleCanDeregisterItselfFromProcess) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  DeregisteringModule module(thread, NULL);
+  EXPECT_EQ(0, thread->RegisterModule(&module));
+  EXPECT_EQ(0, thread->Start());
+  SleepMs(50);
+  EXPECT_EQ(0, thread->Stop());
+  EXPECT_EQ(0, module.target_calls());
+  EXPECT_EQ(-1, thread->DeRegisterModule(&module));
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ProcessThreadTest, ModuleDeregisteredFromProcessIsNotProcessed) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  FakeModule target(0, 0, NULL);
+  DeregisteringModule module(thread, &target);
+  EXPECT_EQ(0, thread->RegisterModule(&target));
+  EXPECT_EQ(0, thread->RegisterModule(&module));
+  EXPECT_EQ(0, thread->Start());
+  SleepMs(50);
+  EXPECT_EQ(0, thread->Stop());
+  ASSERT_GE(module.target_calls(), 0);
+  EXPECT_EQ(module.target_calls(), target.process_calls());
+  EXPECT_EQ(-1, thread->DeRegisterModule(&target));
+  EXPECT_EQ(0, thread->DeRegisterModule(&module));
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ProcessThreadTest, RegisterModuleDoesNotCallModule) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  scoped_ptr<EventWrapper> event(EventWrapper::Create());
+  ThreadCheckingModule module(event.get());
+  EXPECT_EQ(0, thread->RegisterModule(&module));
+  EXPECT_EQ(kEventTimeout, event->Wait(50));
+  EXPECT_EQ(0, thread->Start());
+  ASSERT_EQ(kEventSignaled, event->Wait(1000));
+  EXPECT_NE(ThreadWrapper::GetThreadId(), module.thread_id());
+  EXPECT_EQ(0, thread->Stop());
+  EXPECT_EQ(0, thread->DeRegisterModule(&module));
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+// Benchmark for many modules with a short process interval. Reports how late
+// the modules are processed on average and the time spent in the process
+// threads per Process() call.
+TEST(ProcessThreadTest, DISABLED_ManyModulesBenchmark) {
+  const int kNumModules = 500;
+  const int kIntervalMs = 5;
+  const int kRunTimeMs = 500;
+  const int kThreadCounts[] = { 1, 4 };
+  for (size_t t = 0; t < sizeof(kThreadCounts) / sizeof(kThreadCounts[0]);
+       ++t) {
+    ProcessThread* thread =
+        ProcessThread::CreateProcessThread(kThreadCounts[t]);
+    std::vector<FakeModule*> modules;
+    for (int i = 0; i < kNumModules; ++i) {
+      modules.push_back(new FakeModule(kIntervalMs, 0, NULL));
+      thread->RegisterModule(modules[i]);
+    }
+    thread->Start();
+    SleepMs(kRunTimeMs);
+    thread->Stop();
+
+    int64_t calls = 0;
+    int64_t late_ms = 0;
+    int64_t max_late_ms = 0;
+    int64_t process_time_us = 0;
+    for (int i = 0; i < kNumModules; ++i) {
+      ProcessThread::ModuleStats stats;
+      thread->GetModuleStats(modules[i], &stats);
+      calls += stats.processCalls;
+      late_ms += stats.totalLateMs;
+      max_late_ms = std::max(max_late_ms, stats.maxLateMs);
+      process_time_us += stats.totalProcessTimeUs;
+      thread->DeRegisterModule(modules[i]);
+      delete modules[i];
+    }
+    ProcessThread::DestroyProcessThread(thread);
+    ASSERT_GT(calls, 0);
+    printf("%d threads, %d modules: %lld Process() calls, late by %.2f ms on "
+           "average (max %lld ms), %.2f us per Process() call.\n",
+           kThreadCounts[t], kNumModules, static_cast<long long>(calls),
+           static_cast<double>(late_ms) / calls,
+           static_cast<long long>(max_late_ms),
+           static_cast<double>(process_time_us) / calls);
+  }
+}
+
+}  // namespace webrtc
@@ -12,15 +12,17 @@
 
 #include <cassert>
 #include <stdio.h>
+#include <string.h>
 
 #include "critical_section_wrapper.h"
+#include "event_wrapper.h"
+#include "thread_wrapper.h"
 #include "trace.h"
 
 #if defined(_WIN32)
 #include <Windows.h>
 #include <mmsystem.h>
 #elif defined(WEBRTC_LINUX) || defined(WEBRTC_MAC)
-#include <string.h>
 #include <sys/time.h>
 #include <time.h>
 #endif
@@ -41,6 +43,8 @@
 namespace webrtc {
 const char RTPFILE_VERSION[] = "1.0";
 const uint32_t MAX_UWORD32 = 0xffffffff;
+// Length of "#!rtpplay1.0 \n" and the 16 byte file header following it.
+const uint32_t kFileHeaderLength = 14 + 16;
 
 // This stucture is specified in the rtpdump documentation.
 // This struct corresponds to RD_packet_t in
@@ -69,8 +73,25 @@ void RtpDump::DestroyRtpDump(RtpDump* object)
 RtpDumpImpl::RtpDumpImpl()
     : _critSect(CriticalSectionWrapper::CreateCriticalSection()),
       _file(*FileWrapper::Create()),
-      _startTime(0)
+      _startTime(0),
+      _ring(NULL),
+      _writePos(0),
+      _readPos(0),
+      _active(0),
+      _producers(0),
+      _stopWaiting(0),
+      _headerOnly(0),
+      _droppedPackets(0),
+      _wakeEvent(EventWrapper::Create()),
+      _producersDoneEvent(EventWrapper::Create()),
+      _writerThread(NULL),
+      _writeBuffer(NULL),
+      _writeBufferLength(0),
+      _fileBytes(0),
+      _maxFileBytes(0),
+      _maxFiles(0)
 {
+    _fileName[0] = '\0';
     WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s created", __FUNCTION__);
 }
 
@@ -80,9 +101,10 @@ RtpDump::~RtpDump()
 
 RtpDumpImpl::~RtpDumpImpl()
 {
-    _file.Flush();
-    _file.CloseFile();
+    Stop();
     delete &_file;
+    delete _producersDoneEvent;
+    delete _wakeEvent;
     delete _critSect;
     WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s deleted", __FUNCTION__);
 }
@@ -95,88 +117,160 @@ int32_t RtpDumpImpl::Start(const char* fileNameUTF8)
         return -1;
     }
 
+    Stop();
+
     CriticalSectionScoped lock(_critSect);
-    _file.Flush();
-    _file.CloseFile();
     if (_file.OpenFile(fileNameUTF8, false, false, false) == -1)
     {
         WEBRTC_TRACE(kTraceError, kTraceUtility, -1,
                      "failed to open the specified file");
         return -1;
     }
+    strncpy(_fileName, fileNameUTF8, FileWrapper::kMaxFileNameSize - 1);
+    _fileName[FileWrapper::kMaxFileNameSize - 1] = '\0';
 
     // Store start of RTP dump (to be used for offset calculation later).
     _startTime = GetTimeInMS();
 
-    // All rtp dump files start with #!rtpplay.
-    char magic[16];
-    sprintf(magic, "#!rtpplay%s \n", RTPFILE_VERSION);
-    if (_file.WriteText(magic) == -1)
+    if (!WriteFileHeader())
     {
-        WEBRTC_TRACE(kTraceError, kTraceUtility, -1,
-                     "error writing to file");
+        _file.CloseFile();
         return -1;
     }
 
-    // The header according to the rtpdump documentation is sizeof(RD_hdr_t)
-    // which is 8 + 4 + 2 = 14 bytes for 32-bit architecture (and 22 bytes on
-    // 64-bit architecture). However, Wireshark use 16 bytes for the header
-    // regardless of if the binary is 32-bit or 64-bit. Go by the same approach
-    // as Wireshark since it makes more sense.
-    // http://wiki.wireshark.org/rtpdump explains that an additional 2 bytes
-    // of padding should be added to the header.
-    char dummyHdr[16];
-    memset(dummyHdr, 0, 16);
-    if (!_file.Write(dummyHdr, sizeof(dummyHdr)))
+    _ring = new RtpDumpSlot[kRingSlots];
+    for (uint32_t i = 0; i < kRingSlots; ++i)
+    {
+        _ring[i].sequence += static_cast<int32_t>(i);
+    }
+    _writeBuffer = new uint8_t[kWriteBufferSize];
+    _writeBufferLength = 0;
+    _writePos += -_writePos.Value();
+    _readPos = 0;
+    _droppedPackets += -_droppedPackets.Value();
+
+    _writerThread = ThreadWrapper::CreateThread(RtpDumpImpl::Run, this,
+                                                kNormalPriority, "RtpDump");
+    unsigned int threadId = 0;
+    if (_writerThread == NULL || !_writerThread->Start(threadId))
     {
         WEBRTC_TRACE(kTraceError, kTraceUtility, -1,
-                     "error writing to file");
+                     "failed to start the writer thread");
+        delete _writerThread;
+        _writerThread = NULL;
+        delete [] _ring;
+        _ring = NULL;
+        delete [] _writeBuffer;
+        _writeBuffer = NULL;
+        _file.CloseFile();
         return -1;
     }
+    // Publishes the state above to DumpPacket().
+    _active.CompareExchange(1, 0);
     return 0;
 }
 
 int32_t RtpDumpImpl::Stop()
 {
+    if (!_active.CompareExchange(0, 1))
+    {
+        return 0;
+    }
+    // Wait for the producers which saw the dump active to finish their
+    // packets. The last one to leave signals the event once _stopWaiting is
+    // set; an earlier stale signal only costs another look at _producers.
+    ++_stopWaiting;
+    while ((_producers += 0) != 0)
+    {
+        _producersDoneEvent->Wait(WEBRTC_EVENT_INFINITE);
+    }
+    --_stopWaiting;
+    _writerThread->SetNotAlive();
+    _wakeEvent->Set();
+    _writerThread->Stop();
+    delete _writerThread;
+    _writerThread = NULL;
+
     CriticalSectionScoped lock(_critSect);
+    // Write what was dumped after the thread's last pass.
+    WritePackets();
+    FlushWriteBuffer();
     _file.Flush();
     _file.CloseFile();
+    delete [] _ring;
+    _ring = NULL;
+    delete [] _writeBuffer;
+    _writeBuffer = NULL;
     return 0;
 }
 
 bool RtpDumpImpl::IsActive() const
 {
-    CriticalSectionScoped lock(_critSect);
-    return _file.Open();
+    return _active.Value() != 0;
 }
 
 int32_t RtpDumpImpl::DumpPacket(const uint8_t* packet, uint16_t packetLength)
 {
-    CriticalSectionScoped lock(_critSect);
-    if (!IsActive())
+    // Checked before counting the producer as well, so that threads dumping
+    // while the dump is stopped can't keep Stop() waiting for _producers.
+    if (_active.Value() == 0)
     {
         return 0;
     }
-
-    if (packet == NULL)
+    ++_producers;
+    if (_active.Value() == 0)
     {
-        return -1;
+        LeaveDumpPacket();
+        return 0;
     }
 
-    if (packetLength < 1)
+    if (packet == NULL || packetLength < 1)
     {
+        LeaveDumpPacket();
         return -1;
     }
 
     // If the packet doesn't contain a valid RTCP header the packet will be
     // considered RTP (without further verification).
-    bool isRTCP = RTCP(packet);
+    const bool isRTCP = RTCP(packet);
+    uint16_t length = packetLength;
+    if (!isRTCP && _headerOnly.Value() != 0)
+    {
+        length = RtpHeaderLength(packet, packetLength);
+    }
+    if (length > sizeof(_ring[0].packet))
+    {
+        length = sizeof(_ring[0].packet);
+    }
 
-    rtpDumpPktHdr_t hdr;
-    uint32_t offset;
+    // Claim a slot.
+    uint32_t pos = static_cast<uint32_t>(_writePos.Value());
+    RtpDumpSlot* slot = NULL;
+    for (;;)
+    {
+        slot = &_ring[pos & (kRingSlots - 1)];
+        const int32_t diff = static_cast<int32_t>(
+            static_cast<uint32_t>(slot->sequence += 0) - pos);
+        if (diff == 0)
+        {
+            if (_writePos.CompareExchange(static_cast<int32_t>(pos + 1),
+                                          static_cast<int32_t>(pos)))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The writer thread hasn't read the packet in this slot yet.
+            ++_droppedPackets;
+            LeaveDumpPacket();
+            return -1;
+        }
+        pos = static_cast<uint32_t>(_writePos.Value());
+    }
 
     // Offset is relative to when recording was started.
-    offset = GetTimeInMS();
+    uint32_t offset = GetTimeInMS();
     if (offset < _startTime)
     {
         // Compensate for wraparound.
@@ -184,32 +278,216 @@ int32_t RtpDumpImpl::DumpPacket(const uint8_t* packet, uint16_t packetLength)
     } else {
         offset -= _startTime;
     }
-    hdr.offset = RtpDumpHtonl(offset);
+    slot->offset = offset;
+    slot->length = length;
+    slot->plen = isRTCP ? 0 : packetLength;
+    memcpy(slot->packet, packet, length);
+    // Publish the packet to the writer thread.
+    ++slot->sequence;
+    LeaveDumpPacket();
+
+    if ((pos & (kRingSlots / 2 - 1)) == kRingSlots / 2 - 1)
+    {
+        // Another half ring filled up since the last wake up.
+        _wakeEvent->Set();
+    }
+    return 0;
+}
 
-    hdr.length = RtpDumpHtons((uint16_t)(packetLength + sizeof(hdr)));
-    if (isRTCP)
+void RtpDumpImpl::LeaveDumpPacket()
+{
+    if (--_producers == 0 && _stopWaiting.Value() != 0)
     {
-        hdr.plen = 0;
+        _producersDoneEvent->Set();
     }
-    else
+}
+
+int32_t RtpDumpImpl::SetHeaderOnly(bool enable)
+{
+    _headerOnly.CompareExchange(enable ? 1 : 0, enable ? 0 : 1);
+    return 0;
+}
+
+int32_t RtpDumpImpl::SetMaxFileSize(uint32_t maxFileBytes, int maxFiles)
+{
+    if (maxFileBytes > 0 && maxFiles < 1)
     {
-        hdr.plen = RtpDumpHtons((uint16_t)packetLength);
+        return -1;
     }
+    CriticalSectionScoped lock(_critSect);
+    _maxFileBytes = maxFileBytes;
+    _maxFiles = maxFiles;
+    return 0;
+}
 
-    if (!_file.Write(&hdr, sizeof(hdr)))
+uint32_t RtpDumpImpl::DroppedPackets() const
+{
+    return static_cast<uint32_t>(_droppedPackets.Value());
+}
+
+uint16_t RtpDumpImpl::RtpHeaderLength(const uint8_t* packet,
+                                      uint16_t packetLength)
+{
+    if (packetLength < 12)
+    {
+        return packetLength;
+    }
+    uint32_t headerLength = 12 + 4 * (packet[0] & 0x0f);
+    if ((packet[0] & 0x10) && headerLength + 4 <= packetLength)
+    {
+        // The extension header is followed by its length in 32-bit words.
+        headerLength += 4 + 4 * ((packet[headerLength + 2] << 8) |
+                                 packet[headerLength + 3]);
+    }
+    return headerLength < packetLength ?
+        static_cast<uint16_t>(headerLength) : packetLength;
+}
+
+bool RtpDumpImpl::Run(void* obj)
+{
+    return static_cast<RtpDumpImpl*>(obj)->Process();
+}
+
+bool RtpDumpImpl::Process()
+{
+    _wakeEvent->Wait(kWriteIntervalMs);
+    CriticalSectionScoped lock(_critSect);
+    WritePackets();
+    FlushWriteBuffer();
+    // Keep the file readable while the dump is running.
+    _file.Flush();
+    return true;
+}
+
+void RtpDumpImpl::WritePackets()
+{
+    if (!_file.Open())
+    {
+        return;
+    }
+    for (;;)
+    {
+        RtpDumpSlot& slot = _ring[_readPos & (kRingSlots - 1)];
+        if (static_cast<uint32_t>(slot.sequence += 0) != _readPos + 1)
+        {
+            break;
+        }
+        const uint32_t recordLength = sizeof(rtpDumpPktHdr_t) + slot.length;
+        // Every file gets at least one packet, however small the limit.
+        if (_maxFileBytes > 0 &&
+            _fileBytes + _writeBufferLength > kFileHeaderLength &&
+            _fileBytes + _writeBufferLength + recordLength > _maxFileBytes)
+        {
+            if (!FlushWriteBuffer() || !RotateFile())
+            {
+                return;
+            }
+        }
+        if (_writeBufferLength + recordLength > kWriteBufferSize &&
+            !FlushWriteBuffer())
+        {
+            return;
+        }
+
+        rtpDumpPktHdr_t hdr;
+        hdr.length = RtpDumpHtons(static_cast<uint16_t>(recordLength));
+        hdr.plen = RtpDumpHtons(slot.plen);
+        hdr.offset = RtpDumpHtonl(slot.offset);
+        memcpy(&_writeBuffer[_writeBufferLength], &hdr, sizeof(hdr));
+        memcpy(&_writeBuffer[_writeBufferLength + sizeof(hdr)], slot.packet,
+               slot.length);
+        _writeBufferLength += recordLength;
+
+        // Hand the slot back to the producers for the next lap.
+        slot.sequence += kRingSlots - 1;
+        ++_readPos;
+    }
+}
+
+bool RtpDumpImpl::FlushWriteBuffer()
+{
+    if (_writeBufferLength == 0)
+    {
+        return true;
+    }
+    const uint32_t length = _writeBufferLength;
+    _writeBufferLength = 0;
+    if (!_file.Write(_writeBuffer, length))
     {
         WEBRTC_TRACE(kTraceError, kTraceUtility, -1,
                      "error writing to file");
-        return -1;
+        return false;
     }
-    if (!_file.Write(packet, packetLength))
+    _fileBytes += length;
+    return true;
+}
+
+bool RtpDumpImpl::WriteFileHeader()
+{
+    // All rtp dump files start with #!rtpplay.
+    char magic[16];
+    sprintf(magic, "#!rtpplay%s \n", RTPFILE_VERSION);
+    if (_file.WriteText(magic) == -1)
     {
         WEBRTC_TRACE(kTraceError, kTraceUtility, -1,
                      "error writing to file");
-        return -1;
+        return false;
     }
 
-    return 0;
+    // The header according to the rtpdump documentation is sizeof(RD_hdr_t)
+    // which is 8 + 4 + 2 = 14 bytes for 32-bit architecture (and 22 bytes on
+    // 64-bit architecture). However, Wireshark use 16 bytes for the header
+    // regardless of if the binary is 32-bit or 64-bit. Go by the same approach
+    // as Wireshark since it makes more sense.
+    // http://wiki.wireshark.org/rtpdump explains that an additional 2 bytes
+    // of padding should be added to the header.
+    char dummyHdr[16];
+    memset(dummyHdr, 0, 16);
+    if (!_file.Write(dummyHdr, sizeof(dummyHdr)))
+    {
+        WEBRTC_TRACE(kTraceError, kTraceUtility, -1,
+                     "error writing to file");
+        return false;
+    }
+    _fileBytes = kFileHeaderLength;
+    return true;
+}
+
+bool RtpDumpImpl::RotateFile()
+{
+    _file.Flush();
+    _file.CloseFile();
+
+    // <file>.<n> for n > 0, <file> itself for n = 0.
+    char from[FileWrapper::kMaxFileNameSize + 16];
+    char to[FileWrapper::kMaxFileNameSize + 16];
+    if (_maxFiles > 1)
+    {
+        sprintf(to, "%s.%d", _fileName, _maxFiles - 1);
+        remove(to);
+    }
+    for (int i = _maxFiles - 1; i > 0; --i)
+    {
+        if (i > 1)
+        {
+            sprintf(from, "%s.%d", _fileName, i - 1);
+        }
+        else
+        {
+            strcpy(from, _fileName);
+        }
+        sprintf(to, "%s.%d", _fileName, i);
+        rename(from, to);
+    }
+
+    if (_file.OpenFile(_fileName, false, false, false) == -1)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceUtility, -1,
+                     "failed to open the specified file");
+        return false;
+    }
+    // Offsets in the new file stay relative to Start().
+    return WriteFileHeader();
 }
 
 bool RtpDumpImpl::RTCP(const uint8_t* packet) const
@@ -11,14 +11,42 @@
 #ifndef WEBRTC_MODULES_UTILITY_SOURCE_RTP_DUMP_IMPL_H_
 #define WEBRTC_MODULES_UTILITY_SOURCE_RTP_DUMP_IMPL_H_
 
+#include "atomic32.h"
+#include "file_wrapper.h"
 #include "rtp_dump.h"
 
 namespace webrtc {
 class CriticalSectionWrapper;
-class FileWrapper;
+class EventWrapper;
+class ThreadWrapper;
+
+// A packet waiting in the ring for the writer thread.
+struct RtpDumpSlot
+{
+    // Position in the ring the slot is free for writing at, plus one once
+    // the packet in it can be read.
+    Atomic32 sequence;
+    // Milliseconds since the start of recording.
+    uint32_t offset;
+    // Bytes stored in packet.
+    uint16_t length;
+    // Actual header+payload length for RTP, 0 for RTCP.
+    uint16_t plen;
+    uint8_t packet[1500];
+};
+
 class RtpDumpImpl : public RtpDump
 {
 public:
+    enum
+    {
+        // Number of packets the ring holds.
+        kRingSlots = 1024,
+        // The writer thread writes at least this often.
+        kWriteIntervalMs = 100,
+        kWriteBufferSize = 64 * 1024
+    };
+
     RtpDumpImpl();
     virtual ~RtpDumpImpl();
 
@@ -26,7 +54,31 @@ public:
     virtual int32_t Stop();
     virtual bool IsActive() const;
     virtual int32_t DumpPacket(const uint8_t* packet, uint16_t packetLength);
+    virtual int32_t SetHeaderOnly(bool enable);
+    virtual int32_t SetMaxFileSize(uint32_t maxFileBytes, int maxFiles);
+    virtual uint32_t DroppedPackets() const;
+
+    // Returns the length of the RTP header of packet, including CSRCs and
+    // header extensions.
+    static uint16_t RtpHeaderLength(const uint8_t* packet,
+                                    uint16_t packetLength);
+
 private:
+    static bool Run(void* obj);
+    bool Process();
+
+    // Called by DumpPacket() when it's done, wakes up a waiting Stop().
+    void LeaveDumpPacket();
+
+    // Writes the packets in the ring to the file. Called with _critSect held.
+    void WritePackets();
+    // Writes the buffered records to the file.
+    bool FlushWriteBuffer();
+    // Writes the rtpplay header to the newly opened file.
+    bool WriteFileHeader();
+    // Moves the full file out of the way and opens a new one.
+    bool RotateFile();
+
     // Return the system time in ms.
     inline uint32_t GetTimeInMS() const;
     // Return x in network byte order (big endian).
@@ -40,9 +92,42 @@ private:
     bool RTCP(const uint8_t* packet) const;
 
 private:
+    // Held by Start(), Stop() and the writer thread while writing.
     CriticalSectionWrapper* _critSect;
     FileWrapper& _file;
+    char _fileName[FileWrapper::kMaxFileNameSize];
     uint32_t _startTime;
+
+    // Multiple producer, single consumer ring of kRingSlots packets. Each
+    // producer claims the slot at _writePos and publishes it by bumping its
+    // sequence, the writer thread reads the slots in order. Allocated in
+    // Start() and freed in Stop().
+    RtpDumpSlot* _ring;
+    Atomic32 _writePos;
+    uint32_t _readPos;
+
+    // Set between Start() and Stop(), checked by DumpPacket() without lock.
+    Atomic32 _active;
+    // Number of threads currently in DumpPacket().
+    Atomic32 _producers;
+    // Set while Stop() waits for _producers to drop to zero.
+    Atomic32 _stopWaiting;
+    Atomic32 _headerOnly;
+    Atomic32 _droppedPackets;
+
+    EventWrapper* _wakeEvent;
+    // Signaled when the last producer leaves DumpPacket() while Stop()
+    // waits.
+    EventWrapper* _producersDoneEvent;
+    ThreadWrapper* _writerThread;
+
+    // Records not yet written to the file. Allocated in Start() and freed in
+    // Stop().
+    uint8_t* _writeBuffer;
+    uint32_t _writeBufferLength;
+    uint32_t _fileBytes;
+    uint32_t _maxFileBytes;
+    int _maxFiles;
 };
 } // namespace webrtc
 #endif // WEBRTC_MODULES_UTILITY_SOURCE_RTP_DUMP_IMPL_H_
@@ -0,0 +1,360 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "critical_section_wrapper.h"
+#include "file_wrapper.h"
+#include "rtp_dump.h"
+#include "rtp_dump_impl.h"
+#include "scoped_ptr.h"
+#include "sleep.h"
+#include "testsupport/fileutils.h"
+#include "thread_wrapper.h"
+#include "tick_util.h"
+
+namespace webrtc {
+namespace {
+
+const char kMagic[] = "#!rtpplay1.0 \n";
+const size_t kFileHeaderLength = sizeof(kMagic) - 1 + 16;
+
+struct Record {
+  uint16_t plen;
+  uint32_t offset;
+  std::vector<uint8_t> data;
+};
+
+uint16_t ReadUint16(const uint8_t* data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+uint32_t ReadUint32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) | (data[1] << 16) |
+      (data[2] << 8) | data[3];
+}
+
+// Reads the records of the rtpdump file |file_name|. Returns false if the
+// file doesn't exist or is malformed.
+bool ReadRtpDump(const std::string& file_name, std::vector<Record>* records) {
+  FILE* file = fopen(file_name.c_str(), "rb");
+  if (file == NULL) {
+    return false;
+  }
+  std::vector<uint8_t> contents;
+  uint8_t buffer[4096];
+  size_t read = 0;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.insert(contents.end(), buffer, buffer + read);
+  }
+  fclose(file);
+
+  if (contents.size() < kFileHeaderLength ||
+      memcmp(&contents[0], kMagic, sizeof(kMagic) - 1) != 0) {
+    return false;
+  }
+  size_t pos = kFileHeaderLength;
+  while (pos < contents.size()) {
+    if (pos + 8 > contents.size()) {
+      return false;
+    }
+    const uint16_t length = ReadUint16(&contents[pos]);
+    if (length < 8 || pos + length > contents.size()) {
+      return false;
+    }
+    Record record;
+    record.plen = ReadUint16(&contents[pos + 2]);
+    record.offset = ReadUint32(&contents[pos + 4]);
+    record.data.assign(contents.begin() + pos + 8,
+                       contents.begin() + pos + length);
+    records->push_back(record);
+    pos += length;
+  }
+  return true;
+}
+
+long FileSize(const std::string& file_name) {
+  FILE* file = fopen(file_name.c_str(), "rb");
+  if (file == NULL) {
+    return -1;
+  }
+  fseek(file, 0, SEEK_END);
+  const long size = ftell(file);
+  fclose(file);
+  return size;
+}
+
+// Builds an RTP packet with |num_csrcs| CSRCs, a header extension of
+// |extension_words| 32-bit words if non-negative, and |payload_length| bytes
+// of payload.
+std::vector<uint8_t> RtpPacket(uint16_t sequence_number, int num_csrcs,
+                               int extension_words, int payload_length) {
+  std::vector<uint8_t> packet(12, 0);
+  packet[0] = static_cast<uint8_t>(0x80 | num_csrcs);
+  packet[1] = 96;
+  packet[2] = static_cast<uint8_t>(sequence_number >> 8);
+  packet[3] = static_cast<uint8_t>(sequence_number);
+  packet.resize(12 + 4 * num_csrcs, 0x11);
+  if (extension_words >= 0) {
+    packet[0] |= 0x10;
+    packet.push_back(0xbe);
+    packet.push_back(0xde);
+    packet.push_back(0);
+    packet.push_back(static_cast<uint8_t>(extension_words));
+    packet.resize(packet.size() + 4 * extension_words, 0x22);
+  }
+  packet.resize(packet.size() + payload_length, 0x33);
+  return packet;
+}
+
+std::vector<uint8_t> RtcpPacket() {
+  // Receiver report without report blocks.
+  const uint8_t rr[] = { 0x80, 201, 0x00, 0x01, 0x12, 0x34, 0x56, 0x78 };
+  return std::vector<uint8_t>(rr, rr + sizeof(rr));
+}
+
+// Dumps a packet every millisecond, as the threads sending and receiving do.
+bool DumpThreadFunction(void* obj) {
+  static const std::vector<uint8_t> packet = RtpPacket(1, 0, -1, 100);
+  static_cast<RtpDump*>(obj)->DumpPacket(&packet[0],
+                                         static_cast<uint16_t>(packet.size()));
+  SleepMs(1);
+  return true;
+}
+
+class RtpDumpTest : public ::testing::Test {
+ protected:
+  RtpDumpTest()
+      : dump_(RtpDump::CreateRtpDump()),
+        file_name_(test::OutputPath() + "rtp_dump_unittest.rtp") {
+  }
+
+  virtual ~RtpDumpTest() {
+    RtpDump::DestroyRtpDump(dump_);
+    remove(file_name_.c_str());
+    for (int i = 1; i < 4; ++i) {
+      remove(RotatedFileName(i).c_str());
+    }
+  }
+
+  std::string RotatedFileName(int index) const {
+    char suffix[8];
+    sprintf(suffix, ".%d", index);
+    return file_name_ + suffix;
+  }
+
+  int32_t Dump(const std::vector<uint8_t>& packet) {
+    return dump_->DumpPacket(&packet[0],
+                             static_cast<uint16_t>(packet.size()));
+  }
+
+  RtpDump* dump_;
+  const std::string file_name_;
+};
+
+TEST_F(RtpDumpTest, WritesPacketsInRtpplayFormat) {
+  EXPECT_FALSE(dump_->IsActive());
+  EXPECT_EQ(0, Dump(RtpPacket(1, 0, -1, 100)));
+  ASSERT_EQ(0, dump_->Start(file_name_.c_str()));
+  EXPECT_TRUE(dump_->IsActive());
+
+  std::vector<std::vector<uint8_t> > packets;
+  packets.push_back(RtpPacket(2, 0, -1, 100));
+  packets.push_back(RtcpPacket());
+  packets.push_back(RtpPacket(3, 1, 2, 1200));
+  for (size_t i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(0, Dump(packets[i]));
+  }
+  EXPECT_EQ(0, dump_->Stop());
+  EXPECT_FALSE(dump_->IsActive());
+  // Not recorded.
+  EXPECT_EQ(0, Dump(RtpPacket(4, 0, -1, 100)));
+
+  std::vector<Record> records;
+  ASSERT_TRUE(ReadRtpDump(file_name_, &records));
+  ASSERT_EQ(packets.size(), records.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    EXPECT_TRUE(records[i].data == packets[i]);
+    EXPECT_LT(records[i].offset, 1000u);
+  }
+  EXPECT_EQ(packets[0].size(), records[0].plen);
+  EXPECT_EQ(0, records[1].plen);
+  EXPECT_EQ(packets[2].size(), records[2].plen);
+  EXPECT_EQ(0u, dump_->DroppedPackets());
+}
+
+TEST_F(RtpDumpTest, WritesInTheBackground) {
+  ASSERT_EQ(0, dump_->Start(file_name_.c_str()));
+  EXPECT_EQ(0, Dump(RtpPacket(1, 0, -1, 100)));
+  // The writer thread writes at least every kWriteIntervalMs.
+  std::vector<Record> records;
+  for (int i = 0; i < 50 && records.empty(); ++i) {
+    SleepMs(RtpDumpImpl::kWriteIntervalMs / 5);
+    records.clear();
+    ReadRtpDump(file_name_, &records);
+  }
+  EXPECT_EQ(1u, records.size());
+}
+
+TEST_F(RtpDumpTest, HeaderOnlyLeavesOutPayload) {
+  ASSERT_EQ(0, dump_->SetHeaderOnly(true));
+  ASSERT_EQ(0, dump_->Start(file_name_.c_str()));
+  const std::vector<uint8_t> plain = RtpPacket(1, 0, -1, 100);
+  const std::vector<uint8_t> extended = RtpPacket(2, 2, 1, 100);
+  const std::vector<uint8_t> rtcp = RtcpPacket();
+  EXPECT_EQ(0, Dump(plain));
+  EXPECT_EQ(0, Dump(extended));
+  EXPECT_EQ(0, Dump(rtcp));
+  EXPECT_EQ(0, dump_->Stop());
+
+  std::vector<Record> records;
+  ASSERT_TRUE(ReadRtpDump(file_name_, &records));
+  ASSERT_EQ(3u, records.size());
+  EXPECT_TRUE(records[0].data ==
+              std::vector<uint8_t>(plain.begin(), plain.begin() + 12));
+  EXPECT_EQ(plain.size(), records[0].plen);
+  // 12 bytes of fixed header, 2 CSRCs and a one word extension.
+  EXPECT_TRUE(records[1].data ==
+              std::vector<uint8_t>(extended.begin(),
+                                   extended.begin() + 12 + 8 + 8));
+  EXPECT_EQ(extended.size(), records[1].plen);
+  EXPECT_TRUE(records[2].data == rtcp);
+}
+
+TEST_F(RtpDumpTest, RtpHeaderLength) {
+  std::vector<uint8_t> packet = RtpPacket(1, 3, 2, 50);
+  EXPECT_EQ(12 + 12 + 12, RtpDumpImpl::RtpHeaderLength(
+      &packet[0], static_cast<uint16_t>(packet.size())));
+  // Truncated packets.
+  EXPECT_EQ(8, RtpDumpImpl::RtpHeaderLength(&packet[0], 8));
+  EXPECT_EQ(30, RtpDumpImpl::RtpHeaderLength(&packet[0], 30));
+}
+
+TEST_F(RtpDumpTest, RotatesFilesWithinDiskBudget) {
+  const uint32_t kMaxFileBytes = 2000;
+  const int kMaxFiles = 3;
+  ASSERT_EQ(-1, dump_->SetMaxFileSize(kMaxFileBytes, 0));
+  ASSERT_EQ(0, dump_->SetMaxFileSize(kMaxFileBytes, kMaxFiles));
+  ASSERT_EQ(0, dump_->Start(file_name_.c_str()));
+  const int kNumPackets = 100;
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(0, Dump(RtpPacket(static_cast<uint16_t>(i), 0, -1, 88)));
+  }
+  EXPECT_EQ(0, dump_->Stop());
+
+  EXPECT_EQ(-1, FileSize(RotatedFileName(kMaxFiles)));
+  // The files from oldest to newest hold the last packets in order.
+  std::vector<Record> records;
+  for (int i = kMaxFiles - 1; i >= 0; --i) {
+    const std::string name = i > 0 ? RotatedFileName(i) : file_name_;
+    const long size = FileSize(name);
+    EXPECT_GT(size, static_cast<long>(kFileHeaderLength));
+    EXPECT_LE(size, static_cast<long>(kMaxFileBytes));
+    ASSERT_TRUE(ReadRtpDump(name, &records));
+  }
+  ASSERT_FALSE(records.empty());
+  for (size_t i = 0; i < records.size(); ++i) {
+    const uint16_t sequence_number = ReadUint16(&records[i].data[2]);
+    EXPECT_EQ(kNumPackets - records.size() + i, sequence_number);
+  }
+}
+
+TEST_F(RtpDumpTest, StopsAndRestartsWhileOtherThreadsDump) {
+  const int kNumThreads = 4;
+  std::vector<ThreadWrapper*> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(ThreadWrapper::CreateThread(DumpThreadFunction, dump_,
+                                                  kNormalPriority,
+                                                  "DumpThread"));
+    unsigned int thread_id = 0;
+    ASSERT_TRUE(threads[i]->Start(thread_id));
+  }
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ(0, dump_->Start(file_name_.c_str()));
+    SleepMs(2);
+    EXPECT_EQ(0, dump_->Stop());
+    EXPECT_FALSE(dump_->IsActive());
+    std::vector<Record> records;
+    EXPECT_TRUE(ReadRtpDump(file_name_, &records));
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    EXPECT_TRUE(threads[i]->Stop());
+    delete threads[i];
+  }
+}
+
+TEST_F(RtpDumpTest, DISABLED_DumpPacketBenchmark) {
+  // Bursts of video packets, with some time in between for the writer
+  // thread, compared to writing each packet to the file under a lock.
+  const int kBursts = 40;
+  const int kBurstPackets = RtpDumpImpl::kRingSlots / 4;
+  const std::vector<uint8_t> packet = RtpPacket(1, 0, 1, 1180);
+
+  scoped_ptr<CriticalSectionWrapper> crit(
+      CriticalSectionWrapper::CreateCriticalSection());
+  scoped_ptr<FileWrapper> file(FileWrapper::Create());
+  ASSERT_EQ(0, file->OpenFile(file_name_.c_str(), false, false, false));
+  int64_t sync_total_us = 0;
+  int64_t sync_max_us = 0;
+  for (int i = 0; i < kBursts; ++i) {
+    for (int j = 0; j < kBurstPackets; ++j) {
+      const int64_t start_us = TickTime::MicrosecondTimestamp();
+      {
+        CriticalSectionScoped cs(crit.get());
+        uint8_t header[8] = { 0 };
+        file->Write(header, sizeof(header));
+        file->Write(&packet[0], packet.size());
+      }
+      const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+      sync_total_us += elapsed_us;
+      sync_max_us = std::max(sync_max_us, elapsed_us);
+    }
+    SleepMs(5);
+  }
+  file->CloseFile();
+
+  ASSERT_EQ(0, dump_->Start(file_name_.c_str()));
+  int64_t async_total_us = 0;
+  int64_t async_max_us = 0;
+  for (int i = 0; i < kBursts; ++i) {
+    for (int j = 0; j < kBurstPackets; ++j) {
+      const int64_t start_us = TickTime::MicrosecondTimestamp();
+      Dump(packet);
+      const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+      async_total_us += elapsed_us;
+      async_max_us = std::max(async_max_us, elapsed_us);
+    }
+    SleepMs(5);
+  }
+  EXPECT_EQ(0, dump_->Stop());
+  const int num_packets = kBursts * kBurstPackets;
+
+  printf("Synchronous writes: %.2f us/packet, max %d us\n",
+         static_cast<double>(sync_total_us) / num_packets,
+         static_cast<int>(sync_max_us));
+  printf("Background writer: %.2f us/packet, max %d us, %u dropped\n",
+         static_cast<double>(async_total_us) / num_packets,
+         static_cast<int>(async_max_us), dump_->DroppedPackets());
+
+  std::vector<Record> records;
+  ASSERT_TRUE(ReadRtpDump(file_name_, &records));
+  EXPECT_EQ(static_cast<size_t>(num_packets) - dump_->DroppedPackets(),
+            records.size());
+}
+
+}  // namespace
+}  // namespace webrtc
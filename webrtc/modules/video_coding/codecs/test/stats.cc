@@ -159,6 +159,36 @@ void Stats::PrintSummary() {
   printf("  Max bit rate: %7d kbps (frame %d)\n",
          frame->bit_rate_in_kbps, frame->frame_number);
 
+  // SIMULCAST LAYERS
+  int num_layers = 0;
+  for (FrameStatisticsIterator it = stats_.begin();
+      it != stats_.end(); ++it) {
+    num_layers = std::max(num_layers, it->num_simulcast_layers);
+  }
+  if (num_layers > 1) {
+    printf("Simulcast layers (time until the layer is delivered):\n");
+    for (int layer = 0; layer < num_layers; ++layer) {
+      int total_time_in_us = 0;
+      int total_length = 0;
+      int nbr_frames = 0;
+      for (FrameStatisticsIterator it = stats_.begin();
+          it != stats_.end(); ++it) {
+        if (it->layer_encoded_length_in_bytes[layer] > 0) {
+          total_time_in_us += it->layer_encode_time_in_us[layer];
+          total_length += it->layer_encoded_length_in_bytes[layer];
+          nbr_frames++;
+        }
+      }
+      if (nbr_frames == 0) {
+        printf("  Layer %d : no encoded frames\n", layer);
+        continue;
+      }
+      printf("  Layer %d : %7d us, %7d bytes average (%d frames)\n", layer,
+             total_time_in_us / nbr_frames, total_length / nbr_frames,
+             nbr_frames);
+    }
+  }
+
   printf("\n");
   printf("Total encoding time  : %7d ms.\n",
          total_encoding_time_in_us / 1000);
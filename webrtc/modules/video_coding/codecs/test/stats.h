@@ -11,8 +11,11 @@
 #ifndef WEBRTC_MODULES_VIDEO_CODING_CODECS_TEST_STATS_H_
 #define WEBRTC_MODULES_VIDEO_CODING_CODECS_TEST_STATS_H_
 
+#include <string.h>
+
 #include <vector>
 
+#include "common_types.h"  // NOLINT
 #include "common_video/interface/video_image.h"
 
 namespace webrtc {
@@ -26,7 +29,10 @@ struct FrameStatistic {
       encode_time_in_us(0), decode_time_in_us(0),
       frame_number(0), packets_dropped(0), total_packets(0),
       bit_rate_in_kbps(0), encoded_frame_length_in_bytes(0),
-      frame_type(kDeltaFrame) {
+      frame_type(kDeltaFrame), num_simulcast_layers(0) {
+    memset(layer_encode_time_in_us, 0, sizeof(layer_encode_time_in_us));
+    memset(layer_encoded_length_in_bytes, 0,
+           sizeof(layer_encoded_length_in_bytes));
   };
   bool encoding_successful;
   bool decoding_successful;
@@ -46,6 +52,14 @@ struct FrameStatistic {
   // Copied from EncodedImage
   int encoded_frame_length_in_bytes;
   webrtc::VideoFrameType frame_type;
+
+  // For simulcast, the time from the start of the encoding until each layer
+  // was delivered and the size of each layer, lowest resolution first. The
+  // fields above describe the highest resolution layer, which is the one
+  // decoded.
+  int num_simulcast_layers;
+  int layer_encode_time_in_us[kMaxSimulcastStreams];
+  int layer_encoded_length_in_bytes[kMaxSimulcastStreams];
 };
 
 // Handles statistics from a single video processing run.
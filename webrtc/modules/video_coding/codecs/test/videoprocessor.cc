@@ -10,6 +10,7 @@
 
 #include "modules/video_coding/codecs/test/videoprocessor.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <limits>
@@ -205,7 +206,30 @@ bool VideoProcessorImpl::ProcessFrame(int frame_number) {
   }
 }
 
-void VideoProcessorImpl::FrameEncoded(EncodedImage* encoded_image) {
+void VideoProcessorImpl::FrameEncoded(
+    EncodedImage* encoded_image,
+    const CodecSpecificInfo* codec_specific_info) {
+  TickTime encode_stop = TickTime::Now();
+  int frame_number = encoded_image->_timeStamp;
+  FrameStatistic& stat = stats_->stats_[frame_number];
+  const int num_layers =
+      std::max(1, static_cast<int>(
+          config_.codec_settings->numberOfSimulcastStreams));
+  int layer = 0;
+  if (codec_specific_info != NULL &&
+      codec_specific_info->codecType == kVideoCodecVP8) {
+    layer = codec_specific_info->codecSpecific.VP8.simulcastIdx;
+  }
+  assert(layer < num_layers);
+  stat.num_simulcast_layers = num_layers;
+  stat.layer_encode_time_in_us[layer] =
+      GetElapsedTimeMicroseconds(encode_start_, encode_stop);
+  stat.layer_encoded_length_in_bytes[layer] = encoded_image->_length;
+  if (layer != num_layers - 1) {
+    // Only the highest resolution layer is decoded and compared to the input.
+    return;
+  }
+
   // Timestamp is frame number, so this gives us #dropped frames.
   int num_dropped_from_prev_encode =  encoded_image->_timeStamp -
       prev_time_stamp_ - 1;
@@ -222,9 +246,6 @@ void VideoProcessorImpl::FrameEncoded(EncodedImage* encoded_image) {
   // (encoder callback is only called for non-zero length frames).
   encoded_frame_size_ = encoded_image->_length;
 
-  TickTime encode_stop = TickTime::Now();
-  int frame_number = encoded_image->_timeStamp;
-  FrameStatistic& stat = stats_->stats_[frame_number];
   stat.encode_time_in_us = GetElapsedTimeMicroseconds(encode_start_,
                                                       encode_stop);
   stat.encoding_successful = true;
@@ -383,7 +404,8 @@ VideoProcessorImpl::VideoProcessorEncodeCompleteCallback::Encoded(
     EncodedImage& encoded_image,
     const webrtc::CodecSpecificInfo* codec_specific_info,
     const webrtc::RTPFragmentationHeader* fragmentation) {
-  video_processor_->FrameEncoded(&encoded_image);  // Forward to parent class.
+  // Forward to parent class.
+  video_processor_->FrameEncoded(&encoded_image, codec_specific_info);
   return 0;
 }
 int32_t
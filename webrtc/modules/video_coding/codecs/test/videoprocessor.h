@@ -172,8 +172,11 @@ class VideoProcessorImpl : public VideoProcessor {
   virtual bool ProcessFrame(int frame_number);
 
  private:
-  // Invoked by the callback when a frame has completed encoding.
-  void FrameEncoded(webrtc::EncodedImage* encodedImage);
+  // Invoked by the callback when a frame has completed encoding. With
+  // simulcast, this is called once per layer, and only the highest resolution
+  // layer is decoded.
+  void FrameEncoded(webrtc::EncodedImage* encodedImage,
+                    const webrtc::CodecSpecificInfo* codec_specific_info);
   // Invoked by the callback when a frame has completed decoding.
   void FrameDecoded(const webrtc::I420VideoFrame& image);
   // Used for getting a 32-bit integer representing time
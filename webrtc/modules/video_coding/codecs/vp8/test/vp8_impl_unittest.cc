@@ -8,10 +8,18 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "webrtc/common_video/libyuv/include/scaler.h"
 #include "webrtc/modules/video_coding/codecs/vp8/include/vp8.h"
+#include "webrtc/modules/video_coding/codecs/vp8/vp8_impl.h"
 #include "webrtc/modules/video_coding/codecs/test_framework/video_source.h"
 #include "webrtc/modules/video_coding/codecs/test_framework/unit_test.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/test/testsupport/fileutils.h"
@@ -93,6 +101,53 @@ int Vp8UnitTestDecodeCompleteCallback::Decoded(I420VideoFrame& image) {
   return 0;
 }
 
+// Records the resolution of the last frame of each simulcast stream.
+class Vp8UnitTestSimulcastCallback : public webrtc::EncodedImageCallback {
+ public:
+  Vp8UnitTestSimulcastCallback() {
+    memset(widths_, 0, sizeof(widths_));
+    memset(heights_, 0, sizeof(heights_));
+  }
+  int Encoded(EncodedImage& encodedImage,
+              const CodecSpecificInfo* codecSpecificInfo,
+              const RTPFragmentationHeader*) {
+    int idx = codecSpecificInfo->codecSpecific.VP8.simulcastIdx;
+    EXPECT_LT(idx, static_cast<int>(kMaxSimulcastStreams));
+    widths_[idx] = encodedImage._encodedWidth;
+    heights_[idx] = encodedImage._encodedHeight;
+    return 0;
+  }
+  uint32_t widths_[kMaxSimulcastStreams];
+  uint32_t heights_[kMaxSimulcastStreams];
+};
+
+// Keeps a copy of every encoded frame.
+class Vp8UnitTestFrameCollector : public webrtc::EncodedImageCallback {
+ public:
+  int Encoded(EncodedImage& encodedImage,
+              const CodecSpecificInfo* codecSpecificInfo,
+              const RTPFragmentationHeader*) {
+    frames_.push_back(std::vector<uint8_t>(
+        encodedImage._buffer, encodedImage._buffer + encodedImage._length));
+    frame_types_.push_back(encodedImage._frameType);
+    timestamps_.push_back(encodedImage._timeStamp);
+    return 0;
+  }
+  std::vector<std::vector<uint8_t> > frames_;
+  std::vector<VideoFrameType> frame_types_;
+  std::vector<uint32_t> timestamps_;
+};
+
+class Vp8UnitTestDecodeCounter : public webrtc::DecodedImageCallback {
+ public:
+  Vp8UnitTestDecodeCounter() : decoded_frames_(0) {}
+  int Decoded(webrtc::I420VideoFrame& frame) {
+    ++decoded_frames_;
+    return 0;
+  }
+  int decoded_frames_;
+};
+
 class TestVp8Impl : public ::testing::Test {
  protected:
   virtual void SetUp() {
@@ -234,4 +289,187 @@ TEST_F(TestVp8Impl, AlignedStrideEncodeDecode) {
   EXPECT_GT(I420PSNR(&input_frame, &decoded_video_frame_), 36);
 }
 
+TEST_F(TestVp8Impl, SimulcastEncode) {
+  codec_inst_.maxFramerate = 30;
+  codec_inst_.startBitrate = 1000;
+  codec_inst_.maxBitrate = 4000;
+  codec_inst_.qpMax = 56;
+  codec_inst_.width = 176;
+  codec_inst_.height = 144;
+  codec_inst_.codecSpecific.VP8.numberOfTemporalLayers = 1;
+  codec_inst_.numberOfSimulcastStreams = 3;
+  for (int i = 0; i < 3; ++i) {
+    SimulcastStream& stream = codec_inst_.simulcastStream[i];
+    stream.width = codec_inst_.width >> (2 - i);
+    stream.height = codec_inst_.height >> (2 - i);
+    stream.minBitrate = 30;
+    stream.targetBitrate = 100;
+    stream.maxBitrate = 600;
+  }
+  Vp8UnitTestSimulcastCallback callback;
+  encoder_->RegisterEncodeCompleteCallback(&callback);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder_->InitEncode(&codec_inst_, 2, 1440));
+
+  I420VideoFrame input_frame;
+  input_frame.CreateEmptyFrame(codec_inst_.width, codec_inst_.height,
+                               codec_inst_.width, (codec_inst_.width + 1) / 2,
+                               (codec_inst_.width + 1) / 2);
+  memset(input_frame.buffer(kYPlane), 0x80,
+         input_frame.allocated_size(kYPlane));
+  memset(input_frame.buffer(kUPlane), 0x80,
+         input_frame.allocated_size(kUPlane));
+  memset(input_frame.buffer(kVPlane), 0x80,
+         input_frame.allocated_size(kVPlane));
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder_->Encode(input_frame, NULL, NULL));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(codec_inst_.simulcastStream[i].width, callback.widths_[i]);
+    EXPECT_EQ(codec_inst_.simulcastStream[i].height, callback.heights_[i]);
+  }
+
+  // A top stream that does not match the codec resolution is rejected.
+  codec_inst_.simulcastStream[2].width = 352;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_ERR_PARAMETER,
+            encoder_->InitEncode(&codec_inst_, 2, 1440));
+}
+
+TEST(Vp8EncoderImplTest, StreamBitrates) {
+  VideoCodec codec;
+  memset(&codec, 0, sizeof(codec));
+  std::vector<uint32_t> bitrates;
+  VP8EncoderImpl::GetStreamBitrates(codec, 500, &bitrates);
+  ASSERT_EQ(1u, bitrates.size());
+  EXPECT_EQ(500u, bitrates[0]);
+
+  codec.numberOfSimulcastStreams = 3;
+  for (int i = 0; i < 3; ++i) {
+    codec.simulcastStream[i].minBitrate = 50 << i;
+    codec.simulcastStream[i].targetBitrate = 150 << i;
+    codec.simulcastStream[i].maxBitrate = 200 << i;
+  }
+  // Too little for the middle stream: the lowest gets up to its max.
+  VP8EncoderImpl::GetStreamBitrates(codec, 180, &bitrates);
+  ASSERT_EQ(3u, bitrates.size());
+  EXPECT_EQ(180u, bitrates[0]);
+  EXPECT_EQ(0u, bitrates[1]);
+  EXPECT_EQ(0u, bitrates[2]);
+  // The lower streams get their targets and the top stream the rest.
+  VP8EncoderImpl::GetStreamBitrates(codec, 1000, &bitrates);
+  EXPECT_EQ(150u, bitrates[0]);
+  EXPECT_EQ(300u, bitrates[1]);
+  EXPECT_EQ(550u, bitrates[2]);
+  // No stream gets more than its max.
+  VP8EncoderImpl::GetStreamBitrates(codec, 5000, &bitrates);
+  EXPECT_EQ(800u, bitrates[2]);
+}
+
+// Decodes 1080p, upscaled from a CIF resource, with 1 to the number of cores
+// threads and reports the throughput and the decode time per frame.
+TEST_F(TestVp8Impl, DISABLED_DecodeThroughputBenchmark) {
+  const int kWidth = 1920;
+  const int kHeight = 1080;
+  const int kNumFrames = 60;
+  const VideoSource source(test::ResourcePath("foreman_cif", "yuv"), kCIF);
+  length_source_frame_ = source.GetFrameLength();
+  source_buffer_.reset(new uint8_t[length_source_frame_]);
+  source_file_ = fopen(source.GetFileName().c_str(), "rb");
+  ASSERT_TRUE(source_file_ != NULL);
+
+  codec_inst_.maxFramerate = source.GetFrameRate();
+  codec_inst_.startBitrate = 4000;
+  codec_inst_.maxBitrate = 8000;
+  codec_inst_.qpMax = 56;
+  codec_inst_.width = kWidth;
+  codec_inst_.height = kHeight;
+  codec_inst_.codecSpecific.VP8.numberOfTemporalLayers = 1;
+  Vp8UnitTestFrameCollector collector;
+  encoder_->RegisterEncodeCompleteCallback(&collector);
+  const int number_of_cores =
+      std::max(static_cast<int>(CpuInfo::DetectNumberOfCores()), 1);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder_->InitEncode(&codec_inst_, number_of_cores, 1440));
+
+  Scaler scaler;
+  ASSERT_EQ(0, scaler.Set(source.GetWidth(), source.GetHeight(),
+                          kWidth, kHeight, kI420, kI420, kScaleBilinear));
+  I420VideoFrame input_frame;
+  I420VideoFrame scaled_frame;
+  for (int i = 0; i < kNumFrames &&
+       fread(source_buffer_.get(), 1, length_source_frame_, source_file_) ==
+           length_source_frame_; ++i) {
+    EXPECT_EQ(0, ConvertToI420(kI420, source_buffer_.get(), 0, 0,
+                               source.GetWidth(), source.GetHeight(),
+                               0, kRotateNone, &input_frame));
+    ASSERT_EQ(0, scaler.Scale(input_frame, &scaled_frame));
+    scaled_frame.set_timestamp(90000 / codec_inst_.maxFramerate * i);
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder_->Encode(scaled_frame, NULL, NULL));
+  }
+  fclose(source_file_);
+  ASSERT_GT(collector.frames_.size(), 0u);
+  ASSERT_EQ(kKeyFrame, collector.frame_types_[0]);
+
+  printf("Decoding %d frames of %dx%d:\n",
+         static_cast<int>(collector.frames_.size()), kWidth, kHeight);
+  for (int cores = 1; cores <= number_of_cores; ++cores) {
+    scoped_ptr<VideoDecoder> decoder(VP8Decoder::Create());
+    Vp8UnitTestDecodeCounter counter;
+    decoder->RegisterDecodeCompleteCallback(&counter);
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, decoder->InitDecode(&codec_inst_, cores));
+    int64_t max_frame_time_us = 0;
+    const TickTime start = TickTime::Now();
+    for (size_t i = 0; i < collector.frames_.size(); ++i) {
+      EncodedImage encoded_image;
+      encoded_image._buffer = &collector.frames_[i][0];
+      encoded_image._length = collector.frames_[i].size();
+      encoded_image._size = collector.frames_[i].size();
+      encoded_image._frameType = collector.frame_types_[i];
+      encoded_image._timeStamp = collector.timestamps_[i];
+      encoded_image._encodedWidth = kWidth;
+      encoded_image._encodedHeight = kHeight;
+      encoded_image._completeFrame = true;
+      const TickTime frame_start = TickTime::Now();
+      EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+                decoder->Decode(encoded_image, false, NULL));
+      max_frame_time_us = std::max(
+          max_frame_time_us, (TickTime::Now() - frame_start).Microseconds());
+    }
+    const int64_t total_time_us = (TickTime::Now() - start).Microseconds();
+    EXPECT_EQ(static_cast<int>(collector.frames_.size()),
+              counter.decoded_frames_);
+    printf("  %2d cores (%d threads): %6.1f fps, %6.2f ms/frame average, "
+           "%6.2f ms max\n", cores,
+           VP8DecoderImpl::NumberOfThreads(kWidth, kHeight, cores),
+           collector.frames_.size() * 1e6 / std::max<int64_t>(total_time_us, 1),
+           total_time_us / 1000.0 / collector.frames_.size(),
+           max_frame_time_us / 1000.0);
+  }
+}
+
+TEST(Vp8EncoderImplTest, TokenPartitions) {
+  // The setting is log2 of the number of partitions.
+  EXPECT_EQ(0, VP8EncoderImpl::TokenPartitions(640, 480));
+  EXPECT_EQ(1, VP8EncoderImpl::TokenPartitions(1280, 720));
+  EXPECT_EQ(2, VP8EncoderImpl::TokenPartitions(1280, 1024));
+  EXPECT_EQ(3, VP8EncoderImpl::TokenPartitions(1920, 1080));
+}
+
+TEST(Vp8DecoderImplTest, NumberOfThreads) {
+  EXPECT_EQ(1, VP8DecoderImpl::NumberOfThreads(640, 480, 8));
+  EXPECT_EQ(2, VP8DecoderImpl::NumberOfThreads(1280, 720, 8));
+  EXPECT_EQ(1, VP8DecoderImpl::NumberOfThreads(1920, 1080, 1));
+  EXPECT_EQ(6, VP8DecoderImpl::NumberOfThreads(1920, 1080, 6));
+  EXPECT_EQ(8, VP8DecoderImpl::NumberOfThreads(1920, 1080, 16));
+  // Unknown resolution.
+  EXPECT_EQ(4, VP8DecoderImpl::NumberOfThreads(0, 0, 4));
+}
+
+TEST(Vp8EncoderImplTest, NumberOfThreads) {
+  EXPECT_EQ(1, VP8EncoderImpl::NumberOfThreads(640, 480, 8));
+  EXPECT_EQ(1, VP8EncoderImpl::NumberOfThreads(1280, 720, 1));
+  EXPECT_EQ(2, VP8EncoderImpl::NumberOfThreads(1280, 720, 2));
+  EXPECT_EQ(2, VP8EncoderImpl::NumberOfThreads(1920, 1080, 4));
+  EXPECT_EQ(3, VP8EncoderImpl::NumberOfThreads(1920, 1080, 6));
+  EXPECT_EQ(8, VP8EncoderImpl::NumberOfThreads(1920, 1080, 12));
+}
+
 }  // namespace webrtc
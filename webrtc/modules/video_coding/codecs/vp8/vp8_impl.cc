@@ -16,6 +16,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+
+#include <algorithm>
 #include <vector>
 
 #include "vpx/vpx_encoder.h"
@@ -23,6 +25,7 @@
 #include "vpx/vp8cx.h"
 #include "vpx/vp8dx.h"
 
+#include "webrtc/common_video/libyuv/include/scaler.h"
 #include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/video_coding/codecs/vp8/default_temporal_layers.h"
@@ -34,25 +37,48 @@ enum { kVp8ErrorPropagationTh = 30 };
 
 namespace webrtc {
 
+namespace {
+
+int GreatestCommonDivisor(int a, int b) {
+  while (b != 0) {
+    const int remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+  return a;
+}
+
+int StreamWidth(const VideoCodec& codec, int stream_idx) {
+  return codec.numberOfSimulcastStreams > 1 ?
+      codec.simulcastStream[stream_idx].width : codec.width;
+}
+
+int StreamHeight(const VideoCodec& codec, int stream_idx) {
+  return codec.numberOfSimulcastStreams > 1 ?
+      codec.simulcastStream[stream_idx].height : codec.height;
+}
+
+}  // namespace
+
 VP8Encoder* VP8Encoder::Create() {
   return new VP8EncoderImpl();
 }
 
 VP8EncoderImpl::VP8EncoderImpl()
-    : encoded_image_(),
-      encoded_complete_callback_(NULL),
+    : encoded_complete_callback_(NULL),
       inited_(false),
       timestamp_(0),
-      picture_id_(0),
       feedback_mode_(false),
       cpu_speed_(-6),  // default value
       rc_max_intra_target_(0),
       token_partitions_(VP8_ONE_TOKENPARTITION),
       rps_(new ReferencePictureSelection),
-      temporal_layers_(NULL),
-      encoder_(NULL),
-      config_(NULL),
-      raw_(NULL) {
+      num_streams_(0),
+      key_frame_request_(false),
+      encoders_(NULL),
+      configs_(NULL),
+      raw_images_(NULL),
+      downsampling_factors_(NULL) {
   memset(&codec_, 0, sizeof(codec_));
   uint32_t seed = static_cast<uint32_t>(TickTime::MillisecondTimestamp());
   srand(seed);
@@ -64,29 +90,148 @@ VP8EncoderImpl::~VP8EncoderImpl() {
 }
 
 int VP8EncoderImpl::Release() {
-  if (encoded_image_._buffer != NULL) {
-    delete [] encoded_image_._buffer;
-    encoded_image_._buffer = NULL;
+  int ret_val = WEBRTC_VIDEO_CODEC_OK;
+  for (size_t i = 0; i < encoded_images_.size(); ++i) {
+    delete [] encoded_images_[i]._buffer;
+  }
+  encoded_images_.clear();
+  if (encoders_ != NULL) {
+    if (inited_) {
+      for (int i = 0; i < num_streams_; ++i) {
+        if (vpx_codec_destroy(&encoders_[i])) {
+          ret_val = WEBRTC_VIDEO_CODEC_MEMORY;
+        }
+      }
+    }
+    delete [] encoders_;
+    encoders_ = NULL;
+  }
+  delete [] configs_;
+  configs_ = NULL;
+  // The images only wrap frame buffers, there is nothing to vpx_img_free().
+  delete [] raw_images_;
+  raw_images_ = NULL;
+  delete [] downsampling_factors_;
+  downsampling_factors_ = NULL;
+  scaled_frames_.reset();
+  scalers_.reset();
+  for (size_t i = 0; i < temporal_layers_.size(); ++i) {
+    delete temporal_layers_[i];
+  }
+  temporal_layers_.clear();
+  picture_ids_.clear();
+  send_stream_.clear();
+  num_streams_ = 0;
+  inited_ = false;
+  return ret_val;
+}
+
+int VP8EncoderImpl::NumberOfStreams(const VideoCodec& codec) {
+  if (codec.numberOfSimulcastStreams <= 1) {
+    return 1;
   }
-  if (encoder_ != NULL) {
-    if (vpx_codec_destroy(encoder_)) {
-      return WEBRTC_VIDEO_CODEC_MEMORY;
+  const int num_streams = codec.numberOfSimulcastStreams;
+  if (num_streams > kMaxSimulcastStreams) {
+    return -1;
+  }
+  // The top stream has the resolution of the codec, and no stream is larger
+  // than the one above it.
+  if (codec.simulcastStream[num_streams - 1].width != codec.width ||
+      codec.simulcastStream[num_streams - 1].height != codec.height) {
+    return -1;
+  }
+  for (int i = 0; i < num_streams; ++i) {
+    const SimulcastStream& stream = codec.simulcastStream[i];
+    if (stream.width < 1 || stream.height < 1) {
+      return -1;
+    }
+    if (i > 0 && (stream.width < codec.simulcastStream[i - 1].width ||
+                  stream.height < codec.simulcastStream[i - 1].height)) {
+      return -1;
     }
-    delete encoder_;
-    encoder_ = NULL;
   }
-  if (config_ != NULL) {
-    delete config_;
-    config_ = NULL;
+  return num_streams;
+}
+
+int VP8EncoderImpl::NumberOfThreads(int width, int height,
+                                    int number_of_cores) {
+  const int pixels = width * height;
+  if (pixels >= 1920 * 1080 && number_of_cores > 8) {
+    return 8;  // 8 threads for 1080p on high perf machines.
+  } else if (pixels > 1280 * 960 && number_of_cores >= 6) {
+    return 3;  // 3 threads for 1080p.
+  } else if (pixels > 640 * 480 && number_of_cores >= 2) {
+    return 2;  // 2 threads for qHD/HD.
+  }
+  return 1;  // 1 thread for VGA or less.
+}
+
+int VP8EncoderImpl::TokenPartitions(int width, int height) {
+  const int pixels = width * height;
+  if (pixels >= 1920 * 1080) {
+    return VP8_EIGHT_TOKENPARTITION;
+  } else if (pixels > 1280 * 960) {
+    return VP8_FOUR_TOKENPARTITION;
+  } else if (pixels > 640 * 480) {
+    return VP8_TWO_TOKENPARTITION;
   }
-  if (raw_ != NULL) {
-    vpx_img_free(raw_);
-    raw_ = NULL;
+  return VP8_ONE_TOKENPARTITION;
+}
+
+void VP8EncoderImpl::GetStreamBitrates(
+    const VideoCodec& codec, uint32_t bitrate_kbit,
+    std::vector<uint32_t>* stream_bitrates_kbit) {
+  if (codec.numberOfSimulcastStreams <= 1) {
+    stream_bitrates_kbit->assign(1, bitrate_kbit);
+    return;
+  }
+  const int num_streams = codec.numberOfSimulcastStreams;
+  stream_bitrates_kbit->assign(num_streams, 0);
+  // Give each stream up to its target, lowest first, for as long as the rest
+  // covers its min bit rate.
+  int last_active_stream = 0;
+  for (int i = 0; i < num_streams &&
+       bitrate_kbit >= codec.simulcastStream[i].minBitrate; ++i) {
+    last_active_stream = i;
+    const uint32_t allocated =
+        std::min(codec.simulcastStream[i].targetBitrate, bitrate_kbit);
+    (*stream_bitrates_kbit)[i] = allocated;
+    bitrate_kbit -= allocated;
+  }
+  // The highest active stream gets what is left, up to its max.
+  uint32_t& top = (*stream_bitrates_kbit)[last_active_stream];
+  const uint32_t max_bitrate =
+      codec.simulcastStream[last_active_stream].maxBitrate;
+  if (max_bitrate > top) {
+    top += std::min(max_bitrate - top, bitrate_kbit);
+  }
+}
+
+void VP8EncoderImpl::SetStreamBitrates(uint32_t bitrate_kbit,
+                                       uint32_t max_bitrate_kbit,
+                                       uint32_t framerate) {
+  std::vector<uint32_t> stream_bitrates;
+  GetStreamBitrates(codec_, bitrate_kbit, &stream_bitrates);
+  for (int stream_idx = 0; stream_idx < num_streams_; ++stream_idx) {
+    uint32_t stream_bitrate = stream_bitrates[stream_idx];
+    uint32_t stream_max_bitrate = max_bitrate_kbit;
+    const bool send_stream = stream_idx == 0 || stream_bitrate > 0;
+    if (num_streams_ > 1) {
+      const SimulcastStream& stream = codec_.simulcastStream[stream_idx];
+      stream_max_bitrate = stream.maxBitrate;
+      if (!send_stream) {
+        stream_bitrate = std::max(stream.minBitrate, 1u);
+      }
+    }
+    if (send_stream && !send_stream_[stream_idx]) {
+      key_frame_request_ = true;
+    }
+    send_stream_[stream_idx] = send_stream;
+    vpx_codec_enc_cfg_t* config = &configs_[EncoderIndex(stream_idx)];
+    config->rc_target_bitrate = stream_bitrate;  // in kbit/s
+    temporal_layers_[stream_idx]->ConfigureBitrates(
+        stream_bitrate, stream_max_bitrate, framerate, config);
   }
-  delete temporal_layers_;
-  temporal_layers_ = NULL;
-  inited_ = false;
-  return WEBRTC_VIDEO_CODEC_OK;
 }
 
 int VP8EncoderImpl::SetRates(uint32_t new_bitrate_kbit,
@@ -94,8 +239,10 @@ int VP8EncoderImpl::SetRates(uint32_t new_bitrate_kbit,
   if (!inited_) {
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
-  if (encoder_->err) {
-    return WEBRTC_VIDEO_CODEC_ERROR;
+  for (int i = 0; i < num_streams_; ++i) {
+    if (encoders_[i].err) {
+      return WEBRTC_VIDEO_CODEC_ERROR;
+    }
   }
   if (new_framerate < 1) {
     return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
@@ -104,14 +251,14 @@ int VP8EncoderImpl::SetRates(uint32_t new_bitrate_kbit,
   if (codec_.maxBitrate > 0 && new_bitrate_kbit > codec_.maxBitrate) {
     new_bitrate_kbit = codec_.maxBitrate;
   }
-  config_->rc_target_bitrate = new_bitrate_kbit;  // in kbit/s
-  temporal_layers_->ConfigureBitrates(new_bitrate_kbit, codec_.maxBitrate,
-                                      new_framerate, config_);
+  SetStreamBitrates(new_bitrate_kbit, codec_.maxBitrate, new_framerate);
   codec_.maxFramerate = new_framerate;
 
   // update encoder context
-  if (vpx_codec_enc_config_set(encoder_, config_)) {
-    return WEBRTC_VIDEO_CODEC_ERROR;
+  for (int i = 0; i < num_streams_; ++i) {
+    if (vpx_codec_enc_config_set(&encoders_[i], &configs_[i])) {
+      return WEBRTC_VIDEO_CODEC_ERROR;
+    }
   }
   return WEBRTC_VIDEO_CODEC_OK;
 }
@@ -135,115 +282,152 @@ int VP8EncoderImpl::InitEncode(const VideoCodec* inst,
   if (number_of_cores < 1) {
     return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
   }
-  feedback_mode_ = inst->codecSpecific.VP8.feedbackModeOn;
+  const int num_streams = NumberOfStreams(*inst);
+  if (num_streams < 0) {
+    return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+  }
+  // Reference picture selection is done for a single stream only.
+  feedback_mode_ = inst->codecSpecific.VP8.feedbackModeOn && num_streams == 1;
 
   int retVal = Release();
   if (retVal < 0) {
     return retVal;
   }
-  if (encoder_ == NULL) {
-    encoder_ = new vpx_codec_ctx_t;
-  }
-  if (config_ == NULL) {
-    config_ = new vpx_codec_enc_cfg_t;
-  }
+  num_streams_ = num_streams;
+  encoders_ = new vpx_codec_ctx_t[num_streams_]();
+  configs_ = new vpx_codec_enc_cfg_t[num_streams_]();
+  raw_images_ = new vpx_image_t[num_streams_]();
+  downsampling_factors_ = new vpx_rational_t[num_streams_]();
+  scaled_frames_.reset(new I420VideoFrame[num_streams_]);
+  scalers_.reset(new Scaler[num_streams_]);
   timestamp_ = 0;
+  key_frame_request_ = false;
 
   if (&codec_ != inst) {
     codec_ = *inst;
   }
 
+  // All streams are encoded by one call with the same flags, and therefore
+  // have the same temporal layers.
   int num_temporal_layers = inst->codecSpecific.VP8.numberOfTemporalLayers > 1 ?
       inst->codecSpecific.VP8.numberOfTemporalLayers : 1;
-  assert(temporal_layers_ == NULL);
-  temporal_layers_ = new DefaultTemporalLayers(num_temporal_layers, rand());
-  // random start 16 bits is enough.
-  picture_id_ = static_cast<uint16_t>(rand()) & 0x7FFF;
-
-  // allocate memory for encoded image
-  if (encoded_image_._buffer != NULL) {
-    delete [] encoded_image_._buffer;
-  }
-  encoded_image_._size = CalcBufferSize(kI420, codec_.width, codec_.height);
-  encoded_image_._buffer = new uint8_t[encoded_image_._size];
-  encoded_image_._completeFrame = true;
-
-  // Creating a wrapper to the image - setting image data to NULL. Actual
-  // pointer will be set in encode. Setting align to 1, as it is meaningless
-  // (actual memory is not allocated).
-  raw_ = vpx_img_wrap(NULL, IMG_FMT_I420, codec_.width, codec_.height,
-                      1, NULL);
+  encoded_images_.resize(num_streams_);
+  picture_ids_.resize(num_streams_);
+  temporal_layers_.resize(num_streams_);
+  send_stream_.assign(num_streams_, true);
+  for (int stream_idx = 0; stream_idx < num_streams_; ++stream_idx) {
+    temporal_layers_[stream_idx] =
+        new DefaultTemporalLayers(num_temporal_layers, rand());
+    // random start 16 bits is enough.
+    picture_ids_[stream_idx] = static_cast<uint16_t>(rand()) & 0x7FFF;
+
+    // allocate memory for encoded image
+    EncodedImage& encoded_image = encoded_images_[stream_idx];
+    encoded_image._size = CalcBufferSize(kI420,
+                                         StreamWidth(codec_, stream_idx),
+                                         StreamHeight(codec_, stream_idx));
+    encoded_image._buffer = new uint8_t[encoded_image._size];
+    encoded_image._completeFrame = true;
+  }
+
   // populate encoder configuration with default values
-  if (vpx_codec_enc_config_default(vpx_codec_vp8_cx(), config_, 0)) {
+  if (vpx_codec_enc_config_default(vpx_codec_vp8_cx(), &configs_[0], 0)) {
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
-  config_->g_w = codec_.width;
-  config_->g_h = codec_.height;
-  config_->rc_target_bitrate = inst->startBitrate;  // in kbit/s
-  temporal_layers_->ConfigureBitrates(inst->startBitrate, inst->maxBitrate,
-                                      inst->maxFramerate, config_);
+  vpx_codec_enc_cfg_t* config = &configs_[0];
   // setting the time base of the codec
-  config_->g_timebase.num = 1;
-  config_->g_timebase.den = 90000;
+  config->g_timebase.num = 1;
+  config->g_timebase.den = 90000;
 
   // Set the error resilience mode according to user settings.
   switch (inst->codecSpecific.VP8.resilience) {
     case kResilienceOff:
-      config_->g_error_resilient = 0;
+      config->g_error_resilient = 0;
       if (num_temporal_layers > 1) {
         // Must be on for temporal layers (i.e., |num_temporal_layers| > 1).
-        config_->g_error_resilient = 1;
+        config->g_error_resilient = 1;
       }
       break;
     case kResilientStream:
-      config_->g_error_resilient = 1;  // TODO(holmer): Replace with
+      config->g_error_resilient = 1;  // TODO(holmer): Replace with
       // VPX_ERROR_RESILIENT_DEFAULT when we
       // drop support for libvpx 9.6.0.
       break;
     case kResilientFrames:
 #ifdef INDEPENDENT_PARTITIONS
-      config_->g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT |
+      config->g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT |
       VPX_ERROR_RESILIENT_PARTITIONS;
       break;
 #else
       return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;  // Not supported
 #endif
   }
-  config_->g_lag_in_frames = 0;  // 0- no frame lagging
-
-  if (codec_.width * codec_.height > 640 * 480 && number_of_cores >= 2) {
-    config_->g_threads = 2;  // 2 threads for qHD/HD.
-  } else {
-    config_->g_threads = 1;  // 1 thread for VGA or less
-  }
+  config->g_lag_in_frames = 0;  // 0- no frame lagging
 
   // rate control settings
-  config_->rc_dropframe_thresh = inst->codecSpecific.VP8.frameDroppingOn ?
+  config->rc_dropframe_thresh = inst->codecSpecific.VP8.frameDroppingOn ?
       30 : 0;
-  config_->rc_end_usage = VPX_CBR;
-  config_->g_pass = VPX_RC_ONE_PASS;
-  config_->rc_resize_allowed = inst->codecSpecific.VP8.automaticResizeOn ?
-      1 : 0;
-  config_->rc_min_quantizer = 2;
-  config_->rc_max_quantizer = inst->qpMax;
-  config_->rc_undershoot_pct = 100;
-  config_->rc_overshoot_pct = 15;
-  config_->rc_buf_initial_sz = 500;
-  config_->rc_buf_optimal_sz = 600;
-  config_->rc_buf_sz = 1000;
+  config->rc_end_usage = VPX_CBR;
+  config->g_pass = VPX_RC_ONE_PASS;
+  // The streams of a multi-resolution encoder must keep their resolution.
+  config->rc_resize_allowed =
+      inst->codecSpecific.VP8.automaticResizeOn && num_streams_ == 1 ? 1 : 0;
+  config->rc_min_quantizer = 2;
+  config->rc_max_quantizer = inst->qpMax;
+  config->rc_undershoot_pct = 100;
+  config->rc_overshoot_pct = 15;
+  config->rc_buf_initial_sz = 500;
+  config->rc_buf_optimal_sz = 600;
+  config->rc_buf_sz = 1000;
   // set the maximum target size of any key-frame.
-  rc_max_intra_target_ = MaxIntraTarget(config_->rc_buf_optimal_sz);
+  rc_max_intra_target_ = MaxIntraTarget(config->rc_buf_optimal_sz);
 
   if (feedback_mode_) {
     // Disable periodic key frames if we get feedback from the decoder
     // through SLI and RPSI.
-    config_->kf_mode = VPX_KF_DISABLED;
+    config->kf_mode = VPX_KF_DISABLED;
   } else if (inst->codecSpecific.VP8.keyFrameInterval  > 0) {
-    config_->kf_mode = VPX_KF_AUTO;
-    config_->kf_max_dist = inst->codecSpecific.VP8.keyFrameInterval;
+    config->kf_mode = VPX_KF_AUTO;
+    config->kf_max_dist = inst->codecSpecific.VP8.keyFrameInterval;
   } else {
-    config_->kf_mode = VPX_KF_DISABLED;
+    config->kf_mode = VPX_KF_DISABLED;
   }
+
+  // The lower streams share these settings and differ in resolution, thread
+  // count and rate.
+  for (int i = 0; i < num_streams_; ++i) {
+    const int stream_idx = EncoderIndex(i);
+    const int width = StreamWidth(codec_, stream_idx);
+    const int height = StreamHeight(codec_, stream_idx);
+    if (i > 0) {
+      configs_[i] = configs_[0];
+    }
+    configs_[i].g_w = width;
+    configs_[i].g_h = height;
+    configs_[i].g_threads = NumberOfThreads(width, height, number_of_cores);
+
+    // Creating a wrapper to the image - setting image data to NULL. Actual
+    // pointer will be set in encode. Setting align to 1, as it is meaningless
+    // (actual memory is not allocated).
+    vpx_img_wrap(&raw_images_[i], IMG_FMT_I420, width, height, 1, NULL);
+
+    // Factor from the resolution of this encoder to the next one.
+    downsampling_factors_[i].num = 1;
+    downsampling_factors_[i].den = 1;
+    if (i > 0) {
+      const int above_width = StreamWidth(codec_, stream_idx + 1);
+      const int above_height = StreamHeight(codec_, stream_idx + 1);
+      const int divisor = GreatestCommonDivisor(above_width, width);
+      downsampling_factors_[i - 1].num = above_width / divisor;
+      downsampling_factors_[i - 1].den = width / divisor;
+      if (scalers_[i].Set(above_width, above_height, width, height,
+                          kI420, kI420, kScaleBox) < 0) {
+        return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+      }
+    }
+  }
+  SetStreamBitrates(inst->startBitrate, inst->maxBitrate, inst->maxFramerate);
+
   switch (inst->codecSpecific.VP8.complexity) {
     case kComplexityHigh:
       cpu_speed_ = -5;
@@ -263,6 +447,8 @@ int VP8EncoderImpl::InitEncode(const VideoCodec* inst,
   // and video quality
   cpu_speed_ = -12;
 #endif
+  // All streams use the partitioning of the top stream.
+  token_partitions_ = TokenPartitions(codec_.width, codec_.height);
   rps_->Init();
   return InitAndSetControlSettings(inst);
 }
@@ -273,20 +459,29 @@ int VP8EncoderImpl::InitAndSetControlSettings(const VideoCodec* inst) {
   // partitions. Eight is probably not the optimal number for low resolution
   // video.
   flags |= VPX_CODEC_USE_OUTPUT_PARTITION;
-  if (vpx_codec_enc_init(encoder_, vpx_codec_vp8_cx(), config_, flags)) {
+  if (num_streams_ > 1) {
+    if (vpx_codec_enc_init_multi(encoders_, vpx_codec_vp8_cx(), configs_,
+                                 num_streams_, flags, downsampling_factors_)) {
+      return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+    }
+  } else if (vpx_codec_enc_init(encoders_, vpx_codec_vp8_cx(), configs_,
+                                flags)) {
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
-  vpx_codec_control(encoder_, VP8E_SET_STATIC_THRESHOLD, 1);
-  vpx_codec_control(encoder_, VP8E_SET_CPUUSED, cpu_speed_);
-  vpx_codec_control(encoder_, VP8E_SET_TOKEN_PARTITIONS,
-                    static_cast<vp8e_token_partitions>(token_partitions_));
+  for (int i = 0; i < num_streams_; ++i) {
+    vpx_codec_ctx_t* encoder = &encoders_[i];
+    vpx_codec_control(encoder, VP8E_SET_STATIC_THRESHOLD, 1);
+    vpx_codec_control(encoder, VP8E_SET_CPUUSED, cpu_speed_);
+    vpx_codec_control(encoder, VP8E_SET_TOKEN_PARTITIONS,
+                      static_cast<vp8e_token_partitions>(token_partitions_));
 #if !defined(WEBRTC_ARCH_ARM)
-  // TODO(fbarchard): Enable Noise reduction for ARM once optimized.
-  vpx_codec_control(encoder_, VP8E_SET_NOISE_SENSITIVITY,
-                    inst->codecSpecific.VP8.denoisingOn ? 1 : 0);
+    // TODO(fbarchard): Enable Noise reduction for ARM once optimized.
+    vpx_codec_control(encoder, VP8E_SET_NOISE_SENSITIVITY,
+                      inst->codecSpecific.VP8.denoisingOn ? 1 : 0);
 #endif
-  vpx_codec_control(encoder_, VP8E_SET_MAX_INTRA_BITRATE_PCT,
-                    rc_max_intra_target_);
+    vpx_codec_control(encoder, VP8E_SET_MAX_INTRA_BITRATE_PCT,
+                      rc_max_intra_target_);
+  }
   inited_ = true;
   return WEBRTC_VIDEO_CODEC_OK;
 }
@@ -322,15 +517,24 @@ int VP8EncoderImpl::Encode(const I420VideoFrame& input_image,
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
 
-  VideoFrameType frame_type = kDeltaFrame;
-  // We only support one stream at the moment.
-  if (frame_types && frame_types->size() > 0) {
-    frame_type = (*frame_types)[0];
+  // All streams are encoded with the same flags, so a key frame requested
+  // for any of them is produced for all.
+  bool send_keyframe = key_frame_request_;
+  if (frame_types) {
+    for (size_t i = 0; i < frame_types->size(); ++i) {
+      if ((*frame_types)[i] == kKeyFrame) {
+        send_keyframe = true;
+      }
+    }
   }
 
   // Check for change in frame size.
   if (input_image.width() != codec_.width ||
       input_image.height() != codec_.height) {
+    if (num_streams_ > 1) {
+      // The simulcast resolutions are fixed at InitEncode().
+      return WEBRTC_VIDEO_CODEC_ERR_SIZE;
+    }
     int ret = UpdateCodecFrameSize(input_image);
     if (ret < 0) {
       return ret;
@@ -338,21 +542,38 @@ int VP8EncoderImpl::Encode(const I420VideoFrame& input_image,
   }
   // Image in vpx_image_t format.
   // Input image is const. VP8's raw image is not defined as const.
-  raw_->planes[PLANE_Y] = const_cast<uint8_t*>(input_image.buffer(kYPlane));
-  raw_->planes[PLANE_U] = const_cast<uint8_t*>(input_image.buffer(kUPlane));
-  raw_->planes[PLANE_V] = const_cast<uint8_t*>(input_image.buffer(kVPlane));
-  // TODO(mikhal): Stride should be set in initialization.
-  raw_->stride[VPX_PLANE_Y] = input_image.stride(kYPlane);
-  raw_->stride[VPX_PLANE_U] = input_image.stride(kUPlane);
-  raw_->stride[VPX_PLANE_V] = input_image.stride(kVPlane);
+  for (int i = 0; i < num_streams_; ++i) {
+    if (i > 0) {
+      // Scale down from the stream above, so that each stream is scaled once.
+      const I420VideoFrame& above =
+          i == 1 ? input_image : scaled_frames_[i - 1];
+      if (scalers_[i].Scale(above, &scaled_frames_[i]) < 0) {
+        return WEBRTC_VIDEO_CODEC_ERROR;
+      }
+    }
+    const I420VideoFrame& image = i == 0 ? input_image : scaled_frames_[i];
+    vpx_image_t* raw = &raw_images_[i];
+    raw->planes[PLANE_Y] = const_cast<uint8_t*>(image.buffer(kYPlane));
+    raw->planes[PLANE_U] = const_cast<uint8_t*>(image.buffer(kUPlane));
+    raw->planes[PLANE_V] = const_cast<uint8_t*>(image.buffer(kVPlane));
+    // TODO(mikhal): Stride should be set in initialization.
+    raw->stride[VPX_PLANE_Y] = image.stride(kYPlane);
+    raw->stride[VPX_PLANE_U] = image.stride(kUPlane);
+    raw->stride[VPX_PLANE_V] = image.stride(kVPlane);
+  }
 
-  int flags = temporal_layers_->EncodeFlags(input_image.timestamp());
+  // The temporal layers of all streams advance in step; the top stream's
+  // flags are used.
+  int flags = 0;
+  for (int stream_idx = 0; stream_idx < num_streams_; ++stream_idx) {
+    flags = temporal_layers_[stream_idx]->EncodeFlags(input_image.timestamp());
+  }
 
-  bool send_keyframe = (frame_type == kKeyFrame);
   if (send_keyframe) {
     // Key frame request from caller.
     // Will update both golden and alt-ref.
     flags = VPX_EFLAG_FORCE_KF;
+    key_frame_request_ = false;
   } else if (feedback_mode_ && codec_specific_info) {
     // Handle RPSI and SLI messages and set up the appropriate encode flags.
     bool sendRefresh = false;
@@ -365,7 +586,7 @@ int VP8EncoderImpl::Encode(const I420VideoFrame& input_image,
         sendRefresh = rps_->ReceivedSLI(input_image.timestamp());
       }
     }
-    flags = rps_->EncodeFlags(picture_id_, sendRefresh,
+    flags = rps_->EncodeFlags(picture_ids_[0], sendRefresh,
                               input_image.timestamp());
   }
 
@@ -376,7 +597,8 @@ int VP8EncoderImpl::Encode(const I420VideoFrame& input_image,
   // frame rate to calculate an average duration for now.
   assert(codec_.maxFramerate > 0);
   uint32_t duration = 90000 / codec_.maxFramerate;
-  if (vpx_codec_encode(encoder_, raw_, timestamp_, duration, flags,
+  // With several streams, this encodes all of them.
+  if (vpx_codec_encode(encoders_, raw_images_, timestamp_, duration, flags,
                        VPX_DL_REALTIME)) {
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
@@ -386,92 +608,105 @@ int VP8EncoderImpl::Encode(const I420VideoFrame& input_image,
 }
 
 int VP8EncoderImpl::UpdateCodecFrameSize(const I420VideoFrame& input_image) {
+  assert(num_streams_ == 1);
   codec_.width = input_image.width();
   codec_.height = input_image.height();
-  raw_->w = codec_.width;
-  raw_->h = codec_.height;
-  raw_->d_w = codec_.width;
-  raw_->d_h = codec_.height;
+  vpx_image_t* raw = &raw_images_[0];
+  raw->w = codec_.width;
+  raw->h = codec_.height;
+  raw->d_w = codec_.width;
+  raw->d_h = codec_.height;
 
-  raw_->stride[VPX_PLANE_Y] = input_image.stride(kYPlane);
-  raw_->stride[VPX_PLANE_U] = input_image.stride(kUPlane);
-  raw_->stride[VPX_PLANE_V] = input_image.stride(kVPlane);
-  vpx_img_set_rect(raw_, 0, 0, codec_.width, codec_.height);
+  raw->stride[VPX_PLANE_Y] = input_image.stride(kYPlane);
+  raw->stride[VPX_PLANE_U] = input_image.stride(kUPlane);
+  raw->stride[VPX_PLANE_V] = input_image.stride(kVPlane);
+  vpx_img_set_rect(raw, 0, 0, codec_.width, codec_.height);
 
   // Update encoder context for new frame size.
   // Change of frame size will automatically trigger a key frame.
-  config_->g_w = codec_.width;
-  config_->g_h = codec_.height;
-  if (vpx_codec_enc_config_set(encoder_, config_)) {
+  configs_[0].g_w = codec_.width;
+  configs_[0].g_h = codec_.height;
+  if (vpx_codec_enc_config_set(&encoders_[0], &configs_[0])) {
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
 void VP8EncoderImpl::PopulateCodecSpecific(CodecSpecificInfo* codec_specific,
-                                       const vpx_codec_cx_pkt& pkt,
-                                       uint32_t timestamp) {
+                                           const vpx_codec_cx_pkt& pkt,
+                                           int stream_idx,
+                                           uint32_t timestamp) {
   assert(codec_specific != NULL);
   codec_specific->codecType = kVideoCodecVP8;
   CodecSpecificInfoVP8 *vp8Info = &(codec_specific->codecSpecific.VP8);
-  vp8Info->pictureId = picture_id_;
-  vp8Info->simulcastIdx = 0;
+  vp8Info->pictureId = picture_ids_[stream_idx];
+  vp8Info->simulcastIdx = stream_idx;
   vp8Info->keyIdx = kNoKeyIdx;  // TODO(hlundin) populate this
   vp8Info->nonReference = (pkt.data.frame.flags & VPX_FRAME_IS_DROPPABLE) != 0;
-  temporal_layers_->PopulateCodecSpecific(
+  temporal_layers_[stream_idx]->PopulateCodecSpecific(
       (pkt.data.frame.flags & VPX_FRAME_IS_KEY) ? true : false, vp8Info,
           timestamp);
-  picture_id_ = (picture_id_ + 1) & 0x7FFF;  // prepare next
+  // prepare next
+  picture_ids_[stream_idx] = (picture_ids_[stream_idx] + 1) & 0x7FFF;
 }
 
 int VP8EncoderImpl::GetEncodedPartitions(const I420VideoFrame& input_image) {
-  vpx_codec_iter_t iter = NULL;
-  int part_idx = 0;
-  encoded_image_._length = 0;
-  encoded_image_._frameType = kDeltaFrame;
-  RTPFragmentationHeader frag_info;
-  frag_info.VerifyAndAllocateFragmentationHeader((1 << token_partitions_) + 1);
-  CodecSpecificInfo codec_specific;
-
-  const vpx_codec_cx_pkt_t *pkt = NULL;
-  while ((pkt = vpx_codec_get_cx_data(encoder_, &iter)) != NULL) {
-    switch (pkt->kind) {
-      case VPX_CODEC_CX_FRAME_PKT: {
-        memcpy(&encoded_image_._buffer[encoded_image_._length],
-               pkt->data.frame.buf,
-               pkt->data.frame.sz);
-        frag_info.fragmentationOffset[part_idx] = encoded_image_._length;
-        frag_info.fragmentationLength[part_idx] =  pkt->data.frame.sz;
-        frag_info.fragmentationPlType[part_idx] = 0;  // not known here
-        frag_info.fragmentationTimeDiff[part_idx] = 0;
-        encoded_image_._length += pkt->data.frame.sz;
-        assert(encoded_image_._length <= encoded_image_._size);
-        ++part_idx;
-        break;
+  for (int stream_idx = 0; stream_idx < num_streams_; ++stream_idx) {
+    const int encoder_idx = EncoderIndex(stream_idx);
+    EncodedImage& encoded_image = encoded_images_[stream_idx];
+    vpx_codec_iter_t iter = NULL;
+    int part_idx = 0;
+    encoded_image._length = 0;
+    encoded_image._frameType = kDeltaFrame;
+    RTPFragmentationHeader frag_info;
+    frag_info.VerifyAndAllocateFragmentationHeader(
+        (1 << token_partitions_) + 1);
+    CodecSpecificInfo codec_specific;
+
+    const vpx_codec_cx_pkt_t *pkt = NULL;
+    while ((pkt = vpx_codec_get_cx_data(&encoders_[encoder_idx], &iter)) !=
+           NULL) {
+      switch (pkt->kind) {
+        case VPX_CODEC_CX_FRAME_PKT: {
+          memcpy(&encoded_image._buffer[encoded_image._length],
+                 pkt->data.frame.buf,
+                 pkt->data.frame.sz);
+          frag_info.fragmentationOffset[part_idx] = encoded_image._length;
+          frag_info.fragmentationLength[part_idx] =  pkt->data.frame.sz;
+          frag_info.fragmentationPlType[part_idx] = 0;  // not known here
+          frag_info.fragmentationTimeDiff[part_idx] = 0;
+          encoded_image._length += pkt->data.frame.sz;
+          assert(encoded_image._length <= encoded_image._size);
+          ++part_idx;
+          break;
+        }
+        default: {
+          break;
+        }
       }
-      default: {
+      // End of frame
+      if ((pkt->data.frame.flags & VPX_FRAME_IS_FRAGMENT) == 0) {
+        // check if encoded frame is a key frame
+        if (pkt->data.frame.flags & VPX_FRAME_IS_KEY) {
+            encoded_image._frameType = kKeyFrame;
+            if (num_streams_ == 1) {
+              rps_->EncodedKeyFrame(picture_ids_[stream_idx]);
+            }
+        }
+        PopulateCodecSpecific(&codec_specific, *pkt, stream_idx,
+                              input_image.timestamp());
         break;
       }
     }
-    // End of frame
-    if ((pkt->data.frame.flags & VPX_FRAME_IS_FRAGMENT) == 0) {
-      // check if encoded frame is a key frame
-      if (pkt->data.frame.flags & VPX_FRAME_IS_KEY) {
-          encoded_image_._frameType = kKeyFrame;
-          rps_->EncodedKeyFrame(picture_id_);
-      }
-      PopulateCodecSpecific(&codec_specific, *pkt, input_image.timestamp());
-      break;
+    if (encoded_image._length > 0 && send_stream_[stream_idx]) {
+      encoded_image._timeStamp = input_image.timestamp();
+      encoded_image.capture_time_ms_ = input_image.render_time_ms();
+      encoded_image._encodedHeight = raw_images_[encoder_idx].h;
+      encoded_image._encodedWidth = raw_images_[encoder_idx].w;
+      encoded_complete_callback_->Encoded(encoded_image, &codec_specific,
+                                          &frag_info);
     }
   }
-  if (encoded_image_._length > 0) {
-    encoded_image_._timeStamp = input_image.timestamp();
-    encoded_image_.capture_time_ms_ = input_image.render_time_ms();
-    encoded_image_._encodedHeight = raw_->h;
-    encoded_image_._encodedWidth = raw_->w;
-    encoded_complete_callback_->Encoded(encoded_image_, &codec_specific,
-                                      &frag_info);
-  }
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
@@ -495,6 +730,7 @@ VP8DecoderImpl::VP8DecoderImpl()
       inited_(false),
       feedback_mode_(false),
       decoder_(NULL),
+      number_of_cores_(1),
       last_keyframe_(),
       image_format_(VPX_IMG_FMT_NONE),
       ref_frame_(NULL),
@@ -509,11 +745,20 @@ VP8DecoderImpl::~VP8DecoderImpl() {
   Release();
 }
 
+int VP8DecoderImpl::NumberOfThreads(int width, int height,
+                                    int number_of_cores) {
+  int max_threads = 1 << VP8EncoderImpl::TokenPartitions(width, height);
+  if (width <= 0 || height <= 0) {
+    max_threads = 1 << VP8_EIGHT_TOKENPARTITION;
+  }
+  return std::min(number_of_cores, max_threads);
+}
+
 int VP8DecoderImpl::Reset() {
   if (!inited_) {
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
-  InitDecode(&codec_, 1);
+  InitDecode(&codec_, number_of_cores_);
   propagation_cnt_ = -1;
   latest_keyframe_complete_ = false;
   mfqe_enabled_ = false;
@@ -534,9 +779,9 @@ int VP8DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
   if (inst->codecType == kVideoCodecVP8) {
     feedback_mode_ = inst->codecSpecific.VP8.feedbackModeOn;
   }
+  number_of_cores_ = std::max(number_of_cores, 1);
   vpx_codec_dec_cfg_t  cfg;
-  // Setting number of threads to a constant value (1)
-  cfg.threads = 1;
+  cfg.threads = NumberOfThreads(inst->width, inst->height, number_of_cores_);
   cfg.h = cfg.w = 0;  // set after decode
 
   vpx_codec_flags_t flags = 0;
@@ -849,7 +1094,7 @@ VideoDecoder* VP8DecoderImpl::Copy() {
   VP8DecoderImpl *copy = new VP8DecoderImpl;
 
   // Initialize the new decoder
-  if (copy->InitDecode(&codec_, 1) != WEBRTC_VIDEO_CODEC_OK) {
+  if (copy->InitDecode(&codec_, number_of_cores_) != WEBRTC_VIDEO_CODEC_OK) {
     delete copy;
     return NULL;
   }
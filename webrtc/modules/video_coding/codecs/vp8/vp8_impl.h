@@ -13,7 +13,10 @@
 #ifndef WEBRTC_MODULES_VIDEO_CODING_CODECS_VP8_IMPL_H_
 #define WEBRTC_MODULES_VIDEO_CODING_CODECS_VP8_IMPL_H_
 
+#include <vector>
+
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
+#include "system_wrappers/interface/scoped_ptr.h"
 
 // VPX forward declaration
 typedef struct vpx_codec_ctx vpx_codec_ctx_t;
@@ -21,13 +24,21 @@ typedef struct vpx_codec_ctx vpx_dec_ctx_t;
 typedef struct vpx_codec_enc_cfg vpx_codec_enc_cfg_t;
 typedef struct vpx_image vpx_image_t;
 typedef struct vpx_ref_frame vpx_ref_frame_t;
+typedef struct vpx_rational vpx_rational_t;
 struct vpx_codec_cx_pkt;
 
 namespace webrtc {
 
+class Scaler;
 class TemporalLayers;
 class ReferencePictureSelection;
 
+// Encodes one stream, or with simulcast, all the streams of
+// VideoCodec::simulcastStream[] with one libvpx multi-resolution encoder.
+// The input frame is scaled down once per lower stream, each from the stream
+// above it, and each stream gets its share of the rate set by SetRates().
+// Encoded streams are delivered lowest resolution first, with
+// CodecSpecificInfoVP8::simulcastIdx set to the stream index.
 class VP8EncoderImpl : public VP8Encoder {
  public:
   VP8EncoderImpl();
@@ -95,7 +106,12 @@ class VP8EncoderImpl : public VP8Encoder {
   //
   virtual int SetChannelParameters(uint32_t packet_loss, int rtt);
 
-  // Inform the encoder about the new target bit rate.
+  // Inform the encoder about the new target bit rate. With simulcast, the
+  // rate is split over the streams: each stream in turn, starting with the
+  // lowest resolution, gets up to its target bit rate as long as the rest
+  // covers its min bit rate, and the highest stream that got any takes what
+  // is left, up to its max bit rate. Streams that get nothing are still
+  // encoded at their min bit rate but are not delivered.
   //
   //          - new_bitrate_kbit : New target bit rate
   //          - frame_rate       : The target frame rate
@@ -103,15 +119,47 @@ class VP8EncoderImpl : public VP8Encoder {
   // Return value                : WEBRTC_VIDEO_CODEC_OK if OK, < 0 otherwise.
   virtual int SetRates(uint32_t new_bitrate_kbit, uint32_t frame_rate);
 
+  // Returns the number of encoder threads to use for a stream of the given
+  // resolution.
+  static int NumberOfThreads(int width, int height, int number_of_cores);
+
+  // Returns the token partition setting, a vp8e_token_partitions value, for
+  // a stream of the given resolution. Frames larger than VGA are split into
+  // several token partitions so that receivers can decode them with
+  // multiple threads, see VP8DecoderImpl::NumberOfThreads().
+  static int TokenPartitions(int width, int height);
+
+  // Splits |bitrate_kbit| over the streams of |codec| as described for
+  // SetRates(). |stream_bitrates_kbit| gets one entry per stream, lowest
+  // resolution first.
+  static void GetStreamBitrates(const VideoCodec& codec, uint32_t bitrate_kbit,
+                                std::vector<uint32_t>* stream_bitrates_kbit);
+
  private:
+  // Returns the number of streams to encode, or -1 if the simulcast settings
+  // of |codec| are not supported.
+  static int NumberOfStreams(const VideoCodec& codec);
+
   // Call encoder initialize function and set control settings.
   int InitAndSetControlSettings(const VideoCodec* inst);
 
+  // Applies the stream bit rates for a total of |bitrate_kbit| to the
+  // configurations.
+  void SetStreamBitrates(uint32_t bitrate_kbit, uint32_t max_bitrate_kbit,
+                         uint32_t framerate);
+
   // Update frame size for codec.
   int UpdateCodecFrameSize(const I420VideoFrame& input_image);
 
+  // Encoder, configuration and image of stream |stream_idx|. libvpx orders
+  // the multi-resolution encoders highest resolution first.
+  int EncoderIndex(int stream_idx) const {
+    return num_streams_ - 1 - stream_idx;
+  }
+
   void PopulateCodecSpecific(CodecSpecificInfo* codec_specific,
                              const vpx_codec_cx_pkt& pkt,
+                             int stream_idx,
                              uint32_t timestamp);
 
   int GetEncodedPartitions(const I420VideoFrame& input_image);
@@ -124,21 +172,35 @@ class VP8EncoderImpl : public VP8Encoder {
   //                            percentage of the per frame bandwidth
   uint32_t MaxIntraTarget(uint32_t optimal_buffer_size);
 
-  EncodedImage encoded_image_;
   EncodedImageCallback* encoded_complete_callback_;
   VideoCodec codec_;
   bool inited_;
   int64_t timestamp_;
-  uint16_t picture_id_;
   bool feedback_mode_;
   int cpu_speed_;
   uint32_t rc_max_intra_target_;
   int token_partitions_;
   ReferencePictureSelection* rps_;
-  TemporalLayers* temporal_layers_;
-  vpx_codec_ctx_t* encoder_;
-  vpx_codec_enc_cfg_t* config_;
-  vpx_image_t* raw_;
+  int num_streams_;
+  // Set when a stream is turned back on and needs a key frame.
+  bool key_frame_request_;
+
+  // Per stream, lowest resolution first.
+  std::vector<EncodedImage> encoded_images_;
+  std::vector<uint16_t> picture_ids_;
+  std::vector<TemporalLayers*> temporal_layers_;
+  std::vector<bool> send_stream_;
+
+  // Per encoder, highest resolution first. |raw_images_| and
+  // |downsampling_factors_| are contiguous as libvpx requires it. The first
+  // image wraps the input frame and the others |scaled_frames_|, of which
+  // entry i is produced by |scalers_| entry i from the frame above it.
+  vpx_codec_ctx_t* encoders_;
+  vpx_codec_enc_cfg_t* configs_;
+  vpx_image_t* raw_images_;
+  vpx_rational_t* downsampling_factors_;
+  scoped_array<I420VideoFrame> scaled_frames_;
+  scoped_array<Scaler> scalers_;
 };  // end of VP8Encoder class
 
 
@@ -148,7 +210,8 @@ class VP8DecoderImpl : public VP8Decoder {
 
   virtual ~VP8DecoderImpl();
 
-  // Initialize the decoder.
+  // Initialize the decoder. The number of decoder threads is chosen from
+  // |number_of_cores| and the resolution of |inst|, see NumberOfThreads().
   //
   // Return value         :  WEBRTC_VIDEO_CODEC_OK.
   //                        <0 - Errors:
@@ -205,6 +268,13 @@ class VP8DecoderImpl : public VP8Decoder {
   // Return value                : A copy of the instance if OK, NULL otherwise.
   virtual VideoDecoder* Copy();
 
+  // Returns the number of decoder threads to use for a stream of the given
+  // resolution. libvpx decodes the token partitions of a frame in parallel,
+  // so no more threads are used than the sender is expected to produce
+  // partitions, see VP8EncoderImpl::TokenPartitions(). If the resolution is
+  // not known, up to the largest number of partitions are allowed.
+  static int NumberOfThreads(int width, int height, int number_of_cores);
+
  private:
   // Copy reference image from this _decoder to the _decoder in copyTo. Set
   // which frame type to copy in _refFrame->frame_type before the call to
@@ -222,6 +292,7 @@ class VP8DecoderImpl : public VP8Decoder {
   bool feedback_mode_;
   vpx_dec_ctx_t* decoder_;
   VideoCodec codec_;
+  int number_of_cores_;
   EncodedImage last_keyframe_;
   int image_format_;
   vpx_ref_frame_t* ref_frame_;
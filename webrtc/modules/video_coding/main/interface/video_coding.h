@@ -416,6 +416,16 @@ public:
     virtual int RegisterRenderBufferSizeCallback(
         VCMRenderBufferSizeCallback* callback) = 0;
 
+    // Registers a callback which is called whenever a frame becomes ready for
+    // decoding. Allows Decode(0) to be called when signaled, rather than
+    // blocking a thread per module in Decode(). The callback can't be called
+    // anymore once it has been replaced, e.g. by registering NULL.
+    //
+    // Return value     : VCM_OK,     on success.
+    //                    <0,              on error.
+    virtual int32_t RegisterFrameReadyCallback(
+        VCMFrameReadyCallback* callback) = 0;
+
     // Waits for the next frame in the dual jitter buffer to become complete
     // (waits no longer than maxWaitTimeMs), then passes it to the dual decoder
     // for decoding. This will never trigger a render callback. Should be
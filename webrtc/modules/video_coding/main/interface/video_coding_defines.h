@@ -193,6 +193,23 @@ class VCMRenderBufferSizeCallback {
   }
 };
 
+// Callback class used for telling the user that a frame has become ready for
+// decoding, so that Decode() can be called without blocking. Called from the
+// thread inserting packets, after the jitter buffer has been unlocked;
+// implementations should only signal another thread.
+class VCMFrameReadyCallback {
+ public:
+  virtual void FrameReady() = 0;
+  // Called from Decode() when it returns without a frame since the next
+  // frame isn't due for decoding for another |wait_ms| ms. Decode() should be
+  // called again by then.
+  virtual void FrameNotDue(uint32_t wait_ms) = 0;
+
+ protected:
+  virtual ~VCMFrameReadyCallback() {
+  }
+};
+
 }  // namespace webrtc
 
 #endif // WEBRTC_MODULES_INTERFACE_VIDEO_CODING_DEFINES_H_
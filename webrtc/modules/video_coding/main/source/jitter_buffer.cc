@@ -23,6 +23,7 @@
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/system_wrappers/interface/trace_event.h"
 
@@ -43,17 +44,6 @@ class FrameSmallerTimestamp {
   uint32_t timestamp_;
 };
 
-class FrameEqualTimestamp {
- public:
-  explicit FrameEqualTimestamp(uint32_t timestamp) : timestamp_(timestamp) {}
-  bool operator()(VCMFrameBuffer* frame) {
-    return (timestamp_ == frame->TimeStamp());
-  }
-
- private:
-  uint32_t timestamp_;
-};
-
 class KeyFrameCriteria {
  public:
   bool operator()(VCMFrameBuffer* frame) {
@@ -73,6 +63,86 @@ bool HasNonEmptyState(VCMFrameBuffer* frame) {
   return frame->GetState() != kStateEmpty;
 }
 
+FrameList::FrameList() : frames_(), size_(0) {}
+
+FrameList::iterator FrameList::Find(uint32_t timestamp) {
+  for (int slot = HomeSlot(timestamp); index_[slot].used;
+       slot = (slot + 1) & (kIndexSize - 1)) {
+    // Skip frames which have been reset since they were inserted.
+    if (index_[slot].timestamp == timestamp &&
+        (*index_[slot].it)->TimeStamp() == timestamp) {
+      return index_[slot].it;
+    }
+  }
+  return frames_.end();
+}
+
+void FrameList::Insert(VCMFrameBuffer* frame) {
+  assert(size_ < kIndexSize / 2);
+  reverse_iterator rit = std::find_if(
+      frames_.rbegin(), frames_.rend(),
+      FrameSmallerTimestamp(frame->TimeStamp()));
+  iterator it = frames_.insert(rit.base(), frame);
+  ++size_;
+  int slot = HomeSlot(frame->TimeStamp());
+  while (index_[slot].used) {
+    slot = (slot + 1) & (kIndexSize - 1);
+  }
+  index_[slot].used = true;
+  index_[slot].timestamp = frame->TimeStamp();
+  index_[slot].it = it;
+}
+
+FrameList::iterator FrameList::Erase(iterator it) {
+  int slot = HomeSlot((*it)->TimeStamp());
+  while (index_[slot].used && index_[slot].it != it) {
+    slot = (slot + 1) & (kIndexSize - 1);
+  }
+  if (!index_[slot].used) {
+    // The frame has been reset since it was inserted, and its entry is not
+    // where its current timestamp points. This is rare, fall back to a scan.
+    for (slot = 0; slot < kIndexSize; ++slot) {
+      if (index_[slot].used && index_[slot].it == it)
+        break;
+    }
+    assert(slot < kIndexSize);
+  }
+  RemoveFromIndex(slot);
+  --size_;
+  return frames_.erase(it);
+}
+
+void FrameList::Clear() {
+  frames_.clear();
+  size_ = 0;
+  for (int slot = 0; slot < kIndexSize; ++slot) {
+    index_[slot].used = false;
+  }
+}
+
+int FrameList::HomeSlot(uint32_t timestamp) {
+  // Fibonacci hashing. The timestamps of consecutive frames typically differ
+  // by a multiple of a power of two, which makes the low bits a poor hash.
+  return static_cast<int>((timestamp * 2654435761u) >> (32 - kIndexBits));
+}
+
+// Removes the entry at |slot| and moves later entries of the same probe
+// sequence back, which keeps the table free of tombstones.
+void FrameList::RemoveFromIndex(int slot) {
+  int hole = slot;
+  for (int i = (slot + 1) & (kIndexSize - 1); index_[i].used;
+       i = (i + 1) & (kIndexSize - 1)) {
+    const int home = HomeSlot(index_[i].timestamp);
+    // The entry can fill the hole if the hole lies between its home slot and
+    // the slot it is stored in.
+    if (((i - home) & (kIndexSize - 1)) >= ((i - hole) & (kIndexSize - 1))) {
+      index_[hole] = index_[i];
+      hole = i;
+    }
+  }
+  index_[hole].used = false;
+}
+
 VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
                                  EventFactory* event_factory,
                                  int vcm_id,
@@ -86,10 +156,19 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
       master_(master),
       frame_event_(event_factory->CreateEvent()),
       packet_event_(event_factory->CreateEvent()),
+      callback_crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      frame_ready_callback_(NULL),
       max_number_of_frames_(kStartNumberOfFrames),
       frame_buffers_(),
+      free_frames_(),
       frame_list_(),
       last_decoded_state_(),
+      continuous_frame_valid_(false),
+      continuous_frame_(),
+      continuous_stop_(),
+      render_buffer_valid_(false),
+      render_buffer_start_(),
+      render_buffer_end_(),
       first_packet_(true),
       num_not_decodable_packets_(0),
       receive_statistics_(),
@@ -117,8 +196,10 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
   memset(frame_buffers_, 0, sizeof(frame_buffers_));
   memset(receive_statistics_, 0, sizeof(receive_statistics_));
 
+  free_frames_.reserve(kMaxNumberOfFrames);
   for (int i = 0; i < kStartNumberOfFrames; i++) {
     frame_buffers_[i] = new VCMFrameBuffer();
+    free_frames_.push_back(frame_buffers_[i]);
   }
 }
 
@@ -172,16 +253,18 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
         frame_buffers_[i] = NULL;
       }
     }
-    frame_list_.clear();
+    frame_list_.Clear();
+    free_frames_.clear();
     for (int i = 0; i < max_number_of_frames_; i++) {
       frame_buffers_[i] = new VCMFrameBuffer(*(rhs.frame_buffers_[i]));
+      if (frame_buffers_[i]->GetState() == kStateFree) {
+        free_frames_.push_back(frame_buffers_[i]);
+      }
       if (frame_buffers_[i]->Length() > 0) {
-        FrameList::reverse_iterator rit = std::find_if(
-            frame_list_.rbegin(), frame_list_.rend(),
-            FrameSmallerTimestamp(frame_buffers_[i]->TimeStamp()));
-        frame_list_.insert(rit.base(), frame_buffers_[i]);
+        frame_list_.Insert(frame_buffers_[i]);
       }
     }
+    InvalidateContinuity();
     rhs.crit_sect_->Leave();
     crit_sect_->Leave();
   }
@@ -211,6 +294,7 @@ void VCMJitterBuffer::Start() {
   rtt_ms_ = kDefaultRtt;
   num_not_decodable_packets_ = 0;
   last_decoded_state_.Reset();
+  InvalidateContinuity();
 
   WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
                VCMId(vcm_id_, receiver_id_), "JB(0x%x): Jitter buffer: start",
@@ -221,11 +305,14 @@ void VCMJitterBuffer::Stop() {
   crit_sect_->Enter();
   running_ = false;
   last_decoded_state_.Reset();
-  frame_list_.clear();
+  frame_list_.Clear();
+  InvalidateContinuity();
   TRACE_EVENT_INSTANT1("webrtc", "JB::FrameListEmptied", "type", "Stop");
+  free_frames_.clear();
   for (int i = 0; i < kMaxNumberOfFrames; i++) {
     if (frame_buffers_[i] != NULL) {
       static_cast<VCMFrameBuffer*>(frame_buffers_[i])->SetState(kStateFree);
+      free_frames_.push_back(frame_buffers_[i]);
     }
   }
 
@@ -245,14 +332,24 @@ bool VCMJitterBuffer::Running() const {
 
 void VCMJitterBuffer::Flush() {
   CriticalSectionScoped cs(crit_sect_);
+  RtcEventLog::LogJitterBufferEvent(VCMId(vcm_id_, receiver_id_),
+                                    RtcEventLog::kFlushed, 0,
+                                    static_cast<int32_t>(frame_list_.size()));
   // Erase all frames from the sorted list and set their state to free.
-  frame_list_.clear();
+  frame_list_.Clear();
   TRACE_EVENT_INSTANT2("webrtc", "JB::FrameListEmptied", "type", "Flush",
                        "frames", max_number_of_frames_);
+  // Rebuild the pool from scratch, a frame which was handed out before the
+  // flush may still be written to and leave a stale entry behind.
+  free_frames_.clear();
   for (int i = 0; i < max_number_of_frames_; i++) {
-    ReleaseFrameIfNotDecoding(frame_buffers_[i]);
+    if (frame_buffers_[i]->GetState() != kStateDecoding) {
+      frame_buffers_[i]->SetState(kStateFree);
+      free_frames_.push_back(frame_buffers_[i]);
+    }
   }
   last_decoded_state_.Reset();  // TODO(mikhal): sync reset.
+  InvalidateContinuity();
   num_not_decodable_packets_ = 0;
   frame_event_->Reset();
   packet_event_->Reset();
@@ -400,8 +497,7 @@ bool VCMJitterBuffer::NextCompleteTimestamp(
   }
   CleanUpOldOrEmptyFrames();
 
-  FrameList::iterator it = FindOldestCompleteContinuousFrame(
-      frame_list_.begin(), &last_decoded_state_);
+  FrameList::iterator it = OldestCompleteContinuousFrame();
   if (it == frame_list_.end()) {
     const int64_t end_wait_time_ms = clock_->TimeInMilliseconds() +
         max_wait_time_ms;
@@ -420,8 +516,7 @@ bool VCMJitterBuffer::NextCompleteTimestamp(
         // Finding oldest frame ready for decoder, but check
         // sequence number and size
         CleanUpOldOrEmptyFrames();
-        it = FindOldestCompleteContinuousFrame(
-            frame_list_.begin(), &last_decoded_state_);
+        it = OldestCompleteContinuousFrame();
         if (it == frame_list_.end()) {
           wait_time_ms = end_wait_time_ms - clock_->TimeInMilliseconds();
         } else {
@@ -498,16 +593,19 @@ VCMEncodedFrame* VCMJitterBuffer::ExtractAndSetDecode(uint32_t timestamp) {
     return NULL;
   }
   // Extract the frame with the desired timestamp.
-  FrameList::iterator it = std::find_if(
-      frame_list_.begin(),
-      frame_list_.end(),
-      FrameEqualTimestamp(timestamp));
+  FrameList::iterator it = frame_list_.Find(timestamp);
 
   if (it == frame_list_.end()) {
     return NULL;
   }
   // We got the frame.
   VCMFrameBuffer* frame = *it;
+  if (frame->LatestPacketTimeMs() >= 0) {
+    RtcEventLog::LogJitterBufferEvent(
+        VCMId(vcm_id_, receiver_id_), RtcEventLog::kFrameDecoded,
+        frame->TimeStamp(), static_cast<int32_t>(
+            clock_->TimeInMilliseconds() - frame->LatestPacketTimeMs()));
+  }
 
   // Frame pulled out from jitter buffer,
   // update the jitter estimate with what we currently know.
@@ -526,7 +624,9 @@ VCMEncodedFrame* VCMJitterBuffer::ExtractAndSetDecode(uint32_t timestamp) {
         frame->LatestPacketTimeMs();
     waiting_for_completion_.timestamp = frame->TimeStamp();
   }
-  frame_list_.erase(frame_list_.begin());
+  const bool continuous_frame = continuous_frame_valid_ &&
+      it == continuous_frame_;
+  const FrameList::iterator next_it = frame_list_.Erase(it);
   if (frame_list_.empty()) {
     TRACE_EVENT_INSTANT1("webrtc", "JB::FrameListEmptied",
                          "type", "MaybeGetIncompleteFrameForDecoding");
@@ -545,6 +645,11 @@ VCMEncodedFrame* VCMJitterBuffer::ExtractAndSetDecode(uint32_t timestamp) {
 
   // We have a frame - update decoded state with frame info.
   last_decoded_state_.SetState(frame);
+  if (continuous_frame) {
+    AdvanceContinuity(next_it);
+  } else {
+    InvalidateContinuity();
+  }
   DropPacketsFromNackList(last_decoded_state_.sequence_num());
   return frame;
 }
@@ -555,7 +660,7 @@ void VCMJitterBuffer::ReleaseFrame(VCMEncodedFrame* frame) {
   CriticalSectionScoped cs(crit_sect_);
   VCMFrameBuffer* frame_buffer = static_cast<VCMFrameBuffer*>(frame);
   if (frame_buffer)
-    frame_buffer->SetState(kStateFree);
+    RecycleFrame(frame_buffer);
 }
 
 // Gets frame to use for this timestamp. If no match, get empty frame.
@@ -581,6 +686,7 @@ int VCMJitterBuffer::GetFrame(const VCMPacket& packet,
     // belongs to a frame with a timestamp equal to the last decoded
     // timestamp.
     last_decoded_state_.UpdateOldPacket(&packet);
+    InvalidateContinuity();
     DropPacketsFromNackList(last_decoded_state_.sequence_num());
 
     if (num_consecutive_old_packets_ > kMaxConsecutiveOldPackets) {
@@ -593,11 +699,7 @@ int VCMJitterBuffer::GetFrame(const VCMPacket& packet,
   }
   num_consecutive_old_packets_ = 0;
 
-  FrameList::iterator it = std::find_if(
-                             frame_list_.begin(),
-                             frame_list_.end(),
-                             FrameEqualTimestamp(packet.timestamp));
-
+  FrameList::iterator it = frame_list_.Find(packet.timestamp);
   if (it != frame_list_.end()) {
     frame = *it;
     crit_sect_->Leave();
@@ -642,6 +744,23 @@ int64_t VCMJitterBuffer::LastPacketTime(VCMEncodedFrame* frame,
 
 VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
                                                  const VCMPacket& packet) {
+  bool frame_ready = false;
+  const VCMFrameBufferEnum ret = InsertPacketInternal(encoded_frame, packet,
+                                                      &frame_ready);
+  if (frame_ready) {
+    // Called after leaving |crit_sect_|, so that the woken up decoder doesn't
+    // have to wait for this thread to release it.
+    CriticalSectionScoped cs(callback_crit_sect_.get());
+    if (frame_ready_callback_) {
+      frame_ready_callback_->FrameReady();
+    }
+  }
+  return ret;
+}
+
+VCMFrameBufferEnum VCMJitterBuffer::InsertPacketInternal(
+    VCMEncodedFrame* encoded_frame, const VCMPacket& packet,
+    bool* frame_ready) {
   assert(encoded_frame);
   bool request_key_frame = false;
   CriticalSectionScoped cs(crit_sect_);
@@ -652,7 +771,12 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
 
   // If this packet belongs to an old, already decoded frame, we want to update
   // the last decoded sequence number.
+  const uint16_t last_decoded_sequence_number =
+      last_decoded_state_.sequence_num();
   last_decoded_state_.UpdateOldPacket(&packet);
+  if (last_decoded_state_.sequence_num() != last_decoded_sequence_number) {
+    InvalidateContinuity();
+  }
 
   // We are keeping track of the first seq num, the latest seq num and
   // the number of wraps to be able to calculate how many packets we expect.
@@ -693,6 +817,7 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
   }
 
   VCMFrameBufferStateEnum state = frame->GetState();
+  const int temporal_id = frame->TemporalId();
   // Insert packet
   // Check for first packet
   // High sequence number will be -1 if neither an empty packet nor
@@ -713,11 +838,15 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
     // belonging to that frame (media or empty).
     if (state == kStateEmpty && first) {
       ret = kFirstPacket;
-      FrameList::reverse_iterator rit = std::find_if(
-          frame_list_.rbegin(),
-          frame_list_.rend(),
-          FrameSmallerTimestamp(frame->TimeStamp()));
-      frame_list_.insert(rit.base(), frame);
+      frame_list_.Insert(frame);
+    }
+    // A packet which leaves its frame empty or incomplete can't change which
+    // frames are continuous, unless it changes the temporal layer of the
+    // frame.
+    if (ret == kFirstPacket || frame->GetState() != state ||
+        (state != kStateEmpty && state != kStateIncomplete) ||
+        frame->TemporalId() != temporal_id) {
+      UpdateContinuity(frame_list_.Find(frame->TimeStamp()));
     }
   }
   switch (buffer_return) {
@@ -728,6 +857,7 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
         // Will be released when it gets old.
         frame->Reset();
         frame->SetState(kStateEmpty);
+        InvalidateContinuity();
       }
       break;
     }
@@ -735,7 +865,7 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
       // Don't let the first packet be overridden by a complete session.
       ret = kCompleteSession;
       // Only update return value for a JB flush indicator.
-      if (UpdateFrameState(frame) == kFlushIndicator)
+      if (UpdateFrameState(frame, frame_ready) == kFlushIndicator)
         ret = kFlushIndicator;
       // Signal that we have a received packet.
       packet_event_->Set();
@@ -827,6 +957,12 @@ VCMNackMode VCMJitterBuffer::nack_mode() const {
   return nack_mode_;
 }
 
+void VCMJitterBuffer::DecodeWithErrors(bool enable) {
+  CriticalSectionScoped cs(crit_sect_);
+  decode_with_errors_ = enable;
+  InvalidateContinuity();
+}
+
 int VCMJitterBuffer::NonContinuousOrIncompleteDuration() {
   if (frame_list_.empty()) {
     return 0;
@@ -866,6 +1002,11 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
       bool found_key_frame = RecycleFramesUntilKeyFrame();
       if (!found_key_frame) {
         *request_key_frame = have_non_empty_frame;
+        if (have_non_empty_frame) {
+          RtcEventLog::LogJitterBufferEvent(VCMId(vcm_id_, receiver_id_),
+                                            RtcEventLog::kKeyFrameRequested,
+                                            0, 0);
+        }
         *nack_list_size = 0;
         return NULL;
       }
@@ -874,7 +1015,14 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
   if (TooLargeNackList()) {
     TRACE_EVENT_INSTANT1("webrtc", "JB::NackListTooLarge",
                          "size", missing_sequence_numbers_.size());
+    const int32_t missing_packets =
+        static_cast<int32_t>(missing_sequence_numbers_.size());
     *request_key_frame = !HandleTooLargeNackList();
+    if (*request_key_frame) {
+      RtcEventLog::LogJitterBufferEvent(VCMId(vcm_id_, receiver_id_),
+                                        RtcEventLog::kKeyFrameRequested, 0,
+                                        missing_packets);
+    }
   }
   if (max_incomplete_time_ms_ > 0) {
     int non_continuous_incomplete_duration =
@@ -887,6 +1035,9 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
                                                 KeyFrameCriteria());
       if (rit == frame_list_.rend()) {
         // Request a key frame if we don't have one already.
+        RtcEventLog::LogJitterBufferEvent(
+            VCMId(vcm_id_, receiver_id_), RtcEventLog::kKeyFrameRequested, 0,
+            static_cast<int32_t>(missing_sequence_numbers_.size()));
         *request_key_frame = true;
         *nack_list_size = 0;
         return NULL;
@@ -894,6 +1045,7 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
         // Skip to the last key frame. If it's incomplete we will start
         // NACKing it.
         last_decoded_state_.Reset();
+        InvalidateContinuity();
         DropPacketsFromNackList(EstimatedLowSequenceNumber(**rit));
       }
     }
@@ -1007,7 +1159,8 @@ FrameList::iterator VCMJitterBuffer::FindLastContinuousAndComplete(
   FrameList::iterator previous_it = start_it;
   ++start_it;
   while (start_it != frame_list_.end() && continuous_complete) {
-    start_it = FindOldestCompleteContinuousFrame(start_it, &previous_state);
+    start_it = FindOldestCompleteContinuousFrame(start_it, &previous_state,
+                                                 NULL);
     if (start_it == frame_list_.end())
       break;
     previous_state.SetState(*start_it);
@@ -1020,8 +1173,12 @@ FrameList::iterator VCMJitterBuffer::FindLastContinuousAndComplete(
 
 void VCMJitterBuffer::RenderBuffer(FrameList::iterator* start_it,
                                    FrameList::iterator* end_it) {
-  *start_it = FindOldestCompleteContinuousFrame(
-      frame_list_.begin(), &last_decoded_state_);
+  if (render_buffer_valid_) {
+    *start_it = render_buffer_start_;
+    *end_it = render_buffer_end_;
+    return;
+  }
+  *start_it = OldestCompleteContinuousFrame();
   if (!decode_with_errors_ && *start_it == frame_list_.end()) {
     // No complete continuous frame found.
     // Look for a complete key frame if we're not decoding with errors.
@@ -1046,6 +1203,9 @@ void VCMJitterBuffer::RenderBuffer(FrameList::iterator* start_it,
     }
     *end_it = FindLastContinuousAndComplete(*end_it);
   }
+  render_buffer_start_ = *start_it;
+  render_buffer_end_ = *end_it;
+  render_buffer_valid_ = true;
 }
 
 void VCMJitterBuffer::RenderBufferSize(uint32_t* timestamp_start,
@@ -1067,11 +1227,32 @@ void VCMJitterBuffer::RenderBufferSize(uint32_t* timestamp_start,
   *timestamp_end = (*end_it)->TimeStamp();
 }
 
+void VCMJitterBuffer::RegisterFrameReadyCallback(
+    VCMFrameReadyCallback* callback) {
+  CriticalSectionScoped cs(callback_crit_sect_.get());
+  frame_ready_callback_ = callback;
+}
+
+void VCMJitterBuffer::FrameNotDue(uint32_t wait_ms) {
+  CriticalSectionScoped cs(callback_crit_sect_.get());
+  if (frame_ready_callback_) {
+    frame_ready_callback_->FrameNotDue(wait_ms);
+  }
+}
+
 // Set the frame state to free and remove it from the sorted
 // frame list. Must be called from inside the critical section crit_sect_.
 void VCMJitterBuffer::ReleaseFrameIfNotDecoding(VCMFrameBuffer* frame) {
   if (frame != NULL && frame->GetState() != kStateDecoding) {
+    RecycleFrame(frame);
+  }
+}
+
+// Must be called from inside the critical section crit_sect_.
+void VCMJitterBuffer::RecycleFrame(VCMFrameBuffer* frame) {
+  if (frame->GetState() != kStateFree) {
     frame->SetState(kStateFree);
+    free_frames_.push_back(frame);
   }
 }
 
@@ -1082,12 +1263,17 @@ VCMFrameBuffer* VCMJitterBuffer::GetEmptyFrame() {
 
   crit_sect_->Enter();
 
-  for (int i = 0; i < max_number_of_frames_; ++i) {
-    if (kStateFree == frame_buffers_[i]->GetState()) {
-      // found a free buffer
-      frame_buffers_[i]->SetState(kStateEmpty);
+  // Reuse the most recently freed frame, its buffer is the most likely to
+  // still be cached.
+  while (!free_frames_.empty()) {
+    VCMFrameBuffer* frame = free_frames_.back();
+    free_frames_.pop_back();
+    // Skip stale entries of frames which were written to after being freed,
+    // see Flush().
+    if (frame->GetState() == kStateFree) {
+      frame->SetState(kStateEmpty);
       crit_sect_->Leave();
-      return frame_buffers_[i];
+      return frame;
     }
   }
 
@@ -1125,8 +1311,13 @@ bool VCMJitterBuffer::RecycleFramesUntilKeyFrame() {
                  "Jitter buffer drop count:%d, low_seq %d", drop_count_,
                  (*it)->GetLowSeqNum());
     TRACE_EVENT_INSTANT0("webrtc", "JB::RecycleFramesUntilKeyFrame");
+    RtcEventLog::LogJitterBufferEvent(VCMId(vcm_id_, receiver_id_),
+                                      RtcEventLog::kFrameDropped,
+                                      (*it)->TimeStamp(),
+                                      static_cast<int32_t>(drop_count_));
+    FrameErased(it);
     ReleaseFrameIfNotDecoding(*it);
-    it = frame_list_.erase(it);
+    it = frame_list_.Erase(it);
     if (it != frame_list_.end() && (*it)->FrameType() == kVideoFrameKey) {
       // Reset last decoded state to make sure the next frame decoded is a key
       // frame, and start NACKing from here.
@@ -1140,12 +1331,14 @@ bool VCMJitterBuffer::RecycleFramesUntilKeyFrame() {
                          "type", "RecycleFramesUntilKeyFrame");
   }
   last_decoded_state_.Reset();  // TODO(mikhal): No sync.
+  InvalidateContinuity();
   missing_sequence_numbers_.clear();
   return false;
 }
 
 // Must be called under the critical section |crit_sect_|.
-VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
+VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame,
+                                                     bool* frame_signaled) {
   if (frame == NULL) {
     WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding,
                  VCMId(vcm_id_, receiver_id_), "JB(0x%x) FB(0x%x): "
@@ -1178,8 +1371,13 @@ VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
     // released by CleanUpOldFrames later.
     TRACE_EVENT_INSTANT1("webrtc", "JB::DropLateFrame",
                          "timestamp", frame->TimeStamp());
+    RtcEventLog::LogJitterBufferEvent(VCMId(vcm_id_, receiver_id_),
+                                      RtcEventLog::kLateFrameDropped,
+                                      frame->TimeStamp(),
+                                      num_consecutive_old_frames_ + 1);
     frame->Reset();
     frame->SetState(kStateEmpty);
+    InvalidateContinuity();
     WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
                  VCMId(vcm_id_, receiver_id_),
                  "JB(0x%x) FB(0x%x): Dropping old frame in Jitter buffer",
@@ -1199,6 +1397,7 @@ VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
   }
   num_consecutive_old_frames_ = 0;
   frame->SetState(kStateComplete);
+  UpdateContinuity(frame_list_.Find(frame->TimeStamp()));
   if (frame->FrameType() == kVideoFrameKey) {
     TRACE_EVENT_INSTANT2("webrtc", "JB::AddKeyFrame",
                          "timestamp", frame->TimeStamp(),
@@ -1233,8 +1432,7 @@ VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
         assert(false);
     }
   }
-  const FrameList::iterator it = FindOldestCompleteContinuousFrame(
-      frame_list_.begin(), &last_decoded_state_);
+  const FrameList::iterator it = OldestCompleteContinuousFrame();
   VCMFrameBuffer* old_frame = NULL;
   if (it != frame_list_.end()) {
     old_frame = *it;
@@ -1244,15 +1442,86 @@ VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
   // Not necessarily the case due to packet reordering or NACK.
   if (!WaitForRetransmissions() || (old_frame != NULL && old_frame == frame)) {
     frame_event_->Set();
+    *frame_signaled = true;
   }
   return kNoError;
 }
 
+// Must be called under the critical section |crit_sect_|.
+FrameList::iterator VCMJitterBuffer::OldestCompleteContinuousFrame() {
+  if (!continuous_frame_valid_) {
+    continuous_frame_ = FindOldestCompleteContinuousFrame(
+        frame_list_.begin(), &last_decoded_state_, &continuous_stop_);
+    continuous_frame_valid_ = true;
+  }
+  return continuous_frame_;
+}
+
+// All frames before |continuous_stop_| are incomplete or discontinuous frames
+// of higher temporal layers, which the search skips. A change of another
+// frame therefore only needs that frame to be looked at.
+// Must be called under the critical section |crit_sect_|.
+void VCMJitterBuffer::UpdateContinuity(FrameList::iterator it) {
+  render_buffer_valid_ = false;
+  if (!continuous_frame_valid_ || it == frame_list_.end()) {
+    return;
+  }
+  if (continuous_stop_ != frame_list_.end() && it != continuous_stop_ &&
+      IsNewerTimestamp((*it)->TimeStamp(), (*continuous_stop_)->TimeStamp())) {
+    // The search stops before reaching this frame.
+    return;
+  }
+  if (CompleteAndContinuous(*it, &last_decoded_state_)) {
+    continuous_frame_ = it;
+    continuous_stop_ = it;
+  } else if ((*it)->TemporalId() <= 0) {
+    continuous_frame_ = frame_list_.end();
+    continuous_stop_ = it;
+  } else if (it == continuous_stop_) {
+    // The search no longer stops at this frame.
+    continuous_frame_valid_ = false;
+  }
+}
+
+// Must be called under the critical section |crit_sect_|.
+void VCMJitterBuffer::FrameErased(FrameList::iterator it) {
+  render_buffer_valid_ = false;
+  if (continuous_frame_valid_ && it == continuous_stop_) {
+    continuous_frame_valid_ = false;
+  }
+}
+
+// The frames before the decoded one are older than it and are dropped by
+// CleanUpOldOrEmptyFrames(), so the search continues after it.
+// Must be called under the critical section |crit_sect_|.
+void VCMJitterBuffer::AdvanceContinuity(FrameList::iterator next_it) {
+  continuous_frame_ = FindOldestCompleteContinuousFrame(
+      next_it, &last_decoded_state_, &continuous_stop_);
+  continuous_frame_valid_ = true;
+  render_buffer_valid_ = false;
+}
+
+// Must be called under the critical section |crit_sect_|.
+void VCMJitterBuffer::InvalidateContinuity() {
+  continuous_frame_valid_ = false;
+  render_buffer_valid_ = false;
+}
+
+bool VCMJitterBuffer::CompleteAndContinuous(
+    const VCMFrameBuffer* frame,
+    const VCMDecodingState* decoding_state) const {
+  const VCMFrameBufferStateEnum state = frame->GetState();
+  return (state == kStateComplete ||
+          (decode_with_errors_ && state == kStateDecodable)) &&
+      decoding_state->ContinuousFrame(frame);
+}
+
 // Find oldest complete frame used for getting next frame to decode
 // Must be called under critical section
 FrameList::iterator VCMJitterBuffer::FindOldestCompleteContinuousFrame(
     FrameList::iterator start_it,
-    const VCMDecodingState* decoding_state) {
+    const VCMDecodingState* decoding_state,
+    FrameList::iterator* stop_it) {
   // If we have more than one frame done since last time, pick oldest.
   VCMFrameBuffer* oldest_frame = NULL;
 
@@ -1262,11 +1531,8 @@ FrameList::iterator VCMJitterBuffer::FindOldestCompleteContinuousFrame(
   // 2. The end of the list was reached.
   for (; start_it != frame_list_.end(); ++start_it)  {
     oldest_frame = *start_it;
-    VCMFrameBufferStateEnum state = oldest_frame->GetState();
     // Is this frame complete or decodable and continuous?
-    if ((state == kStateComplete ||
-         (decode_with_errors_ && state == kStateDecodable)) &&
-         decoding_state->ContinuousFrame(oldest_frame)) {
+    if (CompleteAndContinuous(oldest_frame, decoding_state)) {
       break;
     } else {
       int temporal_id = oldest_frame->TemporalId();
@@ -1279,6 +1545,9 @@ FrameList::iterator VCMJitterBuffer::FindOldestCompleteContinuousFrame(
     }
   }
 
+  if (stop_it) {
+    *stop_it = start_it;
+  }
   if (oldest_frame == NULL) {
     // No complete frame no point to continue.
     return frame_list_.end();
@@ -1295,13 +1564,15 @@ void VCMJitterBuffer::CleanUpOldOrEmptyFrames() {
     if (oldest_frame->GetState() == kStateEmpty && frame_list_.size() > 1) {
       // This frame is empty, mark it as decoded, thereby making it old.
       last_decoded_state_.UpdateEmptyFrame(oldest_frame);
+      InvalidateContinuity();
     }
     if (last_decoded_state_.IsOldFrame(oldest_frame)) {
+      FrameErased(frame_list_.begin());
       ReleaseFrameIfNotDecoding(frame_list_.front());
       TRACE_EVENT_INSTANT1("webrtc", "JB::OldFrameDropped",
                            "timestamp", oldest_frame->TimeStamp());
       TRACE_COUNTER1("webrtc", "JBDroppedLateFrames", drop_count_);
-      frame_list_.erase(frame_list_.begin());
+      frame_list_.Erase(frame_list_.begin());
     } else {
       break;
     }
@@ -32,8 +32,6 @@ enum VCMNackMode {
   kNoNack
 };
 
-typedef std::list<VCMFrameBuffer*> FrameList;
-
 // forward declarations
 class Clock;
 class EventFactory;
@@ -42,6 +40,58 @@ class VCMFrameBuffer;
 class VCMPacket;
 class VCMEncodedFrame;
 
+// Frames ordered by timestamp. The frames are also indexed by timestamp, which
+// makes finding the frame of a packet a constant time operation regardless of
+// how many frames are buffered.
+class FrameList {
+ public:
+  typedef std::list<VCMFrameBuffer*>::iterator iterator;
+  typedef std::list<VCMFrameBuffer*>::reverse_iterator reverse_iterator;
+
+  FrameList();
+
+  iterator begin() { return frames_.begin(); }
+  iterator end() { return frames_.end(); }
+  reverse_iterator rbegin() { return frames_.rbegin(); }
+  reverse_iterator rend() { return frames_.rend(); }
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  VCMFrameBuffer* front() const { return frames_.front(); }
+  VCMFrameBuffer* back() const { return frames_.back(); }
+
+  // Returns the frame with timestamp |timestamp|, or end() if there is none.
+  iterator Find(uint32_t timestamp);
+  // Inserts |frame| after all frames with older timestamps. The search starts
+  // at the newest frame, making in-order insertion cheap.
+  void Insert(VCMFrameBuffer* frame);
+  // Removes the frame at |it| and returns an iterator to the next frame.
+  iterator Erase(iterator it);
+  void Clear();
+
+ private:
+  // Must be a power of two, well above kMaxNumberOfFrames to keep the probe
+  // sequences short.
+  enum { kIndexBits = 10 };
+  enum { kIndexSize = 1 << kIndexBits };
+
+  struct IndexEntry {
+    IndexEntry() : used(false), timestamp(0) {}
+    bool used;
+    // The timestamp of the frame when it was inserted. A frame which is reset
+    // while listed keeps its entry, see Erase().
+    uint32_t timestamp;
+    iterator it;
+  };
+
+  static int HomeSlot(uint32_t timestamp);
+  void RemoveFromIndex(int slot);
+
+  std::list<VCMFrameBuffer*> frames_;
+  size_t size_;
+  // Open addressing hash table with linear probing.
+  IndexEntry index_[kIndexSize];
+};
+
 struct VCMJitterSample {
   VCMJitterSample() : timestamp(0), frame_size(0), latest_packet_time(-1) {}
   uint32_t timestamp;
@@ -156,7 +206,7 @@ class VCMJitterBuffer {
   uint16_t* GetNackList(uint16_t* nack_list_size, bool* request_key_frame);
 
   // Enable/disable decoding with errors.
-  void DecodeWithErrors(bool enable) {decode_with_errors_ = enable;}
+  void DecodeWithErrors(bool enable);
   int64_t LastDecodedTimestamp() const;
   bool decode_with_errors() const {return decode_with_errors_;}
 
@@ -164,6 +214,14 @@ class VCMJitterBuffer {
   // corresponding to the start and end of the continuous complete buffer.
   void RenderBufferSize(uint32_t* timestamp_start, uint32_t* timestamp_end);
 
+  // Sets a callback to call, in addition to signaling the internal frame
+  // event, when a frame becomes ready for decoding. The callback is called
+  // from InsertPacket() without |crit_sect_| held. Once this returns the
+  // previous callback is no longer called.
+  void RegisterFrameReadyCallback(VCMFrameReadyCallback* callback);
+  // Tells the callback that the next frame isn't due for |wait_ms| ms.
+  void FrameNotDue(uint32_t wait_ms);
+
  private:
   class SequenceNumberLessThan {
    public:
@@ -192,6 +250,9 @@ class VCMJitterBuffer {
 
   void ReleaseFrameIfNotDecoding(VCMFrameBuffer* frame);
 
+  // Sets the state of |frame| to free and returns it to |free_frames_|.
+  void RecycleFrame(VCMFrameBuffer* frame);
+
   // Gets an empty frame, creating a new frame if necessary (i.e. increases
   // jitter buffer size).
   VCMFrameBuffer* GetEmptyFrame();
@@ -200,16 +261,50 @@ class VCMJitterBuffer {
   // completely full. Returns true if a key frame was found.
   bool RecycleFramesUntilKeyFrame();
 
+  // Inserts |packet| with |crit_sect_| held. Sets |frame_ready| if a frame
+  // became ready for decoding.
+  VCMFrameBufferEnum InsertPacketInternal(VCMEncodedFrame* encoded_frame,
+                                          const VCMPacket& packet,
+                                          bool* frame_ready);
+
   // Sets the state of |frame| to complete if it's not too old to be decoded.
   // Also updates the frame statistics. Signals the |frame_event| if this is
-  // the next frame to be decoded.
-  VCMFrameBufferEnum UpdateFrameState(VCMFrameBuffer* frame);
+  // the next frame to be decoded, and sets |frame_signaled| if it did.
+  VCMFrameBufferEnum UpdateFrameState(VCMFrameBuffer* frame,
+                                      bool* frame_signaled);
+
+  // Returns the oldest complete frame which is continuous with the last
+  // decoded frame. The result is kept up to date as frames change, and only
+  // searched for from the start of |frame_list_| after InvalidateContinuity().
+  FrameList::iterator OldestCompleteContinuousFrame();
+
+  // Must be called when the listed frame at |it| has been inserted, or its
+  // state, temporal layer or packets have changed.
+  void UpdateContinuity(FrameList::iterator it);
+  // Must be called before the frame at |it| is removed from |frame_list_|,
+  // unless it is extracted for decoding.
+  void FrameErased(FrameList::iterator it);
+  // Must be called when the oldest complete continuous frame has been
+  // extracted for decoding and |last_decoded_state_| set to it. |next_it| is
+  // the frame which followed it in |frame_list_|.
+  void AdvanceContinuity(FrameList::iterator next_it);
+  // Must be called on any other change of |last_decoded_state_| or
+  // |frame_list_|, or when a listed frame is reset.
+  void InvalidateContinuity();
+
+  // Returns true if |frame| is complete, or decodable when decoding with
+  // errors, and continuous with |decoding_state|.
+  bool CompleteAndContinuous(const VCMFrameBuffer* frame,
+                             const VCMDecodingState* decoding_state) const;
 
   // Finds the oldest complete frame, used for getting next frame to decode.
-  // Can return a decodable, incomplete frame when enabled.
+  // Can return a decodable, incomplete frame when enabled. If |stop_it| is
+  // not NULL it is set to the frame the search stopped at, which is the
+  // returned frame, an incomplete or discontinuous base layer frame or end().
   FrameList::iterator FindOldestCompleteContinuousFrame(
       FrameList::iterator start_it,
-      const VCMDecodingState* decoding_state);
+      const VCMDecodingState* decoding_state,
+      FrameList::iterator* stop_it);
   FrameList::iterator FindLastContinuousAndComplete(
       FrameList::iterator start_it);
   void RenderBuffer(FrameList::iterator* start_it,
@@ -258,12 +353,27 @@ class VCMJitterBuffer {
   scoped_ptr<EventWrapper> frame_event_;
   // Event to signal when we have received a packet.
   scoped_ptr<EventWrapper> packet_event_;
+  // Protects |frame_ready_callback_|, and is held while calling it.
+  scoped_ptr<CriticalSectionWrapper> callback_crit_sect_;
+  // Called along with |frame_event_| if set.
+  VCMFrameReadyCallback* frame_ready_callback_;
   // Number of allocated frames.
   int max_number_of_frames_;
   // Array of pointers to the frames in jitter buffer.
   VCMFrameBuffer* frame_buffers_[kMaxNumberOfFrames];
+  // The frames in |frame_buffers_| which are free, most recently used last.
+  std::vector<VCMFrameBuffer*> free_frames_;
   FrameList frame_list_;
   VCMDecodingState last_decoded_state_;
+  // Cached results of OldestCompleteContinuousFrame() and RenderBuffer().
+  bool continuous_frame_valid_;
+  FrameList::iterator continuous_frame_;
+  // Where the search for |continuous_frame_| stopped. Changes to frames after
+  // it can't change the result.
+  FrameList::iterator continuous_stop_;
+  bool render_buffer_valid_;
+  FrameList::iterator render_buffer_start_;
+  FrameList::iterator render_buffer_end_;
   bool first_packet_;
 
   // Statistics.
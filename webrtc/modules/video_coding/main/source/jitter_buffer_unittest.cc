@@ -8,9 +8,13 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <list>
+#include <utility>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/modules/video_coding/main/source/frame_buffer.h"
@@ -20,9 +24,55 @@
 #include "webrtc/modules/video_coding/main/source/stream_generator.h"
 #include "webrtc/modules/video_coding/main/test/test_util.h"
 #include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
+TEST(FrameListTest, FindsFramesInTimestampOrder) {
+  const int kNumFrames = kMaxNumberOfFrames;
+  uint8_t payload[10] = { 0 };
+  std::vector<VCMFrameBuffer*> frames;
+  FrameList frame_list;
+  for (int i = 0; i < kNumFrames; ++i) {
+    // Insert every other frame out of order, and wrap the timestamps.
+    const int n = (i % 2 == 0) ? i + 1 : i - 1;
+    VCMPacket packet(payload, sizeof(payload), n, 0xffffff00 + n * 3000,
+                     true);
+    frames.push_back(new VCMFrameBuffer());
+    frames.back()->SetState(kStateEmpty);
+    frames.back()->InsertPacket(packet, 0, false, 0);
+    frame_list.Insert(frames.back());
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumFrames), frame_list.size());
+  uint32_t expected_timestamp = 0xffffff00;
+  for (FrameList::iterator it = frame_list.begin(); it != frame_list.end();
+       ++it) {
+    EXPECT_EQ(expected_timestamp, (*it)->TimeStamp());
+    expected_timestamp += 3000;
+  }
+  // Remove every third frame and make sure the others can still be found.
+  for (int i = 0; i < kNumFrames; i += 3) {
+    FrameList::iterator it = frame_list.Find(frames[i]->TimeStamp());
+    ASSERT_TRUE(it != frame_list.end());
+    frame_list.Erase(it);
+  }
+  for (int i = 0; i < kNumFrames; ++i) {
+    FrameList::iterator it = frame_list.Find(frames[i]->TimeStamp());
+    if (i % 3 == 0) {
+      EXPECT_TRUE(it == frame_list.end());
+    } else {
+      ASSERT_TRUE(it != frame_list.end());
+      EXPECT_EQ(frames[i], *it);
+    }
+  }
+  EXPECT_TRUE(frame_list.Find(0xffffff00 + 1) == frame_list.end());
+  frame_list.Clear();
+  EXPECT_TRUE(frame_list.empty());
+  EXPECT_TRUE(frame_list.Find(frames[1]->TimeStamp()) == frame_list.end());
+  for (int i = 0; i < kNumFrames; ++i)
+    delete frames[i];
+}
+
 class TestBasicJitterBuffer : public ::testing::Test {
  protected:
   virtual void SetUp() {
@@ -299,6 +349,51 @@ TEST_F(TestBasicJitterBuffer, DualPacketFrame) {
   EXPECT_EQ(kVideoFrameKey, frame_out->FrameType());
 }
 
+class CountingFrameReadyCallback : public VCMFrameReadyCallback {
+ public:
+  CountingFrameReadyCallback() : frames_ready_(0) {}
+  virtual void FrameReady() { ++frames_ready_; }
+  virtual void FrameNotDue(uint32_t wait_ms) {}
+  int frames_ready() const { return frames_ready_; }
+
+ private:
+  int frames_ready_;
+};
+
+TEST_F(TestBasicJitterBuffer, FrameReadyCallback) {
+  CountingFrameReadyCallback callback;
+  jitter_buffer_->RegisterFrameReadyCallback(&callback);
+  packet_->frameType = kVideoFrameKey;
+  packet_->isFirstPacket = true;
+  packet_->markerBit = false;
+
+  VCMEncodedFrame* frame_in = jitter_buffer_->GetFrame(*packet_);
+  EXPECT_EQ(kFirstPacket, jitter_buffer_->InsertPacket(frame_in, *packet_));
+  // Not called for an incomplete frame.
+  EXPECT_EQ(0, callback.frames_ready());
+
+  ++seq_num_;
+  packet_->isFirstPacket = false;
+  packet_->markerBit = true;
+  packet_->seqNum = seq_num_;
+  frame_in = jitter_buffer_->GetFrame(*packet_);
+  EXPECT_EQ(kCompleteSession, jitter_buffer_->InsertPacket(frame_in, *packet_));
+  EXPECT_EQ(1, callback.frames_ready());
+  EXPECT_EQ(0, CheckOutFrame(DecodeCompleteFrame(), 2 * size_, false));
+
+  // Not called anymore once deregistered.
+  jitter_buffer_->RegisterFrameReadyCallback(NULL);
+  ++seq_num_;
+  packet_->frameType = kVideoFrameDelta;
+  packet_->isFirstPacket = true;
+  packet_->seqNum = seq_num_;
+  packet_->timestamp += 33 * 90;
+  frame_in = jitter_buffer_->GetFrame(*packet_);
+  EXPECT_EQ(kCompleteSession, jitter_buffer_->InsertPacket(frame_in, *packet_));
+  EXPECT_EQ(1, callback.frames_ready());
+  EXPECT_TRUE(DecodeCompleteFrame() != NULL);
+}
+
 TEST_F(TestBasicJitterBuffer, 100PacketKeyFrame) {
   packet_->frameType = kVideoFrameKey;
   packet_->isFirstPacket = true;
@@ -523,6 +618,49 @@ TEST_F(TestBasicJitterBuffer, FrameReordering2Frames2PacketsEach) {
   EXPECT_EQ(kVideoFrameDelta, frame_out->FrameType());
 }
 
+TEST_F(TestBasicJitterBuffer, OlderFrameCompletedLastIsDecodedFirst) {
+  packet_->frameType = kVideoFrameKey;
+  packet_->isFirstPacket = true;
+  packet_->markerBit = true;
+  VCMEncodedFrame* frame_in = jitter_buffer_->GetFrame(*packet_);
+  EXPECT_EQ(kCompleteSession, jitter_buffer_->InsertPacket(frame_in, *packet_));
+  VCMEncodedFrame* frame_out = DecodeCompleteFrame();
+  EXPECT_EQ(0, CheckOutFrame(frame_out, size_, false));
+  jitter_buffer_->ReleaseFrame(frame_out);
+
+  // First packet of a two packet delta frame.
+  packet_->frameType = kVideoFrameDelta;
+  packet_->isFirstPacket = true;
+  packet_->markerBit = false;
+  packet_->seqNum = ++seq_num_;
+  packet_->timestamp = timestamp_ + 33 * 90;
+  frame_in = jitter_buffer_->GetFrame(*packet_);
+  EXPECT_EQ(kFirstPacket, jitter_buffer_->InsertPacket(frame_in, *packet_));
+
+  // The following single packet delta frame is complete but not continuous.
+  packet_->markerBit = true;
+  packet_->seqNum = seq_num_ + 2;
+  packet_->timestamp = timestamp_ + 2 * 33 * 90;
+  frame_in = jitter_buffer_->GetFrame(*packet_);
+  EXPECT_EQ(kCompleteSession, jitter_buffer_->InsertPacket(frame_in, *packet_));
+  EXPECT_TRUE(DecodeCompleteFrame() == NULL);
+
+  // Completing the older frame makes both decodable, in order.
+  packet_->isFirstPacket = false;
+  packet_->seqNum = ++seq_num_;
+  packet_->timestamp = timestamp_ + 33 * 90;
+  frame_in = jitter_buffer_->GetFrame(*packet_);
+  EXPECT_EQ(kCompleteSession, jitter_buffer_->InsertPacket(frame_in, *packet_));
+  frame_out = DecodeCompleteFrame();
+  EXPECT_EQ(0, CheckOutFrame(frame_out, 2 * size_, false));
+  EXPECT_EQ(timestamp_ + 33 * 90, frame_out->TimeStamp());
+  jitter_buffer_->ReleaseFrame(frame_out);
+  frame_out = DecodeCompleteFrame();
+  EXPECT_EQ(0, CheckOutFrame(frame_out, size_, false));
+  EXPECT_EQ(timestamp_ + 2 * 33 * 90, frame_out->TimeStamp());
+  jitter_buffer_->ReleaseFrame(frame_out);
+}
+
 TEST_F(TestBasicJitterBuffer, DuplicatePackets) {
   packet_->frameType = kVideoFrameKey;
   packet_->isFirstPacket = true;
@@ -1780,4 +1918,101 @@ TEST_F(TestJitterBufferNack, NormalOperationWrap2) {
   EXPECT_EQ(65535, list[0]);
 }
 
+class TestJitterBufferReplay : public TestJitterBufferNack {
+ protected:
+  enum { kTimestampDelta = 1500 };  // 60 fps.
+
+  // Replays |num_frames| frames of |packets_per_frame| packets each through
+  // the jitter buffer, decoding a frame once it is |depth| frames old. Every
+  // |reorder_interval|th packet is swapped with the one following it, and
+  // every |loss_interval|th packet is lost and retransmitted |rtx_delay|
+  // frames later. An interval of 0 disables reordering or loss. Returns the
+  // number of packets inserted per second.
+  double Replay(int num_frames, int packets_per_frame, int depth,
+                int reorder_interval, int loss_interval, int rtx_delay) {
+    jitter_buffer_->Flush();
+    jitter_buffer_->SetNackSettings(1000, 1000, 0);
+    uint8_t payload[500] = { 0 };
+    std::list<std::pair<int, VCMPacket> > retransmissions;
+    std::vector<VCMPacket> packets;
+    uint16_t seq_num = 0xffff - 100;
+    uint32_t timestamp = 0xffffffff - 100 * kTimestampDelta;
+    int packet_count = 0;
+    int inserted = 0;
+    int decoded = 0;
+    TickTime start = TickTime::Now();
+    for (int f = 0; f < num_frames; ++f) {
+      packets.clear();
+      while (!retransmissions.empty() && retransmissions.front().first <= f) {
+        packets.push_back(retransmissions.front().second);
+        retransmissions.pop_front();
+      }
+      const size_t first_new_packet = packets.size();
+      for (int p = 0; p < packets_per_frame; ++p) {
+        VCMPacket packet(payload, sizeof(payload), seq_num++, timestamp,
+                         p == packets_per_frame - 1);
+        packet.frameType = (f == 0) ? kVideoFrameKey : kVideoFrameDelta;
+        packet.isFirstPacket = (p == 0);
+        if (packet.isFirstPacket)
+          packet.completeNALU = kNaluStart;
+        else if (packet.markerBit)
+          packet.completeNALU = kNaluEnd;
+        ++packet_count;
+        if (loss_interval > 0 && packet_count % loss_interval == 0) {
+          retransmissions.push_back(std::make_pair(f + rtx_delay, packet));
+        } else {
+          packets.push_back(packet);
+        }
+      }
+      for (size_t i = first_new_packet; reorder_interval > 0 &&
+           i + 1 < packets.size(); ++i) {
+        if ((f * packets_per_frame + i) % reorder_interval == 0)
+          std::swap(packets[i], packets[i + 1]);
+      }
+      for (size_t i = 0; i < packets.size(); ++i) {
+        VCMEncodedFrame* frame = NULL;
+        if (jitter_buffer_->GetFrame(packets[i], frame) == VCM_OK) {
+          jitter_buffer_->InsertPacket(frame, packets[i]);
+          ++inserted;
+        }
+      }
+      uint16_t nack_list_size = 0;
+      bool request_key_frame = false;
+      jitter_buffer_->GetNackList(&nack_list_size, &request_key_frame);
+      EXPECT_FALSE(request_key_frame);
+      uint32_t next_timestamp = 0;
+      while (jitter_buffer_->NextCompleteTimestamp(0, &next_timestamp) &&
+             static_cast<int32_t>(timestamp - next_timestamp) >=
+             depth * kTimestampDelta) {
+        jitter_buffer_->ReleaseFrame(
+            jitter_buffer_->ExtractAndSetDecode(next_timestamp));
+        ++decoded;
+      }
+      timestamp += kTimestampDelta;
+      clock_->AdvanceTimeMilliseconds(1000 / 60);
+    }
+    const int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    EXPECT_EQ(num_frames - depth, decoded);
+    return inserted * 1e6 / std::max<int64_t>(elapsed_us, 1);
+  }
+};
+
+// Measures the insert rate of the jitter buffer with clean, reordered and
+// lossy streams, with the decoder running a few or many frames behind.
+TEST_F(TestJitterBufferReplay, DISABLED_InsertPacketBenchmark) {
+  const int kNumFrames = 3000;
+  const int kPacketsPerFrame = 10;
+  const int kDepths[] = { 8, 64, 200 };
+  for (size_t i = 0; i < sizeof(kDepths) / sizeof(kDepths[0]); ++i) {
+    const int depth = kDepths[i];
+    double clean = Replay(kNumFrames, kPacketsPerFrame, depth, 0, 0, 0);
+    double reordered = Replay(kNumFrames, kPacketsPerFrame, depth, 7, 0, 0);
+    double lossy = Replay(kNumFrames, kPacketsPerFrame, depth, 7, 23,
+                          std::min(depth - 1, 6));
+    printf("Depth %3d frames: %.0f inserts/s clean, %.0f inserts/s "
+           "reordered, %.0f inserts/s reordered with 4%% loss and NACK\n",
+           depth, clean, reordered, lossy);
+  }
+}
+
 }  // namespace webrtc
@@ -218,6 +218,7 @@ VCMEncodedFrame* VCMReceiver::FrameForDecoding(
       // waiting as long as we're allowed to avoid busy looping, and then return
       // NULL. Next call to this function might return the frame.
       render_wait_event_->Wait(max_wait_time_ms);
+      jitter_buffer_.FrameNotDue(wait_time_ms - new_max_wait_time);
       return NULL;
     }
     // Wait until it's time to render.
@@ -359,6 +360,11 @@ int VCMReceiver::SetMinReceiverDelay(int desired_delay_ms) {
   return 0;
 }
 
+void VCMReceiver::RegisterFrameReadyCallback(
+    VCMFrameReadyCallback* callback) {
+  jitter_buffer_.RegisterFrameReadyCallback(callback);
+}
+
 int VCMReceiver::RenderBufferSizeMs() {
   uint32_t timestamp_start = 0u;
   uint32_t timestamp_end = 0u;
@@ -86,6 +86,8 @@ class VCMReceiver {
   // the time this function is called.
   int RenderBufferSizeMs();
 
+  void RegisterFrameReadyCallback(VCMFrameReadyCallback* callback);
+
  private:
   void CopyJitterBufferStateFromReceiver(const VCMReceiver& receiver);
   void UpdateState(VCMReceiverState new_state);
@@ -888,6 +888,14 @@ int VideoCodingModuleImpl::RegisterRenderBufferSizeCallback(
   return VCM_OK;
 }
 
+int32_t
+VideoCodingModuleImpl::RegisterFrameReadyCallback(
+    VCMFrameReadyCallback* callback)
+{
+    _receiver.RegisterFrameReadyCallback(callback);
+    return VCM_OK;
+}
+
 // Decode next frame, blocking.
 // Should be called as often as possible to get the most out of the decoder.
 int32_t
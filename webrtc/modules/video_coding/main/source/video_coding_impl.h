@@ -200,6 +200,10 @@ public:
     virtual int RegisterRenderBufferSizeCallback(
         VCMRenderBufferSizeCallback* callback);
 
+    // Frame ready callback.
+    virtual int32_t RegisterFrameReadyCallback(
+        VCMFrameReadyCallback* callback);
+
     // Decode next frame, blocks for a maximum of maxWaitTimeMs milliseconds.
     // Should be called as often as possible to get the most out of the decoder.
     virtual int32_t Decode(uint16_t maxWaitTimeMs = 200);
@@ -51,8 +51,6 @@ VPMBrightnessDetection::ProcessFrame(const I420VideoFrame& frame,
                      "Null frame pointer");
         return VPM_PARAMETER_ERROR;
     }
-    int width = frame.width();
-    int height = frame.height();
 
     if (!VideoProcessingModule::ValidFrameStats(stats))
     {
@@ -85,19 +83,15 @@ VPMBrightnessDetection::ProcessFrame(const I420VideoFrame& frame,
     {
         if (stats.mean < 90 || stats.mean > 170)
         {
-            // Standard deviation of Y
-            const uint8_t* buffer = frame.buffer(kYPlane);
-            float stdY = 0;
-            for (int h = 0; h < height; h += (1 << stats.subSamplHeight))
+            // Standard deviation of Y, from the histogram of the same
+            // subsampled pixels rather than from the frame itself.
+            uint64_t sqDevSum = 0;
+            for (int32_t i = 0; i < 256; i++)
             {
-                int row = h*width;
-                for (int w = 0; w < width; w += (1 << stats.subSamplWidth))
-                {
-                    stdY += (buffer[w + row] - stats.mean) * (buffer[w + row] -
-                        stats.mean);
-                }
-            }           
-            stdY = sqrt(stdY / stats.numPixels);
+                const int64_t dev = i - static_cast<int64_t>(stats.mean);
+                sqDevSum += stats.hist[i] * static_cast<uint64_t>(dev * dev);
+            }
+            float stdY = sqrt(static_cast<float>(sqDevSum) / stats.numPixels);
 
             // Get percentiles
             uint32_t sum = 0;
@@ -10,23 +10,40 @@
 
 #include "denoising.h"
 #include "trace.h"
+#include "system_wrappers/interface/cpu_features_wrapper.h"
 
 #include <cstring>
 
 namespace webrtc {
 
-enum { kSubsamplingTime = 0 };       // Down-sampling in time (unit: number of frames)
-enum { kSubsamplingWidth = 0 };      // Sub-sampling in width (unit: power of 2)
-enum { kSubsamplingHeight = 0 };     // Sub-sampling in height (unit: power of 2)
-enum { kDenoiseFiltParam = 179 };    // (Q8) De-noising filter parameter
-enum { kDenoiseFiltParamRec = 77 };  // (Q8) 1 - filter parameter
-enum { kDenoiseThreshold = 19200 };  // (Q8) De-noising threshold level
-
-VPMDenoising::VPMDenoising() :
+VPMDenoising::VPMDenoising(bool runtime_cpu_detection) :
+    _denoise(Denoise_C),
     _id(0),
     _moment1(NULL),
     _moment2(NULL)
 {
+    if (runtime_cpu_detection)
+    {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+        if (WebRtc_GetCPUInfo(kAVX2))
+        {
+            _denoise = Denoise_AVX2;
+        }
+        else if (WebRtc_GetCPUInfo(kSSE2))
+        {
+            _denoise = Denoise_SSE2;
+        }
+#elif defined(WEBRTC_ARCH_ARM_V7)
+#if defined(WEBRTC_ARCH_ARM_NEON)
+        _denoise = Denoise_NEON;
+#else
+        if (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON)
+        {
+            _denoise = Denoise_NEON;
+        }
+#endif
+#endif
+    }
     Reset();
 }
 
@@ -56,7 +73,6 @@ void
 VPMDenoising::Reset()
 {
     _frameSize = 0;
-    _denoiseFrameCnt = 0;
 
     if (_moment1)
     {
@@ -75,14 +91,6 @@ int32_t
 VPMDenoising::ProcessFrame(I420VideoFrame* frame)
 {
     assert(frame);
-    int32_t     thevar;
-    int               k;
-    int               jsub, ksub;
-    int32_t     diff0;
-    uint32_t    tmpMoment1;
-    uint32_t    tmpMoment2;
-    uint32_t    tmp;
-    int32_t     numPixelsChanged = 0;
 
     if (frame->IsZeroSize())
     {
@@ -120,60 +128,52 @@ VPMDenoising::ProcessFrame(I420VideoFrame* frame)
         memset(_moment2, 0, sizeof(uint32_t)*ysize);
     }
 
-    /* Apply de-noising on each pixel, but update variance sub-sampled */
-    uint8_t* buffer = frame->buffer(kYPlane);
-    for (int i = 0; i < height; i++)
-    { // Collect over height
-        k = i * width;
-        ksub = ((i >> kSubsamplingHeight) << kSubsamplingHeight) * width;
-        for (int j = 0; j < width; j++)
-        { // Collect over width
-            jsub = ((j >> kSubsamplingWidth) << kSubsamplingWidth);
-            /* Update mean value for every pixel and every frame */
-            tmpMoment1 = _moment1[k + j];
-            tmpMoment1 *= kDenoiseFiltParam; // Q16
-            tmpMoment1 += ((kDenoiseFiltParamRec *
-                          ((uint32_t)buffer[k + j])) << 8);
-            tmpMoment1 >>= 8; // Q8
-            _moment1[k + j] = tmpMoment1;
-
-            tmpMoment2 = _moment2[ksub + jsub];
-            if ((ksub == k) && (jsub == j) && (_denoiseFrameCnt == 0))
-            {
-                tmp = ((uint32_t)buffer[k + j] *
-                      (uint32_t)buffer[k + j]);
-                tmpMoment2 *= kDenoiseFiltParam; // Q16
-                tmpMoment2 += ((kDenoiseFiltParamRec * tmp)<<8);
-                tmpMoment2 >>= 8; // Q8
-            }
-            _moment2[k + j] = tmpMoment2;
-            /* Current event = deviation from mean value */
-            diff0 = ((int32_t)buffer[k + j] << 8) - _moment1[k + j];
-            /* Recent events = variance (variations over time) */
-            thevar = _moment2[k + j];
-            thevar -= ((_moment1[k + j] * _moment1[k + j]) >> 8);
-            /***************************************************************************
-             * De-noising criteria, i.e., when should we replace a pixel by its mean
-             *
-             * 1) recent events are minor
-             * 2) current events are minor
-             ***************************************************************************/
-            if ((thevar < kDenoiseThreshold)
-                && ((diff0 * diff0 >> 8) < kDenoiseThreshold))
-            { // Replace with mean
-                buffer[k + j] = (uint8_t)(_moment1[k + j] >> 8);
-                numPixelsChanged++;
-            }
-        }
-    }
+    /* Apply de-noising on each pixel */
+    return _denoise(frame->buffer(kYPlane), _moment1, _moment2, ysize);
+}
 
-    /* Update frame counter */
-    _denoiseFrameCnt++;
-    if (_denoiseFrameCnt > kSubsamplingTime)
+int32_t
+VPMDenoising::Denoise_C(uint8_t* pixels, uint32_t* moment1,
+                        uint32_t* moment2, int numPixels)
+{
+    int32_t numPixelsChanged = 0;
+    for (int i = 0; i < numPixels; i++)
     {
-        _denoiseFrameCnt = 0;
+        const uint32_t pixel = pixels[i];
+        /* Update mean value for every pixel and every frame */
+        uint32_t tmpMoment1 = moment1[i];
+        tmpMoment1 *= kDenoiseFiltParam; // Q16
+        tmpMoment1 += ((kDenoiseFiltParamRec * pixel) << 8);
+        tmpMoment1 >>= 8; // Q8
+        moment1[i] = tmpMoment1;
+
+        /* Update second order moment. The moments stay below 2^16 and 2^24,
+         * respectively, so that none of the products below overflow. */
+        uint32_t tmpMoment2 = moment2[i];
+        tmpMoment2 *= kDenoiseFiltParam; // Q16
+        tmpMoment2 += ((kDenoiseFiltParamRec * (pixel * pixel)) << 8);
+        tmpMoment2 >>= 8; // Q8
+        moment2[i] = tmpMoment2;
+
+        /* Current event = deviation from mean value */
+        const int32_t diff0 = (static_cast<int32_t>(pixel) << 8) - tmpMoment1;
+        /* Recent events = variance (variations over time) */
+        const int32_t thevar = static_cast<int32_t>(tmpMoment2 -
+            ((tmpMoment1 * tmpMoment1) >> 8));
+        /***********************************************************************
+         * De-noising criteria, i.e., when should we replace a pixel by its mean
+         *
+         * 1) recent events are minor
+         * 2) current events are minor
+         **********************************************************************/
+        if ((thevar < kDenoiseThreshold)
+            && (((static_cast<uint32_t>(diff0) * diff0) >> 8) <
+                static_cast<uint32_t>(kDenoiseThreshold)))
+        { // Replace with mean
+            pixels[i] = (uint8_t)(tmpMoment1 >> 8);
+            numPixelsChanged++;
+        }
     }
-
     return numPixelsChanged;
 }
 
@@ -22,7 +22,9 @@ namespace webrtc {
 class VPMDenoising
 {
 public:
-    VPMDenoising();
+    // When |runtime_cpu_detection| is true, runtime selection of an optimized
+    // code path is allowed.
+    explicit VPMDenoising(bool runtime_cpu_detection = true);
     ~VPMDenoising();
 
     int32_t ChangeUniqueId(int32_t id);
@@ -32,12 +34,37 @@ public:
     int32_t ProcessFrame(I420VideoFrame* frame);
 
 private:
+    enum { kDenoiseFiltParam = 179 };    // (Q8) De-noising filter parameter
+    enum { kDenoiseFiltParamRec = 77 };  // (Q8) 1 - filter parameter
+    enum { kDenoiseThreshold = 19200 };  // (Q8) De-noising threshold level
+    // The largest deviation from the mean, in Q8, for which
+    // (diff * diff) >> 8 < kDenoiseThreshold.
+    enum { kDenoiseMaxDiff = 2217 };
+
+    // Updates the moments of |numPixels| pixels and replaces the pixels
+    // whose mean and variance over time are both small by their mean.
+    // Returns the number of replaced pixels. The optimized versions are
+    // bit-exact with the C version.
+    typedef int32_t (*DenoiseFunc)(uint8_t* pixels, uint32_t* moment1,
+                                   uint32_t* moment2, int numPixels);
+    DenoiseFunc _denoise;
+    static int32_t Denoise_C(uint8_t* pixels, uint32_t* moment1,
+                             uint32_t* moment2, int numPixels);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    static int32_t Denoise_SSE2(uint8_t* pixels, uint32_t* moment1,
+                                uint32_t* moment2, int numPixels);
+    static int32_t Denoise_AVX2(uint8_t* pixels, uint32_t* moment1,
+                                uint32_t* moment2, int numPixels);
+#elif defined(WEBRTC_ARCH_ARM_V7)
+    static int32_t Denoise_NEON(uint8_t* pixels, uint32_t* moment1,
+                                uint32_t* moment2, int numPixels);
+#endif
+
     int32_t _id;
 
     uint32_t*   _moment1;           // (Q8) First order moment (mean)
     uint32_t*   _moment2;           // (Q8) Second order moment
     uint32_t    _frameSize;         // Size (# of pixels) of frame
-    int               _denoiseFrameCnt;   // Counter for subsampling in time
 };
 
 } //namespace
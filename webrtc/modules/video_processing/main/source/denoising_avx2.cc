@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "denoising.h"
+
+#include <immintrin.h>
+
+namespace webrtc {
+
+int32_t
+VPMDenoising::Denoise_AVX2(uint8_t* pixels, uint32_t* moment1,
+                           uint32_t* moment2, int numPixels)
+{
+    const __m256i filtParam = _mm256_set1_epi32(kDenoiseFiltParam);
+    const __m256i filtParamRec = _mm256_set1_epi32(kDenoiseFiltParamRec << 8);
+    const __m256i threshold = _mm256_set1_epi32(kDenoiseThreshold);
+    const __m256i maxDiff = _mm256_set1_epi32(kDenoiseMaxDiff + 1);
+    __m256i changed = _mm256_setzero_si256();
+
+    // Work on 16 pixels at a time, eight in each of two vectors.
+    const int numPixels16 = numPixels & ~15;
+    for (int i = 0; i < numPixels16; i += 16)
+    {
+        const __m128i in =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+        __m256i out[2];
+        for (int j = 0; j < 2; j++)
+        {
+            __m256i* m1Ptr = reinterpret_cast<__m256i*>(moment1 + i + 8 * j);
+            __m256i* m2Ptr = reinterpret_cast<__m256i*>(moment2 + i + 8 * j);
+            const __m256i pixel = _mm256_cvtepu8_epi32(
+                j ? _mm_srli_si128(in, 8) : in);
+
+            // Update mean value.
+            __m256i m1 = _mm256_mullo_epi32(_mm256_loadu_si256(m1Ptr),
+                                            filtParam);
+            m1 = _mm256_add_epi32(m1, _mm256_mullo_epi32(pixel, filtParamRec));
+            m1 = _mm256_srli_epi32(m1, 8);
+            _mm256_storeu_si256(m1Ptr, m1);
+
+            // Update second order moment.
+            __m256i m2 = _mm256_mullo_epi32(_mm256_loadu_si256(m2Ptr),
+                                            filtParam);
+            m2 = _mm256_add_epi32(m2, _mm256_mullo_epi32(
+                _mm256_mullo_epi32(pixel, pixel), filtParamRec));
+            m2 = _mm256_srli_epi32(m2, 8);
+            _mm256_storeu_si256(m2Ptr, m2);
+
+            const __m256i diff0 =
+                _mm256_sub_epi32(_mm256_slli_epi32(pixel, 8), m1);
+            const __m256i thevar = _mm256_sub_epi32(
+                m2, _mm256_srli_epi32(_mm256_mullo_epi32(m1, m1), 8));
+            const __m256i replace = _mm256_and_si256(
+                _mm256_cmpgt_epi32(threshold, thevar),
+                _mm256_cmpgt_epi32(maxDiff, _mm256_abs_epi32(diff0)));
+
+            out[j] = _mm256_blendv_epi8(pixel, _mm256_srli_epi32(m1, 8),
+                                        replace);
+            changed = _mm256_sub_epi32(changed, replace);
+        }
+        // The packs work within 128-bit lanes, so restore the pixel order
+        // before the final pack.
+        const __m256i out16 = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(out[0], out[1]), 0xd8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i),
+                         _mm_packus_epi16(_mm256_castsi256_si128(out16),
+                                          _mm256_extracti128_si256(out16, 1)));
+    }
+
+    __m128i changed128 = _mm_add_epi32(_mm256_castsi256_si128(changed),
+                                       _mm256_extracti128_si256(changed, 1));
+    changed128 = _mm_add_epi32(changed128, _mm_srli_si128(changed128, 8));
+    changed128 = _mm_add_epi32(changed128, _mm_srli_si128(changed128, 4));
+    int32_t numPixelsChanged = _mm_cvtsi128_si32(changed128);
+
+    // Handle the remaining pixels.
+    numPixelsChanged += Denoise_C(pixels + numPixels16, moment1 + numPixels16,
+                                  moment2 + numPixels16,
+                                  numPixels - numPixels16);
+    return numPixelsChanged;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "denoising.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+int32_t
+VPMDenoising::Denoise_NEON(uint8_t* pixels, uint32_t* moment1,
+                           uint32_t* moment2, int numPixels)
+{
+    const int32x4_t threshold = vdupq_n_s32(kDenoiseThreshold);
+    const int32x4_t maxDiff = vdupq_n_s32(kDenoiseMaxDiff);
+    uint32x4_t changed = vdupq_n_u32(0);
+
+    // Work on 8 pixels at a time, four in each of two vectors.
+    const int numPixels8 = numPixels & ~7;
+    for (int i = 0; i < numPixels8; i += 8)
+    {
+        const uint16x8_t in = vmovl_u8(vld1_u8(pixels + i));
+        uint16x4_t out[2];
+        for (int j = 0; j < 2; j++)
+        {
+            uint32_t* m1Ptr = moment1 + i + 4 * j;
+            uint32_t* m2Ptr = moment2 + i + 4 * j;
+            const uint32x4_t pixel =
+                vmovl_u16(j ? vget_high_u16(in) : vget_low_u16(in));
+
+            // Update mean value.
+            uint32x4_t m1 = vmulq_n_u32(vld1q_u32(m1Ptr), kDenoiseFiltParam);
+            m1 = vmlaq_n_u32(m1, pixel, kDenoiseFiltParamRec << 8);
+            m1 = vshrq_n_u32(m1, 8);
+            vst1q_u32(m1Ptr, m1);
+
+            // Update second order moment.
+            uint32x4_t m2 = vmulq_n_u32(vld1q_u32(m2Ptr), kDenoiseFiltParam);
+            m2 = vmlaq_n_u32(m2, vmulq_u32(pixel, pixel),
+                             kDenoiseFiltParamRec << 8);
+            m2 = vshrq_n_u32(m2, 8);
+            vst1q_u32(m2Ptr, m2);
+
+            const int32x4_t diff0 = vsubq_s32(
+                vreinterpretq_s32_u32(vshlq_n_u32(pixel, 8)),
+                vreinterpretq_s32_u32(m1));
+            const int32x4_t thevar = vreinterpretq_s32_u32(
+                vsubq_u32(m2, vshrq_n_u32(vmulq_u32(m1, m1), 8)));
+            const uint32x4_t replace =
+                vandq_u32(vcltq_s32(thevar, threshold),
+                          vcleq_s32(vabsq_s32(diff0), maxDiff));
+
+            out[j] = vmovn_u32(vbslq_u32(replace, vshrq_n_u32(m1, 8), pixel));
+            changed = vsubq_u32(changed, replace);
+        }
+        vst1_u8(pixels + i, vmovn_u16(vcombine_u16(out[0], out[1])));
+    }
+
+    int32_t numPixelsChanged = vgetq_lane_u32(changed, 0) +
+        vgetq_lane_u32(changed, 1) + vgetq_lane_u32(changed, 2) +
+        vgetq_lane_u32(changed, 3);
+
+    // Handle the remaining pixels.
+    numPixelsChanged += Denoise_C(pixels + numPixels8, moment1 + numPixels8,
+                                  moment2 + numPixels8,
+                                  numPixels - numPixels8);
+    return numPixelsChanged;
+}
+
+}  // namespace webrtc
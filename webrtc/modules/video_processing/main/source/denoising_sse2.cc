@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "denoising.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+
+namespace {
+
+// Multiplies the unsigned 32-bit lanes of |x| by the 16-bit constant in |k|,
+// which must hold the constant in all of its 16-bit lanes. Returns the low 32
+// bits of the products.
+inline __m128i MulLo32By16(const __m128i& x, const __m128i& k)
+{
+    return _mm_add_epi32(_mm_mullo_epi16(x, k),
+                         _mm_slli_epi32(_mm_mulhi_epu16(x, k), 16));
+}
+
+// Squares the 32-bit lanes of |x|, all of which must be below 2^16.
+inline __m128i Square16(const __m128i& x)
+{
+    return _mm_add_epi32(_mm_mullo_epi16(x, x),
+                         _mm_slli_epi32(_mm_mulhi_epu16(x, x), 16));
+}
+
+}  // namespace
+
+int32_t
+VPMDenoising::Denoise_SSE2(uint8_t* pixels, uint32_t* moment1,
+                           uint32_t* moment2, int numPixels)
+{
+    const __m128i z = _mm_setzero_si128();
+    const __m128i filtParam = _mm_set1_epi16(kDenoiseFiltParam);
+    const __m128i filtParamRec = _mm_set1_epi16(kDenoiseFiltParamRec);
+    const __m128i threshold = _mm_set1_epi32(kDenoiseThreshold);
+    const __m128i maxDiff = _mm_set1_epi32(kDenoiseMaxDiff + 1);
+    const __m128i minDiff = _mm_set1_epi32(-kDenoiseMaxDiff - 1);
+    __m128i changed = _mm_setzero_si128();
+
+    // Work on 16 pixels at a time, four in each of four vectors.
+    const int numPixels16 = numPixels & ~15;
+    for (int i = 0; i < numPixels16; i += 16)
+    {
+        const __m128i in =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+        const __m128i in16[2] = { _mm_unpacklo_epi8(in, z),
+                                  _mm_unpackhi_epi8(in, z) };
+        __m128i out[4];
+        for (int j = 0; j < 4; j++)
+        {
+            __m128i* m1Ptr = reinterpret_cast<__m128i*>(moment1 + i + 4 * j);
+            __m128i* m2Ptr = reinterpret_cast<__m128i*>(moment2 + i + 4 * j);
+            const __m128i pixel = (j & 1) ? _mm_unpackhi_epi16(in16[j >> 1], z)
+                                          : _mm_unpacklo_epi16(in16[j >> 1], z);
+
+            // Update mean value. The pixel term is below 2^16, so a 16-bit
+            // multiplication is enough.
+            __m128i m1 = MulLo32By16(_mm_loadu_si128(m1Ptr), filtParam);
+            m1 = _mm_add_epi32(m1, _mm_slli_epi32(
+                _mm_mullo_epi16(pixel, filtParamRec), 8));
+            m1 = _mm_srli_epi32(m1, 8);
+            _mm_storeu_si128(m1Ptr, m1);
+
+            // Update second order moment.
+            __m128i m2 = MulLo32By16(_mm_loadu_si128(m2Ptr), filtParam);
+            m2 = _mm_add_epi32(m2, _mm_slli_epi32(
+                MulLo32By16(Square16(pixel), filtParamRec), 8));
+            m2 = _mm_srli_epi32(m2, 8);
+            _mm_storeu_si128(m2Ptr, m2);
+
+            const __m128i diff0 = _mm_sub_epi32(_mm_slli_epi32(pixel, 8), m1);
+            const __m128i thevar =
+                _mm_sub_epi32(m2, _mm_srli_epi32(Square16(m1), 8));
+            const __m128i replace = _mm_and_si128(
+                _mm_cmplt_epi32(thevar, threshold),
+                _mm_and_si128(_mm_cmplt_epi32(diff0, maxDiff),
+                              _mm_cmpgt_epi32(diff0, minDiff)));
+
+            out[j] = _mm_or_si128(
+                _mm_and_si128(replace, _mm_srli_epi32(m1, 8)),
+                _mm_andnot_si128(replace, pixel));
+            changed = _mm_sub_epi32(changed, replace);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i),
+                         _mm_packus_epi16(_mm_packs_epi32(out[0], out[1]),
+                                          _mm_packs_epi32(out[2], out[3])));
+    }
+
+    changed = _mm_add_epi32(changed, _mm_srli_si128(changed, 8));
+    changed = _mm_add_epi32(changed, _mm_srli_si128(changed, 4));
+    int32_t numPixelsChanged = _mm_cvtsi128_si32(changed);
+
+    // Handle the remaining pixels.
+    numPixelsChanged += Denoise_C(pixels + numPixels16, moment1 + numPixels16,
+                                  moment2 + numPixels16,
+                                  numPixels - numPixels16);
+    return numPixelsChanged;
+}
+
+}  // namespace webrtc
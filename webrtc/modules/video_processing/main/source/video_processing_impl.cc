@@ -132,17 +132,36 @@ VideoProcessingModule::GetFrameStats(FrameStats* stats,
     SetSubSampling(stats, width, height);
 
     const uint8_t* buffer = frame.buffer(kYPlane);
-    // Compute histogram and sum of frame
+    // Compute histogram of frame. Four partial histograms are used so that
+    // runs of equal pixels do not serialize on a single counter.
+    uint32_t partialHist[4][256];
+    memset(partialHist, 0, sizeof(partialHist));
+    const int step = 1 << stats->subSamplWidth;
     for (int i = 0; i < height; i += (1 << stats->subSamplHeight))
     {
-        int k = i * width;
-        for (int j = 0; j < width; j += (1 << stats->subSamplWidth))
-        { 
-            stats->hist[buffer[k + j]]++;
-            stats->sum += buffer[k + j];
+        const uint8_t* row = buffer + i * width;
+        int j = 0;
+        for (; j + 3 * step < width; j += 4 * step)
+        {
+            partialHist[0][row[j]]++;
+            partialHist[1][row[j + step]]++;
+            partialHist[2][row[j + 2 * step]]++;
+            partialHist[3][row[j + 3 * step]]++;
+        }
+        for (; j < width; j += step)
+        {
+            partialHist[0][row[j]]++;
         }
     }
 
+    // Compute sum of frame from the histogram.
+    for (int i = 0; i < 256; i++)
+    {
+        stats->hist[i] = partialHist[0][i] + partialHist[1][i] +
+            partialHist[2][i] + partialHist[3][i];
+        stats->sum += i * stats->hist[i];
+    }
+
     stats->numPixels = (width * height) / ((1 << stats->subSamplWidth) *
         (1 << stats->subSamplHeight));
     assert(stats->numPixels > 0);
@@ -10,9 +10,11 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "modules/video_processing/main/interface/video_processing.h"
+#include "modules/video_processing/main/source/denoising.h"
 #include "modules/video_processing/main/test/unit_test/unit_test.h"
 #include "system_wrappers/interface/tick_util.h"
 #include "testsupport/fileutils.h"
@@ -132,4 +134,61 @@ TEST_F(VideoProcessingModuleTest, Denoising)
         static_cast<int>(minRuntime / frameNum));
 }
 
+// The optimized de-noising must be bit-exact with the C version. The frame
+// size is chosen to leave a remainder after the vectorized loops.
+TEST(VPMDenoisingTest, OptimizedMatchesC)
+{
+    const int kWidth = 182;
+    const int kHeight = 98;
+    const int kHalfWidth = (kWidth + 1) / 2;
+    VPMDenoising denoiseC(false);
+    VPMDenoising denoiseOptimized(true);
+    I420VideoFrame frameC;
+    I420VideoFrame frameOptimized;
+    ASSERT_EQ(0, frameC.CreateEmptyFrame(kWidth, kHeight, kWidth, kHalfWidth,
+                                         kHalfWidth));
+
+    srand(1234);
+    for (int frameNum = 0; frameNum < 50; frameNum++)
+    {
+        // Flat regions with a little noise, which get de-noised, next to
+        // regions with strong noise and a gradient, which do not.
+        uint8_t* buffer = frameC.buffer(kYPlane);
+        for (int i = 0; i < kHeight; i++)
+        {
+            for (int j = 0; j < kWidth; j++)
+            {
+                int value;
+                if (j < kWidth / 3)
+                {
+                    value = 16 + rand() % 5;
+                }
+                else if (j < 2 * kWidth / 3)
+                {
+                    value = 128 + (i + j + frameNum) % 32 + rand() % 9;
+                }
+                else
+                {
+                    // Includes the extremes, which maximize the moments.
+                    value = (rand() % 2) ? 255 : rand() % 256;
+                }
+                buffer[i * kWidth + j] = static_cast<uint8_t>(value);
+            }
+        }
+        frameOptimized.CopyFrame(frameC);
+
+        const int32_t changedC = denoiseC.ProcessFrame(&frameC);
+        const int32_t changedOptimized =
+            denoiseOptimized.ProcessFrame(&frameOptimized);
+        EXPECT_EQ(changedC, changedOptimized);
+        if (frameNum > 0)
+        {
+            EXPECT_GT(changedC, 0);
+        }
+        ASSERT_EQ(0, memcmp(frameC.buffer(kYPlane),
+                            frameOptimized.buffer(kYPlane),
+                            kWidth * kHeight)) << "Frame " << frameNum;
+    }
+}
+
 }  // namespace webrtc
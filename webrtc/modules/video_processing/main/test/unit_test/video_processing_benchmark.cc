@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Reports the run time per frame of the pixel-processing functions of the
+// VideoProcessingModule on synthetic frames at 360p, 720p and 1080p.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+#include "modules/video_processing/main/interface/video_processing.h"
+#include "modules/video_processing/main/source/denoising.h"
+#include "system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kNumFrames = 60;
+const int kFrameRate = 30;
+// The flicker repeats every third frame.
+const int kNumSourceFrames = 6;
+
+// Fills the frame with a moving gradient plus noise. The brightness is
+// modulated as if lit by a 100 Hz flicker seen at |kFrameRate|.
+void FillFrame(int frameNum, I420VideoFrame* frame)
+{
+    const int width = frame->width();
+    const int height = frame->height();
+    const double kPi = 3.14159265358979;
+    const int offset = static_cast<int>(
+        20 * sin(2 * kPi * 100 * frameNum / kFrameRate + 0.3));
+    uint8_t* buffer = frame->buffer(kYPlane);
+    for (int i = 0; i < height; i++)
+    {
+        for (int j = 0; j < width; j++)
+        {
+            int value = 40 + ((i + j + 2 * frameNum) & 127) + offset +
+                rand() % 8;
+            buffer[i * width + j] = static_cast<uint8_t>(
+                value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+    }
+}
+
+void RunBenchmark(int width, int height)
+{
+    const int halfWidth = (width + 1) / 2;
+    I420VideoFrame source[kNumSourceFrames];
+    for (int i = 0; i < kNumSourceFrames; i++)
+    {
+        ASSERT_EQ(0, source[i].CreateEmptyFrame(width, height, width,
+                                                halfWidth, halfWidth));
+    }
+    I420VideoFrame frame;
+
+    VideoProcessingModule* vpm = VideoProcessingModule::Create(0);
+    ASSERT_TRUE(vpm != NULL);
+    VPMDenoising denoiseC(false);
+    VPMDenoising denoiseOptimized(true);
+    TickInterval statsTicks;
+    TickInterval denoiseCTicks;
+    TickInterval denoiseOptimizedTicks;
+    TickInterval deflickerTicks;
+    TickInterval brightnessTicks;
+    int deflickeredFrames = 0;
+
+    srand(1234);
+    for (int frameNum = 0; frameNum < kNumFrames; frameNum++)
+    {
+        // Cycle through a few pre-generated frames to keep the noise
+        // generation out of the loop.
+        I420VideoFrame& input = source[frameNum % kNumSourceFrames];
+        if (frameNum < kNumSourceFrames)
+        {
+            FillFrame(frameNum, &input);
+        }
+        input.set_timestamp(90000 / kFrameRate * (frameNum + 1));
+
+        ASSERT_EQ(0, frame.CopyFrame(input));
+        TickTime t0 = TickTime::Now();
+        denoiseC.ProcessFrame(&frame);
+        denoiseCTicks += TickTime::Now() - t0;
+
+        ASSERT_EQ(0, frame.CopyFrame(input));
+        t0 = TickTime::Now();
+        denoiseOptimized.ProcessFrame(&frame);
+        denoiseOptimizedTicks += TickTime::Now() - t0;
+
+        ASSERT_EQ(0, frame.CopyFrame(input));
+        VideoProcessingModule::FrameStats stats;
+        t0 = TickTime::Now();
+        ASSERT_EQ(0, VideoProcessingModule::GetFrameStats(&stats, frame));
+        statsTicks += TickTime::Now() - t0;
+
+        t0 = TickTime::Now();
+        ASSERT_GE(vpm->BrightnessDetection(frame, stats), 0);
+        brightnessTicks += TickTime::Now() - t0;
+
+        t0 = TickTime::Now();
+        ASSERT_EQ(0, vpm->Deflickering(&frame, &stats));
+        deflickerTicks += TickTime::Now() - t0;
+        // The stats are cleared when the frame was altered.
+        if (!VideoProcessingModule::ValidFrameStats(stats))
+        {
+            deflickeredFrames++;
+        }
+    }
+    VideoProcessingModule::Destroy(vpm);
+
+    printf("%4dx%-4d GetFrameStats %6.3f  BrightnessDetection %6.3f  "
+           "Deflickering %6.3f (%d/%d frames)  Denoising C %6.3f  "
+           "optimized %6.3f [ms / frame]\n", width, height,
+           statsTicks.Microseconds() / 1000.0 / kNumFrames,
+           brightnessTicks.Microseconds() / 1000.0 / kNumFrames,
+           deflickerTicks.Microseconds() / 1000.0 / kNumFrames,
+           deflickeredFrames, kNumFrames,
+           denoiseCTicks.Microseconds() / 1000.0 / kNumFrames,
+           denoiseOptimizedTicks.Microseconds() / 1000.0 / kNumFrames);
+}
+
+}  // namespace
+
+TEST(VideoProcessingBenchmark, FrameSizes)
+{
+    RunBenchmark(640, 360);
+    RunBenchmark(1280, 720);
+    RunBenchmark(1920, 1080);
+}
+
+}  // namespace webrtc
@@ -29,6 +29,8 @@ namespace webrtc {
 int32_t SetRenderAndroidVM(void* javaVM);
 #endif
 
+class ProcessThread;
+
 // Class definitions
 class VideoRender: public Module
 {
@@ -244,6 +246,12 @@ public:
     virtual int32_t SetExpectedRenderDelay(uint32_t stream_id,
                                            int32_t delay_ms) = 0;
 
+    // Renders the incoming streams added after this call on |process_thread|,
+    // woken up by new frames, instead of on one thread per stream. NULL
+    // restores the default. |process_thread| must outlive those streams.
+    virtual int32_t SetIncomingStreamProcessThread(
+        ProcessThread* process_thread) = 0;
+
     virtual int32_t ConfigureRenderer(const uint32_t streamId,
                                       const unsigned int zOrder,
                                       const float left,
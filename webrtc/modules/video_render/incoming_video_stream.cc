@@ -22,6 +22,7 @@
 #endif
 
 #include "common_video/libyuv/include/webrtc_libyuv.h"
+#include "webrtc/modules/utility/interface/process_thread.h"
 #include "webrtc/modules/video_render//video_render_frames.h"
 #include "system_wrappers/interface/critical_section_wrapper.h"
 #include "system_wrappers/interface/event_wrapper.h"
@@ -41,6 +42,10 @@ IncomingVideoStream::IncomingVideoStream(const int32_t module_id,
       buffer_critsect_(*CriticalSectionWrapper::CreateCriticalSection()),
       incoming_render_thread_(),
       deliver_buffer_event_(*EventWrapper::Create()),
+      process_thread_(NULL),
+      render_module_(this),
+      next_render_time_ms_(0),
+      render_pending_(false),
       running_(false),
       external_callback_(NULL),
       render_callback_(NULL),
@@ -132,8 +137,16 @@ int32_t IncomingVideoStream::RenderFrame(const uint32_t stream_id,
 
   // Insert frame.
   CriticalSectionScoped csB(&buffer_critsect_);
-  if (render_buffers_.AddFrame(&video_frame) == 1)
-    deliver_buffer_event_.Set();
+  if (render_buffers_.AddFrame(&video_frame) == 1) {
+    if (process_thread_) {
+      // |next_render_time_ms_| may be up to KEventMaxWaitTimeMs away, so
+      // make the render module due now.
+      render_pending_ = true;
+      process_thread_->WakeUp(&render_module_);
+    } else {
+      deliver_buffer_event_.Set();
+    }
+  }
 
   return 0;
 }
@@ -198,6 +211,17 @@ int32_t IncomingVideoStream::SetExternalCallback(
   return 0;
 }
 
+int32_t IncomingVideoStream::SetProcessThread(ProcessThread* process_thread) {
+  CriticalSectionScoped cs(&stream_critsect_);
+  if (running_) {
+    WEBRTC_TRACE(kTraceError, kTraceVideoRenderer, module_id_,
+                 "%s: Already running", __FUNCTION__);
+    return -1;
+  }
+  process_thread_ = process_thread;
+  return 0;
+}
+
 int32_t IncomingVideoStream::Start() {
   CriticalSectionScoped csS(&stream_critsect_);
   WEBRTC_TRACE(kTraceInfo, kTraceVideoRenderer, module_id_,
@@ -208,6 +232,22 @@ int32_t IncomingVideoStream::Start() {
     return 0;
   }
 
+  if (process_thread_) {
+    {
+      CriticalSectionScoped csT(&thread_critsect_);
+      next_render_time_ms_ =
+          TickTime::MillisecondTimestamp() + KEventStartupTimeMS;
+    }
+    if (process_thread_->RegisterModule(&render_module_) != 0) {
+      WEBRTC_TRACE(kTraceError, kTraceVideoRenderer, module_id_,
+                   "%s: Could not register with process thread",
+                   __FUNCTION__);
+      return -1;
+    }
+    running_ = true;
+    return 0;
+  }
+
   CriticalSectionScoped csT(&thread_critsect_);
   assert(incoming_render_thread_ == NULL);
 
@@ -236,36 +276,47 @@ int32_t IncomingVideoStream::Start() {
 }
 
 int32_t IncomingVideoStream::Stop() {
-  CriticalSectionScoped cs_stream(&stream_critsect_);
-  WEBRTC_TRACE(kTraceInfo, kTraceVideoRenderer, module_id_,
-               "%s for stream %d", __FUNCTION__, stream_id_);
-
-  if (!running_) {
-    WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, module_id_,
-                 "%s: Not running", __FUNCTION__);
-    return 0;
-  }
+  ProcessThread* process_thread = NULL;
+  {
+    CriticalSectionScoped cs_stream(&stream_critsect_);
+    WEBRTC_TRACE(kTraceInfo, kTraceVideoRenderer, module_id_,
+                 "%s for stream %d", __FUNCTION__, stream_id_);
 
-  thread_critsect_.Enter();
-  if (incoming_render_thread_) {
-    ThreadWrapper* thread = incoming_render_thread_;
-    incoming_render_thread_ = NULL;
-    thread->SetNotAlive();
+    if (!running_) {
+      WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, module_id_,
+                   "%s: Not running", __FUNCTION__);
+      return 0;
+    }
+    running_ = false;
+
+    if (!process_thread_) {
+      thread_critsect_.Enter();
+      if (incoming_render_thread_) {
+        ThreadWrapper* thread = incoming_render_thread_;
+        incoming_render_thread_ = NULL;
+        thread->SetNotAlive();
 #ifndef WIN32_
-    deliver_buffer_event_.StopTimer();
+        deliver_buffer_event_.StopTimer();
 #endif
-    thread_critsect_.Leave();
-    if (thread->Stop()) {
-      delete thread;
-    } else {
-      assert(false);
-      WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, module_id_,
-                   "%s: Not able to stop thread, leaking", __FUNCTION__);
+        thread_critsect_.Leave();
+        if (thread->Stop()) {
+          delete thread;
+        } else {
+          assert(false);
+          WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, module_id_,
+                       "%s: Not able to stop thread, leaking", __FUNCTION__);
+        }
+      } else {
+        thread_critsect_.Leave();
+      }
+      return 0;
     }
-  } else {
-    thread_critsect_.Leave();
+    process_thread = process_thread_;
   }
-  running_ = false;
+  // Waits for an ongoing RenderModule::Process() call to return. This is done
+  // without |stream_critsect_| held, since a module decoding on the same
+  // thread may be waiting for it in RenderFrame().
+  process_thread->DeRegisterModule(&render_module_);
   return 0;
 }
 
@@ -292,74 +343,93 @@ bool IncomingVideoStream::IncomingVideoStreamThreadFun(void* obj) {
 
 bool IncomingVideoStream::IncomingVideoStreamProcess() {
   if (kEventError != deliver_buffer_event_.Wait(KEventMaxWaitTimeMs)) {
-    thread_critsect_.Enter();
+    CriticalSectionScoped cs(&thread_critsect_);
     if (incoming_render_thread_ == NULL) {
       // Terminating
-      thread_critsect_.Leave();
       return false;
     }
+    RenderNextFrame();
+  }
+  return true;
+}
 
-    I420VideoFrame* frame_to_render = NULL;
+int32_t IncomingVideoStream::RenderModule::TimeUntilNextProcess() {
+  CriticalSectionScoped cs(&stream_->thread_critsect_);
+  {
+    CriticalSectionScoped cs_buffer(&stream_->buffer_critsect_);
+    if (stream_->render_pending_) {
+      return 0;
+    }
+  }
+  return static_cast<int32_t>(stream_->next_render_time_ms_ -
+                              TickTime::MillisecondTimestamp());
+}
 
-    // Get a new frame to render and the time for the frame after this one.
-    buffer_critsect_.Enter();
-    frame_to_render = render_buffers_.FrameToRender();
-    uint32_t wait_time = render_buffers_.TimeToNextFrameRelease();
-    buffer_critsect_.Leave();
+int32_t IncomingVideoStream::RenderModule::Process() {
+  CriticalSectionScoped cs(&stream_->thread_critsect_);
+  stream_->RenderNextFrame();
+  return 0;
+}
 
-    // Set timer for next frame to render.
-    if (wait_time > KEventMaxWaitTimeMs) {
-      wait_time = KEventMaxWaitTimeMs;
-    }
-    deliver_buffer_event_.StartTimer(false, wait_time);
+void IncomingVideoStream::RenderNextFrame() {
+  I420VideoFrame* frame_to_render = NULL;
 
-    if (!frame_to_render) {
-      if (render_callback_) {
-        if (last_rendered_frame_.render_time_ms() == 0 &&
-            !start_image_.IsZeroSize()) {
-          // We have not rendered anything and have a start image.
-          temp_frame_.CopyFrame(start_image_);
-          render_callback_->RenderFrame(stream_id_, temp_frame_);
-        } else if (!timeout_image_.IsZeroSize() &&
-                   last_rendered_frame_.render_time_ms() + timeout_time_ <
-                       TickTime::MillisecondTimestamp()) {
-          // Render a timeout image.
-          temp_frame_.CopyFrame(timeout_image_);
-          render_callback_->RenderFrame(stream_id_, temp_frame_);
-        }
-      }
+  // Get a new frame to render and the time for the frame after this one.
+  buffer_critsect_.Enter();
+  render_pending_ = false;
+  frame_to_render = render_buffers_.FrameToRender();
+  uint32_t wait_time = render_buffers_.TimeToNextFrameRelease();
+  buffer_critsect_.Leave();
 
-      // No frame.
-      thread_critsect_.Leave();
-      return true;
-    }
+  // Set timer for next frame to render.
+  if (wait_time > KEventMaxWaitTimeMs) {
+    wait_time = KEventMaxWaitTimeMs;
+  }
+  if (process_thread_) {
+    next_render_time_ms_ = TickTime::MillisecondTimestamp() + wait_time;
+  } else {
+    deliver_buffer_event_.StartTimer(false, wait_time);
+  }
 
-    // Send frame for rendering.
-    if (external_callback_) {
-      WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
-                   "%s: executing external renderer callback to deliver frame",
-                   __FUNCTION__, frame_to_render->render_time_ms());
-      external_callback_->RenderFrame(stream_id_, *frame_to_render);
-    } else {
-      if (render_callback_) {
-        WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
-                     "%s: Render frame, time: ", __FUNCTION__,
-                     frame_to_render->render_time_ms());
-        render_callback_->RenderFrame(stream_id_, *frame_to_render);
+  if (!frame_to_render) {
+    if (render_callback_) {
+      if (last_rendered_frame_.render_time_ms() == 0 &&
+          !start_image_.IsZeroSize()) {
+        // We have not rendered anything and have a start image.
+        temp_frame_.CopyFrame(start_image_);
+        render_callback_->RenderFrame(stream_id_, temp_frame_);
+      } else if (!timeout_image_.IsZeroSize() &&
+                 last_rendered_frame_.render_time_ms() + timeout_time_ <
+                     TickTime::MillisecondTimestamp()) {
+        // Render a timeout image.
+        temp_frame_.CopyFrame(timeout_image_);
+        render_callback_->RenderFrame(stream_id_, temp_frame_);
       }
     }
 
-    // Release critsect before calling the module user.
-    thread_critsect_.Leave();
+    // No frame.
+    return;
+  }
 
-    // We're done with this frame, delete it.
-    if (frame_to_render) {
-      CriticalSectionScoped cs(&buffer_critsect_);
-      last_rendered_frame_.SwapFrame(frame_to_render);
-      render_buffers_.ReturnFrame(frame_to_render);
+  // Send frame for rendering.
+  if (external_callback_) {
+    WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
+                 "%s: executing external renderer callback to deliver frame",
+                 __FUNCTION__, frame_to_render->render_time_ms());
+    external_callback_->RenderFrame(stream_id_, *frame_to_render);
+  } else {
+    if (render_callback_) {
+      WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
+                   "%s: Render frame, time: ", __FUNCTION__,
+                   frame_to_render->render_time_ms());
+      render_callback_->RenderFrame(stream_id_, *frame_to_render);
     }
   }
-  return true;
+
+  // We're done with this frame, delete it.
+  CriticalSectionScoped cs(&buffer_critsect_);
+  last_rendered_frame_.SwapFrame(frame_to_render);
+  render_buffers_.ReturnFrame(frame_to_render);
 }
 
 int32_t IncomingVideoStream::GetLastRenderedFrame(
@@ -17,6 +17,7 @@
 namespace webrtc {
 class CriticalSectionWrapper;
 class EventWrapper;
+class ProcessThread;
 class ThreadWrapper;
 class VideoRenderCallback;
 class VideoRenderFrames;
@@ -46,6 +47,10 @@ class IncomingVideoStream : public VideoRenderCallback {
   // Callback for file recording, snapshot, ...
   int32_t SetExternalCallback(VideoRenderCallback* render_object);
 
+  // Renders on |process_thread| instead of on a thread of its own, if set
+  // before Start(). |process_thread| must outlive the stream.
+  int32_t SetProcessThread(ProcessThread* process_thread);
+
   // Start/Stop.
   int32_t Start();
   int32_t Stop();
@@ -75,6 +80,21 @@ class IncomingVideoStream : public VideoRenderCallback {
   bool IncomingVideoStreamProcess();
 
  private:
+  // Registered with |process_thread_| to render the stream on it.
+  class RenderModule : public Module {
+   public:
+    explicit RenderModule(IncomingVideoStream* stream) : stream_(stream) {}
+    virtual int32_t TimeUntilNextProcess();
+    virtual int32_t Process();
+
+   private:
+    IncomingVideoStream* const stream_;
+  };
+
+  // Renders the frame to render now, if any, and schedules the next call.
+  // Must be called with |thread_critsect_| held.
+  void RenderNextFrame();
+
   enum { KEventStartupTimeMS = 10 };
   enum { KEventMaxWaitTimeMs = 100 };
   enum { KFrameRatePeriodMs = 1000 };
@@ -87,6 +107,13 @@ class IncomingVideoStream : public VideoRenderCallback {
   CriticalSectionWrapper& buffer_critsect_;
   ThreadWrapper* incoming_render_thread_;
   EventWrapper& deliver_buffer_event_;
+  ProcessThread* process_thread_;
+  RenderModule render_module_;
+  // The time to call RenderNextFrame() when rendering on |process_thread_|.
+  int64_t next_render_time_ms_;
+  // Set by RenderFrame() when a frame is added to an empty buffer, to render
+  // on |process_thread_| right away. Protected by |buffer_critsect_|.
+  bool render_pending_;
   bool running_;
 
   VideoRenderCallback* external_callback_;
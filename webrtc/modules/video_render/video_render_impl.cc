@@ -96,7 +96,8 @@ ModuleVideoRenderImpl::ModuleVideoRenderImpl(
                                              const bool fullscreen) :
     _id(id), _moduleCrit(*CriticalSectionWrapper::CreateCriticalSection()),
     _ptrWindow(window), _fullScreen(fullscreen), _ptrRenderer(NULL),
-    _streamRenderMap(*(new MapWrapper()))
+    _streamRenderMap(*(new MapWrapper())),
+    _incomingStreamProcessThread(NULL)
 {
 
     // Create platform specific renderer
@@ -474,6 +475,7 @@ ModuleVideoRenderImpl::AddIncomingRenderStream(const uint32_t streamId,
                      "%s: Can't create incoming stream", __FUNCTION__);
         return NULL;
     }
+    ptrIncomingStream->SetProcessThread(_incomingStreamProcessThread);
 
 
     if (ptrIncomingStream->SetRenderCallback(ptrRenderCallback) == -1)
@@ -875,6 +877,13 @@ int32_t ModuleVideoRenderImpl::SetExpectedRenderDelay(
   return incoming_stream->SetExpectedRenderDelay(delay_ms);
 }
 
+int32_t ModuleVideoRenderImpl::SetIncomingStreamProcessThread(
+    ProcessThread* process_thread) {
+  CriticalSectionScoped cs(&_moduleCrit);
+  _incomingStreamProcessThread = process_thread;
+  return 0;
+}
+
 int32_t ModuleVideoRenderImpl::ConfigureRenderer(
                                                        const uint32_t streamId,
                                                        const unsigned int zOrder,
@@ -120,6 +120,9 @@ public:
     virtual int32_t SetExpectedRenderDelay(uint32_t stream_id,
                                            int32_t delay_ms);
 
+    virtual int32_t SetIncomingStreamProcessThread(
+        ProcessThread* process_thread);
+
     /**************************************************************************
      *
      *   Start/Stop
@@ -220,6 +223,7 @@ private:
 
     IVideoRender* _ptrRenderer;
     MapWrapper& _streamRenderMap;
+    ProcessThread* _incomingStreamProcessThread;
 };
 
 } //namespace webrtc
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// This singleton logs RTP and RTCP headers, bandwidth estimates, pacer state
+// and jitter buffer decisions to a binary file, for offline analysis of call
+// quality. Events are appended to a memory buffer on the calling thread and
+// written to file by a separate thread. While the log is stopped, logging an
+// event only checks a flag.
+//
+// The file format is described in system_wrappers/source/rtc_event_log_impl.h.
+// Log files can be parsed and summarized with the event_log_summary tool in
+// webrtc/tools.
+
+#ifndef WEBRTC_SYSTEM_WRAPPERS_INTERFACE_RTC_EVENT_LOG_H_
+#define WEBRTC_SYSTEM_WRAPPERS_INTERFACE_RTC_EVENT_LOG_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class RtcEventLog {
+ public:
+  enum EventType {
+    kRtpHeader = 1,
+    kRtcpPacket = 2,
+    kRemoteBitrateEstimate = 3,
+    kBitrateControllerUpdate = 4,
+    kPacerState = 5,
+    kJitterBufferEvent = 6
+  };
+
+  enum JitterBufferEvent {
+    // A frame was handed to the decoder. The value is the time in ms since
+    // its last packet arrived.
+    kFrameDecoded = 1,
+    // A complete frame arrived after a later frame was decoded and was
+    // dropped. The value is the number of consecutive late frames.
+    kLateFrameDropped = 2,
+    // A frame was dropped while looking for a key frame to decode from. The
+    // value is the total number of dropped frames.
+    kFrameDropped = 3,
+    // All frames were flushed. The value is the number of flushed frames.
+    kFlushed = 4,
+    // A key frame was requested. The value is the size of the NACK list.
+    kKeyFrameRequested = 5
+  };
+
+  // Starts logging to |file_name|, replacing any earlier file. Returns 0 on
+  // success and -1 if the file couldn't be opened.
+  static int32_t Start(const char* file_name);
+
+  // Stops logging, and returns once all events have been written to file.
+  static void Stop();
+
+  // Returns the number of events dropped since the log was started, because
+  // the file writer thread didn't keep up.
+  static uint32_t DroppedEvents();
+
+  // Logs the RTP header of |packet|. |id| is the id of the module logging it.
+  static void LogRtpHeader(int32_t id, bool incoming, const uint8_t* packet,
+                           int packet_length);
+
+  // Logs a, possibly compound, RTCP packet.
+  static void LogRtcpPacket(int32_t id, bool incoming, const uint8_t* packet,
+                            int packet_length);
+
+  // Logs an update of the receive side bandwidth estimate. |bandwidth_usage|
+  // is the BandwidthUsage state of the over-use detector.
+  static void LogRemoteBitrateEstimate(uint32_t bitrate_bps,
+                                       uint32_t incoming_bitrate_bps,
+                                       int bandwidth_usage);
+
+  // Logs a send bitrate decision of the bitrate controller.
+  static void LogBitrateControllerUpdate(uint32_t bitrate_bps,
+                                         uint8_t fraction_lost,
+                                         uint32_t rtt_ms);
+
+  // Logs the number of packets queued in the pacer and the time the oldest of
+  // them has been queued.
+  static void LogPacerState(int queued_packets, int queue_ms);
+
+  // Logs a decision of the jitter buffer about the frame with RTP timestamp
+  // |timestamp|. See JitterBufferEvent for the meaning of |value|.
+  static void LogJitterBufferEvent(int32_t id, JitterBufferEvent event,
+                                   uint32_t timestamp, int32_t value);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_SYSTEM_WRAPPERS_INTERFACE_RTC_EVENT_LOG_H_
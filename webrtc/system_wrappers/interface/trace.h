@@ -59,6 +59,12 @@ class Trace {
   static int32_t SetTraceFile(const char* file_name,
                               const bool add_file_counter = false);
 
+  // Same as SetTraceFile() but writes messages in a compact binary format,
+  // which saves the trace thread from formatting them. Such files are
+  // converted to the text format with the trace_decoder tool.
+  static int32_t SetBinaryTraceFile(const char* file_name,
+                                    const bool add_file_counter = false);
+
   // Returns the name of the file that the trace is currently writing to.
   static int32_t TraceFile(char file_name[1024]);
 
@@ -81,6 +87,10 @@ class Trace {
                   const TraceModule module,
                   const int32_t id,
                   const char* msg, ...);
+
+  // Returns the number of messages that have been dropped because they were
+  // added faster than they could be written.
+  static uint32_t DroppedMessages();
 };
 
 }  // namespace webrtc
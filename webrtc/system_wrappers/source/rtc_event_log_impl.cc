@@ -0,0 +1,344 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/rtc_event_log_impl.h"
+
+#include <string.h>
+
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+const char kRtcEventLogMagic[8] = { 'W', 'R', 'T', 'C', 'E', 'L', 'O', 'G' };
+
+namespace {
+
+// Size of each of the two event buffers. At 100 bytes per event this holds
+// the events of 100 ms at 25000 events per second.
+enum { kBufferSize = 256 * 1024 };
+// How often the file writer thread writes when nobody wakes it up.
+enum { kWriteIntervalMs = 100 };
+// Size of the fixed RTP header, and of the header of an RTP header extension.
+enum { kRtpHeaderSize = 12 };
+enum { kRtpExtensionHeaderSize = 4 };
+
+static RtcEventLogImpl* volatile log_instance = NULL;
+
+uint8_t* WriteUint16(uint8_t* buffer, uint16_t value) {
+  buffer[0] = static_cast<uint8_t>(value);
+  buffer[1] = static_cast<uint8_t>(value >> 8);
+  return buffer + 2;
+}
+
+uint8_t* WriteUint32(uint8_t* buffer, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+  return buffer + 4;
+}
+
+// Returns the log if it is started, NULL otherwise.
+RtcEventLogImpl* ActiveLog() {
+  RtcEventLogImpl* log = RtcEventLogImpl::GetInstance(false);
+  if (log == NULL || !log->active()) {
+    return NULL;
+  }
+  return log;
+}
+
+// Returns the size of the RTP header of |packet|, including CSRCs and header
+// extension, limited to |packet_length|.
+int RtpHeaderLength(const uint8_t* packet, int packet_length) {
+  if (packet_length < kRtpHeaderSize) {
+    return packet_length;
+  }
+  int header_length = kRtpHeaderSize + 4 * (packet[0] & 0x0f);
+  const bool has_extension = (packet[0] & 0x10) != 0;
+  if (has_extension &&
+      header_length + kRtpExtensionHeaderSize <= packet_length) {
+    const int extension_words = (packet[header_length + 2] << 8) |
+        packet[header_length + 3];
+    header_length += kRtpExtensionHeaderSize + 4 * extension_words;
+  }
+  return header_length < packet_length ? header_length : packet_length;
+}
+
+}  // namespace
+
+RtcEventLogImpl* RtcEventLogImpl::GetInstance(bool create) {
+  if (log_instance == NULL && create) {
+    // Allocated once and never freed, like the lock of GetStaticInstance().
+    static CriticalSectionWrapper* crit_sect(
+        CriticalSectionWrapper::CreateCriticalSection());
+    CriticalSectionScoped lock(crit_sect);
+    if (log_instance == NULL) {
+      log_instance = new RtcEventLogImpl();
+    }
+  }
+  return log_instance;
+}
+
+RtcEventLogImpl::RtcEventLogImpl()
+    : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      wake_event_(EventWrapper::Create()),
+      file_writer_thread_(NULL),
+      file_(FileWrapper::Create()),
+      active_(false),
+      buffer_(new uint8_t[kBufferSize]),
+      buffer_length_(0),
+      write_buffer_(new uint8_t[kBufferSize]),
+      dropped_events_(0) {
+}
+
+RtcEventLogImpl::~RtcEventLogImpl() {
+  Stop();
+  delete [] buffer_;
+  delete [] write_buffer_;
+}
+
+int32_t RtcEventLogImpl::Start(const char* file_name) {
+  Stop();
+  if (file_->OpenFile(file_name, false, false, false) != 0) {
+    return -1;
+  }
+  uint8_t file_header[kRtcEventLogHeaderSize];
+  memcpy(file_header, kRtcEventLogMagic, sizeof(kRtcEventLogMagic));
+  WriteUint32(&file_header[sizeof(kRtcEventLogMagic)], kRtcEventLogVersion);
+  if (!file_->Write(file_header, sizeof(file_header))) {
+    file_->CloseFile();
+    return -1;
+  }
+  {
+    CriticalSectionScoped cs(crit_.get());
+    buffer_length_ = 0;
+    dropped_events_ = 0;
+    active_ = true;
+  }
+  file_writer_thread_.reset(ThreadWrapper::CreateThread(
+      RtcEventLogImpl::Run, this, kNormalPriority, "RtcEventLog"));
+  unsigned int thread_id = 0;
+  if (!file_writer_thread_->Start(thread_id)) {
+    file_writer_thread_.reset();
+    Stop();
+    return -1;
+  }
+  return 0;
+}
+
+void RtcEventLogImpl::Stop() {
+  {
+    CriticalSectionScoped cs(crit_.get());
+    if (!active_) {
+      return;
+    }
+    active_ = false;
+  }
+  if (file_writer_thread_.get() != NULL) {
+    file_writer_thread_->SetNotAlive();
+    wake_event_->Set();
+    file_writer_thread_->Stop();
+    file_writer_thread_.reset();
+  }
+  // Write whatever was logged after the thread's last pass.
+  WriteToFile();
+  file_->Flush();
+  file_->CloseFile();
+}
+
+uint32_t RtcEventLogImpl::DroppedEvents() const {
+  CriticalSectionScoped cs(crit_.get());
+  return dropped_events_;
+}
+
+void RtcEventLogImpl::LogEvent(RtcEventLog::EventType type, uint8_t flags,
+                               int32_t id, const uint8_t* payload,
+                               int payload_length) {
+  if (payload_length > kRtcEventMaxPayloadSize) {
+    payload_length = kRtcEventMaxPayloadSize;
+  }
+  RtcEventHeader header;
+  header.size = static_cast<uint16_t>(kRtcEventHeaderSize + payload_length);
+  header.type = static_cast<uint8_t>(type);
+  header.flags = flags;
+  header.id = id;
+  header.time_us = TickTime::MicrosecondTimestamp();
+
+  bool half_full = false;
+  {
+    CriticalSectionScoped cs(crit_.get());
+    if (!active_) {
+      return;
+    }
+    if (buffer_length_ + header.size > kBufferSize) {
+      ++dropped_events_;
+      return;
+    }
+    WriteEventHeader(header, &buffer_[buffer_length_]);
+    memcpy(&buffer_[buffer_length_ + kRtcEventHeaderSize], payload,
+           payload_length);
+    half_full = buffer_length_ < kBufferSize / 2 &&
+        buffer_length_ + header.size >= kBufferSize / 2;
+    buffer_length_ += header.size;
+  }
+  if (half_full) {
+    // Don't wait for the next interval, to not run out of buffer space.
+    wake_event_->Set();
+  }
+}
+
+void RtcEventLogImpl::WriteEventHeader(const RtcEventHeader& header,
+                                       uint8_t buffer[kRtcEventHeaderSize]) {
+  const uint64_t time_us = static_cast<uint64_t>(header.time_us);
+  WriteUint16(&buffer[0], header.size);
+  buffer[2] = header.type;
+  buffer[3] = header.flags;
+  WriteUint32(&buffer[4], static_cast<uint32_t>(header.id));
+  WriteUint32(&buffer[8], static_cast<uint32_t>(time_us));
+  WriteUint32(&buffer[12], static_cast<uint32_t>(time_us >> 32));
+}
+
+void RtcEventLogImpl::ReadEventHeader(const uint8_t buffer[kRtcEventHeaderSize],
+                                      RtcEventHeader* header) {
+  uint32_t id = 0;
+  uint64_t time_us = 0;
+  for (int i = 3; i >= 0; --i) {
+    id = (id << 8) | buffer[4 + i];
+  }
+  for (int i = 7; i >= 0; --i) {
+    time_us = (time_us << 8) | buffer[8 + i];
+  }
+  header->size = static_cast<uint16_t>(buffer[0] | (buffer[1] << 8));
+  header->type = buffer[2];
+  header->flags = buffer[3];
+  header->id = static_cast<int32_t>(id);
+  header->time_us = static_cast<int64_t>(time_us);
+}
+
+bool RtcEventLogImpl::Run(void* obj) {
+  return static_cast<RtcEventLogImpl*>(obj)->Process();
+}
+
+bool RtcEventLogImpl::Process() {
+  wake_event_->Wait(kWriteIntervalMs);
+  WriteToFile();
+  return true;
+}
+
+void RtcEventLogImpl::WriteToFile() {
+  int length = 0;
+  {
+    CriticalSectionScoped cs(crit_.get());
+    uint8_t* buffer = buffer_;
+    buffer_ = write_buffer_;
+    write_buffer_ = buffer;
+    length = buffer_length_;
+    buffer_length_ = 0;
+  }
+  if (length > 0) {
+    file_->Write(write_buffer_, length);
+  }
+}
+
+int32_t RtcEventLog::Start(const char* file_name) {
+  return RtcEventLogImpl::GetInstance(true)->Start(file_name);
+}
+
+void RtcEventLog::Stop() {
+  RtcEventLogImpl* log = RtcEventLogImpl::GetInstance(false);
+  if (log != NULL) {
+    log->Stop();
+  }
+}
+
+uint32_t RtcEventLog::DroppedEvents() {
+  RtcEventLogImpl* log = RtcEventLogImpl::GetInstance(false);
+  return log != NULL ? log->DroppedEvents() : 0;
+}
+
+void RtcEventLog::LogRtpHeader(int32_t id, bool incoming, const uint8_t* packet,
+                               int packet_length) {
+  RtcEventLogImpl* log = ActiveLog();
+  if (log == NULL || packet == NULL) {
+    return;
+  }
+  uint8_t payload[kRtcEventMaxPayloadSize];
+  int header_length = RtpHeaderLength(packet, packet_length);
+  if (header_length > kRtcEventMaxPayloadSize - 2) {
+    header_length = kRtcEventMaxPayloadSize - 2;
+  }
+  WriteUint16(payload, static_cast<uint16_t>(packet_length));
+  memcpy(&payload[2], packet, header_length);
+  log->LogEvent(kRtpHeader, incoming ? kRtcEventIncoming : 0, id, payload,
+                2 + header_length);
+}
+
+void RtcEventLog::LogRtcpPacket(int32_t id, bool incoming,
+                                const uint8_t* packet, int packet_length) {
+  RtcEventLogImpl* log = ActiveLog();
+  if (log == NULL || packet == NULL) {
+    return;
+  }
+  log->LogEvent(kRtcpPacket, incoming ? kRtcEventIncoming : 0, id, packet,
+                packet_length);
+}
+
+void RtcEventLog::LogRemoteBitrateEstimate(uint32_t bitrate_bps,
+                                           uint32_t incoming_bitrate_bps,
+                                           int bandwidth_usage) {
+  RtcEventLogImpl* log = ActiveLog();
+  if (log == NULL) {
+    return;
+  }
+  uint8_t payload[9];
+  uint8_t* ptr = WriteUint32(payload, bitrate_bps);
+  ptr = WriteUint32(ptr, incoming_bitrate_bps);
+  *ptr = static_cast<uint8_t>(bandwidth_usage);
+  log->LogEvent(kRemoteBitrateEstimate, 0, -1, payload, sizeof(payload));
+}
+
+void RtcEventLog::LogBitrateControllerUpdate(uint32_t bitrate_bps,
+                                             uint8_t fraction_lost,
+                                             uint32_t rtt_ms) {
+  RtcEventLogImpl* log = ActiveLog();
+  if (log == NULL) {
+    return;
+  }
+  uint8_t payload[9];
+  uint8_t* ptr = WriteUint32(payload, bitrate_bps);
+  ptr = WriteUint32(ptr, rtt_ms);
+  *ptr = fraction_lost;
+  log->LogEvent(kBitrateControllerUpdate, 0, -1, payload, sizeof(payload));
+}
+
+void RtcEventLog::LogPacerState(int queued_packets, int queue_ms) {
+  RtcEventLogImpl* log = ActiveLog();
+  if (log == NULL) {
+    return;
+  }
+  uint8_t payload[8];
+  uint8_t* ptr = WriteUint32(payload, static_cast<uint32_t>(queued_packets));
+  WriteUint32(ptr, static_cast<uint32_t>(queue_ms));
+  log->LogEvent(kPacerState, 0, -1, payload, sizeof(payload));
+}
+
+void RtcEventLog::LogJitterBufferEvent(int32_t id, JitterBufferEvent event,
+                                       uint32_t timestamp, int32_t value) {
+  RtcEventLogImpl* log = ActiveLog();
+  if (log == NULL) {
+    return;
+  }
+  uint8_t payload[9];
+  payload[0] = static_cast<uint8_t>(event);
+  uint8_t* ptr = WriteUint32(&payload[1], timestamp);
+  WriteUint32(ptr, static_cast<uint32_t>(value));
+  log->LogEvent(kJitterBufferEvent, 0, id, payload, sizeof(payload));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_RTC_EVENT_LOG_IMPL_H_
+#define WEBRTC_SYSTEM_WRAPPERS_SOURCE_RTC_EVENT_LOG_IMPL_H_
+
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/file_wrapper.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+
+// Event log files start with kRtcEventLogMagic followed by a little endian
+// uint32_t version, followed by the events. Each event starts with a
+// kRtcEventHeaderSize byte little endian header:
+//   uint16_t size, of the event including the header,
+//   uint8_t type, an RtcEventLog::EventType,
+//   uint8_t flags, kRtcEventIncoming for received packets,
+//   int32_t id, of the module which logged the event or -1,
+//   int64_t time_us, TickTime::MicrosecondTimestamp() of the event,
+// followed by a little endian payload depending on the type:
+//   kRtpHeader: uint16_t packet_length, the RTP header.
+//   kRtcpPacket: the RTCP packet.
+//   kRemoteBitrateEstimate: uint32_t bitrate_bps,
+//       uint32_t incoming_bitrate_bps, uint8_t bandwidth_usage.
+//   kBitrateControllerUpdate: uint32_t bitrate_bps, uint32_t rtt_ms,
+//       uint8_t fraction_lost.
+//   kPacerState: uint32_t queued_packets, uint32_t queue_ms.
+//   kJitterBufferEvent: uint8_t event, uint32_t timestamp, int32_t value.
+// Readers should skip events of unknown types, and payload bytes beyond the
+// ones they know of.
+extern const char kRtcEventLogMagic[8];
+enum { kRtcEventLogVersion = 1 };
+enum { kRtcEventLogHeaderSize = 12 };
+enum { kRtcEventHeaderSize = 16 };
+enum { kRtcEventIncoming = 0x01 };
+// Payloads larger than this are truncated.
+enum { kRtcEventMaxPayloadSize = 1500 };
+
+struct RtcEventHeader {
+  uint16_t size;
+  uint8_t type;
+  uint8_t flags;
+  int32_t id;
+  int64_t time_us;
+};
+
+class RtcEventLogImpl {
+ public:
+  // Returns the log instance, creating it if |create| is set. Once created,
+  // the instance lives until the process exits, so that it is safe to log
+  // events while another thread stops the log.
+  static RtcEventLogImpl* GetInstance(bool create);
+
+  ~RtcEventLogImpl();
+
+  int32_t Start(const char* file_name);
+  void Stop();
+  uint32_t DroppedEvents() const;
+
+  // May be stale, but is cheap enough to check before every event.
+  bool active() const { return active_; }
+
+  // Appends an event with |payload_length| bytes of payload to the buffer.
+  // Does nothing if the log isn't started.
+  void LogEvent(RtcEventLog::EventType type, uint8_t flags, int32_t id,
+                const uint8_t* payload, int payload_length);
+
+  static void WriteEventHeader(const RtcEventHeader& header,
+                               uint8_t buffer[kRtcEventHeaderSize]);
+  static void ReadEventHeader(const uint8_t buffer[kRtcEventHeaderSize],
+                              RtcEventHeader* header);
+
+ private:
+  RtcEventLogImpl();
+
+  static bool Run(void* obj);
+  bool Process();
+  // Writes the events buffered so far to file. Only called on the file
+  // writer thread, or once it has been stopped.
+  void WriteToFile();
+
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  scoped_ptr<EventWrapper> wake_event_;
+  scoped_ptr<ThreadWrapper> file_writer_thread_;
+  scoped_ptr<FileWrapper> file_;
+  // Set while started. Read without |crit_| as a hint, to make logging cheap
+  // while stopped.
+  volatile bool active_;
+  // Events are appended to |buffer_| under |crit_|. The file writer thread
+  // swaps it for |write_buffer_| and writes it to file without the lock.
+  uint8_t* buffer_;
+  int buffer_length_;
+  uint8_t* write_buffer_;
+  uint32_t dropped_events_;
+
+  DISALLOW_COPY_AND_ASSIGN(RtcEventLogImpl);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_SYSTEM_WRAPPERS_SOURCE_RTC_EVENT_LOG_IMPL_H_
@@ -0,0 +1,217 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/system_wrappers/source/rtc_event_log_impl.h"
+#include "webrtc/test/testsupport/fileutils.h"
+
+namespace webrtc {
+namespace {
+
+struct Event {
+  RtcEventHeader header;
+  std::vector<uint8_t> payload;
+};
+
+// Reads all events of the log file |file_name|.
+bool ReadLog(const std::string& file_name, std::vector<Event>* events) {
+  FILE* file = fopen(file_name.c_str(), "rb");
+  if (file == NULL) {
+    return false;
+  }
+  uint8_t file_header[kRtcEventLogHeaderSize];
+  if (fread(file_header, 1, sizeof(file_header), file) !=
+      sizeof(file_header) ||
+      memcmp(kRtcEventLogMagic, file_header, sizeof(kRtcEventLogMagic)) != 0 ||
+      file_header[8] != kRtcEventLogVersion) {
+    fclose(file);
+    return false;
+  }
+  uint8_t header[kRtcEventHeaderSize];
+  while (fread(header, 1, sizeof(header), file) == sizeof(header)) {
+    Event event;
+    RtcEventLogImpl::ReadEventHeader(header, &event.header);
+    event.payload.resize(event.header.size - kRtcEventHeaderSize);
+    if (!event.payload.empty() &&
+        fread(&event.payload[0], 1, event.payload.size(), file) !=
+        event.payload.size()) {
+      fclose(file);
+      return false;
+    }
+    events->push_back(event);
+  }
+  fclose(file);
+  return true;
+}
+
+uint32_t ReadUint32(const uint8_t* buffer) {
+  return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) |
+      (static_cast<uint32_t>(buffer[3]) << 24);
+}
+
+class RtcEventLogTest : public ::testing::Test {
+ protected:
+  RtcEventLogTest()
+      : file_name_(test::OutputPath() + "rtc_event_log_test.log") {
+  }
+
+  virtual void TearDown() {
+    RtcEventLog::Stop();
+    remove(file_name_.c_str());
+  }
+
+  const std::string file_name_;
+};
+
+TEST_F(RtcEventLogTest, EventHeaderRoundTrip) {
+  RtcEventHeader header;
+  header.size = 0x1234;
+  header.type = RtcEventLog::kPacerState;
+  header.flags = kRtcEventIncoming;
+  header.id = -1;
+  header.time_us = 0x0123456789abcdefLL;
+  uint8_t buffer[kRtcEventHeaderSize];
+  RtcEventLogImpl::WriteEventHeader(header, buffer);
+  RtcEventHeader decoded;
+  RtcEventLogImpl::ReadEventHeader(buffer, &decoded);
+  EXPECT_EQ(header.size, decoded.size);
+  EXPECT_EQ(header.type, decoded.type);
+  EXPECT_EQ(header.flags, decoded.flags);
+  EXPECT_EQ(header.id, decoded.id);
+  EXPECT_EQ(header.time_us, decoded.time_us);
+}
+
+TEST_F(RtcEventLogTest, LogsEventsOfAllTypes) {
+  // RTP header with one CSRC and a one word header extension, followed by 4
+  // bytes of payload which shouldn't be logged.
+  const uint8_t kRtpPacket[] = {
+    0x91, 0x60, 0x12, 0x34, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03,
+    0xbe, 0xde, 0x00, 0x01, 0x10, 0xff, 0x00, 0x00,
+    0xaa, 0xbb, 0xcc, 0xdd };
+  const uint8_t kRtcpPacket[] = {
+    0x80, 0xc9, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02 };
+
+  // Nothing is logged before the log is started.
+  RtcEventLog::LogPacerState(1, 2);
+  ASSERT_EQ(0, RtcEventLog::Start(file_name_.c_str()));
+  const int64_t start_us = TickTime::MicrosecondTimestamp();
+  RtcEventLog::LogRtpHeader(7, false, kRtpPacket, sizeof(kRtpPacket));
+  RtcEventLog::LogRtcpPacket(7, true, kRtcpPacket, sizeof(kRtcpPacket));
+  RtcEventLog::LogRemoteBitrateEstimate(500000, 600000, 1);
+  RtcEventLog::LogBitrateControllerUpdate(300000, 25, 120);
+  RtcEventLog::LogPacerState(17, 42);
+  RtcEventLog::LogJitterBufferEvent(8, RtcEventLog::kFrameDecoded, 90000, 12);
+  RtcEventLog::Stop();
+  // Nor after it is stopped.
+  RtcEventLog::LogPacerState(1, 2);
+  EXPECT_EQ(0u, RtcEventLog::DroppedEvents());
+
+  std::vector<Event> events;
+  ASSERT_TRUE(ReadLog(file_name_, &events));
+  ASSERT_EQ(6u, events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_GE(events[i].header.time_us, start_us);
+  }
+
+  EXPECT_EQ(RtcEventLog::kRtpHeader, events[0].header.type);
+  EXPECT_EQ(0, events[0].header.flags);
+  EXPECT_EQ(7, events[0].header.id);
+  ASSERT_EQ(2 + sizeof(kRtpPacket) - 4, events[0].payload.size());
+  EXPECT_EQ(sizeof(kRtpPacket), events[0].payload[0]);
+  EXPECT_EQ(0, memcmp(kRtpPacket, &events[0].payload[2],
+                      sizeof(kRtpPacket) - 4));
+
+  EXPECT_EQ(RtcEventLog::kRtcpPacket, events[1].header.type);
+  EXPECT_EQ(kRtcEventIncoming, events[1].header.flags);
+  ASSERT_EQ(sizeof(kRtcpPacket), events[1].payload.size());
+  EXPECT_EQ(0, memcmp(kRtcpPacket, &events[1].payload[0],
+                      sizeof(kRtcpPacket)));
+
+  EXPECT_EQ(RtcEventLog::kRemoteBitrateEstimate, events[2].header.type);
+  ASSERT_EQ(9u, events[2].payload.size());
+  EXPECT_EQ(500000u, ReadUint32(&events[2].payload[0]));
+  EXPECT_EQ(600000u, ReadUint32(&events[2].payload[4]));
+  EXPECT_EQ(1, events[2].payload[8]);
+
+  EXPECT_EQ(RtcEventLog::kBitrateControllerUpdate, events[3].header.type);
+  ASSERT_EQ(9u, events[3].payload.size());
+  EXPECT_EQ(300000u, ReadUint32(&events[3].payload[0]));
+  EXPECT_EQ(120u, ReadUint32(&events[3].payload[4]));
+  EXPECT_EQ(25, events[3].payload[8]);
+
+  EXPECT_EQ(RtcEventLog::kPacerState, events[4].header.type);
+  EXPECT_EQ(-1, events[4].header.id);
+  ASSERT_EQ(8u, events[4].payload.size());
+  EXPECT_EQ(17u, ReadUint32(&events[4].payload[0]));
+  EXPECT_EQ(42u, ReadUint32(&events[4].payload[4]));
+
+  EXPECT_EQ(RtcEventLog::kJitterBufferEvent, events[5].header.type);
+  EXPECT_EQ(8, events[5].header.id);
+  ASSERT_EQ(9u, events[5].payload.size());
+  EXPECT_EQ(RtcEventLog::kFrameDecoded, events[5].payload[0]);
+  EXPECT_EQ(90000u, ReadUint32(&events[5].payload[1]));
+  EXPECT_EQ(12u, ReadUint32(&events[5].payload[5]));
+}
+
+TEST_F(RtcEventLogTest, RestartReplacesFile) {
+  ASSERT_EQ(0, RtcEventLog::Start(file_name_.c_str()));
+  RtcEventLog::LogPacerState(1, 2);
+  RtcEventLog::LogPacerState(3, 4);
+  ASSERT_EQ(0, RtcEventLog::Start(file_name_.c_str()));
+  RtcEventLog::LogPacerState(5, 6);
+  RtcEventLog::Stop();
+
+  std::vector<Event> events;
+  ASSERT_TRUE(ReadLog(file_name_, &events));
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(5u, ReadUint32(&events[0].payload[0]));
+}
+
+// Measures the cost of logging an RTP header on the calling thread, with the
+// log started and stopped.
+TEST_F(RtcEventLogTest, DISABLED_LogRtpHeaderBenchmark) {
+  const int kNumEvents = 200000;
+  uint8_t packet[1200];
+  memset(packet, 0, sizeof(packet));
+  packet[0] = 0x80;
+  double ns_per_event[2];
+  for (int started = 0; started < 2; ++started) {
+    if (started) {
+      ASSERT_EQ(0, RtcEventLog::Start(file_name_.c_str()));
+    }
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    for (int i = 0; i < kNumEvents; ++i) {
+      packet[2] = static_cast<uint8_t>(i >> 8);
+      packet[3] = static_cast<uint8_t>(i);
+      RtcEventLog::LogRtpHeader(0, true, packet, sizeof(packet));
+    }
+    ns_per_event[started] = 1000.0 *
+        (TickTime::MicrosecondTimestamp() - start_us) / kNumEvents;
+    RtcEventLog::Stop();
+  }
+  // A video call sends and receives in the order of 1000 packets per second
+  // in each direction.
+  printf("%.1f ns/event stopped, %.1f ns/event started, %.3f%% CPU at 2000 "
+         "events/s, %u events dropped\n", ns_per_event[0], ns_per_event[1],
+         ns_per_event[1] * 2000 / 1e7, RtcEventLog::DroppedEvents());
+}
+
+}  // namespace
+}  // namespace webrtc
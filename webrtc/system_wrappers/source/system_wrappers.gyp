@@ -41,6 +41,7 @@
         '../interface/logging.h',
         '../interface/map_wrapper.h',
         '../interface/ref_count.h',
+        '../interface/rtc_event_log.h',
         '../interface/rw_lock_wrapper.h',
         '../interface/scoped_ptr.h',
         '../interface/scoped_refptr.h',
@@ -86,6 +87,8 @@
         'logging.cc',
         'logging_no_op.cc',
         'map.cc',
+        'rtc_event_log_impl.cc',
+        'rtc_event_log_impl.h',
         'rw_lock.cc',
         'rw_lock_generic.cc',
         'rw_lock_generic.h',
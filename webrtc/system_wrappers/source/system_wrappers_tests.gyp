@@ -31,9 +31,11 @@
         'data_log_helpers_unittest.cc',
         'data_log_c_helpers_unittest.c',
         'data_log_c_helpers_unittest.h',
+        'rtc_event_log_unittest.cc',
         'stringize_macros_unittest.cc',
         'thread_unittest.cc',
         'thread_posix_unittest.cc',
+        'trace_impl_unittest.cc',
         'unittest_utilities_unittest.cc',
       ],
       'conditions': [
@@ -45,6 +47,9 @@
         ['os_posix==0', {
           'sources!': [ 'thread_posix_unittest.cc', ],
         }],
+        ['enable_tracing==0', {
+          'sources!': [ 'trace_impl_unittest.cc', ],
+        }],
       ],
       # Disable warnings to enable Win64 build, issue 1323.
       'msvs_disabled_warnings': [
@@ -10,10 +10,12 @@
 
 #include "webrtc/system_wrappers/source/trace_impl.h"
 
+#include <algorithm>
 #include <cassert>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef _WIN32
 #include "webrtc/system_wrappers/source/trace_win.h"
@@ -22,6 +24,7 @@
 #endif  // _WIN32
 
 #include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 #define KEY_LEN_CHARS 31
 
@@ -37,6 +40,95 @@ const int Trace::kTimestampLength = 12;
 
 static uint32_t level_filter = kTraceDefault;
 
+const char kTraceFileMagic[8] = { 'W', 'R', 'T', 'C', 'T', 'R', 'C', 'E' };
+
+enum { kRingSize = WEBRTC_TRACE_RING_SIZE };
+// TraceRecord::message_length of the filler written when a record does not
+// fit before the end of the ring.
+enum { kPaddingRecord = 0xffff };
+// How often the trace thread drains the rings when nobody wakes it up.
+enum { kWriteIntervalMs = 100 };
+// A ring is handed back once its thread has not traced for this long.
+enum { kRingIdleTimeMs = 5000 };
+
+TraceRing::TraceRing()
+    : owner_(0),
+      busy_(0),
+      dropped_(0),
+      buffer_(new char[kRingSize]),
+      write_pos_(0),
+      read_pos_(0),
+      cached_read_pos_(0) {
+}
+
+TraceRing::~TraceRing() {
+  delete [] buffer_;
+}
+
+bool TraceRing::Write(const TraceRecord& record, const char* message,
+                      bool* half_full) {
+  const uint32_t size =
+      (sizeof(TraceRecord) + record.message_length + 7) & ~7u;
+  // Only the producer updates |write_pos_|.
+  const uint32_t write_pos = static_cast<uint32_t>(write_pos_.Value());
+  uint32_t offset = write_pos & (kRingSize - 1);
+  const uint32_t tail = kRingSize - offset;
+  // Records never wrap; skip to the start of the ring if this one does not
+  // fit before the end.
+  const uint32_t needed = (tail < size) ? tail + size : size;
+  if (write_pos - cached_read_pos_ + needed > kRingSize) {
+    // Atomic32 has no load with acquire semantics, adding zero is a full
+    // barrier.
+    cached_read_pos_ = static_cast<uint32_t>(read_pos_ += 0);
+    if (write_pos - cached_read_pos_ + needed > kRingSize) {
+      ++dropped_;
+      return false;
+    }
+  }
+  if (tail < size) {
+    // There is always room for the first two fields since all records are a
+    // multiple of 8 bytes.
+    TraceRecord* padding = reinterpret_cast<TraceRecord*>(buffer_ + offset);
+    padding->size = static_cast<uint16_t>(tail);
+    padding->message_length = kPaddingRecord;
+    offset = 0;
+  }
+  TraceRecord* stored = reinterpret_cast<TraceRecord*>(buffer_ + offset);
+  *stored = record;
+  stored->size = static_cast<uint16_t>(size);
+  memcpy(stored + 1, message, record.message_length);
+
+  const uint32_t fill = write_pos - cached_read_pos_;
+  // Publish the record to the consumer.
+  write_pos_ += needed;
+  *half_full = fill < kRingSize / 2 && fill + needed >= kRingSize / 2;
+  return true;
+}
+
+uint32_t TraceRing::Peek(std::vector<const TraceRecord*>* records) {
+  const uint32_t write_pos = static_cast<uint32_t>(write_pos_ += 0);
+  // Only the consumer updates |read_pos_|.
+  uint32_t pos = static_cast<uint32_t>(read_pos_.Value());
+  while (pos != write_pos) {
+    const TraceRecord* record = reinterpret_cast<const TraceRecord*>(
+        buffer_ + (pos & (kRingSize - 1)));
+    if (record->message_length != kPaddingRecord) {
+      records->push_back(record);
+    }
+    pos += record->size;
+  }
+  return write_pos;
+}
+
+void TraceRing::Consume(uint32_t position) {
+  read_pos_ += static_cast<int32_t>(
+      position - static_cast<uint32_t>(read_pos_.Value()));
+}
+
+static bool RecordTimeLess(const TraceRecord* a, const TraceRecord* b) {
+  return a->time_us < b->time_us;
+}
+
 // Construct On First Use idiom. Avoids "static initialization order fiasco".
 TraceImpl* TraceImpl::StaticInstance(CountOperation count_operation,
                                      const TraceLevel level) {
@@ -70,28 +162,23 @@ TraceImpl::TraceImpl()
       callback_(NULL),
       row_count_text_(0),
       file_count_text_(0),
+      binary_file_(false),
       trace_file_(*FileWrapper::Create()),
       thread_(*ThreadWrapper::CreateThread(TraceImpl::Run, this,
                                            kHighestPriority, "Trace")),
       event_(*EventWrapper::Create()),
-      critsect_array_(CriticalSectionWrapper::CreateCriticalSection()),
-      next_free_idx_(),
-      level_(),
-      length_(),
-      message_queue_(),
-      active_queue_(0) {
-  next_free_idx_[0] = 0;
-  next_free_idx_[1] = 0;
+      critsect_overflow_(CriticalSectionWrapper::CreateCriticalSection()),
+      dropped_messages_(0),
+      prev_api_time_ms_(0),
+      prev_time_ms_(0) {
+  for (int n = 0; n < WEBRTC_TRACE_NUM_RINGS; ++n) {
+    last_write_pos_[n] = 0;
+    last_owner_[n] = 0;
+    last_active_ms_[n] = 0;
+  }
 
   unsigned int tid = 0;
   thread_.Start(tid);
-
-  for (int m = 0; m < WEBRTC_TRACE_NUM_ARRAY; ++m) {
-    for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE; ++n) {
-      message_queue_[m][n] = new
-      char[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
-    }
-  }
 }
 
 bool TraceImpl::StopThread() {
@@ -110,6 +197,9 @@ bool TraceImpl::StopThread() {
   event_.Set();
   bool stopped = thread_.Stop();
 
+  // Write whatever was traced after the thread's last pass.
+  WriteToFile();
+
   CriticalSectionScoped lock(critsect_interface_);
   trace_file_.Flush();
   trace_file_.CloseFile();
@@ -122,22 +212,50 @@ TraceImpl::~TraceImpl() {
   delete &trace_file_;
   delete &thread_;
   delete critsect_interface_;
-  delete critsect_array_;
-
-  for (int m = 0; m < WEBRTC_TRACE_NUM_ARRAY; ++m) {
-    for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE; ++n) {
-      delete [] message_queue_[m][n];
-    }
-  }
+  delete critsect_overflow_;
 }
 
-int32_t TraceImpl::AddThreadId(char* trace_message) const {
-  uint32_t thread_id = ThreadWrapper::GetThreadId();
+int32_t TraceImpl::AddThreadId(char* trace_message, const uint32_t thread_id) {
   // Messages is 12 characters.
   return sprintf(trace_message, "%10u; ", thread_id);
 }
 
-int32_t TraceImpl::AddLevel(char* sz_message, const TraceLevel level) const {
+int32_t TraceImpl::AddTime(char* trace_message, const int64_t time_us,
+                           uint32_t* prev_time_ms) {
+  const time_t seconds = static_cast<time_t>(time_us / 1000000);
+  struct tm local_time;
+#ifdef _WIN32
+  if (localtime_s(&local_time, &seconds) != 0) {
+    return -1;
+  }
+#else
+  if (localtime_r(&seconds, &local_time) == NULL) {
+    return -1;
+  }
+#endif  // _WIN32
+
+  const uint32_t time_ms = static_cast<uint32_t>(time_us / 1000);
+  uint32_t delta_ms = time_ms - *prev_time_ms;
+  if (*prev_time_ms == 0) {
+    delta_ms = 0;
+  }
+  *prev_time_ms = time_ms;
+  if (delta_ms > 0x0fffffff) {
+    // Wraparound or records that are not in time order.
+    delta_ms = 0;
+  }
+  if (delta_ms > 99999) {
+    delta_ms = 99999;
+  }
+
+  sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", local_time.tm_hour,
+          local_time.tm_min, local_time.tm_sec, time_ms % 1000,
+          static_cast<unsigned long>(delta_ms));
+  // Messages are 22 characters.
+  return 22;
+}
+
+int32_t TraceImpl::AddLevel(char* sz_message, const TraceLevel level) {
   const int kMessageLength = 12;
   switch (level) {
     case kTraceTerseInfo:
@@ -188,7 +306,7 @@ int32_t TraceImpl::AddLevel(char* sz_message, const TraceLevel level) const {
 
 int32_t TraceImpl::AddModuleAndId(char* trace_message,
                                   const TraceModule module,
-                                  const int32_t id) const {
+                                  const int32_t id) {
   // Use long int to prevent problems with different definitions of
   // int32_t.
   // TODO(hellner): is this actually a problem? If so, it should be better to
@@ -339,11 +457,13 @@ int32_t TraceImpl::AddModuleAndId(char* trace_message,
 }
 
 int32_t TraceImpl::SetTraceFileImpl(const char* file_name_utf8,
-                                    const bool add_file_counter) {
+                                    const bool add_file_counter,
+                                    const bool binary) {
   CriticalSectionScoped lock(critsect_interface_);
 
   trace_file_.Flush();
   trace_file_.CloseFile();
+  binary_file_ = binary;
 
   if (file_name_utf8) {
     if (add_file_counter) {
@@ -353,12 +473,13 @@ int32_t TraceImpl::SetTraceFileImpl(const char* file_name_utf8,
       CreateFileName(file_name_utf8, file_name_with_counter_utf8,
                      file_count_text_);
       if (trace_file_.OpenFile(file_name_with_counter_utf8, false, false,
-                               true) == -1) {
+                               !binary_file_) == -1) {
         return -1;
       }
     } else {
       file_count_text_ = 0;
-      if (trace_file_.OpenFile(file_name_utf8, false, false, true) == -1) {
+      if (trace_file_.OpenFile(file_name_utf8, false, false,
+                               !binary_file_) == -1) {
         return -1;
       }
     }
@@ -381,81 +502,88 @@ int32_t TraceImpl::SetTraceCallbackImpl(TraceCallback* callback) {
 
 int32_t TraceImpl::AddMessage(
     char* trace_message,
-    const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
+    const char* msg,
+    const uint16_t msg_length,
     const uint16_t written_so_far) const {
-  int length = 0;
   if (written_so_far >= WEBRTC_TRACE_MAX_MESSAGE_SIZE) {
     return -1;
   }
   // - 2 to leave room for newline and NULL termination.
-#ifdef _WIN32
-  length = _snprintf(trace_message,
-                     WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2,
-                     "%s", msg);
-  if (length < 0) {
-    length = WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2;
-    trace_message[length] = 0;
-  }
-#else
-  length = snprintf(trace_message,
-                    WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2,
-                    "%s", msg);
-  if (length < 0 ||
-      length > WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2) {
-    length = WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2;
-    trace_message[length] = 0;
-  }
-#endif
+  int length = std::min<int>(
+      msg_length, WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2);
+  memcpy(trace_message, msg, length);
+  trace_message[length] = 0;
   // Length with NULL termination.
   return length + 1;
 }
 
-void TraceImpl::AddMessageToList(
-    const char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-    const uint16_t length,
-    const TraceLevel level) {
-  CriticalSectionScoped lock(critsect_array_);
-
-  if (next_free_idx_[active_queue_] >= WEBRTC_TRACE_MAX_QUEUE) {
-    if (!trace_file_.Open() && !callback_) {
-      // Keep at least the last 1/4 of old messages when not logging.
-      // TODO(hellner): isn't this redundant. The user will make it known
-      //                when to start logging. Why keep messages before
-      //                that?
-      for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE / 4; ++n) {
-        const int last_quarter_offset = (3 * WEBRTC_TRACE_MAX_QUEUE / 4);
-        memcpy(message_queue_[active_queue_][n],
-               message_queue_[active_queue_][n + last_quarter_offset],
-               WEBRTC_TRACE_MAX_MESSAGE_SIZE);
+TraceRing* TraceImpl::AcquireRing(const uint32_t thread_id) {
+  if (thread_id == 0) {
+    return NULL;
+  }
+  const int32_t owner = static_cast<int32_t>(thread_id);
+  const int start = ((thread_id * 2654435761u) >> 16) % WEBRTC_TRACE_NUM_RINGS;
+  int free_index = -1;
+  for (int n = 0; n < WEBRTC_TRACE_NUM_RINGS; ++n) {
+    const int index = (start + n) % WEBRTC_TRACE_NUM_RINGS;
+    TraceRing* ring = &rings_[index];
+    const int32_t ring_owner = ring->owner_.Value();
+    if (ring_owner == owner) {
+      if (!ring->busy_.CompareExchange(1, 0)) {
+        // The trace thread is releasing the ring.
+        return NULL;
       }
-      next_free_idx_[active_queue_] = WEBRTC_TRACE_MAX_QUEUE / 4;
-    } else {
-      // More messages are being written than there is room for in the
-      // buffer. Drop any new messages.
-      // TODO(hellner): its probably better to drop old messages instead
-      //                of new ones. One step further: if this happens
-      //                it's due to writing faster than what can be
-      //                processed. Maybe modify the filter at this point.
-      //                E.g. turn of STREAM.
-      return;
+      if (ring->owner_.Value() == owner) {
+        return ring;
+      }
+      ring->busy_.CompareExchange(0, 1);
+      return NULL;
+    }
+    if (ring_owner == 0 && free_index == -1) {
+      free_index = index;
     }
   }
+  if (free_index == -1) {
+    return NULL;
+  }
+  for (int n = 0; n < WEBRTC_TRACE_NUM_RINGS; ++n) {
+    TraceRing* ring = &rings_[(free_index + n) % WEBRTC_TRACE_NUM_RINGS];
+    if (ring->owner_.CompareExchange(owner, 0)) {
+      if (ring->busy_.CompareExchange(1, 0)) {
+        return ring;
+      }
+      return NULL;
+    }
+  }
+  return NULL;
+}
 
-  uint16_t idx = next_free_idx_[active_queue_];
-  next_free_idx_[active_queue_]++;
-
-  level_[active_queue_][idx] = level;
-  length_[active_queue_][idx] = length;
-  memcpy(message_queue_[active_queue_][idx], trace_message, length);
-
-  if (next_free_idx_[active_queue_] == WEBRTC_TRACE_MAX_QUEUE - 1) {
-    // Logging more messages than can be worked off. Log a warning.
-    const char warning_msg[] = "WARNING MISSING TRACE MESSAGES\n";
-    level_[active_queue_][next_free_idx_[active_queue_]] = kTraceWarning;
-    length_[active_queue_][next_free_idx_[active_queue_]] = strlen(warning_msg);
-    memcpy(message_queue_[active_queue_][next_free_idx_[active_queue_]],
-           warning_msg, strlen(warning_msg));
-    next_free_idx_[active_queue_]++;
+void TraceImpl::ReleaseIdleRings() {
+  const int64_t now_ms = TickTime::MillisecondTimestamp();
+  for (int n = 0; n < WEBRTC_TRACE_NUM_RINGS; ++n) {
+    TraceRing* ring = &rings_[n];
+    const int32_t owner = ring->owner_.Value();
+    const uint32_t write_pos = ring->WritePosition();
+    if (owner == 0) {
+      last_owner_[n] = 0;
+      continue;
+    }
+    if (owner != last_owner_[n] || write_pos != last_write_pos_[n]) {
+      last_owner_[n] = owner;
+      last_write_pos_[n] = write_pos;
+      last_active_ms_[n] = now_ms;
+      continue;
+    }
+    if (now_ms - last_active_ms_[n] < kRingIdleTimeMs) {
+      continue;
+    }
+    // The owner can not write while |busy_| is held; it will claim a ring
+    // again the next time it traces.
+    if (ring->busy_.CompareExchange(2, 0)) {
+      ring->owner_.CompareExchange(0, owner);
+      ring->busy_.CompareExchange(0, 2);
+      last_owner_[n] = 0;
+    }
   }
 }
 
@@ -464,16 +592,10 @@ bool TraceImpl::Run(void* obj) {
 }
 
 bool TraceImpl::Process() {
-  if (event_.Wait(1000) == kEventSignaled) {
-    // This slightly odd construction is to avoid locking |critsect_interface_|
-    // while calling WriteToFile() since it's locked inside the function.
-    critsect_interface_->Enter();
-    bool write_to_file = trace_file_.Open() || callback_;
-    critsect_interface_->Leave();
-    if (write_to_file) {
-      WriteToFile();
-    }
-  } else {
+  const bool signaled = event_.Wait(kWriteIntervalMs) == kEventSignaled;
+  WriteToFile();
+  ReleaseIdleRings();
+  if (!signaled) {
     CriticalSectionScoped lock(critsect_interface_);
     trace_file_.Flush();
   }
@@ -481,63 +603,108 @@ bool TraceImpl::Process() {
 }
 
 void TraceImpl::WriteToFile() {
-  uint8_t local_queue_active = 0;
-  uint16_t local_next_free_idx = 0;
+  // Collect everything written so far. The records stay in the rings until
+  // they have been written.
+  uint32_t end_pos[WEBRTC_TRACE_NUM_RINGS + 1];
+  uint32_t dropped = 0;
+  pending_records_.clear();
+  for (int n = 0; n <= WEBRTC_TRACE_NUM_RINGS; ++n) {
+    TraceRing* ring =
+        (n < WEBRTC_TRACE_NUM_RINGS) ? &rings_[n] : &overflow_ring_;
+    end_pos[n] = ring->Peek(&pending_records_);
+    const int32_t ring_dropped = ring->dropped_.Value();
+    if (ring_dropped > 0) {
+      ring->dropped_ -= ring_dropped;
+      dropped += ring_dropped;
+    }
+  }
+  if (dropped > 0) {
+    dropped_messages_ += dropped;
+  }
+  // Messages from different threads are interleaved in time order.
+  std::stable_sort(pending_records_.begin(), pending_records_.end(),
+                   RecordTimeLess);
 
-  // There are two buffers. One for reading (for writing to file) and one for
-  // writing (for storing new messages). Let new messages be posted to the
-  // unused buffer so that the current buffer can be flushed safely.
   {
-    CriticalSectionScoped lock(critsect_array_);
-    local_next_free_idx = next_free_idx_[active_queue_];
-    next_free_idx_[active_queue_] = 0;
-    local_queue_active = active_queue_;
-    if (active_queue_ == 0) {
-      active_queue_ = 1;
-    } else {
-      active_queue_ = 0;
+    CriticalSectionScoped lock(critsect_interface_);
+    if (trace_file_.Open() || callback_) {
+      bool ok = true;
+      for (size_t i = 0; ok && i < pending_records_.size(); ++i) {
+        const TraceRecord* record = pending_records_[i];
+        ok = WriteRecord(*record, reinterpret_cast<const char*>(record + 1));
+      }
+      if (ok && dropped > 0) {
+        // Logging more messages than can be worked off. Log a warning.
+        char warning_msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+        TraceRecord warning;
+        warning.size = 0;
+        warning.message_length = static_cast<uint16_t>(
+            sprintf(warning_msg, "WARNING MISSING TRACE MESSAGES (%u dropped)",
+                    dropped));
+        warning.level = kTraceWarning;
+        warning.module = kTraceUtility;
+        warning.id = -1;
+        warning.thread_id = ThreadWrapper::GetThreadId();
+        warning.time_us = CurrentTimeUs();
+        WriteRecord(warning, warning_msg);
+      }
     }
   }
-  if (local_next_free_idx == 0) {
-    return;
+
+  for (int n = 0; n <= WEBRTC_TRACE_NUM_RINGS; ++n) {
+    TraceRing* ring =
+        (n < WEBRTC_TRACE_NUM_RINGS) ? &rings_[n] : &overflow_ring_;
+    ring->Consume(end_pos[n]);
   }
+  pending_records_.clear();
+}
 
-  CriticalSectionScoped lock(critsect_interface_);
+bool TraceImpl::WrapFile() {
+  row_count_text_ = 0;
+  trace_file_.Flush();
 
-  for (uint16_t idx = 0; idx < local_next_free_idx; ++idx) {
-    TraceLevel local_level = level_[local_queue_active][idx];
-    if (callback_) {
-      callback_->Print(local_level, message_queue_[local_queue_active][idx],
-                       length_[local_queue_active][idx]);
-    }
-    if (trace_file_.Open()) {
-      if (row_count_text_ > WEBRTC_TRACE_MAX_FILE_SIZE) {
-        // wrap file
-        row_count_text_ = 0;
-        trace_file_.Flush();
-
-        if (file_count_text_ == 0) {
-          trace_file_.Rewind();
-        } else {
-          char old_file_name[FileWrapper::kMaxFileNameSize];
-          char new_file_name[FileWrapper::kMaxFileNameSize];
-
-          // get current name
-          trace_file_.FileName(old_file_name,
-                               FileWrapper::kMaxFileNameSize);
-          trace_file_.CloseFile();
-
-          file_count_text_++;
-
-          UpdateFileName(old_file_name, new_file_name, file_count_text_);
-
-          if (trace_file_.OpenFile(new_file_name, false, false,
-                                   true) == -1) {
-            return;
-          }
-        }
+  char old_file_name[FileWrapper::kMaxFileNameSize];
+  char new_file_name[FileWrapper::kMaxFileNameSize];
+
+  // get current name
+  trace_file_.FileName(old_file_name, FileWrapper::kMaxFileNameSize);
+  trace_file_.CloseFile();
+
+  if (file_count_text_ == 0) {
+    // Reopen rather than rewind the file, which would leave the records of
+    // the previous pass after the new ones. A binary record cut in half
+    // there can't be decoded.
+    return trace_file_.OpenFile(old_file_name, false, false,
+                                !binary_file_) != -1;
+  }
+
+  file_count_text_++;
+
+  UpdateFileName(old_file_name, new_file_name, file_count_text_);
+
+  return trace_file_.OpenFile(new_file_name, false, false,
+                              !binary_file_) != -1;
+}
+
+bool TraceImpl::WriteRecord(const TraceRecord& record, const char* message) {
+  const TraceLevel level = static_cast<TraceLevel>(record.level);
+  if (trace_file_.Open()) {
+    if (row_count_text_ > WEBRTC_TRACE_MAX_FILE_SIZE) {
+      // wrap file
+      if (!WrapFile()) {
+        return false;
       }
-      if (row_count_text_ ==  0) {
+    }
+    if (row_count_text_ == 0) {
+      if (binary_file_) {
+        uint8_t header[kTraceFileHeaderSize];
+        memcpy(header, kTraceFileMagic, sizeof(kTraceFileMagic));
+        header[8] = kTraceFileVersion;
+        header[9] = 0;
+        header[10] = 0;
+        header[11] = 0;
+        trace_file_.Write(header, kTraceFileHeaderSize);
+      } else {
         char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
         int32_t length = AddDateTimeInfo(message);
         if (length != -1) {
@@ -556,65 +723,151 @@ void TraceImpl::WriteToFile() {
           row_count_text_++;
         }
       }
-      uint16_t length = length_[local_queue_active][idx];
-      message_queue_[local_queue_active][idx][length] = 0;
-      message_queue_[local_queue_active][idx][length - 1] = '\n';
-      trace_file_.Write(message_queue_[local_queue_active][idx], length);
-      row_count_text_++;
     }
   }
-}
 
-void TraceImpl::AddImpl(const TraceLevel level, const TraceModule module,
-                        const int32_t id,
-                        const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE]) {
-  if (TraceCheck(level)) {
-    char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+  // The text form is only built if anyone is going to read it.
+  if (callback_ || (trace_file_.Open() && !binary_file_)) {
+    char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
     char* message_ptr = trace_message;
-
-    int32_t len = 0;
     int32_t ack_len = 0;
 
-    len = AddLevel(message_ptr, level);
-    if (len == -1) {
-      return;
-    }
+    int32_t len = AddLevel(message_ptr, level);
     message_ptr += len;
     ack_len += len;
 
-    len = AddTime(message_ptr, level);
+    len = AddTime(message_ptr, record.time_us,
+                  (level == kTraceApiCall) ? &prev_api_time_ms_ :
+                                             &prev_time_ms_);
     if (len == -1) {
-      return;
+      return true;
     }
     message_ptr += len;
     ack_len += len;
 
-    len = AddModuleAndId(message_ptr, module, id);
-    if (len == -1) {
-      return;
-    }
+    len = AddModuleAndId(message_ptr, static_cast<TraceModule>(record.module),
+                         record.id);
     message_ptr += len;
     ack_len += len;
 
-    len = AddThreadId(message_ptr);
+    len = AddThreadId(message_ptr, record.thread_id);
     if (len < 0) {
-      return;
+      return true;
     }
     message_ptr += len;
     ack_len += len;
 
-    len = AddMessage(message_ptr, msg, (uint16_t)ack_len);
+    len = AddMessage(message_ptr, message, record.message_length,
+                     static_cast<uint16_t>(ack_len));
     if (len == -1) {
-      return;
+      return true;
     }
     ack_len += len;
-    AddMessageToList(trace_message, (uint16_t)ack_len, level);
 
-    // Make sure that messages are written as soon as possible.
+    if (callback_) {
+      callback_->Print(level, trace_message, ack_len);
+    }
+    if (trace_file_.Open() && !binary_file_) {
+      trace_message[ack_len] = 0;
+      trace_message[ack_len - 1] = '\n';
+      trace_file_.Write(trace_message, ack_len);
+      row_count_text_++;
+    }
+  }
+
+  if (trace_file_.Open() && binary_file_) {
+    uint8_t header[kTraceFileRecordHeaderSize];
+    WriteFileRecordHeader(record, header);
+    trace_file_.Write(header, kTraceFileRecordHeaderSize);
+    trace_file_.Write(message, record.message_length);
+    row_count_text_++;
+  }
+  return true;
+}
+
+void TraceImpl::WriteFileRecordHeader(
+    const TraceRecord& record, uint8_t header[kTraceFileRecordHeaderSize]) {
+  const uint32_t id = static_cast<uint32_t>(record.id);
+  const uint64_t time_us = static_cast<uint64_t>(record.time_us);
+  header[0] = static_cast<uint8_t>(record.message_length);
+  header[1] = static_cast<uint8_t>(record.message_length >> 8);
+  header[2] = static_cast<uint8_t>(record.level);
+  header[3] = static_cast<uint8_t>(record.level >> 8);
+  header[4] = static_cast<uint8_t>(record.module);
+  header[5] = static_cast<uint8_t>(record.module >> 8);
+  header[6] = 0;
+  header[7] = 0;
+  for (int i = 0; i < 4; ++i) {
+    header[8 + i] = static_cast<uint8_t>(id >> (8 * i));
+    header[12 + i] = static_cast<uint8_t>(record.thread_id >> (8 * i));
+  }
+  for (int i = 0; i < 8; ++i) {
+    header[16 + i] = static_cast<uint8_t>(time_us >> (8 * i));
+  }
+}
+
+void TraceImpl::ReadFileRecordHeader(
+    const uint8_t header[kTraceFileRecordHeaderSize], TraceRecord* record) {
+  uint32_t id = 0;
+  uint32_t thread_id = 0;
+  uint64_t time_us = 0;
+  for (int i = 3; i >= 0; --i) {
+    id = (id << 8) | header[8 + i];
+    thread_id = (thread_id << 8) | header[12 + i];
+  }
+  for (int i = 7; i >= 0; --i) {
+    time_us = (time_us << 8) | header[16 + i];
+  }
+  record->size = 0;
+  record->message_length = static_cast<uint16_t>(header[0] | (header[1] << 8));
+  record->level = static_cast<uint16_t>(header[2] | (header[3] << 8));
+  record->module = static_cast<uint16_t>(header[4] | (header[5] << 8));
+  record->id = static_cast<int32_t>(id);
+  record->thread_id = thread_id;
+  record->time_us = static_cast<int64_t>(time_us);
+}
+
+void TraceImpl::AddImpl(const TraceLevel level, const TraceModule module,
+                        const int32_t id, const char* msg) {
+  if (!TraceCheck(level)) {
+    return;
+  }
+  // Only the raw message is stored here; the trace thread does the
+  // formatting.
+  size_t length = msg ? strlen(msg) : 0;
+  if (length > WEBRTC_TRACE_MAX_MESSAGE_SIZE - 1) {
+    length = WEBRTC_TRACE_MAX_MESSAGE_SIZE - 1;
+  }
+  TraceRecord record;
+  record.size = 0;
+  record.message_length = static_cast<uint16_t>(length);
+  record.level = static_cast<uint16_t>(level);
+  record.module = static_cast<uint16_t>(module);
+  record.id = id;
+  record.thread_id = ThreadWrapper::GetThreadId();
+  record.time_us = CurrentTimeUs();
+
+  bool half_full = false;
+  TraceRing* ring = AcquireRing(record.thread_id);
+  if (ring) {
+    ring->Write(record, msg, &half_full);
+    ring->busy_.CompareExchange(0, 1);
+  } else {
+    CriticalSectionScoped lock(critsect_overflow_);
+    overflow_ring_.Write(record, msg, &half_full);
+  }
+
+  // Wake up the trace thread before the ring fills up, and make sure that
+  // errors are written as soon as possible.
+  if (half_full || (level & (kTraceError | kTraceCritical))) {
     event_.Set();
   }
 }
 
+uint32_t TraceImpl::DroppedMessagesImpl() const {
+  return static_cast<uint32_t>(dropped_messages_.Value());
+}
+
 bool TraceImpl::TraceCheck(const TraceLevel level) const {
   return (level & level_filter) ? true : false;
 }
@@ -715,13 +968,34 @@ int32_t Trace::SetTraceFile(const char* file_name,
                             const bool add_file_counter) {
   TraceImpl* trace = TraceImpl::GetTrace();
   if (trace) {
-    int ret_val = trace->SetTraceFileImpl(file_name, add_file_counter);
+    int ret_val = trace->SetTraceFileImpl(file_name, add_file_counter, false);
     ReturnTrace();
     return ret_val;
   }
   return -1;
 }
 
+int32_t Trace::SetBinaryTraceFile(const char* file_name,
+                                  const bool add_file_counter) {
+  TraceImpl* trace = TraceImpl::GetTrace();
+  if (trace) {
+    int ret_val = trace->SetTraceFileImpl(file_name, add_file_counter, true);
+    ReturnTrace();
+    return ret_val;
+  }
+  return -1;
+}
+
+uint32_t Trace::DroppedMessages() {
+  TraceImpl* trace = TraceImpl::GetTrace();
+  if (trace) {
+    uint32_t dropped = trace->DroppedMessagesImpl();
+    ReturnTrace();
+    return dropped;
+  }
+  return 0;
+}
+
 int32_t Trace::SetTraceCallback(TraceCallback* callback) {
   TraceImpl* trace = TraceImpl::GetTrace();
   if (trace) {
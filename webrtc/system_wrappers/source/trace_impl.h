@@ -11,6 +11,9 @@
 #ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_IMPL_H_
 #define WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_IMPL_H_
 
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/file_wrapper.h"
@@ -20,27 +23,88 @@
 
 namespace webrtc {
 
-// TODO(pwestin) WEBRTC_TRACE_MAX_QUEUE needs to be tweaked
-// TODO(hellner) the buffer should be close to how much the system can write to
-//               file. Increasing the buffer will not solve anything. Sooner or
-//               later the buffer is going to fill up anyways.
+// Every thread that traces claims one of WEBRTC_TRACE_NUM_RINGS rings of
+// WEBRTC_TRACE_RING_SIZE bytes and appends binary records to it without taking
+// any lock. Threads that find no free ring share a locked overflow ring.
+// Rings are released again once their thread has been idle for a while.
+// Total buffer size is (WEBRTC_TRACE_NUM_RINGS + 1) * WEBRTC_TRACE_RING_SIZE,
+// i.e. about 1 or 4 Mbyte.
 #if defined(WEBRTC_IOS)
-#define WEBRTC_TRACE_MAX_QUEUE  2000
+#define WEBRTC_TRACE_NUM_RINGS 16
 #else
-#define WEBRTC_TRACE_MAX_QUEUE  8000
+#define WEBRTC_TRACE_NUM_RINGS 64
 #endif
-#define WEBRTC_TRACE_NUM_ARRAY 2
+#define WEBRTC_TRACE_RING_SIZE (64 * 1024)
 #define WEBRTC_TRACE_MAX_MESSAGE_SIZE 256
-// Total buffer size is WEBRTC_TRACE_NUM_ARRAY (number of buffer partitions) *
-// WEBRTC_TRACE_MAX_QUEUE (number of lines per buffer partition) *
-// WEBRTC_TRACE_MAX_MESSAGE_SIZE (number of 1 byte charachters per line) =
-// 1 or 4 Mbyte.
 
 #define WEBRTC_TRACE_MAX_FILE_SIZE 100*1000
 // Number of rows that may be written to file. On average 110 bytes per row (max
 // 256 bytes per row). So on average 110*100*1000 = 11 Mbyte, max 256*100*1000 =
 // 25.6 Mbyte
 
+// A trace message as stored in the rings, followed by |message_length| bytes
+// of message text (not NULL terminated).
+struct TraceRecord {
+  uint16_t size;  // Size in the ring, including the message and padding.
+  uint16_t message_length;
+  uint16_t level;
+  uint16_t module;
+  int32_t id;
+  uint32_t thread_id;
+  int64_t time_us;  // Wall clock time in microseconds since the Unix epoch.
+};
+
+// Binary trace files start with kTraceFileMagic followed by a little endian
+// uint32_t version, followed by the records. Each record is a
+// kTraceFileRecordHeaderSize byte little endian header:
+//   uint16_t message_length, uint16_t level, uint16_t module, uint16_t 0,
+//   int32_t id, uint32_t thread_id, int64_t time_us
+// followed by |message_length| bytes of message text.
+extern const char kTraceFileMagic[8];
+enum { kTraceFileVersion = 1 };
+enum { kTraceFileHeaderSize = 12 };
+enum { kTraceFileRecordHeaderSize = 24 };
+
+// Single producer, single consumer ring of TraceRecords.
+class TraceRing {
+ public:
+  TraceRing();
+  ~TraceRing();
+
+  // Producer side. Returns false, and counts the message as dropped, if there
+  // is no room for the record. |half_full| is set if this record made the
+  // ring cross half its capacity.
+  bool Write(const TraceRecord& record, const char* message, bool* half_full);
+
+  // Consumer side. Appends all records written so far to |records| and
+  // returns the position to pass to Consume() once they have been handled.
+  uint32_t Peek(std::vector<const TraceRecord*>* records);
+  void Consume(uint32_t position);
+
+  // Position after the last record written, for telling whether the ring is
+  // in use. May be slightly stale.
+  uint32_t WritePosition() const {
+    return static_cast<uint32_t>(write_pos_.Value());
+  }
+
+  // Thread id of the producer owning the ring, 0 if the ring is free.
+  Atomic32 owner_;
+  // Set while the owner writes to, or the trace thread releases, the ring.
+  Atomic32 busy_;
+  // Messages dropped since the trace thread last looked.
+  Atomic32 dropped_;
+
+ private:
+  char* buffer_;
+  // Free running byte positions; the ring offset is |position| & (size - 1).
+  Atomic32 write_pos_;
+  Atomic32 read_pos_;
+  // Producer's last known value of |read_pos_|.
+  uint32_t cached_read_pos_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceRing);
+};
+
 class TraceImpl : public Trace {
  public:
   virtual ~TraceImpl();
@@ -48,7 +112,8 @@ class TraceImpl : public Trace {
   static TraceImpl* CreateInstance();
   static TraceImpl* GetTrace(const TraceLevel level = kTraceAll);
 
-  int32_t SetTraceFileImpl(const char* file_name, const bool add_file_counter);
+  int32_t SetTraceFileImpl(const char* file_name, const bool add_file_counter,
+                           const bool binary);
   int32_t TraceFileImpl(char file_name[FileWrapper::kMaxFileNameSize]);
 
   int32_t SetTraceCallbackImpl(TraceCallback* callback);
@@ -56,21 +121,39 @@ class TraceImpl : public Trace {
   void AddImpl(const TraceLevel level, const TraceModule module,
                const int32_t id, const char* msg);
 
+  uint32_t DroppedMessagesImpl() const;
+
   bool StopThread();
 
   bool TraceCheck(const TraceLevel level) const;
 
+  // Text formatting of the parts of a trace line, shared with the offline
+  // decoder of binary trace files.
+  static int32_t AddLevel(char* sz_message, const TraceLevel level);
+  static int32_t AddModuleAndId(char* trace_message, const TraceModule module,
+                                const int32_t id);
+  static int32_t AddThreadId(char* trace_message, const uint32_t thread_id);
+  // Adds |time_us| as local time and the ms since |*prev_time_ms|, which is
+  // then set to the time of this message. Returns -1 if the time can't be
+  // converted.
+  static int32_t AddTime(char* trace_message, const int64_t time_us,
+                         uint32_t* prev_time_ms);
+
+  static void WriteFileRecordHeader(const TraceRecord& record,
+                                    uint8_t header[kTraceFileRecordHeaderSize]);
+  static void ReadFileRecordHeader(
+      const uint8_t header[kTraceFileRecordHeaderSize], TraceRecord* record);
+
  protected:
   TraceImpl();
 
   static TraceImpl* StaticInstance(CountOperation count_operation,
                                    const TraceLevel level = kTraceAll);
 
-  int32_t AddThreadId(char* trace_message) const;
-
   // OS specific implementations.
-  virtual int32_t AddTime(char* trace_message,
-                          const TraceLevel level) const = 0;
+  // Returns the wall clock time in microseconds since the Unix epoch. May be
+  // called on any thread.
+  virtual int64_t CurrentTimeUs() const = 0;
 
   virtual int32_t AddBuildInfo(char* trace_message) const = 0;
   virtual int32_t AddDateTimeInfo(char* trace_message) const = 0;
@@ -81,19 +164,15 @@ class TraceImpl : public Trace {
  private:
   friend class Trace;
 
-  int32_t AddLevel(char* sz_message, const TraceLevel level) const;
-
-  int32_t AddModuleAndId(char* trace_message, const TraceModule module,
-                         const int32_t id) const;
-
   int32_t AddMessage(char* trace_message,
-                     const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
+                     const char* msg,
+                     const uint16_t msg_length,
                      const uint16_t written_so_far) const;
 
-  void AddMessageToList(
-    const char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-    const uint16_t length,
-    const TraceLevel level);
+  // Returns the ring owned by |thread_id|, claiming a free one if needed, with
+  // its |busy_| flag set. Returns NULL if no ring is available.
+  TraceRing* AcquireRing(const uint32_t thread_id);
+  void ReleaseIdleRings();
 
   bool UpdateFileName(
     const char file_name_utf8[FileWrapper::kMaxFileNameSize],
@@ -106,23 +185,36 @@ class TraceImpl : public Trace {
     const uint32_t new_count) const;
 
   void WriteToFile();
+  // Writes one record to the callback and/or file. Lock should already be
+  // taken.
+  bool WriteRecord(const TraceRecord& record, const char* message);
+  bool WrapFile();
 
   CriticalSectionWrapper* critsect_interface_;
   TraceCallback* callback_;
   uint32_t row_count_text_;
   uint32_t file_count_text_;
+  bool binary_file_;
 
   FileWrapper& trace_file_;
   ThreadWrapper& thread_;
   EventWrapper& event_;
 
-  // critsect_array_ protects active_queue_.
-  CriticalSectionWrapper* critsect_array_;
-  uint16_t next_free_idx_[WEBRTC_TRACE_NUM_ARRAY];
-  TraceLevel level_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  uint16_t length_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  char* message_queue_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  uint8_t active_queue_;
+  TraceRing rings_[WEBRTC_TRACE_NUM_RINGS];
+  // critsect_overflow_ serializes the producers of overflow_ring_.
+  CriticalSectionWrapper* critsect_overflow_;
+  TraceRing overflow_ring_;
+  mutable Atomic32 dropped_messages_;
+
+  // Only accessed on the trace thread.
+  std::vector<const TraceRecord*> pending_records_;
+  // Time of the last API call and of the last other message, for the time
+  // deltas in the text form.
+  uint32_t prev_api_time_ms_;
+  uint32_t prev_time_ms_;
+  uint32_t last_write_pos_[WEBRTC_TRACE_NUM_RINGS];
+  int32_t last_owner_[WEBRTC_TRACE_NUM_RINGS];
+  int64_t last_active_ms_[WEBRTC_TRACE_NUM_RINGS];
 };
 
 }  // namespace webrtc
@@ -35,6 +35,11 @@ int32_t Trace::SetTraceFile(const char* file_name,
   return -1;
 }
 
+int32_t Trace::SetBinaryTraceFile(const char* file_name,
+                                  const bool add_file_counter) {
+  return -1;
+}
+
 int32_t Trace::SetTraceCallback(TraceCallback* callback) {
   return -1;
 }
@@ -43,4 +48,8 @@ void Trace::Add(const TraceLevel level, const TraceModule module,
                 const int32_t id, const char* msg, ...) {
 }
 
+uint32_t Trace::DroppedMessages() {
+  return 0;
+}
+
 }  // namespace webrtc
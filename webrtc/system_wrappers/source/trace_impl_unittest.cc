@@ -0,0 +1,295 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/trace_impl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/fileutils.h"
+
+namespace webrtc {
+namespace {
+
+TraceRecord CreateRecord(uint16_t message_length, int32_t id) {
+  TraceRecord record;
+  record.size = 0;
+  record.message_length = message_length;
+  record.level = kTraceStream;
+  record.module = kTraceUtility;
+  record.id = id;
+  record.thread_id = 1;
+  record.time_us = id;
+  return record;
+}
+
+TEST(TraceRingTest, WritesAndReadsRecords) {
+  TraceRing ring;
+  const char kMessage[] = "abcdefghijklmnopqrstuvwxyz";
+  bool half_full = false;
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(ring.Write(CreateRecord(i, i), kMessage, &half_full));
+    EXPECT_FALSE(half_full);
+  }
+  std::vector<const TraceRecord*> records;
+  uint32_t position = ring.Peek(&records);
+  ASSERT_EQ(10u, records.size());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, records[i]->id);
+    EXPECT_EQ(i, records[i]->message_length);
+    EXPECT_EQ(0, memcmp(kMessage, records[i] + 1, i));
+  }
+  ring.Consume(position);
+  records.clear();
+  ring.Peek(&records);
+  EXPECT_TRUE(records.empty());
+}
+
+TEST(TraceRingTest, DropsRecordsWhenFullAndWraps) {
+  TraceRing ring;
+  char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+  memset(message, 'x', sizeof(message));
+  // Fill the ring with records that do not divide its size evenly.
+  const uint16_t kMessageLength = 100;
+  int written = 0;
+  int half_full_count = 0;
+  bool half_full = false;
+  while (ring.Write(CreateRecord(kMessageLength, written), message,
+                    &half_full)) {
+    half_full_count += half_full ? 1 : 0;
+    ++written;
+  }
+  EXPECT_EQ(1, half_full_count);
+  EXPECT_EQ(1, ring.dropped_.Value());
+  EXPECT_GT(written, WEBRTC_TRACE_RING_SIZE / 256);
+
+  // Free up half of the ring and write records across the wrap point.
+  std::vector<const TraceRecord*> records;
+  ring.Peek(&records);
+  ASSERT_EQ(static_cast<size_t>(written), records.size());
+  uint32_t consumed = 0;
+  for (int i = 0; i < written / 2; ++i) {
+    consumed += records[i]->size;
+  }
+  ring.Consume(consumed);
+  for (int i = 0; i < written / 2 - 1; ++i) {
+    EXPECT_TRUE(ring.Write(CreateRecord(kMessageLength, written + i), message,
+                           &half_full));
+  }
+  records.clear();
+  ring.Peek(&records);
+  ASSERT_EQ(static_cast<size_t>(written - written / 2 + written / 2 - 1),
+            records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(written / 2 + static_cast<int>(i), records[i]->id);
+    EXPECT_EQ(kMessageLength, records[i]->message_length);
+  }
+}
+
+TEST(TraceRingTest, FileRecordHeaderRoundTrip) {
+  TraceRecord record = CreateRecord(123, -1);
+  record.thread_id = 0x89abcdef;
+  record.time_us = 0x0123456789abcdefLL;
+  uint8_t header[kTraceFileRecordHeaderSize];
+  TraceImpl::WriteFileRecordHeader(record, header);
+  TraceRecord decoded;
+  TraceImpl::ReadFileRecordHeader(header, &decoded);
+  EXPECT_EQ(record.message_length, decoded.message_length);
+  EXPECT_EQ(record.level, decoded.level);
+  EXPECT_EQ(record.module, decoded.module);
+  EXPECT_EQ(record.id, decoded.id);
+  EXPECT_EQ(record.thread_id, decoded.thread_id);
+  EXPECT_EQ(record.time_us, decoded.time_us);
+}
+
+TEST(TraceRingTest, AddTimeReportsDelta) {
+  char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+  uint32_t prev_time_ms = 0;
+  const int64_t time_us = 1370000000123456LL;
+  ASSERT_EQ(22, TraceImpl::AddTime(message, time_us, &prev_time_ms));
+  EXPECT_STREQ(":123 |    0) ", &message[9]);
+  EXPECT_EQ(static_cast<uint32_t>(time_us / 1000), prev_time_ms);
+  ASSERT_EQ(22, TraceImpl::AddTime(message, time_us + 1500000, &prev_time_ms));
+  EXPECT_STREQ(":623 | 1500) ", &message[9]);
+}
+
+class TraceTest : public ::testing::Test, public TraceCallback {
+ public:
+  virtual void Print(TraceLevel level, const char* msg, int length) {
+    CriticalSectionScoped cs(crit_.get());
+    if (length > Trace::kBoilerplateLength &&
+        strncmp(&msg[Trace::kBoilerplateLength], "TraceTest ", 10) == 0) {
+      messages_.push_back(std::string(&msg[Trace::kBoilerplateLength]));
+      if (static_cast<int>(messages_.size()) == expected_messages_) {
+        done_->Set();
+      }
+    }
+  }
+
+ protected:
+  TraceTest()
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        done_(EventWrapper::Create()),
+        expected_messages_(0) {
+  }
+
+  void SetUp() {
+    Trace::CreateTrace();
+    Trace::LevelFilter(old_filter_);
+    Trace::SetLevelFilter(kTraceStream);
+  }
+
+  void TearDown() {
+    Trace::SetTraceCallback(NULL);
+    Trace::SetTraceFile(NULL);
+    Trace::SetLevelFilter(old_filter_);
+    Trace::ReturnTrace();
+  }
+
+  static bool TraceThread(void* obj) {
+    TraceTest* test = static_cast<TraceTest*>(obj);
+    for (int i = 0; i < test->messages_per_thread_; ++i) {
+      Trace::Add(kTraceStream, kTraceUtility, -1, "TraceTest %d", i);
+    }
+    return false;
+  }
+
+  // Traces |messages_per_thread| messages on each of |num_threads| threads
+  // and returns the average time per message in nanoseconds.
+  double TraceOnThreads(int num_threads, int messages_per_thread) {
+    messages_per_thread_ = messages_per_thread;
+    std::vector<ThreadWrapper*> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.push_back(ThreadWrapper::CreateThread(TraceThread, this,
+                                                    kNormalPriority));
+    }
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < num_threads; ++i) {
+      unsigned int id = 0;
+      threads[i]->Start(id);
+    }
+    for (int i = 0; i < num_threads; ++i) {
+      threads[i]->Stop();
+      delete threads[i];
+    }
+    const int64_t elapsed_ns = (TickTime::Now() - start).Microseconds() * 1000;
+    return static_cast<double>(elapsed_ns) /
+        (num_threads * messages_per_thread);
+  }
+
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  scoped_ptr<EventWrapper> done_;
+  std::vector<std::string> messages_;
+  int expected_messages_;
+  int messages_per_thread_;
+  uint32_t old_filter_;
+};
+
+TEST_F(TraceTest, CallbackReceivesMessagesFromAllThreads) {
+  const int kNumThreads = 4;
+  const int kMessagesPerThread = 100;
+  expected_messages_ = kNumThreads * kMessagesPerThread;
+  Trace::SetTraceCallback(this);
+  TraceOnThreads(kNumThreads, kMessagesPerThread);
+  EXPECT_EQ(kEventSignaled, done_->Wait(2000));
+
+  CriticalSectionScoped cs(crit_.get());
+  ASSERT_EQ(static_cast<size_t>(expected_messages_), messages_.size());
+  EXPECT_EQ(0u, Trace::DroppedMessages());
+  // Each thread's messages arrive in order.
+  int count[kMessagesPerThread] = { 0 };
+  for (size_t i = 0; i < messages_.size(); ++i) {
+    int n = -1;
+    ASSERT_EQ(1, sscanf(messages_[i].c_str(), "TraceTest %d", &n));
+    ASSERT_GE(n, 0);
+    ASSERT_LT(n, kMessagesPerThread);
+    ++count[n];
+  }
+  for (int i = 0; i < kMessagesPerThread; ++i) {
+    EXPECT_EQ(kNumThreads, count[i]);
+  }
+}
+
+TEST_F(TraceTest, WritesBinaryFile) {
+  const std::string file_name = test::OutputPath() + "trace_binary_test.bin";
+  ASSERT_EQ(0, Trace::SetBinaryTraceFile(file_name.c_str()));
+  const int kMessages = 50;
+  expected_messages_ = kMessages;
+  Trace::SetTraceCallback(this);
+  TraceOnThreads(1, kMessages);
+  EXPECT_EQ(kEventSignaled, done_->Wait(2000));
+  // Closing the file flushes it.
+  Trace::SetTraceFile(NULL);
+
+  FILE* file = fopen(file_name.c_str(), "rb");
+  ASSERT_TRUE(file != NULL);
+  uint8_t file_header[kTraceFileHeaderSize];
+  ASSERT_EQ(sizeof(file_header), fread(file_header, 1, sizeof(file_header),
+                                       file));
+  EXPECT_EQ(0, memcmp(kTraceFileMagic, file_header, sizeof(kTraceFileMagic)));
+  EXPECT_EQ(kTraceFileVersion, file_header[8]);
+
+  int found = 0;
+  uint8_t header[kTraceFileRecordHeaderSize];
+  while (fread(header, 1, sizeof(header), file) == sizeof(header)) {
+    TraceRecord record;
+    TraceImpl::ReadFileRecordHeader(header, &record);
+    std::string message(record.message_length, '\0');
+    ASSERT_EQ(record.message_length,
+              fread(&message[0], 1, record.message_length, file));
+    char expected[32];
+    sprintf(expected, "TraceTest %d", found);
+    if (message.compare(0, 10, "TraceTest ") == 0) {
+      EXPECT_EQ(expected, message);
+      EXPECT_EQ(kTraceStream, record.level);
+      EXPECT_EQ(kTraceUtility, record.module);
+      EXPECT_EQ(-1, record.id);
+      ++found;
+    }
+  }
+  fclose(file);
+  remove(file_name.c_str());
+  EXPECT_EQ(kMessages, found);
+}
+
+// Measures the cost of a trace call on the calling thread, with the trace
+// writing text, binary or nothing at all.
+TEST_F(TraceTest, DISABLED_AddBenchmark) {
+  const int kMessagesPerThread = 20000;
+  const std::string text_file = test::OutputPath() + "trace_benchmark.txt";
+  const std::string binary_file = test::OutputPath() + "trace_benchmark.bin";
+  for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+    Trace::SetTraceFile(NULL);
+    double no_output_ns = TraceOnThreads(num_threads, kMessagesPerThread);
+    Trace::SetTraceFile(text_file.c_str());
+    double text_ns = TraceOnThreads(num_threads, kMessagesPerThread);
+    Trace::SetBinaryTraceFile(binary_file.c_str());
+    double binary_ns = TraceOnThreads(num_threads, kMessagesPerThread);
+    printf("%d thread(s): %.0f ns/trace without output, %.0f ns/trace text, "
+           "%.0f ns/trace binary\n", num_threads, no_output_ns, text_ns,
+           binary_ns);
+  }
+  Trace::SetTraceFile(NULL);
+  printf("Dropped %u messages\n", Trace::DroppedMessages());
+  remove(text_file.c_str());
+  remove(binary_file.c_str());
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -13,8 +13,6 @@
 #include <cassert>
 #include <stdarg.h>
 
-#include "Mmsystem.h"
-
 #if defined(_DEBUG)
 #define BUILDMODE "d"
 #elif defined(DEBUG)
@@ -30,58 +28,23 @@
 #define BUILDINFO BUILDDATE " " BUILDTIME " " BUILDMODE
 
 namespace webrtc {
-TraceWindows::TraceWindows()
-    : prev_api_tick_count_(0),
-      prev_tick_count_(0) {
+TraceWindows::TraceWindows() {
 }
 
 TraceWindows::~TraceWindows() {
   StopThread();
 }
 
-int32_t TraceWindows::AddTime(char* trace_message,
-                              const TraceLevel level) const {
-  uint32_t dw_current_time = timeGetTime();
-  SYSTEMTIME system_time;
-  GetSystemTime(&system_time);
-
-  if (level == kTraceApiCall) {
-    uint32_t dw_delta_time = dw_current_time - prev_tick_count_;
-    prev_tick_count_ = dw_current_time;
-
-    if (prev_tick_count_ == 0) {
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 0x0fffffff) {
-      // Either wrap-around or data race.
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 99999) {
-      dw_delta_time = 99999;
-    }
+// Offset between the FILETIME epoch (1601) and the Unix epoch, in 100 ns.
+static const int64_t kFileTimeToUnixEpoch = 116444736000000000LL;
 
-    sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
-            system_time.wMinute, system_time.wSecond,
-            system_time.wMilliseconds, dw_delta_time);
-  } else {
-    uint32_t dw_delta_time = dw_current_time - prev_api_tick_count_;
-    prev_api_tick_count_ = dw_current_time;
-
-    if (prev_api_tick_count_ == 0) {
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 0x0fffffff) {
-      // Either wraparound or data race.
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 99999) {
-      dw_delta_time = 99999;
-    }
-    sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
-            system_time.wMinute, system_time.wSecond,
-            system_time.wMilliseconds, dw_delta_time);
-  }
-  return 22;
+int64_t TraceWindows::CurrentTimeUs() const {
+  FILETIME file_time;
+  GetSystemTimeAsFileTime(&file_time);
+  ULARGE_INTEGER time;
+  time.LowPart = file_time.dwLowDateTime;
+  time.HighPart = file_time.dwHighDateTime;
+  return (static_cast<int64_t>(time.QuadPart) - kFileTimeToUnixEpoch) / 10;
 }
 
 int32_t TraceWindows::AddBuildInfo(char* trace_message) const {
@@ -92,9 +55,6 @@ int32_t TraceWindows::AddBuildInfo(char* trace_message) const {
 }
 
 int32_t TraceWindows::AddDateTimeInfo(char* trace_message) const {
-  prev_api_tick_count_ = timeGetTime();
-  prev_tick_count_ = prev_api_tick_count_;
-
   SYSTEMTIME sys_time;
   GetLocalTime(&sys_time);
 
@@ -10,12 +10,18 @@
 
 #include "webrtc/test/channel_transport/udp_socket_manager_posix.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
 #include <strings.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
 #include <stdio.h>
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+#include <sys/epoll.h>
+#endif
 
 #include "webrtc/system_wrappers/interface/sleep.h"
 #include "webrtc/system_wrappers/interface/trace.h"
@@ -197,7 +203,22 @@ UdpSocketManagerPosixImpl::UdpSocketManagerPosixImpl()
     _thread = ThreadWrapper::CreateThread(UdpSocketManagerPosixImpl::Run, this,
                                           kRealtimePriority,
                                           "UdpSocketManagerPosixImplThread");
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+    _epollFd = epoll_create(kMaxEpollEvents);
+    if (_epollFd == -1)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceTransport, -1,
+                     "UdpSocketManagerPosix failed to create epoll set: %d",
+                     errno);
+    }
+    else if (fcntl(_epollFd, F_SETFD, FD_CLOEXEC) == -1)
+    {
+        WEBRTC_TRACE(kTraceWarning, kTraceTransport, -1,
+                     "Failed to set FD_CLOEXEC for epoll set");
+    }
+#else
     FD_ZERO(&_readFds);
+#endif
     WEBRTC_TRACE(kTraceMemory,  kTraceTransport, -1,
                  "UdpSocketManagerPosix created");
 }
@@ -228,6 +249,13 @@ UdpSocketManagerPosixImpl::~UdpSocketManagerPosixImpl()
         delete _critSectList;
     }
 
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+    if (_epollFd != -1)
+    {
+        close(_epollFd);
+    }
+#endif
+
     WEBRTC_TRACE(kTraceMemory,  kTraceTransport, -1,
                  "UdpSocketManagerPosix deleted");
 }
@@ -239,6 +267,12 @@ bool UdpSocketManagerPosixImpl::Start()
     {
         return false;
     }
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+    if (_epollFd == -1)
+    {
+        return false;
+    }
+#endif
 
     WEBRTC_TRACE(kTraceStateInfo,  kTraceTransport, -1,
                  "Start UdpSocketManagerPosix");
@@ -257,6 +291,35 @@ bool UdpSocketManagerPosixImpl::Stop()
     return _thread->Stop();
 }
 
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+bool UdpSocketManagerPosixImpl::Process()
+{
+    UpdateSocketMap();
+
+    // Timeout = 10 ms.
+    struct epoll_event events[kMaxEpollEvents];
+    int num = epoll_wait(_epollFd, events, kMaxEpollEvents, 10);
+    if (num == SOCKET_ERROR)
+    {
+        if (errno != EINTR)
+        {
+            // Timeout = 10 ms.
+            SleepMs(10);
+        }
+        return true;
+    }
+
+    // Sockets are only deleted from UpdateSocketMap(), which runs on this
+    // thread after they have been taken out of the epoll set, so the pointers
+    // stored in the events are still valid here.
+    for (int i = 0; i < num; i++)
+    {
+        UdpSocketPosix* s = static_cast<UdpSocketPosix*>(events[i].data.ptr);
+        s->HasIncoming();
+    }
+    return true;
+}
+#else
 bool UdpSocketManagerPosixImpl::Process()
 {
     bool doSelect = false;
@@ -308,6 +371,7 @@ bool UdpSocketManagerPosixImpl::Process()
     }
     return true;
 }
+#endif
 
 bool UdpSocketManagerPosixImpl::Run(ThreadObj obj)
 {
@@ -319,10 +383,17 @@ bool UdpSocketManagerPosixImpl::Run(ThreadObj obj)
 bool UdpSocketManagerPosixImpl::AddSocket(UdpSocketWrapper* s)
 {
     UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+    if(sl->GetFd() == INVALID_SOCKET || _epollFd == -1)
+    {
+        return false;
+    }
+#else
     if(sl->GetFd() == INVALID_SOCKET || !(sl->GetFd() < FD_SETSIZE))
     {
         return false;
     }
+#endif
     _critSectList->Enter();
     _addList.PushBack(s);
     _critSectList->Leave();
@@ -397,6 +468,13 @@ void UdpSocketManagerPosixImpl::UpdateSocketMap()
             {
                 deleteSocket = socket;
             }
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+            // Kernels before 2.6.9 require a non-NULL event for
+            // EPOLL_CTL_DEL.
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            epoll_ctl(_epollFd, EPOLL_CTL_DEL, removeFD, &event);
+#endif
             _socketMap.Erase(it);
         }
         if(deleteSocket)
@@ -414,6 +492,18 @@ void UdpSocketManagerPosixImpl::UpdateSocketMap()
             static_cast<UdpSocketPosix*>(_addList.First()->GetItem());
         if(s)
         {
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.ptr = s;
+            if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, s->GetFd(), &event) == -1)
+            {
+                WEBRTC_TRACE(kTraceError, kTraceTransport, -1,
+                             "UdpSocketManagerPosix failed to add socket %d "
+                             "to epoll set: %d", s->GetFd(), errno);
+            }
+#endif
             _socketMap.Insert(s->GetFd(), s);
         }
         _addList.PopFront();
@@ -19,6 +19,7 @@
 #include "webrtc/system_wrappers/interface/map_wrapper.h"
 #include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
+#include "webrtc/test/channel_transport/udp_socket_posix.h"
 #include "webrtc/test/channel_transport/udp_socket_wrapper.h"
 
 namespace webrtc {
@@ -28,7 +29,7 @@ class ConditionVariableWrapper;
 namespace test {
 
 class UdpSocketManagerPosixImpl;
-#define MAX_NUMBER_OF_SOCKET_MANAGERS_LINUX 8
+#define MAX_NUMBER_OF_SOCKET_MANAGERS_LINUX 64
 
 class UdpSocketManagerPosix : public UdpSocketManager
 {
@@ -72,10 +73,18 @@ protected:
     void UpdateSocketMap();
 
 private:
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+    enum { kMaxEpollEvents = 64 };
+#endif
+
     ThreadWrapper* _thread;
     CriticalSectionWrapper* _critSectList;
 
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+    int _epollFd;
+#else
     fd_set _readFds;
+#endif
 
     MapWrapper _socketMap;
     ListWrapper _addList;
@@ -15,9 +15,15 @@
 // It also uses the static UdpSocketManager object.
 // The most important property of these tests is that they do not leak memory.
 
+#include <stdio.h>
+#include <string.h>
+
 #include "gtest/gtest.h"
 #include "webrtc/test/channel_transport/udp_socket_wrapper.h"
 #include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 
 namespace webrtc {
@@ -80,5 +86,90 @@ TEST(UdpSocketManager, UnremovedSocketsGetCollectedAtManagerDeletion) {
 #endif
 }
 
+static void CountIncomingPacket(CallbackObj obj, const int8_t* /*buf*/,
+                                int32_t /*len*/,
+                                const SocketAddress* /*from*/) {
+  ++*static_cast<Atomic32*>(obj);
+}
+
+static SocketAddress LoopbackAddress(uint16_t port) {
+  SocketAddress address;
+  memset(&address, 0, sizeof(address));
+  address._sockaddr_in.sin_family = AF_INET;
+  address._sockaddr_in.sin_port = UdpTransport::Htons(port);
+  address._sockaddr_in.sin_addr = UdpTransport::InetAddrIPV4("127.0.0.1");
+  return address;
+}
+
+// Benchmark for the socket manager receive path. Spreads a fixed number of
+// small packets over a set of loopback sockets and reports the rate at which
+// they are delivered to the socket callbacks, in total and per manager
+// thread. The number of packets in flight is bounded so that the loopback
+// receive buffers don't overflow.
+TEST(UdpSocketManager, DISABLED_LoopbackReceiveBenchmark) {
+  const int32_t kId = 42;
+  const int kNumSockets = 32;
+  const int kNumPackets = 100000;
+  const int kMaxPacketsInFlight = 128;
+  const int kPacketSize = 160;
+  const uint16_t kBasePort = 51300;
+  const int64_t kTimeoutMs = 10000;
+  const uint8_t kThreadCounts[] = {1, 2, 4};
+
+  int8_t packet[kPacketSize];
+  memset(packet, 0, sizeof(packet));
+
+  for (size_t t = 0; t < sizeof(kThreadCounts) / sizeof(kThreadCounts[0]);
+       ++t) {
+    uint8_t threads = kThreadCounts[t];
+    UdpSocketManager* mgr = UdpSocketManager::Create(kId, threads);
+    Atomic32 received;
+
+    UdpSocketWrapper* receivers[kNumSockets];
+    SocketAddress addresses[kNumSockets];
+    for (int i = 0; i < kNumSockets; ++i) {
+      addresses[i] = LoopbackAddress(kBasePort + i);
+      receivers[i] = UdpSocketWrapper::CreateSocket(kId, mgr, &received,
+                                                    CountIncomingPacket);
+      ASSERT_TRUE(receivers[i] != NULL);
+      ASSERT_TRUE(receivers[i]->Bind(addresses[i]));
+      receivers[i]->StartReceiving();
+    }
+    UdpSocketWrapper* sender =
+        UdpSocketWrapper::CreateSocket(kId, mgr, NULL, NULL);
+    ASSERT_TRUE(sender != NULL);
+
+    TickTime start = TickTime::Now();
+    int sent = 0;
+    while (sent < kNumPackets &&
+           (TickTime::Now() - start).Milliseconds() < kTimeoutMs) {
+      if (sent - received.Value() >= kMaxPacketsInFlight) {
+        continue;
+      }
+      if (sender->SendTo(packet, kPacketSize,
+                         addresses[sent % kNumSockets]) == kPacketSize) {
+        ++sent;
+      }
+    }
+    while (received.Value() < sent &&
+           (TickTime::Now() - start).Milliseconds() < kTimeoutMs) {
+      SleepMs(1);
+    }
+    double elapsed_ms = (TickTime::Now() - start).Microseconds() / 1000.0;
+    double packets_per_second = received.Value() * 1000.0 / elapsed_ms;
+    printf("%d threads: received %d/%d packets in %.2fms, %.0f packets/s, "
+           "%.0f packets/s per thread.\n", threads, received.Value(),
+           kNumPackets, elapsed_ms, packets_per_second,
+           packets_per_second / threads);
+    EXPECT_GT(received.Value(), 0);
+
+    sender->CloseBlocking();
+    for (int i = 0; i < kNumSockets; ++i) {
+      receivers[i]->CloseBlocking();
+    }
+    UdpSocketManager::Return();
+  }
+}
+
 }  // namespace test
 }  // namespace webrtc
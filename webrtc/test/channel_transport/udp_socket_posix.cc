@@ -15,6 +15,7 @@
 #include <netdb.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
@@ -180,9 +181,39 @@ bool UdpSocketPosix::ValidHandle()
 
 void UdpSocketPosix::HasIncoming()
 {
-    // replace 2048 with a mcro define and figure out
-    // where 2048 comes from
-    int8_t buf[2048];
+#if defined(WEBRTC_UDP_SOCKET_USE_RECVMMSG)
+    int8_t bufs[kMaxReceiveBatch][kMaxPacketSize];
+    SocketAddress from[kMaxReceiveBatch];
+    struct iovec iovecs[kMaxReceiveBatch];
+    struct mmsghdr msgs[kMaxReceiveBatch];
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < kMaxReceiveBatch; ++i)
+    {
+        iovecs[i].iov_base = bufs[i];
+        iovecs[i].iov_len = kMaxPacketSize;
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &from[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+    }
+
+    int received = recvmmsg(_socket, msgs, kMaxReceiveBatch, MSG_DONTWAIT,
+                            NULL);
+    if (received == SOCKET_ERROR)
+    {
+        return;
+    }
+    for (int i = 0; i < received; ++i)
+    {
+        // A zero length datagram means the peer has performed an orderly
+        // shutdown.
+        if (msgs[i].msg_len > 0 && _wantsIncoming && _incomingCb)
+        {
+            _incomingCb(_obj, bufs[i], msgs[i].msg_len, &from[i]);
+        }
+    }
+#else
+    int8_t buf[kMaxPacketSize];
     int retval;
     SocketAddress from;
 #if defined(WEBRTC_MAC)
@@ -219,6 +250,7 @@ void UdpSocketPosix::HasIncoming()
         }
         break;
     }
+#endif
 }
 
 void UdpSocketPosix::CloseBlocking()
@@ -25,6 +25,16 @@ namespace test {
 
 #define SOCKET_ERROR -1
 
+// On Linux the socket manager waits on an epoll set instead of select(),
+// which removes the FD_SETSIZE limit on socket descriptors. Where available,
+// incoming datagrams are drained in batches with a single recvmmsg() call.
+#if defined(WEBRTC_LINUX)
+#define WEBRTC_UDP_SOCKET_USE_EPOLL
+#if !defined(WEBRTC_ANDROID)
+#define WEBRTC_UDP_SOCKET_USE_RECVMMSG
+#endif
+#endif
+
 class UdpSocketPosix : public UdpSocketWrapper
 {
 public:
@@ -66,12 +76,18 @@ public:
                         int32_t /*overrideDSCP*/) {return false;}
 
     bool CleanUp();
+    // Reads pending datagrams and delivers them to the registered callback.
+    // With recvmmsg() support up to kMaxReceiveBatch datagrams are read per
+    // call, otherwise one.
     void HasIncoming();
     bool WantsIncoming() {return _wantsIncoming;}
     void ReadyForDeletion();
 private:
     friend class UdpSocketManagerPosix;
 
+    enum { kMaxPacketSize = 2048 };
+    enum { kMaxReceiveBatch = 16 };
+
     int32_t _id;
     IncomingSocketCallback _incomingCb;
     CallbackObj _obj;
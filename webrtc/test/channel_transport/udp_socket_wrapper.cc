@@ -104,7 +104,11 @@ UdpSocketWrapper* UdpSocketWrapper::CreateSocket(const int32_t id,
     if (s)
     {
         UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
+#if defined(WEBRTC_UDP_SOCKET_USE_EPOLL)
+        if (sl->GetFd() != INVALID_SOCKET)
+#else
         if (sl->GetFd() != INVALID_SOCKET && sl->GetFd() < FD_SETSIZE)
+#endif
         {
             // ok
         } else
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "tools/event_log/event_log_parser.h"
+
+#include <string.h>
+
+#include "system_wrappers/source/rtc_event_log_impl.h"
+
+namespace webrtc {
+
+namespace {
+
+uint16_t ReadUint16(const uint8_t* buffer) {
+  return static_cast<uint16_t>(buffer[0] | (buffer[1] << 8));
+}
+
+uint32_t ReadUint32(const uint8_t* buffer) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) {
+    value = (value << 8) | buffer[i];
+  }
+  return value;
+}
+
+uint32_t ReadBigEndianUint32(const uint8_t* buffer) {
+  return (static_cast<uint32_t>(buffer[0]) << 24) | (buffer[1] << 16) |
+      (buffer[2] << 8) | buffer[3];
+}
+
+bool HasPayload(const RtcEvent& event, RtcEventLog::EventType type,
+                size_t payload_size) {
+  return event.type == type && event.payload.size() >= payload_size;
+}
+
+}  // namespace
+
+RtcEventLogParser::RtcEventLogParser()
+    : file_(NULL),
+      truncated_(false) {
+}
+
+RtcEventLogParser::~RtcEventLogParser() {
+  if (file_ != NULL) {
+    fclose(file_);
+  }
+}
+
+bool RtcEventLogParser::Open(const std::string& file_name) {
+  if (file_ != NULL) {
+    fclose(file_);
+  }
+  truncated_ = false;
+  file_ = fopen(file_name.c_str(), "rb");
+  if (file_ == NULL) {
+    return false;
+  }
+  uint8_t file_header[kRtcEventLogHeaderSize];
+  if (fread(file_header, 1, sizeof(file_header), file_) !=
+      sizeof(file_header) ||
+      memcmp(file_header, kRtcEventLogMagic, sizeof(kRtcEventLogMagic)) != 0 ||
+      ReadUint32(&file_header[sizeof(kRtcEventLogMagic)]) !=
+      kRtcEventLogVersion) {
+    fclose(file_);
+    file_ = NULL;
+    return false;
+  }
+  return true;
+}
+
+bool RtcEventLogParser::ReadEvent(RtcEvent* event) {
+  if (file_ == NULL) {
+    return false;
+  }
+  uint8_t buffer[kRtcEventHeaderSize];
+  size_t bytes_read = fread(buffer, 1, sizeof(buffer), file_);
+  if (bytes_read != sizeof(buffer)) {
+    truncated_ = bytes_read > 0;
+    return false;
+  }
+  RtcEventHeader header;
+  RtcEventLogImpl::ReadEventHeader(buffer, &header);
+  if (header.size < kRtcEventHeaderSize) {
+    truncated_ = true;
+    return false;
+  }
+  event->type = header.type;
+  event->incoming = (header.flags & kRtcEventIncoming) != 0;
+  event->id = header.id;
+  event->time_us = header.time_us;
+  event->payload.resize(header.size - kRtcEventHeaderSize);
+  if (!event->payload.empty() &&
+      fread(&event->payload[0], 1, event->payload.size(), file_) !=
+      event->payload.size()) {
+    truncated_ = true;
+    return false;
+  }
+  return true;
+}
+
+bool ParseRtpHeader(const RtcEvent& event, RtpHeaderEvent* rtp_header) {
+  // Packet length followed by the fixed RTP header.
+  if (!HasPayload(event, RtcEventLog::kRtpHeader, 2 + 12)) {
+    return false;
+  }
+  const uint8_t* header = &event.payload[2];
+  rtp_header->packet_length = ReadUint16(&event.payload[0]);
+  rtp_header->header_length = static_cast<int>(event.payload.size()) - 2;
+  rtp_header->marker = (header[1] & 0x80) != 0;
+  rtp_header->payload_type = header[1] & 0x7f;
+  rtp_header->sequence_number = static_cast<uint16_t>((header[2] << 8) |
+                                                      header[3]);
+  rtp_header->timestamp = ReadBigEndianUint32(&header[4]);
+  rtp_header->ssrc = ReadBigEndianUint32(&header[8]);
+  return true;
+}
+
+bool ParseRemoteBitrateEstimate(const RtcEvent& event,
+                                RemoteBitrateEstimateEvent* estimate) {
+  if (!HasPayload(event, RtcEventLog::kRemoteBitrateEstimate, 9)) {
+    return false;
+  }
+  estimate->bitrate_bps = ReadUint32(&event.payload[0]);
+  estimate->incoming_bitrate_bps = ReadUint32(&event.payload[4]);
+  estimate->bandwidth_usage = event.payload[8];
+  return true;
+}
+
+bool ParseBitrateControllerUpdate(const RtcEvent& event,
+                                  BitrateControllerEvent* update) {
+  if (!HasPayload(event, RtcEventLog::kBitrateControllerUpdate, 9)) {
+    return false;
+  }
+  update->bitrate_bps = ReadUint32(&event.payload[0]);
+  update->rtt_ms = ReadUint32(&event.payload[4]);
+  update->fraction_lost = event.payload[8];
+  return true;
+}
+
+bool ParsePacerState(const RtcEvent& event, PacerStateEvent* state) {
+  if (!HasPayload(event, RtcEventLog::kPacerState, 8)) {
+    return false;
+  }
+  state->queued_packets = static_cast<int>(ReadUint32(&event.payload[0]));
+  state->queue_ms = static_cast<int>(ReadUint32(&event.payload[4]));
+  return true;
+}
+
+bool ParseJitterBufferEvent(const RtcEvent& event,
+                            JitterBufferEvent* jitter_buffer_event) {
+  if (!HasPayload(event, RtcEventLog::kJitterBufferEvent, 9)) {
+    return false;
+  }
+  jitter_buffer_event->event =
+      static_cast<RtcEventLog::JitterBufferEvent>(event.payload[0]);
+  jitter_buffer_event->timestamp = ReadUint32(&event.payload[1]);
+  jitter_buffer_event->value =
+      static_cast<int32_t>(ReadUint32(&event.payload[5]));
+  return true;
+}
+
+bool ParseRtcpPacketTypes(const RtcEvent& event,
+                          std::vector<std::pair<int, int> >* packet_types) {
+  if (event.type != RtcEventLog::kRtcpPacket) {
+    return false;
+  }
+  size_t position = 0;
+  while (position + 4 <= event.payload.size()) {
+    const uint8_t* header = &event.payload[position];
+    packet_types->push_back(std::make_pair(header[1], header[0] & 0x1f));
+    // The length is in 32-bit words minus one.
+    position += 4 * (((header[2] << 8) | header[3]) + 1);
+  }
+  return position == event.payload.size();
+}
+
+}  // namespace webrtc
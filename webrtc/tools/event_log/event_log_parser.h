@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_TOOLS_EVENT_LOG_EVENT_LOG_PARSER_H_
+#define WEBRTC_TOOLS_EVENT_LOG_EVENT_LOG_PARSER_H_
+
+#include <stdio.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "system_wrappers/interface/constructor_magic.h"
+#include "system_wrappers/interface/rtc_event_log.h"
+
+namespace webrtc {
+
+// An event as read from an RTC event log file, written after
+// webrtc::RtcEventLog::Start(). The payload can be decoded with the Parse*()
+// functions below, depending on the type.
+struct RtcEvent {
+  int type;  // An RtcEventLog::EventType, or unknown to this parser.
+  bool incoming;
+  int32_t id;
+  int64_t time_us;
+  std::vector<uint8_t> payload;
+};
+
+struct RtpHeaderEvent {
+  uint32_t ssrc;
+  uint16_t sequence_number;
+  uint32_t timestamp;
+  uint8_t payload_type;
+  bool marker;
+  int header_length;
+  int packet_length;
+};
+
+struct RemoteBitrateEstimateEvent {
+  uint32_t bitrate_bps;
+  uint32_t incoming_bitrate_bps;
+  int bandwidth_usage;
+};
+
+struct BitrateControllerEvent {
+  uint32_t bitrate_bps;
+  uint32_t rtt_ms;
+  uint8_t fraction_lost;
+};
+
+struct PacerStateEvent {
+  int queued_packets;
+  int queue_ms;
+};
+
+struct JitterBufferEvent {
+  RtcEventLog::JitterBufferEvent event;
+  uint32_t timestamp;
+  int32_t value;
+};
+
+class RtcEventLogParser {
+ public:
+  RtcEventLogParser();
+  ~RtcEventLogParser();
+
+  // Opens |file_name| and checks its file header. Returns false if the file
+  // can't be opened or isn't an RTC event log of a supported version.
+  bool Open(const std::string& file_name);
+
+  // Reads the next event. Returns false at the end of the file, or if the
+  // last event is truncated.
+  bool ReadEvent(RtcEvent* event);
+
+  // True if reading stopped at an incomplete event, e.g. because the log
+  // wasn't stopped before the process exited.
+  bool truncated() const { return truncated_; }
+
+ private:
+  FILE* file_;
+  bool truncated_;
+
+  DISALLOW_COPY_AND_ASSIGN(RtcEventLogParser);
+};
+
+// The functions below decode the payload of |event|. They return false if
+// |event| is of another type or its payload is too short.
+bool ParseRtpHeader(const RtcEvent& event, RtpHeaderEvent* rtp_header);
+bool ParseRemoteBitrateEstimate(const RtcEvent& event,
+                                RemoteBitrateEstimateEvent* estimate);
+bool ParseBitrateControllerUpdate(const RtcEvent& event,
+                                  BitrateControllerEvent* update);
+bool ParsePacerState(const RtcEvent& event, PacerStateEvent* state);
+bool ParseJitterBufferEvent(const RtcEvent& event,
+                            JitterBufferEvent* jitter_buffer_event);
+
+// Appends the packet type and the five bit count or format field of each
+// packet of the compound RTCP packet |event| to |packet_types|, e.g. 205, 1
+// for a generic NACK.
+bool ParseRtcpPacketTypes(const RtcEvent& event,
+                          std::vector<std::pair<int, int> >* packet_types);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_TOOLS_EVENT_LOG_EVENT_LOG_PARSER_H_
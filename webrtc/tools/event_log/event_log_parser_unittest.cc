@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/rtc_event_log.h"
+#include "webrtc/test/testsupport/fileutils.h"
+#include "webrtc/tools/event_log/event_log_parser.h"
+
+namespace webrtc {
+namespace test {
+
+class EventLogParserTest : public ::testing::Test {
+ protected:
+  EventLogParserTest()
+      : file_name_(OutputPath() + "event_log_parser_test.log") {
+  }
+
+  virtual void TearDown() {
+    RtcEventLog::Stop();
+    remove(file_name_.c_str());
+  }
+
+  const std::string file_name_;
+};
+
+TEST_F(EventLogParserTest, ParsesAllEventTypes) {
+  const uint8_t kRtpPacket[] = {
+    0x80, 0xe0, 0x12, 0x34, 0x00, 0x01, 0x02, 0x03,
+    0x12, 0x34, 0x56, 0x78, 0xaa, 0xbb };
+  // Compound RTCP packet with an empty receiver report and a PLI.
+  const uint8_t kRtcpPacket[] = {
+    0x80, 0xc9, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+    0x81, 0xce, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02,
+    0x00, 0x00, 0x00, 0x03 };
+  ASSERT_EQ(0, RtcEventLog::Start(file_name_.c_str()));
+  RtcEventLog::LogRtpHeader(3, true, kRtpPacket, sizeof(kRtpPacket));
+  RtcEventLog::LogRtcpPacket(3, false, kRtcpPacket, sizeof(kRtcpPacket));
+  RtcEventLog::LogRemoteBitrateEstimate(500000, 450000, 2);
+  RtcEventLog::LogBitrateControllerUpdate(300000, 25, 120);
+  RtcEventLog::LogPacerState(17, 42);
+  RtcEventLog::LogJitterBufferEvent(4, RtcEventLog::kFrameDropped, 90000, -1);
+  RtcEventLog::Stop();
+
+  RtcEventLogParser parser;
+  ASSERT_TRUE(parser.Open(file_name_));
+  RtcEvent event;
+
+  ASSERT_TRUE(parser.ReadEvent(&event));
+  EXPECT_EQ(RtcEventLog::kRtpHeader, event.type);
+  EXPECT_TRUE(event.incoming);
+  EXPECT_EQ(3, event.id);
+  RtpHeaderEvent rtp_header;
+  ASSERT_TRUE(ParseRtpHeader(event, &rtp_header));
+  EXPECT_EQ(0x12345678u, rtp_header.ssrc);
+  EXPECT_EQ(0x1234, rtp_header.sequence_number);
+  EXPECT_EQ(0x00010203u, rtp_header.timestamp);
+  EXPECT_EQ(96, rtp_header.payload_type);
+  EXPECT_TRUE(rtp_header.marker);
+  EXPECT_EQ(12, rtp_header.header_length);
+  EXPECT_EQ(static_cast<int>(sizeof(kRtpPacket)), rtp_header.packet_length);
+  PacerStateEvent other_type;
+  EXPECT_FALSE(ParsePacerState(event, &other_type));
+
+  ASSERT_TRUE(parser.ReadEvent(&event));
+  EXPECT_FALSE(event.incoming);
+  std::vector<std::pair<int, int> > packet_types;
+  ASSERT_TRUE(ParseRtcpPacketTypes(event, &packet_types));
+  ASSERT_EQ(2u, packet_types.size());
+  EXPECT_EQ(std::make_pair(201, 0), packet_types[0]);
+  EXPECT_EQ(std::make_pair(206, 1), packet_types[1]);
+
+  ASSERT_TRUE(parser.ReadEvent(&event));
+  RemoteBitrateEstimateEvent estimate;
+  ASSERT_TRUE(ParseRemoteBitrateEstimate(event, &estimate));
+  EXPECT_EQ(500000u, estimate.bitrate_bps);
+  EXPECT_EQ(450000u, estimate.incoming_bitrate_bps);
+  EXPECT_EQ(2, estimate.bandwidth_usage);
+
+  ASSERT_TRUE(parser.ReadEvent(&event));
+  BitrateControllerEvent update;
+  ASSERT_TRUE(ParseBitrateControllerUpdate(event, &update));
+  EXPECT_EQ(300000u, update.bitrate_bps);
+  EXPECT_EQ(120u, update.rtt_ms);
+  EXPECT_EQ(25, update.fraction_lost);
+
+  ASSERT_TRUE(parser.ReadEvent(&event));
+  PacerStateEvent pacer_state;
+  ASSERT_TRUE(ParsePacerState(event, &pacer_state));
+  EXPECT_EQ(17, pacer_state.queued_packets);
+  EXPECT_EQ(42, pacer_state.queue_ms);
+
+  ASSERT_TRUE(parser.ReadEvent(&event));
+  EXPECT_EQ(4, event.id);
+  JitterBufferEvent jitter_buffer_event;
+  ASSERT_TRUE(ParseJitterBufferEvent(event, &jitter_buffer_event));
+  EXPECT_EQ(RtcEventLog::kFrameDropped, jitter_buffer_event.event);
+  EXPECT_EQ(90000u, jitter_buffer_event.timestamp);
+  EXPECT_EQ(-1, jitter_buffer_event.value);
+
+  EXPECT_FALSE(parser.ReadEvent(&event));
+  EXPECT_FALSE(parser.truncated());
+}
+
+TEST_F(EventLogParserTest, DetectsTruncatedEvent) {
+  ASSERT_EQ(0, RtcEventLog::Start(file_name_.c_str()));
+  RtcEventLog::LogPacerState(1, 2);
+  RtcEventLog::LogPacerState(3, 4);
+  RtcEventLog::Stop();
+  // Cut off the last byte.
+  FILE* file = fopen(file_name_.c_str(), "rb");
+  ASSERT_TRUE(file != NULL);
+  std::vector<char> contents(1000);
+  contents.resize(fread(&contents[0], 1, contents.size(), file));
+  fclose(file);
+  file = fopen(file_name_.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  fwrite(&contents[0], 1, contents.size() - 1, file);
+  fclose(file);
+
+  RtcEventLogParser parser;
+  ASSERT_TRUE(parser.Open(file_name_));
+  RtcEvent event;
+  EXPECT_TRUE(parser.ReadEvent(&event));
+  EXPECT_FALSE(parser.ReadEvent(&event));
+  EXPECT_TRUE(parser.truncated());
+}
+
+TEST_F(EventLogParserTest, RejectsOtherFiles) {
+  FILE* file = fopen(file_name_.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  fprintf(file, "Not an event log\n");
+  fclose(file);
+  RtcEventLogParser parser;
+  EXPECT_FALSE(parser.Open(file_name_));
+}
+
+}  // namespace test
+}  // namespace webrtc
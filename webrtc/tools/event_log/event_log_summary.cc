@@ -0,0 +1,309 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tools/event_log/event_log_parser.h"
+#include "tools/simple_command_line_parser.h"
+
+namespace {
+
+struct RtpStreamStats {
+  RtpStreamStats()
+      : packets(0),
+        bytes(0),
+        payload_type(0),
+        first_time_us(0),
+        last_time_us(0),
+        first_sequence_number(0),
+        highest_sequence_number(0),
+        reordered(0) {}
+
+  int packets;
+  int64_t bytes;
+  int payload_type;
+  int64_t first_time_us;
+  int64_t last_time_us;
+  // Sequence numbers unwrapped to 64 bits.
+  int64_t first_sequence_number;
+  int64_t highest_sequence_number;
+  int reordered;
+};
+
+// Min, mean, max and percentiles of a series of values.
+class Distribution {
+ public:
+  void Add(int64_t value) { values_.push_back(value); }
+  bool empty() const { return values_.empty(); }
+
+  void Print(const char* name, const char* unit) {
+    if (values_.empty()) {
+      return;
+    }
+    std::sort(values_.begin(), values_.end());
+    int64_t sum = 0;
+    for (size_t i = 0; i < values_.size(); ++i) {
+      sum += values_[i];
+    }
+    printf("  %s: min %lld, mean %lld, p50 %lld, p95 %lld, max %lld %s\n",
+           name, static_cast<long long>(values_.front()),
+           static_cast<long long>(sum / static_cast<int64_t>(values_.size())),
+           static_cast<long long>(Percentile(50)),
+           static_cast<long long>(Percentile(95)),
+           static_cast<long long>(values_.back()), unit);
+  }
+
+ private:
+  int64_t Percentile(int percent) const {
+    return values_[(values_.size() - 1) * percent / 100];
+  }
+
+  std::vector<int64_t> values_;
+};
+
+const char* RtcpPacketTypeName(int packet_type, int format) {
+  switch (packet_type) {
+    case 200: return "SR";
+    case 201: return "RR";
+    case 202: return "SDES";
+    case 203: return "BYE";
+    case 204: return "APP";
+    case 205: return format == 1 ? "NACK" : "RTPFB";
+    case 206:
+      switch (format) {
+        case 1: return "PLI";
+        case 4: return "FIR";
+        case 15: return "REMB";
+        default: return "PSFB";
+      }
+    case 207: return "XR";
+    default: return "unknown";
+  }
+}
+
+const char* JitterBufferEventName(
+    webrtc::RtcEventLog::JitterBufferEvent event) {
+  switch (event) {
+    case webrtc::RtcEventLog::kFrameDecoded: return "frames decoded";
+    case webrtc::RtcEventLog::kLateFrameDropped: return "late frames dropped";
+    case webrtc::RtcEventLog::kFrameDropped: return "frames dropped";
+    case webrtc::RtcEventLog::kFlushed: return "flushes";
+    case webrtc::RtcEventLog::kKeyFrameRequested: return "key frame requests";
+  }
+  return "unknown";
+}
+
+class Summary {
+ public:
+  Summary()
+      : events_(0),
+        first_time_us_(0),
+        last_time_us_(0),
+        overuse_(0),
+        max_queued_packets_(0) {}
+
+  void Add(const webrtc::RtcEvent& event) {
+    if (events_ == 0) {
+      first_time_us_ = event.time_us;
+    }
+    ++events_;
+    first_time_us_ = std::min(first_time_us_, event.time_us);
+    last_time_us_ = std::max(last_time_us_, event.time_us);
+
+    webrtc::RtpHeaderEvent rtp_header;
+    webrtc::RemoteBitrateEstimateEvent estimate;
+    webrtc::BitrateControllerEvent update;
+    webrtc::PacerStateEvent pacer_state;
+    webrtc::JitterBufferEvent jitter_buffer_event;
+    std::vector<std::pair<int, int> > rtcp_packet_types;
+    if (webrtc::ParseRtpHeader(event, &rtp_header)) {
+      AddRtpHeader(event, rtp_header);
+    } else if (webrtc::ParseRtcpPacketTypes(event, &rtcp_packet_types)) {
+      for (size_t i = 0; i < rtcp_packet_types.size(); ++i) {
+        ++rtcp_counts_[std::make_pair(event.incoming, RtcpPacketTypeName(
+            rtcp_packet_types[i].first, rtcp_packet_types[i].second))];
+      }
+    } else if (webrtc::ParseRemoteBitrateEstimate(event, &estimate)) {
+      remote_estimate_kbps_.Add(estimate.bitrate_bps / 1000);
+      incoming_kbps_.Add(estimate.incoming_bitrate_bps / 1000);
+      // BandwidthUsage::kBwOverusing.
+      overuse_ += estimate.bandwidth_usage == 2 ? 1 : 0;
+    } else if (webrtc::ParseBitrateControllerUpdate(event, &update)) {
+      send_kbps_.Add(update.bitrate_bps / 1000);
+      rtt_ms_.Add(update.rtt_ms);
+      loss_percent_.Add(update.fraction_lost * 100 / 255);
+    } else if (webrtc::ParsePacerState(event, &pacer_state)) {
+      pacer_queue_ms_.Add(pacer_state.queue_ms);
+      max_queued_packets_ = std::max(max_queued_packets_,
+                                     pacer_state.queued_packets);
+    } else if (webrtc::ParseJitterBufferEvent(event, &jitter_buffer_event)) {
+      ++jitter_buffer_counts_[jitter_buffer_event.event];
+      if (jitter_buffer_event.event == webrtc::RtcEventLog::kFrameDecoded) {
+        decode_wait_ms_.Add(jitter_buffer_event.value);
+      }
+    }
+  }
+
+  void Print() {
+    const double duration_s = (last_time_us_ - first_time_us_) / 1e6;
+    printf("%d events over %.1f s\n", events_, duration_s);
+
+    printf("RTP streams:\n");
+    for (std::map<std::pair<bool, uint32_t>, RtpStreamStats>::iterator it =
+         rtp_streams_.begin(); it != rtp_streams_.end(); ++it) {
+      const RtpStreamStats& stats = it->second;
+      const double stream_s = (stats.last_time_us - stats.first_time_us) / 1e6;
+      printf("  %s SSRC %u, payload type %d: %d packets, %lld bytes",
+             it->first.first ? "incoming" : "outgoing", it->first.second,
+             stats.payload_type, stats.packets,
+             static_cast<long long>(stats.bytes));
+      if (stream_s > 0) {
+        printf(", %.0f kbps", stats.bytes * 8 / stream_s / 1000);
+      }
+      if (it->first.first) {
+        const int64_t expected = stats.highest_sequence_number -
+            stats.first_sequence_number + 1;
+        printf(", %lld lost, %d reordered",
+               static_cast<long long>(std::max<int64_t>(
+                   expected - stats.packets, 0)), stats.reordered);
+      }
+      printf("\n");
+    }
+
+    printf("RTCP packets:\n");
+    for (std::map<std::pair<bool, std::string>, int>::iterator it =
+         rtcp_counts_.begin(); it != rtcp_counts_.end(); ++it) {
+      printf("  %s %s: %d\n", it->first.first ? "incoming" : "outgoing",
+             it->first.second.c_str(), it->second);
+    }
+
+    printf("Remote bitrate estimator:\n");
+    remote_estimate_kbps_.Print("estimate", "kbps");
+    incoming_kbps_.Print("incoming bitrate", "kbps");
+    printf("  over-use detected in %d updates\n", overuse_);
+
+    printf("Bitrate controller:\n");
+    send_kbps_.Print("send bitrate", "kbps");
+    loss_percent_.Print("loss", "%");
+    rtt_ms_.Print("RTT", "ms");
+
+    printf("Pacer:\n");
+    pacer_queue_ms_.Print("oldest queued packet", "ms");
+    printf("  max %d packets queued\n", max_queued_packets_);
+
+    printf("Jitter buffer:\n");
+    for (std::map<int, int>::iterator it = jitter_buffer_counts_.begin();
+         it != jitter_buffer_counts_.end(); ++it) {
+      printf("  %s: %d\n", JitterBufferEventName(
+          static_cast<webrtc::RtcEventLog::JitterBufferEvent>(it->first)),
+          it->second);
+    }
+    decode_wait_ms_.Print("wait after last packet until decoding", "ms");
+  }
+
+ private:
+  void AddRtpHeader(const webrtc::RtcEvent& event,
+                    const webrtc::RtpHeaderEvent& rtp_header) {
+    RtpStreamStats& stats =
+        rtp_streams_[std::make_pair(event.incoming, rtp_header.ssrc)];
+    if (stats.packets == 0) {
+      stats.first_time_us = event.time_us;
+      stats.first_sequence_number = rtp_header.sequence_number;
+      stats.highest_sequence_number = rtp_header.sequence_number;
+    } else {
+      // Unwrap relative to the highest sequence number seen.
+      const int16_t delta = static_cast<int16_t>(
+          rtp_header.sequence_number -
+          static_cast<uint16_t>(stats.highest_sequence_number));
+      if (delta > 0) {
+        stats.highest_sequence_number += delta;
+      } else {
+        ++stats.reordered;
+      }
+    }
+    ++stats.packets;
+    stats.bytes += rtp_header.packet_length;
+    stats.payload_type = rtp_header.payload_type;
+    stats.last_time_us = event.time_us;
+  }
+
+  int events_;
+  int64_t first_time_us_;
+  int64_t last_time_us_;
+  // Keyed by incoming and SSRC.
+  std::map<std::pair<bool, uint32_t>, RtpStreamStats> rtp_streams_;
+  // Keyed by incoming and packet type.
+  std::map<std::pair<bool, std::string>, int> rtcp_counts_;
+  Distribution remote_estimate_kbps_;
+  Distribution incoming_kbps_;
+  int overuse_;
+  Distribution send_kbps_;
+  Distribution loss_percent_;
+  Distribution rtt_ms_;
+  Distribution pacer_queue_ms_;
+  int max_queued_packets_;
+  std::map<int, int> jitter_buffer_counts_;
+  Distribution decode_wait_ms_;
+};
+
+}  // namespace
+
+/*
+ * A tool summarizing RTC event log files, as written after
+ * webrtc::RtcEventLog::Start(): RTP streams and RTCP packets, bandwidth
+ * estimates, pacer queueing and jitter buffer decisions.
+ *
+ * Usage:
+ * event_log_summary --input_file=<name_of_file>
+ */
+int main(int argc, char** argv) {
+  std::string program_name = argv[0];
+  std::string usage = "Summarizes a WebRTC event log.\n"
+      "Example usage:\n" + program_name + " --input_file=event.log\n"
+      "Command line flags:\n"
+      "  - input_file(string): The event log file. Default: event.log\n";
+
+  webrtc::test::CommandLineParser parser;
+
+  // Init the parser and set the usage message
+  parser.Init(argc, argv);
+  parser.SetUsageMessage(usage);
+
+  parser.SetFlag("input_file", "event.log");
+  parser.SetFlag("help", "false");
+
+  parser.ProcessFlags();
+  if (parser.GetFlag("help") == "true") {
+    parser.PrintUsageMessage();
+    return 0;
+  }
+
+  webrtc::RtcEventLogParser log;
+  if (!log.Open(parser.GetFlag("input_file"))) {
+    fprintf(stderr, "Error: could not open %s as an event log.\n",
+            parser.GetFlag("input_file").c_str());
+    return -1;
+  }
+  Summary summary;
+  webrtc::RtcEvent event;
+  while (log.ReadEvent(&event)) {
+    summary.Add(event);
+  }
+  if (log.truncated()) {
+    fprintf(stderr, "Warning: the last event is truncated.\n");
+  }
+  summary.Print();
+  return 0;
+}
@@ -102,8 +102,45 @@
         'frame_editing/frame_editing.cc',
       ],
     }, # frame_editing
+    {
+      'target_name': 'event_log_parser',
+      'type': 'static_library',
+      'dependencies': [
+        '<(webrtc_root)/system_wrappers/source/system_wrappers.gyp:system_wrappers',
+      ],
+      'sources': [
+        'event_log/event_log_parser.cc',
+        'event_log/event_log_parser.h',
+      ],
+    }, # event_log_parser
+    {
+      'target_name': 'event_log_summary',
+      'type': 'executable',
+      'dependencies': [
+        'command_line_parser',
+        'event_log_parser',
+      ],
+      'sources': [
+        'event_log/event_log_summary.cc',
+      ],
+    }, # event_log_summary
   ],
   'conditions': [
+    ['enable_tracing==1', {
+      'targets' : [
+        {
+          'target_name': 'trace_decoder',
+          'type': 'executable',
+          'dependencies': [
+            'command_line_parser',
+            '<(webrtc_root)/system_wrappers/source/system_wrappers.gyp:system_wrappers',
+          ],
+          'sources': [
+            'trace_decoder/trace_decoder.cc',
+          ],
+        }, # trace_decoder
+      ], # targets
+    }], # enable_tracing
     ['include_tests==1', {
       'targets' : [
         {
@@ -111,12 +148,14 @@
           'type': 'executable',
           'dependencies': [
             'command_line_parser',
+            'event_log_parser',
             'frame_editing_lib',
             '<(webrtc_root)/test/test.gyp:test_support_main',
             '<(DEPTH)/testing/gtest.gyp:gtest',
           ],
           'sources': [
             'simple_command_line_parser_unittest.cc',
+            'event_log/event_log_parser_unittest.cc',
             'frame_editing/frame_editing_unittest.cc',
           ],
           # Disable warnings to enable Win64 build, issue 1323.
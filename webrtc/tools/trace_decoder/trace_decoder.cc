@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "system_wrappers/source/trace_impl.h"
+#include "tools/simple_command_line_parser.h"
+
+namespace {
+
+int DecodeFile(FILE* input, FILE* output) {
+  uint8_t file_header[webrtc::kTraceFileHeaderSize];
+  if (fread(file_header, 1, sizeof(file_header), input) !=
+      sizeof(file_header) ||
+      memcmp(file_header, webrtc::kTraceFileMagic,
+             sizeof(webrtc::kTraceFileMagic)) != 0) {
+    fprintf(stderr, "Error: not a binary trace file.\n");
+    return -1;
+  }
+  if (file_header[8] != webrtc::kTraceFileVersion) {
+    fprintf(stderr, "Error: unsupported trace file version %d.\n",
+            file_header[8]);
+    return -1;
+  }
+
+  uint32_t prev_api_ms = 0;
+  uint32_t prev_ms = 0;
+  int records = 0;
+  uint8_t record_header[webrtc::kTraceFileRecordHeaderSize];
+  while (fread(record_header, 1, sizeof(record_header), input) ==
+         sizeof(record_header)) {
+    webrtc::TraceRecord record;
+    webrtc::TraceImpl::ReadFileRecordHeader(record_header, &record);
+    char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+    if (record.message_length >= sizeof(message) ||
+        fread(message, 1, record.message_length, input) !=
+        record.message_length) {
+      fprintf(stderr, "Error: truncated record %d.\n", records);
+      return -1;
+    }
+    message[record.message_length] = '\0';
+
+    const webrtc::TraceLevel level =
+        static_cast<webrtc::TraceLevel>(record.level);
+    char prefix[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+    char* prefix_ptr = prefix;
+    prefix_ptr += webrtc::TraceImpl::AddLevel(prefix_ptr, level);
+    int length = webrtc::TraceImpl::AddTime(
+        prefix_ptr, record.time_us,
+        (level == webrtc::kTraceApiCall) ? &prev_api_ms : &prev_ms);
+    if (length < 0) {
+      fprintf(stderr, "Error: invalid time in record %d.\n", records);
+      return -1;
+    }
+    prefix_ptr += length;
+    prefix_ptr += webrtc::TraceImpl::AddModuleAndId(
+        prefix_ptr, static_cast<webrtc::TraceModule>(record.module),
+        record.id);
+    webrtc::TraceImpl::AddThreadId(prefix_ptr, record.thread_id);
+    fprintf(output, "%s%s\n", prefix, message);
+    ++records;
+  }
+  return records;
+}
+
+}  // namespace
+
+/*
+ * A tool converting binary trace files, as written after
+ * webrtc::Trace::SetBinaryTraceFile(), to the text format used by
+ * webrtc::Trace::SetTraceFile().
+ *
+ * Usage:
+ * trace_decoder --input_file=<name_of_file> --output_file=<name_of_file>
+ */
+int main(int argc, char** argv) {
+  std::string program_name = argv[0];
+  std::string usage = "Converts a binary WebRTC trace file to text.\n"
+      "Example usage:\n" + program_name + " --input_file=trace.bin "
+      "--output_file=trace.txt\n"
+      "Command line flags:\n"
+      "  - input_file(string): The binary trace file. Default: trace.bin\n"
+      "  - output_file(string): The text file to write. Leave empty to write "
+      "to stdout. Default: \"\"\n";
+
+  webrtc::test::CommandLineParser parser;
+
+  // Init the parser and set the usage message
+  parser.Init(argc, argv);
+  parser.SetUsageMessage(usage);
+
+  parser.SetFlag("input_file", "trace.bin");
+  parser.SetFlag("output_file", "");
+  parser.SetFlag("help", "false");
+
+  parser.ProcessFlags();
+  if (parser.GetFlag("help") == "true") {
+    parser.PrintUsageMessage();
+    return 0;
+  }
+
+  FILE* input = fopen(parser.GetFlag("input_file").c_str(), "rb");
+  if (input == NULL) {
+    fprintf(stderr, "Error: could not open %s.\n",
+            parser.GetFlag("input_file").c_str());
+    return -1;
+  }
+  FILE* output = stdout;
+  if (!parser.GetFlag("output_file").empty()) {
+    output = fopen(parser.GetFlag("output_file").c_str(), "w");
+    if (output == NULL) {
+      fprintf(stderr, "Error: could not open %s.\n",
+              parser.GetFlag("output_file").c_str());
+      fclose(input);
+      return -1;
+    }
+  }
+
+  int records = DecodeFile(input, output);
+
+  fclose(input);
+  if (output != stdout) {
+    fclose(output);
+  }
+  if (records < 0) {
+    return -1;
+  }
+  fprintf(stderr, "Decoded %d trace messages.\n", records);
+  return 0;
+}
@@ -115,6 +115,12 @@ class WEBRTC_DLLEXPORT ViEBase {
   // Stops receiving incoming RTP and RTCP packets on the specified channel.
   virtual int StopReceive(const int video_channel) = 0;
 
+  // Decodes and renders the channels created after this call on threads
+  // shared by all channels, one per core, which are woken up when a frame is
+  // ready. By default every channel has a decode and a render thread of its
+  // own, which are mostly idle when receiving many streams.
+  virtual int EnableSharedDecodeThreads(bool enable) = 0;
+
   // Retrieves the version information for VideoEngine and its components.
   virtual int GetVersion(char version[1024]) = 0;
 
@@ -23,6 +23,7 @@
 
 namespace webrtc {
 
+class RtcpAggregator;
 class Transport;
 class VideoEngine;
 
@@ -78,6 +79,14 @@ class WEBRTC_DLLEXPORT ViENetwork {
   // This function deregisters a used Transport for a specified channel.
   virtual int DeregisterSendTransport(const int video_channel) = 0;
 
+  // Sends the RTCP packets of this channel through |aggregator|, which merges
+  // them with those of the other channels using it. The aggregator must wrap
+  // the channel's send transport, be processed by the application on a
+  // ProcessThread and outlive its use by the channel. Fails if external
+  // encryption is registered on the channel. NULL sends RTCP directly again.
+  virtual int SetRtcpAggregator(const int video_channel,
+                                RtcpAggregator* aggregator) = 0;
+
   // When using external transport for a channel, received RTP packets should
   // be passed to VideoEngine using this function. The input should contain
   // the RTP header and payload.
@@ -27,6 +27,7 @@
 #include "video_engine/include/vie_errors.h"
 #include "video_engine/vie_impl.h"
 #include "video_engine/vie_input_manager.h"
+#include "video_engine/vie_render_manager.h"
 #include "video_engine/vie_shared_data.h"
 
 namespace webrtc {
@@ -384,6 +385,32 @@ int ViEBaseImpl::GetVersion(char version[1024]) {
   return 0;
 }
 
+int ViEBaseImpl::EnableSharedDecodeThreads(bool enable) {
+  WEBRTC_TRACE(kTraceApiCall, kTraceVideo, ViEId(shared_data_.instance_id()),
+               "%s(enable: %d)", __FUNCTION__, enable);
+  if (!shared_data_.Initialized()) {
+    shared_data_.SetLastError(kViENotInitialized);
+    WEBRTC_TRACE(kTraceError, kTraceVideo, ViEId(shared_data_.instance_id()),
+                 "%s - ViE instance %d not initialized", __FUNCTION__,
+                 shared_data_.instance_id());
+    return -1;
+  }
+
+  ProcessThread* decode_process_thread = NULL;
+  if (enable) {
+    decode_process_thread = shared_data_.decode_process_thread();
+    if (!decode_process_thread) {
+      shared_data_.SetLastError(kViEBaseUnknownError);
+      return -1;
+    }
+  }
+  shared_data_.channel_manager()->SetDecodeProcessThread(
+      decode_process_thread);
+  shared_data_.render_manager()->SetIncomingStreamProcessThread(
+      decode_process_thread);
+  return 0;
+}
+
 int ViEBaseImpl::LastError() {
   return shared_data_.LastErrorInternal();
 }
@@ -43,6 +43,7 @@ class ViEBaseImpl
   virtual int StopSend(const int video_channel);
   virtual int StartReceive(const int video_channel);
   virtual int StopReceive(const int video_channel);
+  virtual int EnableSharedDecodeThreads(bool enable);
   virtual int GetVersion(char version[1024]);
   virtual int LastError();
 
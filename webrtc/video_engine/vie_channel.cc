@@ -28,6 +28,7 @@
 #include "video_engine/include/vie_errors.h"
 #include "video_engine/include/vie_image_process.h"
 #include "video_engine/include/vie_rtp_rtcp.h"
+#include "video_engine/vie_decode_scheduler.h"
 #include "video_engine/vie_defines.h"
 
 namespace webrtc {
@@ -226,6 +227,7 @@ ViEChannel::~ViEChannel() {
   if (decode_thread_) {
     StopDecodeThread();
   }
+  decode_scheduler_.reset();
   // Release modules.
   VideoCodingModule::Destroy(&vcm_);
 }
@@ -1397,6 +1399,18 @@ int32_t ViEChannel::StartReceive() {
   return 0;
 }
 
+void ViEChannel::SetDecodeProcessThread(
+    ProcessThread* decode_process_thread) {
+  CriticalSectionScoped cs(callback_cs_.get());
+  assert(!decode_thread_);
+  if (decode_process_thread) {
+    decode_scheduler_.reset(new ViEDecodeScheduler(&vcm_,
+                                                   decode_process_thread));
+  } else {
+    decode_scheduler_.reset();
+  }
+}
+
 int32_t ViEChannel::StopReceive() {
   WEBRTC_TRACE(kTraceInfo, kTraceVideo, ViEId(engine_id_, channel_id_), "%s",
                __FUNCTION__);
@@ -1452,6 +1466,19 @@ int32_t ViEChannel::DeregisterSendTransport() {
   return 0;
 }
 
+int32_t ViEChannel::SetRtcpAggregator(RtcpAggregator* aggregator) {
+  WEBRTC_TRACE(kTraceInfo, kTraceVideo, ViEId(engine_id_, channel_id_),
+               "%s: 0x%p", __FUNCTION__, aggregator);
+
+  CriticalSectionScoped cs(callback_cs_.get());
+  if (vie_sender_.SetRtcpAggregator(aggregator) != 0) {
+    WEBRTC_TRACE(kTraceError, kTraceVideo, ViEId(engine_id_, channel_id_),
+                 "%s: external encryption registered", __FUNCTION__);
+    return -1;
+  }
+  return 0;
+}
+
 int32_t ViEChannel::ReceivedRTPPacket(
     const void* rtp_packet, const int32_t rtp_packet_length) {
   {
@@ -1716,6 +1743,9 @@ void ViEChannel::OnRttUpdate(uint32_t rtt) {
 }
 
 int32_t ViEChannel::StartDecodeThread() {
+  if (decode_scheduler_.get()) {
+    return decode_scheduler_->Start();
+  }
   // Start the decode thread
   if (decode_thread_) {
     // Already started.
@@ -1745,6 +1775,9 @@ int32_t ViEChannel::StartDecodeThread() {
 }
 
 int32_t ViEChannel::StopDecodeThread() {
+  if (decode_scheduler_.get()) {
+    return decode_scheduler_->Stop();
+  }
   if (!decode_thread_) {
     WEBRTC_TRACE(kTraceWarning, kTraceVideo, ViEId(engine_id_, channel_id_),
                  "%s: decode thread not running", __FUNCTION__);
@@ -1775,10 +1808,14 @@ int32_t ViEChannel::RegisterExternalEncryption(Encryption* encryption) {
     return -1;
   }
 
+  if (vie_sender_.RegisterExternalEncryption(encryption) != 0) {
+    WEBRTC_TRACE(kTraceError, kTraceVideo, ViEId(engine_id_, channel_id_),
+                 "%s: RTCP aggregator set", __FUNCTION__);
+    return -1;
+  }
   external_encryption_ = encryption;
 
   vie_receiver_.RegisterExternalDecryption(encryption);
-  vie_sender_.RegisterExternalEncryption(encryption);
 
   WEBRTC_TRACE(kTraceInfo, kTraceVideo, ViEId(engine_id_, channel_id_),
                "%s", "external encryption object registerd with channel=%d",
@@ -36,12 +36,14 @@ class CriticalSectionWrapper;
 class Encryption;
 class PacedSender;
 class ProcessThread;
+class RtcpAggregator;
 class RtpRtcp;
 class RtcpRttObserver;
 class ThreadWrapper;
 class VideoCodingModule;
 class VideoDecoder;
 class VideoRenderCallback;
+class ViEDecodeScheduler;
 class ViEDecoderObserver;
 class ViEEffectFilter;
 class ViENetworkObserver;
@@ -250,9 +252,18 @@ class ViEChannel
   int32_t StartReceive();
   int32_t StopReceive();
 
+  // Decodes on |decode_process_thread|, woken up when frames are ready,
+  // instead of on a decode thread of its own. Must be called before
+  // StartReceive() and |decode_process_thread| must outlive the channel.
+  void SetDecodeProcessThread(ProcessThread* decode_process_thread);
+
   int32_t RegisterSendTransport(Transport* transport);
   int32_t DeregisterSendTransport();
 
+  // Sends RTCP through |aggregator| instead of the send transport directly,
+  // see ViENetwork::SetRtcpAggregator().
+  int32_t SetRtcpAggregator(RtcpAggregator* aggregator);
+
   // Incoming packet from external transport.
   int32_t ReceivedRTPPacket(const void* rtp_packet,
                             const int32_t rtp_packet_length);
@@ -387,6 +398,8 @@ class ViEChannel
   bool decoder_reset_;
   bool wait_for_key_frame_;
   ThreadWrapper* decode_thread_;
+  // Replaces |decode_thread_| if set.
+  scoped_ptr<ViEDecodeScheduler> decode_scheduler_;
 
   Encryption* external_encryption_;
 
@@ -38,6 +38,7 @@ ViEChannelManager::ViEChannelManager(
       voice_sync_interface_(NULL),
       voice_engine_(NULL),
       module_process_thread_(NULL),
+      decode_process_thread_(NULL),
       over_use_detector_options_(options),
       bwe_mode_(RemoteBitrateEstimator::kSingleStreamEstimation) {
   WEBRTC_TRACE(kTraceMemory, kTraceVideo, ViEId(engine_id),
@@ -81,6 +82,12 @@ void ViEChannelManager::SetModuleProcessThread(
   module_process_thread_ = module_process_thread;
 }
 
+void ViEChannelManager::SetDecodeProcessThread(
+    ProcessThread* decode_process_thread) {
+  CriticalSectionScoped cs(channel_id_critsect_);
+  decode_process_thread_ = decode_process_thread;
+}
+
 int ViEChannelManager::CreateChannel(int* channel_id) {
   CriticalSectionScoped cs(channel_id_critsect_);
 
@@ -431,6 +438,9 @@ bool ViEChannelManager::CreateChannelObject(
                                            paced_sender,
                                            send_rtp_rtcp_module,
                                            sender);
+  if (decode_process_thread_) {
+    vie_channel->SetDecodeProcessThread(decode_process_thread_);
+  }
   if (vie_channel->Init() != 0) {
     WEBRTC_TRACE(kTraceError, kTraceVideo, ViEId(engine_id_),
                  "%s could not init channel", __FUNCTION__, channel_id);
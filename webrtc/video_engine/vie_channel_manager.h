@@ -49,6 +49,10 @@ class ViEChannelManager: private ViEManagerBase {
 
   void SetModuleProcessThread(ProcessThread* module_process_thread);
 
+  // Channels created after this call decode on |decode_process_thread|
+  // instead of on a decode thread each. NULL restores the latter.
+  void SetDecodeProcessThread(ProcessThread* decode_process_thread);
+
   // Creates a new channel. 'channel_id' will be the id of the created channel.
   int CreateChannel(int* channel_id);
 
@@ -135,6 +139,7 @@ class ViEChannelManager: private ViEManagerBase {
 
   VoiceEngine* voice_engine_;
   ProcessThread* module_process_thread_;
+  ProcessThread* decode_process_thread_;
   const OverUseDetectorOptions& over_use_detector_options_;
   RemoteBitrateEstimator::EstimationMode bwe_mode_;
 };
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video_engine/vie_decode_scheduler.h"
+
+#include "modules/utility/interface/process_thread.h"
+#include "modules/video_coding/main/interface/video_coding.h"
+#include "system_wrappers/interface/critical_section_wrapper.h"
+#include "system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+ViEDecodeScheduler::ViEDecodeScheduler(VideoCodingModule* vcm,
+                                       ProcessThread* process_thread)
+    : vcm_(vcm),
+      process_thread_(process_thread),
+      crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      running_(false),
+      frame_ready_(false),
+      next_frame_due_ms_(-1),
+      last_process_time_ms_(TickTime::MillisecondTimestamp()) {
+}
+
+ViEDecodeScheduler::~ViEDecodeScheduler() {
+  Stop();
+}
+
+int32_t ViEDecodeScheduler::Start() {
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    if (running_) {
+      return 0;
+    }
+    running_ = true;
+    // Look for frames inserted before starting right away.
+    frame_ready_ = true;
+  }
+  vcm_->RegisterFrameReadyCallback(this);
+  if (process_thread_->RegisterModule(this) != 0) {
+    vcm_->RegisterFrameReadyCallback(NULL);
+    CriticalSectionScoped cs(crit_sect_.get());
+    running_ = false;
+    return -1;
+  }
+  return 0;
+}
+
+int32_t ViEDecodeScheduler::Stop() {
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    if (!running_) {
+      return 0;
+    }
+    running_ = false;
+  }
+  // No more wake ups once the callback is deregistered, and no more decoding
+  // once the module is.
+  vcm_->RegisterFrameReadyCallback(NULL);
+  process_thread_->DeRegisterModule(this);
+  return 0;
+}
+
+void ViEDecodeScheduler::FrameReady() {
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    frame_ready_ = true;
+  }
+  process_thread_->WakeUp(this);
+}
+
+void ViEDecodeScheduler::FrameNotDue(uint32_t wait_ms) {
+  // Called from Decode() in Process(), which asks for the new time next.
+  CriticalSectionScoped cs(crit_sect_.get());
+  next_frame_due_ms_ = TickTime::MillisecondTimestamp() + wait_ms;
+}
+
+int32_t ViEDecodeScheduler::TimeUntilNextProcess() {
+  CriticalSectionScoped cs(crit_sect_.get());
+  if (frame_ready_) {
+    return 0;
+  }
+  int64_t next_process_ms = last_process_time_ms_ + kMaxDecodeIntervalMs;
+  if (next_frame_due_ms_ >= 0 && next_frame_due_ms_ < next_process_ms) {
+    next_process_ms = next_frame_due_ms_;
+  }
+  return static_cast<int32_t>(next_process_ms -
+                              TickTime::MillisecondTimestamp());
+}
+
+int32_t ViEDecodeScheduler::Process() {
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    frame_ready_ = false;
+    next_frame_due_ms_ = -1;
+    last_process_time_ms_ = TickTime::MillisecondTimestamp();
+  }
+  const int32_t ret = vcm_->Decode(0);
+
+  if (ret == VCM_OK) {
+    // There may be more frames ready for decoding.
+    CriticalSectionScoped cs(crit_sect_.get());
+    frame_ready_ = true;
+  }
+  return 0;
+}
+
+}  // namespace webrtc
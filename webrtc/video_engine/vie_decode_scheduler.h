@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// ViEDecodeScheduler decodes the frames of a VideoCodingModule on a shared
+// ProcessThread, as an alternative to a decode thread per channel blocking in
+// VideoCodingModule::Decode().
+
+#ifndef WEBRTC_VIDEO_ENGINE_VIE_DECODE_SCHEDULER_H_
+#define WEBRTC_VIDEO_ENGINE_VIE_DECODE_SCHEDULER_H_
+
+#include "modules/interface/module.h"
+#include "modules/video_coding/main/interface/video_coding_defines.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+class ProcessThread;
+class VideoCodingModule;
+
+class ViEDecodeScheduler : public Module, public VCMFrameReadyCallback {
+ public:
+  enum {
+    // The interval to call Decode() at when no frame has been signaled ready
+    // or due, for frames which become decodable without a signal, e.g.
+    // incomplete frames.
+    kMaxDecodeIntervalMs = 50,
+  };
+
+  ViEDecodeScheduler(VideoCodingModule* vcm, ProcessThread* process_thread);
+  ~ViEDecodeScheduler();
+
+  // Registers with the VCM and the process thread and starts decoding.
+  int32_t Start();
+  // Stops decoding. No frame is being decoded once this returns.
+  int32_t Stop();
+
+  // Implements VCMFrameReadyCallback.
+  virtual void FrameReady();
+  virtual void FrameNotDue(uint32_t wait_ms);
+
+  // Implements Module.
+  virtual int32_t TimeUntilNextProcess();
+  virtual int32_t Process();
+
+ private:
+  VideoCodingModule* vcm_;
+  ProcessThread* process_thread_;
+  scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  bool running_;
+  // Set when a frame has been signaled, cleared when Process() is called.
+  bool frame_ready_;
+  // The time the next frame is due for decoding, as reported by the last
+  // Decode() call, or -1 if unknown.
+  int64_t next_frame_due_ms_;
+  int64_t last_process_time_ms_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEO_ENGINE_VIE_DECODE_SCHEDULER_H_
@@ -0,0 +1,417 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(WEBRTC_LINUX)
+#include <dirent.h>
+#endif
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "webrtc/modules/utility/interface/process_thread.h"
+#include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
+#include "webrtc/modules/video_coding/main/interface/video_coding.h"
+#include "webrtc/modules/video_render/incoming_video_stream.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/video_engine/vie_decode_scheduler.h"
+
+namespace webrtc {
+namespace {
+
+// Decoder which measures the time from the insertion of a frame, given by its
+// payload, until it's decoded.
+class FakeDecoder : public VideoDecoder {
+ public:
+  explicit FakeDecoder(EventWrapper* event)
+      : crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+        event_(event),
+        render_stream_(NULL),
+        render_delay_ms_(0),
+        num_decoded_(0),
+        total_delay_us_(0) {}
+
+  virtual int32_t InitDecode(const VideoCodec* codec_settings,
+                             int32_t number_of_cores) {
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+  virtual int32_t Decode(const EncodedImage& input_image,
+                         bool missing_frames,
+                         const RTPFragmentationHeader* fragmentation,
+                         const CodecSpecificInfo* codec_specific_info,
+                         int64_t render_time_ms) {
+    int64_t insert_time_us = 0;
+    if (input_image._length >= sizeof(insert_time_us)) {
+      memcpy(&insert_time_us, input_image._buffer, sizeof(insert_time_us));
+    }
+    const int64_t delay_us = TickTime::MicrosecondTimestamp() -
+        insert_time_us;
+    IncomingVideoStream* render_stream = NULL;
+    {
+      CriticalSectionScoped cs(crit_sect_.get());
+      ++num_decoded_;
+      total_delay_us_ += delay_us;
+      if (event_) {
+        event_->Set();
+      }
+      render_stream = render_stream_;
+    }
+    if (render_stream) {
+      SleepMs(render_delay_ms_);
+      I420VideoFrame frame;
+      frame.CreateEmptyFrame(16, 16, 16, 8, 8);
+      frame.set_render_time_ms(TickTime::MillisecondTimestamp());
+      render_stream->RenderFrame(0, frame);
+    }
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+  virtual int32_t RegisterDecodeCompleteCallback(
+      DecodedImageCallback* callback) {
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+  virtual int32_t Release() { return WEBRTC_VIDEO_CODEC_OK; }
+  virtual int32_t Reset() { return WEBRTC_VIDEO_CODEC_OK; }
+
+  // Renders a frame to |stream| for each decoded frame, |delay_ms| after
+  // signaling the event.
+  void set_render_stream(IncomingVideoStream* stream, int delay_ms) {
+    CriticalSectionScoped cs(crit_sect_.get());
+    render_stream_ = stream;
+    render_delay_ms_ = delay_ms;
+  }
+
+  int num_decoded() const {
+    CriticalSectionScoped cs(crit_sect_.get());
+    return num_decoded_;
+  }
+  int64_t total_delay_us() const {
+    CriticalSectionScoped cs(crit_sect_.get());
+    return total_delay_us_;
+  }
+
+ private:
+  scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  EventWrapper* event_;
+  IncomingVideoStream* render_stream_;
+  int render_delay_ms_;
+  int num_decoded_;
+  int64_t total_delay_us_;
+};
+
+// A receiving VCM with a FakeDecoder, fed one packet frames.
+class Stream {
+ public:
+  explicit Stream(EventWrapper* event)
+      : vcm_(VideoCodingModule::Create(0)),
+        decoder_(event),
+        sequence_number_(0),
+        timestamp_(0) {
+    vcm_->InitializeReceiver();
+    vcm_->Codec(kVideoCodecVP8, &codec_);
+    vcm_->RegisterReceiveCodec(&codec_, 1);
+    vcm_->RegisterExternalDecoder(&decoder_, codec_.plType, true);
+  }
+  ~Stream() { VideoCodingModule::Destroy(vcm_); }
+
+  // Inserts a frame with the current time as payload.
+  int32_t InsertFrame() {
+    uint8_t payload[sizeof(int64_t)];
+    const int64_t now_us = TickTime::MicrosecondTimestamp();
+    memcpy(payload, &now_us, sizeof(now_us));
+    WebRtcRTPHeader rtp_info;
+    memset(&rtp_info, 0, sizeof(rtp_info));
+    rtp_info.frameType = sequence_number_ == 0 ? kVideoFrameKey :
+        kVideoFrameDelta;
+    rtp_info.header.timestamp = timestamp_;
+    rtp_info.header.sequenceNumber = sequence_number_;
+    rtp_info.header.markerBit = true;
+    rtp_info.header.payloadType = codec_.plType;
+    rtp_info.type.Video.codec = kRTPVideoVP8;
+    rtp_info.type.Video.codecHeader.VP8.InitRTPVideoHeaderVP8();
+    rtp_info.type.Video.isFirstPacket = true;
+    ++sequence_number_;
+    timestamp_ += 90000 / 30;
+    return vcm_->IncomingPacket(payload, sizeof(payload), rtp_info);
+  }
+
+  VideoCodingModule* vcm() { return vcm_; }
+  FakeDecoder& decoder() { return decoder_; }
+
+ private:
+  VideoCodingModule* vcm_;
+  VideoCodec codec_;
+  FakeDecoder decoder_;
+  uint16_t sequence_number_;
+  uint32_t timestamp_;
+};
+
+// Signals |event| for each rendered frame.
+class FakeRenderer : public VideoRenderCallback {
+ public:
+  explicit FakeRenderer(EventWrapper* event) : event_(event) {}
+  virtual int32_t RenderFrame(const uint32_t stream_id,
+                              I420VideoFrame& video_frame) {
+    event_->Set();
+    return 0;
+  }
+
+ private:
+  EventWrapper* event_;
+};
+
+bool DecodeThreadFunction(void* obj) {
+  static_cast<VideoCodingModule*>(obj)->Decode(50);
+  return true;
+}
+
+// Returns the number of threads of the process, or -1 if unknown.
+int NumberOfThreads() {
+#if defined(WEBRTC_LINUX)
+  DIR* dir = opendir("/proc/self/task");
+  if (!dir) {
+    return -1;
+  }
+  int threads = 0;
+  while (dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      ++threads;
+    }
+  }
+  closedir(dir);
+  return threads;
+#else
+  return -1;
+#endif
+}
+
+// Returns the number of voluntary and involuntary context switches of the
+// process so far, or -1 if unknown.
+int64_t NumberOfContextSwitches() {
+#if !defined(_WIN32)
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+  return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+  return -1;
+#endif
+}
+
+}  // namespace
+
+TEST(ViEDecodeSchedulerTest, ProcessesWhenFrameReady) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  Stream stream(NULL);
+  ViEDecodeScheduler scheduler(stream.vcm(), thread);
+
+  // No frame to decode, decode again after the maximum interval.
+  EXPECT_EQ(0, scheduler.Process());
+  EXPECT_GT(scheduler.TimeUntilNextProcess(), 20);
+
+  scheduler.FrameReady();
+  EXPECT_EQ(0, scheduler.TimeUntilNextProcess());
+
+  // Still no frame, back to the maximum interval.
+  EXPECT_EQ(0, scheduler.Process());
+  EXPECT_GT(scheduler.TimeUntilNextProcess(), 20);
+
+  // A frame waiting for its render time is decoded when it's due.
+  scheduler.FrameNotDue(20);
+  EXPECT_GT(scheduler.TimeUntilNextProcess(), 0);
+  EXPECT_LE(scheduler.TimeUntilNextProcess(), 20);
+
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ViEDecodeSchedulerTest, DecodesOnProcessThread) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  ASSERT_EQ(0, thread->Start());
+  scoped_ptr<EventWrapper> decoded(EventWrapper::Create());
+  Stream stream(decoded.get());
+  ViEDecodeScheduler scheduler(stream.vcm(), thread);
+  ASSERT_EQ(0, scheduler.Start());
+
+  ASSERT_EQ(VCM_OK, stream.InsertFrame());
+  EXPECT_EQ(kEventSignaled, decoded->Wait(1000));
+  EXPECT_EQ(1, stream.decoder().num_decoded());
+
+  // Nothing is decoded once stopped.
+  EXPECT_EQ(0, scheduler.Stop());
+  SleepMs(1000 / 30);
+  ASSERT_EQ(VCM_OK, stream.InsertFrame());
+  EXPECT_EQ(kEventTimeout,
+            decoded->Wait(2 * ViEDecodeScheduler::kMaxDecodeIntervalMs));
+  EXPECT_EQ(1, stream.decoder().num_decoded());
+
+  EXPECT_EQ(0, thread->Stop());
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+TEST(ViEDecodeSchedulerTest, RendersNewFrameOnProcessThreadRightAway) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread();
+  ASSERT_EQ(0, thread->Start());
+  scoped_ptr<EventWrapper> rendered(EventWrapper::Create());
+  FakeRenderer renderer(rendered.get());
+  IncomingVideoStream render_stream(0, 0);
+  ASSERT_EQ(0, render_stream.SetProcessThread(thread));
+  ASSERT_EQ(0, render_stream.SetRenderCallback(&renderer));
+  ASSERT_EQ(0, render_stream.Start());
+  // Let the stream find its buffer empty, so that it waits for the maximum
+  // time before looking again.
+  SleepMs(20);
+
+  I420VideoFrame frame;
+  frame.CreateEmptyFrame(16, 16, 16, 8, 8);
+  frame.set_render_time_ms(TickTime::MillisecondTimestamp());
+  const int64_t start_ms = TickTime::MillisecondTimestamp();
+  ASSERT_EQ(0, render_stream.RenderFrame(0, frame));
+  EXPECT_EQ(kEventSignaled, rendered->Wait(1000));
+  EXPECT_LT(TickTime::MillisecondTimestamp() - start_ms, 50);
+
+  EXPECT_EQ(0, render_stream.Stop());
+  EXPECT_EQ(0, thread->Stop());
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+// Stops a stream rendering on the thread it's decoded on, while a decoded
+// frame is being delivered to it.
+TEST(ViEDecodeSchedulerTest, StopsRendererWhileDecodingOnSharedThread) {
+  ProcessThread* thread = ProcessThread::CreateProcessThread(1);
+  ASSERT_EQ(0, thread->Start());
+  scoped_ptr<EventWrapper> decoded(EventWrapper::Create());
+  scoped_ptr<EventWrapper> rendered(EventWrapper::Create());
+  FakeRenderer renderer(rendered.get());
+  IncomingVideoStream render_stream(0, 0);
+  ASSERT_EQ(0, render_stream.SetProcessThread(thread));
+  ASSERT_EQ(0, render_stream.SetRenderCallback(&renderer));
+  ASSERT_EQ(0, render_stream.Start());
+
+  Stream stream(decoded.get());
+  stream.decoder().set_render_stream(&render_stream, 50);
+  ViEDecodeScheduler scheduler(stream.vcm(), thread);
+  ASSERT_EQ(0, scheduler.Start());
+  ASSERT_EQ(VCM_OK, stream.InsertFrame());
+  ASSERT_EQ(kEventSignaled, decoded->Wait(1000));
+
+  // The decoder is about to deliver the frame on the process thread.
+  EXPECT_EQ(0, render_stream.Stop());
+  EXPECT_EQ(0, scheduler.Stop());
+  EXPECT_EQ(1, stream.decoder().num_decoded());
+  EXPECT_EQ(kEventTimeout, rendered->Wait(0));
+  EXPECT_EQ(0, thread->Stop());
+  ProcessThread::DestroyProcessThread(thread);
+}
+
+// Receives many 30 fps streams, decoded either on a thread per stream, which
+// blocks in Decode(), or on shared process threads, one per core. Reports the
+// number of threads, the context switches per decoded frame and the time from
+// inserting a frame until it's decoded.
+TEST(ViEDecodeSchedulerTest, DISABLED_ManyStreamsBenchmark) {
+  const int kNumStreams = 200;
+  const int kNumFrames = 60;
+  const int kFrameIntervalMs = 1000 / 30;
+  const int num_cores = CpuInfo::DetectNumberOfCores();
+
+  printf("%d streams, %d frames each, %d cores\n", kNumStreams, kNumFrames,
+         num_cores);
+  for (int shared = 0; shared <= 1; ++shared) {
+    std::vector<Stream*> streams;
+    for (int i = 0; i < kNumStreams; ++i) {
+      streams.push_back(new Stream(NULL));
+    }
+
+    std::vector<ThreadWrapper*> decode_threads;
+    std::vector<ViEDecodeScheduler*> schedulers;
+    ProcessThread* process_thread = NULL;
+    if (shared) {
+      process_thread = ProcessThread::CreateProcessThread(num_cores);
+      ASSERT_EQ(0, process_thread->Start());
+      for (int i = 0; i < kNumStreams; ++i) {
+        schedulers.push_back(new ViEDecodeScheduler(streams[i]->vcm(),
+                                                    process_thread));
+        ASSERT_EQ(0, schedulers[i]->Start());
+      }
+    } else {
+      for (int i = 0; i < kNumStreams; ++i) {
+        decode_threads.push_back(ThreadWrapper::CreateThread(
+            DecodeThreadFunction, streams[i]->vcm(), kHighestPriority,
+            "DecodingThread"));
+        unsigned int thread_id = 0;
+        ASSERT_TRUE(decode_threads[i]->Start(thread_id));
+      }
+    }
+    const int num_threads = NumberOfThreads();
+
+    const int64_t start_switches = NumberOfContextSwitches();
+    int64_t next_frame_ms = TickTime::MillisecondTimestamp();
+    for (int frame = 0; frame < kNumFrames; ++frame) {
+      for (int i = 0; i < kNumStreams; ++i) {
+        EXPECT_EQ(VCM_OK, streams[i]->InsertFrame());
+      }
+      next_frame_ms += kFrameIntervalMs;
+      const int64_t wait_ms = next_frame_ms -
+          TickTime::MillisecondTimestamp();
+      if (wait_ms > 0) {
+        SleepMs(static_cast<int>(wait_ms));
+      }
+    }
+    // Let the last frames be decoded.
+    SleepMs(2 * kFrameIntervalMs);
+    const int64_t switches = NumberOfContextSwitches() - start_switches;
+
+    // Let all threads finish their current wait in parallel.
+    for (size_t i = 0; i < decode_threads.size(); ++i) {
+      decode_threads[i]->SetNotAlive();
+    }
+    for (size_t i = 0; i < decode_threads.size(); ++i) {
+      EXPECT_TRUE(decode_threads[i]->Stop());
+      delete decode_threads[i];
+    }
+    for (size_t i = 0; i < schedulers.size(); ++i) {
+      EXPECT_EQ(0, schedulers[i]->Stop());
+      delete schedulers[i];
+    }
+    if (process_thread) {
+      EXPECT_EQ(0, process_thread->Stop());
+      ProcessThread::DestroyProcessThread(process_thread);
+    }
+
+    int decoded = 0;
+    int64_t total_delay_us = 0;
+    for (int i = 0; i < kNumStreams; ++i) {
+      decoded += streams[i]->decoder().num_decoded();
+      total_delay_us += streams[i]->decoder().total_delay_us();
+      delete streams[i];
+    }
+    EXPECT_GT(decoded, 0);
+    printf("%s: %d threads, %d decoded frames, %.2f context switches per "
+           "frame, %.1f us average decode delay\n",
+           shared ? "Shared process threads" : "Decode thread per stream",
+           num_threads, decoded,
+           static_cast<double>(switches) / std::max(decoded, 1),
+           static_cast<double>(total_delay_us) / std::max(decoded, 1));
+  }
+}
+
+}  // namespace webrtc
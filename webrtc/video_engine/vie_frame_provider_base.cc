@@ -60,7 +60,8 @@ void ViEFrameProviderBase::DeliverFrame(
       // We don't have to copy the frame.
       frame_callbacks_.front()->DeliverFrame(id_, video_frame, num_csrcs, CSRC);
     } else {
-      // Make a copy of the frame for all callbacks.callback
+      // Make a copy of the frame for all callbacks. The copy shares the plane
+      // buffers, which are only copied if a callback writes to them.
       for (FrameCallbacks::iterator it = frame_callbacks_.begin();
            it != frame_callbacks_.end(); ++it) {
         if (!extra_frame_.get()) {
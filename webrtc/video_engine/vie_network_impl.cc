@@ -155,6 +155,34 @@ int ViENetworkImpl::DeregisterSendTransport(const int video_channel) {
   return 0;
 }
 
+int ViENetworkImpl::SetRtcpAggregator(const int video_channel,
+                                      RtcpAggregator* aggregator) {
+  WEBRTC_TRACE(kTraceApiCall, kTraceVideo,
+               ViEId(shared_data_->instance_id(), video_channel),
+               "%s(channel: %d)", __FUNCTION__, video_channel);
+  if (!shared_data_->Initialized()) {
+    shared_data_->SetLastError(kViENotInitialized);
+    WEBRTC_TRACE(kTraceError, kTraceVideo, ViEId(shared_data_->instance_id()),
+                 "%s - ViE instance %d not initialized", __FUNCTION__,
+                 shared_data_->instance_id());
+    return -1;
+  }
+  ViEChannelManagerScoped cs(*(shared_data_->channel_manager()));
+  ViEChannel* vie_channel = cs.Channel(video_channel);
+  if (!vie_channel) {
+    WEBRTC_TRACE(kTraceError, kTraceVideo,
+                 ViEId(shared_data_->instance_id(), video_channel),
+                 "%s Channel doesn't exist", __FUNCTION__);
+    shared_data_->SetLastError(kViENetworkInvalidChannelId);
+    return -1;
+  }
+  if (vie_channel->SetRtcpAggregator(aggregator) != 0) {
+    shared_data_->SetLastError(kViENetworkUnknownError);
+    return -1;
+  }
+  return 0;
+}
+
 int ViENetworkImpl::ReceivedRTPPacket(const int video_channel, const void* data,
                                       const int length) {
   WEBRTC_TRACE(kTraceApiCall, kTraceVideo,
@@ -30,6 +30,8 @@ class ViENetworkImpl
   virtual int RegisterSendTransport(const int video_channel,
                                     Transport& transport);
   virtual int DeregisterSendTransport(const int video_channel);
+  virtual int SetRtcpAggregator(const int video_channel,
+                                RtcpAggregator* aggregator);
   virtual int ReceivedRTPPacket(const int video_channel,
                                 const void* data,
                                 const int length);
@@ -34,7 +34,8 @@ ViERenderer* ViERenderManagerScoped::Renderer(int32_t render_id) const {
 ViERenderManager::ViERenderManager(int32_t engine_id)
     : list_cs_(CriticalSectionWrapper::CreateCriticalSection()),
       engine_id_(engine_id),
-      use_external_render_module_(false) {
+      use_external_render_module_(false),
+      incoming_stream_process_thread_(NULL) {
   WEBRTC_TRACE(webrtc::kTraceMemory, webrtc::kTraceVideo, ViEId(engine_id),
                "ViERenderManager::ViERenderManager(engine_id: %d) - "
                "Constructor", engine_id);
@@ -133,6 +134,8 @@ ViERenderer* ViERenderManager::AddRenderStream(const int32_t render_id,
     }
     render_list_.PushBack(static_cast<void*>(render_module));
   }
+  render_module->SetIncomingStreamProcessThread(
+      incoming_stream_process_thread_);
 
   ViERenderer* vie_renderer = ViERenderer::CreateViERenderer(render_id,
                                                              engine_id_,
@@ -150,6 +153,12 @@ ViERenderer* ViERenderManager::AddRenderStream(const int32_t render_id,
   return vie_renderer;
 }
 
+void ViERenderManager::SetIncomingStreamProcessThread(
+    ProcessThread* process_thread) {
+  CriticalSectionScoped cs(list_cs_.get());
+  incoming_stream_process_thread_ = process_thread;
+}
+
 int32_t ViERenderManager::RemoveRenderStream(
     const int32_t render_id) {
   // We need exclusive right to the items in the render manager to delete a
@@ -21,6 +21,7 @@
 namespace webrtc {
 
 class CriticalSectionWrapper;
+class ProcessThread;
 class RWLockWrapper;
 class VideoRender;
 class VideoRenderCallback;
@@ -45,6 +46,10 @@ class ViERenderManager : private ViEManagerBase {
 
   int32_t RemoveRenderStream(int32_t render_id);
 
+  // Render streams added after this call render on |process_thread| instead
+  // of on a thread each. NULL restores the latter.
+  void SetIncomingStreamProcessThread(ProcessThread* process_thread);
+
  private:
   // Returns a pointer to the render module if it exists in the render list.
   // Assumed protected.
@@ -58,6 +63,7 @@ class ViERenderManager : private ViEManagerBase {
   MapWrapper stream_to_vie_renderer_;  // Protected by ViEManagerBase.
   ListWrapper render_list_;
   bool use_external_render_module_;
+  ProcessThread* incoming_stream_process_thread_;
 };
 
 class ViERenderManagerScoped: private ViEManagerScopedBase {
@@ -12,6 +12,7 @@
 
 #include <cassert>
 
+#include "modules/rtp_rtcp/interface/rtcp_aggregator.h"
 #include "modules/utility/interface/rtp_dump.h"
 #include "system_wrappers/interface/critical_section_wrapper.h"
 #include "system_wrappers/interface/trace.h"
@@ -24,6 +25,7 @@ ViESender::ViESender(int channel_id)
       external_encryption_(NULL),
       encryption_buffer_(NULL),
       transport_(NULL),
+      rtcp_aggregator_(NULL),
       rtp_dump_(NULL) {
 }
 
@@ -42,7 +44,7 @@ ViESender::~ViESender() {
 
 int ViESender::RegisterExternalEncryption(Encryption* encryption) {
   CriticalSectionScoped cs(critsect_.get());
-  if (external_encryption_) {
+  if (external_encryption_ || rtcp_aggregator_) {
     return -1;
   }
   encryption_buffer_ = new uint8_t[kViEMaxMtu];
@@ -84,6 +86,17 @@ int ViESender::DeregisterSendTransport() {
   return 0;
 }
 
+int ViESender::SetRtcpAggregator(RtcpAggregator* aggregator) {
+  CriticalSectionScoped cs(critsect_.get());
+  if (aggregator && external_encryption_) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideo, channel_id_,
+                 "SetRtcpAggregator: External encryption is registered");
+    return -1;
+  }
+  rtcp_aggregator_ = aggregator;
+  return 0;
+}
+
 int ViESender::StartRTPDump(const char file_nameUTF8[1024]) {
   CriticalSectionScoped cs(critsect_.get());
   if (rtp_dump_) {
@@ -127,80 +140,140 @@ int ViESender::StopRTPDump() {
 }
 
 int ViESender::SendPacket(int vie_id, const void* data, int len) {
-  CriticalSectionScoped cs(critsect_.get());
-  if (!transport_) {
-    // No transport
-    return -1;
-  }
-  assert(ChannelId(vie_id) == channel_id_);
-
   // TODO(mflodman) Change decrypt to get rid of this cast.
   void* tmp_ptr = const_cast<void*>(data);
-  unsigned char* send_packet = static_cast<unsigned char*>(tmp_ptr);
+  return DeliverPacket(vie_id, static_cast<uint8_t*>(tmp_ptr), len, 0, false);
+}
 
-  // Data length for packets sent to possible encryption and to the transport.
-  int send_packet_length = len;
+int ViESender::SendRTCPPacket(int vie_id, const void* data, int len) {
+  // TODO(mflodman) Change decrypt to get rid of this cast.
+  void* tmp_ptr = const_cast<void*>(data);
+  return DeliverPacket(vie_id, static_cast<uint8_t*>(tmp_ptr), len, 0, true);
+}
 
-  if (rtp_dump_) {
-    rtp_dump_->DumpPacket(send_packet, send_packet_length);
-  }
+int ViESender::SendWritablePacket(int vie_id, void* data, int len,
+                                  int capacity) {
+  return DeliverPacket(vie_id, static_cast<uint8_t*>(data), len, capacity,
+                       false);
+}
 
-  if (external_encryption_) {
-    // Encryption buffer size.
-    int encrypted_packet_length = kViEMaxMtu;
+int ViESender::SendWritableRTCPPacket(int vie_id, void* data, int len,
+                                      int capacity) {
+  return DeliverPacket(vie_id, static_cast<uint8_t*>(data), len, capacity,
+                       true);
+}
 
-    external_encryption_->encrypt(channel_id_, send_packet, encryption_buffer_,
-                                  send_packet_length, &encrypted_packet_length);
-    send_packet = encryption_buffer_;
-    send_packet_length = encrypted_packet_length;
+void ViESender::SendWritablePackets(int vie_id, unsigned char* const* data,
+                                    const int* len, int capacity,
+                                    int* bytes_sent, int num_packets) {
+  if (num_packets <= 0) {
+    return;
   }
-  const int bytes_sent = transport_->SendPacket(channel_id_, send_packet,
-                                                send_packet_length);
-  if (bytes_sent != send_packet_length) {
-    WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideo, channel_id_,
-                 "ViESender::SendPacket - Transport failed to send RTP packet");
+  {
+    CriticalSectionScoped cs(critsect_.get());
+    assert(ChannelId(vie_id) == channel_id_);
+    int tail_room = 0;
+    if (external_encryption_) {
+      tail_room = external_encryption_->in_place_tail_room();
+      for (int i = 0; tail_room >= 0 && i < num_packets; ++i) {
+        if (len[i] + tail_room > capacity) {
+          tail_room = -1;
+        }
+      }
+    }
+    if (transport_ && tail_room >= 0) {
+      if (rtp_dump_) {
+        for (int i = 0; i < num_packets; ++i) {
+          rtp_dump_->DumpPacket(data[i], len[i]);
+        }
+      }
+      const int* send_lengths = len;
+      if (external_encryption_) {
+        // The packets are ours to modify, encrypt them where they are.
+        encrypted_lengths_.resize(num_packets);
+        external_encryption_->encrypt_in_place_batch(
+            channel_id_, data, len, &encrypted_lengths_[0], num_packets);
+        send_lengths = &encrypted_lengths_[0];
+      }
+      transport_->SendWritablePackets(channel_id_, data, send_lengths,
+                                      capacity, bytes_sent, num_packets);
+      for (int i = 0; i < num_packets; ++i) {
+        if (bytes_sent[i] != send_lengths[i]) {
+          WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideo, channel_id_,
+                       "ViESender::SendWritablePackets - Transport failed to "
+                       "send RTP packet");
+        }
+      }
+      return;
+    }
+  }
+  // No transport, or the packets have to be copied to be encrypted.
+  for (int i = 0; i < num_packets; ++i) {
+    bytes_sent[i] = DeliverPacket(vie_id, data[i], len[i], capacity, false);
   }
-  return bytes_sent;
 }
 
-int ViESender::SendRTCPPacket(int vie_id, const void* data, int len) {
+int ViESender::DeliverPacket(int vie_id, uint8_t* packet, int length,
+                             int capacity, bool rtcp) {
   CriticalSectionScoped cs(critsect_.get());
-
   if (!transport_) {
+    // No transport
     return -1;
   }
-
   assert(ChannelId(vie_id) == channel_id_);
 
-  // Prepare for possible encryption and sending.
-  // TODO(mflodman) Change decrypt to get rid of this cast.
-  void* tmp_ptr = const_cast<void*>(data);
-  unsigned char* send_packet = static_cast<unsigned char*>(tmp_ptr);
-
-  // Data length for packets sent to possible encryption and to the transport.
-  int send_packet_length = len;
-
   if (rtp_dump_) {
-    rtp_dump_->DumpPacket(send_packet, send_packet_length);
+    rtp_dump_->DumpPacket(packet, length);
   }
 
   if (external_encryption_) {
     // Encryption buffer size.
     int encrypted_packet_length = kViEMaxMtu;
-
-    external_encryption_->encrypt_rtcp(
-        channel_id_, send_packet, encryption_buffer_, send_packet_length,
-        &encrypted_packet_length);
-    send_packet = encryption_buffer_;
-    send_packet_length = encrypted_packet_length;
+    const int tail_room = external_encryption_->in_place_tail_room();
+    if (tail_room >= 0 && length + tail_room <= capacity) {
+      // The packet is ours to modify, encrypt it where it is.
+      if (rtcp) {
+        external_encryption_->encrypt_rtcp_in_place(
+            channel_id_, packet, length, &encrypted_packet_length);
+      } else {
+        external_encryption_->encrypt_in_place(channel_id_, packet, length,
+                                               &encrypted_packet_length);
+      }
+    } else {
+      if (rtcp) {
+        external_encryption_->encrypt_rtcp(
+            channel_id_, packet, encryption_buffer_, length,
+            &encrypted_packet_length);
+      } else {
+        external_encryption_->encrypt(channel_id_, packet, encryption_buffer_,
+                                      length, &encrypted_packet_length);
+      }
+      packet = encryption_buffer_;
+      capacity = kViEMaxMtu;
+    }
+    length = encrypted_packet_length;
   }
 
-  const int bytes_sent = transport_->SendRTCPPacket(channel_id_, send_packet,
-                                                    send_packet_length);
-  if (bytes_sent != send_packet_length) {
-    WEBRTC_TRACE(
-        webrtc::kTraceWarning, webrtc::kTraceVideo, channel_id_,
-        "ViESender::SendRTCPPacket - Transport failed to send RTCP packet");
+  // Let the transport modify the packet too if it's ours, e.g. to encrypt it
+  // itself.
+  int bytes_sent = 0;
+  if (rtcp && rtcp_aggregator_) {
+    // Never encrypted, see SetRtcpAggregator().
+    bytes_sent = rtcp_aggregator_->SendRTCPPacket(channel_id_, packet, length);
+  } else if (rtcp) {
+    bytes_sent = capacity > 0 ?
+        transport_->SendWritableRTCPPacket(channel_id_, packet, length,
+                                           capacity) :
+        transport_->SendRTCPPacket(channel_id_, packet, length);
+  } else {
+    bytes_sent = capacity > 0 ?
+        transport_->SendWritablePacket(channel_id_, packet, length, capacity) :
+        transport_->SendPacket(channel_id_, packet, length);
+  }
+  if (bytes_sent != length) {
+    WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideo, channel_id_,
+                 "ViESender::DeliverPacket - Transport failed to send %s "
+                 "packet", rtcp ? "RTCP" : "RTP");
   }
   return bytes_sent;
 }
@@ -14,6 +14,8 @@
 #ifndef WEBRTC_VIDEO_ENGINE_VIE_SENDER_H_
 #define WEBRTC_VIDEO_ENGINE_VIE_SENDER_H_
 
+#include <vector>
+
 #include "common_types.h"  // NOLINT
 #include "engine_configurations.h"  // NOLINT
 #include "system_wrappers/interface/scoped_ptr.h"
@@ -23,6 +25,7 @@
 namespace webrtc {
 
 class CriticalSectionWrapper;
+class RtcpAggregator;
 class RtpDump;
 class Transport;
 class VideoCodingModule;
@@ -32,7 +35,8 @@ class ViESender: public Transport {
   explicit ViESender(const int32_t channel_id);
   ~ViESender();
 
-  // Registers an encryption class to use before sending packets.
+  // Registers an encryption class to use before sending packets. Fails if an
+  // RTCP aggregator is set.
   int RegisterExternalEncryption(Encryption* encryption);
   int DeregisterExternalEncryption();
 
@@ -40,6 +44,11 @@ class ViESender: public Transport {
   int RegisterSendTransport(Transport* transport);
   int DeregisterSendTransport();
 
+  // Sends RTCP through |aggregator|, which wraps the send transport, instead
+  // of sending it directly. NULL sends RTCP directly again. Fails if
+  // external encryption is registered, the aggregator needs plain RTCP.
+  int SetRtcpAggregator(RtcpAggregator* aggregator);
+
   // Stores all incoming packets to file.
   int StartRTPDump(const char file_nameUTF8[1024]);
   int StopRTPDump();
@@ -47,15 +56,32 @@ class ViESender: public Transport {
   // Implements Transport.
   virtual int SendPacket(int vie_id, const void* data, int len);
   virtual int SendRTCPPacket(int vie_id, const void* data, int len);
+  virtual int SendWritablePacket(int vie_id, void* data, int len,
+                                 int capacity);
+  virtual int SendWritableRTCPPacket(int vie_id, void* data, int len,
+                                     int capacity);
+  // Encrypts the packets with one Encryption::encrypt_in_place_batch() call
+  // if they all have room for it.
+  virtual void SendWritablePackets(int vie_id, unsigned char* const* data,
+                                   const int* len, int capacity,
+                                   int* bytes_sent, int num_packets);
 
  private:
+  // Dumps, encrypts and sends |packet|. |capacity| is the size of the buffer
+  // if it may be modified in place, otherwise 0.
+  int DeliverPacket(int vie_id, uint8_t* packet, int length, int capacity,
+                    bool rtcp);
+
   const int32_t channel_id_;
 
   scoped_ptr<CriticalSectionWrapper> critsect_;
 
   Encryption* external_encryption_;
   uint8_t* encryption_buffer_;
+  // Lengths of the packets encrypted by SendWritablePackets().
+  std::vector<int> encrypted_lengths_;
   Transport* transport_;
+  RtcpAggregator* rtcp_aggregator_;
   RtpDump* rtp_dump_;
 };
 
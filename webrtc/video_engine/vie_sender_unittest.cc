@@ -0,0 +1,513 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// This file includes unit tests for ViESender's use of external encryption
+// and of an RTCP aggregator.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "webrtc/common_types.h"
+#include "webrtc/modules/rtp_rtcp/interface/rtcp_aggregator.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/video_engine/vie_defines.h"
+#include "webrtc/video_engine/vie_sender.h"
+
+namespace webrtc {
+namespace {
+
+const int kChannelId = 3;
+const int kRtpHeaderLength = 12;
+
+uint64_t Load64(const uint8_t* data) {
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void Store64(uint8_t* data, uint64_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+uint64_t Mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// A stand-in for AES-GCM with the same structure: a counter mode keystream
+// XORed onto the payload, and a 16 byte tag computed by a multiply-accumulate
+// hash over the header and the encrypted payload. The hash is a chain of
+// dependent multiplications per packet, so like GHASH it runs faster when
+// several packets are interleaved. It is not secure, and only meant for
+// measuring how the packets are handled.
+class GcmStandInEncryption : public Encryption {
+ public:
+  enum { kTagLength = 16 };
+  // The number of packets interleaved by encrypt_in_place_batch().
+  enum { kInterleave = 4 };
+
+  explicit GcmStandInEncryption(bool in_place)
+      : in_place_(in_place),
+        key_(0x0123456789abcdefULL),
+        batches_(0) {
+  }
+
+  virtual void encrypt(int channel, unsigned char* in_data,
+                       unsigned char* out_data, int bytes_in,
+                       int* bytes_out) {
+    Crypt(&in_data, &out_data, &bytes_in, bytes_out, 1, true);
+  }
+
+  virtual void decrypt(int channel, unsigned char* in_data,
+                       unsigned char* out_data, int bytes_in,
+                       int* bytes_out) {
+    Crypt(&in_data, &out_data, &bytes_in, bytes_out, 1, false);
+  }
+
+  virtual void encrypt_rtcp(int channel, unsigned char* in_data,
+                            unsigned char* out_data, int bytes_in,
+                            int* bytes_out) {
+    encrypt(channel, in_data, out_data, bytes_in, bytes_out);
+  }
+
+  virtual void decrypt_rtcp(int channel, unsigned char* in_data,
+                            unsigned char* out_data, int bytes_in,
+                            int* bytes_out) {
+    decrypt(channel, in_data, out_data, bytes_in, bytes_out);
+  }
+
+  virtual int in_place_tail_room() {
+    return in_place_ ? kTagLength : -1;
+  }
+
+  virtual void encrypt_in_place(int channel, unsigned char* data,
+                                int bytes_in, int* bytes_out) {
+    Crypt(&data, &data, &bytes_in, bytes_out, 1, true);
+  }
+
+  virtual void encrypt_rtcp_in_place(int channel, unsigned char* data,
+                                     int bytes_in, int* bytes_out) {
+    encrypt_in_place(channel, data, bytes_in, bytes_out);
+  }
+
+  virtual void encrypt_in_place_batch(int channel, unsigned char* const* data,
+                                      const int* bytes_in, int* bytes_out,
+                                      int num_packets) {
+    ++batches_;
+    for (int i = 0; i < num_packets; i += kInterleave) {
+      Crypt(&data[i], &data[i], &bytes_in[i], &bytes_out[i],
+            std::min(static_cast<int>(kInterleave), num_packets - i), true);
+    }
+  }
+
+  // The number of encrypt_in_place_batch() calls.
+  int batches() const { return batches_; }
+
+ private:
+  struct State {
+    const uint8_t* in;
+    uint8_t* out;
+    int payload_end;
+    uint64_t nonce;
+    uint64_t hash1;
+    uint64_t hash2;
+  };
+
+  void Step(State* state, int offset, bool encrypt) const {
+    const uint8_t* in = state->in + offset;
+    uint8_t* out = state->out + offset;
+    uint64_t key_stream = Mix(key_ ^ (state->nonce + offset));
+    uint64_t cipher = 0;
+    if (offset + 8 <= state->payload_end) {
+      const uint64_t value = Load64(in);
+      cipher = encrypt ? value ^ key_stream : value;
+      Store64(out, value ^ key_stream);
+    } else {
+      // The last, partial word.
+      for (int i = 0; offset + i < state->payload_end; ++i) {
+        const uint8_t value = in[i];
+        const uint8_t cipher_byte =
+            encrypt ? value ^ static_cast<uint8_t>(key_stream) : value;
+        cipher |= static_cast<uint64_t>(cipher_byte) << (8 * i);
+        out[i] = value ^ static_cast<uint8_t>(key_stream);
+        key_stream >>= 8;
+      }
+    }
+    state->hash1 = (state->hash1 ^ cipher) * 0x9e3779b97f4a7c15ULL;
+    state->hash2 = (state->hash2 + cipher) * 0xc2b2ae3d27d4eb4fULL;
+  }
+
+  // Encrypts or decrypts the |num_packets| packets in |in| to |out|, which may
+  // be the same buffers.
+  void Crypt(unsigned char* const* in, unsigned char* const* out,
+             const int* bytes_in, int* bytes_out, int num_packets,
+             bool encrypt) const {
+    State states[kInterleave];
+    int common_end = bytes_in[0];
+    for (int k = 0; k < num_packets; ++k) {
+      State& state = states[k];
+      state.in = in[k];
+      state.out = out[k];
+      state.payload_end = bytes_in[k] - (encrypt ? 0 : kTagLength);
+      if (state.payload_end < kRtpHeaderLength) {
+        state.out = NULL;
+        bytes_out[k] = -1;
+        continue;
+      }
+      if (in[k] != out[k]) {
+        memcpy(out[k], in[k], kRtpHeaderLength);
+      }
+      // Sequence number and SSRC.
+      state.nonce = (static_cast<uint64_t>(Load64(in[k] + 4) >> 32) << 16) |
+          (in[k][2] << 8 | in[k][3]);
+      state.hash1 = Load64(in[k]);
+      state.hash2 = Load64(in[k] + 4);
+      common_end = std::min(common_end, state.payload_end);
+    }
+    // Interleave the packets as long as they all have full words left.
+    int offset = kRtpHeaderLength;
+    for (; offset + 8 <= common_end; offset += 8) {
+      for (int k = 0; k < num_packets; ++k) {
+        if (states[k].out) {
+          Step(&states[k], offset, encrypt);
+        }
+      }
+    }
+    for (int k = 0; k < num_packets; ++k) {
+      State& state = states[k];
+      if (!state.out) {
+        continue;
+      }
+      for (int i = offset; i < state.payload_end; i += 8) {
+        Step(&state, i, encrypt);
+      }
+      uint8_t tag[kTagLength];
+      Store64(tag, Mix(state.hash1 ^ state.payload_end));
+      Store64(tag + 8, Mix(state.hash2));
+      if (encrypt) {
+        memcpy(state.out + state.payload_end, tag, kTagLength);
+        bytes_out[k] = state.payload_end + kTagLength;
+      } else {
+        bytes_out[k] = memcmp(state.in + state.payload_end, tag,
+                              kTagLength) == 0 ? state.payload_end : -1;
+      }
+    }
+  }
+
+  const bool in_place_;
+  const uint64_t key_;
+  int batches_;
+};
+
+class RecordingTransport : public Transport {
+ public:
+  RecordingTransport()
+      : packets_(0),
+        writable_packets_(0),
+        last_data_(NULL),
+        last_length_(0) {
+  }
+
+  virtual int SendPacket(int channel, const void* data, int len) {
+    ++packets_;
+    last_data_ = data;
+    last_length_ = len;
+    return len;
+  }
+
+  virtual int SendRTCPPacket(int channel, const void* data, int len) {
+    return SendPacket(channel, data, len);
+  }
+
+  virtual int SendWritablePacket(int channel, void* data, int len,
+                                 int capacity) {
+    ++writable_packets_;
+    return SendPacket(channel, data, len);
+  }
+
+  virtual int SendWritableRTCPPacket(int channel, void* data, int len,
+                                     int capacity) {
+    ++writable_packets_;
+    return SendRTCPPacket(channel, data, len);
+  }
+
+  int packets_;
+  int writable_packets_;
+  const void* last_data_;
+  int last_length_;
+};
+
+void BuildPacket(uint16_t sequence_number, int length, uint8_t* packet) {
+  for (int i = 0; i < length; ++i) {
+    packet[i] = static_cast<uint8_t>(i * 7 + sequence_number);
+  }
+  packet[0] = 0x80;
+  packet[1] = 100;
+  packet[2] = sequence_number >> 8;
+  packet[3] = sequence_number & 0xff;
+}
+
+}  // namespace
+
+class ViESenderTest : public ::testing::Test {
+ protected:
+  ViESenderTest()
+      : vie_id_(ViEModuleId(0, kChannelId)),
+        sender_(kChannelId) {
+  }
+
+  virtual void SetUp() {
+    EXPECT_EQ(0, sender_.RegisterSendTransport(&transport_));
+  }
+
+  const int vie_id_;
+  RecordingTransport transport_;
+  ViESender sender_;
+};
+
+TEST_F(ViESenderTest, EncryptsWritablePacketsInPlace) {
+  GcmStandInEncryption encryption(true);
+  EXPECT_EQ(0, sender_.RegisterExternalEncryption(&encryption));
+  const int kLength = 200;
+  uint8_t packet[kViEMaxMtu];
+  uint8_t original[kViEMaxMtu];
+  BuildPacket(1, kLength, packet);
+  memcpy(original, packet, kLength);
+
+  EXPECT_EQ(kLength + GcmStandInEncryption::kTagLength,
+            sender_.SendWritablePacket(vie_id_, packet, kLength,
+                                       sizeof(packet)));
+  EXPECT_EQ(packet, transport_.last_data_);
+  EXPECT_EQ(1, transport_.writable_packets_);
+  EXPECT_EQ(0, memcmp(packet, original, kRtpHeaderLength));
+  EXPECT_NE(0, memcmp(packet, original, kLength));
+
+  uint8_t decrypted[kViEMaxMtu];
+  int decrypted_length = 0;
+  encryption.decrypt(kChannelId, packet, decrypted,
+                     kLength + GcmStandInEncryption::kTagLength,
+                     &decrypted_length);
+  EXPECT_EQ(kLength, decrypted_length);
+  EXPECT_EQ(0, memcmp(decrypted, original, kLength));
+
+  // Same for RTCP.
+  EXPECT_EQ(kLength + GcmStandInEncryption::kTagLength,
+            sender_.SendWritableRTCPPacket(vie_id_, packet, kLength,
+                                           sizeof(packet)));
+  EXPECT_EQ(packet, transport_.last_data_);
+  EXPECT_EQ(2, transport_.writable_packets_);
+}
+
+TEST_F(ViESenderTest, CopiesPacketsWhichCantBeModified) {
+  GcmStandInEncryption encryption(true);
+  EXPECT_EQ(0, sender_.RegisterExternalEncryption(&encryption));
+  const int kLength = 200;
+  uint8_t packet[kViEMaxMtu];
+  uint8_t original[kViEMaxMtu];
+  BuildPacket(1, kLength, packet);
+  memcpy(original, packet, kLength);
+
+  // Read only packet.
+  EXPECT_EQ(kLength + GcmStandInEncryption::kTagLength,
+            sender_.SendPacket(vie_id_, packet, kLength));
+  EXPECT_NE(packet, transport_.last_data_);
+  EXPECT_EQ(0, memcmp(packet, original, kLength));
+
+  // No room for the tag.
+  EXPECT_EQ(kLength + GcmStandInEncryption::kTagLength,
+            sender_.SendWritablePacket(vie_id_, packet, kLength,
+                                       kLength + 1));
+  EXPECT_NE(packet, transport_.last_data_);
+  EXPECT_EQ(0, memcmp(packet, original, kLength));
+
+  // The encryption doesn't implement in-place encryption.
+  GcmStandInEncryption copying_encryption(false);
+  EXPECT_EQ(0, sender_.DeregisterExternalEncryption());
+  EXPECT_EQ(0, sender_.RegisterExternalEncryption(&copying_encryption));
+  EXPECT_EQ(kLength + GcmStandInEncryption::kTagLength,
+            sender_.SendWritablePacket(vie_id_, packet, kLength,
+                                       sizeof(packet)));
+  EXPECT_NE(packet, transport_.last_data_);
+  EXPECT_EQ(0, memcmp(packet, original, kLength));
+}
+
+TEST_F(ViESenderTest, BatchMatchesSinglePackets) {
+  GcmStandInEncryption encryption(true);
+  const int kNumPackets = 7;
+  std::vector<uint8_t> batch(kNumPackets * kViEMaxMtu);
+  std::vector<uint8_t> single(kNumPackets * kViEMaxMtu);
+  unsigned char* data[kNumPackets];
+  int lengths[kNumPackets];
+  int batch_lengths[kNumPackets];
+  for (int i = 0; i < kNumPackets; ++i) {
+    data[i] = &batch[i * kViEMaxMtu];
+    lengths[i] = 100 + 37 * i;
+    BuildPacket(i, lengths[i], data[i]);
+  }
+  single = batch;
+  encryption.encrypt_in_place_batch(kChannelId, data, lengths, batch_lengths,
+                                    kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    int length = 0;
+    encryption.encrypt_in_place(kChannelId, &single[i * kViEMaxMtu],
+                                lengths[i], &length);
+    EXPECT_EQ(length, batch_lengths[i]);
+  }
+  EXPECT_TRUE(single == batch);
+}
+
+TEST_F(ViESenderTest, EncryptsWritablePacketsInOneBatch) {
+  GcmStandInEncryption encryption(true);
+  EXPECT_EQ(0, sender_.RegisterExternalEncryption(&encryption));
+  const int kNumPackets = 5;
+  std::vector<uint8_t> buffers(kNumPackets * kViEMaxMtu);
+  unsigned char* data[kNumPackets];
+  int lengths[kNumPackets];
+  int bytes_sent[kNumPackets];
+  for (int i = 0; i < kNumPackets; ++i) {
+    data[i] = &buffers[i * kViEMaxMtu];
+    lengths[i] = 200 + i;
+    BuildPacket(i, lengths[i], data[i]);
+  }
+
+  sender_.SendWritablePackets(vie_id_, data, lengths, kViEMaxMtu, bytes_sent,
+                              kNumPackets);
+  EXPECT_EQ(1, encryption.batches());
+  EXPECT_EQ(kNumPackets, transport_.writable_packets_);
+  EXPECT_EQ(data[kNumPackets - 1], transport_.last_data_);
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(lengths[i] + GcmStandInEncryption::kTagLength, bytes_sent[i]);
+    uint8_t decrypted[kViEMaxMtu];
+    int decrypted_length = 0;
+    encryption.decrypt(kChannelId, data[i], decrypted, bytes_sent[i],
+                       &decrypted_length);
+    EXPECT_EQ(lengths[i], decrypted_length);
+    uint8_t original[kViEMaxMtu];
+    BuildPacket(i, lengths[i], original);
+    EXPECT_EQ(0, memcmp(decrypted, original, lengths[i]));
+  }
+
+  // Without room for the tag the packets are encrypted one by one, with a
+  // copy.
+  for (int i = 0; i < kNumPackets; ++i) {
+    BuildPacket(i, lengths[i], data[i]);
+  }
+  sender_.SendWritablePackets(vie_id_, data, lengths, lengths[kNumPackets - 1],
+                              bytes_sent, kNumPackets);
+  EXPECT_EQ(1, encryption.batches());
+  EXPECT_NE(data[kNumPackets - 1], transport_.last_data_);
+  EXPECT_EQ(lengths[0] + GcmStandInEncryption::kTagLength, bytes_sent[0]);
+}
+
+TEST_F(ViESenderTest, SendsRtcpThroughAggregator) {
+  SimulatedClock clock(0);
+  RtcpAggregator aggregator(&transport_, &clock);
+  EXPECT_EQ(0, sender_.SetRtcpAggregator(&aggregator));
+
+  // A receiver report with one report block is held by the aggregator.
+  const int kRtcpLength = 32;
+  uint8_t rtcp[kRtcpLength];
+  memset(rtcp, 0, sizeof(rtcp));
+  rtcp[0] = 0x81;
+  rtcp[1] = 201;
+  rtcp[3] = kRtcpLength / 4 - 1;
+  EXPECT_EQ(kRtcpLength, sender_.SendRTCPPacket(vie_id_, rtcp, kRtcpLength));
+  EXPECT_EQ(0, transport_.packets_);
+
+  // RTP is sent directly.
+  const int kLength = 200;
+  uint8_t packet[kViEMaxMtu];
+  BuildPacket(1, kLength, packet);
+  EXPECT_EQ(kLength, sender_.SendPacket(vie_id_, packet, kLength));
+  EXPECT_EQ(1, transport_.packets_);
+
+  aggregator.Flush();
+  EXPECT_EQ(2, transport_.packets_);
+  EXPECT_EQ(kRtcpLength, transport_.last_length_);
+
+  // The aggregator needs plain RTCP.
+  GcmStandInEncryption encryption(true);
+  EXPECT_EQ(-1, sender_.RegisterExternalEncryption(&encryption));
+  EXPECT_EQ(0, sender_.SetRtcpAggregator(NULL));
+  EXPECT_EQ(0, sender_.RegisterExternalEncryption(&encryption));
+  EXPECT_EQ(-1, sender_.SetRtcpAggregator(&aggregator));
+
+  // Without the aggregator RTCP is sent directly again.
+  EXPECT_EQ(kRtcpLength + GcmStandInEncryption::kTagLength,
+            sender_.SendRTCPPacket(vie_id_, rtcp, kRtcpLength));
+  EXPECT_EQ(3, transport_.packets_);
+}
+
+// Measures the packet throughput of encrypting and sending RTP packets the way
+// the engines did before in-place encryption, in place, and in place in
+// batches.
+TEST_F(ViESenderTest, DISABLED_EncryptionThroughputBenchmark) {
+  const int kNumPackets = 20000;
+  const int kBatchSize = 16;
+  const int kLength = 1200;
+  GcmStandInEncryption copying_encryption(false);
+  GcmStandInEncryption encryption(true);
+  std::vector<uint8_t> buffers(kBatchSize * kViEMaxMtu);
+  unsigned char* data[kBatchSize];
+  int lengths[kBatchSize];
+  int bytes_sent[kBatchSize];
+  for (int i = 0; i < kBatchSize; ++i) {
+    data[i] = &buffers[i * kViEMaxMtu];
+    lengths[i] = kLength;
+  }
+
+  for (int mode = 0; mode < 3; ++mode) {
+    if (mode == 0) {
+      EXPECT_EQ(0, sender_.RegisterExternalEncryption(&copying_encryption));
+    } else if (mode == 1) {
+      EXPECT_EQ(0, sender_.DeregisterExternalEncryption());
+      EXPECT_EQ(0, sender_.RegisterExternalEncryption(&encryption));
+    }
+    for (int i = 0; i < kBatchSize; ++i) {
+      BuildPacket(i, kLength, data[i]);
+    }
+    // The packets are encrypted over and over again, which costs the same as
+    // encrypting new packets.
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    for (int n = 0; n < kNumPackets; n += kBatchSize) {
+      if (mode == 0) {
+        for (int i = 0; i < kBatchSize; ++i) {
+          sender_.SendPacket(vie_id_, data[i], kLength);
+        }
+      } else if (mode == 1) {
+        for (int i = 0; i < kBatchSize; ++i) {
+          sender_.SendWritablePacket(vie_id_, data[i], kLength, kViEMaxMtu);
+        }
+      } else {
+        sender_.SendWritablePackets(vie_id_, data, lengths, kViEMaxMtu,
+                                    bytes_sent, kBatchSize);
+      }
+    }
+    const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+    const char* kModes[] = {"Copy to encryption buffer",
+                            "In place",
+                            "In place, batches of 16"};
+    printf("%s: %.0f packets/s, %.2f Gbit/s\n", kModes[mode],
+           kNumPackets * 1e6 / elapsed_us,
+           kNumPackets * kLength * 8e-3 / elapsed_us);
+  }
+  EXPECT_EQ(3 * kNumPackets, transport_.packets_);
+}
+
+}  // namespace webrtc
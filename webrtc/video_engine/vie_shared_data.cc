@@ -32,6 +32,7 @@ ViESharedData::ViESharedData()
       input_manager_(*new ViEInputManager(instance_id_)),
       render_manager_(*new ViERenderManager(instance_id_)),
       module_process_thread_(ProcessThread::CreateProcessThread()),
+      decode_process_thread_(NULL),
       last_error_(0) {
   Trace::CreateTrace();
   channel_manager_.SetModuleProcessThread(module_process_thread_);
@@ -46,9 +47,28 @@ ViESharedData::~ViESharedData() {
 
   module_process_thread_->Stop();
   ProcessThread::DestroyProcessThread(module_process_thread_);
+  if (decode_process_thread_) {
+    decode_process_thread_->Stop();
+    ProcessThread::DestroyProcessThread(decode_process_thread_);
+  }
   Trace::ReturnTrace();
 }
 
+ProcessThread* ViESharedData::decode_process_thread() {
+  if (!decode_process_thread_) {
+    ProcessThread* thread = ProcessThread::CreateProcessThread(number_cores_);
+    if (!thread) {
+      return NULL;
+    }
+    if (thread->Start() != 0) {
+      ProcessThread::DestroyProcessThread(thread);
+      return NULL;
+    }
+    decode_process_thread_ = thread;
+  }
+  return decode_process_thread_;
+}
+
 bool ViESharedData::Initialized() const {
   return initialized_;
 }
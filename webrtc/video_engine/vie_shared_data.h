@@ -40,6 +40,10 @@ class ViESharedData {
   ViEChannelManager* channel_manager() { return &channel_manager_; }
   ViEInputManager* input_manager() { return &input_manager_; }
   ViERenderManager* render_manager() { return &render_manager_; }
+  // The threads shared by the channels to decode and render on, see
+  // ViEBase::EnableSharedDecodeThreads(). Created and started on first use,
+  // NULL if that fails.
+  ProcessThread* decode_process_thread();
 
  private:
   static int instance_counter_;
@@ -52,6 +56,7 @@ class ViESharedData {
   ViEInputManager& input_manager_;
   ViERenderManager& render_manager_;
   ProcessThread* module_process_thread_;
+  ProcessThread* decode_process_thread_;
   mutable int last_error_;
 };
 
@@ -55,6 +55,31 @@ Channel::SendData(FrameType frameType,
         _rtpRtcpModule->SetAudioLevel(_rtpAudioProc->level_estimator()->RMS());
     }
 
+    const int32_t ret = SendEncodedData(frameType, payloadType, timeStamp,
+                                        payloadData, payloadSize,
+                                        fragmentation);
+
+    // Hand the same payload to the channels sharing this encoder.
+    for (size_t i = 0; i < _encoderFollowers.size(); ++i)
+    {
+        Channel* follower = _encoderFollowers[i];
+        follower->SendEncodedData(
+            frameType, payloadType,
+            timeStamp + follower->_sharedTimeStampOffset,
+            payloadData, payloadSize, fragmentation);
+    }
+
+    return ret;
+}
+
+int32_t
+Channel::SendEncodedData(FrameType frameType,
+                         uint8_t payloadType,
+                         uint32_t timeStamp,
+                         const uint8_t* payloadData,
+                         uint16_t payloadSize,
+                         const RTPFragmentationHeader* fragmentation)
+{
     // Push data from ACM to RTP/RTCP-module to deliver audio frame for
     // packetization.
     // This call will trigger Transport::SendPacket() from the RTP/RTCP module.
@@ -110,6 +135,19 @@ Channel::OnRxVadDetected(const int vadDecision)
 
 int
 Channel::SendPacket(int channel, const void *data, int len)
+{
+    return SendRTPPacketInternal(channel, (uint8_t*)data, len, 0);
+}
+
+int
+Channel::SendWritablePacket(int channel, void *data, int len, int capacity)
+{
+    return SendRTPPacketInternal(channel, (uint8_t*)data, len, capacity);
+}
+
+int
+Channel::SendRTPPacketInternal(int channel, uint8_t* data, int len,
+                               int capacity)
 {
     channel = VoEChannelId(channel);
     assert(channel == _channelId);
@@ -129,7 +167,7 @@ Channel::SendPacket(int channel, const void *data, int len)
     // API
     if (_insertExtraRTPPacket)
     {
-        uint8_t* rtpHdr = (uint8_t*)data;
+        uint8_t* rtpHdr = data;
         uint8_t M_PT(0);
         if (_extraMarkerBit)
         {
@@ -140,7 +178,7 @@ Channel::SendPacket(int channel, const void *data, int len)
         _insertExtraRTPPacket = false;  // insert one packet only
     }
 
-    uint8_t* bufferToSendPtr = (uint8_t*)data;
+    uint8_t* bufferToSendPtr = data;
     int32_t bufferLength = len;
 
     // Dump the RTP packet to a file (if RTP dump is enabled).
@@ -158,22 +196,39 @@ Channel::SendPacket(int channel, const void *data, int len)
 
         if (_encryptionPtr)
         {
-            if (!_encryptionRTPBufferPtr)
+            const int tailRoom = _encryptionPtr->in_place_tail_room();
+            int32_t encryptedBufferLength = 0;
+            if (tailRoom >= 0 && bufferLength + tailRoom <= capacity)
             {
-                // Allocate memory for encryption buffer one time only
-                _encryptionRTPBufferPtr =
-                    new uint8_t[kVoiceEngineMaxIpPacketSizeBytes];
-                memset(_encryptionRTPBufferPtr, 0,
-                       kVoiceEngineMaxIpPacketSizeBytes);
+                // The RTP module doesn't use the packet after this call,
+                // encrypt it where it is.
+                _encryptionPtr->encrypt_in_place(_channelId,
+                                                 bufferToSendPtr,
+                                                 bufferLength,
+                                                 (int*)&encryptedBufferLength);
+            }
+            else
+            {
+                if (!_encryptionRTPBufferPtr)
+                {
+                    // Allocate memory for encryption buffer one time only
+                    _encryptionRTPBufferPtr =
+                        new uint8_t[kVoiceEngineMaxIpPacketSizeBytes];
+                    memset(_encryptionRTPBufferPtr, 0,
+                           kVoiceEngineMaxIpPacketSizeBytes);
+                }
+
+                // Perform encryption (SRTP or external)
+                _encryptionPtr->encrypt(_channelId,
+                                        bufferToSendPtr,
+                                        _encryptionRTPBufferPtr,
+                                        bufferLength,
+                                        (int*)&encryptedBufferLength);
+
+                // Replace default data buffer with encrypted buffer
+                bufferToSendPtr = _encryptionRTPBufferPtr;
+                capacity = kVoiceEngineMaxIpPacketSizeBytes;
             }
-
-            // Perform encryption (SRTP or external)
-            int32_t encryptedBufferLength = 0;
-            _encryptionPtr->encrypt(_channelId,
-                                    bufferToSendPtr,
-                                    _encryptionRTPBufferPtr,
-                                    bufferLength,
-                                    (int*)&encryptedBufferLength);
             if (encryptedBufferLength <= 0)
             {
                 _engineStatisticsPtr->SetLastError(
@@ -181,9 +236,6 @@ Channel::SendPacket(int channel, const void *data, int len)
                     kTraceError, "Channel::SendPacket() encryption failed");
                 return -1;
             }
-
-            // Replace default data buffer with encrypted buffer
-            bufferToSendPtr = _encryptionRTPBufferPtr;
             bufferLength = encryptedBufferLength;
         }
     }
@@ -191,8 +243,10 @@ Channel::SendPacket(int channel, const void *data, int len)
     // Packet transmission using WebRtc socket transport
     if (!_externalTransport)
     {
-        int n = _transportPtr->SendPacket(channel, bufferToSendPtr,
-                                          bufferLength);
+        int n = capacity > 0 ?
+            _transportPtr->SendWritablePacket(channel, bufferToSendPtr,
+                                              bufferLength, capacity) :
+            _transportPtr->SendPacket(channel, bufferToSendPtr, bufferLength);
         if (n < 0)
         {
             WEBRTC_TRACE(kTraceError, kTraceVoice,
@@ -208,9 +262,10 @@ Channel::SendPacket(int channel, const void *data, int len)
     {
         CriticalSectionScoped cs(&_callbackCritSect);
 
-        int n = _transportPtr->SendPacket(channel,
-                                          bufferToSendPtr,
-                                          bufferLength);
+        int n = capacity > 0 ?
+            _transportPtr->SendWritablePacket(channel, bufferToSendPtr,
+                                              bufferLength, capacity) :
+            _transportPtr->SendPacket(channel, bufferToSendPtr, bufferLength);
         if (n < 0)
         {
             WEBRTC_TRACE(kTraceError, kTraceVoice,
@@ -225,6 +280,20 @@ Channel::SendPacket(int channel, const void *data, int len)
 
 int
 Channel::SendRTCPPacket(int channel, const void *data, int len)
+{
+    return SendRTCPPacketInternal(channel, (uint8_t*)data, len, 0);
+}
+
+int
+Channel::SendWritableRTCPPacket(int channel, void *data, int len,
+                                int capacity)
+{
+    return SendRTCPPacketInternal(channel, (uint8_t*)data, len, capacity);
+}
+
+int
+Channel::SendRTCPPacketInternal(int channel, uint8_t* data, int len,
+                                int capacity)
 {
     channel = VoEChannelId(channel);
     assert(channel == _channelId);
@@ -244,7 +313,7 @@ Channel::SendRTCPPacket(int channel, const void *data, int len)
         }
     }
 
-    uint8_t* bufferToSendPtr = (uint8_t*)data;
+    uint8_t* bufferToSendPtr = data;
     int32_t bufferLength = len;
 
     // Dump the RTCP packet to a file (if RTP dump is enabled).
@@ -262,20 +331,38 @@ Channel::SendRTCPPacket(int channel, const void *data, int len)
 
         if (_encryptionPtr)
         {
-            if (!_encryptionRTCPBufferPtr)
+            const int tailRoom = _encryptionPtr->in_place_tail_room();
+            int32_t encryptedBufferLength = 0;
+            if (tailRoom >= 0 && bufferLength + tailRoom <= capacity)
             {
-                // Allocate memory for encryption buffer one time only
-                _encryptionRTCPBufferPtr =
-                    new uint8_t[kVoiceEngineMaxIpPacketSizeBytes];
+                // The RTCP sender doesn't use the packet after this call,
+                // encrypt it where it is.
+                _encryptionPtr->encrypt_rtcp_in_place(
+                    _channelId,
+                    bufferToSendPtr,
+                    bufferLength,
+                    (int*)&encryptedBufferLength);
+            }
+            else
+            {
+                if (!_encryptionRTCPBufferPtr)
+                {
+                    // Allocate memory for encryption buffer one time only
+                    _encryptionRTCPBufferPtr =
+                        new uint8_t[kVoiceEngineMaxIpPacketSizeBytes];
+                }
+
+                // Perform encryption (SRTP or external).
+                _encryptionPtr->encrypt_rtcp(_channelId,
+                                             bufferToSendPtr,
+                                             _encryptionRTCPBufferPtr,
+                                             bufferLength,
+                                             (int*)&encryptedBufferLength);
+
+                // Replace default data buffer with encrypted buffer
+                bufferToSendPtr = _encryptionRTCPBufferPtr;
+                capacity = kVoiceEngineMaxIpPacketSizeBytes;
             }
-
-            // Perform encryption (SRTP or external).
-            int32_t encryptedBufferLength = 0;
-            _encryptionPtr->encrypt_rtcp(_channelId,
-                                         bufferToSendPtr,
-                                         _encryptionRTCPBufferPtr,
-                                         bufferLength,
-                                         (int*)&encryptedBufferLength);
             if (encryptedBufferLength <= 0)
             {
                 _engineStatisticsPtr->SetLastError(
@@ -283,9 +370,6 @@ Channel::SendRTCPPacket(int channel, const void *data, int len)
                     "Channel::SendRTCPPacket() encryption failed");
                 return -1;
             }
-
-            // Replace default data buffer with encrypted buffer
-            bufferToSendPtr = _encryptionRTCPBufferPtr;
             bufferLength = encryptedBufferLength;
         }
     }
@@ -293,9 +377,11 @@ Channel::SendRTCPPacket(int channel, const void *data, int len)
     // Packet transmission using WebRtc socket transport
     if (!_externalTransport)
     {
-        int n = _transportPtr->SendRTCPPacket(channel,
-                                              bufferToSendPtr,
-                                              bufferLength);
+        int n = capacity > 0 ?
+            _transportPtr->SendWritableRTCPPacket(channel, bufferToSendPtr,
+                                                  bufferLength, capacity) :
+            _transportPtr->SendRTCPPacket(channel, bufferToSendPtr,
+                                          bufferLength);
         if (n < 0)
         {
             WEBRTC_TRACE(kTraceInfo, kTraceVoice,
@@ -314,9 +400,11 @@ Channel::SendRTCPPacket(int channel, const void *data, int len)
         {
             return -1;
         }
-        int n = _transportPtr->SendRTCPPacket(channel,
-                                              bufferToSendPtr,
-                                              bufferLength);
+        int n = capacity > 0 ?
+            _transportPtr->SendWritableRTCPPacket(channel, bufferToSendPtr,
+                                                  bufferLength, capacity) :
+            _transportPtr->SendRTCPPacket(channel, bufferToSendPtr,
+                                          bufferLength);
         if (n < 0)
         {
             WEBRTC_TRACE(kTraceInfo, kTraceVoice,
@@ -955,7 +1043,10 @@ Channel::Channel(const int32_t channelId,
     _RxVadDetection(false),
     _rxApmIsEnabled(false),
     _rxAgcIsEnabled(false),
-    _rxNsIsEnabled(false)
+    _rxNsIsEnabled(false),
+    _inputModified(false),
+    _encoderLeaderId(-1),
+    _sharedTimeStampOffset(0)
 {
     WEBRTC_TRACE(kTraceMemory, kTraceVoice, VoEId(_instanceId,_channelId),
                  "Channel::Channel() - ctor");
@@ -4385,6 +4476,11 @@ Channel::PrepareEncodeAndSend(int mixingFrequency)
         return -1;
     }
 
+    // The input is no longer the same as that of other channels if any of
+    // the steps below apply.
+    _inputModified = _inputFilePlaying || _mute ||
+        (_inputExternalMedia && _inputExternalMediaCallbackPtr != NULL);
+
     if (_inputFilePlaying)
     {
         MixOrReplaceAudioWithFile(mixingFrequency);
@@ -4465,6 +4561,8 @@ Channel::EncodeAndSend()
     }
 
     _audioFrame.id_ = _channelId;
+    // Encoding on our own; a later shared encoder may be another channel.
+    _encoderLeaderId = -1;
 
     // --- Add 10ms of raw (PCM) audio data to the encoder @ 32kHz.
 
@@ -4486,6 +4584,85 @@ Channel::EncodeAndSend()
     return _audioCodingModule.Process();
 }
 
+bool
+Channel::EncoderAtFrameBoundary()
+{
+    CodecInst codec;
+    if (_audioCodingModule.SendCodec(&codec) != 0)
+    {
+        return true;
+    }
+    const int32_t msLeft = _audioCodingModule.TimeUntilNextProcess();
+    return msLeft < 0 || msLeft * (codec.plfreq / 1000) >= codec.pacsize;
+}
+
+bool
+Channel::GetSharedEncoderConfig(SharedEncoderConfig* config)
+{
+    // The audio level extension is measured on the input of each channel,
+    // and RED/FEC and secondary encodings aren't passed on by SendData().
+    if (_inputModified || _includeAudioLevelIndication ||
+        _audioCodingModule.FECStatus())
+    {
+        return false;
+    }
+    CodecInst secondaryCodec;
+    if (_audioCodingModule.SecondarySendCodec(&secondaryCodec) == 0)
+    {
+        return false;
+    }
+    if (_audioCodingModule.SendCodec(&config->codec) != 0 ||
+        _audioCodingModule.VAD(&config->dtx, &config->vad,
+                               &config->vadMode) != 0)
+    {
+        return false;
+    }
+    // iSAC adapts its rate to the bandwidth estimate of each channel, and its
+    // rate and payload limits aren't reflected in the CodecInst.
+    if (STR_CASE_CMP(config->codec.plname, "ISAC") == 0)
+    {
+        return false;
+    }
+    return true;
+}
+
+bool
+Channel::SameSharedEncoderConfig(const SharedEncoderConfig& a,
+                                 const SharedEncoderConfig& b)
+{
+    return a.codec.pltype == b.codec.pltype &&
+        STR_CASE_CMP(a.codec.plname, b.codec.plname) == 0 &&
+        a.codec.plfreq == b.codec.plfreq &&
+        a.codec.pacsize == b.codec.pacsize &&
+        a.codec.channels == b.codec.channels &&
+        a.codec.rate == b.codec.rate &&
+        a.dtx == b.dtx &&
+        a.vad == b.vad &&
+        a.vadMode == b.vadMode;
+}
+
+void
+Channel::AddEncoderFollower(Channel* follower)
+{
+    assert(follower != this);
+    if (follower->_encoderLeaderId != _channelId)
+    {
+        // Continue the RTP timestamps of the follower from its last sent
+        // packet. Both channels last sent a payload of the same block if they
+        // were encoding in step.
+        follower->_encoderLeaderId = _channelId;
+        follower->_sharedTimeStampOffset =
+            follower->_lastLocalTimeStamp - _lastLocalTimeStamp;
+    }
+    _encoderFollowers.push_back(follower);
+}
+
+void
+Channel::ClearEncoderFollowers()
+{
+    _encoderFollowers.clear();
+}
+
 int Channel::RegisterExternalMediaProcessing(
     ProcessingTypes type,
     VoEMediaProcess& processObject)
@@ -5007,6 +5184,7 @@ Channel::InsertInbandDtmfTone()
         }
 
         // Replace mixed audio with DTMF tone.
+        _inputModified = true;
         for (int sample = 0;
             sample < _audioFrame.samples_per_channel_;
             sample++)
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_VOICE_ENGINE_CHANNEL_H
 #define WEBRTC_VOICE_ENGINE_CHANNEL_H
 
+#include <vector>
+
 #include "webrtc/common_audio/resampler/include/resampler.h"
 #include "webrtc/common_types.h"
 #include "webrtc/modules/audio_coding/main/interface/audio_coding_module.h"
@@ -349,6 +351,10 @@ public:
     // From Transport (called by the RTP/RTCP module)
     int SendPacket(int /*channel*/, const void *data, int len);
     int SendRTCPPacket(int /*channel*/, const void *data, int len);
+    int SendWritablePacket(int /*channel*/, void *data, int len,
+                           int capacity);
+    int SendWritableRTCPPacket(int /*channel*/, void *data, int len,
+                               int capacity);
 
 public:
     // From MixerParticipant
@@ -420,13 +426,48 @@ public:
     uint32_t Demultiplex(const AudioFrame& audioFrame);
     uint32_t PrepareEncodeAndSend(int mixingFrequency);
     uint32_t EncodeAndSend();
+    // Returns true if the encoder holds no input of its next frame, so the
+    // current block can be dropped without cutting a frame short.
+    bool EncoderAtFrameBoundary();
+
+    // Encoder settings which must be equal for channels to share the
+    // encoding of their input, see TransmitMixer::SetEncoderSharing().
+    struct SharedEncoderConfig
+    {
+        CodecInst codec;
+        bool dtx;
+        bool vad;
+        ACMVADMode vadMode;
+    };
+    // Returns false if the encoding of the current block can't be shared,
+    // e.g. since PrepareEncodeAndSend() changed the input of this channel.
+    bool GetSharedEncoderConfig(SharedEncoderConfig* config);
+    static bool SameSharedEncoderConfig(const SharedEncoderConfig& a,
+                                        const SharedEncoderConfig& b);
+    // Makes |follower| send the payloads encoded by this channel, with its
+    // own SSRC and sequence numbers, until ClearEncoderFollowers(). The
+    // follower's own EncodeAndSend() must not be called meanwhile.
+    void AddEncoderFollower(Channel* follower);
+    void ClearEncoderFollowers();
 
 private:
     int InsertInbandDtmfTone();
+    int32_t SendEncodedData(FrameType frameType,
+                            uint8_t payloadType,
+                            uint32_t timeStamp,
+                            const uint8_t* payloadData,
+                            uint16_t payloadSize,
+                            const RTPFragmentationHeader* fragmentation);
     int32_t MixOrReplaceAudioWithFile(const int mixingFrequency);
     int32_t MixAudioWithFile(AudioFrame& audioFrame, const int mixingFrequency);
     void UpdateDeadOrAliveCounters(bool alive);
     int32_t SendPacketRaw(const void *data, int len, bool RTCP);
+    // Send RTP/RTCP packets from the RTP/RTCP module. |capacity| is the size
+    // of the buffer holding |data| if it may be modified in place, else 0.
+    int SendRTPPacketInternal(int channel, uint8_t* data, int len,
+                              int capacity);
+    int SendRTCPPacketInternal(int channel, uint8_t* data, int len,
+                               int capacity);
     void UpdatePacketDelay(uint32_t timestamp,
                            uint16_t sequenceNumber);
     void RegisterReceiveCodecsToRTPModule();
@@ -542,6 +583,11 @@ private:
     bool _rxApmIsEnabled;
     bool _rxAgcIsEnabled;
     bool _rxNsIsEnabled;
+    // Encoder sharing
+    bool _inputModified;
+    std::vector<Channel*> _encoderFollowers;
+    int32_t _encoderLeaderId;
+    uint32_t _sharedTimeStampOffset;
 };
 
 } // namespace voe
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/voice_engine/encode_thread_pool.h"
+
+#include <assert.h>
+
+#include "webrtc/system_wrappers/interface/condition_variable_wrapper.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/voice_engine/channel.h"
+
+namespace webrtc {
+namespace voe {
+
+EncodeThreadPool::EncodeThreadPool()
+    : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      work_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      done_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      channels_(NULL),
+      num_required_(0),
+      num_channels_(0),
+      next_channel_(0),
+      active_(0),
+      stopped_(false) {
+}
+
+EncodeThreadPool::~EncodeThreadPool() {
+  Stop();
+}
+
+int EncodeThreadPool::Start(int num_threads) {
+  assert(threads_.empty());
+  for (int i = 0; i < num_threads; ++i) {
+    // The encoding is on the capture path, so run at the priority of the
+    // audio device threads.
+    ThreadWrapper* thread = ThreadWrapper::CreateThread(
+        Run, this, kRealtimePriority, "VoiceEncodeThread");
+    unsigned int thread_id = 0;
+    if (thread == NULL) {
+      Stop();
+      return -1;
+    }
+    threads_.push_back(thread);
+    if (!thread->Start(thread_id)) {
+      Stop();
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void EncodeThreadPool::Stop() {
+  {
+    CriticalSectionScoped cs(crit_.get());
+    stopped_ = true;
+    work_cond_->WakeAll();
+  }
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i]->Stop();
+    delete threads_[i];
+  }
+  threads_.clear();
+  stopped_ = false;
+}
+
+int EncodeThreadPool::EncodeAndSend(Channel* const* channels,
+                                    int num_required,
+                                    int num_channels,
+                                    int deadline_ms) {
+  const int64_t deadline = TickTime::MillisecondTimestamp() + deadline_ms;
+  CriticalSectionScoped cs(crit_.get());
+  assert(channels_ == NULL);
+  assert(num_required <= num_channels);
+  channels_ = channels;
+  num_required_ = num_required;
+  num_channels_ = num_channels;
+  next_channel_ = 0;
+  active_ = 0;
+  work_cond_->WakeAll();
+
+  // Encode on this thread as well, until the deadline and the required
+  // channels are picked up.
+  while (next_channel_ < num_required_ ||
+         TickTime::MillisecondTimestamp() < deadline) {
+    Channel* channel = NextChannel();
+    if (channel == NULL) {
+      break;
+    }
+    crit_->Leave();
+    channel->EncodeAndSend();
+    crit_->Enter();
+    ChannelDone();
+  }
+
+  while (next_channel_ < num_channels_) {
+    const int64_t remaining_ms = deadline - TickTime::MillisecondTimestamp();
+    if (remaining_ms <= 0) {
+      // Skip the channels not picked up yet. The required channels are all
+      // picked up by now, see above.
+      num_channels_ = next_channel_;
+      break;
+    }
+    done_cond_->SleepCS(*crit_, static_cast<unsigned long>(remaining_ms));
+  }
+  while (active_ > 0) {
+    done_cond_->SleepCS(*crit_);
+  }
+  channels_ = NULL;
+  return next_channel_;
+}
+
+bool EncodeThreadPool::Run(void* obj) {
+  return static_cast<EncodeThreadPool*>(obj)->Process();
+}
+
+bool EncodeThreadPool::Process() {
+  CriticalSectionScoped cs(crit_.get());
+  Channel* channel = NULL;
+  while (!stopped_ && (channel = NextChannel()) == NULL) {
+    work_cond_->SleepCS(*crit_);
+  }
+  if (channel == NULL) {
+    return false;
+  }
+  crit_->Leave();
+  channel->EncodeAndSend();
+  crit_->Enter();
+  ChannelDone();
+  return true;
+}
+
+Channel* EncodeThreadPool::NextChannel() {
+  if (channels_ == NULL || next_channel_ >= num_channels_) {
+    return NULL;
+  }
+  ++active_;
+  return channels_[next_channel_++];
+}
+
+void EncodeThreadPool::ChannelDone() {
+  --active_;
+  if (active_ == 0 && next_channel_ >= num_channels_) {
+    done_cond_->WakeAll();
+  }
+}
+
+}  // namespace voe
+}  // namespace webrtc
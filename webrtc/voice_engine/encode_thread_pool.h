@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VOICE_ENGINE_ENCODE_THREAD_POOL_H_
+#define WEBRTC_VOICE_ENGINE_ENCODE_THREAD_POOL_H_
+
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class ConditionVariableWrapper;
+class CriticalSectionWrapper;
+class ThreadWrapper;
+
+namespace voe {
+
+class Channel;
+
+// Worker threads calling Channel::EncodeAndSend() for the sending channels of
+// one 10 ms capture block in parallel. The thread delivering the block takes
+// part in the encoding, so the pool may be given fewer threads than the
+// number of cores.
+class EncodeThreadPool {
+ public:
+  EncodeThreadPool();
+  ~EncodeThreadPool();
+
+  // Starts |num_threads| worker threads. Returns -1 if a thread can't be
+  // started, in which case no threads are left running.
+  int Start(int num_threads);
+
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+  // Encodes and sends the first |num_channels| of |channels| concurrently.
+  // Channels are picked up in order. The first |num_required| channels are
+  // always encoded; the others not picked up by a thread |deadline_ms| after
+  // the call are skipped, and the call returns as soon as the encodings
+  // already started are done.
+  //
+  // Returns the number of channels encoded, i.e. the index of the first
+  // skipped channel.
+  int EncodeAndSend(Channel* const* channels, int num_required,
+                    int num_channels, int deadline_ms);
+
+ private:
+  static bool Run(void* obj);
+  bool Process();
+
+  void Stop();
+
+  // Picks the next channel to encode, or returns NULL if there is none left.
+  // Must be called with |crit_| held.
+  Channel* NextChannel();
+
+  // Called after encoding a channel picked by NextChannel(), with |crit_|
+  // held.
+  void ChannelDone();
+
+  std::vector<ThreadWrapper*> threads_;
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  // Signaled when a block is ready for encoding, and on Stop().
+  scoped_ptr<ConditionVariableWrapper> work_cond_;
+  // Signaled when the last started encoding of a block is done.
+  scoped_ptr<ConditionVariableWrapper> done_cond_;
+
+  // The current block. |num_channels_| is lowered to |next_channel_|, but
+  // not below |num_required_|, when the deadline expires.
+  Channel* const* channels_;
+  int num_required_;
+  int num_channels_;
+  int next_channel_;
+  // Number of encodings started but not done.
+  int active_;
+  bool stopped_;
+
+  DISALLOW_COPY_AND_ASSIGN(EncodeThreadPool);
+};
+
+}  // namespace voe
+}  // namespace webrtc
+
+#endif  // WEBRTC_VOICE_ENGINE_ENCODE_THREAD_POOL_H_
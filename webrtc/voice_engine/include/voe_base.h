@@ -181,6 +181,29 @@ public:
     // Gets the NetEQ playout mode for a specified |channel| number.
     virtual int GetNetEQPlayoutMode(int channel, NetEqModes& mode) = 0;
 
+    // Encodes and packetizes the sending channels on |numThreads| worker
+    // threads in addition to the audio device thread, instead of on the
+    // audio device thread alone. Channels at a codec frame boundary that are
+    // not picked up by a thread |deadlineMs| after encoding of a 10 ms block
+    // started don't send that block; channels skipped in one block are
+    // encoded first in the next. The Transport of each channel must then be
+    // callable from any thread. Setting |numThreads| to 0 restores sequential
+    // encoding, which is the default.
+    virtual int SetEncoderThreads(int numThreads, int deadlineMs) = 0;
+
+    // Lets sending channels with the same send codec and VAD/DTX settings
+    // share one encoding of the captured audio, e.g. for the legs of a
+    // broadcast. Each channel still packetizes the payload with its own SSRC
+    // and sequence numbers. Channels playing a file as microphone, muted,
+    // with external media processing, inband DTMF, RED, a secondary codec,
+    // the audio level extension or iSAC encode on their own. Disabled by
+    // default.
+    virtual int SetEncoderSharing(bool enable) = 0;
+
+    // Gets the time spent in the capture callback since the last call.
+    virtual int GetCaptureTimingStatistics(
+        CaptureTimingStatistics& stats) = 0;
+
 protected:
     VoEBase() {}
     virtual ~VoEBase() {}
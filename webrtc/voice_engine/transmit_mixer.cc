@@ -14,9 +14,11 @@
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/voice_engine/channel.h"
 #include "webrtc/voice_engine/channel_manager.h"
+#include "webrtc/voice_engine/encode_thread_pool.h"
 #include "webrtc/voice_engine/include/voe_external_media.h"
 #include "webrtc/voice_engine/statistics.h"
 #include "webrtc/voice_engine/utility.h"
@@ -205,7 +207,15 @@ TransmitMixer::TransmitMixer(const uint32_t instanceId) :
     _mute(false),
     _remainingMuteMicTimeMs(0),
     stereo_codec_(false),
-    swap_stereo_channels_(false)
+    swap_stereo_channels_(false),
+    encode_crit_(CriticalSectionWrapper::CreateCriticalSection()),
+    encode_deadline_ms_(0),
+    share_encoders_(false),
+    encode_rotation_(0),
+    timing_crit_(CriticalSectionWrapper::CreateCriticalSection()),
+    deadline_misses_(0),
+    skipped_encodes_(0),
+    shared_encodes_(0)
 {
     WEBRTC_TRACE(kTraceMemory, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::TransmitMixer() - ctor");
@@ -340,6 +350,7 @@ TransmitMixer::PrepareDemux(const void* audioSamples,
                  "samplesPerSec=%u, totalDelayMS=%u, clockDrift=%d,"
                  "currentMicLevel=%u)", nSamples, nChannels, samplesPerSec,
                  totalDelayMS, clockDrift, currentMicLevel);
+    const int64_t startUs = TickTime::MicrosecondTimestamp();
 
     // --- Resample input audio and create/store the initial audio frame
     if (GenerateAudioFrame(static_cast<const int16_t*>(audioSamples),
@@ -415,6 +426,8 @@ TransmitMixer::PrepareDemux(const void* audioSamples,
 
     // --- Measure audio level of speech after all processing.
     _audioLevel.ComputeLevel(_audioFrame);
+
+    AddStageTiming(kPrepareStage, startUs);
     return 0;
 }
 
@@ -423,23 +436,28 @@ TransmitMixer::DemuxAndMix()
 {
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::DemuxAndMix()");
+    const int64_t startUs = TickTime::MicrosecondTimestamp();
 
-    ScopedChannel sc(*_channelManagerPtr);
-    void* iterator(NULL);
-    Channel* channelPtr = sc.GetFirstChannel(iterator);
-    while (channelPtr != NULL)
     {
-        if (channelPtr->InputIsOnHold())
-        {
-            channelPtr->UpdateLocalTimeStamp();
-        } else if (channelPtr->Sending())
+        ScopedChannel sc(*_channelManagerPtr);
+        void* iterator(NULL);
+        Channel* channelPtr = sc.GetFirstChannel(iterator);
+        while (channelPtr != NULL)
         {
-            // Demultiplex makes a copy of its input.
-            channelPtr->Demultiplex(_audioFrame);
-            channelPtr->PrepareEncodeAndSend(_audioFrame.sample_rate_hz_);
+            if (channelPtr->InputIsOnHold())
+            {
+                channelPtr->UpdateLocalTimeStamp();
+            } else if (channelPtr->Sending())
+            {
+                // Demultiplex makes a copy of its input.
+                channelPtr->Demultiplex(_audioFrame);
+                channelPtr->PrepareEncodeAndSend(_audioFrame.sample_rate_hz_);
+            }
+            channelPtr = sc.GetNextChannel(iterator);
         }
-        channelPtr = sc.GetNextChannel(iterator);
     }
+
+    AddStageTiming(kDemuxStage, startUs);
     return 0;
 }
 
@@ -448,21 +466,212 @@ TransmitMixer::EncodeAndSend()
 {
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::EncodeAndSend()");
+    const int64_t startUs = TickTime::MicrosecondTimestamp();
+    int skippedChannels = 0;
+    int sharedChannels = 0;
+
+    {
+        CriticalSectionScoped cs(encode_crit_.get());
+        ScopedChannel sc(*_channelManagerPtr);
+        void* iterator(NULL);
+        Channel* channelPtr = sc.GetFirstChannel(iterator);
+        Channel* channels[kVoiceEngineMaxNumChannels];
+        int numChannels = 0;
+        while (channelPtr != NULL)
+        {
+            if (channelPtr->Sending() && !channelPtr->InputIsOnHold())
+            {
+                assert(numChannels < kVoiceEngineMaxNumChannels);
+                channels[numChannels++] = channelPtr;
+            }
+            channelPtr = sc.GetNextChannel(iterator);
+        }
 
-    ScopedChannel sc(*_channelManagerPtr);
-    void* iterator(NULL);
-    Channel* channelPtr = sc.GetFirstChannel(iterator);
-    while (channelPtr != NULL)
-    {
-        if (channelPtr->Sending() && !channelPtr->InputIsOnHold())
+        // Channels sending the encoding of another channel. The first
+        // channel with a given encoder config encodes for all of them.
+        Channel* leaders[kVoiceEngineMaxNumChannels];
+        int numLeaders = 0;
+        if (share_encoders_)
         {
-            channelPtr->EncodeAndSend();
+            Channel::SharedEncoderConfig configs[kVoiceEngineMaxNumChannels];
+            int numEncoded = 0;
+            for (int i = 0; i < numChannels; ++i)
+            {
+                Channel::SharedEncoderConfig config;
+                Channel* leader = NULL;
+                if (channels[i]->GetSharedEncoderConfig(&config))
+                {
+                    for (int j = 0; j < numLeaders && leader == NULL; ++j)
+                    {
+                        if (Channel::SameSharedEncoderConfig(configs[j],
+                                                             config))
+                        {
+                            leader = leaders[j];
+                        }
+                    }
+                    if (leader == NULL)
+                    {
+                        configs[numLeaders] = config;
+                        leaders[numLeaders++] = channels[i];
+                    }
+                }
+                if (leader != NULL)
+                {
+                    leader->AddEncoderFollower(channels[i]);
+                    channels[i]->UpdateLocalTimeStamp();
+                    ++sharedChannels;
+                } else
+                {
+                    channels[numEncoded++] = channels[i];
+                }
+            }
+            numChannels = numEncoded;
         }
-        channelPtr = sc.GetNextChannel(iterator);
+
+        if (encode_pool_.get() == NULL)
+        {
+            for (int i = 0; i < numChannels; ++i)
+            {
+                channels[i]->EncodeAndSend();
+            }
+        } else
+        {
+            // Channels in the middle of a codec frame are always encoded, a
+            // dropped block would leave a gap inside the frame. The others
+            // follow, starting with the first one skipped in the last block,
+            // so the same channels aren't skipped every time.
+            Channel* ordered[kVoiceEngineMaxNumChannels];
+            Channel* optional[kVoiceEngineMaxNumChannels];
+            int numRequired = 0;
+            int numOptional = 0;
+            for (int i = 0; i < numChannels; ++i)
+            {
+                if (channels[i]->EncoderAtFrameBoundary())
+                {
+                    optional[numOptional++] = channels[i];
+                } else
+                {
+                    ordered[numRequired++] = channels[i];
+                }
+            }
+            const int firstOptional =
+                numOptional > 0 ? encode_rotation_ % numOptional : 0;
+            for (int i = 0; i < numOptional; ++i)
+            {
+                ordered[numRequired + i] =
+                    optional[(firstOptional + i) % numOptional];
+            }
+
+            const int encodedChannels = encode_pool_->EncodeAndSend(
+                ordered, numRequired, numChannels, encode_deadline_ms_);
+            for (int i = encodedChannels; i < numChannels; ++i)
+            {
+                // Drop the block but keep the RTP timestamp running, as for
+                // a channel on hold. Followers of a skipped channel send
+                // nothing either.
+                ordered[i]->UpdateLocalTimeStamp();
+            }
+            skippedChannels = numChannels - encodedChannels;
+            if (skippedChannels > 0)
+            {
+                encode_rotation_ =
+                    firstOptional + encodedChannels - numRequired;
+            }
+        }
+
+        for (int i = 0; i < numLeaders; ++i)
+        {
+            leaders[i]->ClearEncoderFollowers();
+        }
+    }
+
+    AddStageTiming(kEncodeStage, startUs);
+    if (skippedChannels > 0)
+    {
+        CriticalSectionScoped cs(timing_crit_.get());
+        ++deadline_misses_;
+        skipped_encodes_ += skippedChannels;
+    }
+    if (sharedChannels > 0)
+    {
+        CriticalSectionScoped cs(timing_crit_.get());
+        shared_encodes_ += sharedChannels;
     }
     return 0;
 }
 
+int TransmitMixer::SetEncoderThreads(int num_threads, int deadline_ms)
+{
+    WEBRTC_TRACE(kTraceInfo, kTraceVoice, VoEId(_instanceId, -1),
+                 "TransmitMixer::SetEncoderThreads(num_threads=%d, "
+                 "deadline_ms=%d)", num_threads, deadline_ms);
+
+    CriticalSectionScoped cs(encode_crit_.get());
+    encode_pool_.reset();
+    encode_deadline_ms_ = deadline_ms;
+    if (num_threads == 0)
+    {
+        return 0;
+    }
+    scoped_ptr<EncodeThreadPool> pool(new EncodeThreadPool());
+    if (pool->Start(num_threads) != 0)
+    {
+        return -1;
+    }
+    encode_pool_.reset(pool.release());
+    return 0;
+}
+
+void TransmitMixer::SetEncoderSharing(bool enable)
+{
+    WEBRTC_TRACE(kTraceInfo, kTraceVoice, VoEId(_instanceId, -1),
+                 "TransmitMixer::SetEncoderSharing(enable=%d)", enable);
+
+    CriticalSectionScoped cs(encode_crit_.get());
+    share_encoders_ = enable;
+}
+
+void TransmitMixer::GetCaptureTimingStatistics(CaptureTimingStatistics* stats)
+{
+    CriticalSectionScoped cs(timing_crit_.get());
+    stats->blocks = stage_timing_[kEncodeStage].count;
+    StatVal* stageStats[kNumCaptureStages] =
+        { &stats->prepare, &stats->demux, &stats->encode };
+    for (int i = 0; i < kNumCaptureStages; ++i)
+    {
+        const StageTiming& timing = stage_timing_[i];
+        stageStats[i]->min = timing.min_us;
+        stageStats[i]->max = timing.max_us;
+        stageStats[i]->average = timing.count > 0 ?
+            static_cast<int>(timing.total_us / timing.count) : 0;
+        stage_timing_[i] = StageTiming();
+    }
+    stats->deadlineMisses = deadline_misses_;
+    stats->skippedEncodes = skipped_encodes_;
+    stats->sharedEncodes = shared_encodes_;
+    deadline_misses_ = 0;
+    skipped_encodes_ = 0;
+    shared_encodes_ = 0;
+}
+
+void TransmitMixer::AddStageTiming(CaptureStage stage, int64_t start_us)
+{
+    const int elapsedUs =
+        static_cast<int>(TickTime::MicrosecondTimestamp() - start_us);
+    CriticalSectionScoped cs(timing_crit_.get());
+    StageTiming& timing = stage_timing_[stage];
+    if (timing.count == 0 || elapsedUs < timing.min_us)
+    {
+        timing.min_us = elapsedUs;
+    }
+    if (elapsedUs > timing.max_us)
+    {
+        timing.max_us = elapsedUs;
+    }
+    timing.total_us += elapsedUs;
+    ++timing.count;
+}
+
 uint32_t TransmitMixer::CaptureLevel() const
 {
     CriticalSectionScoped cs(&_critSect);
@@ -16,6 +16,7 @@
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/utility/interface/file_player.h"
 #include "webrtc/modules/utility/interface/file_recorder.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
 #include "webrtc/voice_engine/include/voe_base.h"
 #include "webrtc/voice_engine/level_indicator.h"
 #include "webrtc/voice_engine/monitor_module.h"
@@ -31,6 +32,7 @@ class VoEMediaProcess;
 namespace voe {
 
 class ChannelManager;
+class EncodeThreadPool;
 class MixedAudio;
 class Statistics;
 
@@ -64,6 +66,19 @@ public:
 
     int32_t EncodeAndSend();
 
+    // Encodes the sending channels on |num_threads| worker threads and the
+    // calling thread, skipping channels not started within |deadline_ms|.
+    // See VoEBase::SetEncoderThreads().
+    int SetEncoderThreads(int num_threads, int deadline_ms);
+
+    // Encodes the input once for each group of sending channels with the
+    // same encoder settings. See VoEBase::SetEncoderSharing().
+    void SetEncoderSharing(bool enable);
+
+    // Gets and resets the time spent in PrepareDemux(), DemuxAndMix() and
+    // EncodeAndSend().
+    void GetCaptureTimingStatistics(CaptureTimingStatistics* stats);
+
     uint32_t CaptureLevel() const;
 
     int32_t StopSend();
@@ -161,8 +176,24 @@ public:
   bool IsStereoChannelSwappingEnabled();
 
 private:
+    enum CaptureStage { kPrepareStage = 0, kDemuxStage, kEncodeStage,
+                        kNumCaptureStages };
+
+    struct StageTiming
+    {
+        StageTiming() : count(0), total_us(0), min_us(0), max_us(0) {}
+
+        int count;
+        int64_t total_us;
+        int min_us;
+        int max_us;
+    };
+
     TransmitMixer(const uint32_t instanceId);
 
+    // Adds the time since |start_us| to the timing of |stage|.
+    void AddStageTiming(CaptureStage stage, int64_t start_us);
+
     // Gets the maximum sample rate and number of channels over all currently
     // sending codecs.
     void GetSendCodecInfo(int* max_sample_rate, int* max_channels);
@@ -232,6 +263,22 @@ private:
     int32_t _remainingMuteMicTimeMs;
     bool stereo_codec_;
     bool swap_stereo_channels_;
+
+    // Protects |encode_pool_|, |encode_deadline_ms_|, |share_encoders_| and
+    // |encode_rotation_|, which are used throughout EncodeAndSend().
+    scoped_ptr<CriticalSectionWrapper> encode_crit_;
+    scoped_ptr<EncodeThreadPool> encode_pool_;
+    int encode_deadline_ms_;
+    bool share_encoders_;
+    // Position among the channels at a frame boundary to start encoding from
+    // in the next block.
+    int encode_rotation_;
+
+    scoped_ptr<CriticalSectionWrapper> timing_crit_;
+    StageTiming stage_timing_[kNumCaptureStages];
+    int deadline_misses_;
+    int skipped_encodes_;
+    int shared_encodes_;
 };
 
 #endif // WEBRTC_VOICE_ENGINE_TRANSMIT_MIXER_H
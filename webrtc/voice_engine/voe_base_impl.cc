@@ -1006,6 +1006,45 @@ int VoEBaseImpl::GetNetEQPlayoutMode(int channel, NetEqModes& mode)
     return channelPtr->GetNetEQPlayoutMode(mode);
 }
 
+int VoEBaseImpl::SetEncoderThreads(int numThreads, int deadlineMs)
+{
+    WEBRTC_TRACE(kTraceApiCall, kTraceVoice, VoEId(_shared->instance_id(), -1),
+                 "SetEncoderThreads(numThreads=%d, deadlineMs=%d)", numThreads,
+                 deadlineMs);
+    CriticalSectionScoped cs(_shared->crit_sec());
+    if (numThreads < 0 || numThreads > kVoiceEngineMaxEncoderThreads ||
+        deadlineMs <= 0)
+    {
+        _shared->SetLastError(VE_INVALID_ARGUMENT, kTraceError,
+            "SetEncoderThreads() invalid argument");
+        return -1;
+    }
+    if (_shared->transmit_mixer()->SetEncoderThreads(numThreads,
+                                                     deadlineMs) != 0)
+    {
+        _shared->SetLastError(VE_THREAD_ERROR, kTraceError,
+            "SetEncoderThreads() failed to start the encoder threads");
+        return -1;
+    }
+    return 0;
+}
+
+int VoEBaseImpl::SetEncoderSharing(bool enable)
+{
+    WEBRTC_TRACE(kTraceApiCall, kTraceVoice, VoEId(_shared->instance_id(), -1),
+                 "SetEncoderSharing(enable=%d)", enable);
+    _shared->transmit_mixer()->SetEncoderSharing(enable);
+    return 0;
+}
+
+int VoEBaseImpl::GetCaptureTimingStatistics(CaptureTimingStatistics& stats)
+{
+    WEBRTC_TRACE(kTraceApiCall, kTraceVoice, VoEId(_shared->instance_id(), -1),
+                 "GetCaptureTimingStatistics()");
+    _shared->transmit_mixer()->GetCaptureTimingStatistics(&stats);
+    return 0;
+}
+
 int VoEBaseImpl::SetOnHoldStatus(int channel, bool enable, OnHoldModes mode)
 {
     WEBRTC_TRACE(kTraceApiCall, kTraceVoice, VoEId(_shared->instance_id(), -1),
@@ -60,6 +60,12 @@ public:
 
     virtual int GetNetEQPlayoutMode(int channel, NetEqModes& mode);
 
+    virtual int SetEncoderThreads(int numThreads, int deadlineMs);
+
+    virtual int SetEncoderSharing(bool enable);
+
+    virtual int GetCaptureTimingStatistics(CaptureTimingStatistics& stats);
+
     virtual int SetOnHoldStatus(int channel,
                                 bool enable,
                                 OnHoldModes mode = kHoldSendAndPlay);
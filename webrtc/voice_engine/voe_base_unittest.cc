@@ -10,10 +10,24 @@
 
 #include "webrtc/voice_engine/include/voe_base.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_device/include/fake_audio_device.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/voice_engine/include/voe_codec.h"
+#include "webrtc/voice_engine/include/voe_errors.h"
+#include "webrtc/voice_engine/include/voe_network.h"
+#include "webrtc/voice_engine/voice_engine_defines.h"
 
 namespace webrtc {
 
@@ -47,4 +61,303 @@ TEST_F(VoEBaseTest, AudioProcessingCreatedAfterInit) {
   EXPECT_TRUE(base_->audio_processing() != NULL);
 }
 
+// Keeps the audio callback, so that the test can deliver captured audio on a
+// realtime priority thread, the way the audio device would.
+class CapturingAudioDeviceModule : public FakeAudioDeviceModule {
+ public:
+  CapturingAudioDeviceModule()
+      : audio_callback_(NULL),
+        recording_(false),
+        blocks_left_(0),
+        done_(EventWrapper::Create()) {}
+
+  virtual int32_t RegisterAudioCallback(AudioTransport* audio_callback) {
+    audio_callback_ = audio_callback;
+    return 0;
+  }
+  virtual int32_t InitRecording() { return 0; }
+  virtual int32_t StartRecording() {
+    recording_ = true;
+    return 0;
+  }
+  virtual int32_t StopRecording() {
+    recording_ = false;
+    return 0;
+  }
+  virtual bool Recording() const { return recording_; }
+  virtual int32_t MaxMicrophoneVolume(uint32_t* max_volume) const {
+    *max_volume = kMaxVolumeLevel;
+    return 0;
+  }
+
+  // Delivers |num_blocks| blocks of 10 ms of 16 kHz mono audio back to back,
+  // and returns when they have been processed.
+  void Capture(int num_blocks) {
+    ASSERT_TRUE(audio_callback_ != NULL);
+    blocks_left_ = num_blocks;
+    scoped_ptr<ThreadWrapper> thread(ThreadWrapper::CreateThread(
+        CaptureThread, this, kRealtimePriority, "FakeCaptureThread"));
+    unsigned int thread_id = 0;
+    ASSERT_TRUE(thread->Start(thread_id));
+    EXPECT_EQ(kEventSignaled, done_->Wait(60000));
+    thread->Stop();
+  }
+
+ private:
+  static bool CaptureThread(void* obj) {
+    return static_cast<CapturingAudioDeviceModule*>(obj)->CaptureBlock();
+  }
+
+  bool CaptureBlock() {
+    if (blocks_left_ == 0) {
+      done_->Set();
+      return false;
+    }
+    --blocks_left_;
+    int16_t audio[160];
+    for (int i = 0; i < 160; ++i) {
+      // A 500 Hz square wave.
+      audio[i] = (i % 32 < 16) ? 1000 : -1000;
+    }
+    uint32_t new_mic_level = 0;
+    audio_callback_->RecordedDataIsAvailable(audio, 160, 2, 1, 16000, 0, 0, 0,
+                                             false, new_mic_level);
+    return true;
+  }
+
+  AudioTransport* audio_callback_;
+  bool recording_;
+  int blocks_left_;
+  scoped_ptr<EventWrapper> done_;
+};
+
+// Counts the RTP packets of each channel, and the packets not following the
+// previous one of the channel in sequence. Packets may be sent from several
+// threads at once.
+class PacketCountingTransport : public Transport {
+ public:
+  PacketCountingTransport()
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()) {}
+
+  virtual int SendPacket(int channel, const void* data, int len) {
+    const uint8_t* packet = static_cast<const uint8_t*>(data);
+    const uint16_t sequence_number = (packet[2] << 8) | packet[3];
+    CriticalSectionScoped cs(crit_.get());
+    if (packets_[channel] > 0 &&
+        sequence_number != static_cast<uint16_t>(
+            last_sequence_numbers_[channel] + 1)) {
+      ++out_of_sequence_[channel];
+    }
+    last_sequence_numbers_[channel] = sequence_number;
+    ++packets_[channel];
+    return len;
+  }
+  virtual int SendRTCPPacket(int channel, const void* data, int len) {
+    return len;
+  }
+
+  int packets(int channel) {
+    CriticalSectionScoped cs(crit_.get());
+    return packets_[channel];
+  }
+
+  int out_of_sequence(int channel) {
+    CriticalSectionScoped cs(crit_.get());
+    return out_of_sequence_[channel];
+  }
+
+ private:
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  std::map<int, int> packets_;
+  std::map<int, uint16_t> last_sequence_numbers_;
+  std::map<int, int> out_of_sequence_;
+};
+
+class VoEBaseEncoderThreadsTest : public ::testing::Test {
+ protected:
+  VoEBaseEncoderThreadsTest()
+      : voe_(VoiceEngine::Create()),
+        base_(VoEBase::GetInterface(voe_)),
+        codec_(VoECodec::GetInterface(voe_)),
+        network_(VoENetwork::GetInterface(voe_)) {
+  }
+
+  virtual void SetUp() {
+    ASSERT_EQ(0, base_->Init(&adm_));
+  }
+
+  virtual void TearDown() {
+    for (size_t i = 0; i < channels_.size(); ++i) {
+      base_->StopSend(channels_[i]);
+      network_->DeRegisterExternalTransport(channels_[i]);
+      base_->DeleteChannel(channels_[i]);
+    }
+    base_->Terminate();
+    network_->Release();
+    codec_->Release();
+    base_->Release();
+    VoiceEngine::Delete(voe_);
+  }
+
+  // Creates |num_channels| channels sending with the codec |codec_name|.
+  void CreateSendingChannels(int num_channels, const char* codec_name) {
+    CodecInst codec;
+    bool found = false;
+    for (int i = 0; i < codec_->NumOfCodecs() && !found; ++i) {
+      ASSERT_EQ(0, codec_->GetCodec(i, codec));
+      found = strcmp(codec.plname, codec_name) == 0;
+    }
+    ASSERT_TRUE(found);
+    for (int i = 0; i < num_channels; ++i) {
+      const int channel = base_->CreateChannel();
+      ASSERT_NE(-1, channel);
+      channels_.push_back(channel);
+      ASSERT_EQ(0, codec_->SetSendCodec(channel, codec));
+      ASSERT_EQ(0, network_->RegisterExternalTransport(channel, transport_));
+      ASSERT_EQ(0, base_->StartSend(channel));
+    }
+  }
+
+  VoiceEngine* voe_;
+  VoEBase* base_;
+  VoECodec* codec_;
+  VoENetwork* network_;
+  CapturingAudioDeviceModule adm_;
+  PacketCountingTransport transport_;
+  std::vector<int> channels_;
+};
+
+TEST_F(VoEBaseEncoderThreadsTest, RejectsInvalidArguments) {
+  EXPECT_EQ(-1, base_->SetEncoderThreads(-1, 5));
+  EXPECT_EQ(VE_INVALID_ARGUMENT, base_->LastError());
+  EXPECT_EQ(-1, base_->SetEncoderThreads(kVoiceEngineMaxEncoderThreads + 1,
+                                         5));
+  EXPECT_EQ(-1, base_->SetEncoderThreads(2, 0));
+  EXPECT_EQ(0, base_->SetEncoderThreads(2, 5));
+  EXPECT_EQ(0, base_->SetEncoderThreads(3, 5));
+  EXPECT_EQ(0, base_->SetEncoderThreads(0, 5));
+}
+
+TEST_F(VoEBaseEncoderThreadsTest, SendsTheSamePacketsAsSequentialEncoding) {
+  const int kNumChannels = 10;
+  const int kNumBlocks = 20;
+  CreateSendingChannels(kNumChannels, "PCMU");
+  adm_.Capture(kNumBlocks);
+  std::vector<int> sequential_packets;
+  for (int i = 0; i < kNumChannels; ++i) {
+    sequential_packets.push_back(transport_.packets(channels_[i]));
+    EXPECT_GT(sequential_packets[i], 0);
+  }
+
+  // A deadline long enough to never be missed.
+  ASSERT_EQ(0, base_->SetEncoderThreads(3, 10000));
+  CaptureTimingStatistics stats;
+  EXPECT_EQ(0, base_->GetCaptureTimingStatistics(stats));
+  adm_.Capture(kNumBlocks);
+  for (int i = 0; i < kNumChannels; ++i) {
+    EXPECT_EQ(2 * sequential_packets[i], transport_.packets(channels_[i]));
+  }
+
+  EXPECT_EQ(0, base_->GetCaptureTimingStatistics(stats));
+  EXPECT_EQ(kNumBlocks, stats.blocks);
+  EXPECT_EQ(0, stats.deadlineMisses);
+  EXPECT_EQ(0, stats.skippedEncodes);
+  EXPECT_LE(stats.encode.min, stats.encode.average);
+  EXPECT_LE(stats.encode.average, stats.encode.max);
+  EXPECT_LE(stats.prepare.min, stats.prepare.max);
+  EXPECT_LE(stats.demux.min, stats.demux.max);
+
+  // The statistics are reset when read.
+  EXPECT_EQ(0, base_->GetCaptureTimingStatistics(stats));
+  EXPECT_EQ(0, stats.blocks);
+}
+
+TEST_F(VoEBaseEncoderThreadsTest, SharesEncodingsOfChannelsWithTheSameCodec) {
+  const int kNumPcmuChannels = 6;
+  const int kNumPcmaChannels = 4;
+  const int kNumBlocks = 20;
+  CreateSendingChannels(kNumPcmuChannels, "PCMU");
+  CreateSendingChannels(kNumPcmaChannels, "PCMA");
+  adm_.Capture(kNumBlocks);
+  std::vector<int> own_packets;
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    own_packets.push_back(transport_.packets(channels_[i]));
+    EXPECT_GT(own_packets[i], 0);
+  }
+
+  EXPECT_EQ(0, base_->SetEncoderSharing(true));
+  CaptureTimingStatistics stats;
+  EXPECT_EQ(0, base_->GetCaptureTimingStatistics(stats));
+  adm_.Capture(kNumBlocks);
+  EXPECT_EQ(0, base_->GetCaptureTimingStatistics(stats));
+  // One channel per codec encodes.
+  EXPECT_EQ((kNumPcmuChannels + kNumPcmaChannels - 2) * kNumBlocks,
+            stats.sharedEncodes);
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    EXPECT_EQ(2 * own_packets[i], transport_.packets(channels_[i]));
+    EXPECT_EQ(0, transport_.out_of_sequence(channels_[i]));
+  }
+
+  // Also with the encoder threads.
+  ASSERT_EQ(0, base_->SetEncoderThreads(3, 10000));
+  adm_.Capture(kNumBlocks);
+  EXPECT_EQ(0, base_->GetCaptureTimingStatistics(stats));
+  EXPECT_EQ((kNumPcmuChannels + kNumPcmaChannels - 2) * kNumBlocks,
+            stats.sharedEncodes);
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    EXPECT_EQ(3 * own_packets[i], transport_.packets(channels_[i]));
+    EXPECT_EQ(0, transport_.out_of_sequence(channels_[i]));
+  }
+
+  EXPECT_EQ(0, base_->SetEncoderSharing(false));
+  adm_.Capture(kNumBlocks);
+  EXPECT_EQ(0, base_->GetCaptureTimingStatistics(stats));
+  EXPECT_EQ(0, stats.sharedEncodes);
+}
+
+// Measures the time spent in each stage of the capture callback with the
+// maximum number of channels, encoding sequentially and on encoder threads.
+TEST_F(VoEBaseEncoderThreadsTest, DISABLED_CaptureBenchmark) {
+  const int kNumBlocks = 100;
+  const int kDeadlineMs = 8;
+  CreateSendingChannels(kVoiceEngineMaxNumChannels, "ISAC");
+  const int kNumThreads[] = { 0, 1, 3, 7 };
+  for (size_t i = 0; i < sizeof(kNumThreads) / sizeof(kNumThreads[0]); ++i) {
+    ASSERT_EQ(0, base_->SetEncoderThreads(kNumThreads[i], kDeadlineMs));
+    // Warm up, and skip the statistics of the previous run.
+    adm_.Capture(10);
+    CaptureTimingStatistics stats;
+    base_->GetCaptureTimingStatistics(stats);
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    adm_.Capture(kNumBlocks);
+    const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+    base_->GetCaptureTimingStatistics(stats);
+    printf("%d channels, %d encoder threads: %lld us per block; prepare %d, "
+           "demux %d, encode %d (max %d) us; %d deadline misses, %d channel "
+           "blocks skipped\n", kVoiceEngineMaxNumChannels, kNumThreads[i],
+           static_cast<long long>(elapsed_us / kNumBlocks),
+           stats.prepare.average, stats.demux.average, stats.encode.average,
+           stats.encode.max, stats.deadlineMisses, stats.skippedEncodes);
+  }
+}
+
+// Measures the encoding time of a broadcast to the maximum number of
+// channels, with and without sharing the encoder.
+TEST_F(VoEBaseEncoderThreadsTest, DISABLED_SharedEncoderBenchmark) {
+  const int kNumBlocks = 100;
+  CreateSendingChannels(kVoiceEngineMaxNumChannels, "ILBC");
+  for (int share = 0; share < 2; ++share) {
+    ASSERT_EQ(0, base_->SetEncoderSharing(share != 0));
+    adm_.Capture(10);
+    CaptureTimingStatistics stats;
+    base_->GetCaptureTimingStatistics(stats);
+    adm_.Capture(kNumBlocks);
+    base_->GetCaptureTimingStatistics(stats);
+    printf("%d iLBC channels, %s: encode %d (max %d) us per block, %d "
+           "channel blocks shared\n", kVoiceEngineMaxNumChannels,
+           share ? "shared encoder" : "encoder per channel",
+           stats.encode.average, stats.encode.max, stats.sharedEncodes);
+  }
+}
+
 }  // namespace webrtc
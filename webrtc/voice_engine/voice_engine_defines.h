@@ -59,6 +59,7 @@ enum { kVoiceEngineMaxModuleVersionSize = 960 };
 
 // Base
 enum { kVoiceEngineVersionMaxMessageSize = 1024 };
+enum { kVoiceEngineMaxEncoderThreads = 32 };
 
 // Audio processing
 const NoiseSuppression::Level kDefaultNsMode = NoiseSuppression::kModerate;